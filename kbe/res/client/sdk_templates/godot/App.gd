@@ -34,6 +34,16 @@ enum CLIENT_TYPE {
 	#mini client (lightweight plugin)
 	CLIENT_TYPE_MINI		= 7
 }
+
+#Optional features declared by the client in hello, same as network/common.h on the server
+const CLIENT_FEATURE_VOLATILE_SNAPSHOT = 0x00000001
+
+#Per entity field flags of onUpdateVolatileSnapshot, coordinates are in centimetres
+const VOLATILE_SNAPSHOT_FLAG_XZ = 0x01
+const VOLATILE_SNAPSHOT_FLAG_Y = 0x02
+const VOLATILE_SNAPSHOT_FLAG_YAW = 0x04
+const VOLATILE_SNAPSHOT_FLAG_PITCH_ROLL = 0x08
+const VOLATILE_SNAPSHOT_UNITS_PER_METER = 100.0
 var clientType = CLIENT_TYPE.CLIENT_TYPE_MINI
 
 var username = "kbengine"
@@ -315,6 +325,11 @@ func hello():
 	bundle.writeString(clientVersion)
 	bundle.writeString(clientScriptVersion)
 	bundle.writeBlob(_encryptedKey)
+	
+	#No compression, declare that the client can decode onUpdateVolatileSnapshot
+	bundle.writeUint8(0)
+	bundle.writeUint32(0)
+	bundle.writeUint32(CLIENT_FEATURE_VOLATILE_SNAPSHOT)
 	bundle.send(_networkInterface)
 	
 #Callback from server after handshake
@@ -1428,6 +1443,115 @@ func _updateVolatileData(entityID, x, y, z, yaw, pitch, roll, isOnGround):
 	if directionChanged or positionChanged:
 		entity.onUpdateVolatileData()
 
+#The server sets the base position (centimetres) of the onUpdateVolatileSnapshot deltas
+#The position itself is set by the following snapshot (zero delta)
+func Client_onUpdateVolatileBase(stream):
+	var eid = getViewEntityIDFromStream(stream)
+	
+	var x = stream.readInt32()
+	var y = stream.readInt32()
+	var z = stream.readInt32()
+	
+	if not entities.has(eid):
+		Dbg.ERROR_MSG("KBEngine::Client_onUpdateVolatileBase: entity(" + str(eid) + ") not found!")
+		return
+	
+	entities[eid]._volatileBase = [x, y, z]
+
+#Positions and directions of several View entities in one message
+#Layout: uint8 slotCount, presence mask, 4 bit field flags per entity (low nibble first), then the fields of each entity in slot order
+#The slot is the alias ID of the entity
+func Client_onUpdateVolatileSnapshot(stream):
+	var slotCount = stream.readUint8()
+	
+	var masks = []
+	var count = 0
+	
+	for i in range((slotCount + 7) / 8):
+		var bits = stream.readUint8()
+		masks.append(bits)
+		
+		while bits != 0:
+			bits &= bits - 1
+			count += 1
+	
+	#Each byte holds the flags of two entities, low nibble first
+	var flags = []
+	for i in range(0, count, 2):
+		var nibbles = stream.readUint8()
+		flags.append(nibbles & 0x0f)
+		flags.append(nibbles >> 4)
+	
+	var n = 0
+	for slot in range(slotCount):
+		if (masks[slot >> 3] & (1 << (slot & 7))) == 0:
+			continue
+		
+		var f = flags[n]
+		n += 1
+		var delta = [0, 0, 0]
+		var yaw = 0
+		var pitch = 0
+		var roll = 0
+		
+		if (f & VOLATILE_SNAPSHOT_FLAG_XZ) > 0:
+			delta[0] = stream.readInt16()
+			delta[2] = stream.readInt16()
+		
+		if (f & VOLATILE_SNAPSHOT_FLAG_Y) > 0:
+			delta[1] = stream.readInt16()
+		
+		if (f & VOLATILE_SNAPSHOT_FLAG_YAW) > 0:
+			yaw = stream.readInt8()
+		
+		if (f & VOLATILE_SNAPSHOT_FLAG_PITCH_ROLL) > 0:
+			pitch = stream.readInt8()
+			roll = stream.readInt8()
+		
+		#Same as getViewEntityIDFromStream, an uninitialized alias may arrive after a reconnect
+		if slot >= len(_entityIDAliasIDList):
+			continue
+		
+		_updateVolatileSnapshot(_entityIDAliasIDList[slot], f, delta, yaw, pitch, roll)
+
+func _updateVolatileSnapshot(entityID, flags, delta, yaw, pitch, roll):
+	if not entities.has(entityID):
+		Dbg.ERROR_MSG("KBEngine::Client_onUpdateVolatileSnapshot: entity(" + str(entityID) + ") not found!")
+		return
+	var entity = entities[entityID]
+	
+	var directionChanged = (flags & (VOLATILE_SNAPSHOT_FLAG_YAW | VOLATILE_SNAPSHOT_FLAG_PITCH_ROLL)) > 0
+	
+	if (flags & VOLATILE_SNAPSHOT_FLAG_YAW) > 0:
+		entity.direction.z = KBEngine.Helpers.int82angle(yaw, false)
+	
+	if (flags & VOLATILE_SNAPSHOT_FLAG_PITCH_ROLL) > 0:
+		entity.direction.y = KBEngine.Helpers.int82angle(pitch, false)
+		entity.direction.x = KBEngine.Helpers.int82angle(roll, false)
+	
+	if directionChanged:
+		Event.fireOut("set_direction", [entity])
+	
+	var positionChanged = false
+	if (flags & VOLATILE_SNAPSHOT_FLAG_XZ) > 0:
+		var base = entity._volatileBase
+		if base == null:
+			Dbg.ERROR_MSG("KBEngine::Client_onUpdateVolatileSnapshot: entity(" + str(entityID) + ") has no base position!")
+		else:
+			#Snapshot positions are absolute, _entityServerPos is not added
+			base[0] += delta[0]
+			base[1] += delta[1]
+			base[2] += delta[2]
+			
+			entity.isOnGround = (flags & VOLATILE_SNAPSHOT_FLAG_Y) == 0
+			entity.position = Vector3(base[0] / VOLATILE_SNAPSHOT_UNITS_PER_METER, 
+				base[1] / VOLATILE_SNAPSHOT_UNITS_PER_METER, base[2] / VOLATILE_SNAPSHOT_UNITS_PER_METER)
+			Event.fireOut("updatePosition", [entity])
+			positionChanged = true
+	
+	if directionChanged or positionChanged:
+		entity.onUpdateVolatileData()
+
 #The server informs the start of streaming data download
 #Please refer to the API manual about onStreamDataStarted
 func Client_onStreamDataStarted(id, datasize, descr):
@@ -6,6 +6,10 @@
 var _entityLastLocalPos = Vector3(0,0,0)
 var _entityLastLocalDir = Vector3(0,0,0)
 
+#Base position (centimetres) of the onUpdateVolatileSnapshot deltas, set by onUpdateVolatileBase
+#This property is for the engine, do not modify elsewhere
+var _volatileBase = null
+
 var id = 0
 var className = ""
 var position = Vector3(0,0,0)
@@ -78,6 +78,16 @@ KBEngine.MESSAGE_LENGTH_LENGTH	= 2;
 KBEngine.CLIENT_NO_FLOAT		= 0;
 KBEngine.KBE_FLT_MAX			= 3.402823466e+38;
 
+// 客户端在hello中声明的可选特性， 与服务端network/common.h中的定义一致
+KBEngine.CLIENT_FEATURE_VOLATILE_SNAPSHOT		= 0x00000001;
+
+// onUpdateVolatileSnapshot中每个实体的字段标记， 坐标单位为厘米
+KBEngine.VOLATILE_SNAPSHOT_FLAG_XZ				= 0x01;
+KBEngine.VOLATILE_SNAPSHOT_FLAG_Y				= 0x02;
+KBEngine.VOLATILE_SNAPSHOT_FLAG_YAW				= 0x04;
+KBEngine.VOLATILE_SNAPSHOT_FLAG_PITCH_ROLL		= 0x08;
+KBEngine.VOLATILE_SNAPSHOT_UNITS_PER_METER		= 100.0;
+
 /*-----------------------------------------------------------------------------------------
 												number64bits
 -----------------------------------------------------------------------------------------*/
@@ -1259,6 +1269,9 @@ KBEngine.Entity = KBEngine.Class.extend(
 		
 		// 玩家是否在地面上
 		this.isOnGround = false;
+		
+		// onUpdateVolatileSnapshot增量的基准位置(厘米)，由onUpdateVolatileBase设置
+		this.volatileBase = null;
 
         return true;
     },
@@ -2494,6 +2507,11 @@ KBEngine.KBEngineApp = function(kbengineArgs)
 		bundle.writeString(KBEngine.app.clientVersion);
 		bundle.writeString(KBEngine.app.clientScriptVersion);
 		bundle.writeBlob(KBEngine.app.encryptedKey);
+		
+		// 不使用压缩， 声明客户端能够解析onUpdateVolatileSnapshot
+		bundle.writeUint8(0);
+		bundle.writeUint32(0);
+		bundle.writeUint32(KBEngine.CLIENT_FEATURE_VOLATILE_SNAPSHOT);
 		bundle.send(KBEngine.app);
 	}
 
@@ -4394,6 +4412,139 @@ KBEngine.KBEngineApp = function(kbengineArgs)
 			entity.onUpdateVolatileData();		
 	}
 	
+	this.Client_onUpdateVolatileBase = function(stream)
+	{
+		var eid = KBEngine.app.getViewEntityIDFromStream(stream);
+		
+		var x = stream.readInt32();
+		var y = stream.readInt32();
+		var z = stream.readInt32();
+		
+		var entity = KBEngine.app.entities[eid];
+		if(entity == undefined)
+		{
+			KBEngine.ERROR_MSG("KBEngineApp::Client_onUpdateVolatileBase: entity(" + eid + ") not found!");
+			return;
+		}
+		
+		// 位置由随后的快照(增量为0)设置
+		entity.volatileBase = [x, y, z];
+	}
+	
+	this.Client_onUpdateVolatileSnapshot = function(stream)
+	{
+		var slotCount = stream.readUint8();
+		
+		var masks = [];
+		var count = 0;
+		
+		for(var i = 0; i < Math.floor((slotCount + 7) / 8); ++i)
+		{
+			masks.push(stream.readUint8());
+			
+			for(var bits = masks[i]; bits != 0; bits &= bits - 1)
+				++count;
+		}
+		
+		// 每个字节包含两个实体的标记， 低4位在前
+		var flags = [];
+		for(var i = 0; i < count; i += 2)
+		{
+			var nibbles = stream.readUint8();
+			flags.push(nibbles & 0x0f);
+			flags.push(nibbles >> 4);
+		}
+		
+		var n = 0;
+		for(var slot = 0; slot < slotCount; ++slot)
+		{
+			if((masks[slot >> 3] & (1 << (slot & 7))) == 0)
+				continue;
+			
+			var f = flags[n++];
+			var delta = [0, 0, 0];
+			var yaw = 0, pitch = 0, roll = 0;
+			
+			if((f & KBEngine.VOLATILE_SNAPSHOT_FLAG_XZ) > 0)
+			{
+				delta[0] = stream.readInt16();
+				delta[2] = stream.readInt16();
+			}
+			
+			if((f & KBEngine.VOLATILE_SNAPSHOT_FLAG_Y) > 0)
+				delta[1] = stream.readInt16();
+			
+			if((f & KBEngine.VOLATILE_SNAPSHOT_FLAG_YAW) > 0)
+				yaw = stream.readInt8();
+			
+			if((f & KBEngine.VOLATILE_SNAPSHOT_FLAG_PITCH_ROLL) > 0)
+			{
+				pitch = stream.readInt8();
+				roll = stream.readInt8();
+			}
+			
+			// 与getViewEntityIDFromStream相同， 重连时可能收到未初始化的别名
+			if(slot >= KBEngine.app.entityIDAliasIDList.length)
+				continue;
+			
+			KBEngine.app._updateVolatileSnapshot(KBEngine.app.entityIDAliasIDList[slot], f, delta, yaw, pitch, roll);
+		}
+	}
+	
+	this._updateVolatileSnapshot = function(entityID, flags, delta, yaw, pitch, roll)
+	{
+		var entity = KBEngine.app.entities[entityID];
+		if(entity == undefined)
+		{
+			KBEngine.ERROR_MSG("KBEngineApp::Client_onUpdateVolatileSnapshot: entity(" + entityID + ") not found!");
+			return;
+		}
+		
+		var done = false;
+		
+		if((flags & (KBEngine.VOLATILE_SNAPSHOT_FLAG_YAW | KBEngine.VOLATILE_SNAPSHOT_FLAG_PITCH_ROLL)) > 0)
+		{
+			if((flags & KBEngine.VOLATILE_SNAPSHOT_FLAG_YAW) > 0)
+				entity.direction.z = KBEngine.int82angle(yaw, false);
+			
+			if((flags & KBEngine.VOLATILE_SNAPSHOT_FLAG_PITCH_ROLL) > 0)
+			{
+				entity.direction.y = KBEngine.int82angle(pitch, false);
+				entity.direction.x = KBEngine.int82angle(roll, false);
+			}
+			
+			KBEngine.Event.fire("set_direction", entity);
+			done = true;
+		}
+		
+		if((flags & KBEngine.VOLATILE_SNAPSHOT_FLAG_XZ) > 0)
+		{
+			var base = entity.volatileBase;
+			if(base == null)
+			{
+				KBEngine.ERROR_MSG("KBEngineApp::Client_onUpdateVolatileSnapshot: entity(" + entityID + ") has no base position!");
+			}
+			else
+			{
+				// 快照中的位置是绝对坐标， 不需要加上entityServerPos
+				base[0] += delta[0];
+				base[1] += delta[1];
+				base[2] += delta[2];
+				
+				entity.isOnGround = (flags & KBEngine.VOLATILE_SNAPSHOT_FLAG_Y) == 0;
+				entity.position.x = base[0] / KBEngine.VOLATILE_SNAPSHOT_UNITS_PER_METER;
+				entity.position.y = base[1] / KBEngine.VOLATILE_SNAPSHOT_UNITS_PER_METER;
+				entity.position.z = base[2] / KBEngine.VOLATILE_SNAPSHOT_UNITS_PER_METER;
+				
+				KBEngine.Event.fire("updatePosition", entity);
+				done = true;
+			}
+		}
+		
+		if(done)
+			entity.onUpdateVolatileData();
+	}
+	
 	this.Client_onStreamDataStarted = function(id, datasize, descr)
 	{
 		KBEngine.Event.fire("onStreamDataStarted", id, datasize, descr);
@@ -23,7 +23,9 @@ Entity::Entity():
 	direction(),
 	spaceID(0),
 	entityLastLocalPos(),
-	entityLastLocalDir()
+	entityLastLocalDir(),
+	volatileBase(),
+	hasVolatileBase(false)
 {
 }
 
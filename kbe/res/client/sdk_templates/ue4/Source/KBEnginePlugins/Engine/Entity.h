@@ -188,6 +188,11 @@ public:
 	FVector entityLastLocalPos;
 	FVector entityLastLocalDir;
 
+	// onUpdateVolatileSnapshot增量的基准位置(厘米)，由onUpdateVolatileBase设置
+	// 这两个属性是给引擎KBEngine.cpp用的，别的地方不要修改
+	int32 volatileBase[3];
+	bool hasVolatileBase;
+
 	//EntityCall* baseEntityCall = null;
 	//EntityCall* cellEntityCall = null;
 };
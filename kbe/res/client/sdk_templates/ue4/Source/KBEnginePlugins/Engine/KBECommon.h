@@ -25,6 +25,16 @@ typedef TArray<KBVar> KB_ARRAY;
 
 #define KBE_FLT_MAX FLT_MAX
 
+/** 客户端在hello中声明的可选特性， 与服务端network/common.h中的定义一致 */
+#define CLIENT_FEATURE_VOLATILE_SNAPSHOT		0x00000001
+
+/** onUpdateVolatileSnapshot中每个实体的字段标记， 坐标单位为厘米 */
+#define VOLATILE_SNAPSHOT_FLAG_XZ				0x01
+#define VOLATILE_SNAPSHOT_FLAG_Y				0x02
+#define VOLATILE_SNAPSHOT_FLAG_YAW				0x04
+#define VOLATILE_SNAPSHOT_FLAG_PITCH_ROLL		0x08
+#define VOLATILE_SNAPSHOT_UNITS_PER_METER		100.f
+
 /** 安全的释放一个指针内存 */
 #define KBE_SAFE_RELEASE(i)									\
 	if (i)													\
@@ -433,6 +433,11 @@ void KBEngineApp::hello()
 	(*pBundle) << clientVersion_;
 	(*pBundle) << clientScriptVersion_;
 	pBundle->appendBlob(encryptedKey_);
+
+	// 不使用压缩， 声明客户端能够解析onUpdateVolatileSnapshot
+	(*pBundle) << (uint8)0;
+	(*pBundle) << (uint32)0;
+	(*pBundle) << (uint32)CLIENT_FEATURE_VOLATILE_SNAPSHOT;
 	pBundle->send(pNetworkInterface_);
 }
 
@@ -1254,6 +1259,154 @@ void KBEngineApp::Client_onControlEntity(ENTITY_ID eid, int8 isControlled)
 	KBENGINE_EVENT_FIRE("onControlled", pEventData);
 }
 
+void KBEngineApp::Client_onUpdateVolatileBase(MemoryStream& stream)
+{
+	ENTITY_ID eid = getViewEntityIDFromStream(stream);
+
+	int32 x = stream.read<int32>();
+	int32 y = stream.read<int32>();
+	int32 z = stream.read<int32>();
+
+	Entity** pEntityFind = entities_.Find(eid);
+
+	if (!pEntityFind)
+	{
+		ERROR_MSG("KBEngineApp::Client_onUpdateVolatileBase(): entity(%d) not found!", eid);
+		return;
+	}
+
+	// 位置由随后的快照(增量为0)设置
+	Entity& entity = *(*pEntityFind);
+	entity.volatileBase[0] = x;
+	entity.volatileBase[1] = y;
+	entity.volatileBase[2] = z;
+	entity.hasVolatileBase = true;
+}
+
+void KBEngineApp::Client_onUpdateVolatileSnapshot(MemoryStream& stream)
+{
+	uint8 slotCount = stream.read<uint8>();
+
+	uint8 masks[32];
+	int count = 0;
+
+	for (int i = 0; i < (slotCount + 7) / 8; ++i)
+	{
+		masks[i] = stream.read<uint8>();
+
+		for (uint8 bits = masks[i]; bits; bits &= bits - 1)
+			++count;
+	}
+
+	// 每个字节包含两个实体的标记， 低4位在前
+	uint8 flags[256];
+	for (int i = 0; i < count; i += 2)
+	{
+		uint8 nibbles = stream.read<uint8>();
+		flags[i] = nibbles & 0x0f;
+		flags[i + 1] = nibbles >> 4;
+	}
+
+	int n = 0;
+	for (int slot = 0; slot < slotCount; ++slot)
+	{
+		if ((masks[slot >> 3] & (1 << (slot & 7))) == 0)
+			continue;
+
+		uint8 f = flags[n++];
+		int16 delta[3] = { 0, 0, 0 };
+		int8 yaw = 0, pitch = 0, roll = 0;
+
+		if ((f & VOLATILE_SNAPSHOT_FLAG_XZ) > 0)
+		{
+			delta[0] = stream.read<int16>();
+			delta[2] = stream.read<int16>();
+		}
+
+		if ((f & VOLATILE_SNAPSHOT_FLAG_Y) > 0)
+			delta[1] = stream.read<int16>();
+
+		if ((f & VOLATILE_SNAPSHOT_FLAG_YAW) > 0)
+			yaw = stream.read<int8>();
+
+		if ((f & VOLATILE_SNAPSHOT_FLAG_PITCH_ROLL) > 0)
+		{
+			pitch = stream.read<int8>();
+			roll = stream.read<int8>();
+		}
+
+		// 与getViewEntityIDFromStream相同， 重连时可能收到未初始化的别名
+		if (slot >= entityIDAliasIDList_.Num())
+			continue;
+
+		_updateVolatileSnapshot(entityIDAliasIDList_[slot], f, delta, yaw, pitch, roll);
+	}
+}
+
+void KBEngineApp::_updateVolatileSnapshot(ENTITY_ID entityID, uint8 flags, const int16* delta, int8 yaw, int8 pitch, int8 roll)
+{
+	Entity** pEntityFind = entities_.Find(entityID);
+
+	if (!pEntityFind)
+	{
+		ERROR_MSG("KBEngineApp::Client_onUpdateVolatileSnapshot(): entity(%d) not found!", entityID);
+		return;
+	}
+
+	Entity& entity = *(*pEntityFind);
+	bool done = false;
+
+	if ((flags & (VOLATILE_SNAPSHOT_FLAG_YAW | VOLATILE_SNAPSHOT_FLAG_PITCH_ROLL)) > 0)
+	{
+		if ((flags & VOLATILE_SNAPSHOT_FLAG_YAW) > 0)
+			entity.direction.Z = int82angle(yaw, false);
+
+		if ((flags & VOLATILE_SNAPSHOT_FLAG_PITCH_ROLL) > 0)
+		{
+			entity.direction.Y = int82angle(pitch, false);
+			entity.direction.X = int82angle(roll, false);
+		}
+
+		UKBEventData_set_direction* pEventData = NewObject<UKBEventData_set_direction>();
+		pEventData->direction = entity.direction;
+		pEventData->entityID = entity.id();
+		KBENGINE_EVENT_FIRE("set_direction", pEventData);
+
+		done = true;
+	}
+
+	if ((flags & VOLATILE_SNAPSHOT_FLAG_XZ) > 0)
+	{
+		if (!entity.hasVolatileBase)
+		{
+			ERROR_MSG("KBEngineApp::Client_onUpdateVolatileSnapshot(): entity(%d) has no base position!", entityID);
+		}
+		else
+		{
+			// 快照中的位置是绝对坐标， 不需要加上entityServerPos_
+			int32* base = entity.volatileBase;
+			base[0] += delta[0];
+			base[1] += delta[1];
+			base[2] += delta[2];
+
+			entity.isOnGround((flags & VOLATILE_SNAPSHOT_FLAG_Y) == 0);
+			entity.position = FVector(base[0] / VOLATILE_SNAPSHOT_UNITS_PER_METER, 
+				base[1] / VOLATILE_SNAPSHOT_UNITS_PER_METER, base[2] / VOLATILE_SNAPSHOT_UNITS_PER_METER);
+			done = true;
+
+			UKBEventData_updatePosition* pEventData = NewObject<UKBEventData_updatePosition>();
+			KBPos2UE4Pos(pEventData->position, entity.position);
+			pEventData->entityID = entity.id();
+			pEventData->moveSpeed = entity.velocity();
+			pEventData->isOnGround = entity.isOnGround();
+			KBENGINE_EVENT_FIRE("updatePosition", pEventData);
+		}
+	}
+
+	if (done)
+		entity.onUpdateVolatileData();
+}
+
 void KBEngineApp::Client_onStreamDataStarted(int16 id, uint32 datasize, FString descr)
 {
 	UKBEventData_onStreamDataStarted* pEventData = NewObject<UKBEventData_onStreamDataStarted>();
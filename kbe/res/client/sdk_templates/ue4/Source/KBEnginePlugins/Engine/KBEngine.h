@@ -313,8 +313,16 @@ public:
 	void Client_onUpdateData_xyz_p(MemoryStream& stream);
 	void Client_onUpdateData_xyz_r(MemoryStream& stream);
 
+	/*
+		服务端设置实体onUpdateVolatileSnapshot增量的基准位置(厘米)
+		服务端一次同步View内多个实体的位置与朝向， 槽位即实体的别名ID
+	*/
+	void Client_onUpdateVolatileBase(MemoryStream& stream);
+	void Client_onUpdateVolatileSnapshot(MemoryStream& stream);
+
 private:
 	void _updateVolatileData(ENTITY_ID entityID, float x, float y, float z, float yaw, float pitch, float roll, int8 isOnGround);
+	void _updateVolatileSnapshot(ENTITY_ID entityID, uint8 flags, const int16* delta, int8 yaw, int8 pitch, int8 roll);
 
 	bool initNetwork();
 
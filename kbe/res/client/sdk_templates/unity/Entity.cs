@@ -16,6 +16,10 @@
 		public Vector3 _entityLastLocalPos = new Vector3(0f, 0f, 0f);
 		public Vector3 _entityLastLocalDir = new Vector3(0f, 0f, 0f);
 		
+		// onUpdateVolatileSnapshot增量的基准位置(厘米)，由onUpdateVolatileBase设置
+		// 这个属性是给引擎KBEngine.cs用的，别的地方不要修改
+		public Int32[] _volatileBase = null;
+		
     	public Int32 id = 0;
 		public string className = "";
 		public Vector3 position = new Vector3(0.0f, 0.0f, 0.0f);
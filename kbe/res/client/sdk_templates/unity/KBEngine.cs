@@ -101,6 +101,18 @@
 		// https://github.com/kbengine/kbengine/tree/master/docs/api
 		public Dictionary<Int32, Entity> entities = new Dictionary<Int32, Entity>();
 		
+		// 客户端在hello中声明的可选特性， 与服务端network/common.h中的定义一致
+		public const UInt32 CLIENT_FEATURE_VOLATILE_SNAPSHOT = 0x00000001;
+		
+		// onUpdateVolatileSnapshot中每个实体的字段标记
+		public const byte VOLATILE_SNAPSHOT_FLAG_XZ = 0x01;
+		public const byte VOLATILE_SNAPSHOT_FLAG_Y = 0x02;
+		public const byte VOLATILE_SNAPSHOT_FLAG_YAW = 0x04;
+		public const byte VOLATILE_SNAPSHOT_FLAG_PITCH_ROLL = 0x08;
+		
+		// 快照中的坐标单位为厘米
+		public const float VOLATILE_SNAPSHOT_UNITS_PER_METER = 100.0f;
+		
 		// 在玩家View范围小于256个实体时我们可以通过一字节索引来找到entity
 		private List<Int32> _entityIDAliasIDList = new List<Int32>();
 		private Dictionary<Int32, MemoryStream> _bufferedCreateEntityMessages = new Dictionary<Int32, MemoryStream>(); 
@@ -355,6 +367,11 @@
 			bundle.writeString(clientVersion);
 			bundle.writeString(clientScriptVersion);
 			bundle.writeBlob(_encryptedKey);
+			
+			// 不使用压缩， 声明客户端能够解析onUpdateVolatileSnapshot
+			bundle.writeUint8(0);
+			bundle.writeUint32(0);
+			bundle.writeUint32(CLIENT_FEATURE_VOLATILE_SNAPSHOT);
 			bundle.send(_networkInterface);
 		}
 
@@ -1894,6 +1911,148 @@
 				entity.onUpdateVolatileData();
 		}
 		
+		/*
+			服务端设置实体onUpdateVolatileSnapshot增量的基准位置(厘米)
+			随后的快照(增量为0)会设置实体的位置
+		*/
+		public void Client_onUpdateVolatileBase(MemoryStream stream)
+		{
+			Int32 eid = getViewEntityIDFromStream(stream);
+			
+			Int32 x = stream.readInt32();
+			Int32 y = stream.readInt32();
+			Int32 z = stream.readInt32();
+			
+			Entity entity = null;
+
+			if(!entities.TryGetValue(eid, out entity))
+			{
+				Dbg.ERROR_MSG("KBEngine::Client_onUpdateVolatileBase: entity(" + eid + ") not found!");
+				return;
+			}
+			
+			entity._volatileBase = new Int32[]{x, y, z};
+		}
+		
+		/*
+			服务端一次同步View内多个实体的位置与朝向
+			格式: uint8 slotCount, 存在掩码, 每个实体4位的字段标记(低4位在前), 之后按槽位顺序是每个实体的字段
+			槽位即实体的别名ID
+		*/
+		public void Client_onUpdateVolatileSnapshot(MemoryStream stream)
+		{
+			int slotCount = stream.readUint8();
+			
+			byte[] masks = new byte[(slotCount + 7) / 8];
+			int count = 0;
+			
+			for(int i = 0; i < masks.Length; ++i)
+			{
+				masks[i] = stream.readUint8();
+				
+				for(int bits = masks[i]; bits != 0; bits &= bits - 1)
+					++count;
+			}
+			
+			// 每个字节包含两个实体的标记， 低4位在前
+			byte[] flags = new byte[count + 1];
+			for(int i = 0; i < count; i += 2)
+			{
+				byte nibbles = stream.readUint8();
+				flags[i] = (byte)(nibbles & 0x0f);
+				flags[i + 1] = (byte)(nibbles >> 4);
+			}
+			
+			int n = 0;
+			for(int slot = 0; slot < slotCount; ++slot)
+			{
+				if((masks[slot >> 3] & (1 << (slot & 7))) == 0)
+					continue;
+				
+				byte f = flags[n++];
+				Int16 dx = 0, dy = 0, dz = 0;
+				SByte yaw = 0, pitch = 0, roll = 0;
+				
+				if((f & VOLATILE_SNAPSHOT_FLAG_XZ) > 0)
+				{
+					dx = stream.readInt16();
+					dz = stream.readInt16();
+				}
+				
+				if((f & VOLATILE_SNAPSHOT_FLAG_Y) > 0)
+					dy = stream.readInt16();
+				
+				if((f & VOLATILE_SNAPSHOT_FLAG_YAW) > 0)
+					yaw = stream.readInt8();
+				
+				if((f & VOLATILE_SNAPSHOT_FLAG_PITCH_ROLL) > 0)
+				{
+					pitch = stream.readInt8();
+					roll = stream.readInt8();
+				}
+				
+				// 与getViewEntityIDFromStream相同， 重连时可能收到未初始化的别名
+				if(slot >= _entityIDAliasIDList.Count)
+					continue;
+				
+				_updateVolatileSnapshot(_entityIDAliasIDList[slot], f, dx, dy, dz, yaw, pitch, roll);
+			}
+		}
+		
+		private void _updateVolatileSnapshot(Int32 entityID, byte flags, Int16 dx, Int16 dy, Int16 dz, SByte yaw, SByte pitch, SByte roll)
+		{
+			Entity entity = null;
+
+			if(!entities.TryGetValue(entityID, out entity))
+			{
+				Dbg.ERROR_MSG("KBEngine::Client_onUpdateVolatileSnapshot: entity(" + entityID + ") not found!");
+				return;
+			}
+			
+			bool done = false;
+			
+			if((flags & (VOLATILE_SNAPSHOT_FLAG_YAW | VOLATILE_SNAPSHOT_FLAG_PITCH_ROLL)) > 0)
+			{
+				if((flags & VOLATILE_SNAPSHOT_FLAG_YAW) > 0)
+					entity.direction.z = KBEMath.int82angle(yaw, false) * 360 / ((float)System.Math.PI * 2);
+				
+				if((flags & VOLATILE_SNAPSHOT_FLAG_PITCH_ROLL) > 0)
+				{
+					entity.direction.y = KBEMath.int82angle(pitch, false) * 360 / ((float)System.Math.PI * 2);
+					entity.direction.x = KBEMath.int82angle(roll, false) * 360 / ((float)System.Math.PI * 2);
+				}
+				
+				Event.fireOut("set_direction", new object[]{entity});
+				done = true;
+			}
+			
+			if((flags & VOLATILE_SNAPSHOT_FLAG_XZ) > 0)
+			{
+				Int32[] b = entity._volatileBase;
+				if(b == null)
+				{
+					Dbg.ERROR_MSG("KBEngine::Client_onUpdateVolatileSnapshot: entity(" + entityID + ") has no base position!");
+				}
+				else
+				{
+					// 快照中的位置是绝对坐标， 不需要加上_entityServerPos
+					b[0] += dx;
+					b[1] += dy;
+					b[2] += dz;
+					
+					entity.isOnGround = (flags & VOLATILE_SNAPSHOT_FLAG_Y) == 0;
+					entity.position = new Vector3(b[0] / VOLATILE_SNAPSHOT_UNITS_PER_METER, 
+						b[1] / VOLATILE_SNAPSHOT_UNITS_PER_METER, b[2] / VOLATILE_SNAPSHOT_UNITS_PER_METER);
+					
+					Event.fireOut("updatePosition", new object[]{entity});
+					done = true;
+				}
+			}
+			
+			if(done)
+				entity.onUpdateVolatileData();
+		}
+		
 		/*
 			服务端通知流数据下载开始
 			请参考API手册关于onStreamDataStarted
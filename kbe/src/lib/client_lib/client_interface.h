@@ -208,6 +208,14 @@ NETWORK_INTERFACE_DECLARE_BEGIN(ClientInterface)
 	// 服务器心跳回调
 	CLIENT_MESSAGE_DECLARE_ARGS0(onAppActiveTickCB,							NETWORK_FIXED_MESSAGE)
 
+	// 服务器增量更新entity的容器属性
+	CLIENT_MESSAGE_DECLARE_STREAM(onUpdatePropertyPatch,					NETWORK_VARIABLE_MESSAGE)
+	CLIENT_MESSAGE_DECLARE_STREAM(onUpdatePropertyPatchOptimized,			NETWORK_VARIABLE_MESSAGE)
+
+	// 服务器每tick打包更新视野内entity的位置与朝向(增量)， 以及重置增量的基准位置
+	CLIENT_MESSAGE_DECLARE_STREAM(onUpdateVolatileSnapshot,					NETWORK_VARIABLE_MESSAGE)
+	CLIENT_MESSAGE_DECLARE_STREAM(onUpdateVolatileBase,						NETWORK_VARIABLE_MESSAGE)
+
 	NETWORK_INTERFACE_DECLARE_END()
 
 #ifdef DEFINE_IN_INTERFACE
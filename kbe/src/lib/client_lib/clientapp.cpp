@@ -28,6 +28,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "network/channel.h"
 #include "network/tcp_packet_sender.h"
 #include "network/tcp_packet_receiver.h"
+#include "network/compression_filter.h"
 #include "thread/threadpool.h"
 #include "entitydef/entity_call.h"
 #include "entitydef/entity_component.h"
@@ -67,7 +68,7 @@ dispatcher_(dispatcher),
 networkInterface_(ninterface),
 pTCPPacketSender_(NULL),
 pTCPPacketReceiver_(NULL),
-pBlowfishFilter_(NULL),
+pEncryptionFilter_(NULL),
 threadPool_(),
 entryScript_(),
 state_(C_STATE_INIT)
@@ -89,7 +90,7 @@ state_(C_STATE_INIT)
 ClientApp::~ClientApp()
 {
 	EntityCallAbstract::resetCallHooks();
-	SAFE_RELEASE(pBlowfishFilter_);
+	SAFE_RELEASE(pEncryptionFilter_);
 }
 
 //-------------------------------------------------------------------------------------		
@@ -110,7 +111,7 @@ void ClientApp::reset(void)
 
 	SAFE_RELEASE(pTCPPacketSender_);
 	SAFE_RELEASE(pTCPPacketReceiver_);
-	SAFE_RELEASE(pBlowfishFilter_);
+	SAFE_RELEASE(pEncryptionFilter_);
 
 	ClientObjectBase::reset();
 }
@@ -420,11 +421,13 @@ void ClientApp::handleGameTick()
 					(*pBundle) << KBEVersion::versionString();
 					(*pBundle) << KBEVersion::scriptVersionString();
 
-					if(Network::g_channelExternalEncryptType == 1)
+					// 去掉与loginapp通信时安装的过滤器
+					pServerChannel_->pFilter(NULL);
+
+					pEncryptionFilter_ = Network::createClientEncryptionFilter(Network::g_channelExternalEncryptType);
+					if(pEncryptionFilter_)
 					{
-						pBlowfishFilter_ = new Network::BlowfishFilter();
-						(*pBundle).appendBlob(pBlowfishFilter_->key());
-						pServerChannel_->pFilter(NULL);
+						(*pBundle).appendBlob(pEncryptionFilter_->key());
 					}
 					else
 					{
@@ -432,6 +435,9 @@ void ClientApp::handleGameTick()
 						(*pBundle).appendBlob(key);
 					}
 
+					Network::addCompressionOffer(*pBundle, EntityDef::compressionDictionary());
+					(*pBundle) << (uint32)CLIENT_FEATURE_VOLATILE_SNAPSHOT;
+
 					pServerChannel_->pEndPoint()->send(pBundle);
 					Network::Bundle::reclaimPoolObject(pBundle);
 					// ret = ClientObjectBase::loginBaseapp();
@@ -677,10 +683,10 @@ bool ClientApp::login(std::string accountName, std::string passwd, std::string d
 		(*pBundle) << KBEVersion::versionString();
 		(*pBundle) << KBEVersion::scriptVersionString();
 
-		if(Network::g_channelExternalEncryptType == 1)
+		pEncryptionFilter_ = Network::createClientEncryptionFilter(Network::g_channelExternalEncryptType);
+		if(pEncryptionFilter_)
 		{
-			pBlowfishFilter_ = new Network::BlowfishFilter();
-			(*pBundle).appendBlob(pBlowfishFilter_->key());
+			(*pBundle).appendBlob(pEncryptionFilter_->key());
 		}
 		else
 		{
@@ -688,6 +694,9 @@ bool ClientApp::login(std::string accountName, std::string passwd, std::string d
 			(*pBundle).appendBlob(key);
 		}
 
+		Network::addCompressionOffer(*pBundle, EntityDef::compressionDictionary());
+		(*pBundle) << (uint32)CLIENT_FEATURE_VOLATILE_SNAPSHOT;
+
 		pServerChannel_->pEndPoint()->send(pBundle);
 		Network::Bundle::reclaimPoolObject(pBundle);
 		//ret = ClientObjectBase::login();
@@ -701,10 +710,10 @@ void ClientApp::onHelloCB_(Network::Channel* pChannel, const std::string& verInf
 		const std::string& scriptVerInfo, const std::string& protocolMD5, const std::string& entityDefMD5, 
 		COMPONENT_TYPE componentType)
 {
-	if(Network::g_channelExternalEncryptType == 1)
+	if(pEncryptionFilter_)
 	{
-		pServerChannel_->pFilter(pBlowfishFilter_);
-		pBlowfishFilter_ = NULL;
+		pServerChannel_->pFilter(pEncryptionFilter_);
+		pEncryptionFilter_ = NULL;
 	}
 
 	if(componentType == LOGINAPP_TYPE)
@@ -263,7 +263,7 @@ protected:
 	
 	Network::TCPPacketSender*								pTCPPacketSender_;
 	Network::TCPPacketReceiver*								pTCPPacketReceiver_;
-	Network::BlowfishFilter*								pBlowfishFilter_;
+	Network::EncryptionFilter*								pEncryptionFilter_;
 
 	// 线程池
 	thread::ThreadPool										threadPool_;
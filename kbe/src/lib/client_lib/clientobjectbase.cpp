@@ -20,12 +20,14 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "entity.h"
 #include "config.h"
+#include "common.h"
 #include "clientobjectbase.h"
 #include "pyscript/pywatcher.h"
 #include "network/channel.h"
 #include "network/fixed_messages.h"
 #include "network/common.h"
 #include "network/message_handler.h"
+#include "network/compression_filter.h"
 #include "entitydef/scriptdef_module.h"
 #include "entitydef/entity_call.h"
 #include "entitydef/entitydef.h"
@@ -154,6 +156,7 @@ void ClientObjectBase::reset(void)
 	serverDatas_ = "";
 
 	bufferedCreateEntityMessage_.clear();
+	volatileDirtyEntities_.clear();
 	canReset_ = false;
 	locktime_ = 0;
 
@@ -183,6 +186,7 @@ void ClientObjectBase::onServerClosed()
 void ClientObjectBase::tickSend()
 {
 	handleTimers();
+	fireVolatileEvents();
 
 	if(!pServerChannel_ || !pServerChannel_->pEndPoint())
 		return;
@@ -579,10 +583,24 @@ void ClientObjectBase::onHelloCB(Network::Channel* pChannel, MemoryStream& s)
 	COMPONENT_TYPE ctype;
 	s >> ctype;
 
+	// 服务端同意压缩时会在末尾附带压缩类别与字典标识
+	uint8 compressType = 0;
+	uint32 compressDictionaryID = 0;
+
+	if(s.length() >= sizeof(compressType) + sizeof(compressDictionaryID))
+		s >> compressType >> compressDictionaryID;
+
 	INFO_MSG(fmt::format("ClientObjectBase::onHelloCB: verInfo={}, scriptVerInfo={}, protocolMD5={}, entityDefMD5={}, addr:{}\n",
 		verInfo, scriptVerInfo, protocolMD5, entityDefMD5, pChannel->c_str()));
 
 	onHelloCB_(pChannel, verInfo, scriptVerInfo, protocolMD5, entityDefMD5, ctype);
+
+	// 压缩过滤器叠加在onHelloCB_中安装的加密过滤器之上
+	if(compressType > 0)
+	{
+		pChannel->pushFilter(Network::createCompressionFilter(compressType, 
+			compressDictionaryID, EntityDef::compressionDictionary()));
+	}
 }
 
 //-------------------------------------------------------------------------------------	
@@ -1163,6 +1181,36 @@ void ClientObjectBase::onUpdatePropertys_(ENTITY_ID eid, MemoryStream& s)
 	entity->onUpdatePropertys(s);
 }
 
+//-------------------------------------------------------------------------------------
+void ClientObjectBase::onUpdatePropertyPatch(Network::Channel * pChannel, MemoryStream& s)
+{
+	ENTITY_ID eid = 0;
+	s >> eid;
+	onUpdatePropertyPatch_(eid, s);
+}
+
+//-------------------------------------------------------------------------------------
+void ClientObjectBase::onUpdatePropertyPatchOptimized(Network::Channel * pChannel, MemoryStream& s)
+{
+	ENTITY_ID eid = getViewEntityIDFromStream(s);
+	onUpdatePropertyPatch_(eid, s);
+}
+
+//-------------------------------------------------------------------------------------
+void ClientObjectBase::onUpdatePropertyPatch_(ENTITY_ID eid, MemoryStream& s)
+{
+	client::Entity* entity = pEntities_->find(eid);
+	if(entity == NULL)
+	{	
+		// 补丁只能作用在已有的属性值上， 实体创建时会收到完整的属性
+		ERROR_MSG(fmt::format("ClientObjectBase::onUpdatePropertyPatch: not found entity({}).\n", eid));
+		s.done();
+		return;
+	}
+
+	entity->onUpdatePropertyPatch(s);
+}
+
 //-------------------------------------------------------------------------------------
 client::Entity* ClientObjectBase::pPlayer()
 {
@@ -1215,9 +1263,12 @@ void ClientObjectBase::updatePlayerToServer()
 	Vector3 movement = pos - clientPos;
 	bool posChanged =  KBEVec3Length(&movement) > 0.0004f;
 
+	// 玩家与所有controlled entity的更新合并到一个bundle中发送
+	Network::Bundle* pBundle = NULL;
+
     if(posChanged || dirChanged)
     {
-        Network::Bundle* pBundle = Network::Bundle::createPoolObject();
+        pBundle = Network::Bundle::createPoolObject();
         (*pBundle).newMessage(BaseappInterface::onUpdateDataFromClient);
 
         pEntity->position(clientPos);
@@ -1233,7 +1284,6 @@ void ClientObjectBase::updatePlayerToServer()
 
         (*pBundle) << pEntity->isOnGround();
         (*pBundle) << spaceID_;
-        pServerChannel_->send(pBundle);
     }
 
     // 同步所有controlled entity的位置与朝向
@@ -1255,22 +1305,25 @@ void ClientObjectBase::updatePlayerToServer()
             entity->position(tempClientPos);
             entity->direction(tempClientDir);
 
-            Network::Bundle *tempBundle = Network::Bundle::createPoolObject();
-            (*tempBundle).newMessage(BaseappInterface::onUpdateDataFromClientForControlledEntity);
+            if(pBundle == NULL)
+                pBundle = Network::Bundle::createPoolObject();
 
-            (*tempBundle) << entity->id();
-            (*tempBundle) << temppos.x;
-            (*tempBundle) << temppos.y;
-            (*tempBundle) << temppos.z;
-            (*tempBundle) << tempdir.roll();
-            (*tempBundle) << tempdir.pitch();
-            (*tempBundle) << tempdir.yaw();
-            (*tempBundle) << entity->isOnGround();
-            (*tempBundle) << spaceID_;
+            (*pBundle).newMessage(BaseappInterface::onUpdateDataFromClientForControlledEntity);
 
-            pServerChannel_->send(tempBundle);
+            (*pBundle) << entity->id();
+            (*pBundle) << temppos.x;
+            (*pBundle) << temppos.y;
+            (*pBundle) << temppos.z;
+            (*pBundle) << tempdir.roll();
+            (*pBundle) << tempdir.pitch();
+            (*pBundle) << tempdir.yaw();
+            (*pBundle) << entity->isOnGround();
+            (*pBundle) << spaceID_;
         }
     }
+
+    if(pBundle)
+        pServerChannel_->send(pBundle);
 }
 
 //-------------------------------------------------------------------------------------
@@ -1859,7 +1912,8 @@ void ClientObjectBase::_updateVolatileData(ENTITY_ID entityID, float x, float y,
 		basepos += relativePos;
 		
 		// DEBUG_MSG(fmt::format("ClientObjectBase::_updateVolatileData: {}-{}-{}--{}-{}-{}-\n", x, y, z, basepos.x, basepos.y, basepos.z));
-		entity->position(basepos);
+		if(entity->volatilePosition(basepos))
+			volatileDirtyEntities_.push_back(entityID);
 	}
 
 	Direction3D dir = entity->direction();
@@ -1874,7 +1928,166 @@ void ClientObjectBase::_updateVolatileData(ENTITY_ID entityID, float x, float y,
 		dir.roll(roll);
 
 	if(yaw != FLT_MAX || pitch != FLT_MAX || roll != FLT_MAX)
-		entity->direction(dir);
+	{
+		if(entity->volatileDirection(dir))
+			volatileDirtyEntities_.push_back(entityID);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void ClientObjectBase::fireVolatileEvents()
+{
+	if(volatileDirtyEntities_.empty())
+		return;
+
+	// 事件回调中可能再次收包或销毁实体， 先交换出来再派发
+	std::vector<ENTITY_ID> dirtyEntities;
+	dirtyEntities.swap(volatileDirtyEntities_);
+
+	std::vector<ENTITY_ID>::iterator iter = dirtyEntities.begin();
+	for(; iter != dirtyEntities.end(); ++iter)
+	{
+		// 实体可能已在本帧被销毁
+		client::Entity* entity = pEntities_->find((*iter));
+		if(entity == NULL)
+			continue;
+
+		entity->fireVolatileEvents();
+	}
+
+	// 保留容量， 避免每帧重新分配
+	if(volatileDirtyEntities_.empty())
+	{
+		dirtyEntities.clear();
+		volatileDirtyEntities_.swap(dirtyEntities);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void ClientObjectBase::onUpdateVolatileBase(Network::Channel* pChannel, MemoryStream& s)
+{
+	ENTITY_ID eid = getViewEntityIDFromStream(s);
+
+	int32 x, y, z;
+	s >> x >> y >> z;
+
+	client::Entity* entity = pEntities_->find(eid);
+	if(entity == NULL)
+	{
+		ERROR_MSG(fmt::format("ClientObjectBase::onUpdateVolatileBase: not found entity({}).\n", eid));
+		return;
+	}
+
+	// 位置由随后的快照(增量为0)设置
+	entity->volatileBase(x, y, z);
+}
+
+//-------------------------------------------------------------------------------------
+void ClientObjectBase::onUpdateVolatileSnapshot(Network::Channel* pChannel, MemoryStream& s)
+{
+	uint8 slotCount = 0;
+	s >> slotCount;
+
+	uint8 masks[32];
+	int count = 0;
+
+	for(int i = 0; i < (slotCount + 7) / 8; ++i)
+	{
+		s >> masks[i];
+
+		for(uint8 bits = masks[i]; bits; bits &= bits - 1)
+			++count;
+	}
+
+	// 每个字节包含两个实体的标记， 低4位在前
+	uint8 flags[256];
+	for(int i = 0; i < count; i += 2)
+	{
+		uint8 nibbles = 0;
+		s >> nibbles;
+
+		flags[i] = nibbles & 0x0f;
+		flags[i + 1] = nibbles >> 4;
+	}
+
+	int n = 0;
+	for(int slot = 0; slot < slotCount; ++slot)
+	{
+		if((masks[slot >> 3] & (1 << (slot & 7))) == 0)
+			continue;
+
+		uint8 f = flags[n++];
+		int16 delta[3] = { 0, 0, 0 };
+		int8 yaw = 0, pitch = 0, roll = 0;
+
+		if((f & VOLATILE_SNAPSHOT_FLAG_XZ) > 0)
+			s >> delta[0] >> delta[2];
+
+		if((f & VOLATILE_SNAPSHOT_FLAG_Y) > 0)
+			s >> delta[1];
+
+		if((f & VOLATILE_SNAPSHOT_FLAG_YAW) > 0)
+			s >> yaw;
+
+		if((f & VOLATILE_SNAPSHOT_FLAG_PITCH_ROLL) > 0)
+			s >> pitch >> roll;
+
+		// 与getViewEntityIDFromStream相同， 重连时可能收到未初始化的别名
+		if((size_t)slot >= pEntityIDAliasIDList_.size())
+			continue;
+
+		_updateVolatileSnapshot(pEntityIDAliasIDList_[slot], f, delta, yaw, pitch, roll);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void ClientObjectBase::_updateVolatileSnapshot(ENTITY_ID entityID, uint8 flags, const int16* delta, 
+	int8 yaw, int8 pitch, int8 roll)
+{
+	client::Entity* entity = pEntities_->find(entityID);
+	if(entity == NULL)
+	{
+		ERROR_MSG(fmt::format("ClientObjectBase::onUpdateVolatileSnapshot: not found entity({}).\n", entityID));
+		return;
+	}
+
+	if((flags & VOLATILE_SNAPSHOT_FLAG_XZ) > 0)
+	{
+		if(!entity->hasVolatileBase())
+		{
+			ERROR_MSG(fmt::format("ClientObjectBase::onUpdateVolatileSnapshot: entity({}) has no base position.\n", entityID));
+		}
+		else
+		{
+			const int32* base = entity->volatileBase();
+			int32 x = base[0] + delta[0];
+			int32 y = base[1] + delta[1];
+			int32 z = base[2] + delta[2];
+
+			entity->volatileBase(x, y, z);
+			entity->isOnGround((flags & VOLATILE_SNAPSHOT_FLAG_Y) == 0);
+			if(entity->volatilePosition(Position3D(x / VOLATILE_SNAPSHOT_UNITS_PER_METER, 
+				y / VOLATILE_SNAPSHOT_UNITS_PER_METER, z / VOLATILE_SNAPSHOT_UNITS_PER_METER)))
+				volatileDirtyEntities_.push_back(entityID);
+		}
+	}
+
+	if((flags & (VOLATILE_SNAPSHOT_FLAG_YAW | VOLATILE_SNAPSHOT_FLAG_PITCH_ROLL)) > 0)
+	{
+		Direction3D dir = entity->direction();
+
+		if((flags & VOLATILE_SNAPSHOT_FLAG_YAW) > 0)
+			dir.yaw(int82angle(yaw));
+
+		if((flags & VOLATILE_SNAPSHOT_FLAG_PITCH_ROLL) > 0)
+		{
+			dir.pitch(int82angle(pitch));
+			dir.roll(int82angle(roll));
+		}
+
+		if(entity->volatileDirection(dir))
+			volatileDirtyEntities_.push_back(entityID);
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -258,6 +258,13 @@ public:
 	virtual void onUpdatePropertysOptimized(Network::Channel* pChannel, MemoryStream& s);
 	void onUpdatePropertys_(ENTITY_ID eid, MemoryStream& s);
 
+	/** 网络接口
+		服务器增量更新entity的容器属性
+	*/
+	virtual void onUpdatePropertyPatch(Network::Channel* pChannel, MemoryStream& s);
+	virtual void onUpdatePropertyPatchOptimized(Network::Channel* pChannel, MemoryStream& s);
+	void onUpdatePropertyPatch_(ENTITY_ID eid, MemoryStream& s);
+
 	/** 网络接口
 		服务器强制设置entity的位置与朝向
 	*/
@@ -304,6 +311,19 @@ public:
 	void _updateVolatileData(ENTITY_ID entityID, float x, float y, float z, float roll, 
 		float pitch, float yaw, int8 isOnGround);
 
+	/** 网络接口
+		服务器每tick打包更新VolatileData， 坐标为相对于基准位置的增量
+	*/
+	virtual void onUpdateVolatileSnapshot(Network::Channel* pChannel, MemoryStream& s);
+	virtual void onUpdateVolatileBase(Network::Channel* pChannel, MemoryStream& s);
+	void _updateVolatileSnapshot(ENTITY_ID entityID, uint8 flags, const int16* delta, 
+		int8 yaw, int8 pitch, int8 roll);
+
+	/** 
+		派发本帧收到的位置与朝向同步事件， 每个实体每帧最多一次
+	*/
+	void fireVolatileEvents();
+
 	/** 
 		更新玩家到服务端 
 	*/
@@ -459,6 +479,9 @@ protected:
 	typedef std::map<ENTITY_ID, KBEShared_ptr<MemoryStream> > BUFFEREDMESSAGE;
 	BUFFEREDMESSAGE											bufferedCreateEntityMessage_;
 
+	// 本帧位置或朝向被服务器更新、尚未派发事件的实体
+	std::vector<ENTITY_ID>									volatileDirtyEntities_;
+
 	EventHandler											eventHandler_;
 
 	Network::NetworkInterface&								networkInterface_;
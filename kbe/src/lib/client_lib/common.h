@@ -29,6 +29,18 @@ namespace KBEngine{
 #define CLIENT_COMMON_NETWORK_MESSAGE_MACRO()													\
 	NULL																						\
 
+/**
+	onUpdateVolatileSnapshot中每个实体的4位标记
+	坐标为相对于上次发送值的增量(int16, 厘米)， 朝向为int8角度
+*/
+#define VOLATILE_SNAPSHOT_FLAG_XZ			0x01
+#define VOLATILE_SNAPSHOT_FLAG_Y			0x02
+#define VOLATILE_SNAPSHOT_FLAG_YAW			0x04
+#define VOLATILE_SNAPSHOT_FLAG_PITCH_ROLL	0x08
+
+// 快照坐标的量化精度(每米的单位数)
+#define VOLATILE_SNAPSHOT_UNITS_PER_METER	100.f
+
 }
 
 #endif // KBE_CLIENT_COMMON_H
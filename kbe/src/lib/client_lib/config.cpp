@@ -280,6 +280,22 @@ bool Config::loadConfig(std::string fileName)
 		{
 			Network::g_channelExternalEncryptType = xml->getValInt(childnode);
 		}
+
+		childnode = xml->enterNode(rootNode, "compression");
+		if(childnode)
+		{
+			TiXmlNode* childnode1 = xml->enterNode(childnode, "type");
+			if(childnode1)
+				Network::g_channelExternalCompressType = xml->getValInt(childnode1);
+
+			childnode1 = xml->enterNode(childnode, "threshold");
+			if(childnode1)
+				Network::g_channelExternalCompressThreshold = KBE_MAX(0, xml->getValInt(childnode1));
+
+			childnode1 = xml->enterNode(childnode, "level");
+			if(childnode1)
+				Network::g_channelExternalCompressLevel = KBE_MIN(9, KBE_MAX(1, xml->getValInt(childnode1)));
+		}
 	}
 
 	rootNode = xml->getRootNode("telnet_service");
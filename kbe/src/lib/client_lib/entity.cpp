@@ -26,6 +26,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "moveto_point_handler.h"	
 #include "entitydef/entity_call.h"
 #include "entitydef/entity_component.h"
+#include "entitydef/property_patch.h"
 #include "network/channel.h"	
 #include "network/bundle.h"	
 #include "network/fixed_messages.h"
@@ -77,10 +78,13 @@ aspect_(id),
 velocity_(3.0f),
 enterworld_(false),
 isOnGround_(true),
+hasVolatileBase_(false),
+volatileDirtyFlags_(0),
 pMoveHandlerID_(0),
 inited_(false),
 isControlled_(false)
 {
+	volatileBase_[0] = volatileBase_[1] = volatileBase_[2] = 0;
 	ENTITY_INIT_PROPERTYS(Entity);
 	script::PyGC::incTracing("Entity");
 }
@@ -441,6 +445,82 @@ void Entity::onUpdatePropertys(MemoryStream& s)
 	}
 }
 
+//-------------------------------------------------------------------------------------
+void Entity::onUpdatePropertyPatch(MemoryStream& s)
+{
+	EntityDef::context().currClientappID = pClientApp_->appID();
+	EntityDef::context().currEntityID = id();
+	EntityDef::context().currComponentType = CLIENT_TYPE;
+
+	ENTITY_PROPERTY_UID uid;
+	ENTITY_PROPERTY_UID child_uid;
+	PropertyDescription* pPropertyDescription = NULL;
+
+	if(pScriptModule_->usePropertyDescrAlias())
+	{
+		uint8 aliasID = 0;
+		uint8 child_aliasID = 0;
+		s >> aliasID >> child_aliasID;
+		uid = aliasID;
+		child_uid = child_aliasID;
+
+		if(uid == 0)
+			pPropertyDescription = pScriptModule()->findAliasPropertyDescription(child_aliasID);
+	}
+	else
+	{
+		s >> uid >> child_uid;
+
+		if(uid == 0)
+			pPropertyDescription = pScriptModule()->findClientPropertyDescription(child_uid);
+	}
+
+	// 组件属性不会产生补丁
+	if(pPropertyDescription == NULL)
+	{
+		ERROR_MSG(fmt::format("Entity::onUpdatePropertyPatch: not found {}:{}\n", uid, child_uid));
+		s.done();
+		return;
+	}
+
+	uint16 numOps = 0;
+	s >> numOps;
+
+	PyObject* pyValue = PyObject_GetAttrString(this, pPropertyDescription->getName());
+	if(pyValue == NULL)
+	{
+		SCRIPT_ERROR_CHECK();
+		s.done();
+		return;
+	}
+
+	for(uint16 i = 0; i < numOps; ++i)
+	{
+		if(!PropertyPatch::apply(s, pyValue))
+		{
+			ERROR_MSG(fmt::format("Entity::onUpdatePropertyPatch: {}({}) apply patch to {} error!\n", 
+				pScriptModule_->getName(), id(), pPropertyDescription->getName()));
+
+			s.done();
+			break;
+		}
+	}
+
+	// 容器被原地修改， 旧值与新值是同一个对象
+	bool willCallScript = pPropertyDescription->hasBase() ? inited_ : enterworld_;
+	if (willCallScript)
+	{
+		std::string setname = "set_";
+		setname += pPropertyDescription->getName();
+
+		SCRIPT_OBJECT_CALL_ARGS1(this, const_cast<char*>(setname.c_str()),
+			const_cast<char*>("O"), pyValue, false);
+	}
+
+	Py_DECREF(pyValue);
+	SCRIPT_ERROR_CHECK();
+}
+
 //-------------------------------------------------------------------------------------
 void Entity::writeToDB(void* data, void* extra1, void* extra2)
 {
@@ -480,6 +560,19 @@ void Entity::onPositionChanged()
 	pClientApp_->fireEvent(&eventdata);
 }
 
+//-------------------------------------------------------------------------------------
+void Entity::fireVolatileEvents()
+{
+	uint8 flags = volatileDirtyFlags_;
+	volatileDirtyFlags_ = 0;
+
+	if((flags & VOLATILE_DIRTY_POSITION) > 0)
+		onPositionChanged();
+
+	if((flags & VOLATILE_DIRTY_DIRECTION) > 0)
+		onDirectionChanged();
+}
+
 //-------------------------------------------------------------------------------------
 int Entity::pySetDirection(PyObject *value)
 {
@@ -49,6 +49,10 @@ class Channel;
 namespace client
 {
 
+// 服务器同步的位置/朝向待派发事件标记
+#define VOLATILE_DIRTY_POSITION			0x01
+#define VOLATILE_DIRTY_DIRECTION		0x02
+
 class Entity : public script::ScriptObject
 {
 	/** 子类化 将一些py操作填充进派生类 */
@@ -93,6 +97,14 @@ public:
 	INLINE void direction(const Direction3D& dir);
 	void onDirectionChanged();
 	DECLARE_PY_GETSET_METHOD(pyGetDirection, pySetDirection);
+
+	/**
+		服务器同步的位置与朝向只写入数值， 变更事件由fireVolatileEvents在每帧统一派发
+		返回true表示本帧首次被标记， 调用者需要将其加入待派发列表
+	*/
+	INLINE bool volatilePosition(const Position3D& pos);
+	INLINE bool volatileDirection(const Direction3D& dir);
+	void fireVolatileEvents();
 	
 	/**
 		实体客户端的位置和朝向
@@ -176,6 +188,11 @@ public:
 		服务器更新entity属性
 	*/
 	void onUpdatePropertys(MemoryStream& s);
+
+	/**
+		服务器增量更新entity的容器属性
+	*/
+	void onUpdatePropertyPatch(MemoryStream& s);
 	
 	/**
 	    用于Entity的数据第一次设置时，决定是否要回调脚本层的set_*方法
@@ -190,6 +207,17 @@ public:
 	bool isOnGround() const { return isOnGround_;}
 	void isOnGround(bool v) { isOnGround_ = v;}
 
+	/**
+		onUpdateVolatileSnapshot的增量基准位置(厘米)， 与服务端保持一致
+	*/
+	bool hasVolatileBase() const { return hasVolatileBase_; }
+	const int32* volatileBase() const { return volatileBase_; }
+	void volatileBase(int32 x, int32 y, int32 z) 
+	{ 
+		volatileBase_[0] = x; volatileBase_[1] = y; volatileBase_[2] = z; 
+		hasVolatileBase_ = true; 
+	}
+
 	INLINE bool isInited();
 	INLINE void isInited(bool status);
 
@@ -216,6 +244,11 @@ protected:
 	
 	bool									isOnGround_;
 
+	int32									volatileBase_[3];
+	bool									hasVolatileBase_;
+
+	uint8									volatileDirtyFlags_;				// 本帧尚未派发事件的位置/朝向变更
+
 	ScriptID								pMoveHandlerID_;
 	
 	bool									inited_;							// __init__调用之后设置为true
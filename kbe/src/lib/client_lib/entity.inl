@@ -37,6 +37,26 @@ INLINE void Entity::position(const Position3D& pos)
 	onPositionChanged();
 }
 
+//-------------------------------------------------------------------------------------
+INLINE bool Entity::volatilePosition(const Position3D& pos)
+{ 
+	position_ = pos; 
+
+	bool first = volatileDirtyFlags_ == 0;
+	volatileDirtyFlags_ |= VOLATILE_DIRTY_POSITION;
+	return first;
+}
+
+//-------------------------------------------------------------------------------------
+INLINE bool Entity::volatileDirection(const Direction3D& dir)
+{ 
+	direction_ = dir; 
+
+	bool first = volatileDirtyFlags_ == 0;
+	volatileDirtyFlags_ |= VOLATILE_DIRTY_DIRECTION;
+	return first;
+}
+
 //-------------------------------------------------------------------------------------
 INLINE void Entity::serverPosition(const Position3D& pos)
 { 
@@ -0,0 +1,197 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "aesgcm.h"
+#include "helper/debug_helper.h"
+#include "openssl/rand.h"
+#include "openssl/crypto.h"
+
+namespace KBEngine { 
+
+//-------------------------------------------------------------------------------------
+static void deriveAesGcmKey(const std::string& key, const char* label, 
+	unsigned char* pKey, unsigned char* pSalt)
+{
+	unsigned char digest[EVP_MAX_MD_SIZE];
+	std::string datas = std::string(label) + key;
+
+	EVP_Digest(datas.data(), datas.size(), digest, NULL, EVP_sha256(), NULL);
+	OPENSSL_cleanse(const_cast<char*>(datas.data()), datas.size());
+
+	memcpy(pKey, digest, KBEAesGcm::KEY_SIZE);
+	memcpy(pSalt, digest + KBEAesGcm::KEY_SIZE, KBEAesGcm::SALT_SIZE);
+	OPENSSL_cleanse(digest, sizeof(digest));
+}
+
+//-------------------------------------------------------------------------------------
+static EVP_CIPHER_CTX* createAesGcmContext(const unsigned char* pKey, bool encrypt)
+{
+	EVP_CIPHER_CTX* pCtx = EVP_CIPHER_CTX_new();
+	if(pCtx == NULL)
+		return NULL;
+
+	// 密钥只设置一次， 每条记录只更换nonce
+	int ret = encrypt ? EVP_EncryptInit_ex(pCtx, EVP_aes_128_gcm(), NULL, NULL, NULL) :
+		EVP_DecryptInit_ex(pCtx, EVP_aes_128_gcm(), NULL, NULL, NULL);
+
+	if(ret == 1)
+		ret = EVP_CIPHER_CTX_ctrl(pCtx, EVP_CTRL_GCM_SET_IVLEN, KBEAesGcm::NONCE_SIZE, NULL);
+
+	if(ret == 1)
+	{
+		ret = encrypt ? EVP_EncryptInit_ex(pCtx, NULL, NULL, pKey, NULL) :
+			EVP_DecryptInit_ex(pCtx, NULL, NULL, pKey, NULL);
+	}
+
+	if(ret != 1)
+	{
+		EVP_CIPHER_CTX_free(pCtx);
+		return NULL;
+	}
+
+	return pCtx;
+}
+
+//-------------------------------------------------------------------------------------
+static void makeAesGcmNonce(const unsigned char* pSalt, uint64 counter, unsigned char* pNonce)
+{
+	memcpy(pNonce, pSalt, KBEAesGcm::SALT_SIZE);
+
+	for(int i = KBEAesGcm::NONCE_SIZE - 1; i >= KBEAesGcm::SALT_SIZE; --i)
+	{
+		pNonce[i] = (unsigned char)(counter & 0xff);
+		counter >>= 8;
+	}
+}
+
+//-------------------------------------------------------------------------------------
+KBEAesGcm::KBEAesGcm(const Key & key, bool isServer):
+key_(key),
+isGood_(false),
+pSealCtx_(NULL),
+pOpenCtx_(NULL),
+sealCounter_(0),
+openCounter_(0)
+{
+	init(isServer);
+}
+
+//-------------------------------------------------------------------------------------
+KBEAesGcm::KBEAesGcm():
+key_(KEY_SIZE, 0),
+isGood_(false),
+pSealCtx_(NULL),
+pOpenCtx_(NULL),
+sealCounter_(0),
+openCounter_(0)
+{
+	RAND_bytes((unsigned char*)const_cast<char *>(key_.c_str()), 
+		key_.size());
+
+	init(false);
+}
+
+//-------------------------------------------------------------------------------------
+KBEAesGcm::~KBEAesGcm()
+{
+	if(pSealCtx_)
+		EVP_CIPHER_CTX_free(pSealCtx_);
+
+	if(pOpenCtx_)
+		EVP_CIPHER_CTX_free(pOpenCtx_);
+
+	pSealCtx_ = NULL;
+	pOpenCtx_ = NULL;
+}
+
+//-------------------------------------------------------------------------------------
+bool KBEAesGcm::init(bool isServer)
+{
+	if((int)key_.size() < KEY_SIZE)
+	{
+		ERROR_MSG(fmt::format("KBEAesGcm::init: "
+			"invalid length {}\n",
+			key_.size()));
+
+		isGood_ = false;
+		return false;
+	}
+
+	unsigned char sealKey[KEY_SIZE], openKey[KEY_SIZE];
+	deriveAesGcmKey(key_, isServer ? "kbe aes-gcm s2c" : "kbe aes-gcm c2s", sealKey, sealSalt_);
+	deriveAesGcmKey(key_, isServer ? "kbe aes-gcm c2s" : "kbe aes-gcm s2c", openKey, openSalt_);
+
+	pSealCtx_ = createAesGcmContext(sealKey, true);
+	pOpenCtx_ = createAesGcmContext(openKey, false);
+
+	OPENSSL_cleanse(sealKey, sizeof(sealKey));
+	OPENSSL_cleanse(openKey, sizeof(openKey));
+
+	isGood_ = pSealCtx_ != NULL && pOpenCtx_ != NULL;
+
+	if(!isGood_)
+	{
+		ERROR_MSG("KBEAesGcm::init: create cipher context failed!\n");
+	}
+
+	return isGood_;
+}
+
+//-------------------------------------------------------------------------------------
+bool KBEAesGcm::seal(unsigned char * data, int length, unsigned char * pTag)
+{
+	unsigned char nonce[NONCE_SIZE];
+	makeAesGcmNonce(sealSalt_, sealCounter_++, nonce);
+
+	int outlen = 0;
+	if(EVP_EncryptInit_ex(pSealCtx_, NULL, NULL, NULL, nonce) != 1)
+		return false;
+
+	if(length > 0 && EVP_EncryptUpdate(pSealCtx_, data, &outlen, data, length) != 1)
+		return false;
+
+	if(EVP_EncryptFinal_ex(pSealCtx_, data + outlen, &outlen) != 1)
+		return false;
+
+	return EVP_CIPHER_CTX_ctrl(pSealCtx_, EVP_CTRL_GCM_GET_TAG, TAG_SIZE, pTag) == 1;
+}
+
+//-------------------------------------------------------------------------------------
+bool KBEAesGcm::open(unsigned char * data, int length, const unsigned char * pTag)
+{
+	unsigned char nonce[NONCE_SIZE];
+	makeAesGcmNonce(openSalt_, openCounter_++, nonce);
+
+	int outlen = 0;
+	if(EVP_DecryptInit_ex(pOpenCtx_, NULL, NULL, NULL, nonce) != 1)
+		return false;
+
+	if(length > 0 && EVP_DecryptUpdate(pOpenCtx_, data, &outlen, data, length) != 1)
+		return false;
+
+	if(EVP_CIPHER_CTX_ctrl(pOpenCtx_, EVP_CTRL_GCM_SET_TAG, TAG_SIZE, 
+		const_cast<unsigned char*>(pTag)) != 1)
+		return false;
+
+	return EVP_DecryptFinal_ex(pOpenCtx_, data + outlen, &outlen) == 1;
+}
+
+//-------------------------------------------------------------------------------------
+} 
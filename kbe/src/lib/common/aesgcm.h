@@ -0,0 +1,79 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KBENGINE_AESGCM_H
+#define KBENGINE_AESGCM_H
+
+#include "common/common.h"
+#include "openssl/evp.h"
+#include <string>
+
+namespace KBEngine { 
+
+/*
+	AES-128-GCM认证加密， 两个方向各自从key派生子密钥与nonce前缀，
+	nonce的后8字节为每个方向的记录计数器， 不需要在网络上传输
+*/
+class KBEAesGcm
+{
+public:
+	static const int KEY_SIZE = 128 / 8;
+	static const int TAG_SIZE = 16;
+	static const int NONCE_SIZE = 12;
+	static const int SALT_SIZE = NONCE_SIZE - 8;
+
+	typedef std::string Key;
+
+	virtual ~KBEAesGcm();
+
+	// 服务端使用客户端在hello中提供的key
+	KBEAesGcm(const Key & key, bool isServer);
+
+	// 客户端随机生成key
+	KBEAesGcm();
+
+	const Key & key() const { return key_; }
+	bool isGood() const { return isGood_; }
+
+	// 原地加密length字节， 认证标签写入pTag
+	bool seal(unsigned char * data, int length, unsigned char * pTag);
+
+	// 原地解密length字节并校验认证标签
+	bool open(unsigned char * data, int length, const unsigned char * pTag);
+
+protected:
+	bool init(bool isServer);
+
+	Key key_;
+	bool isGood_;
+
+	EVP_CIPHER_CTX* pSealCtx_;
+	EVP_CIPHER_CTX* pOpenCtx_;
+
+	unsigned char sealSalt_[SALT_SIZE];
+	unsigned char openSalt_[SALT_SIZE];
+
+	uint64 sealCounter_;
+	uint64 openCounter_;
+};
+
+}
+
+#endif // KBENGINE_AESGCM_H
@@ -87,6 +87,14 @@ void KBE_MD5::final()
 void KBE_MD5::clear()
 {
 	memset(this, 0, sizeof(*this));
+	MD5_Init(&state_);
+}
+
+//-------------------------------------------------------------------------------------
+void KBE_MD5::setDigest(const unsigned char* digest)
+{
+	memcpy(bytes_, digest, sizeof(bytes_));
+	isFinal_ = true;
 }
 
 //-------------------------------------------------------------------------------------
@@ -45,6 +45,11 @@ public:
 	
 	void final();
 
+	/**
+		直接设置一个已经计算好的摘要， 例如从entitydef缓存中恢复
+	*/
+	void setDigest(const unsigned char* digest);
+
 	bool operator==( const KBE_MD5 & other ) const;
 	bool operator!=( const KBE_MD5 & other ) const
 		{ return !(*this == other); }
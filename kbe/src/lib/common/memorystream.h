@@ -525,6 +525,21 @@ public:
             data_.reserve(ressize);
     }
 
+	// reserve不会缩小容量， 这里释放超出ressize的部分， 已写入的数据保留
+	void shrink(size_t ressize)
+	{
+		if (ressize < wpos_)
+			ressize = wpos_;
+
+		if (data_.capacity() <= ressize)
+			return;
+
+		std::vector<uint8> datas;
+		datas.reserve(ressize);
+		datas.assign(data_.begin(), data_.begin() + wpos_);
+		data_.swap(datas);
+	}
+
     void appendBlob(const char *src, ArraySize cnt)
     {
         (*this) << cnt;
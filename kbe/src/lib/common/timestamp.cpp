@@ -21,16 +21,72 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "timestamp.h"
 #include "helper/debug_helper.h"
 
+#if defined(unix) && (defined(__i386__) || defined(__x86_64__))
+#include <cpuid.h>
+#endif
+
 namespace KBEngine{
 
-#define KBE_USE_RDTSC
+#ifdef unix
+#include <sys/time.h>
+#include <sys/types.h>
+#include <unistd.h>
 
-#ifdef KBE_USE_RDTSC
-	KBETimingMethod g_timingMethod = RDTSC_TIMING_METHOD;
-#else // KBE_USE_RDTSC
-	#define DEFAULT_TIMING_METHOD GET_TIME_TIMING_METHOD
-	KBETimingMethod g_timingMethod = NO_TIMING_METHOD;
-#endif // KBE_USE_RDTSC
+/**
+	CPU是否提供恒定速率的TSC(invariant TSC)， 只有这种情况下rdtsc才不受变频和多核影响。
+	在虚拟机中TSC可能在迁移后跳变， 因此检测到hypervisor时也不使用
+*/
+static bool hasInvariantTSC()
+{
+#if defined(__i386__) || defined(__x86_64__)
+	unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || (ecx & (1u << 31)))
+		return false;
+
+	if (__get_cpuid_max(0x80000000, NULL) < 0x80000007)
+		return false;
+
+	__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+	return (edx & (1u << 8)) != 0;
+#else
+	return false;
+#endif
+}
+
+/**
+	可通过环境变量KBE_TIMING_METHOD强制指定[rdtsc|gettimeofday|gettime|coarse]，
+	否则在有invariant TSC时使用rdtsc， 其他情况使用clock_gettime(vDSO)
+*/
+static KBETimingMethod selectTimingMethod()
+{
+	const char* timingMethod = getenv("KBE_TIMING_METHOD");
+	if (timingMethod)
+	{
+		if (strcmp(timingMethod, "rdtsc") == 0)
+			return RDTSC_TIMING_METHOD;
+		else if (strcmp(timingMethod, "gettimeofday") == 0)
+			return GET_TIME_OF_DAY_TIMING_METHOD;
+		else if (strcmp(timingMethod, "gettime") == 0)
+			return GET_TIME_TIMING_METHOD;
+		else if (strcmp(timingMethod, "coarse") == 0)
+			return GET_TIME_COARSE_TIMING_METHOD;
+
+		// 此时日志系统还未初始化， 未知的值按自动检测处理
+	}
+
+	return hasInvariantTSC() ? RDTSC_TIMING_METHOD : GET_TIME_TIMING_METHOD;
+}
+
+KBETimingMethod g_timingMethod = selectTimingMethod();
+
+#else // unix
+
+KBETimingMethod g_timingMethod = GET_TIME_TIMING_METHOD;
+
+#endif // unix
+
+uint64 g_cachedTimestamp = 0;
 
 const char* getTimingMethodName()
 {
@@ -48,17 +104,16 @@ const char* getTimingMethodName()
 		case GET_TIME_TIMING_METHOD:
 			return "gettime";
 
+		case GET_TIME_COARSE_TIMING_METHOD:
+			return "coarse";
+
 		default:
 			return "Unknown";
 	}
 }
 
 #ifdef unix
-#include <sys/time.h>
-#include <sys/types.h>
-#include <unistd.h>
 
-#ifdef KBE_USE_RDTSC
 static uint64 calcStampsPerSecond_rdtsc()
 {
 	struct timeval	tvBefore,	tvSleep = {0, 500000},	tvAfter;
@@ -68,7 +123,7 @@ static uint64 calcStampsPerSecond_rdtsc()
 	gettimeofday(&tvBefore, NULL);
 
 	gettimeofday(&tvBefore, NULL);
-	stampBefore = timestamp();
+	stampBefore = timestamp_rdtsc();
 
 	select(0, NULL, NULL, NULL, &tvSleep);
 
@@ -76,21 +131,20 @@ static uint64 calcStampsPerSecond_rdtsc()
 	gettimeofday(&tvAfter, NULL);
 
 	gettimeofday(&tvAfter, NULL);
-	stampAfter = timestamp();
+	stampAfter = timestamp_rdtsc();
 
-	uint64 microDelta =
-		(tvAfter.tv_usec + 1000000 - tvBefore.tv_usec) % 1000000;
+	uint64 microDelta = 1000000ULL * (tvAfter.tv_sec - tvBefore.tv_sec) + 
+		tvAfter.tv_usec - tvBefore.tv_usec;
 
 	uint64 stampDelta = stampAfter - stampBefore;
 
 	return (stampDelta * 1000000ULL) / microDelta;
 }
-#else
+
 static uint64 calcStampsPerSecond_gettime()
 {
 	return 1000000000ULL;
 }
-#endif
 
 static uint64 calcStampsPerSecond_gettimeofday()
 {
@@ -99,54 +153,13 @@ static uint64 calcStampsPerSecond_gettimeofday()
 
 static uint64 calcStampsPerSecond()
 {
-	static bool firstTime = true;
-	if (firstTime)
-	{
-		firstTime = false;
-	}
-
-#ifdef KBE_USE_RDTSC
-	return calcStampsPerSecond_rdtsc();
-#else 
-
 	if (g_timingMethod == RDTSC_TIMING_METHOD)
 		return calcStampsPerSecond_rdtsc();
 	else if (g_timingMethod == GET_TIME_OF_DAY_TIMING_METHOD)
 		return calcStampsPerSecond_gettimeofday();
-	else if (g_timingMethod == GET_TIME_TIMING_METHOD)
-		return calcStampsPerSecond_gettime();
-	else
-	{
-		char * timingMethod = getenv("KBE_TIMING_METHOD");
-		if (!timingMethod)
-		{
-			g_timingMethod = DEFAULT_TIMING_METHOD;
-		}
-		else if (strcmp(timingMethod, "rdtsc") == 0)
-		{
-			g_timingMethod = RDTSC_TIMING_METHOD;
-		}
-		else if (strcmp(timingMethod, "gettimeofday") == 0)
-		{
-			g_timingMethod = GET_TIME_OF_DAY_TIMING_METHOD;
-		}
-		else if (strcmp(timingMethod, "gettime") == 0)
-		{
-			g_timingMethod = GET_TIME_TIMING_METHOD;
-		}
-		else
-		{
-			WARNING_MSG(fmt::format("calcStampsPerSecond: "
-						 "Unknown timing method '%s', using clock_gettime.\n",
-						 timingMethod));
-
-			g_timingMethod = DEFAULT_TIMING_METHOD;
-		}
-
-		return calcStampsPerSecond();
-	}
-
-#endif
+	
+	// GET_TIME_TIMING_METHOD, GET_TIME_COARSE_TIMING_METHOD
+	return calcStampsPerSecond_gettime();
 }
 
 
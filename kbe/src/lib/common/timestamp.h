@@ -40,6 +40,7 @@ enum KBETimingMethod
 	GET_TIME_OF_DAY_TIMING_METHOD,
 	GET_TIME_TIMING_METHOD,
 	NO_TIMING_METHOD,
+	GET_TIME_COARSE_TIMING_METHOD, // CLOCK_MONOTONIC_COARSE, 精度为内核tick(1~4ms), 但几乎没有开销
 };
 
 extern KBETimingMethod g_timingMethod;
@@ -73,12 +74,23 @@ inline uint64 timestamp_gettimeofday()
 }
 
 #include <time.h>
-#include <asm/unistd.h>
 
+// 直接调用clock_gettime以便走vDSO， 不需要陷入内核
 inline uint64 timestamp_gettime()
 {
 	timespec tv;
-	assert(syscall( __NR_clock_gettime, CLOCK_MONOTONIC, &tv ) == 0);
+	clock_gettime(CLOCK_MONOTONIC, &tv);
+	return 1000000000ULL * tv.tv_sec + tv.tv_nsec;
+}
+
+inline uint64 timestamp_gettime_coarse()
+{
+	timespec tv;
+#ifdef CLOCK_MONOTONIC_COARSE
+	clock_gettime(CLOCK_MONOTONIC_COARSE, &tv);
+#else
+	clock_gettime(CLOCK_MONOTONIC, &tv);
+#endif
 	return 1000000000ULL * tv.tv_sec + tv.tv_nsec;
 }
 
@@ -91,6 +103,8 @@ inline uint64 timestamp()
 		return timestamp_rdtsc();
 	else if (g_timingMethod == GET_TIME_OF_DAY_TIMING_METHOD)
 		return timestamp_gettimeofday();
+	else if (g_timingMethod == GET_TIME_COARSE_TIMING_METHOD)
+		return timestamp_gettime_coarse();
 	else // GET_TIME_TIMING_METHOD
 		return timestamp_gettime();
 
@@ -124,6 +138,27 @@ inline uint64 timestamp()
 	#error Unsupported platform!
 #endif
 
+/**
+	每次主循环被唤醒时缓存的时间戳， 提供给不需要tick内精度的地方使用(如通道最后收包时间)，
+	避免频繁读取时钟。 只由主线程的poller刷新
+*/
+extern uint64 g_cachedTimestamp;
+
+inline uint64 refreshCachedTimestamp()
+{
+	g_cachedTimestamp = timestamp();
+	return g_cachedTimestamp;
+}
+
+inline uint64 cachedTimestamp()
+{
+	// 还没有进入主循环
+	if (g_cachedTimestamp == 0)
+		return timestamp();
+
+	return g_cachedTimestamp;
+}
+
 uint64 stampsPerSecond();
 double stampsPerSecondD();
 
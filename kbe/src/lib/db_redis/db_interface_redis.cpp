@@ -411,6 +411,39 @@ bool DBInterfaceRedis::queryAppend(bool printlog, const char* format, ...)
 	return true;
 }
 
+//-------------------------------------------------------------------------------------
+bool DBInterfaceRedis::queryAppend(const std::string& cmd, bool printlog)
+{
+	KBE_ASSERT(pRedisContext_);
+	int ret = redisAppendCommand(pRedisContext_, cmd.c_str());
+
+	if(lastquery_.size() > 0 && lastquery_[lastquery_.size() - 1] != ';')
+		lastquery_ = "";
+
+	lastquery_ += cmd;
+	lastquery_ += ";";
+	RedisWatcher::querystatistics(cmd.c_str(), (uint32)cmd.size());
+
+	if (ret == REDIS_ERR) 
+	{	
+		if(printlog)
+		{
+			ERROR_MSG(fmt::format("DBInterfaceRedis::queryAppend: cmd={}, errno={}, error={}\n",
+				lastquery_, pRedisContext_->err, pRedisContext_->errstr));
+		}
+
+		this->throwError();
+		return false;
+	}  
+
+	if(printlog)
+	{
+		INFO_MSG("DBInterfaceRedis::queryAppend: successfully!\n"); 
+	}
+
+	return true;
+}
+
 //-------------------------------------------------------------------------------------
 bool DBInterfaceRedis::getQueryReply(redisReply **pRedisReply)
 {
@@ -108,6 +108,7 @@ public:
 	bool query(const std::string& cmd, redisReply** pRedisReply, bool printlog = true);
 	bool query(bool printlog, const char* format, ...);
 	bool queryAppend(bool printlog, const char* format, ...);
+	bool queryAppend(const std::string& cmd, bool printlog = true);
 	bool getQueryReply(redisReply **pRedisReply);
 	
 	void write_query_result(redisReply* pRedisReply, MemoryStream * result);
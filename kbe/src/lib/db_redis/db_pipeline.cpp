@@ -0,0 +1,187 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "db_interface_redis.h"
+#include "db_pipeline.h"
+#include "db_exception.h"
+#include "db_interface/db_interface.h"
+#include "helper/debug_helper.h"
+#include "common/timestamp.h"
+
+namespace KBEngine { 
+namespace redis {
+
+//-------------------------------------------------------------------------------------
+DBPipeline::DBPipeline(DBInterface* pdbi, bool transaction):
+	pdbi_(pdbi),
+	transaction_(transaction),
+	committed_(false),
+	numCommands_(0),
+	replys_()
+{
+	if(transaction_)
+		static_cast<DBInterfaceRedis*>(pdbi_)->queryAppend(false, "MULTI");
+}
+
+//-------------------------------------------------------------------------------------
+DBPipeline::~DBPipeline()
+{
+	// 没有提交的命令已经写入了连接的输出缓冲， 必须读走回复， 否则后续的查询会读到错误的结果
+	if(!committed_ && !static_cast<DBInterfaceRedis*>(pdbi_)->hasLostConnection())
+	{
+		try
+		{
+			if(transaction_)
+			{
+				WARNING_MSG("DBPipeline::~DBPipeline: "
+					"Rolling back\n");
+			}
+
+			flush(transaction_ ? "DISCARD" : NULL);
+		}
+		catch (DBException & e)
+		{
+			if (e.isLostConnection())
+			{
+				static_cast<DBInterfaceRedis*>(pdbi_)->hasLostConnection(true);
+			}
+		}
+	}
+
+	clear();
+}
+
+//-------------------------------------------------------------------------------------
+void DBPipeline::clear()
+{
+	std::vector<redisReply*>::iterator iter = replys_.begin();
+	for(; iter != replys_.end(); ++iter)
+	{
+		if((*iter))
+			freeReplyObject((*iter));
+	}
+
+	replys_.clear();
+}
+
+//-------------------------------------------------------------------------------------
+bool DBPipeline::append(const std::string& cmd)
+{
+	KBE_ASSERT(!committed_);
+
+	if(!static_cast<DBInterfaceRedis*>(pdbi_)->queryAppend(cmd, false))
+		return false;
+
+	++numCommands_;
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+bool DBPipeline::commit()
+{
+	return flush(transaction_ ? "EXEC" : NULL);
+}
+
+//-------------------------------------------------------------------------------------
+bool DBPipeline::flush(const char* endCmd)
+{
+	KBE_ASSERT(!committed_);
+	committed_ = true;
+
+	DBInterfaceRedis* pdbi = static_cast<DBInterfaceRedis*>(pdbi_);
+
+	size_t numReplys = numCommands_;
+	if(transaction_)
+	{
+		pdbi->queryAppend(false, endCmd);
+
+		// MULTI + 每条命令的QUEUED + EXEC/DISCARD
+		numReplys += 2;
+	}
+
+	uint64 startTime = timestamp();
+	bool ret = true;
+
+	replys_.reserve(numReplys);
+
+	for(size_t i = 0; i < numReplys; ++i)
+	{
+		redisReply* pRedisReply = NULL;
+		if(!pdbi->getQueryReply(&pRedisReply))
+		{
+			ERROR_MSG(fmt::format("DBPipeline::commit: cmd={}, errno={}, error={}\n",
+				pdbi->lastquery(), pdbi->getlasterror(), pdbi->getstrerror()));
+
+			pdbi->throwError();
+			return false;
+		}
+
+		if(pRedisReply && pRedisReply->type == REDIS_REPLY_ERROR)
+		{
+			ERROR_MSG(fmt::format("DBPipeline::commit: cmd={}, error={}\n",
+				pdbi->lastquery(), pRedisReply->str));
+
+			ret = false;
+		}
+
+		replys_.push_back(pRedisReply);
+	}
+
+	uint64 duration = timestamp() - startTime;
+	if(duration > stampsPerSecond() * 0.2f)
+	{
+		WARNING_MSG(fmt::format("DBPipeline::commit(): {} commands took {:.2f} seconds\n", 
+			numCommands_, (double(duration)/stampsPerSecondD())));
+	}
+
+	// 事务被放弃时EXEC返回nil
+	if(transaction_)
+	{
+		redisReply* pExecReply = replys_.back();
+		if(pExecReply == NULL || pExecReply->type != REDIS_REPLY_ARRAY || pExecReply->elements != numCommands_)
+			ret = false;
+	}
+
+	return ret;
+}
+
+//-------------------------------------------------------------------------------------
+redisReply* DBPipeline::pRedisReply(size_t i)
+{
+	if(!committed_ || i >= numCommands_)
+		return NULL;
+
+	if(transaction_)
+	{
+		redisReply* pExecReply = replys_.empty() ? NULL : replys_.back();
+		if(pExecReply == NULL || pExecReply->type != REDIS_REPLY_ARRAY || i >= pExecReply->elements)
+			return NULL;
+
+		return pExecReply->element[i];
+	}
+
+	if(i >= replys_.size())
+		return NULL;
+
+	return replys_[i];
+}
+
+}
+}
@@ -0,0 +1,69 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KBE_REDIS_PIPELINE_HELPER_H
+#define KBE_REDIS_PIPELINE_HELPER_H
+
+#include "common/common.h"
+#include "hiredis/hiredis.h"
+
+namespace KBEngine { 
+class DBInterface;
+namespace redis {
+
+/**
+	将多条命令一次性写入连接(redisAppendCommand)， 然后一次读回所有结果， 
+	避免每条命令一个往返。
+	transaction为true时命令被包裹在MULTI/EXEC中， 只在需要原子性的地方使用。
+ */
+class DBPipeline
+{
+public:
+	DBPipeline(DBInterface* pdbi, bool transaction = false);
+	~DBPipeline();
+	
+	bool append(const std::string& cmd);
+
+	/**
+		发送所有命令并读回结果， 任意一条命令返回错误则返回false
+	*/
+	bool commit();
+
+	size_t size() const { return numCommands_; }
+
+	/**
+		第i条命令的结果， 事务模式下为EXEC返回数组中的元素
+	*/
+	redisReply* pRedisReply(size_t i);
+
+private:
+	bool flush(const char* endCmd);
+	void clear();
+
+	DBInterface* pdbi_;
+	bool transaction_;
+	bool committed_;
+	size_t numCommands_;
+	std::vector<redisReply*> replys_;
+};
+
+}
+}
+#endif // KBE_REDIS_PIPELINE_HELPER_H
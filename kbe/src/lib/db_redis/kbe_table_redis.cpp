@@ -20,6 +20,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 
 //#include "entity_table_redis.h"
 #include "db_transaction.h"
+#include "db_pipeline.h"
 #include "redis_helper.h"
 #include "kbe_table_redis.h"
 #include "db_interface_redis.h"
@@ -250,27 +251,13 @@ bool KBEAccountTableRedis::updateCount(DBInterface * pdbi, const std::string& na
 	/*
 	kbe_accountinfos:accountName = hashes(password, bindata, email, entityDBID, flags, deadline, regtime, lasttime, numlogin)
 	*/
-	redis::DBTransaction transaction(pdbi);
-	
-	// 如果查询失败则返回存在， 避免可能产生的错误
-	if(!pdbi->query(fmt::format("HINCRBY " KBE_TABLE_PERFIX "_accountinfos:{} numlogin", name), false))
-	{
-		transaction.rollback();
-		return false;
-	}
-	
-	// 如果查询失败则返回存在， 避免可能产生的错误
-	if(!pdbi->query(fmt::format("HSET " KBE_TABLE_PERFIX "_accountinfos:{} lasttime {}", name, time(NULL)), false))
-	{
-		transaction.rollback();
-		return false;
-	}
+	redis::DBPipeline pipeline(pdbi, true);
 	
-	transaction.commit();
+	pipeline.append(fmt::format("HINCRBY " KBE_TABLE_PERFIX "_accountinfos:{} numlogin 1", name));
+	pipeline.append(fmt::format("HSET " KBE_TABLE_PERFIX "_accountinfos:{} lasttime {}", name, time(NULL)));
 	
-	redisReply* pRedisReply = transaction.pRedisReply();
-
-	return pRedisReply && pRedisReply->type == REDIS_REPLY_ARRAY && pRedisReply->elements == 2;
+	// 两条命令在同一个往返中提交
+	return pipeline.commit();
 }
 
 //-------------------------------------------------------------------------------------
@@ -398,56 +385,28 @@ bool KBEEmailVerificationTableRedis::logAccount(DBInterface * pdbi, int8 type, c
 	kbe_email_verification:accountName = code
 	*/
 	
-	redis::DBTransaction transaction(pdbi);
+	redis::DBPipeline pipeline(pdbi, true);
 	
-	// 如果查询失败则返回存在， 避免可能产生的错误
-	if(!pdbi->query(fmt::format("HSET " KBE_TABLE_PERFIX "_email_verification:{} accountName {} type {} datas {} logtime {}", 
-		code, name, type, datas, time(NULL)), false))
-	{
-		ERROR_MSG(fmt::format("KBEEmailVerificationTableMysql::logAccount({}): cmd({}) is failed({})!\n", 
-				code, pdbi->lastquery(), pdbi->getstrerror()));
-		
-		transaction.rollback();
-		return false;
-	}
+	pipeline.append(fmt::format("HSET " KBE_TABLE_PERFIX "_email_verification:{} accountName {} type {} datas {} logtime {}", 
+		code, name, type, datas, time(NULL)));
 
-	// 如果查询失败则返回存在， 避免可能产生的错误
-	if(!pdbi->query(fmt::format("SET " KBE_TABLE_PERFIX "_email_verification:{} {}", name, code), false))
-	{
-		ERROR_MSG(fmt::format("KBEEmailVerificationTableMysql::logAccount({}): cmd({}) is failed({})!\n", 
-				code, pdbi->lastquery(), pdbi->getstrerror()));	
-		
-		transaction.rollback();	
-		return false;
-	}
+	pipeline.append(fmt::format("SET " KBE_TABLE_PERFIX "_email_verification:{} {}", name, code));
 
-	// 如果查询失败则返回存在， 避免可能产生的错误
-	if(!pdbi->query(fmt::format("EXPIRE " KBE_TABLE_PERFIX "_email_verification:{} {}", 
-		code.c_str(), getDeadline(type)), false))
-	{
-		ERROR_MSG(fmt::format("KBEEmailVerificationTableMysql::logAccount({}): cmd({}) is failed({})!\n", 
-				code, pdbi->lastquery(), pdbi->getstrerror()));
-		
-		transaction.rollback();	
-		return false;
-	}
+	pipeline.append(fmt::format("EXPIRE " KBE_TABLE_PERFIX "_email_verification:{} {}", 
+		code.c_str(), getDeadline(type)));
+
+	pipeline.append(fmt::format("EXPIRE " KBE_TABLE_PERFIX "_email_verification:{} {}", 
+		name.c_str(), getDeadline(type)));
 	
-	// 如果查询失败则返回存在， 避免可能产生的错误
-	if(!pdbi->query(fmt::format("EXPIRE " KBE_TABLE_PERFIX "_email_verification:{} {}", 
-		name.c_str(), getDeadline(type)), false))
+	if(!pipeline.commit())
 	{
-		ERROR_MSG(fmt::format("KBEEmailVerificationTableMysql::logAccount({}): cmd({}) is failed({})!\n", 
+		ERROR_MSG(fmt::format("KBEEmailVerificationTableRedis::logAccount({}): cmd({}) is failed({})!\n", 
 				code, pdbi->lastquery(), pdbi->getstrerror()));
 		
-		transaction.rollback();	
 		return false;
 	}
-	
-	transaction.commit();
-	
-	redisReply* pRedisReply = transaction.pRedisReply();
 
-	return pRedisReply && pRedisReply->type == REDIS_REPLY_ARRAY && pRedisReply->elements == 4;
+	return true;
 }
 
 //-------------------------------------------------------------------------------------
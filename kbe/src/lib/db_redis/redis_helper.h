@@ -27,6 +27,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "common/memorystream.h"
 #include "helper/debug_helper.h"
 #include "db_interface_redis.h"
+#include "db_pipeline.h"
 
 namespace KBEngine{ 
 
@@ -105,13 +106,18 @@ public:
 					redisReply* r0 = pRedisReply->element[1];
 					KBE_ASSERT(r0->type == REDIS_REPLY_ARRAY);
 					
+					// 这一页扫描到的key一次性发出， 不再逐条等待回复
+					redis::DBPipeline pipeline(pdbi);
+
 					for(size_t j = 0; j < r0->elements; ++j) 
 					{
 						redisReply* r1 = r0->element[j];
 						KBE_ASSERT(r1->type == REDIS_REPLY_STRING);
-							
-						pdbi->query(fmt::format("del {}", r1->str), &pRedisReply, printlog);
+
+						pipeline.append(fmt::format("del {}", r1->str));
 					}
+
+					pipeline.commit();
 				}
 				
 				freeReplyObject(pRedisReply); 
@@ -151,13 +157,18 @@ public:
 					redisReply* r0 = pRedisReply->element[1];
 					KBE_ASSERT(r0->type == REDIS_REPLY_ARRAY);
 					
+					// 这一页扫描到的key一次性发出， 不再逐条等待回复
+					redis::DBPipeline pipeline(pdbi);
+
 					for(size_t j = 0; j < r0->elements; ++j) 
 					{
 						redisReply* r1 = r0->element[j];
 						KBE_ASSERT(r1->type == REDIS_REPLY_STRING);
 
-						pdbi->query(fmt::format("hdel {} {}", r1->str, itemName), &pRedisReply, printlog);
+						pipeline.append(fmt::format("hdel {} {}", r1->str, itemName));
 					}
+
+					pipeline.commit();
 				}
 				
 				freeReplyObject(pRedisReply); 
@@ -1520,9 +1520,182 @@ PyObject* EntityCallType::createFromStream(MemoryStream* mstream)
 	Py_RETURN_NONE;
 }
 
+//-------------------------------------------------------------------------------------
+static inline PyObject* numberToPyObject(int8 v)			{ return PyLong_FromLong(v); }
+static inline PyObject* numberToPyObject(int16 v)			{ return PyLong_FromLong(v); }
+static inline PyObject* numberToPyObject(int32 v)			{ return PyLong_FromLong(v); }
+static inline PyObject* numberToPyObject(int64 v)			{ return PyLong_FromLongLong(v); }
+static inline PyObject* numberToPyObject(uint8 v)			{ return PyLong_FromLong(v); }
+static inline PyObject* numberToPyObject(uint16 v)			{ return PyLong_FromLong(v); }
+static inline PyObject* numberToPyObject(uint32 v)			{ return PyLong_FromUnsignedLong(v); }
+static inline PyObject* numberToPyObject(uint64 v)			{ return PyLong_FromUnsignedLongLong(v); }
+static inline PyObject* numberToPyObject(float v)			{ return PyFloat_FromDouble(v); }
+static inline PyObject* numberToPyObject(double v)			{ return PyFloat_FromDouble(v); }
+
+//-------------------------------------------------------------------------------------
+template <typename T>
+static inline bool pyObjectToSmallInt(PyObject* pyVal, T& v)
+{
+	if(!PyLong_Check(pyVal))
+		return false;
+
+	long l = PyLong_AsLong(pyVal);
+	if(l == -1 && PyErr_Occurred())
+	{
+		PyErr_Clear();
+		return false;
+	}
+
+	v = (T)l;
+	return true;
+}
+
+static inline bool pyObjectToNumber(PyObject* pyVal, int8& v)		{ return pyObjectToSmallInt(pyVal, v); }
+static inline bool pyObjectToNumber(PyObject* pyVal, int16& v)		{ return pyObjectToSmallInt(pyVal, v); }
+static inline bool pyObjectToNumber(PyObject* pyVal, int32& v)		{ return pyObjectToSmallInt(pyVal, v); }
+static inline bool pyObjectToNumber(PyObject* pyVal, uint8& v)		{ return pyObjectToSmallInt(pyVal, v); }
+static inline bool pyObjectToNumber(PyObject* pyVal, uint16& v)		{ return pyObjectToSmallInt(pyVal, v); }
+
+static inline bool pyObjectToNumber(PyObject* pyVal, uint32& v)
+{
+	if(!PyLong_Check(pyVal))
+		return false;
+
+	unsigned long l = PyLong_AsUnsignedLong(pyVal);
+	if(l == (unsigned long)-1 && PyErr_Occurred())
+	{
+		PyErr_Clear();
+		return false;
+	}
+
+	v = (uint32)l;
+	return true;
+}
+
+static inline bool pyObjectToNumber(PyObject* pyVal, int64& v)
+{
+	if(!PyLong_Check(pyVal))
+		return false;
+
+	v = PyLong_AsLongLong(pyVal);
+	if(v == -1 && PyErr_Occurred())
+	{
+		PyErr_Clear();
+		return false;
+	}
+
+	return true;
+}
+
+static inline bool pyObjectToNumber(PyObject* pyVal, uint64& v)
+{
+	if(!PyLong_Check(pyVal))
+		return false;
+
+	v = PyLong_AsUnsignedLongLong(pyVal);
+	if(v == (uint64)-1 && PyErr_Occurred())
+	{
+		PyErr_Clear();
+		return false;
+	}
+
+	return true;
+}
+
+static inline bool pyObjectToNumber(PyObject* pyVal, float& v)
+{
+	if(!PyFloat_Check(pyVal))
+		return false;
+
+	v = (float)PyFloat_AS_DOUBLE(pyVal);
+	return true;
+}
+
+static inline bool pyObjectToNumber(PyObject* pyVal, double& v)
+{
+	if(!PyFloat_Check(pyVal))
+		return false;
+
+	v = PyFloat_AS_DOUBLE(pyVal);
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+template <typename T>
+static void addNumbersToStreamT(MemoryStream* mstream, DataType* pDataType, PyObject** items, Py_ssize_t size)
+{
+	// 先转换到一个本地缓冲中， 再整块写入流， 无法快速转换的元素(例如类型不符)交给原DataType处理
+	T buf[256];
+	size_t count = 0;
+
+	for(Py_ssize_t i = 0; i < size; ++i)
+	{
+		T v;
+		if(pyObjectToNumber(items[i], v))
+		{
+			EndianConvert(v);
+			buf[count++] = v;
+
+			if(count == sizeof(buf) / sizeof(T))
+			{
+				mstream->append(buf, count);
+				count = 0;
+			}
+
+			continue;
+		}
+
+		if(count > 0)
+		{
+			mstream->append(buf, count);
+			count = 0;
+		}
+
+		PyObject* pyVal = items[i];
+		Py_INCREF(pyVal);
+		pDataType->addToStream(mstream, pyVal);
+		Py_DECREF(pyVal);
+	}
+
+	if(count > 0)
+		mstream->append(buf, count);
+}
+
+//-------------------------------------------------------------------------------------
+template <typename T>
+static bool createNumbersFromStreamT(MemoryStream* mstream, ArraySize size, std::vector<PyObject*>& vals)
+{
+	if((size_t)size * sizeof(T) > mstream->length())
+		return false;
+
+	const uint8* pData = mstream->data() + mstream->rpos();
+	vals.reserve(vals.size() + size);
+
+	for(ArraySize i = 0; i < size; ++i)
+	{
+		T v;
+		memcpy(&v, pData + i * sizeof(T), sizeof(T));
+		EndianConvert(v);
+
+		PyObject* pyVal = numberToPyObject(v);
+		if(pyVal == NULL)
+		{
+			PyErr_PrintEx(0);
+			pyVal = numberToPyObject(T());
+		}
+
+		vals.push_back(pyVal);
+	}
+
+	mstream->read_skip(size * sizeof(T));
+	return true;
+}
+
 //-------------------------------------------------------------------------------------
 FixedArrayType::FixedArrayType(DATATYPE_UID did):
-DataType(did)
+DataType(did),
+dataType_(NULL),
+itemCodec_(ITEM_CODEC_GENERIC)
 {
 }
 
@@ -1618,12 +1791,163 @@ bool FixedArrayType::initialize(XML* xml, TiXmlNode* node, const std::string& pa
 		return false;
 	}
 
+	initItemCodec();
+
 	DATATYPE_UID uid = dataType_->id();
 	EntityDef::md5().append((void*)&uid, sizeof(DATATYPE_UID));
 	EntityDef::md5().append((void*)strType.c_str(), (int)strType.size());
 	return true;
 }
 
+//-------------------------------------------------------------------------------------
+void FixedArrayType::initItemCodec()
+{
+	itemCodec_ = ITEM_CODEC_GENERIC;
+
+	if(dataType_->type() == DATA_TYPE_FIXEDDICT)
+	{
+		itemCodec_ = ITEM_CODEC_FIXEDDICT;
+		return;
+	}
+	
+	if(dataType_->type() == DATA_TYPE_FIXEDARRAY)
+	{
+		itemCodec_ = ITEM_CODEC_FIXEDARRAY;
+		return;
+	}
+
+	if(dataType_->type() != DATA_TYPE_DIGIT)
+		return;
+
+	std::string name = dataType_->getName();
+
+	if(name == "INT8")
+		itemCodec_ = ITEM_CODEC_INT8;
+	else if(name == "INT16")
+		itemCodec_ = ITEM_CODEC_INT16;
+	else if(name == "INT32")
+		itemCodec_ = ITEM_CODEC_INT32;
+	else if(name == "INT64")
+		itemCodec_ = ITEM_CODEC_INT64;
+	else if(name == "UINT8")
+		itemCodec_ = ITEM_CODEC_UINT8;
+	else if(name == "UINT16")
+		itemCodec_ = ITEM_CODEC_UINT16;
+	else if(name == "UINT32")
+		itemCodec_ = ITEM_CODEC_UINT32;
+	else if(name == "UINT64")
+		itemCodec_ = ITEM_CODEC_UINT64;
+	else if(name == "FLOAT")
+		itemCodec_ = ITEM_CODEC_FLOAT;
+	else if(name == "DOUBLE")
+		itemCodec_ = ITEM_CODEC_DOUBLE;
+}
+
+//-------------------------------------------------------------------------------------
+bool FixedArrayType::addNumbersToStream(MemoryStream* mstream, PyObject* pyValue)
+{
+	PyObject* pySeq = NULL;
+	PyObject** items = NULL;
+	Py_ssize_t size = 0;
+
+	if(PyObject_TypeCheck(pyValue, FixedArray::getScriptType()))
+	{
+		std::vector<PyObject*>& values = static_cast<FixedArray*>(pyValue)->getValues();
+		size = (Py_ssize_t)values.size();
+		items = size > 0 ? &values[0] : NULL;
+	}
+	else if(PyList_Check(pyValue) || PyTuple_Check(pyValue))
+	{
+		pySeq = PySequence_Fast(pyValue, "");
+		if(pySeq == NULL)
+		{
+			PyErr_Clear();
+			return false;
+		}
+
+		size = PySequence_Fast_GET_SIZE(pySeq);
+		items = PySequence_Fast_ITEMS(pySeq);
+	}
+	else
+	{
+		return false;
+	}
+
+	(*mstream) << (ArraySize)size;
+
+	switch(itemCodec_)
+	{
+	case ITEM_CODEC_INT8:
+		addNumbersToStreamT<int8>(mstream, dataType_, items, size);
+		break;
+	case ITEM_CODEC_INT16:
+		addNumbersToStreamT<int16>(mstream, dataType_, items, size);
+		break;
+	case ITEM_CODEC_INT32:
+		addNumbersToStreamT<int32>(mstream, dataType_, items, size);
+		break;
+	case ITEM_CODEC_INT64:
+		addNumbersToStreamT<int64>(mstream, dataType_, items, size);
+		break;
+	case ITEM_CODEC_UINT8:
+		addNumbersToStreamT<uint8>(mstream, dataType_, items, size);
+		break;
+	case ITEM_CODEC_UINT16:
+		addNumbersToStreamT<uint16>(mstream, dataType_, items, size);
+		break;
+	case ITEM_CODEC_UINT32:
+		addNumbersToStreamT<uint32>(mstream, dataType_, items, size);
+		break;
+	case ITEM_CODEC_UINT64:
+		addNumbersToStreamT<uint64>(mstream, dataType_, items, size);
+		break;
+	case ITEM_CODEC_FLOAT:
+		addNumbersToStreamT<float>(mstream, dataType_, items, size);
+		break;
+	case ITEM_CODEC_DOUBLE:
+		addNumbersToStreamT<double>(mstream, dataType_, items, size);
+		break;
+	default:
+		KBE_ASSERT(false);
+		break;
+	};
+
+	Py_XDECREF(pySeq);
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+bool FixedArrayType::createNumbersFromStream(MemoryStream* mstream, ArraySize size, std::vector<PyObject*>& vals)
+{
+	switch(itemCodec_)
+	{
+	case ITEM_CODEC_INT8:
+		return createNumbersFromStreamT<int8>(mstream, size, vals);
+	case ITEM_CODEC_INT16:
+		return createNumbersFromStreamT<int16>(mstream, size, vals);
+	case ITEM_CODEC_INT32:
+		return createNumbersFromStreamT<int32>(mstream, size, vals);
+	case ITEM_CODEC_INT64:
+		return createNumbersFromStreamT<int64>(mstream, size, vals);
+	case ITEM_CODEC_UINT8:
+		return createNumbersFromStreamT<uint8>(mstream, size, vals);
+	case ITEM_CODEC_UINT16:
+		return createNumbersFromStreamT<uint16>(mstream, size, vals);
+	case ITEM_CODEC_UINT32:
+		return createNumbersFromStreamT<uint32>(mstream, size, vals);
+	case ITEM_CODEC_UINT64:
+		return createNumbersFromStreamT<uint64>(mstream, size, vals);
+	case ITEM_CODEC_FLOAT:
+		return createNumbersFromStreamT<float>(mstream, size, vals);
+	case ITEM_CODEC_DOUBLE:
+		return createNumbersFromStreamT<double>(mstream, size, vals);
+	default:
+		break;
+	};
+
+	return false;
+}
+
 //-------------------------------------------------------------------------------------
 bool FixedArrayType::isSameItemType(PyObject* pyValue)
 {
@@ -1676,6 +2000,9 @@ void FixedArrayType::addToStream(MemoryStream* mstream, PyObject* pyValue)
 //-------------------------------------------------------------------------------------
 void FixedArrayType::addToStreamEx(MemoryStream* mstream, PyObject* pyValue, bool onlyPersistents)
 {
+	if(itemCodec_ >= ITEM_CODEC_INT8 && addNumbersToStream(mstream, pyValue))
+		return;
+
 	ArraySize size = (ArraySize)PySequence_Size(pyValue);
 	(*mstream) << size;
 
@@ -1683,9 +2010,9 @@ void FixedArrayType::addToStreamEx(MemoryStream* mstream, PyObject* pyValue, boo
 	{
 		PyObject* pyVal = PySequence_GetItem(pyValue, i);
 
-		if(dataType_->type() == DATA_TYPE_FIXEDDICT)
+		if(itemCodec_ == ITEM_CODEC_FIXEDDICT)
 			((FixedDictType*)dataType_)->addToStreamEx(mstream, pyVal, onlyPersistents);
-		else if(dataType_->type() == DATA_TYPE_FIXEDARRAY)
+		else if(itemCodec_ == ITEM_CODEC_FIXEDARRAY)
 			((FixedArrayType*)dataType_)->addToStreamEx(mstream, pyVal, onlyPersistents);
 		else
 			dataType_->addToStream(mstream, pyVal);
@@ -1713,6 +2040,10 @@ PyObject* FixedArrayType::createFromStreamEx(MemoryStream* mstream, bool onlyPer
 		(*mstream) >> size;	
 		
 		std::vector<PyObject*>& vals = pFixedArray->getValues();
+
+		if(itemCodec_ >= ITEM_CODEC_INT8 && createNumbersFromStream(mstream, size, vals))
+			return pFixedArray;
+
 		for(ArraySize i=0; i<size; ++i)
 		{
 			if(mstream->length() == 0)
@@ -1725,9 +2056,9 @@ PyObject* FixedArrayType::createFromStreamEx(MemoryStream* mstream, bool onlyPer
 
 			PyObject* pyVal = NULL;
 			
-			if(dataType_->type() == DATA_TYPE_FIXEDDICT)
+			if(itemCodec_ == ITEM_CODEC_FIXEDDICT)
 				pyVal = ((FixedDictType*)dataType_)->createFromStreamEx(mstream, onlyPersistents);
-			else if(dataType_->type() == DATA_TYPE_FIXEDARRAY)
+			else if(itemCodec_ == ITEM_CODEC_FIXEDARRAY)
 				pyVal = ((FixedArrayType*)dataType_)->createFromStreamEx(mstream, onlyPersistents);
 			else
 				pyVal = dataType_->createFromStream(mstream);
@@ -1768,6 +2099,7 @@ FixedDictType::~FixedDictType()
 	for(; iter != keyTypes_.end(); ++iter)
 	{
 		iter->second->dataType->decRef();
+		S_RELEASE(iter->second->pyKeyName);
 	}
 
 	keyTypes_.clear();
@@ -1922,6 +2254,7 @@ bool FixedDictType::initialize(XML* xml, TiXmlNode* node, std::string& parentNam
 
 					pDictItemDataType->persistent = persistent;
 					pDictItemDataType->databaseLength = databaseLength;
+					pDictItemDataType->pyKeyName = PyUnicode_InternFromString(typeName.c_str());
 					EntityDef::md5().append((void*)&persistent, sizeof(bool));
 					EntityDef::md5().append((void*)&databaseLength, sizeof(uint32));
 					DataTypes::addDataType(std::string("_") + parentName + std::string("_") + typeName + "_ArrayType", dataType);
@@ -1957,6 +2290,7 @@ bool FixedDictType::initialize(XML* xml, TiXmlNode* node, std::string& parentNam
 
 					pDictItemDataType->persistent = persistent;
 					pDictItemDataType->databaseLength = databaseLength;
+					pDictItemDataType->pyKeyName = PyUnicode_InternFromString(typeName.c_str());
 					EntityDef::md5().append((void*)&persistent, sizeof(bool));
 					EntityDef::md5().append((void*)&databaseLength, sizeof(uint32));
 				}
@@ -1987,10 +2321,11 @@ bool FixedDictType::initialize(XML* xml, TiXmlNode* node, std::string& parentNam
 		{
 			if(strType.size() > 0 && !loadImplModule(strType))
 				return false;
-
-			moduleName_ = strType;
 		}
 
+		// 其他组件不加载impl模块， 但仍记录名称， 写入entitydef缓存后其他组件需要它
+		moduleName_ = strType;
+
 		if(strType.size() > 0)
 			EntityDef::md5().append((void*)strType.c_str(), (int)strType.size());
 	}
@@ -2272,8 +2607,7 @@ void FixedDictType::addToStreamEx(MemoryStream* mstream, PyObject* pyValue, bool
 				continue;
 		}
 
-		PyObject* pyObject = 
-			PyDict_GetItemString(pydict, const_cast<char*>(iter->first.c_str()));
+		PyObject* pyObject = PyDict_GetItem(pydict, iter->second->pyKeyName);
 		
 		if(pyObject == NULL)
 		{
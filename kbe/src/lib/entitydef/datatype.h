@@ -48,6 +48,7 @@ namespace KBEngine{
 class RefCountable;
 class ScriptDefModule;
 class PropertyDescription;
+class EntityDefCache;
 
 class DataType : public RefCountable
 {
@@ -649,6 +650,30 @@ public:
 
 class FixedArrayType : public DataType
 {
+	friend class EntityDefCache;
+
+public:
+	/**
+		在initialize时根据元素类型预先确定的编解码方式，
+		数字类型的数组不再逐个元素经过DataType的虚函数， 而是批量写入/读出
+	*/
+	enum ItemCodec
+	{
+		ITEM_CODEC_GENERIC = 0,
+		ITEM_CODEC_FIXEDDICT,
+		ITEM_CODEC_FIXEDARRAY,
+		ITEM_CODEC_INT8,
+		ITEM_CODEC_INT16,
+		ITEM_CODEC_INT32,
+		ITEM_CODEC_INT64,
+		ITEM_CODEC_UINT8,
+		ITEM_CODEC_UINT16,
+		ITEM_CODEC_UINT32,
+		ITEM_CODEC_UINT64,
+		ITEM_CODEC_FLOAT,
+		ITEM_CODEC_DOUBLE
+	};
+
 public:	
 	FixedArrayType(DATATYPE_UID did = 0);
 	virtual ~FixedArrayType();	
@@ -680,8 +705,16 @@ public:
 
 	virtual DATATYPE type() const{ return DATA_TYPE_FIXEDARRAY; }
 
+	ItemCodec itemCodec() const { return itemCodec_; }
+
 protected:
+	void initItemCodec();
+
+	bool addNumbersToStream(MemoryStream* mstream, PyObject* pyValue);
+	bool createNumbersFromStream(MemoryStream* mstream, ArraySize size, std::vector<PyObject*>& vals);
+
 	DataType*			dataType_;		// 这个数组所处理的类别
+	ItemCodec			itemCodec_;
 };
 
 class FixedDictType : public DataType
@@ -696,6 +729,9 @@ public:
 
 		// 这个属性在数据库中的长度
 		uint32 databaseLength;
+
+		// 预先创建好的key字符串对象， 避免每次序列化时都构造一次
+		PyObject* pyKeyName;
 	};
 
 	typedef KBEShared_ptr< DictItemDataType > DictItemDataTypePtr;
@@ -50,10 +50,11 @@ void DataTypes::finalise(void)
 	uid_dataTypes_.clear();
 	dataTypesLowerName_.clear();
 	dataTypes_.clear();
+	dataTypesOrders_.clear();
 }
 
 //-------------------------------------------------------------------------------------
-bool DataTypes::initialize(std::string file)
+bool DataTypes::initialize()
 {
 	// 初始化一些基础类别
 	addDataType("UINT8",		new IntType<uint8>);
@@ -80,7 +81,7 @@ bool DataTypes::initialize(std::string file)
 	addDataType("VECTOR2",		new Vector2Type);
 	addDataType("VECTOR3",		new Vector3Type);
 	addDataType("VECTOR4",		new Vector4Type);
-	return loadTypes(file);
+	return true;
 }
 
 //-------------------------------------------------------------------------------------
@@ -45,7 +45,10 @@ public:
 	DataTypes();
 	virtual ~DataTypes();	
 
-	static bool initialize(std::string file);
+	/**
+		初始化基础类别， 别名与自定义类别由loadTypes从types.xml加载
+	*/
+	static bool initialize();
 	static void finalise(void);
 
 	static bool addDataType(std::string name, DataType* dataType);
@@ -141,7 +141,7 @@ PyObject* EntityCall::onScriptGetAttribute(PyObject* attr)
 				return ScriptObject::onScriptGetAttribute(attr);
 		}
 
-		return createRemoteMethod(pMethodDescription);
+		return getRemoteMethod(pMethodDescription);
 	}
 	else
 	{
@@ -290,6 +290,7 @@ void EntityCall::onInstallScript(PyObject* mod)
 //-------------------------------------------------------------------------------------
 void EntityCall::reload()
 { 
+	clearRemoteMethods();
 	pScriptModule_ = EntityDef::findScriptModule(scriptModuleName_.c_str());
 }
 
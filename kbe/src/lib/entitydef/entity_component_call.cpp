@@ -126,7 +126,7 @@ PyObject* EntityComponentCall::onScriptGetAttribute(PyObject* attr)
 				return ScriptObject::onScriptGetAttribute(attr);
 		}
 
-		return createRemoteMethod(pMethodDescription);
+		return getRemoteMethod(pMethodDescription);
 	}
 	
 	free(ccattr);
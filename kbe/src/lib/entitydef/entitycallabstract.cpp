@@ -27,6 +27,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "network/network_interface.h"
 #include "server/components.h"
 #include "client_lib/client_interface.h"
+#include "remote_entity_method.h"
 
 #include "../../server/baseapp/baseapp_interface.h"
 #include "../../server/cellapp/cellapp_interface.h"
@@ -63,13 +64,69 @@ componentID_(componentID),
 addr_((pAddr == NULL) ? Network::Address::NONE : *pAddr),
 type_(type),
 id_(eid),
-utype_(utype)
+utype_(utype),
+remoteMethods_()
 {
 }
 
 //-------------------------------------------------------------------------------------
 EntityCallAbstract::~EntityCallAbstract()
 {
+	clearRemoteMethods();
+}
+
+//-------------------------------------------------------------------------------------
+RemoteEntityMethod* EntityCallAbstract::getRemoteMethod(MethodDescription* pMethodDescription)
+{
+	std::vector<RemoteEntityMethod*>::iterator iter = remoteMethods_.begin();
+	for(; iter != remoteMethods_.end(); ++iter)
+	{
+		RemoteEntityMethod* pMethod = (*iter);
+		if(pMethod->getDescription() != pMethodDescription)
+			continue;
+
+		(*iter) = remoteMethods_.back();
+		remoteMethods_.pop_back();
+
+		// 复活对象， 重新持有本entityCall
+		PyObject_INIT(static_cast<PyObject*>(pMethod), Py_TYPE(pMethod));
+		Py_INCREF(this);
+		return pMethod;
+	}
+
+	return createRemoteMethod(pMethodDescription);
+}
+
+//-------------------------------------------------------------------------------------
+bool EntityCallAbstract::reclaimRemoteMethod(RemoteEntityMethod* pMethod)
+{
+	// 只有该方法对象引用着本entityCall时回收没有意义， entityCall随后就会析构
+	if(this->ob_refcnt <= 1)
+		return false;
+
+	std::vector<RemoteEntityMethod*>::iterator iter = remoteMethods_.begin();
+	for(; iter != remoteMethods_.end(); ++iter)
+	{
+		if((*iter)->getDescription() == pMethod->getDescription())
+			return false;
+	}
+
+	remoteMethods_.push_back(pMethod);
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+void EntityCallAbstract::clearRemoteMethods()
+{
+	std::vector<RemoteEntityMethod*>::iterator iter = remoteMethods_.begin();
+	for(; iter != remoteMethods_.end(); ++iter)
+	{
+		// 回收时已经释放了对entityCall的引用
+		(*iter)->releaseEntityCall();
+		delete (*iter);
+	}
+
+	remoteMethods_.clear();
 }
 
 //-------------------------------------------------------------------------------------
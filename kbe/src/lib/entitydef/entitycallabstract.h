@@ -141,6 +141,22 @@ public:
 	INLINE bool isBase() const;
 	INLINE bool isBaseReal() const;
 	INLINE bool isBaseViaCell() const;
+
+	/** 
+		创建一个远程方法对象， 由子类实现
+	*/
+	virtual RemoteEntityMethod* createRemoteMethod(MethodDescription* pMethodDescription){ return NULL; }
+
+	/** 
+		获得一个远程方法对象， 优先复用之前回收的同一方法的对象， 避免每次访问属性都分配
+	*/
+	RemoteEntityMethod* getRemoteMethod(MethodDescription* pMethodDescription);
+
+	/** 
+		远程方法对象引用计数归0时尝试回收到这里， 返回false则由调用者释放该对象
+	*/
+	bool reclaimRemoteMethod(RemoteEntityMethod* pMethod);
+	void clearRemoteMethods();
 	
 protected:
 	COMPONENT_ID							componentID_;			// 远端机器组件的ID
@@ -149,6 +165,8 @@ protected:
 	ENTITY_ID								id_;					// entityID
 	ENTITY_SCRIPT_UID						utype_;					// entity的utype按照entities.xml中的定义顺序
 
+	std::vector<RemoteEntityMethod*>		remoteMethods_;			// 回收的远程方法对象(引用计数为0)， 每个方法最多一个
+
 	static EntityCallCallHookFunc*			__hookCallFuncPtr;
 	static FindChannelFunc					__findChannelFunc;
 };
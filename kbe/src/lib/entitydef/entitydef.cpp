@@ -20,6 +20,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 
 
 #include "entitydef.h"
+#include "entitydef_cache.h"
 #include "scriptdef_module.h"
 #include "datatypes.h"
 #include "common.h"
@@ -47,6 +48,8 @@ std::vector<PyTypeObject*> EntityDef::__scriptBaseTypes;
 std::string EntityDef::__entitiesPath;
 
 KBE_MD5 EntityDef::__md5;
+std::string EntityDef::__compressionDictionary;
+KBEUnordered_map< std::string, SmartPointer<XML> > EntityDef::__defXMLCache;
 bool EntityDef::_isInit = false;
 bool g_isReload = false;
 
@@ -86,7 +89,10 @@ bool EntityDef::finalise(bool isReload)
 	MethodDescription::resetDescriptionCount();
 
 	EntityDef::__md5.clear();
+	EntityDef::__compressionDictionary.clear();
+	EntityDef::clearDefXMLCache();
 	g_methodUtypeAuto = 1;
+	g_scriptUtype = 1;
 	EntityDef::_isInit = false;
 
 	g_propertyUtypeAuto = 1;
@@ -149,11 +155,33 @@ void EntityDef::reload(bool fullReload)
 	else
 	{
 		loadAllEntityScriptModules(EntityDef::__entitiesPath, EntityDef::__scriptBaseTypes);
+		clearDefXMLCache();
 	}
 
 	EntityDef::_isInit = true;
 }
 
+//-------------------------------------------------------------------------------------
+SmartPointer<XML> EntityDef::openDefXML(const std::string& file)
+{
+	KBEUnordered_map< std::string, SmartPointer<XML> >::iterator iter = __defXMLCache.find(file);
+	if(iter != __defXMLCache.end())
+		return iter->second;
+
+	SmartPointer<XML> xml(new XML());
+	if(!xml->openSection(file.c_str()))
+		return NULL;
+
+	__defXMLCache[file] = xml;
+	return xml;
+}
+
+//-------------------------------------------------------------------------------------
+void EntityDef::clearDefXMLCache()
+{
+	__defXMLCache.clear();
+}
+
 //-------------------------------------------------------------------------------------
 bool EntityDef::initialize(std::vector<PyTypeObject*>& scriptBaseTypes, 
 						   COMPONENT_TYPE loadComponentType)
@@ -175,70 +203,111 @@ bool EntityDef::initialize(std::vector<PyTypeObject*>& scriptBaseTypes,
 	std::string entitiesFile = __entitiesPath + "entities.xml";
 	std::string defFilePath = __entitiesPath + "entity_defs/";
 	
-	// 初始化数据类别
-	// assets/scripts/entity_defs/types.xml
-	if(!DataTypes::initialize(defFilePath + "types.xml"))
+	std::string cacheFile = EntityDefCache::cacheFile(__entitiesPath);
+	
+	// 初始化基础数据类别
+	if(!DataTypes::initialize())
 		return false;
 
-	// 打开这个entities.xml文件
-	SmartPointer<XML> xml(new XML());
-	if(!xml->openSection(entitiesFile.c_str()))
-		return false;
-	
-	// 获得entities.xml根节点, 如果没有定义一个entity那么直接返回true
-	TiXmlNode* node = xml->getRootNode();
-	if(node == NULL)
-		return true;
+	size_t baseTypesOrders = DataTypes::dataTypesOrders().size();
+	uint64 startTime = timestamp();
 
-	// 开始遍历所有的entity节点
-	XML_FOR_BEGIN(node)
+	// 源文件没有改动时直接从缓存重建， 否则从xml加载
+	if(EntityDefCache::load(cacheFile))
 	{
-		std::string moduleName = xml.get()->getKey(node);
-		__scriptTypeMappingUType[moduleName] = g_scriptUtype;
-		ScriptDefModule* pScriptModule = new ScriptDefModule(moduleName, g_scriptUtype++);
-		EntityDef::__scriptModules.push_back(pScriptModule);
-
-		std::string deffile = defFilePath + moduleName + ".def";
-		SmartPointer<XML> defxml(new XML());
+		INFO_MSG(fmt::format("EntityDef::initialize: loaded {} script modules from {}, took {:.3f}ms.\n",
+			__scriptModules.size(), cacheFile, double(timestamp() - startTime) * 1000.0 / stampsPerSecondD()));
+	}
+	else
+	{
+		// assets/scripts/entity_defs/types.xml
+		std::string typesFile = Resmgr::getSingleton().matchRes(defFilePath + "types.xml");
+		if(!DataTypes::loadTypes(typesFile))
+			return false;
 
-		if(!defxml->openSection(deffile.c_str()))
+		// 打开这个entities.xml文件
+		SmartPointer<XML> xml = openDefXML(entitiesFile);
+		if(xml == NULL)
 			return false;
+		
+		// 获得entities.xml根节点, 如果没有定义一个entity那么直接返回true
+		TiXmlNode* node = xml->getRootNode();
+		if(node == NULL)
+			return true;
 
-		TiXmlNode* defNode = defxml->getRootNode();
-		if(defNode == NULL)
-		{
-			// root节点下没有子节点了
-			continue;
-		}
+		bool cacheable = true;
 
-		// 加载def文件中的定义
-		if(!loadDefInfo(defFilePath, moduleName, defxml.get(), defNode, pScriptModule))
+		// 开始遍历所有的entity节点
+		XML_FOR_BEGIN(node)
 		{
-			ERROR_MSG(fmt::format("EntityDef::initialize: failed to load entity({}) module!\n",
-				moduleName.c_str()));
+			std::string moduleName = xml.get()->getKey(node);
+			__scriptTypeMappingUType[moduleName] = g_scriptUtype;
+			ScriptDefModule* pScriptModule = new ScriptDefModule(moduleName, g_scriptUtype++);
+			EntityDef::__scriptModules.push_back(pScriptModule);
+
+			std::string deffile = defFilePath + moduleName + ".def";
+			SmartPointer<XML> defxml = openDefXML(deffile);
+			if(defxml == NULL)
+				return false;
 
-			return false;
-		}
+			TiXmlNode* defNode = defxml->getRootNode();
+			if(defNode == NULL)
+			{
+				// root节点下没有子节点了， 这种模块没有经过onLoaded， 不写入缓存
+				cacheable = false;
+				continue;
+			}
+
+			// 加载def文件中的定义
+			if(!loadDefInfo(defFilePath, moduleName, defxml.get(), defNode, pScriptModule))
+			{
+				ERROR_MSG(fmt::format("EntityDef::initialize: failed to load entity({}) module!\n",
+					moduleName.c_str()));
+
+				return false;
+			}
 		
-		// 尝试在主entity文件中加载detailLevel数据
-		if(!loadDetailLevelInfo(defFilePath, moduleName, defxml.get(), defNode, pScriptModule))
-		{
-			ERROR_MSG(fmt::format("EntityDef::initialize: failed to load entity({}) DetailLevelInfo!\n",
-				moduleName.c_str()));
+			// 尝试在主entity文件中加载detailLevel数据
+			if(!loadDetailLevelInfo(defFilePath, moduleName, defxml.get(), defNode, pScriptModule))
+			{
+				ERROR_MSG(fmt::format("EntityDef::initialize: failed to load entity({}) DetailLevelInfo!\n",
+					moduleName.c_str()));
 
-			return false;
+				return false;
+			}
+
+			pScriptModule->onLoaded();
 		}
+		XML_FOR_END(node);
 
-		pScriptModule->onLoaded();
-	}
-	XML_FOR_END(node);
+		EntityDef::md5().final();
+
+		INFO_MSG(fmt::format("EntityDef::initialize: loaded {} script modules from xml, took {:.3f}ms.\n",
+			__scriptModules.size(), double(timestamp() - startTime) * 1000.0 / stampsPerSecondD()));
 
-	EntityDef::md5().final();
+		if(cacheable)
+		{
+			// 加载过程中打开过的def文件都在__defXMLCache中， 它们与types.xml一起决定缓存是否有效
+			std::vector<std::string> sources;
+			sources.push_back(typesFile);
+
+			KBEUnordered_map< std::string, SmartPointer<XML> >::iterator iter = __defXMLCache.begin();
+			for(; iter != __defXMLCache.end(); ++iter)
+				sources.push_back(iter->first);
+
+			EntityDefCache::save(cacheFile, sources, baseTypesOrders);
+		}
+	}
 
 	if(loadComponentType == DBMGR_TYPE)
+	{
+		clearDefXMLCache();
 		return true;
+	}
 
-	return loadAllEntityScriptModules(__entitiesPath, scriptBaseTypes) && initializeWatcher();
+	bool ret = loadAllEntityScriptModules(__entitiesPath, scriptBaseTypes) && initializeWatcher();
+	clearDefXMLCache();
+	return ret;
 }
 
 //-------------------------------------------------------------------------------------
@@ -479,8 +548,8 @@ bool EntityDef::loadInterfaces(const std::string& defFilePath,
 
 		std::string interfaceName = defxml->getKey(interfaceNode);
 		std::string interfacefile = defFilePath + "interfaces/" + interfaceName + ".def";
-		SmartPointer<XML> interfaceXml(new XML());
-		if(!interfaceXml.get()->openSection(interfacefile.c_str()))
+		SmartPointer<XML> interfaceXml = openDefXML(interfacefile);
+		if(interfaceXml == NULL)
 			return false;
 
 		TiXmlNode* interfaceRootNode = interfaceXml->getRootNode();
@@ -574,8 +643,8 @@ bool EntityDef::loadComponents(const std::string& defFilePath,
 		}
 
 		std::string componentfile = defFilePath + "components/" + componentTypeName + ".def";
-		SmartPointer<XML> componentXml(new XML());
-		if (!componentXml.get()->openSection(componentfile.c_str()))
+		SmartPointer<XML> componentXml = openDefXML(componentfile);
+		if (componentXml == NULL)
 			return false;
 
 		// 产生一个属性描述实例
@@ -776,8 +845,8 @@ bool EntityDef::loadParentClass(const std::string& defFilePath,
 	std::string parentClassName = defxml->getKey(parentClassNode);
 	std::string parentClassfile = defFilePath + parentClassName + ".def";
 	
-	SmartPointer<XML> parentClassXml(new XML());
-	if(!parentClassXml->openSection(parentClassfile.c_str()))
+	SmartPointer<XML> parentClassXml = openDefXML(parentClassfile);
+	if(parentClassXml == NULL)
 		return false;
 	
 	TiXmlNode* parentClassdefNode = parentClassXml->getRootNode();
@@ -1771,8 +1840,8 @@ bool EntityDef::loadAllComponentScriptModules(std::string entitiesPath, std::vec
 {
 	std::string entitiesFile = entitiesPath + "entities.xml";
 
-	SmartPointer<XML> xml(new XML());
-	if (!xml->openSection(entitiesFile.c_str()))
+	SmartPointer<XML> xml = openDefXML(entitiesFile);
+	if (xml == NULL)
 		return false;
 
 	TiXmlNode* node = xml->getRootNode();
@@ -1946,8 +2015,8 @@ bool EntityDef::loadAllEntityScriptModules(std::string entitiesPath,
 
 	std::string entitiesFile = entitiesPath + "entities.xml";
 
-	SmartPointer<XML> xml(new XML());
-	if(!xml->openSection(entitiesFile.c_str()))
+	SmartPointer<XML> xml = openDefXML(entitiesFile);
+	if(xml == NULL)
 		return false;
 
 	TiXmlNode* node = xml->getRootNode();
@@ -2177,6 +2246,46 @@ bool EntityDef::uninstallScript()
 	return EntityDef::finalise();
 }
 
+//-------------------------------------------------------------------------------------
+const std::string& EntityDef::compressionDictionary()
+{
+	if(__compressionDictionary.size() > 0 || !_isInit)
+		return __compressionDictionary;
+
+	// deflate对字典靠后的内容引用代价更低， 方法名放在后面
+	SCRIPT_MODULES::const_iterator iter = __scriptModules.begin();
+	for(; iter != __scriptModules.end(); ++iter)
+	{
+		ScriptDefModule* pScriptModule = (*iter).get();
+		__compressionDictionary += pScriptModule->getName();
+
+		ScriptDefModule::PROPERTYDESCRIPTION_MAP& propertyDescrs = pScriptModule->getClientPropertyDescriptions();
+		ScriptDefModule::PROPERTYDESCRIPTION_MAP::const_iterator piter = propertyDescrs.begin();
+		for(; piter != propertyDescrs.end(); ++piter)
+			__compressionDictionary += piter->first;
+	}
+
+	for(iter = __scriptModules.begin(); iter != __scriptModules.end(); ++iter)
+	{
+		ScriptDefModule* pScriptModule = (*iter).get();
+
+		ScriptDefModule::METHODDESCRIPTION_MAP* methodDescrs[] = {
+			&pScriptModule->getBaseExposedMethodDescriptions(),
+			&pScriptModule->getCellExposedMethodDescriptions(),
+			&pScriptModule->getClientMethodDescriptions()
+		};
+
+		for(size_t i = 0; i < sizeof(methodDescrs) / sizeof(methodDescrs[0]); ++i)
+		{
+			ScriptDefModule::METHODDESCRIPTION_MAP::const_iterator miter = methodDescrs[i]->begin();
+			for(; miter != methodDescrs[i]->end(); ++miter)
+				__compressionDictionary += miter->first;
+		}
+	}
+
+	return __compressionDictionary;
+}
+
 //-------------------------------------------------------------------------------------
 bool EntityDef::initializeWatcher()
 {
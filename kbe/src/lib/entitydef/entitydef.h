@@ -45,6 +45,8 @@ typedef SmartPointer<ScriptDefModule> ScriptDefModulePtr;
 
 class EntityDef
 {
+	friend class EntityDefCache;
+
 public:
 	typedef std::vector<ScriptDefModulePtr> SCRIPT_MODULES;	
 	typedef std::map<std::string, ENTITY_SCRIPT_UID> SCRIPT_MODULE_UID_MAP;	
@@ -202,6 +204,19 @@ public:
 
 	static KBE_MD5& md5(){ return __md5; }
 
+	/**
+		由客户端可见的模块、属性与方法名称生成的压缩字典， 
+		服务端与客户端的entitydef一致时生成的字典也一致
+	*/
+	static const std::string& compressionDictionary();
+
+	/**
+		打开def相关的xml文件， 加载期间同一个文件只解析一次
+		(entities.xml会被每个模块查询， interface、component和父类的def也会被多个实体引用)
+	*/
+	static SmartPointer<XML> openDefXML(const std::string& file);
+	static void clearDefXMLCache();
+
 	static bool initializeWatcher();
 
 	static void entitydefAliasID(bool v)
@@ -259,6 +274,9 @@ private:
 	static std::string __entitiesPath;
 
 	static KBE_MD5 __md5;														// defs-md5
+	static std::string __compressionDictionary;
+
+	static KBEUnordered_map< std::string, SmartPointer<XML> > __defXMLCache;		// 加载期间已解析的xml， 加载结束后释放
 
 	static bool _isInit;
 
@@ -0,0 +1,785 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "entitydef_cache.h"
+#include "entitydef.h"
+#include "scriptdef_module.h"
+#include "datatypes.h"
+#include "common/md5.h"
+#include "common/kbeversion.h"
+
+#include <sys/stat.h>
+
+namespace KBEngine{
+
+// 定义在entitydef.cpp, 加载过程中分配utype使用
+extern ENTITY_METHOD_UID g_methodUtypeAuto;
+extern std::vector<ENTITY_METHOD_UID> g_methodCusUtypes;
+extern ENTITY_PROPERTY_UID g_propertyUtypeAuto;
+extern std::vector<ENTITY_PROPERTY_UID> g_propertyUtypes;
+extern ENTITY_SCRIPT_UID g_scriptUtype;
+
+// 属性被添加到了模块的哪些部分
+#define CACHE_PROPERTY_IN_CELL		0x01
+#define CACHE_PROPERTY_IN_BASE		0x02
+#define CACHE_PROPERTY_IN_CLIENT	0x04
+
+//-------------------------------------------------------------------------------------
+static bool statSourceFile(const std::string& path, uint64& size, uint64& mtime)
+{
+	struct stat s;
+	if(stat(path.c_str(), &s) != 0)
+		return false;
+
+	size = (uint64)s.st_size;
+	mtime = (uint64)s.st_mtime;
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+static void writeMethods(MemoryStream& s, ScriptDefModule::METHODDESCRIPTION_MAP& methods)
+{
+	s << (uint32)methods.size();
+
+	ScriptDefModule::METHODDESCRIPTION_MAP::iterator iter = methods.begin();
+	for(; iter != methods.end(); ++iter)
+	{
+		MethodDescription* pMethodDescription = iter->second;
+		std::vector<DataType*>& argTypes = pMethodDescription->getArgTypes();
+
+		s << iter->first << pMethodDescription->getUType() << pMethodDescription->isExposed();
+		s << (uint8)argTypes.size();
+
+		std::vector<DataType*>::iterator argIter = argTypes.begin();
+		for(; argIter != argTypes.end(); ++argIter)
+			s << (*argIter)->id();
+	}
+}
+
+//-------------------------------------------------------------------------------------
+static bool readMethods(MemoryStream& s, ScriptDefModule* pScriptModule, COMPONENT_TYPE domain)
+{
+	uint32 count = 0;
+	s >> count;
+
+	for(uint32 i = 0; i < count; ++i)
+	{
+		std::string name;
+		ENTITY_METHOD_UID utype = 0;
+		bool isExposed = false;
+		uint8 argSize = 0;
+
+		s >> name >> utype >> isExposed >> argSize;
+
+		MethodDescription* pMethodDescription = new MethodDescription(utype, domain, name, isExposed);
+
+		for(uint8 a = 0; a < argSize; ++a)
+		{
+			DATATYPE_UID uid = 0;
+			s >> uid;
+
+			if(!pMethodDescription->pushArgType(DataTypes::getDataType(uid)))
+			{
+				delete pMethodDescription;
+				return false;
+			}
+		}
+
+		bool ret = false;
+
+		if(domain == CELLAPP_TYPE)
+			ret = pScriptModule->addCellMethodDescription(name.c_str(), pMethodDescription);
+		else if(domain == BASEAPP_TYPE)
+			ret = pScriptModule->addBaseMethodDescription(name.c_str(), pMethodDescription);
+		else
+			ret = pScriptModule->addClientMethodDescription(name.c_str(), pMethodDescription);
+
+		if(!ret)
+		{
+			delete pMethodDescription;
+			return false;
+		}
+
+		g_methodCusUtypes.push_back(utype);
+	}
+
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+std::string EntityDefCache::cacheFile(const std::string& entitiesPath)
+{
+	return entitiesPath + "entity_defs/.entitydef.cache";
+}
+
+//-------------------------------------------------------------------------------------
+bool EntityDefCache::readFile(const std::string& file, MemoryStream& s)
+{
+	FILE* f = fopen(file.c_str(), "rb");
+	if(f == NULL)
+		return false;
+
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	if(size <= 0 || size > (long)MemoryStream::MAX_SIZE)
+	{
+		fclose(f);
+		return false;
+	}
+
+	std::vector<uint8> buf((size_t)size);
+	size_t readSize = fread(&buf[0], 1, buf.size(), f);
+	fclose(f);
+
+	if(readSize != buf.size())
+		return false;
+
+	s.append(&buf[0], buf.size());
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+bool EntityDefCache::checkSources(MemoryStream& s)
+{
+	uint32 count = 0;
+	s >> count;
+
+	for(uint32 i = 0; i < count; ++i)
+	{
+		std::string path;
+		uint64 size = 0, mtime = 0;
+		s >> path >> size >> mtime;
+
+		uint64 currSize = 0, currMtime = 0;
+		if(!statSourceFile(path, currSize, currMtime) || currSize != size || currMtime != mtime)
+		{
+			INFO_MSG(fmt::format("EntityDefCache::checkSources: {} has changed, reloading entitydefs from xml.\n",
+				path));
+
+			return false;
+		}
+	}
+
+	return count > 0;
+}
+
+//-------------------------------------------------------------------------------------
+bool EntityDefCache::load(const std::string& file)
+{
+	MemoryStream s;
+	if(!readFile(file, s))
+		return false;
+
+	try
+	{
+		uint32 magic = 0, version = 0, dataSize = 0;
+		std::string kbeVersion;
+		uint8 dataDigest[16];
+
+		s >> magic >> version >> kbeVersion >> dataSize;
+		s.read(dataDigest, sizeof(dataDigest));
+
+		if(magic != CACHE_MAGIC || version != CACHE_VERSION ||
+			kbeVersion != KBEVersion::versionString() || dataSize != s.length())
+		{
+			INFO_MSG(fmt::format("EntityDefCache::load: {} is outdated, reloading entitydefs from xml.\n",
+				file));
+
+			return false;
+		}
+
+		KBE_MD5 md5(s.data() + s.rpos(), (int)s.length());
+		if(memcmp(md5.getDigest(), dataDigest, sizeof(dataDigest)) != 0)
+		{
+			WARNING_MSG(fmt::format("EntityDefCache::load: {} is damaged, reloading entitydefs from xml.\n",
+				file));
+
+			return false;
+		}
+
+		if(!checkSources(s))
+			return false;
+
+		if(build(s))
+			return true;
+	}
+	catch(MemoryStreamException&)
+	{
+	}
+
+	ERROR_MSG(fmt::format("EntityDefCache::load: failed to rebuild entitydefs from {}, reloading from xml.\n",
+		file));
+
+	reset();
+	return false;
+}
+
+//-------------------------------------------------------------------------------------
+void EntityDefCache::reset()
+{
+	// 丢弃重建了一半的模型， 恢复到只有基础类别的状态
+	EntityDef::finalise(true);
+	DataTypes::initialize();
+}
+
+//-------------------------------------------------------------------------------------
+bool EntityDefCache::build(MemoryStream& s)
+{
+	ENTITY_SCRIPT_UID scriptUtype = 0;
+	ENTITY_PROPERTY_UID propertyUtypeAuto = 0;
+	ENTITY_METHOD_UID methodUtypeAuto = 0;
+	s >> scriptUtype >> propertyUtypeAuto >> methodUtypeAuto;
+
+	// 先产生所有的模块， 组件类别需要引用它们
+	uint32 count = 0;
+	s >> count;
+
+	std::vector<ScriptDefModule*> scriptModules;
+
+	for(uint32 i = 0; i < count; ++i)
+	{
+		std::string name;
+		ENTITY_SCRIPT_UID utype = 0;
+		bool isComponentModule = false, isPersistent = true;
+		s >> name >> utype >> isComponentModule >> isPersistent;
+
+		ScriptDefModule* pScriptModule = new ScriptDefModule(name, utype);
+		pScriptModule->isComponentModule(isComponentModule);
+		pScriptModule->isPersistent(isPersistent);
+
+		EntityDef::__scriptTypeMappingUType[name] = utype;
+		EntityDef::__scriptModules.push_back(pScriptModule);
+		scriptModules.push_back(pScriptModule);
+	}
+
+	g_scriptUtype = scriptUtype;
+
+	// 按照id顺序产生类别， 类别的id由产生的顺序决定， 必须与写入缓存时一致
+	s >> count;
+
+	for(uint32 i = 0; i < count; ++i)
+	{
+		DATATYPE_UID uid = 0;
+		uint8 cacheType = 0;
+		s >> uid >> cacheType;
+
+		DataType* pDataType = NULL;
+
+		if(cacheType == CACHE_TYPE_ARRAY)
+		{
+			pDataType = new FixedArrayType();
+		}
+		else if(cacheType == CACHE_TYPE_FIXED_DICT)
+		{
+			pDataType = new FixedDictType();
+		}
+		else if(cacheType == CACHE_TYPE_ENTITY_COMPONENT)
+		{
+			ENTITY_SCRIPT_UID moduleUtype = 0;
+			s >> moduleUtype;
+
+			ScriptDefModule* pCompScriptDefModule = EntityDef::findScriptModule(moduleUtype);
+			if(pCompScriptDefModule == NULL)
+				return false;
+
+			pDataType = new EntityComponentType(pCompScriptDefModule);
+		}
+		else
+		{
+			ERROR_MSG(fmt::format("EntityDefCache::build: unknown type({}), uid={}.\n", cacheType, uid));
+			return false;
+		}
+
+		if(pDataType->id() != uid)
+		{
+			ERROR_MSG(fmt::format("EntityDefCache::build: type uid mismatch({} != {}).\n",
+				pDataType->id(), uid));
+
+			return false;
+		}
+	}
+
+	// 类别都产生后再填充数组元素与固定字典的key， 它们可能引用id更大的类别
+	s >> count;
+
+	std::vector<FixedDictType*> implFixedDicts;
+
+	for(uint32 i = 0; i < count; ++i)
+	{
+		DATATYPE_UID uid = 0;
+		s >> uid;
+
+		DataType* pDataType = DataTypes::getDataType(uid);
+		if(pDataType == NULL)
+			return false;
+
+		if(pDataType->type() == DATA_TYPE_FIXEDARRAY)
+		{
+			DATATYPE_UID itemUid = 0;
+			s >> itemUid;
+
+			DataType* pItemDataType = DataTypes::getDataType(itemUid);
+			if(pItemDataType == NULL)
+				return false;
+
+			FixedArrayType* pFixedArrayType = static_cast<FixedArrayType*>(pDataType);
+			pFixedArrayType->dataType_ = pItemDataType;
+			pItemDataType->incRef();
+		}
+		else if(pDataType->type() == DATA_TYPE_FIXEDDICT)
+		{
+			FixedDictType* pFixedDictType = static_cast<FixedDictType*>(pDataType);
+			uint32 keySize = 0;
+			s >> pFixedDictType->moduleName() >> keySize;
+
+			for(uint32 k = 0; k < keySize; ++k)
+			{
+				std::string keyName;
+				DATATYPE_UID keyUid = 0;
+				FixedDictType::DictItemDataTypePtr pDictItemDataType(new FixedDictType::DictItemDataType());
+
+				s >> keyName >> keyUid >> pDictItemDataType->persistent >> pDictItemDataType->databaseLength;
+
+				pDictItemDataType->dataType = DataTypes::getDataType(keyUid);
+				if(pDictItemDataType->dataType == NULL)
+					return false;
+
+				pDictItemDataType->dataType->incRef();
+				pDictItemDataType->pyKeyName = PyUnicode_InternFromString(keyName.c_str());
+				pFixedDictType->getKeyTypes().push_back(std::pair< std::string,
+					FixedDictType::DictItemDataTypePtr >(keyName, pDictItemDataType));
+			}
+
+			if(pFixedDictType->moduleName().size() > 0)
+				implFixedDicts.push_back(pFixedDictType);
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	const DataTypes::UID_DATATYPE_MAP& uidDataTypes = DataTypes::uid_dataTypes();
+	DataTypes::UID_DATATYPE_MAP::const_iterator typeIter = uidDataTypes.begin();
+	for(; typeIter != uidDataTypes.end(); ++typeIter)
+	{
+		if(typeIter->second->type() == DATA_TYPE_FIXEDARRAY)
+			static_cast<FixedArrayType*>(typeIter->second)->initItemCodec();
+	}
+
+	// 与FixedDictType::initialize一致， 只有这些组件需要加载impl模块
+	if(g_componentType == CELLAPP_TYPE || g_componentType == BASEAPP_TYPE ||
+			g_componentType == CLIENT_TYPE)
+	{
+		std::vector<FixedDictType*>::iterator dictIter = implFixedDicts.begin();
+		for(; dictIter != implFixedDicts.end(); ++dictIter)
+		{
+			if(!(*dictIter)->loadImplModule((*dictIter)->moduleName()))
+				return false;
+		}
+	}
+
+	// 按照原先的顺序添加别名， 别名会改写类别的aliasName
+	s >> count;
+
+	for(uint32 i = 0; i < count; ++i)
+	{
+		std::string name;
+		DATATYPE_UID uid = 0;
+		s >> name >> uid;
+
+		DataType* pDataType = DataTypes::getDataType(uid);
+		if(pDataType == NULL)
+			return false;
+
+		DataTypes::addDataType(name, pDataType);
+	}
+
+	std::vector<ScriptDefModule*>::iterator iter = scriptModules.begin();
+	for(; iter != scriptModules.end(); ++iter)
+	{
+		if(!buildModule(s, (*iter)))
+		{
+			ERROR_MSG(fmt::format("EntityDefCache::build: failed to build module({}).\n",
+				(*iter)->getName()));
+
+			return false;
+		}
+	}
+
+	g_propertyUtypeAuto = propertyUtypeAuto;
+	g_methodUtypeAuto = methodUtypeAuto;
+
+	// 实体拥有的部分依赖当前的脚本文件， 不缓存判定结果
+	for(iter = scriptModules.begin(); iter != scriptModules.end(); ++iter)
+	{
+		if(!(*iter)->isComponentModule())
+			(*iter)->matchCompOwn();
+	}
+
+	for(iter = scriptModules.begin(); iter != scriptModules.end(); ++iter)
+	{
+		if(!(*iter)->isComponentModule())
+			(*iter)->onLoaded();
+	}
+
+	uint8 digest[16];
+	s.read(digest, sizeof(digest));
+
+	EntityDef::md5().clear();
+	EntityDef::md5().setDigest(digest);
+	return s.length() == 0;
+}
+
+//-------------------------------------------------------------------------------------
+bool EntityDefCache::buildModule(MemoryStream& s, ScriptDefModule* pScriptModule)
+{
+	bool hasCell = false, hasBase = false, hasClient = false;
+	int8 assertionHasClient = -1, assertionHasCell = -1, assertionHasBase = -1;
+	s >> hasCell >> hasBase >> hasClient >> assertionHasClient >> assertionHasCell >> assertionHasBase;
+
+	DetailLevel& dlInfo = pScriptModule->getDetailLevel();
+	for(int i = 0; i < 3; ++i)
+		s >> dlInfo.level[i].radius >> dlInfo.level[i].lag;
+
+	float position = 0.f, yaw = 0.f, pitch = 0.f, roll = 0.f;
+	bool optimized = true;
+	s >> position >> yaw >> pitch >> roll >> optimized;
+
+	VolatileInfo* pVolatileInfo = pScriptModule->getPVolatileInfo();
+	pVolatileInfo->position(position);
+	pVolatileInfo->yaw(yaw);
+	pVolatileInfo->pitch(pitch);
+	pVolatileInfo->roll(roll);
+	pVolatileInfo->optimized(optimized);
+
+	uint32 count = 0;
+	s >> count;
+
+	for(uint32 i = 0; i < count; ++i)
+	{
+		ENTITY_PROPERTY_UID utype = 0;
+		std::string dataTypeName, name, indexType, defaultStr;
+		uint32 flags = 0, databaseLength = 0;
+		bool isPersistent = false, isIdentifier = false, inDetailLevel = false;
+		DATATYPE_UID uid = 0;
+		int8 detailLevel = DETAIL_LEVEL_FAR;
+		uint8 parts = 0;
+
+		s >> utype >> dataTypeName >> name >> flags >> isPersistent >> uid >> isIdentifier
+			>> indexType >> databaseLength >> defaultStr >> detailLevel >> parts >> inDetailLevel;
+
+		// 名称是否合法与当前组件的脚本环境有关， 重新检查
+		if(!EntityDef::validDefPropertyName(pScriptModule, name))
+		{
+			ERROR_MSG(fmt::format("EntityDefCache::buildModule: '{}' is limited, in module({})!\n",
+				name, pScriptModule->getName()));
+
+			return false;
+		}
+
+		DataType* pDataType = DataTypes::getDataType(uid);
+		if(pDataType == NULL)
+			return false;
+
+		PropertyDescription* pPropertyDescription = PropertyDescription::createDescription(utype, dataTypeName,
+			name, flags, isPersistent, pDataType, isIdentifier, indexType, databaseLength, defaultStr,
+			(DETAIL_TYPE)detailLevel);
+
+		bool ret = true;
+
+		if(ret && (parts & CACHE_PROPERTY_IN_CELL) > 0)
+			ret = pScriptModule->addPropertyDescription(name.c_str(), pPropertyDescription, CELLAPP_TYPE);
+
+		if(ret && (parts & CACHE_PROPERTY_IN_BASE) > 0)
+			ret = pScriptModule->addPropertyDescription(name.c_str(), pPropertyDescription, BASEAPP_TYPE);
+
+		if(ret && (parts & CACHE_PROPERTY_IN_CLIENT) > 0)
+			ret = pScriptModule->addPropertyDescription(name.c_str(), pPropertyDescription, CLIENT_TYPE);
+
+		if(!ret)
+			return false;
+
+		// 组件属性在加入模块之后才按组件拥有的部分修正flags， 详情级别的归属以加入时为准
+		ScriptDefModule::PROPERTYDESCRIPTION_MAP& detailLevelPropertys =
+			pScriptModule->getCellPropertyDescriptionsByDetailLevel(detailLevel);
+
+		if(inDetailLevel)
+			detailLevelPropertys[name] = pPropertyDescription;
+		else
+			detailLevelPropertys.erase(name);
+
+		g_propertyUtypes.push_back(utype);
+	}
+
+	if(!readMethods(s, pScriptModule, CELLAPP_TYPE) ||
+		!readMethods(s, pScriptModule, BASEAPP_TYPE) ||
+		!readMethods(s, pScriptModule, CLIENT_TYPE))
+		return false;
+
+	s >> count;
+
+	for(uint32 i = 0; i < count; ++i)
+	{
+		std::string componentName;
+		ENTITY_SCRIPT_UID utype = 0;
+		s >> componentName >> utype;
+
+		ScriptDefModule* pCompScriptDefModule = EntityDef::findScriptModule(utype);
+		if(pCompScriptDefModule == NULL)
+			return false;
+
+		pScriptModule->addComponentDescription(componentName.c_str(), pCompScriptDefModule);
+	}
+
+	pScriptModule->setCell(hasCell);
+	pScriptModule->setBase(hasBase);
+	pScriptModule->setClient(hasClient);
+	pScriptModule->setCompOwnAssertions(assertionHasClient, assertionHasCell, assertionHasBase);
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+bool EntityDefCache::save(const std::string& file, const std::vector<std::string>& sources,
+	size_t baseTypesOrders)
+{
+	MemoryStream s;
+
+	s << (uint32)sources.size();
+
+	std::vector<std::string>::const_iterator sourceIter = sources.begin();
+	for(; sourceIter != sources.end(); ++sourceIter)
+	{
+		uint64 size = 0, mtime = 0;
+		if(!statSourceFile((*sourceIter), size, mtime))
+			return false;
+
+		s << (*sourceIter) << size << mtime;
+	}
+
+	s << g_scriptUtype << g_propertyUtypeAuto << g_methodUtypeAuto;
+
+	const EntityDef::SCRIPT_MODULES& scriptModules = EntityDef::getScriptModules();
+	s << (uint32)scriptModules.size();
+
+	EntityDef::SCRIPT_MODULES::const_iterator moduleIter = scriptModules.begin();
+	for(; moduleIter != scriptModules.end(); ++moduleIter)
+	{
+		ScriptDefModule* pScriptModule = (*moduleIter).get();
+		s << std::string(pScriptModule->getName()) << pScriptModule->getUType() <<
+			pScriptModule->isComponentModule() << pScriptModule->isPersistent();
+	}
+
+	// 基础类别由DataTypes::initialize产生， 只需记录加载def时产生的类别
+	const DataTypes::UID_DATATYPE_MAP& uidDataTypes = DataTypes::uid_dataTypes();
+	std::vector<DataType*> defDataTypes;
+
+	DataTypes::UID_DATATYPE_MAP::const_iterator typeIter = uidDataTypes.begin();
+	for(; typeIter != uidDataTypes.end(); ++typeIter)
+	{
+		DATATYPE type = typeIter->second->type();
+		if(type == DATA_TYPE_FIXEDARRAY || type == DATA_TYPE_FIXEDDICT || type == DATA_TYPE_ENTITY_COMPONENT)
+			defDataTypes.push_back(typeIter->second);
+	}
+
+	s << (uint32)defDataTypes.size();
+
+	std::vector<DataType*>::iterator defIter = defDataTypes.begin();
+	for(; defIter != defDataTypes.end(); ++defIter)
+	{
+		DataType* pDataType = (*defIter);
+		s << pDataType->id();
+
+		if(pDataType->type() == DATA_TYPE_FIXEDARRAY)
+		{
+			s << (uint8)CACHE_TYPE_ARRAY;
+		}
+		else if(pDataType->type() == DATA_TYPE_FIXEDDICT)
+		{
+			s << (uint8)CACHE_TYPE_FIXED_DICT;
+		}
+		else
+		{
+			s << (uint8)CACHE_TYPE_ENTITY_COMPONENT;
+			s << static_cast<EntityComponentType*>(pDataType)->pScriptDefModule()->getUType();
+		}
+	}
+
+	uint32 containerCount = 0;
+	for(defIter = defDataTypes.begin(); defIter != defDataTypes.end(); ++defIter)
+	{
+		if((*defIter)->type() != DATA_TYPE_ENTITY_COMPONENT)
+			++containerCount;
+	}
+
+	s << containerCount;
+
+	for(defIter = defDataTypes.begin(); defIter != defDataTypes.end(); ++defIter)
+	{
+		DataType* pDataType = (*defIter);
+
+		if(pDataType->type() == DATA_TYPE_FIXEDARRAY)
+		{
+			s << pDataType->id() << static_cast<FixedArrayType*>(pDataType)->getDataType()->id();
+		}
+		else if(pDataType->type() == DATA_TYPE_FIXEDDICT)
+		{
+			FixedDictType* pFixedDictType = static_cast<FixedDictType*>(pDataType);
+			FixedDictType::FIXEDDICT_KEYTYPE_MAP& keyTypes = pFixedDictType->getKeyTypes();
+
+			s << pDataType->id() << pFixedDictType->moduleName() << (uint32)keyTypes.size();
+
+			FixedDictType::FIXEDDICT_KEYTYPE_MAP::iterator keyIter = keyTypes.begin();
+			for(; keyIter != keyTypes.end(); ++keyIter)
+			{
+				s << keyIter->first << keyIter->second->dataType->id() <<
+					keyIter->second->persistent << keyIter->second->databaseLength;
+			}
+		}
+	}
+
+	const DataTypes::DATATYPE_ORDERS& dataTypesOrders = DataTypes::dataTypesOrders();
+	s << (uint32)(dataTypesOrders.size() - baseTypesOrders);
+
+	for(size_t i = baseTypesOrders; i < dataTypesOrders.size(); ++i)
+	{
+		DataType* pDataType = DataTypes::getDataType(dataTypesOrders[i]);
+		if(pDataType == NULL)
+			return false;
+
+		s << dataTypesOrders[i] << pDataType->id();
+	}
+
+	for(moduleIter = scriptModules.begin(); moduleIter != scriptModules.end(); ++moduleIter)
+	{
+		ScriptDefModule* pScriptModule = (*moduleIter).get();
+
+		s << pScriptModule->hasCell() << pScriptModule->hasBase() << pScriptModule->hasClient();
+		s << pScriptModule->assertionHasClient() << pScriptModule->assertionHasCell() << pScriptModule->assertionHasBase();
+
+		DetailLevel& dlInfo = pScriptModule->getDetailLevel();
+		for(int i = 0; i < 3; ++i)
+			s << dlInfo.level[i].radius << dlInfo.level[i].lag;
+
+		VolatileInfo* pVolatileInfo = pScriptModule->getPVolatileInfo();
+		s << pVolatileInfo->position() << pVolatileInfo->yaw() << pVolatileInfo->pitch() <<
+			pVolatileInfo->roll() << pVolatileInfo->optimized();
+
+		// 同一个属性描述可能同时加入了cell、base与client部分
+		std::vector<PropertyDescription*> propertyDescrs;
+		std::map<PropertyDescription*, uint8> propertyParts;
+
+		ScriptDefModule::PROPERTYDESCRIPTION_MAP* partDescrs[3] = {
+			&pScriptModule->getCellPropertyDescriptions(),
+			&pScriptModule->getBasePropertyDescriptions(),
+			&pScriptModule->getClientPropertyDescriptions() };
+
+		uint8 partFlags[3] = { CACHE_PROPERTY_IN_CELL, CACHE_PROPERTY_IN_BASE, CACHE_PROPERTY_IN_CLIENT };
+
+		for(int i = 0; i < 3; ++i)
+		{
+			ScriptDefModule::PROPERTYDESCRIPTION_MAP::iterator propIter = partDescrs[i]->begin();
+			for(; propIter != partDescrs[i]->end(); ++propIter)
+			{
+				if(propertyParts.find(propIter->second) == propertyParts.end())
+					propertyDescrs.push_back(propIter->second);
+
+				propertyParts[propIter->second] |= partFlags[i];
+			}
+		}
+
+		s << (uint32)propertyDescrs.size();
+
+		std::vector<PropertyDescription*>::iterator propIter = propertyDescrs.begin();
+		for(; propIter != propertyDescrs.end(); ++propIter)
+		{
+			PropertyDescription* pPropertyDescription = (*propIter);
+			ScriptDefModule::PROPERTYDESCRIPTION_MAP& detailLevelPropertys =
+				pScriptModule->getCellPropertyDescriptionsByDetailLevel(pPropertyDescription->getDetailLevel());
+
+			ScriptDefModule::PROPERTYDESCRIPTION_MAP::iterator detailIter =
+				detailLevelPropertys.find(pPropertyDescription->getName());
+
+			bool inDetailLevel = detailIter != detailLevelPropertys.end() && detailIter->second == pPropertyDescription;
+
+			s << pPropertyDescription->getUType() << std::string(pPropertyDescription->getDataTypeName()) <<
+				std::string(pPropertyDescription->getName()) << pPropertyDescription->getFlags() <<
+				pPropertyDescription->isPersistent() << pPropertyDescription->getDataType()->id() <<
+				pPropertyDescription->isIdentifier() << std::string(pPropertyDescription->indexType()) <<
+				pPropertyDescription->getDatabaseLength() << std::string(pPropertyDescription->getDefaultValStr()) <<
+				pPropertyDescription->getDetailLevel() << propertyParts[pPropertyDescription] << inDetailLevel;
+		}
+
+		writeMethods(s, pScriptModule->getCellMethodDescriptions());
+		writeMethods(s, pScriptModule->getBaseMethodDescriptions());
+		writeMethods(s, pScriptModule->getClientMethodDescriptions());
+
+		ScriptDefModule::COMPONENTDESCRIPTION_MAP& componentDescrs = pScriptModule->getComponentDescrs();
+		s << (uint32)componentDescrs.size();
+
+		ScriptDefModule::COMPONENTDESCRIPTION_MAP::iterator compIter = componentDescrs.begin();
+		for(; compIter != componentDescrs.end(); ++compIter)
+			s << compIter->first << compIter->second->getUType();
+	}
+
+	s.append(EntityDef::md5().getDigest(), 16);
+
+	MemoryStream header;
+	KBE_MD5 md5(s.data(), (int)s.length());
+	header << (uint32)CACHE_MAGIC << (uint32)CACHE_VERSION << KBEVersion::versionString() << (uint32)s.length();
+	header.append(md5.getDigest(), 16);
+
+	// 多个进程可能同时写入， 先写到临时文件再替换
+	std::string tmpFile = fmt::format("{}.{}", file, getProcessPID());
+	FILE* f = fopen(tmpFile.c_str(), "wb");
+	if(f == NULL)
+	{
+		WARNING_MSG(fmt::format("EntityDefCache::save: can't write {}, entitydefs will be loaded from xml next time.\n",
+			tmpFile));
+
+		return false;
+	}
+
+	bool ret = fwrite(header.data(), 1, header.length(), f) == header.length() &&
+		fwrite(s.data(), 1, s.length(), f) == s.length();
+
+	ret = (fclose(f) == 0) && ret;
+
+#if KBE_PLATFORM == PLATFORM_WIN32
+	if(ret)
+		remove(file.c_str());
+#endif
+
+	if(!ret || rename(tmpFile.c_str(), file.c_str()) != 0)
+	{
+		WARNING_MSG(fmt::format("EntityDefCache::save: can't write {}, entitydefs will be loaded from xml next time.\n",
+			file));
+
+		remove(tmpFile.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+}
@@ -0,0 +1,89 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KBE_ENTITYDEF_CACHE_H
+#define KBE_ENTITYDEF_CACHE_H
+
+#include "common/common.h"
+#include "common/memorystream.h"
+#include "helper/debug_helper.h"
+
+namespace KBEngine{
+
+class ScriptDefModule;
+
+/*
+	entitydef的二进制缓存
+	从XML加载成功后， 将解析结果中与python无关的部分(类别、别名、模块、属性与方法描述、组件和md5)
+	写入缓存文件， 之后启动的进程(包括其他组件)在源文件都没有改动时直接由缓存重建模型， 跳过XML解析。
+
+	缓存文件格式:
+		uint32 magic, uint32 版本, string 引擎版本, uint32 数据长度, 16字节数据md5
+		数据: 源文件列表(路径、大小、修改时间)、类别、别名、模块、defs-md5
+
+	重建时仍然通过与XML加载相同的构造和add接口生成对象， 属性默认值、FIXED_DICT的implementedBy等
+	python相关的部分由当前组件重新处理， 实体拥有哪些部分也根据当前的脚本文件重新判定。
+	缓存不存在、版本不符、数据损坏、任意源文件的大小或修改时间变化， 或者重建失败时都回退到XML加载。
+*/
+class EntityDefCache
+{
+public:
+	enum
+	{
+		CACHE_MAGIC = 0x4445424B,	// "KBED"
+		CACHE_VERSION = 1
+	};
+
+	/**
+		缓存文件的路径
+	*/
+	static std::string cacheFile(const std::string& entitiesPath);
+
+	/**
+		从缓存重建entitydef， 返回false时模型状态与调用前一致， 调用者应回退到XML加载
+	*/
+	static bool load(const std::string& file);
+
+	/**
+		将当前从XML加载的entitydef写入缓存
+		sources: 加载过程中读取的所有xml文件
+		baseTypesOrders: 基础类别在DataTypes::dataTypesOrders()中所占的数量
+	*/
+	static bool save(const std::string& file, const std::vector<std::string>& sources,
+		size_t baseTypesOrders);
+
+private:
+	enum
+	{
+		CACHE_TYPE_ARRAY = 1,
+		CACHE_TYPE_FIXED_DICT = 2,
+		CACHE_TYPE_ENTITY_COMPONENT = 3
+	};
+
+	static bool readFile(const std::string& file, MemoryStream& s);
+	static bool checkSources(MemoryStream& s);
+	static bool build(MemoryStream& s);
+	static bool buildModule(MemoryStream& s, ScriptDefModule* pScriptModule);
+	static void reset();
+};
+
+}
+
+#endif // KBE_ENTITYDEF_CACHE_H
@@ -58,6 +58,9 @@ Sequence(getScriptType(), false)
 //-------------------------------------------------------------------------------------
 FixedArray::~FixedArray()
 {
+	if(ownerLink_.ownerID != 0)
+		PropertyPatch::detachChildren(this);
+
 	_dataType->decRef();
 
 	script::PyGC::decTracing("FixedArray");
@@ -174,6 +177,20 @@ PyObject* FixedArray::createNewItemFromObj(PyObject* pyItem)
 	return _dataType->createNewItemFromObj(pyItem);
 }
 
+//-------------------------------------------------------------------------------------
+void FixedArray::onValuesRemoving(Py_ssize_t index1, Py_ssize_t index2)
+{
+	if(ownerLink_.ownerID != 0)
+		PropertyPatch::onSequenceRemoving(this, index1, index2);
+}
+
+//-------------------------------------------------------------------------------------
+void FixedArray::onValuesChanged(Py_ssize_t index1, Py_ssize_t index2, Py_ssize_t count)
+{
+	if(ownerLink_.ownerID != 0)
+		PropertyPatch::onSequenceChanged(this, index1, index2, count);
+}
+
 //-------------------------------------------------------------------------------------
 PyObject* FixedArray::__py_append(PyObject* self, PyObject* args, PyObject* kwargs)
 {
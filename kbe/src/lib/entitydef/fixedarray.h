@@ -25,6 +25,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "datatype.h"
 #include "pyscript/sequence.h"
 #include "pyscript/pickler.h"
+#include "property_patch.h"
 
 namespace KBEngine{
 
@@ -37,6 +38,9 @@ public:
 	virtual ~FixedArray();
 
 	const DataType* getDataType(void){ return _dataType; }
+	FixedArrayType* getArrayType(void){ return _dataType; }
+
+	PropertyOwnerLink& ownerLink(){ return ownerLink_; }
 	
 	/** 
 		初始化固定数组
@@ -75,6 +79,9 @@ public:
 
 	virtual PyObject* createNewItemFromObj(PyObject* pyItem);
 
+	virtual void onValuesRemoving(Py_ssize_t index1, Py_ssize_t index2);
+	virtual void onValuesChanged(Py_ssize_t index1, Py_ssize_t index2, Py_ssize_t count);
+
 	/** 
 		获得对象的描述 
 	*/
@@ -82,6 +89,9 @@ public:
 	PyObject* tp_str();
 protected:
 	FixedArrayType* _dataType;
+
+	// 所属的实体属性， 用于增量同步
+	PropertyOwnerLink ownerLink_;
 } ;
 
 }
@@ -94,6 +94,9 @@ Map(getScriptType(), false)
 //-------------------------------------------------------------------------------------
 FixedDict::~FixedDict()
 {
+	if(ownerLink_.ownerID != 0)
+		PropertyPatch::detachChildren(this);
+
 	_dataType->decRef();
 	script::PyGC::decTracing("FixedDict");
 
@@ -110,9 +113,7 @@ void FixedDict::initialize(std::string strDictInitData)
 		PyObject* pyobj = iter->second->dataType->parseDefaultStr("");
 		if(pyobj)
 		{
-			PyObject* pykey = PyUnicode_FromString(iter->first.c_str());
-			PyDict_SetItem(pyDict_, pykey, pyobj);
-			Py_DECREF(pykey);
+			PyDict_SetItem(pyDict_, iter->second->pyKeyName, pyobj);
 			Py_DECREF(pyobj);
 		}
 		else
@@ -143,7 +144,7 @@ void FixedDict::initialize(MemoryStream* streamInitData, bool isPersistentsStrea
 		if(isPersistentsStream && !iter->second->persistent)
 		{
 			PyObject* val1 = iter->second->dataType->parseDefaultStr("");
-			PyDict_SetItemString(pyDict_, iter->first.c_str(), val1);
+			PyDict_SetItem(pyDict_, iter->second->pyKeyName, val1);
 			
 			// 由于PyDict_SetItem会增加引用因此需要减
 			Py_DECREF(val1);
@@ -158,7 +159,7 @@ void FixedDict::initialize(MemoryStream* streamInitData, bool isPersistentsStrea
 			else
 				val1 = iter->second->dataType->createFromStream(streamInitData);
 
-			PyDict_SetItemString(pyDict_, iter->first.c_str(), val1);
+			PyDict_SetItem(pyDict_, iter->second->pyKeyName, val1);
 			
 			// 由于PyDict_SetItem会增加引用因此需要减
 			Py_DECREF(val1);
@@ -268,7 +269,32 @@ int FixedDict::mp_ass_subscript(PyObject* self, PyObject* key, PyObject* value)
 	PyObject* val1 = 
 		static_cast<FixedDictType*>(fixedDict->getDataType())->createNewItemFromObj(dictKeyName, value);
 
+	if(fixedDict->ownerLink_.ownerID != 0)
+	{
+		PyObject* pyOldValue = PyDict_GetItem(fixedDict->pyDict_, key);
+		if(pyOldValue)
+			PropertyPatch::onKeyRemoving(fixedDict, pyOldValue);
+	}
+
 	int ret = PyDict_SetItem(fixedDict->pyDict_, key, val1);
+
+	// 属性已关联到实体上， 生成增量同步补丁
+	if(ret == 0 && fixedDict->ownerLink_.ownerID != 0)
+	{
+		FixedDictType::FIXEDDICT_KEYTYPE_MAP& keyTypes = fixedDict->_dataType->getKeyTypes();
+		for(size_t i = 0; i < keyTypes.size(); ++i)
+		{
+			if(keyTypes[i].first == dictKeyName)
+			{
+				if(i <= 0xff)
+					PropertyPatch::onKeyChanged(fixedDict, (uint8)i, val1);
+				else
+					PropertyPatch::onContainerChanged(fixedDict);
+
+				break;
+			}
+		}
+	}
 	
 	// 由于PyDict_SetItem会增加引用因此需要减
 	Py_DECREF(val1);
@@ -342,6 +368,13 @@ PyObject* FixedDict::update(PyObject* args)
 			PyObject* val1 = 
 				static_cast<FixedDictType*>(getDataType())->createNewItemFromObj(iter->first.c_str(), val);
 
+			if(ownerLink_.ownerID != 0)
+			{
+				PyObject* pyOldValue = PyDict_GetItem(pyDict_, iter->second->pyKeyName);
+				if(pyOldValue)
+					PropertyPatch::onKeyRemoving(this, pyOldValue);
+			}
+
 			PyDict_SetItemString(pyDict_, iter->first.c_str(), val1);
 			
 			// 由于PyDict_SetItem会增加引用因此需要减
@@ -349,6 +382,9 @@ PyObject* FixedDict::update(PyObject* args)
 		}
 	}
 
+	if(ownerLink_.ownerID != 0)
+		PropertyPatch::onContainerChanged(this);
+
 	S_Return; 
 }
 
@@ -27,6 +27,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "common/common.h"
 #include "pyscript/map.h"
 #include "pyscript/pickler.h"
+#include "property_patch.h"
 
 namespace KBEngine{
 
@@ -45,6 +46,8 @@ public:
 
 	DataType* getDataType(void){ return _dataType; }
 
+	PropertyOwnerLink& ownerLink(){ return ownerLink_; }
+
 	/** 
 		支持pickler 方法 
 	*/
@@ -97,6 +100,9 @@ public:
 
 protected:
 	FixedDictType* _dataType;
+
+	// 所属的实体属性， 用于增量同步
+	PropertyOwnerLink ownerLink_;
 } ;
 
 }
@@ -84,7 +84,7 @@ bool MethodDescription::pushArgType(DataType* dataType)
 }
 
 //-------------------------------------------------------------------------------------
-bool MethodDescription::checkArgs(PyObject* args)
+bool MethodDescription::checkArgsSize(PyObject* args, int& offset)
 {
 	if (args == NULL || !PyTuple_Check(args))
 	{
@@ -95,7 +95,7 @@ bool MethodDescription::checkArgs(PyObject* args)
 		return false;
 	}
 	
-	int offset = (isExposed() == true && g_componentType == CELLAPP_TYPE && isCell()) ? 1 : 0;
+	offset = (isExposed() == true && g_componentType == CELLAPP_TYPE && isCell()) ? 1 : 0;
 	uint8 argsSize = (uint8)argTypes_.size();
 	uint8 giveArgsSize = (uint8)PyTuple_Size(args);
 
@@ -134,35 +134,49 @@ bool MethodDescription::checkArgs(PyObject* args)
 			Py_DECREF(pyeid);
 		}
 	}	
+
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+bool MethodDescription::checkArgType(uint8 i, PyObject* pyArg)
+{
+	if (argTypes_[i]->isSameType(pyArg))
+		return true;
+
+	PyObject* pExample = argTypes_[i]->parseDefaultStr("");
+	PyErr_Format(PyExc_AssertionError,
+		"Method::checkArgs: method[%s] argument %d: Expected %s, %s found",
+		getName(),
+		i+1,
+		pExample->ob_type->tp_name,
+		pyArg != NULL ? pyArg->ob_type->tp_name : "NULL");
 	
+	PyErr_PrintEx(0);
+	Py_DECREF(pExample);
+	return false;
+}
+
+//-------------------------------------------------------------------------------------
+bool MethodDescription::checkArgs(PyObject* args)
+{
+	int offset = 0;
+	if (!checkArgsSize(args, offset))
+		return false;
+	
+	uint8 argsSize = (uint8)argTypes_.size();
 	for(uint8 i=0; i <argsSize; ++i)
 	{
-		PyObject* pyArg = PyTuple_GetItem(args, i + offset);
-		if (!argTypes_[i]->isSameType(pyArg))
-		{
-			PyObject* pExample = argTypes_[i]->parseDefaultStr("");
-			PyErr_Format(PyExc_AssertionError,
-				"Method::checkArgs: method[%s] argument %d: Expected %s, %s found",
-				getName(),
-				i+1,
-				pExample->ob_type->tp_name,
-				pyArg != NULL ? pyArg->ob_type->tp_name : "NULL");
-			
-			PyErr_PrintEx(0);
-			Py_DECREF(pExample);
+		if (!checkArgType(i, PyTuple_GetItem(args, i + offset)))
 			return false;
-		}
 	}
 
 	return true;
 }
 
 //-------------------------------------------------------------------------------------
-void MethodDescription::addToStream(MemoryStream* mstream, PyObject* args)
+void MethodDescription::addUTypeToStream(MemoryStream* mstream)
 {
-	uint8 argsSize = argTypes_.size();
-	int offset = 0;
-
 	// 将utype放进去，方便对端识别这个方法
 	// 这里如果aliasID_大于0则采用一个优化的办法， 使用1字节传输
 	// 注意：在加载def时指定了客户端方法才设置aliasID，因此服务器内部不使用aliasID
@@ -175,6 +189,15 @@ void MethodDescription::addToStream(MemoryStream* mstream, PyObject* args)
 		uint8 utype = (uint8)aliasID_;
 		(*mstream) << utype;
 	}
+}
+
+//-------------------------------------------------------------------------------------
+void MethodDescription::addToStream(MemoryStream* mstream, PyObject* args)
+{
+	uint8 argsSize = argTypes_.size();
+	int offset = 0;
+
+	addUTypeToStream(mstream);
 
 	// 如果是exposed方法则先将entityID打包进去
 	if(isExposed() && g_componentType == CELLAPP_TYPE && isCell())
@@ -190,6 +213,29 @@ void MethodDescription::addToStream(MemoryStream* mstream, PyObject* args)
 	}
 }
 
+//-------------------------------------------------------------------------------------
+bool MethodDescription::checkArgsAndAddToStream(MemoryStream* mstream, PyObject* args)
+{
+	int offset = 0;
+	if (!checkArgsSize(args, offset))
+		return false;
+
+	addUTypeToStream(mstream);
+
+	// 每个参数检查通过后立即打包， 不再单独遍历一次
+	uint8 argsSize = (uint8)argTypes_.size();
+	for(uint8 i=0; i <argsSize; ++i)
+	{
+		PyObject* pyArg = PyTuple_GET_ITEM(args, i + offset);
+		if (!checkArgType(i, pyArg))
+			return false;
+
+		argTypes_[i]->addToStream(mstream, pyArg);
+	}
+
+	return true;
+}
+
 //-------------------------------------------------------------------------------------
 PyObject* MethodDescription::createFromStream(MemoryStream* mstream)
 {
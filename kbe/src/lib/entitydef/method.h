@@ -76,6 +76,12 @@ public:
 	*/
 	void addToStream(MemoryStream* mstream, PyObject* args);
 
+	/** 
+		检查参数的同时将其打包到流， 只遍历一次参数
+		返回false时流中的数据不完整， 调用者应丢弃
+	*/
+	bool checkArgsAndAddToStream(MemoryStream* mstream, PyObject* args);
+
 	/** 
 		将一个call流解包 并返回一个PyObject类型的args 
 	*/
@@ -100,6 +106,11 @@ public:
 	INLINE uint8 aliasIDAsUint8() const;
 	INLINE void aliasID(int16 v);
 	
+protected:
+	bool checkArgsSize(PyObject* args, int& offset);
+	bool checkArgType(uint8 i, PyObject* pyArg);
+	void addUTypeToStream(MemoryStream* mstream);
+
 protected:
 	static uint32							methodDescriptionCount_;					// 所有的属性描述的数量
 
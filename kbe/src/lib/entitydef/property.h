@@ -113,6 +113,7 @@ public:
 		设置这个属性为索引键 
 	*/
 	INLINE void setIdentifier(bool isIdentifier);
+	INLINE bool isIdentifier() const;
 	
 	/** 
 		设置这个属性在数据库中的长度 
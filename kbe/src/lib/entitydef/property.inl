@@ -71,6 +71,11 @@ INLINE void PropertyDescription::setIdentifier(bool isIdentifier)
 	isIdentifier_ = isIdentifier; 
 }
 
+INLINE bool PropertyDescription::isIdentifier() const
+{ 
+	return isIdentifier_; 
+}
+
 INLINE void PropertyDescription::setDatabaseLength(uint32 databaseLength)
 { 
 	databaseLength_ = databaseLength; 
@@ -0,0 +1,500 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "property_patch.h"
+#include "fixedarray.h"
+#include "fixeddict.h"
+#include "entitydef.h"
+
+namespace KBEngine{ 
+
+PropertyPatch::PatchHandler PropertyPatch::handler_ = NULL;
+
+// 容器嵌套层数上限， 路径深度用uint8描述， 同时防止容器包含自身时无限递归
+static const int MAX_PATCH_DEPTH = 255;
+
+//-------------------------------------------------------------------------------------
+PropertyOwnerLink* PropertyPatch::getLink(PyObject* pyobj)
+{
+	if(pyobj == NULL)
+		return NULL;
+
+	if(PyObject_TypeCheck(pyobj, FixedArray::getScriptType()))
+		return &static_cast<FixedArray*>(pyobj)->ownerLink();
+
+	if(PyObject_TypeCheck(pyobj, FixedDict::getScriptType()))
+		return &static_cast<FixedDict*>(pyobj)->ownerLink();
+
+	return NULL;
+}
+
+//-------------------------------------------------------------------------------------
+void PropertyPatch::attach(ENTITY_ID ownerID, const PropertyDescription* pPropertyDescription, PyObject* pyRoot)
+{
+	PropertyOwnerLink* pLink = getLink(pyRoot);
+	if(pLink == NULL)
+		return;
+
+	// 已经关联过了， 后续加入的子容器在修改时会自动关联
+	if(pLink->ownerID == ownerID && pLink->pPropertyDescription == pPropertyDescription && 
+		pLink->pParent == NULL)
+		return;
+
+	attach_(pyRoot, ownerID, pPropertyDescription, NULL);
+}
+
+//-------------------------------------------------------------------------------------
+void PropertyPatch::attach_(PyObject* pyobj, ENTITY_ID ownerID, 
+	const PropertyDescription* pPropertyDescription, PyObject* pyParent)
+{
+	PropertyOwnerLink* pLink = getLink(pyobj);
+	if(pLink == NULL)
+		return;
+
+	int depth = 0;
+	for(PyObject* pyTemp = pyParent; pyTemp != NULL; pyTemp = getLink(pyTemp)->pParent)
+	{
+		if(++depth >= MAX_PATCH_DEPTH)
+		{
+			WARNING_MSG(fmt::format("PropertyPatch::attach: {} is nested too deep!\n", 
+				pPropertyDescription->getName()));
+
+			return;
+		}
+	}
+
+	pLink->ownerID = ownerID;
+	pLink->pPropertyDescription = pPropertyDescription;
+	pLink->pParent = pyParent;
+
+	if(PyObject_TypeCheck(pyobj, FixedArray::getScriptType()))
+	{
+		std::vector<PyObject*>& values = static_cast<FixedArray*>(pyobj)->getValues();
+		for(size_t i = 0; i < values.size(); ++i)
+		{
+			if(values[i] != pyobj)
+				attach_(values[i], ownerID, pPropertyDescription, pyobj);
+		}
+	}
+	else
+	{
+		PyObject* pyKey = NULL;
+		PyObject* pyValue = NULL;
+		Py_ssize_t pos = 0;
+
+		while(PyDict_Next(static_cast<FixedDict*>(pyobj)->getDictObject(), &pos, &pyKey, &pyValue))
+		{
+			if(pyValue != pyobj)
+				attach_(pyValue, ownerID, pPropertyDescription, pyobj);
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void PropertyPatch::detach_(PyObject* pyobj)
+{
+	PropertyOwnerLink* pLink = getLink(pyobj);
+	if(pLink == NULL || pLink->ownerID == 0)
+		return;
+
+	pLink->ownerID = 0;
+	pLink->pPropertyDescription = NULL;
+	pLink->pParent = NULL;
+
+	detachChildren(pyobj);
+}
+
+//-------------------------------------------------------------------------------------
+void PropertyPatch::detachChildren(PyObject* pyParent)
+{
+	if(PyObject_TypeCheck(pyParent, FixedArray::getScriptType()))
+	{
+		std::vector<PyObject*>& values = static_cast<FixedArray*>(pyParent)->getValues();
+		for(size_t i = 0; i < values.size(); ++i)
+		{
+			PropertyOwnerLink* pLink = getLink(values[i]);
+			if(pLink && pLink->pParent == pyParent)
+				detach_(values[i]);
+		}
+	}
+	else if(PyObject_TypeCheck(pyParent, FixedDict::getScriptType()))
+	{
+		PyObject* pyKey = NULL;
+		PyObject* pyValue = NULL;
+		Py_ssize_t pos = 0;
+
+		while(PyDict_Next(static_cast<FixedDict*>(pyParent)->getDictObject(), &pos, &pyKey, &pyValue))
+		{
+			PropertyOwnerLink* pLink = getLink(pyValue);
+			if(pLink && pLink->pParent == pyParent)
+				detach_(pyValue);
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------
+PyObject* PropertyPatch::findRoot(PyObject* pyContainer)
+{
+	int depth = 0;
+	PropertyOwnerLink* pLink = getLink(pyContainer);
+
+	while(pLink && pLink->pParent)
+	{
+		if(++depth > MAX_PATCH_DEPTH)
+			return NULL;
+
+		pyContainer = pLink->pParent;
+		pLink = getLink(pyContainer);
+	}
+
+	return pyContainer;
+}
+
+//-------------------------------------------------------------------------------------
+void PropertyPatch::notify(PyObject* pyContainer, MemoryStream* pPatch)
+{
+	PyObject* pyRoot = findRoot(pyContainer);
+	if(pyRoot == NULL)
+		return;
+
+	PropertyOwnerLink* pLink = getLink(pyRoot);
+	if(pLink == NULL || pLink->ownerID == 0 || handler_ == NULL)
+		return;
+
+	handler_(pLink->ownerID, pLink->pPropertyDescription, pyRoot, pPatch);
+}
+
+//-------------------------------------------------------------------------------------
+static bool writePathStep(MemoryStream* pPatch, PyObject* pyParent, PyObject* pyChild)
+{
+	int found = -1;
+
+	if(PyObject_TypeCheck(pyParent, FixedArray::getScriptType()))
+	{
+		std::vector<PyObject*>& values = static_cast<FixedArray*>(pyParent)->getValues();
+		for(size_t i = 0; i < values.size(); ++i)
+		{
+			if(values[i] != pyChild)
+				continue;
+
+			// 同一个对象出现在多个位置， 无法确定路径
+			if(found >= 0)
+				return false;
+
+			found = (int)i;
+		}
+
+		if(found < 0)
+			return false;
+
+		(*pPatch) << (uint32)found;
+		return true;
+	}
+
+	FixedDictType::FIXEDDICT_KEYTYPE_MAP& keyTypes = 
+		static_cast<FixedDictType*>(static_cast<FixedDict*>(pyParent)->getDataType())->getKeyTypes();
+
+	for(size_t i = 0; i < keyTypes.size() && i <= 0xff; ++i)
+	{
+		if(PyDict_GetItem(static_cast<FixedDict*>(pyParent)->getDictObject(), keyTypes[i].second->pyKeyName) != pyChild)
+			continue;
+
+		if(found >= 0)
+			return false;
+
+		found = (int)i;
+	}
+
+	if(found < 0)
+		return false;
+
+	(*pPatch) << (uint8)found;
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+bool PropertyPatch::writePath(MemoryStream* pPatch, PyObject* pyContainer, uint8 op)
+{
+	// 自底向上收集容器链， chain.back()为根容器
+	PyObject* chain[MAX_PATCH_DEPTH];
+	int chainSize = 0;
+
+	PyObject* pyobj = pyContainer;
+	while(true)
+	{
+		if(chainSize >= MAX_PATCH_DEPTH)
+			return false;
+
+		chain[chainSize++] = pyobj;
+
+		PropertyOwnerLink* pLink = getLink(pyobj);
+		if(pLink->pParent == NULL)
+			break;
+
+		pyobj = pLink->pParent;
+	}
+
+	// 路径深度包括最后指向被修改位置的节点
+	(*pPatch) << op << (uint8)chainSize;
+
+	for(int i = chainSize - 1; i > 0; --i)
+	{
+		if(!writePathStep(pPatch, chain[i], chain[i - 1]))
+			return false;
+	}
+
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+void PropertyPatch::onSequenceRemoving(FixedArray* pArray, Py_ssize_t index1, Py_ssize_t index2)
+{
+	if(pArray->ownerLink().ownerID == 0)
+		return;
+
+	std::vector<PyObject*>& values = pArray->getValues();
+	for(Py_ssize_t i = index1; i < index2 && i < (Py_ssize_t)values.size(); ++i)
+	{
+		PropertyOwnerLink* pLink = getLink(values[i]);
+		if(pLink && pLink->pParent == pArray)
+			detach_(values[i]);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void PropertyPatch::onSequenceChanged(FixedArray* pArray, Py_ssize_t index1, Py_ssize_t index2, Py_ssize_t count)
+{
+	PropertyOwnerLink& link = pArray->ownerLink();
+	if(link.ownerID == 0 || handler_ == NULL)
+		return;
+
+	std::vector<PyObject*>& values = pArray->getValues();
+	for(Py_ssize_t i = index1; i < index1 + count && i < (Py_ssize_t)values.size(); ++i)
+	{
+		if(values[i] != pArray)
+			attach_(values[i], link.ownerID, link.pPropertyDescription, pArray);
+	}
+
+	uint8 op = 0;
+	if(index2 - index1 == 1 && count == 1)
+		op = OP_SET_ITEM;
+	else if(index2 == index1 && count == 1)
+		op = OP_INSERT_ITEM;
+	else if(index2 - index1 == 1 && count == 0)
+		op = OP_REMOVE_ITEM;
+
+	if(op == 0)
+	{
+		notify(pArray, NULL);
+		return;
+	}
+
+	MemoryStream* pPatch = MemoryStream::createPoolObject();
+
+	if(writePath(pPatch, pArray, op))
+	{
+		(*pPatch) << (uint32)index1;
+
+		if(op != OP_REMOVE_ITEM)
+		{
+			EntityDef::context().currComponentType = g_componentType;
+			pArray->getArrayType()->getDataType()->addToStream(pPatch, values[index1]);
+		}
+
+		notify(pArray, pPatch);
+	}
+	else
+	{
+		notify(pArray, NULL);
+	}
+
+	MemoryStream::reclaimPoolObject(pPatch);
+}
+
+//-------------------------------------------------------------------------------------
+void PropertyPatch::onKeyRemoving(FixedDict* pDict, PyObject* pyOldValue)
+{
+	if(pDict->ownerLink().ownerID == 0)
+		return;
+
+	PropertyOwnerLink* pLink = getLink(pyOldValue);
+	if(pLink && pLink->pParent == pDict)
+		detach_(pyOldValue);
+}
+
+//-------------------------------------------------------------------------------------
+void PropertyPatch::onKeyChanged(FixedDict* pDict, uint8 keyIndex, PyObject* pyValue)
+{
+	PropertyOwnerLink& link = pDict->ownerLink();
+	if(link.ownerID == 0 || handler_ == NULL)
+		return;
+
+	if(pyValue != pDict)
+		attach_(pyValue, link.ownerID, link.pPropertyDescription, pDict);
+
+	FixedDictType::FIXEDDICT_KEYTYPE_MAP& keyTypes = 
+		static_cast<FixedDictType*>(pDict->getDataType())->getKeyTypes();
+
+	MemoryStream* pPatch = MemoryStream::createPoolObject();
+
+	if(keyIndex < keyTypes.size() && writePath(pPatch, pDict, OP_SET_KEY))
+	{
+		(*pPatch) << keyIndex;
+
+		EntityDef::context().currComponentType = g_componentType;
+		keyTypes[keyIndex].second->dataType->addToStream(pPatch, pyValue);
+
+		notify(pDict, pPatch);
+	}
+	else
+	{
+		notify(pDict, NULL);
+	}
+
+	MemoryStream::reclaimPoolObject(pPatch);
+}
+
+//-------------------------------------------------------------------------------------
+void PropertyPatch::onContainerChanged(PyObject* pyContainer)
+{
+	PropertyOwnerLink* pLink = getLink(pyContainer);
+	if(pLink == NULL || pLink->ownerID == 0 || handler_ == NULL)
+		return;
+
+	notify(pyContainer, NULL);
+}
+
+//-------------------------------------------------------------------------------------
+static PyObject* readPathStep(MemoryStream& s, PyObject* pyContainer)
+{
+	if(PyObject_TypeCheck(pyContainer, FixedArray::getScriptType()))
+	{
+		uint32 index = 0;
+		s >> index;
+
+		std::vector<PyObject*>& values = static_cast<FixedArray*>(pyContainer)->getValues();
+		if(index >= values.size())
+			return NULL;
+
+		return values[index];
+	}
+
+	if(PyObject_TypeCheck(pyContainer, FixedDict::getScriptType()))
+	{
+		uint8 keyIndex = 0;
+		s >> keyIndex;
+
+		FixedDictType::FIXEDDICT_KEYTYPE_MAP& keyTypes = 
+			static_cast<FixedDictType*>(static_cast<FixedDict*>(pyContainer)->getDataType())->getKeyTypes();
+
+		if(keyIndex >= keyTypes.size())
+			return NULL;
+
+		return PyDict_GetItem(static_cast<FixedDict*>(pyContainer)->getDictObject(), keyTypes[keyIndex].second->pyKeyName);
+	}
+
+	return NULL;
+}
+
+//-------------------------------------------------------------------------------------
+bool PropertyPatch::apply(MemoryStream& s, PyObject* pyRoot)
+{
+	uint8 op = 0;
+	uint8 depth = 0;
+	s >> op >> depth;
+
+	if(depth == 0)
+		return false;
+
+	PyObject* pyContainer = pyRoot;
+	for(uint8 i = 0; i < depth - 1; ++i)
+	{
+		pyContainer = readPathStep(s, pyContainer);
+		if(pyContainer == NULL)
+			return false;
+	}
+
+	if(PyObject_TypeCheck(pyContainer, FixedArray::getScriptType()))
+	{
+		FixedArray* pArray = static_cast<FixedArray*>(pyContainer);
+		std::vector<PyObject*>& values = pArray->getValues();
+
+		uint32 index = 0;
+		s >> index;
+
+		if(op == OP_REMOVE_ITEM)
+		{
+			if(index >= values.size())
+				return false;
+
+			Py_DECREF(values[index]);
+			values.erase(values.begin() + index);
+			return true;
+		}
+
+		if((op == OP_SET_ITEM && index >= values.size()) || 
+			(op == OP_INSERT_ITEM && index > values.size()) ||
+			(op != OP_SET_ITEM && op != OP_INSERT_ITEM))
+			return false;
+
+		PyObject* pyValue = pArray->getArrayType()->getDataType()->createFromStream(&s);
+		if(pyValue == NULL)
+			return false;
+
+		if(op == OP_SET_ITEM)
+		{
+			Py_DECREF(values[index]);
+			values[index] = pyValue;
+		}
+		else
+		{
+			values.insert(values.begin() + index, pyValue);
+		}
+
+		return true;
+	}
+	
+	if(op == OP_SET_KEY && PyObject_TypeCheck(pyContainer, FixedDict::getScriptType()))
+	{
+		FixedDict* pDict = static_cast<FixedDict*>(pyContainer);
+
+		uint8 keyIndex = 0;
+		s >> keyIndex;
+
+		FixedDictType::FIXEDDICT_KEYTYPE_MAP& keyTypes = 
+			static_cast<FixedDictType*>(pDict->getDataType())->getKeyTypes();
+
+		if(keyIndex >= keyTypes.size())
+			return false;
+
+		PyObject* pyValue = keyTypes[keyIndex].second->dataType->createFromStream(&s);
+		if(pyValue == NULL)
+			return false;
+
+		PyDict_SetItem(pDict->getDictObject(), keyTypes[keyIndex].second->pyKeyName, pyValue);
+		Py_DECREF(pyValue);
+		return true;
+	}
+
+	return false;
+}
+
+//-------------------------------------------------------------------------------------
+}
@@ -0,0 +1,129 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KBE_PROPERTY_PATCH_H
+#define KBE_PROPERTY_PATCH_H
+
+#include "common/common.h"
+#include "common/memorystream.h"
+#include "helper/debug_helper.h"
+#include "pyscript/scriptobject.h"
+
+namespace KBEngine{
+
+class PropertyDescription;
+class FixedArray;
+class FixedDict;
+
+/*
+	容器对象(FIXED_ARRAY/FIXED_DICT)与实体属性之间的关联
+	pParent不持有引用， 父容器移除或销毁子容器时会断开关联
+*/
+struct PropertyOwnerLink
+{
+	PropertyOwnerLink():
+	ownerID(0),
+	pPropertyDescription(NULL),
+	pParent(NULL)
+	{
+	}
+
+	ENTITY_ID ownerID;
+	const PropertyDescription* pPropertyDescription;
+
+	// 为NULL时表示自身就是属性的根容器
+	PyObject* pParent;
+};
+
+/*
+	容器属性的增量同步
+	实体的容器属性被原地修改时(例如: self.items.append(x)、self.info["hp"] = 1)，
+	生成一条只描述这次修改的补丁， 而不必重新序列化整个属性。
+
+	补丁格式:
+		uint8 op, uint8 depth, 
+		depth个路径节点(数组层为uint32下标， 字典层为uint8键序号， 最后一个节点指向被修改的位置)，
+		op不为OP_REMOVE_ITEM时后面跟随新元素数据
+
+	注意: 同一个容器对象同时出现在多个位置时只跟踪最后一次关联的位置，
+	其他位置的副本依赖定期的全量同步来纠正。
+*/
+class PropertyPatch
+{
+public:
+	enum OP
+	{
+		OP_SET_ITEM = 1,
+		OP_INSERT_ITEM = 2,
+		OP_REMOVE_ITEM = 3,
+		OP_SET_KEY = 4
+	};
+
+	// pPatch为NULL时表示这次修改无法用补丁描述， 需要全量同步该属性
+	typedef void (*PatchHandler)(ENTITY_ID ownerID, const PropertyDescription* pPropertyDescription, 
+		PyObject* pyRoot, MemoryStream* pPatch);
+
+	static void handler(PatchHandler h){ handler_ = h; }
+	static bool isEnabled(){ return handler_ != NULL; }
+
+	static PropertyOwnerLink* getLink(PyObject* pyobj);
+
+	/** 
+		将一个属性值及其所有子容器关联到实体属性上
+	*/
+	static void attach(ENTITY_ID ownerID, const PropertyDescription* pPropertyDescription, PyObject* pyRoot);
+
+	/** 
+		断开pyParent下所有子容器的关联， 容器销毁时调用
+	*/
+	static void detachChildren(PyObject* pyParent);
+
+	/** 
+		容器修改通知
+	*/
+	static void onSequenceRemoving(FixedArray* pArray, Py_ssize_t index1, Py_ssize_t index2);
+	static void onSequenceChanged(FixedArray* pArray, Py_ssize_t index1, Py_ssize_t index2, Py_ssize_t count);
+	static void onKeyRemoving(FixedDict* pDict, PyObject* pyOldValue);
+	static void onKeyChanged(FixedDict* pDict, uint8 keyIndex, PyObject* pyValue);
+	static void onContainerChanged(PyObject* pyContainer);
+
+	/** 
+		将补丁应用到属性值上， 失败时s的读取位置不再可信
+	*/
+	static bool apply(MemoryStream& s, PyObject* pyRoot);
+
+protected:
+	static void attach_(PyObject* pyobj, ENTITY_ID ownerID, 
+		const PropertyDescription* pPropertyDescription, PyObject* pyParent);
+
+	static void detach_(PyObject* pyobj);
+
+	static PyObject* findRoot(PyObject* pyContainer);
+
+	static bool writePath(MemoryStream* pPatch, PyObject* pyContainer, uint8 op);
+
+	static void notify(PyObject* pyContainer, MemoryStream* pPatch);
+
+	static PatchHandler handler_;
+};
+
+}
+
+#endif // KBE_PROPERTY_PATCH_H
@@ -49,7 +49,22 @@ pEntityCall_(entityCall)
 //-------------------------------------------------------------------------------------
 RemoteEntityMethod::~RemoteEntityMethod()
 {
-	Py_DECREF(pEntityCall_);
+	Py_XDECREF(pEntityCall_);
+}
+
+//-------------------------------------------------------------------------------------
+void RemoteEntityMethod::onDealloc(RemoteEntityMethod* pMethod)
+{
+	EntityCallAbstract* pEntityCall = pMethod->pEntityCall_;
+
+	if(pEntityCall && pEntityCall->reclaimRemoteMethod(pMethod))
+	{
+		// 对象已回收到entityCall中， 释放对entityCall的引用
+		Py_DECREF(pEntityCall);
+		return;
+	}
+
+	delete pMethod;
 }
 
 //-------------------------------------------------------------------------------------
@@ -67,7 +82,10 @@ PyObject* RemoteEntityMethod::tp_call(PyObject* self, PyObject* args,
 	EntityCallAbstract* entityCall = rmethod->getEntityCall();
 	// DEBUG_MSG(fmt::format("RemoteEntityMethod::tp_call:{}.\n"), methodDescription->getName()));
 
-	if(methodDescription->checkArgs(args))
+	// 检查参数的同时打包到对象池中的流， 流保留了之前的容量， 通常无需再分配内存
+	MemoryStream* mstream = MemoryStream::createPoolObject();
+
+	if(methodDescription->checkArgsAndAddToStream(mstream, args))
 	{
 		Network::Channel* pChannel = entityCall->getChannel();
 		Network::Bundle* pSendBundle = NULL;
@@ -79,11 +97,8 @@ PyObject* RemoteEntityMethod::tp_call(PyObject* self, PyObject* args,
 
 		entityCall->newCall((*pSendBundle));
 
-		MemoryStream mstream;
-		methodDescription->addToStream(&mstream, args);
-
-		if(mstream.wpos() > 0)
-			(*pSendBundle).append(mstream.data(), mstream.wpos());
+		if(mstream->wpos() > 0)
+			(*pSendBundle).append(mstream->data(), (int)mstream->wpos());
 
 		entityCall->sendCall(pSendBundle);
 	}
@@ -93,6 +108,7 @@ PyObject* RemoteEntityMethod::tp_call(PyObject* self, PyObject* args,
                 methodDescription->getName()));
 	}
 
+	MemoryStream::reclaimPoolObject(mstream);
 	S_Return;
 }		
 	
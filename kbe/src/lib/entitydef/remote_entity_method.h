@@ -39,10 +39,21 @@ namespace KBEngine{
 
 class MethodDescription;
 
+/** 
+	远程方法对象引用计数归0时先尝试回收到所属的entityCall中， 
+	下次访问同一方法时直接复用而不必重新分配
+*/
+#define REMOTE_ENTITY_METHOD_HREADER(CLASS, SUPERCLASS)										\
+	SCRIPT_HREADER_BASE(CLASS, SUPERCLASS);													\
+	static void _tp_dealloc(PyObject* self)													\
+	{																						\
+		RemoteEntityMethod::onDealloc(static_cast<CLASS*>(self));							\
+	}																						\
+
 class RemoteEntityMethod : public script::ScriptObject
 {
 	/** 子类化 将一些py操作填充进派生类 */
-	INSTANCE_SCRIPT_HREADER(RemoteEntityMethod, script::ScriptObject)	
+	REMOTE_ENTITY_METHOD_HREADER(RemoteEntityMethod, script::ScriptObject)	
 		
 public:	
 	RemoteEntityMethod(MethodDescription* methodDescription, 
@@ -64,6 +75,16 @@ public:
 	{
 		return pEntityCall_; 
 	}
+
+	/** 
+		被回收到entityCall中的对象已经不再持有entityCall， 析构前调用
+	*/
+	void releaseEntityCall()
+	{
+		pEntityCall_ = NULL;
+	}
+
+	static void onDealloc(RemoteEntityMethod* pMethod);
 	
 protected:	
 	MethodDescription*		methodDescription_;					// 这个方法的描述
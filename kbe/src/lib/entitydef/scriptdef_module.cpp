@@ -72,7 +72,10 @@ componentDescr_uidmap_(),
 componentDescr_(),
 componentPropertyDescr_(),
 persistent_(true),
-isComponentModule_(false)
+isComponentModule_(false),
+assertionHasClient_(-1),
+assertionHasCell_(-1),
+assertionHasBase_(-1)
 {
 	EntityDef::md5().append((void*)name.c_str(), (int)name.size());
 }
@@ -329,8 +332,8 @@ void ScriptDefModule::autoMatchCompOwn()
 	std::string entitiesFile = Resmgr::getSingleton().getPyUserScriptsPath() + "entities.xml";
 
 	// 打开这个entities.xml文件
-	SmartPointer<XML> xml(new XML());
-	if(!xml->openSection(entitiesFile.c_str()) || !xml->isGood())
+	SmartPointer<XML> xml = EntityDef::openDefXML(entitiesFile);
+	if(xml == NULL || !xml->isGood())
 		return;
 	
 	// 获得entities.xml根节点, 如果没有定义一个entity那么直接返回true
@@ -385,12 +388,22 @@ void ScriptDefModule::autoMatchCompOwn()
 	}
 	XML_FOR_END(node);
 
+	assertionHasClient_ = (int8)assertionHasClient;
+	assertionHasCell_ = (int8)assertionHasCell;
+	assertionHasBase_ = (int8)assertionHasBase;
+
+	matchCompOwn();
+}
+
+//-------------------------------------------------------------------------------------
+void ScriptDefModule::matchCompOwn()
+{
 	std::string fmodule = "scripts/client/" + name_ + ".py";
 	std::string fmodule_pyc = fmodule + "c";
 	if(Resmgr::getSingleton().matchRes(fmodule) != fmodule ||
 		Resmgr::getSingleton().matchRes(fmodule_pyc) != fmodule_pyc)
 	{
-		if (assertionHasClient < 0)
+		if (assertionHasClient_ < 0)
 		{
 			// 如果用户不存在明确声明并设置为没有对应实体部分
 			// 这样做的原因是允许用户在def文件定义这部分的内容(因为interface的存在，interface中可能会存在客户端属性或者方法)
@@ -401,12 +414,12 @@ void ScriptDefModule::autoMatchCompOwn()
 		else
 		{
 			// 用户明确声明并进行了设定
-			setClient(assertionHasClient == 1);
+			setClient(assertionHasClient_ == 1);
 		}
 	}
 	else
 	{
-		if(assertionHasClient < 0)
+		if(assertionHasClient_ < 0)
 		{
 			// 如果用户不存在明确声明并设置为没有对应实体部分
 			// 这样做的原因是允许用户在def文件定义这部分的内容(因为interface的存在，interface中可能会存在客户端属性或者方法)
@@ -417,7 +430,7 @@ void ScriptDefModule::autoMatchCompOwn()
 		else
 		{
 			// 用户明确声明并进行了设定
-			setClient(assertionHasClient == 1);
+			setClient(assertionHasClient_ == 1);
 		}
 	}
 
@@ -433,7 +446,7 @@ void ScriptDefModule::autoMatchCompOwn()
 	if(Resmgr::getSingleton().matchRes(fmodule) != fmodule ||
 		Resmgr::getSingleton().matchRes(fmodule_pyc) != fmodule_pyc)
 	{
-		if (assertionHasBase < 0)
+		if (assertionHasBase_ < 0)
 		{
 			// 如果用户不存在明确声明并设置为没有对应实体部分
 			// 这样做的原因是允许用户在def文件定义这部分的内容(因为interface的存在，interface中可能会存在base属性或者方法)
@@ -444,12 +457,12 @@ void ScriptDefModule::autoMatchCompOwn()
 		else
 		{
 			// 用户明确声明并进行了设定
-			setBase(assertionHasBase == 1);
+			setBase(assertionHasBase_ == 1);
 		}
 	}
 	else
 	{
-		if(assertionHasBase < 0)
+		if(assertionHasBase_ < 0)
 		{
 			// 如果用户不存在明确声明并设置为没有对应实体部分
 			// 这样做的原因是允许用户在def文件定义这部分的内容(因为interface的存在，interface中可能会存在base属性或者方法)
@@ -460,7 +473,7 @@ void ScriptDefModule::autoMatchCompOwn()
 		else
 		{
 			// 用户明确声明并进行了设定
-			setBase(assertionHasBase == 1);
+			setBase(assertionHasBase_ == 1);
 		}
 	}
 
@@ -469,7 +482,7 @@ void ScriptDefModule::autoMatchCompOwn()
 	if(Resmgr::getSingleton().matchRes(fmodule) != fmodule ||
 		Resmgr::getSingleton().matchRes(fmodule_pyc) != fmodule_pyc)
 	{
-		if (assertionHasCell < 0)
+		if (assertionHasCell_ < 0)
 		{
 			// 如果用户不存在明确声明并设置为没有对应实体部分
 			// 这样做的原因是允许用户在def文件定义这部分的内容(因为interface的存在，interface中可能会存在cell属性或者方法)
@@ -480,12 +493,12 @@ void ScriptDefModule::autoMatchCompOwn()
 		else
 		{
 			// 用户明确声明并进行了设定
-			setCell(assertionHasCell == 1);
+			setCell(assertionHasCell_ == 1);
 		}
 	}
 	else
 	{
-		if(assertionHasCell < 0)
+		if(assertionHasCell_ < 0)
 		{
 			// 如果用户不存在明确声明并设置为没有对应实体部分
 			// 这样做的原因是允许用户在def文件定义这部分的内容(因为interface的存在，interface中可能会存在cell属性或者方法)
@@ -496,7 +509,7 @@ void ScriptDefModule::autoMatchCompOwn()
 		else
 		{
 			// 用户明确声明并进行了设定
-			setCell(assertionHasCell == 1);
+			setCell(assertionHasCell_ == 1);
 		}
 	}
 }
@@ -157,6 +157,23 @@ public:
 
 	void autoMatchCompOwn();
 
+	/**
+		根据entities.xml中的声明(autoMatchCompOwn中读取)与脚本文件是否存在决定实体拥有的部分，
+		从entitydef缓存重建时直接使用缓存中的声明
+	*/
+	void matchCompOwn();
+
+	int8 assertionHasClient() const { return assertionHasClient_; }
+	int8 assertionHasCell() const { return assertionHasCell_; }
+	int8 assertionHasBase() const { return assertionHasBase_; }
+
+	void setCompOwnAssertions(int8 hasClient, int8 hasCell, int8 hasBase)
+	{
+		assertionHasClient_ = hasClient;
+		assertionHasCell_ = hasCell;
+		assertionHasBase_ = hasBase;
+	}
+
 	INLINE bool isPersistent() const;
 	INLINE void isPersistent(bool v);
 
@@ -254,6 +271,11 @@ protected:
 	bool								persistent_;
 
 	bool								isComponentModule_;
+
+	// entities.xml中对hasClient、hasCell、hasBase的声明， -1为未声明
+	int8								assertionHasClient_;
+	int8								assertionHasCell_;
+	int8								assertionHasBase_;
 };
 
 
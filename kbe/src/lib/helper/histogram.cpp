@@ -0,0 +1,91 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "histogram.h"
+
+namespace KBEngine { 
+
+//-------------------------------------------------------------------------------------
+Histogram::Histogram()
+{
+	reset();
+}
+
+//-------------------------------------------------------------------------------------
+Histogram::~Histogram()
+{
+}
+
+//-------------------------------------------------------------------------------------
+void Histogram::reset()
+{
+	memset(buckets_, 0, sizeof(buckets_));
+	count_ = 0;
+	sum_ = 0;
+	min_ = (uint64)-1;
+	max_ = 0;
+}
+
+//-------------------------------------------------------------------------------------
+uint64 Histogram::bucketUpperBound(uint32 idx)
+{
+	if(idx < (uint32)HISTOGRAM_SUB_BUCKETS)
+		return idx;
+
+	uint32 msb = idx / HISTOGRAM_SUB_BUCKETS + HISTOGRAM_SUB_BUCKET_BITS - 1;
+	uint64 sub = idx % HISTOGRAM_SUB_BUCKETS;
+	uint32 shift = msb - HISTOGRAM_SUB_BUCKET_BITS;
+
+	return ((HISTOGRAM_SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+//-------------------------------------------------------------------------------------
+uint64 Histogram::valueAtPercentile(double percentile) const
+{
+	if(count_ == 0)
+		return 0;
+
+	if(percentile >= 100.0)
+		return max_;
+
+	if(percentile < 0.0)
+		percentile = 0.0;
+
+	uint64 target = (uint64)(percentile / 100.0 * double(count_));
+	if(target == 0)
+		target = 1;
+
+	uint64 accumulated = 0;
+	for(uint32 i = 0; i < (uint32)HISTOGRAM_BUCKETS; ++i)
+	{
+		accumulated += buckets_[i];
+		if(accumulated >= target)
+		{
+			// 桶的上界不可能超过实际记录到的最大值
+			return KBE_MIN(bucketUpperBound(i), max_);
+		}
+	}
+
+	return max_;
+}
+
+//-------------------------------------------------------------------------------------
+}
@@ -0,0 +1,119 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KBE_HELPER_HISTOGRAM_H
+#define KBE_HELPER_HISTOGRAM_H
+
+#include "common/common.h"
+
+#if KBE_PLATFORM == PLATFORM_WIN32
+#include <intrin.h>
+#endif
+
+namespace KBEngine { 
+
+/*
+	对数-线性分桶的直方图(HDR风格)。
+	每个2的幂区间被等分为HISTOGRAM_SUB_BUCKETS个子桶, 相对误差不超过1/HISTOGRAM_SUB_BUCKETS,
+	记录一次只是一次位运算加一次数组自增, 适合在热点路径上统计耗时、大小等分布。
+	记录值的单位由使用者决定(例如TimeStamp或字节数)。
+*/
+class Histogram
+{
+public:
+	enum
+	{
+		HISTOGRAM_SUB_BUCKET_BITS = 4,
+		HISTOGRAM_SUB_BUCKETS = 1 << HISTOGRAM_SUB_BUCKET_BITS,
+
+		// 超过2^HISTOGRAM_MAX_BITS的值被计入最后一个桶
+		HISTOGRAM_MAX_BITS = 48,
+		HISTOGRAM_BUCKETS = (HISTOGRAM_MAX_BITS - HISTOGRAM_SUB_BUCKET_BITS + 1) * HISTOGRAM_SUB_BUCKETS
+	};
+
+	Histogram();
+	~Histogram();
+
+	void record(uint64 val)
+	{
+		++buckets_[bucketIndex(val)];
+		++count_;
+		sum_ += val;
+
+		if(val < min_)
+			min_ = val;
+
+		if(val > max_)
+			max_ = val;
+	}
+
+	void reset();
+
+	uint64 count() const { return count_; }
+	uint64 sum() const { return sum_; }
+	uint64 min() const { return count_ > 0 ? min_ : 0; }
+	uint64 max() const { return max_; }
+	double mean() const { return count_ > 0 ? double(sum_) / double(count_) : 0.0; }
+
+	/**
+		得到百分位上的值(percentile取值0~100), 返回的是所在桶的上界
+	*/
+	uint64 valueAtPercentile(double percentile) const;
+
+	uint32 bucket(uint32 idx) const { return buckets_[idx]; }
+
+	static uint32 bucketIndex(uint64 val)
+	{
+		if(val < (uint64)HISTOGRAM_SUB_BUCKETS)
+			return (uint32)val;
+
+		uint32 msb = highestBit(val);
+		if(msb >= HISTOGRAM_MAX_BITS)
+			return HISTOGRAM_BUCKETS - 1;
+
+		uint32 sub = (uint32)(val >> (msb - HISTOGRAM_SUB_BUCKET_BITS)) & (HISTOGRAM_SUB_BUCKETS - 1);
+		return (msb - HISTOGRAM_SUB_BUCKET_BITS + 1) * HISTOGRAM_SUB_BUCKETS + sub;
+	}
+
+	static uint64 bucketUpperBound(uint32 idx);
+
+private:
+	static uint32 highestBit(uint64 val)
+	{
+#if KBE_PLATFORM == PLATFORM_WIN32
+		unsigned long idx = 0;
+		_BitScanReverse64(&idx, val);
+		return (uint32)idx;
+#else
+		return 63 - (uint32)__builtin_clzll(val);
+#endif
+	}
+
+	uint32 buckets_[HISTOGRAM_BUCKETS];
+
+	uint64 count_;
+	uint64 sum_;
+	uint64 min_;
+	uint64 max_;
+};
+
+}
+
+#endif // KBE_HELPER_HISTOGRAM_H
@@ -0,0 +1,301 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "metrics.h"
+#include "helper/debug_helper.h"
+
+namespace KBEngine { 
+
+static Metrics* g_pMetrics = NULL;
+
+//-------------------------------------------------------------------------------------
+MetricHistogram::MetricHistogram():
+sum_(0)
+{
+	for(uint32 i = 0; i < (uint32)Histogram::HISTOGRAM_BUCKETS; ++i)
+		buckets_[i] = 0;
+}
+
+//-------------------------------------------------------------------------------------
+uint64 MetricHistogram::count() const
+{
+	uint64 count = 0;
+
+	for(uint32 i = 0; i < (uint32)Histogram::HISTOGRAM_BUCKETS; ++i)
+		count += bucket(i);
+
+	return count;
+}
+
+//-------------------------------------------------------------------------------------
+Metrics::Metrics():
+metrics_()
+{
+}
+
+//-------------------------------------------------------------------------------------
+Metrics::~Metrics()
+{
+	std::vector<Metric>::iterator iter = metrics_.begin();
+	for(; iter != metrics_.end(); ++iter)
+	{
+		switch(iter->type)
+		{
+		case METRIC_TYPE_COUNTER:
+			delete static_cast<MetricCounter*>(iter->pMetric);
+			break;
+		case METRIC_TYPE_GAUGE:
+			delete static_cast<MetricGauge*>(iter->pMetric);
+			break;
+		case METRIC_TYPE_HISTOGRAM:
+			delete static_cast<MetricHistogram*>(iter->pMetric);
+			break;
+		};
+	}
+
+	metrics_.clear();
+}
+
+//-------------------------------------------------------------------------------------
+Metrics& Metrics::getSingleton()
+{
+	if(g_pMetrics == NULL)
+		g_pMetrics = new Metrics();
+
+	return *g_pMetrics;
+}
+
+//-------------------------------------------------------------------------------------
+void Metrics::finalise()
+{
+	SAFE_RELEASE(g_pMetrics);
+}
+
+//-------------------------------------------------------------------------------------
+Metrics::Metric* Metrics::findMetric(const std::string& name)
+{
+	std::vector<Metric>::iterator iter = metrics_.begin();
+	for(; iter != metrics_.end(); ++iter)
+	{
+		if(iter->name == name)
+			return &(*iter);
+	}
+
+	return NULL;
+}
+
+//-------------------------------------------------------------------------------------
+Metrics::Metric* Metrics::addMetric(const std::string& name, const std::string& help, 
+	METRIC_TYPE type, double scale)
+{
+	std::string metricName = sanitizeName(name);
+
+	Metric* pMetric = findMetric(metricName);
+	if(pMetric)
+	{
+		if(pMetric->type != type)
+		{
+			ERROR_MSG(fmt::format("Metrics::addMetric: {} is already registered with another type({})!\n", 
+				metricName, (int)pMetric->type));
+
+			return NULL;
+		}
+
+		return pMetric;
+	}
+
+	Metric metric;
+	metric.name = metricName;
+	metric.help = help;
+	metric.type = type;
+	metric.scale = scale;
+	metric.pMetric = NULL;
+
+	switch(type)
+	{
+	case METRIC_TYPE_COUNTER:
+		metric.pMetric = new MetricCounter();
+		break;
+	case METRIC_TYPE_GAUGE:
+		metric.pMetric = new MetricGauge();
+		break;
+	case METRIC_TYPE_HISTOGRAM:
+		metric.pMetric = new MetricHistogram();
+		break;
+	};
+
+	metrics_.push_back(metric);
+	return &metrics_.back();
+}
+
+//-------------------------------------------------------------------------------------
+MetricCounter* Metrics::counter(const std::string& name, const std::string& help)
+{
+	Metric* pMetric = addMetric(name, help, METRIC_TYPE_COUNTER, 1.0);
+	return pMetric ? static_cast<MetricCounter*>(pMetric->pMetric) : NULL;
+}
+
+//-------------------------------------------------------------------------------------
+MetricGauge* Metrics::gauge(const std::string& name, const std::string& help)
+{
+	Metric* pMetric = addMetric(name, help, METRIC_TYPE_GAUGE, 1.0);
+	return pMetric ? static_cast<MetricGauge*>(pMetric->pMetric) : NULL;
+}
+
+//-------------------------------------------------------------------------------------
+MetricHistogram* Metrics::histogram(const std::string& name, const std::string& help, double scale)
+{
+	Metric* pMetric = addMetric(name, help, METRIC_TYPE_HISTOGRAM, scale);
+	return pMetric ? static_cast<MetricHistogram*>(pMetric->pMetric) : NULL;
+}
+
+//-------------------------------------------------------------------------------------
+std::string Metrics::sanitizeName(const std::string& name)
+{
+	std::string ret = name;
+
+	for(size_t i = 0; i < ret.size(); ++i)
+	{
+		char c = ret[i];
+		if((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == ':')
+			continue;
+
+		if(c >= '0' && c <= '9' && i > 0)
+			continue;
+
+		ret[i] = '_';
+	}
+
+	return ret;
+}
+
+//-------------------------------------------------------------------------------------
+std::string Metrics::escapeLabel(const std::string& val)
+{
+	std::string ret;
+	ret.reserve(val.size());
+
+	for(size_t i = 0; i < val.size(); ++i)
+	{
+		char c = val[i];
+		if(c == '\\' || c == '"')
+		{
+			ret += '\\';
+			ret += c;
+		}
+		else if(c == '\n')
+		{
+			ret += "\\n";
+		}
+		else
+		{
+			ret += c;
+		}
+	}
+
+	return ret;
+}
+
+//-------------------------------------------------------------------------------------
+template<class HISTOGRAM>
+void Metrics::renderHistogram(std::string& out, const std::string& name, const std::string& labels, 
+	const HISTOGRAM& histogram, double scale)
+{
+	const uint32 subBuckets = Histogram::HISTOGRAM_SUB_BUCKETS;
+	const uint32 numBuckets = Histogram::HISTOGRAM_BUCKETS;
+
+	// 只输出到最后一个非空桶所在的2的幂区间为止
+	uint32 lastOctave = 0;
+	for(uint32 i = 0; i < numBuckets - 1; ++i)
+	{
+		if(histogram.bucket(i) > 0)
+			lastOctave = i / subBuckets;
+	}
+
+	std::string prefix = labels.size() > 0 ? labels + "," : "";
+	uint64 accumulated = 0;
+
+	// 对数-线性桶按2的幂合并后输出, 避免每个直方图产生数百行
+	for(uint32 i = 0; i < numBuckets - 1; ++i)
+	{
+		accumulated += histogram.bucket(i);
+
+		if(i % subBuckets != subBuckets - 1)
+			continue;
+
+		out += fmt::format("{}_bucket{{{}le=\"{}\"}} {}\n", name, prefix, 
+			double(Histogram::bucketUpperBound(i)) * scale, accumulated);
+
+		if(i / subBuckets >= lastOctave)
+			break;
+	}
+
+	uint64 count = 0;
+	for(uint32 i = 0; i < numBuckets; ++i)
+		count += histogram.bucket(i);
+
+	out += fmt::format("{}_bucket{{{}le=\"+Inf\"}} {}\n", name, prefix, count);
+
+	if(labels.size() > 0)
+	{
+		out += fmt::format("{}_count{{{}}} {}\n", name, labels, count);
+		out += fmt::format("{}_sum{{{}}} {}\n", name, labels, double(histogram.sum()) * scale);
+	}
+	else
+	{
+		out += fmt::format("{}_count {}\n", name, count);
+		out += fmt::format("{}_sum {}\n", name, double(histogram.sum()) * scale);
+	}
+}
+
+template void Metrics::renderHistogram<Histogram>(std::string&, const std::string&, const std::string&, 
+	const Histogram&, double);
+
+template void Metrics::renderHistogram<MetricHistogram>(std::string&, const std::string&, const std::string&, 
+	const MetricHistogram&, double);
+
+//-------------------------------------------------------------------------------------
+void Metrics::render(std::string& out) const
+{
+	std::vector<Metric>::const_iterator iter = metrics_.begin();
+	for(; iter != metrics_.end(); ++iter)
+	{
+		const Metric& metric = (*iter);
+
+		switch(metric.type)
+		{
+		case METRIC_TYPE_COUNTER:
+			out += fmt::format("# TYPE {} counter\n# HELP {} {}\n{}_total {}\n", metric.name, metric.name, 
+				metric.help, metric.name, static_cast<MetricCounter*>(metric.pMetric)->value());
+			break;
+		case METRIC_TYPE_GAUGE:
+			out += fmt::format("# TYPE {} gauge\n# HELP {} {}\n{} {}\n", metric.name, metric.name, 
+				metric.help, metric.name, static_cast<MetricGauge*>(metric.pMetric)->value());
+			break;
+		case METRIC_TYPE_HISTOGRAM:
+			out += fmt::format("# TYPE {} histogram\n# HELP {} {}\n", metric.name, metric.name, metric.help);
+			renderHistogram(out, metric.name, "", *static_cast<MetricHistogram*>(metric.pMetric), metric.scale);
+			break;
+		};
+	}
+}
+
+//-------------------------------------------------------------------------------------
+}
@@ -0,0 +1,170 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KBE_HELPER_METRICS_H
+#define KBE_HELPER_METRICS_H
+
+#include "common/common.h"
+#include "helper/histogram.h"
+
+namespace KBEngine { 
+
+/*
+	原子加, 用于多线程下的计数器与直方图, 记录一次只有一条带lock前缀的加法指令
+*/
+inline uint64 metricAtomicAdd(volatile uint64* p, uint64 v)
+{
+#if KBE_PLATFORM == PLATFORM_WIN32
+	return (uint64)::InterlockedExchangeAdd64((volatile LONG64*)p, (LONG64)v);
+#else
+	return __sync_fetch_and_add(p, v);
+#endif
+}
+
+inline uint64 metricAtomicLoad(const volatile uint64* p)
+{
+#if KBE_PLATFORM == PLATFORM_WIN32
+	return (uint64)::InterlockedCompareExchange64((volatile LONG64*)p, 0, 0);
+#else
+	return __sync_fetch_and_add(const_cast<volatile uint64*>(p), 0);
+#endif
+}
+
+/*
+	单调递增的计数器
+*/
+class MetricCounter
+{
+public:
+	MetricCounter():value_(0) {}
+
+	void add(uint64 v = 1) { metricAtomicAdd(&value_, v); }
+	uint64 value() const { return metricAtomicLoad(&value_); }
+
+private:
+	volatile uint64 value_;
+};
+
+/*
+	可增可减的当前值
+*/
+class MetricGauge
+{
+public:
+	MetricGauge():value_(0) {}
+
+	void set(int64 v) { value_ = (uint64)v; }
+	void add(int64 v) { metricAtomicAdd(&value_, (uint64)v); }
+	int64 value() const { return (int64)metricAtomicLoad(&value_); }
+
+private:
+	volatile uint64 value_;
+};
+
+/*
+	与Histogram相同的对数-线性分桶, 但每个桶是原子的, 可以被任意线程同时记录。
+	记录一次为一次桶自增与一次sum累加, count由所有桶求和得到, 不单独维护。
+*/
+class MetricHistogram
+{
+public:
+	MetricHistogram();
+
+	void record(uint64 val)
+	{
+		metricAtomicAdd(&buckets_[Histogram::bucketIndex(val)], 1);
+		metricAtomicAdd(&sum_, val);
+	}
+
+	uint64 count() const;
+	uint64 sum() const { return metricAtomicLoad(&sum_); }
+	uint64 bucket(uint32 idx) const { return metricAtomicLoad(&buckets_[idx]); }
+
+private:
+	volatile uint64 buckets_[Histogram::HISTOGRAM_BUCKETS];
+	volatile uint64 sum_;
+};
+
+/*
+	指标注册表, 按OpenMetrics文本格式输出。
+	注册只能在主线程进行(通常在初始化阶段), 返回的指针在进程生命周期内有效,
+	热点路径上应缓存该指针然后直接调用add/record。
+*/
+class Metrics
+{
+public:
+	enum METRIC_TYPE
+	{
+		METRIC_TYPE_COUNTER = 0,
+		METRIC_TYPE_GAUGE = 1,
+		METRIC_TYPE_HISTOGRAM = 2
+	};
+
+	struct Metric
+	{
+		std::string name;
+		std::string help;
+		METRIC_TYPE type;
+
+		// 输出直方图时记录值乘以scale, 例如TimeStamp转换为秒
+		double scale;
+
+		void* pMetric;
+	};
+
+	Metrics();
+	~Metrics();
+
+	static Metrics& getSingleton();
+	static void finalise();
+
+	/**
+		name需符合OpenMetrics命名规则([a-zA-Z_:][a-zA-Z0-9_:]*)，
+		重复注册同名同类型的指标将返回已存在的对象
+	*/
+	MetricCounter* counter(const std::string& name, const std::string& help);
+	MetricGauge* gauge(const std::string& name, const std::string& help);
+	MetricHistogram* histogram(const std::string& name, const std::string& help, double scale = 1.0);
+
+	void render(std::string& out) const;
+
+	/**
+		输出一个直方图, Histogram与MetricHistogram共用
+	*/
+	template<class HISTOGRAM>
+	static void renderHistogram(std::string& out, const std::string& name, const std::string& labels, 
+		const HISTOGRAM& histogram, double scale);
+
+	/**
+		将任意字符串转换为合法的指标名或转义为合法的label值
+	*/
+	static std::string sanitizeName(const std::string& name);
+	static std::string escapeLabel(const std::string& val);
+
+private:
+	Metric* findMetric(const std::string& name);
+	Metric* addMetric(const std::string& name, const std::string& help, METRIC_TYPE type, double scale);
+
+	std::vector<Metric> metrics_;
+};
+
+}
+
+#endif // KBE_HELPER_METRICS_H
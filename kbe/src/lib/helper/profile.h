@@ -25,6 +25,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "common/common.h"
 #include "common/timer.h"
 #include "common/timestamp.h"
+#include "helper/tick_timeline.h"
 
 namespace KBEngine
 {
@@ -104,6 +105,9 @@ public:
 
 		// 记录开始时间
 		lastIntTime_ = now;
+
+		if (TickTimeline::isRecording())
+			TickTimeline::getSingleton().onProfileStart(this, now);
 	}
 
 	void stop(uint32 qty = 0)
@@ -135,6 +139,9 @@ public:
 		// 的时间片段
 		if (!stack.empty())
 			stack.back()->lastIntTime_ = now;
+
+		if (TickTimeline::isRecording())
+			TickTimeline::getSingleton().onProfileStop(this, now);
 	}
 
 	
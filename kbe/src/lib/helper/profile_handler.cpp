@@ -29,6 +29,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "common/memorystream.h"
 #include "helper/console_helper.h"
 #include "helper/profile.h"
+#include "helper/tick_timeline.h"
 
 namespace KBEngine { 
 
@@ -444,6 +445,58 @@ void NetworkProfileHandler::onRecvMessage(const Network::MessageHandler& msgHand
 	pProfileVal->total_recv_count = msgHandler.recvcount();
 }
 
+//-------------------------------------------------------------------------------------
+TickProfileHandler::TickProfileHandler(Network::NetworkInterface & networkInterface, uint32 timinglen, 
+							   std::string name, const Network::Address& addr) :
+ProfileHandler(networkInterface, timinglen, name, addr),
+wasRecording_(TickTimeline::isRecording())
+{
+	TickTimeline::getSingleton().start();
+}
+
+//-------------------------------------------------------------------------------------
+TickProfileHandler::~TickProfileHandler()
+{
+}
+
+//-------------------------------------------------------------------------------------
+void TickProfileHandler::timeout()
+{
+	TickTimeline& tickTimeline = TickTimeline::getSingleton();
+
+	if(!wasRecording_)
+		tickTimeline.stop();
+
+	MemoryStream s;
+	s << timinglen_;
+
+	// 只包含环形缓冲中最近的若干帧(tickTimeline/frames)
+	s << tickTimeline.exportChromeTrace(false);
+	sendStream(&s);
+}
+
+//-------------------------------------------------------------------------------------
+void TickProfileHandler::sendStream(MemoryStream* s)
+{
+	Network::Channel* pChannel = networkInterface_.findChannel(addr_);
+	if(pChannel == NULL)
+	{
+		WARNING_MSG(fmt::format("TickProfileHandler::sendStream: not found {} addr({})\n",
+			name_, addr_.c_str()));
+		return;
+	}
+
+	Network::Bundle* pBundle = Network::Bundle::createPoolObject();
+
+	ConsoleInterface::ConsoleProfileHandler msgHandler;
+	(*pBundle).newMessage(msgHandler);
+
+	int8 type = 4;
+	(*pBundle) << type;
+	(*pBundle).append(s);
+	pChannel->send(pBundle);
+}
+
 //-------------------------------------------------------------------------------------
 
 }
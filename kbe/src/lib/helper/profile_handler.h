@@ -206,6 +206,24 @@ private:
 	PROFILEVALS profileVals_;
 };
 
+/*
+	在timinglen秒内记录逐tick的profile时间线， 结束时以Chrome trace json的形式发送给控制台
+*/
+class TickProfileHandler : public ProfileHandler
+{
+public:
+	TickProfileHandler(Network::NetworkInterface & networkInterface, uint32 timinglen, 
+		std::string name, const Network::Address& addr);
+	virtual ~TickProfileHandler();
+	
+	void timeout();
+	void sendStream(MemoryStream* s);
+
+private:
+	// 如果开始前时间线已经在记录(例如配置中开启了)， 结束时不停止它
+	bool wasRecording_;
+};
+
 }
 
 #endif
@@ -0,0 +1,350 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "tick_timeline.h"
+#include "profile.h"
+#include "helper/watcher.h"
+
+namespace KBEngine { 
+
+bool TickTimeline::recording_ = false;
+static TickTimeline* g_pTickTimeline = NULL;
+
+//-------------------------------------------------------------------------------------
+static void appendJsonString(std::string& datas, const char* str)
+{
+	datas += '"';
+
+	for(; *str; ++str)
+	{
+		char c = *str;
+		if(c == '"' || c == '\\')
+		{
+			datas += '\\';
+			datas += c;
+		}
+		else if((unsigned char)c < 0x20)
+		{
+			datas += ' ';
+		}
+		else
+		{
+			datas += c;
+		}
+	}
+
+	datas += '"';
+}
+
+//-------------------------------------------------------------------------------------
+static inline double stampsToMicroseconds(uint64 stamps)
+{
+	return double(stamps) * 1000000.0 / stampsPerSecondD();
+}
+
+//-------------------------------------------------------------------------------------
+TickTimeline::TickTimeline():
+frames_(),
+currFrame_(0),
+numFrames_(0),
+frameActive_(false),
+slowFrames_(),
+openEvents_(),
+maxFrames_(0),
+maxSlowFrames_(16),
+slowTickThreshold_(100),
+numSlowTicks_(0),
+lastSlowTickTime_(0)
+{
+	maxFrames(64);
+	openEvents_.reserve(64);
+}
+
+//-------------------------------------------------------------------------------------
+TickTimeline::~TickTimeline()
+{
+}
+
+//-------------------------------------------------------------------------------------
+TickTimeline& TickTimeline::getSingleton()
+{
+	if(g_pTickTimeline == NULL)
+		g_pTickTimeline = new TickTimeline();
+
+	return *g_pTickTimeline;
+}
+
+//-------------------------------------------------------------------------------------
+void TickTimeline::finalise()
+{
+	recording_ = false;
+	SAFE_RELEASE(g_pTickTimeline);
+}
+
+//-------------------------------------------------------------------------------------
+void TickTimeline::start()
+{
+	if(recording_)
+		return;
+
+	for(size_t i = 0; i < frames_.size(); ++i)
+	{
+		frames_[i].events.clear();
+		frames_[i].droppedEvents = 0;
+		frames_[i].endTime = 0;
+	}
+
+	currFrame_ = 0;
+	numFrames_ = 0;
+	frameActive_ = false;
+	openEvents_.clear();
+	recording_ = true;
+}
+
+//-------------------------------------------------------------------------------------
+void TickTimeline::stop()
+{
+	if(!recording_)
+		return;
+
+	if(frameActive_)
+		endFrame(timestamp());
+
+	recording_ = false;
+	openEvents_.clear();
+}
+
+//-------------------------------------------------------------------------------------
+void TickTimeline::maxFrames(uint32 v)
+{
+	if(v < 2)
+		v = 2;
+
+	// 正在记录中时不能调整环形缓冲大小， 否则会打乱当前帧
+	if(recording_ || v == maxFrames_)
+		return;
+
+	maxFrames_ = v;
+	frames_.clear();
+	frames_.resize(maxFrames_);
+	currFrame_ = 0;
+	numFrames_ = 0;
+}
+
+//-------------------------------------------------------------------------------------
+void TickTimeline::maxSlowFrames(uint32 v)
+{
+	maxSlowFrames_ = v;
+
+	while(slowFrames_.size() > maxSlowFrames_)
+		slowFrames_.pop_front();
+}
+
+//-------------------------------------------------------------------------------------
+void TickTimeline::endFrame(uint64 now)
+{
+	Frame& frame = frames_[currFrame_];
+	frame.endTime = now;
+
+	// 跨越帧边界的事件在此截断
+	std::vector< std::pair<ProfileVal*, uint32> >::iterator iter = openEvents_.begin();
+	for(; iter != openEvents_.end(); ++iter)
+	{
+		if(iter->second != (uint32)-1)
+			frame.events[iter->second].endTime = now;
+
+		iter->second = (uint32)-1;
+	}
+
+	frameActive_ = false;
+
+	if(numFrames_ < maxFrames_)
+		++numFrames_;
+
+	if(slowTickThreshold_ == 0)
+		return;
+
+	uint32 ms = (uint32)(stampsToMicroseconds(frame.endTime - frame.startTime) / 1000.0);
+	if(ms < slowTickThreshold_)
+		return;
+
+	++numSlowTicks_;
+	lastSlowTickTime_ = ms;
+
+	if(maxSlowFrames_ == 0)
+		return;
+
+	if(slowFrames_.size() >= maxSlowFrames_)
+		slowFrames_.pop_front();
+
+	slowFrames_.push_back(frame);
+}
+
+//-------------------------------------------------------------------------------------
+void TickTimeline::onTick(uint32 tick)
+{
+	if(!recording_)
+		return;
+
+	uint64 now = timestamp();
+
+	if(frameActive_)
+	{
+		endFrame(now);
+		currFrame_ = (currFrame_ + 1) % maxFrames_;
+	}
+
+	Frame& frame = frames_[currFrame_];
+	frame.tick = tick;
+	frame.startTime = now;
+	frame.endTime = 0;
+	frame.droppedEvents = 0;
+	frame.events.clear();
+
+	frameActive_ = true;
+}
+
+//-------------------------------------------------------------------------------------
+void TickTimeline::addFrameToStream(std::string& datas, const Frame& frame, bool& first) const
+{
+	if(frame.endTime == 0)
+		return;
+
+	char buf[256];
+	int32 pid = getProcessPID();
+
+	// 帧本身也作为一个事件输出， 便于在时间线上区分每个tick
+	kbe_snprintf(buf, sizeof(buf), "%s\n{\"name\":\"tick %u\",\"cat\":\"tick\",\"ph\":\"X\",\"pid\":%d,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f,"
+		"\"args\":{\"tick\":%u,\"events\":%u,\"dropped\":%u}}",
+		first ? "" : ",", frame.tick, pid, stampsToMicroseconds(frame.startTime), 
+		stampsToMicroseconds(frame.endTime - frame.startTime), frame.tick, (uint32)frame.events.size(), frame.droppedEvents);
+
+	datas += buf;
+	first = false;
+
+	std::vector<Event>::const_iterator iter = frame.events.begin();
+	for(; iter != frame.events.end(); ++iter)
+	{
+		const Event& event = (*iter);
+		uint64 endTime = event.endTime > 0 ? event.endTime : frame.endTime;
+
+		datas += ",\n{\"name\":";
+		appendJsonString(datas, event.pProfile->name());
+
+		kbe_snprintf(buf, sizeof(buf), ",\"cat\":\"profile\",\"ph\":\"X\",\"pid\":%d,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"tick\":%u,\"depth\":%u}}",
+			pid, stampsToMicroseconds(event.startTime), stampsToMicroseconds(endTime - event.startTime), 
+			frame.tick, (uint32)event.depth);
+
+		datas += buf;
+	}
+}
+
+//-------------------------------------------------------------------------------------
+std::string TickTimeline::exportChromeTrace(bool slowOnly) const
+{
+	std::string datas = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool first = true;
+
+	if(slowOnly)
+	{
+		std::deque<Frame>::const_iterator iter = slowFrames_.begin();
+		for(; iter != slowFrames_.end(); ++iter)
+			addFrameToStream(datas, (*iter), first);
+	}
+	else
+	{
+		// 从最老的一帧开始输出， 未结束的帧会在addFrameToStream中跳过
+		for(uint32 i = 1; i <= maxFrames_; ++i)
+			addFrameToStream(datas, frames_[(currFrame_ + i) % maxFrames_], first);
+	}
+
+	datas += "\n]}\n";
+	return datas;
+}
+
+//-------------------------------------------------------------------------------------
+bool TickTimeline::writeChromeTrace(const std::string& filename, bool slowOnly) const
+{
+	FILE* f = fopen(filename.c_str(), "wb");
+	if(f == NULL)
+	{
+		ERROR_MSG(fmt::format("TickTimeline::writeChromeTrace: open {} failed!\n", filename));
+		return false;
+	}
+
+	std::string datas = exportChromeTrace(slowOnly);
+	size_t size = fwrite(datas.data(), 1, datas.size(), f);
+	fclose(f);
+
+	if(size != datas.size())
+	{
+		ERROR_MSG(fmt::format("TickTimeline::writeChromeTrace: write {} failed!\n", filename));
+		return false;
+	}
+
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+std::string TickTimeline::summary(uint32 maxLines, const char* newline) const
+{
+	std::string datas = fmt::format("recording={}, frames={}/{}, slowTickThreshold={}ms, slowTicks={}, slowFrames={}/{}, lastSlowTick={}ms{}",
+		recording_, numFrames_, maxFrames_, slowTickThreshold_, numSlowTicks_, slowFrames_.size(), maxSlowFrames_, lastSlowTickTime_, newline);
+
+	if(numFrames_ == 0)
+		return datas;
+
+	datas += fmt::format("{:<12}{:>12}{:>10}{:>10}{}", "tick", "time(ms)", "events", "dropped", newline);
+
+	uint32 lines = 0;
+	uint32 idx = currFrame_;
+
+	// 从最新的一帧开始倒序输出， 当前未结束的帧跳过
+	for(uint32 i = 0; i < maxFrames_; ++i)
+	{
+		if(maxLines > 0 && lines >= maxLines)
+			break;
+
+		const Frame& frame = frames_[idx];
+		idx = (idx + maxFrames_ - 1) % maxFrames_;
+
+		if(frame.endTime == 0)
+			continue;
+
+		datas += fmt::format("{:<12}{:>12.3f}{:>10}{:>10}{}", frame.tick, 
+			stampsToMicroseconds(frame.endTime - frame.startTime) / 1000.0, frame.events.size(), frame.droppedEvents, newline);
+
+		++lines;
+	}
+
+	return datas;
+}
+
+//-------------------------------------------------------------------------------------
+bool TickTimeline::initializeWatcher()
+{
+	WATCH_OBJECT("tickTimeline/slowTicks", this, &TickTimeline::numSlowTicks);
+	WATCH_OBJECT("tickTimeline/lastSlowTickTime", this, &TickTimeline::lastSlowTickTime);
+	WATCH_OBJECT("tickTimeline/slowTickThreshold", this, &TickTimeline::slowTickThreshold);
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+} 
@@ -0,0 +1,185 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KBE_TICK_TIMELINE_H
+#define KBE_TICK_TIMELINE_H
+
+#include "common/common.h"
+
+namespace KBEngine { 
+
+class ProfileVal;
+
+/*
+	逐帧(tick)的profile时间线记录器。
+	开启后会把每个tick内所有ProfileVal(SCOPED_PROFILE等)的起止时间记录到一个环形缓冲中, 保留最近N个tick,
+	耗时超过阈值的tick会被额外保存一份快照, 这样可以在事后查看某一个具体的慢tick里到底发生了什么。
+	结果可以导出为Chrome trace格式的JSON(chrome://tracing 或 Perfetto中打开)。
+*/
+class TickTimeline
+{
+public:
+	enum
+	{
+		// 单个tick最多记录的事件数量， 超出部分被丢弃并计数
+		MAX_EVENTS_PER_FRAME = 65535
+	};
+
+	struct Event
+	{
+		ProfileVal* pProfile;
+		uint64 startTime;
+		uint64 endTime;
+		uint16 depth;
+	};
+
+	struct Frame
+	{
+		Frame():
+		tick(0),
+		startTime(0),
+		endTime(0),
+		droppedEvents(0),
+		events()
+		{
+		}
+
+		uint32 tick;
+		uint64 startTime;
+		uint64 endTime;
+		uint32 droppedEvents;
+		std::vector<Event> events;
+	};
+
+	TickTimeline();
+	~TickTimeline();
+
+	static TickTimeline& getSingleton();
+	static void finalise();
+
+	static bool isRecording() { return recording_; }
+
+	void start();
+	void stop();
+
+	/**
+		一个新的tick开始了， 结束当前帧并开始记录下一帧
+	*/
+	void onTick(uint32 tick);
+
+	void onProfileStart(ProfileVal* pProfile, uint64 now)
+	{
+		Frame& frame = frames_[currFrame_];
+
+		if(!frameActive_ || frame.events.size() >= (size_t)MAX_EVENTS_PER_FRAME)
+		{
+			if(frameActive_)
+				++frame.droppedEvents;
+
+			openEvents_.push_back(std::make_pair(pProfile, (uint32)-1));
+			return;
+		}
+
+		Event event;
+		event.pProfile = pProfile;
+		event.startTime = now;
+		event.endTime = 0;
+		event.depth = (uint16)openEvents_.size();
+
+		openEvents_.push_back(std::make_pair(pProfile, (uint32)frame.events.size()));
+		frame.events.push_back(event);
+	}
+
+	void onProfileStop(ProfileVal* pProfile, uint64 now)
+	{
+		// 不同ProfileGroup的栈是独立的， 因此这里不一定是栈顶， 从栈顶向下查找
+		// 开启记录之前就已经开始的profile在这里找不到对应的记录， 直接忽略
+		size_t i = openEvents_.size();
+		while(i > 0)
+		{
+			--i;
+			if(openEvents_[i].first != pProfile)
+				continue;
+
+			uint32 idx = openEvents_[i].second;
+			openEvents_.erase(openEvents_.begin() + i);
+
+			if(idx != (uint32)-1)
+				frames_[currFrame_].events[idx].endTime = now;
+
+			return;
+		}
+	}
+
+	uint32 maxFrames() const { return maxFrames_; }
+	void maxFrames(uint32 v);
+
+	uint32 maxSlowFrames() const { return maxSlowFrames_; }
+	void maxSlowFrames(uint32 v);
+
+	/**
+		慢tick阈值, 单位毫秒, 0表示不保存慢tick快照
+	*/
+	uint32 slowTickThreshold() const { return slowTickThreshold_; }
+	void slowTickThreshold(uint32 ms) { slowTickThreshold_ = ms; }
+
+	uint32 numSlowTicks() const { return numSlowTicks_; }
+	uint32 lastSlowTickTime() const { return lastSlowTickTime_; }
+
+	/**
+		导出为Chrome trace json， slowOnly为true则只导出慢tick快照
+	*/
+	std::string exportChromeTrace(bool slowOnly) const;
+
+	bool writeChromeTrace(const std::string& filename, bool slowOnly) const;
+
+	/**
+		最近若干帧的简要信息(tick、耗时、事件数)
+	*/
+	std::string summary(uint32 maxLines, const char* newline = "\n") const;
+
+	bool initializeWatcher();
+
+private:
+	void endFrame(uint64 now);
+	void addFrameToStream(std::string& datas, const Frame& frame, bool& first) const;
+
+	static bool recording_;
+
+	std::vector<Frame> frames_;
+	uint32 currFrame_;
+	uint32 numFrames_;
+	bool frameActive_;
+
+	std::deque<Frame> slowFrames_;
+
+	std::vector< std::pair<ProfileVal*, uint32> > openEvents_;
+
+	uint32 maxFrames_;
+	uint32 maxSlowFrames_;
+	uint32 slowTickThreshold_;
+
+	uint32 numSlowTicks_;
+	uint32 lastSlowTickTime_;
+};
+
+}
+
+#endif // KBE_TICK_TIMELINE_H
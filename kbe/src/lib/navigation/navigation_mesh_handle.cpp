@@ -355,7 +355,7 @@ NavigationHandle* NavMeshHandle::create(std::string resPath, const std::map< int
 
 //-------------------------------------------------------------------------------------
 template<typename NAVMESH_SET_HEADER>
-dtNavMesh* tryReadNavmesh(uint8* data, size_t readsize, const std::string& res, bool showlog)
+dtNavMesh* tryReadNavmesh(const uint8* data, size_t readsize, const std::string& res, bool showlog)
 {
 	if (readsize < sizeof(NAVMESH_SET_HEADER))
 	{
@@ -420,11 +420,19 @@ dtNavMesh* tryReadNavmesh(uint8* data, size_t readsize, const std::string& res,
 		NavMeshTileHeader tileHeader;
 		size = sizeof(NavMeshTileHeader);
 
+		// 数据可能直接来自文件映射， 越界读取会导致崩溃
+		if (pos + size > (int)readsize)
+		{
+			success = false;
+			status = DT_FAILURE + DT_INVALID_PARAM;
+			break;
+		}
+
 		memcpy(&tileHeader, &data[pos], size);
 		pos += size;
 
 		size = tileHeader.dataSize;
-		if (!tileHeader.tileRef || !tileHeader.dataSize)
+		if (!tileHeader.tileRef || !tileHeader.dataSize || size < 0 || pos + size > (int)readsize)
 		{
 			success = false;
 			status = DT_FAILURE + DT_INVALID_PARAM;
@@ -473,11 +481,14 @@ dtNavMesh* tryReadNavmesh(uint8* data, size_t readsize, const std::string& res,
 bool NavMeshHandle::_create(int layer, const std::string& resPath, const std::string& res, NavMeshHandle* pNavMeshHandle)
 {
 	KBE_ASSERT(pNavMeshHandle);
-	FILE* fp = fopen(res.c_str(), "rb");
-	if (!fp)
+
+	// 使用不进入资源池的私有对象， 映射只存在于加载期间， 也不会与其他线程共享引用计数
+	std::string path = Resmgr::getSingleton().matchRes(res);
+	FileObject f(path.c_str(), 0, "rb", true);
+	if (!f.isMapped() && f.fd() == NULL)
 	{
 		ERROR_MSG(fmt::format("NavMeshHandle::create: open({}) error!\n", 
-			Resmgr::getSingleton().matchRes(res)));
+			path));
 
 		return false;
 	}
@@ -485,30 +496,29 @@ bool NavMeshHandle::_create(int layer, const std::string& resPath, const std::st
 	DEBUG_MSG(fmt::format("NavMeshHandle::create: ({}), layer={}\n", 
 		res, layer));
 
-	fseek(fp, 0, SEEK_END); 
-	size_t flen = ftell(fp); 
-	fseek(fp, 0, SEEK_SET); 
+	// 文件已被映射则直接从映射中解析， 否则读到临时缓冲
+	std::vector<uint8> buffer;
+	const uint8* data = f.data();
+	size_t readsize = f.size();
 
-	uint8* data = new uint8[flen];
-	if(data == NULL)
+	if (!f.isMapped())
 	{
-		ERROR_MSG(fmt::format("NavMeshHandle::create: open({}), memory(size={}) error!\n", 
-			Resmgr::getSingleton().matchRes(res), flen));
+		f.seek(0, SEEK_END);
+		size_t flen = f.tell();
+		f.seek(0, SEEK_SET);
 
-		fclose(fp);
-		SAFE_RELEASE_ARRAY(data);
-		return false;
-	}
+		buffer.resize(flen);
+		readsize = flen > 0 ? f.read((char*)&buffer[0], (uint32)flen) : 0;
 
-	size_t readsize = fread(data, 1, flen, fp);
-	if(readsize != flen)
-	{
-		ERROR_MSG(fmt::format("NavMeshHandle::create: open({}), read(size={} != {}) error!\n", 
-			Resmgr::getSingleton().matchRes(res), readsize, flen));
+		if(readsize != flen)
+		{
+			ERROR_MSG(fmt::format("NavMeshHandle::create: open({}), read(size={} != {}) error!\n", 
+				Resmgr::getSingleton().matchRes(res), readsize, flen));
 
-		fclose(fp);
-		SAFE_RELEASE_ARRAY(data);
-		return false;
+			return false;
+		}
+
+		data = readsize > 0 ? &buffer[0] : NULL;
 	}
 
 	dtNavMesh* mesh = tryReadNavmesh<NavMeshSetHeader>(data, readsize, res, false);
@@ -520,14 +530,9 @@ bool NavMeshHandle::_create(int layer, const std::string& resPath, const std::st
 	if (!mesh)
 	{
 		ERROR_MSG("NavMeshHandle::create: dtAllocNavMesh is failed!\n");
-		fclose(fp);
-		SAFE_RELEASE_ARRAY(data);
 		return false;
 	}
 
-	fclose(fp);
-	SAFE_RELEASE_ARRAY(data);
-
 	dtNavMeshQuery* pMavmeshQuery = new dtNavMeshQuery();
 
 	pMavmeshQuery->init(mesh, 1024);
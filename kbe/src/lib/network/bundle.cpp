@@ -31,6 +31,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #endif
 
 #include "common/blowfish.h"
+#include "common/aesgcm.h"
 
 
 namespace KBEngine { 
@@ -158,6 +159,12 @@ void Bundle::_calcPacketMaxSize()
 
 		packetMaxSize_ -= packetMaxSize_ % KBEngine::KBEBlowfish::BLOCK_SIZE;
 	}
+	else if(g_channelExternalEncryptType == 3)
+	{
+		// AES-GCM不需要对齐， 但每个包会被原地加上长度头与认证标签， 需要预留出来
+		packetMaxSize_ = isTCPPacket_ ? (int)TCPPacket::maxBufferSize() : PACKET_MAX_SIZE_UDP;
+		packetMaxSize_ -= (int)(PACKET_LENGTH_SIZE + KBEngine::KBEAesGcm::TAG_SIZE);
+	}
 	else
 	{
 		packetMaxSize_ = isTCPPacket_ ? (int)TCPPacket::maxBufferSize() : PACKET_MAX_SIZE_UDP;
@@ -277,6 +284,35 @@ void Bundle::clearPackets()
 	packets_.clear();
 }
 
+//-------------------------------------------------------------------------------------
+void Bundle::coalesce(Bundle* pBundle)
+{
+	KBE_ASSERT(pCurrPacket_ == NULL && pBundle->pCurrPacket_ == NULL);
+	KBE_ASSERT(isTCPPacket_ == pBundle->isTCPPacket_);
+
+	Packets::iterator iter = pBundle->packets_.begin();
+	for (; iter != pBundle->packets_.end(); ++iter)
+	{
+		Packet* pPacket = (*iter);
+		Packet* pLastPacket = packets_.size() > 0 ? packets_.back() : NULL;
+
+		if (pLastPacket && !pLastPacket->encrypted() && !pPacket->encrypted() &&
+			lastPacketSpace() >= (int32)pPacket->length())
+		{
+			pLastPacket->append(pPacket->data() + pPacket->rpos(), pPacket->length());
+			RECLAIM_PACKET(isTCPPacket_, pPacket);
+		}
+		else
+		{
+			pPacket->pBundle(this);
+			packets_.push_back(pPacket);
+		}
+	}
+
+	pBundle->packets_.clear();
+	numMessages_ += pBundle->numMessages_;
+}
+
 //-------------------------------------------------------------------------------------
 void Bundle::newMessage(const MessageHandler& msgHandler)
 {
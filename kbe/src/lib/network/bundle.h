@@ -107,6 +107,12 @@ public:
 	void finiMessage(bool isSend = true);
 
 	void clearPackets();
+
+	/**
+		将另一个已经完成的bundle的数据并入本bundle的尾部， 
+		小包会被拷贝到最后一个包的剩余空间中， pBundle由调用者回收
+	*/
+	void coalesce(Bundle* pBundle);
 	
 	INLINE void pCurrMsgHandler(const Network::MessageHandler* pMsgHandler);
 	INLINE const Network::MessageHandler* pCurrMsgHandler() const;
@@ -32,11 +32,13 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "network/network_interface.h"
 #include "network/tcp_packet_receiver.h"
 #include "network/tcp_packet_sender.h"
+#include "network/shm_transport.h"
 #include "network/udp_packet_receiver.h"
 #include "network/tcp_packet.h"
 #include "network/udp_packet.h"
 #include "network/message_handler.h"
 #include "network/network_stats.h"
+#include "helper/metrics.h"
 
 namespace KBEngine { 
 namespace Network
@@ -77,7 +79,7 @@ size_t Channel::getPoolObjectBytes()
 		sizeof(id_) + sizeof(inactivityTimerHandle_) + sizeof(inactivityExceptionPeriod_) + 
 		sizeof(lastReceivedTime_) + (bufferedReceives_.size() * sizeof(Packet*)) + sizeof(pPacketReader_) + (bundles_.size() * sizeof(Bundle*)) +
 		+ sizeof(flags_) + sizeof(numPacketsSent_) + sizeof(numPacketsReceived_) + sizeof(numBytesSent_) + sizeof(numBytesReceived_)
-		+ sizeof(lastTickBytesReceived_) + sizeof(lastTickBytesSent_) + sizeof(pFilter_) + sizeof(pEndPoint_) + sizeof(pPacketReceiver_) + sizeof(pPacketSender_)
+		+ sizeof(lastTickBytesReceived_) + sizeof(lastTickBytesSent_) + sizeof(pFilter_) + sizeof(pEndPoint_) + sizeof(pPacketReceiver_) + sizeof(pPacketSender_) + sizeof(pShmTransport_)
 		+ sizeof(proxyID_) + strextra_.size() + sizeof(channelType_)
 		+ sizeof(componentID_) + sizeof(pMsgHandlers_);
 
@@ -125,10 +127,12 @@ Channel::Channel(NetworkInterface & networkInterface,
 	pEndPoint_(NULL),
 	pPacketReceiver_(NULL),
 	pPacketSender_(NULL),
+	pShmTransport_(NULL),
 	proxyID_(0),
 	strextra_(),
 	channelType_(CHANNEL_NORMAL),
 	componentID_(UNKNOWN_COMPONENT_TYPE),
+	clientFeatures_(0),
 	pMsgHandlers_(NULL),
 	flags_(0)
 {
@@ -158,10 +162,12 @@ Channel::Channel():
 	pEndPoint_(NULL),
 	pPacketReceiver_(NULL),
 	pPacketSender_(NULL),
+	pShmTransport_(NULL),
 	proxyID_(0),
 	strextra_(),
 	channelType_(CHANNEL_NORMAL),
 	componentID_(UNKNOWN_COMPONENT_TYPE),
+	clientFeatures_(0),
 	pMsgHandlers_(NULL),
 	flags_(0)
 {
@@ -366,6 +372,7 @@ void Channel::clearState( bool warnOnDiscard /*=false*/ )
 	proxyID_ = 0;
 	strextra_ = "";
 	channelType_ = CHANNEL_NORMAL;
+	clientFeatures_ = 0;
 
 	if(pEndPoint_ && protocoltype_ == PROTOCOL_TCP && !this->isDestroyed())
 	{
@@ -378,6 +385,9 @@ void Channel::clearState( bool warnOnDiscard /*=false*/ )
 		}
 	}
 
+	// 共享内存通道依附于TCP连接，连接断开时一起释放
+	this->pShmTransport(NULL);
+
 	// 这里只清空状态，不释放
 	//SAFE_RELEASE(pPacketReader_);
 	//SAFE_RELEASE(pPacketSender_);
@@ -395,6 +405,31 @@ void Channel::clearState( bool warnOnDiscard /*=false*/ )
 	}
 }
 
+//-------------------------------------------------------------------------------------
+void Channel::pushFilter(PacketFilterPtr pFilter)
+{
+	if(!pFilter)
+		return;
+
+	pFilter->pNextFilter(pFilter_.get());
+	pFilter_ = pFilter;
+}
+
+//-------------------------------------------------------------------------------------
+void Channel::pShmTransport(ShmTransport* pShmTransport)
+{
+	if(pShmTransport_ == pShmTransport)
+		return;
+
+	if(pShmTransport_)
+	{
+		pShmTransport_->close();
+		delete pShmTransport_;
+	}
+
+	pShmTransport_ = pShmTransport;
+}
+
 //-------------------------------------------------------------------------------------
 Channel::Bundles & Channel::bundles()
 {
@@ -504,7 +539,19 @@ void Channel::send(Bundle * pBundle)
 	{
 		pBundle->pChannel(this);
 		pBundle->finiMessage(true);
-		bundles_.push_back(pBundle);
+
+		// WebSocket的每个包都是一个独立的帧， 发送被阻塞时将新的bundle并入队尾尚未开始发送的bundle，
+		// 减少帧和系统调用的数量（队首的bundle可能已经发出一部分，不能动）
+		if(channelType_ == CHANNEL_WEB && sending() && bundles_.size() > 1 && 
+			!bundles_.back()->packets().empty() && !bundles_.back()->packets().front()->encrypted())
+		{
+			bundles_.back()->coalesce(pBundle);
+			Network::Bundle::reclaimPoolObject(pBundle);
+		}
+		else
+		{
+			bundles_.push_back(pBundle);
+		}
 	}
 	
 	uint32 bundleSize = (uint32)bundles_.size();
@@ -521,8 +568,28 @@ void Channel::send(Bundle * pBundle)
 		// 如果不能立即发送到系统缓冲区，那么交给poller处理
 		if(bundles_.size() > 0 && !isCondemn() && !isDestroyed())
 		{
-			flags_ |= FLAG_SENDING;
-			pNetworkInterface_->dispatcher().registerWriteFileDescriptor(*pEndPoint_, pPacketSender_);
+			bool registered = false;
+
+			// 共享内存环满时TCP socket始终可写，必须等待对端腾出空间的通知
+			ShmTransport* pShmTransport = pEndPoint_->pShmTransport();
+			if(pShmTransport)
+				registered = pShmTransport->waitSendSpace(pNetworkInterface_->dispatcher(), pPacketSender_);
+
+			// 无法等待共享内存的通知时退回到socket可写事件，环满期间会反复重试，但不会停止发送
+			if(!registered)
+				registered = pNetworkInterface_->dispatcher().registerWriteFileDescriptor(*pEndPoint_, pPacketSender_);
+
+			if(registered)
+			{
+				flags_ |= FLAG_SENDING;
+			}
+			else
+			{
+				ERROR_MSG(fmt::format("Channel::send[{:p}]: channel({}), register send handler failed!\n",
+					(void*)this, this->c_str()));
+
+				this->condemn();
+			}
 		}
 	}
 
@@ -594,7 +661,11 @@ void Channel::stopSend()
 
 	flags_ &= ~FLAG_SENDING;
 
-	pNetworkInterface_->dispatcher().deregisterWriteFileDescriptor(*pEndPoint_);
+	ShmTransport* pShmTransport = pEndPoint_->pShmTransport();
+	if(pShmTransport && pShmTransport->waitingSendSpace())
+		pShmTransport->stopWaitSendSpace();
+	else
+		pNetworkInterface_->dispatcher().deregisterWriteFileDescriptor(*pEndPoint_);
 }
 
 //-------------------------------------------------------------------------------------
@@ -618,6 +689,9 @@ void Channel::onPacketSent(int bytes, bool sentCompleted)
 		numBytesSent_ += bytes;
 		g_numBytesSent += bytes;
 		lastTickBytesSent_ += bytes;
+
+		if(g_pPacketSentSizeMetric)
+			g_pPacketSentSizeMetric->record(bytes);
 	}
 
 	if(this->isExternal())
@@ -645,7 +719,8 @@ void Channel::onPacketSent(int bytes, bool sentCompleted)
 //-------------------------------------------------------------------------------------
 void Channel::onPacketReceived(int bytes)
 {
-	lastReceivedTime_ = timestamp();
+	// 只用于超时检测， 精确到主循环唤醒的时刻就足够了
+	lastReceivedTime_ = cachedTimestamp();
 	++numPacketsReceived_;
 	++g_numPacketsReceived;
 
@@ -654,6 +729,9 @@ void Channel::onPacketReceived(int bytes)
 		numBytesReceived_ += bytes;
 		lastTickBytesReceived_ += bytes;
 		g_numBytesReceived += bytes;
+
+		if(g_pPacketReceivedSizeMetric)
+			g_pPacketReceivedSizeMetric->record(bytes);
 	}
 
 	if(this->isExternal())
@@ -681,6 +759,9 @@ void Channel::onPacketReceived(int bytes)
 //-------------------------------------------------------------------------------------
 void Channel::addReceiveWindow(Packet* pPacket)
 {
+	if(NetworkStats::getSingleton().trackTimings())
+		pPacket->recvTime(cachedTimestamp());
+
 	bufferedReceives_.push_back(pPacket);
 	uint32 size = (uint32)bufferedReceives_.size();
 
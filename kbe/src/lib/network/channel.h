@@ -45,6 +45,7 @@ class NetworkInterface;
 class MessageHandlers;
 class PacketReader;
 class PacketSender;
+class ShmTransport;
 
 class Channel : public TimerHandler, public PoolObject
 {
@@ -105,6 +106,11 @@ public:
 	PacketFilterPtr pFilter() const { return pFilter_; }
 	void pFilter(PacketFilterPtr pFilter) { pFilter_ = pFilter; }
 
+	/**
+		在已有的过滤器之上再叠加一个过滤器(例如压缩叠加在加密与websocket之上)
+	*/
+	void pushFilter(PacketFilterPtr pFilter);
+
 	void destroy();
 	bool isDestroyed() const { return (flags_ & FLAG_DESTROYED) > 0; }
 
@@ -134,6 +140,12 @@ public:
 	bool sending() const { return (flags_ & FLAG_SENDING) > 0;}
 	void stopSend();
 
+	/**
+		同机组件之间的共享内存通道，由通道负责释放
+	*/
+	ShmTransport* pShmTransport() const { return pShmTransport_; }
+	void pShmTransport(ShmTransport* pShmTransport);
+
 	void send(Bundle * pBundle = NULL);
 	void delayedSend();
 
@@ -160,7 +172,7 @@ public:
 	uint32	numBytesReceived() const	{ return numBytesReceived_; }
 		
 	uint64 lastReceivedTime() const		{ return lastReceivedTime_; }
-	void updateLastReceivedTime()		{ lastReceivedTime_ = timestamp(); }
+	void updateLastReceivedTime()		{ lastReceivedTime_ = cachedTimestamp(); }
 		
 	void addReceiveWindow(Packet* pPacket);
 	
@@ -182,6 +194,12 @@ public:
 	COMPONENT_ID componentID() const{ return componentID_; }
 	void componentID(COMPONENT_ID cid){ componentID_ = cid; }
 
+	/**
+		客户端在hello中声明的可选特性(CLIENT_FEATURE_*)
+	*/
+	uint32 clientFeatures() const { return clientFeatures_; }
+	void clientFeatures(uint32 features){ clientFeatures_ = features; }
+
 	virtual void handshake();
 
 	KBEngine::Network::MessageHandlers* pMsgHandlers() const { return pMsgHandlers_; }
@@ -253,6 +271,7 @@ private:
 	EndPoint *					pEndPoint_;
 	PacketReceiver*				pPacketReceiver_;
 	PacketSender*				pPacketSender_;
+	ShmTransport*				pShmTransport_;
 
 	// 如果是外部通道且代理了一个前端则会绑定前端代理ID
 	ENTITY_ID					proxyID_;
@@ -265,6 +284,9 @@ private:
 
 	COMPONENT_ID				componentID_;
 
+	// 客户端在hello中声明的可选特性
+	uint32						clientFeatures_;
+
 	// 支持指定某个通道使用某个消息handlers
 	KBEngine::Network::MessageHandlers* pMsgHandlers_;
 
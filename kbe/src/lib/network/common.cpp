@@ -29,6 +29,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "network/udp_packet_receiver.h"
 #include "network/address.h"
 #include "helper/watcher.h"
+#include "helper/metrics.h"
 
 namespace KBEngine { 
 namespace Network
@@ -39,6 +40,10 @@ float g_channelExternalTimeout = 60.f;
 
 int8 g_channelExternalEncryptType = 0;
 
+int8 g_channelExternalCompressType = 0;
+uint32 g_channelExternalCompressThreshold = 256;
+int8 g_channelExternalCompressLevel = 1;
+
 uint32 g_SOMAXCONN = 5;
 
 // network stats
@@ -47,6 +52,9 @@ uint64						g_numPacketsReceived = 0;
 uint64						g_numBytesSent = 0;
 uint64						g_numBytesReceived = 0;
 
+MetricHistogram*			g_pPacketSentSizeMetric = NULL;
+MetricHistogram*			g_pPacketReceivedSizeMetric = NULL;
+
 uint32						g_receiveWindowMessagesOverflowCritical = 32;
 uint32						g_intReceiveWindowMessagesOverflow = 65535;
 uint32						g_extReceiveWindowMessagesOverflow = 256;
@@ -67,6 +75,10 @@ uint32						g_intReSendRetries = 0;
 uint32						g_extReSendInterval = 10;
 uint32						g_extReSendRetries = 3;
 
+// 同机组件之间的共享内存通道
+bool						g_shmTransportEnable = false;
+uint32						g_shmTransportRingSize = 4 * 1024 * 1024;
+
 bool initializeWatcher()
 {
 	WATCH_OBJECT("network/numPacketsSent", g_numPacketsSent);
@@ -84,6 +96,19 @@ bool initializeWatcher()
 	return true;
 }
 
+bool initializeMetrics()
+{
+	Metrics& metrics = Metrics::getSingleton();
+
+	g_pPacketSentSizeMetric = metrics.histogram("kbe_network_packet_sent_bytes", 
+		"Size of packets sent by all channels.");
+
+	g_pPacketReceivedSizeMetric = metrics.histogram("kbe_network_packet_received_bytes", 
+		"Size of packets received by all channels.");
+
+	return g_pPacketSentSizeMetric != NULL && g_pPacketReceivedSizeMetric != NULL;
+}
+
 void destroyObjPool()
 {
 	Bundle::destroyObjPool();
@@ -102,6 +127,9 @@ void finalise(void)
 	WatcherPaths::finalise();
 #endif
 
+	g_pPacketSentSizeMetric = NULL;
+	g_pPacketReceivedSizeMetric = NULL;
+
 	MessageHandlers::finalise();
 	
 	Network::destroyObjPool();
@@ -26,6 +26,9 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "helper/debug_option.h"
 
 namespace KBEngine { 
+
+class MetricHistogram;
+
 namespace Network
 {
 const uint32 BROADCAST = 0xFFFFFFFF;
@@ -55,6 +58,11 @@ extern uint32 g_extReSendRetries;
 // 外部通道加密类别
 extern int8 g_channelExternalEncryptType;
 
+// 外部通道压缩类别(0:不压缩, 1:deflate)、压缩阈值(字节)与压缩等级
+extern int8 g_channelExternalCompressType;
+extern uint32 g_channelExternalCompressThreshold;
+extern int8 g_channelExternalCompressLevel;
+
 // listen监听队列最大值
 extern uint32 g_SOMAXCONN;
 
@@ -101,6 +109,12 @@ typedef uint16								PacketLength;				// 最大65535
 
 #define KBE_INTERFACES_TCP_PORT				30099
 
+/*
+	客户端在hello末尾声明自己支持的可选协议特性(按位)， 服务端只对声明了的客户端启用。
+	旧的客户端不附带这部分数据， 视为0
+*/
+#define CLIENT_FEATURE_VOLATILE_SNAPSHOT	0x00000001			// 能解析onUpdateVolatileSnapshot
+
 /*
 	网络消息类型， 定长或者变长。
 	如果需要自定义长度则在NETWORK_INTERFACE_DECLARE_BEGIN中声明时填入长度即可。
@@ -394,6 +408,10 @@ extern uint64						g_numPacketsReceived;
 extern uint64						g_numBytesSent;
 extern uint64						g_numBytesReceived;
 
+// 数据包大小分布， 开启metrics导出后才会被创建(参见initializeMetrics)
+extern MetricHistogram*				g_pPacketSentSizeMetric;
+extern MetricHistogram*				g_pPacketReceivedSizeMetric;
+
 // 包接收窗口溢出
 extern uint32						g_receiveWindowMessagesOverflowCritical;
 extern uint32						g_intReceiveWindowMessagesOverflow;
@@ -409,7 +427,12 @@ extern uint32						g_extSendWindowBytesOverflow;
 extern uint32						g_intSentWindowBytesOverflow;
 extern uint32						g_extSentWindowBytesOverflow;
 
+// 同机组件之间的共享内存通道
+extern bool							g_shmTransportEnable;
+extern uint32						g_shmTransportRingSize;
+
 bool initializeWatcher();
+bool initializeMetrics();
 void finalise(void);
 
 }
@@ -0,0 +1,401 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "compression_filter.h"
+#include "helper/profile.h"
+#include "helper/debug_helper.h"
+#include "common/timestamp.h"
+#include "network/tcp_packet.h"
+#include "network/udp_packet.h"
+#include "network/bundle.h"
+#include "network/channel.h"
+#include "network/network_stats.h"
+#include "network/packet_receiver.h"
+#include "network/packet_sender.h"
+
+namespace KBEngine { 
+namespace Network
+{
+
+// Z_SYNC_FLUSH在每个压缩块末尾产生的空存储块， 发送时去掉， 接收时补回
+static const uint8 SYNC_FLUSH_TAIL[] = { 0x00, 0x00, 0xFF, 0xFF };
+
+// 解压后的数据超过这个大小就先交给上层， 避免一次收到大量压缩记录时缓冲无限增长
+static const size_t DECOMPRESS_FLUSH_SIZE = PACKET_MAX_SIZE_TCP * 16;
+
+//-------------------------------------------------------------------------------------
+CompressionFilter::CompressionFilter(uint8 type, const std::string& dictionary):
+type_(type),
+dictionaryID_(dictionaryID(dictionary)),
+isGood_(true),
+deflateBuffer_(),
+pSendingPacket_(NULL),
+pPacket_(NULL)
+{
+	memset(&deflateStream_, 0, sizeof(deflateStream_));
+	memset(&inflateStream_, 0, sizeof(inflateStream_));
+
+	// 使用原始deflate流(windowBits为负)， 不需要zlib头和校验和
+	if(deflateInit2(&deflateStream_, g_channelExternalCompressLevel, Z_DEFLATED, 
+			-WINDOW_BITS, MEM_LEVEL, Z_DEFAULT_STRATEGY) != Z_OK || 
+		inflateInit2(&inflateStream_, -WINDOW_BITS) != Z_OK)
+	{
+		ERROR_MSG(fmt::format("CompressionFilter::CompressionFilter: init zlib error! type={}\n", type));
+		isGood_ = false;
+		return;
+	}
+
+	if(dictionary.size() > 0)
+	{
+		if(deflateSetDictionary(&deflateStream_, (const Bytef*)dictionary.data(), (uInt)dictionary.size()) != Z_OK || 
+			inflateSetDictionary(&inflateStream_, (const Bytef*)dictionary.data(), (uInt)dictionary.size()) != Z_OK)
+		{
+			ERROR_MSG(fmt::format("CompressionFilter::CompressionFilter: set dictionary error! size={}\n", 
+				dictionary.size()));
+
+			isGood_ = false;
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------
+CompressionFilter::~CompressionFilter()
+{
+	deflateEnd(&deflateStream_);
+	inflateEnd(&inflateStream_);
+
+	if(pPacket_)
+	{
+		RECLAIM_PACKET(pPacket_->isTCPPacket(), pPacket_);
+		pPacket_ = NULL;
+	}
+}
+
+//-------------------------------------------------------------------------------------
+uint32 CompressionFilter::dictionaryID(const std::string& dictionary)
+{
+	if(dictionary.size() == 0)
+		return 0;
+
+	return (uint32)adler32(adler32(0L, Z_NULL, 0), (const Bytef*)dictionary.data(), (uInt)dictionary.size());
+}
+
+//-------------------------------------------------------------------------------------
+Reason CompressionFilter::send(Channel * pChannel, PacketSender& sender, Packet * pPacket)
+{
+	// encrypted表示已经被处理过(或者不允许被处理)， 例如hello的回复
+	if(!pPacket->encrypted() && pPacket != pSendingPacket_)
+	{
+		AUTO_SCOPED_PROFILE("compressSend");
+
+		if(isGood_ && pPacket->length() <= RECORD_LENGTH_MASK)
+			compress(pPacket);
+
+		if(!isGood_ || pPacket->length() > RECORD_LENGTH_MASK + RECORD_HEAD_SIZE)
+		{
+			WARNING_MSG(fmt::format("CompressionFilter::send: "
+				"Dropping packet to {} due to invalid filter, size={}\n",
+				pChannel->addr().c_str(), pPacket->length()));
+
+			return REASON_GENERAL_NETWORK;
+		}
+	}
+
+	Reason reason = PacketFilter::send(pChannel, sender, pPacket);
+
+	// 没有完全发送出去的包会被再次送入过滤器
+	pSendingPacket_ = (reason == REASON_SUCCESS) ? NULL : pPacket;
+	return reason;
+}
+
+//-------------------------------------------------------------------------------------
+void CompressionFilter::compress(Packet * pPacket)
+{
+	uint64 startTime = timestamp();
+
+	size_t start = pPacket->rpos();
+	size_t rawLen = pPacket->length();
+
+	if(rawLen < g_channelExternalCompressThreshold)
+	{
+		// 小包不压缩， 只需要在前面加上记录头
+		if(pPacket->size() < start + RECORD_HEAD_SIZE + rawLen)
+			pPacket->data_resize(start + RECORD_HEAD_SIZE + rawLen);
+
+		uint8* pRecord = pPacket->data() + start;
+		memmove(pRecord + RECORD_HEAD_SIZE, pRecord, rawLen);
+
+		pPacket->wpos(start);
+		(*pPacket) << (uint16)rawLen;
+		pPacket->wpos(start + RECORD_HEAD_SIZE + rawLen);
+	}
+	else
+	{
+		if(deflateBuffer_.size() < deflateBound(&deflateStream_, (uLong)rawLen) + sizeof(SYNC_FLUSH_TAIL))
+			deflateBuffer_.resize(deflateBound(&deflateStream_, (uLong)rawLen) + sizeof(SYNC_FLUSH_TAIL));
+
+		deflateStream_.next_in = (Bytef*)(pPacket->data() + start);
+		deflateStream_.avail_in = (uInt)rawLen;
+
+		size_t outLen = 0;
+
+		do
+		{
+			if(outLen == deflateBuffer_.size())
+				deflateBuffer_.resize(deflateBuffer_.size() * 2);
+
+			deflateStream_.next_out = (Bytef*)&deflateBuffer_[outLen];
+			deflateStream_.avail_out = (uInt)(deflateBuffer_.size() - outLen);
+
+			int ret = deflate(&deflateStream_, Z_SYNC_FLUSH);
+			if(ret != Z_OK && ret != Z_BUF_ERROR)
+			{
+				ERROR_MSG(fmt::format("CompressionFilter::compress: deflate error({})!\n", ret));
+				isGood_ = false;
+				return;
+			}
+
+			outLen = deflateBuffer_.size() - deflateStream_.avail_out;
+		}
+		while(deflateStream_.avail_out == 0);
+
+		if(outLen < sizeof(SYNC_FLUSH_TAIL) || 
+			memcmp(&deflateBuffer_[outLen - sizeof(SYNC_FLUSH_TAIL)], SYNC_FLUSH_TAIL, sizeof(SYNC_FLUSH_TAIL)) != 0)
+		{
+			ERROR_MSG("CompressionFilter::compress: bad sync flush!\n");
+			isGood_ = false;
+			return;
+		}
+
+		outLen -= sizeof(SYNC_FLUSH_TAIL);
+
+		if(outLen > RECORD_LENGTH_MASK)
+		{
+			ERROR_MSG(fmt::format("CompressionFilter::compress: record too large({})!\n", outLen));
+			isGood_ = false;
+			return;
+		}
+
+		pPacket->wpos(start);
+		(*pPacket) << (uint16)(outLen | RECORD_COMPRESSED_FLAG);
+		pPacket->append(&deflateBuffer_[0], outLen);
+	}
+
+	NetworkStats::getSingleton().trackCompression(NetworkStats::SEND, (uint32)rawLen, 
+		(uint32)pPacket->length(), timestamp() - startTime);
+}
+
+//-------------------------------------------------------------------------------------
+Reason CompressionFilter::recv(Channel * pChannel, PacketReceiver & receiver, Packet * pPacket)
+{
+	AUTO_SCOPED_PROFILE("decompressRecv");
+
+	if(!isGood_)
+	{
+		WARNING_MSG(fmt::format("CompressionFilter::recv: "
+			"Dropping packet to {} due to invalid filter\n",
+			pChannel->addr().c_str()));
+
+		if(pPacket)
+			RECLAIM_PACKET(pPacket->isTCPPacket(), pPacket);
+
+		return REASON_GENERAL_NETWORK;
+	}
+
+	// 先与上次剩下的不完整记录合并
+	if(pPacket_)
+	{
+		if(pPacket)
+		{
+			pPacket_->append(pPacket->data() + pPacket->rpos(), pPacket->length());
+			RECLAIM_PACKET(pPacket->isTCPPacket(), pPacket);
+		}
+
+		pPacket = pPacket_;
+		pPacket_ = NULL;
+	}
+
+	if(pPacket == NULL)
+		return PacketFilter::recv(pChannel, receiver, NULL);
+
+	bool isTCPPacket = pPacket->isTCPPacket();
+	size_t startPos = pPacket->rpos();
+
+	Packet* pOutPacket = NULL;
+	MALLOC_PACKET(pOutPacket, isTCPPacket);
+
+	while(pPacket->length() >= RECORD_HEAD_SIZE)
+	{
+		uint16 head = pPacket->read<uint16>(pPacket->rpos());
+		uint32 bodyLen = head & RECORD_LENGTH_MASK;
+
+		if(pPacket->length() < RECORD_HEAD_SIZE + bodyLen)
+			break;
+
+		uint64 startTime = timestamp();
+		size_t outStart = pOutPacket->wpos();
+
+		pPacket->read_skip(RECORD_HEAD_SIZE);
+
+		if(head & RECORD_COMPRESSED_FLAG)
+		{
+			if(!inflateRecord(pPacket->data() + pPacket->rpos(), bodyLen, pOutPacket))
+			{
+				ERROR_MSG(fmt::format("CompressionFilter::recv: "
+					"decompress failed, addr={}\n",
+					pChannel->addr().c_str()));
+
+				isGood_ = false;
+				RECLAIM_PACKET(isTCPPacket, pPacket);
+				RECLAIM_PACKET(isTCPPacket, pOutPacket);
+				pChannel->condemn();
+				return REASON_GENERAL_NETWORK;
+			}
+		}
+		else
+		{
+			pOutPacket->append(pPacket->data() + pPacket->rpos(), bodyLen);
+		}
+
+		pPacket->read_skip(bodyLen);
+
+		NetworkStats::getSingleton().trackCompression(NetworkStats::RECV, 
+			(uint32)(pOutPacket->wpos() - outStart), RECORD_HEAD_SIZE + bodyLen, timestamp() - startTime);
+
+		if(pOutPacket->length() >= DECOMPRESS_FLUSH_SIZE)
+		{
+			Reason reason = PacketFilter::recv(pChannel, receiver, pOutPacket);
+			pOutPacket = NULL;
+
+			if(reason != REASON_SUCCESS)
+			{
+				RECLAIM_PACKET(isTCPPacket, pPacket);
+				return reason;
+			}
+
+			MALLOC_PACKET(pOutPacket, isTCPPacket);
+		}
+	}
+
+	// 剩下不完整的记录等待后续数据， 整个包都没有用到则直接保留这个包
+	if(pPacket->length() > 0)
+	{
+		if(pPacket->rpos() == startPos)
+		{
+			pPacket_ = pPacket;
+		}
+		else
+		{
+			MALLOC_PACKET(pPacket_, isTCPPacket);
+			pPacket_->append(pPacket->data() + pPacket->rpos(), pPacket->length());
+			RECLAIM_PACKET(isTCPPacket, pPacket);
+		}
+	}
+	else
+	{
+		RECLAIM_PACKET(isTCPPacket, pPacket);
+	}
+
+	if(pOutPacket->length() == 0)
+	{
+		RECLAIM_PACKET(isTCPPacket, pOutPacket);
+		return PacketFilter::recv(pChannel, receiver, NULL);
+	}
+
+	return PacketFilter::recv(pChannel, receiver, pOutPacket);
+}
+
+//-------------------------------------------------------------------------------------
+bool CompressionFilter::inflateRecord(const uint8* pData, uint32 size, Packet * pOutPacket)
+{
+	size_t outStart = pOutPacket->wpos();
+	bool tailFed = false;
+
+	inflateStream_.next_in = (Bytef*)pData;
+	inflateStream_.avail_in = (uInt)size;
+
+	for(;;)
+	{
+		if(inflateStream_.avail_in == 0 && !tailFed)
+		{
+			inflateStream_.next_in = (Bytef*)SYNC_FLUSH_TAIL;
+			inflateStream_.avail_in = sizeof(SYNC_FLUSH_TAIL);
+			tailFed = true;
+		}
+
+		if(pOutPacket->size() - pOutPacket->wpos() < PACKET_MAX_SIZE_TCP)
+			pOutPacket->data_resize(pOutPacket->size() + PACKET_MAX_SIZE_TCP * 2);
+
+		inflateStream_.next_out = (Bytef*)(pOutPacket->data() + pOutPacket->wpos());
+		inflateStream_.avail_out = (uInt)(pOutPacket->size() - pOutPacket->wpos());
+
+		int ret = inflate(&inflateStream_, Z_SYNC_FLUSH);
+		pOutPacket->wpos(pOutPacket->size() - inflateStream_.avail_out);
+
+		if(ret != Z_OK && ret != Z_BUF_ERROR)
+			return false;
+
+		// 发送端每条记录对应一个不超过RECORD_LENGTH_MASK的包
+		if(pOutPacket->wpos() - outStart > RECORD_LENGTH_MASK)
+			return false;
+
+		if(tailFed && inflateStream_.avail_in == 0 && inflateStream_.avail_out > 0)
+			break;
+	}
+
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+CompressionFilter* createCompressionFilter(uint8 type, uint32 dictionaryID, const std::string& dictionary)
+{
+	if(g_channelExternalCompressType == CompressionFilter::COMPRESS_TYPE_NONE || 
+		type != (uint8)g_channelExternalCompressType)
+		return NULL;
+
+	if(type != CompressionFilter::COMPRESS_TYPE_DEFLATE)
+	{
+		WARNING_MSG(fmt::format("createCompressionFilter: not support type({})!\n", type));
+		return NULL;
+	}
+
+	// 两端的entitydef不一致时字典也不一致， 此时不使用字典
+	if(dictionaryID == 0 || dictionaryID != CompressionFilter::dictionaryID(dictionary))
+		return new CompressionFilter(type, "");
+
+	return new CompressionFilter(type, dictionary);
+}
+
+//-------------------------------------------------------------------------------------
+void addCompressionOffer(Bundle& bundle, const std::string& dictionary)
+{
+	if(g_channelExternalCompressType == CompressionFilter::COMPRESS_TYPE_NONE)
+	{
+		bundle << (uint8)CompressionFilter::COMPRESS_TYPE_NONE << (uint32)0;
+		return;
+	}
+
+	bundle << (uint8)g_channelExternalCompressType << CompressionFilter::dictionaryID(dictionary);
+}
+
+//-------------------------------------------------------------------------------------
+}
+}
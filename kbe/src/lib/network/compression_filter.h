@@ -0,0 +1,110 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef KBE_COMPRESSION_FILTER_H
+#define KBE_COMPRESSION_FILTER_H
+
+#include "network/packet_filter.h"
+#include "zlib.h"
+
+namespace KBEngine { 
+namespace Network
+{
+class Bundle;
+
+/*
+	外部通道压缩过滤器， 叠加在加密与websocket过滤器之上。
+	每个数据包被包装成一条记录: [uint16 头][记录体]，头的最高位表示记录体是否被压缩，
+	低15位为记录体长度。小于阈值的包原样发送， 其他包使用同一个deflate流压缩(Z_SYNC_FLUSH)，
+	这样后续的包可以引用之前包的内容， 每个压缩记录末尾固定的00 00 FF FF不发送。
+*/
+class CompressionFilter : public PacketFilter
+{
+public:
+	enum CompressType
+	{
+		COMPRESS_TYPE_NONE = 0,
+		COMPRESS_TYPE_DEFLATE = 1
+	};
+
+	static const uint16 RECORD_COMPRESSED_FLAG = 0x8000;
+	static const uint16 RECORD_LENGTH_MASK = 0x7FFF;
+	static const uint16 RECORD_HEAD_SIZE = sizeof(uint16);
+
+	// 每个客户端都有一对压缩流， 使用8K的窗口控制内存(deflate约64K， inflate约8K)
+	static const int WINDOW_BITS = 13;
+	static const int MEM_LEVEL = 6;
+
+	CompressionFilter(uint8 type, const std::string& dictionary);
+	virtual ~CompressionFilter();
+
+	virtual Reason send(Channel * pChannel, PacketSender& sender, Packet * pPacket);
+	virtual Reason recv(Channel * pChannel, PacketReceiver & receiver, Packet * pPacket);
+
+	uint8 type() const { return type_; }
+	uint32 dictionaryID() const { return dictionaryID_; }
+
+	bool good() const { return isGood_; }
+
+	/**
+		字典的标识(adler32)， 空字典为0
+	*/
+	static uint32 dictionaryID(const std::string& dictionary);
+
+protected:
+	void compress(Packet * pPacket);
+
+	bool inflateRecord(const uint8* pData, uint32 size, Packet * pOutPacket);
+
+protected:
+	uint8 type_;
+	uint32 dictionaryID_;
+	bool isGood_;
+
+	z_stream deflateStream_;
+	z_stream inflateStream_;
+
+	// 压缩输出的临时缓冲
+	std::vector<uint8> deflateBuffer_;
+
+	// 已经压缩但是还未完全发送出去的包， 重发时不能再次压缩
+	Packet* pSendingPacket_;
+
+	// 未接收完整的记录
+	Packet* pPacket_;
+};
+
+/**
+	根据对端在hello中提供的压缩类别与字典标识创建过滤器， 服务端与客户端都使用这个接口。
+	本端未开启压缩或类别不一致时返回NULL， 字典标识不一致时不使用字典。
+*/
+CompressionFilter* createCompressionFilter(uint8 type, uint32 dictionaryID, const std::string& dictionary);
+
+/**
+	客户端在hello末尾附带本端的压缩类别与字典标识， 未开启压缩时写入0，
+	使其后的客户端特性字段(CLIENT_FEATURE_*)位置固定
+*/
+void addCompressionOffer(Bundle& bundle, const std::string& dictionary);
+
+}
+}
+
+#endif // KBE_COMPRESSION_FILTER_H
@@ -121,7 +121,7 @@ Reason BlowfishFilter::send(Channel * pChannel, PacketSender& sender, Packet * p
 		}
 	}
 	
-	return sender.processFilterPacket(pChannel, pPacket);
+	return PacketFilter::send(pChannel, sender, pPacket);
 }
 
 //-------------------------------------------------------------------------------------
@@ -179,7 +179,7 @@ Reason BlowfishFilter::recv(Channel * pChannel, PacketReceiver & receiver, Packe
 					if(pPacket_ == NULL)
 						pPacket_ = pPacket;
 
-					return receiver.processFilteredPacket(pChannel, NULL);
+					return PacketFilter::recv(pChannel, receiver, NULL);
 				}
 			}
 			else
@@ -187,7 +187,7 @@ Reason BlowfishFilter::recv(Channel * pChannel, PacketReceiver & receiver, Packe
 				if(pPacket_ == NULL)
 					pPacket_ = pPacket;
 
-				return receiver.processFilteredPacket(pChannel, NULL);
+				return PacketFilter::recv(pChannel, receiver, NULL);
 			}
 		}
 		else
@@ -211,7 +211,7 @@ Reason BlowfishFilter::recv(Channel * pChannel, PacketReceiver & receiver, Packe
 				if(pPacket_ == NULL)
 					pPacket_ = pPacket;
 
-				return receiver.processFilteredPacket(pChannel, NULL);
+				return PacketFilter::recv(pChannel, receiver, NULL);
 			}
 		}
 
@@ -249,7 +249,7 @@ Reason BlowfishFilter::recv(Channel * pChannel, PacketReceiver & receiver, Packe
 		packetLen_ = 0;
 		padSize_ = 0;
 
-		Reason ret = receiver.processFilteredPacket(pChannel, pPacket);
+		Reason ret = PacketFilter::recv(pChannel, receiver, pPacket);
 		if(ret != REASON_SUCCESS)
 		{
 			if(pPacket_)
@@ -336,6 +336,225 @@ void BlowfishFilter::decrypt(Packet * pInPacket, Packet * pOutPacket)
 	}
 }
 
+//-------------------------------------------------------------------------------------
+AesGcmFilter::AesGcmFilter(const Key & key):
+KBEAesGcm(key, true),
+pPacket_(NULL)
+{
+}
+
+//-------------------------------------------------------------------------------------
+AesGcmFilter::AesGcmFilter():
+KBEAesGcm(),
+pPacket_(NULL)
+{
+}
+
+//-------------------------------------------------------------------------------------
+AesGcmFilter::~AesGcmFilter()
+{
+	if(pPacket_)
+	{
+		RECLAIM_PACKET(pPacket_->isTCPPacket(), pPacket_);
+		pPacket_ = NULL;
+	}
+}
+
+//-------------------------------------------------------------------------------------
+Reason AesGcmFilter::send(Channel * pChannel, PacketSender& sender, Packet * pPacket)
+{
+	if(!pPacket->encrypted())
+	{
+		AUTO_SCOPED_PROFILE("encryptSend")
+
+		// 记录长度使用PacketLength
+		if (!isGood_ || pPacket->length() + TAG_SIZE > 0xFFFF)
+		{
+			WARNING_MSG(fmt::format("AesGcmFilter::send: "
+				"Dropping packet to {} due to invalid filter, size={}\n",
+				pChannel->addr().c_str(), pPacket->length()));
+
+			return REASON_GENERAL_NETWORK;
+		}
+
+		encrypt(pPacket, pPacket);
+
+		if (Network::g_trace_packet > 0 && Network::g_trace_encrypted_packet)
+		{
+			if (Network::g_trace_packet_use_logfile)
+				DebugHelper::getSingleton().changeLogger("packetlogs");
+
+			DEBUG_MSG(fmt::format("<==== AesGcmFilter::send: encryptedLen={}\n",
+				pPacket->length()));
+
+			switch (Network::g_trace_packet)
+			{
+			case 1:
+				pPacket->hexlike();
+				break;
+			case 2:
+				pPacket->textlike();
+				break;
+			default:
+				pPacket->print_storage();
+				break;
+			};
+
+			if (Network::g_trace_packet_use_logfile)
+				DebugHelper::getSingleton().changeLogger(COMPONENT_NAME_EX(g_componentType));
+		}
+	}
+	
+	return PacketFilter::send(pChannel, sender, pPacket);
+}
+
+//-------------------------------------------------------------------------------------
+Reason AesGcmFilter::recv(Channel * pChannel, PacketReceiver & receiver, Packet * pPacket)
+{
+	AUTO_SCOPED_PROFILE("encryptRecv")
+
+	if (!isGood_)
+	{
+		WARNING_MSG(fmt::format("AesGcmFilter::recv: "
+			"Dropping packet to {} due to invalid filter\n",
+			pChannel->addr().c_str()));
+
+		return REASON_GENERAL_NETWORK;
+	}
+
+	// 先与上次剩下的不完整记录合并
+	if(pPacket_)
+	{
+		if(pPacket)
+		{
+			pPacket_->append(pPacket->data() + pPacket->rpos(), pPacket->length());
+			RECLAIM_PACKET(pPacket->isTCPPacket(), pPacket);
+		}
+
+		pPacket = pPacket_;
+		pPacket_ = NULL;
+	}
+
+	if(pPacket == NULL)
+		return PacketFilter::recv(pChannel, receiver, NULL);
+
+	decrypt(pPacket, pPacket);
+
+	if (!isGood_)
+	{
+		ERROR_MSG(fmt::format("AesGcmFilter::recv: "
+			"authentication failed, addr={}\n",
+			pChannel->addr().c_str()));
+
+		RECLAIM_PACKET(pPacket->isTCPPacket(), pPacket);
+		pChannel->condemn();
+		return REASON_GENERAL_NETWORK;
+	}
+
+	if(pPacket_ == pPacket)
+		return PacketFilter::recv(pChannel, receiver, NULL);
+
+	if(pPacket->length() == 0)
+	{
+		RECLAIM_PACKET(pPacket->isTCPPacket(), pPacket);
+		return PacketFilter::recv(pChannel, receiver, NULL);
+	}
+
+	return PacketFilter::recv(pChannel, receiver, pPacket);
+}
+
+//-------------------------------------------------------------------------------------
+void AesGcmFilter::encrypt(Packet * pInPacket, Packet * pOutPacket)
+{
+	size_t start = pInPacket->rpos();
+	size_t plainLen = pInPacket->length();
+	size_t recordLen = PACKET_LENGTH_SIZE + plainLen + TAG_SIZE;
+
+	if(pInPacket->size() < start + recordLen)
+		pInPacket->data_resize(start + recordLen);
+
+	// 在原包中腾出长度头的位置， 密文与认证标签直接写回原包
+	uint8* pRecord = pInPacket->data() + start;
+	memmove(pRecord + PACKET_LENGTH_SIZE, pRecord, plainLen);
+
+	if(!seal(pRecord + PACKET_LENGTH_SIZE, (int)plainLen, pRecord + PACKET_LENGTH_SIZE + plainLen))
+	{
+		ERROR_MSG("AesGcmFilter::encrypt: seal failed!\n");
+		isGood_ = false;
+	}
+
+	pInPacket->wpos((int)start);
+	(*pInPacket) << (PacketLength)(plainLen + TAG_SIZE);
+	pInPacket->wpos((int)(start + recordLen));
+	pInPacket->encrypted(true);
+
+	if(pInPacket != pOutPacket)
+	{
+		pOutPacket->append(pInPacket->data() + start, recordLen);
+		pOutPacket->encrypted(true);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void AesGcmFilter::decrypt(Packet * pInPacket, Packet * pOutPacket)
+{
+	// 解密pInPacket中所有完整的记录， 明文在原包中依次前移拼接， 
+	// 不完整的剩余部分放入pPacket_等待下一个包
+	size_t rpos = pInPacket->rpos();
+	size_t wpos = pInPacket->wpos();
+	size_t in = rpos;
+	size_t out = rpos;
+
+	while(wpos - in >= PACKET_LENGTH_SIZE)
+	{
+		PacketLength recordLen = 0;
+		pInPacket->rpos((int)in);
+		(*pInPacket) >> recordLen;
+
+		if(recordLen < TAG_SIZE)
+		{
+			isGood_ = false;
+			break;
+		}
+
+		if(wpos - in - PACKET_LENGTH_SIZE < recordLen)
+			break;
+
+		uint8* pCipher = pInPacket->data() + in + PACKET_LENGTH_SIZE;
+		int cipherLen = recordLen - TAG_SIZE;
+
+		if(!open(pCipher, cipherLen, pCipher + cipherLen))
+		{
+			isGood_ = false;
+			break;
+		}
+
+		memmove(pInPacket->data() + out, pCipher, cipherLen);
+		out += cipherLen;
+		in += PACKET_LENGTH_SIZE + recordLen;
+	}
+
+	if(isGood_ && in < wpos)
+	{
+		// 没有完整的记录， 整个包留待与下一个包合并
+		if(in == rpos && pInPacket == pOutPacket)
+		{
+			pInPacket->rpos((int)rpos);
+			pPacket_ = pInPacket;
+			return;
+		}
+
+		MALLOC_PACKET(pPacket_, pInPacket->isTCPPacket());
+		pPacket_->append(pInPacket->data() + in, wpos - in);
+	}
+
+	pInPacket->rpos((int)rpos);
+	pInPacket->wpos((int)out);
+
+	if(pInPacket != pOutPacket)
+		pOutPacket->append(pInPacket->data() + rpos, out - rpos);
+}
+
 //-------------------------------------------------------------------------------------
 
 } 
@@ -26,6 +26,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 
 #ifdef USE_OPENSSL
 #include "common/blowfish.h"
+#include "common/aesgcm.h"
 #endif
 
 namespace KBEngine { 
@@ -39,6 +40,9 @@ public:
 
 	virtual void encrypt(Packet * pInPacket, Packet * pOutPacket) = 0;
 	virtual void decrypt(Packet * pInPacket, Packet * pOutPacket) = 0;
+
+	// 客户端在hello中发送给服务端的key
+	virtual const std::string& key() const = 0;
 };
 
 
@@ -57,6 +61,9 @@ public:
 
 	void encrypt(Packet * pInPacket, Packet * pOutPacket);
 	void decrypt(Packet * pInPacket, Packet * pOutPacket);
+
+	const std::string& key() const { return KBEBlowfish::key(); }
+
 private:
 	Packet * pPacket_;
 	Network::PacketLength packetLen_;
@@ -65,6 +72,34 @@ private:
 
 typedef SmartPointer<BlowfishFilter> BlowfishFilterPtr;
 
+/*
+	AES-128-GCM， 每个包原地加密为一条记录: [PacketLength 密文长度 + TAG_SIZE][密文][认证标签]
+	nonce由双方的记录计数器隐式得出， 认证失败则断开通道
+*/
+class AesGcmFilter : public EncryptionFilter, public KBEAesGcm
+{
+public:
+	virtual ~AesGcmFilter();
+
+	// 服务端， key来自客户端的hello
+	AesGcmFilter(const Key & key);
+
+	// 客户端， 随机生成key
+	AesGcmFilter();
+
+	virtual Reason send(Channel * pChannel, PacketSender& sender, Packet * pPacket);
+
+	virtual Reason recv(Channel * pChannel, PacketReceiver & receiver, Packet * pPacket);
+
+	void encrypt(Packet * pInPacket, Packet * pOutPacket);
+	void decrypt(Packet * pInPacket, Packet * pOutPacket);
+
+	const std::string& key() const { return KBEAesGcm::key(); }
+
+private:
+	Packet * pPacket_;
+};
+
 inline EncryptionFilter* createEncryptionFilter(int8 type, const std::string& datas)
 {
 	EncryptionFilter* pEncryptionFilter = NULL;
@@ -73,6 +108,30 @@ inline EncryptionFilter* createEncryptionFilter(int8 type, const std::string& da
 	case 1:
 		pEncryptionFilter = new BlowfishFilter(datas);
 		break;
+	case 3:
+		pEncryptionFilter = new AesGcmFilter(datas);
+		break;
+	default:
+		break;
+	}
+
+	return pEncryptionFilter;
+}
+
+/**
+	客户端(bots)使用， 随机生成key， key需要通过hello发送给服务端
+*/
+inline EncryptionFilter* createClientEncryptionFilter(int8 type)
+{
+	EncryptionFilter* pEncryptionFilter = NULL;
+	switch(type)
+	{
+	case 1:
+		pEncryptionFilter = new BlowfishFilter();
+		break;
+	case 3:
+		pEncryptionFilter = new AesGcmFilter();
+		break;
 	default:
 		break;
 	}
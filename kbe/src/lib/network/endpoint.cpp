@@ -114,6 +114,7 @@ void EndPoint::onReclaimObject()
 #endif
 
 	address_ = Address::NONE;
+	pShmTransport_ = NULL;
 }
 
 //-------------------------------------------------------------------------------------
@@ -32,6 +32,7 @@ namespace Network
 {
 
 class Bundle;
+class ShmTransport;
 class EndPoint : public PoolObject
 {
 public:
@@ -132,9 +133,16 @@ public:
 
 	bool waitSend();
 
+	/**
+		同机组件之间切换到共享内存发送后，send不再走socket
+	*/
+	INLINE ShmTransport* pShmTransport() const;
+	INLINE void pShmTransport(ShmTransport* pShmTransport);
+
 protected:
 	KBESOCKET socket_;
 	Address address_;
+	ShmTransport* pShmTransport_;
 };
 
 }
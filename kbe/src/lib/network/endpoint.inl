@@ -19,16 +19,19 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 
+#include "network/shm_transport.h"
+
 namespace KBEngine { 
 namespace Network
 {
 
 INLINE EndPoint::EndPoint(u_int32_t networkAddr, u_int16_t networkPort):
 #if KBE_PLATFORM == PLATFORM_WIN32
-socket_(INVALID_SOCKET)
+socket_(INVALID_SOCKET),
 #else
-socket_(-1)
+socket_(-1),
 #endif
+pShmTransport_(NULL)
 {
 	if(networkAddr)
 	{
@@ -39,10 +42,11 @@ socket_(-1)
 
 INLINE EndPoint::EndPoint(Address address):
 #if KBE_PLATFORM == PLATFORM_WIN32
-socket_(INVALID_SOCKET)
+socket_(INVALID_SOCKET),
 #else
-socket_(-1)
+socket_(-1),
 #endif
+pShmTransport_(NULL)
 {
 	if(address.ip > 0)
 	{
@@ -407,9 +411,22 @@ INLINE EndPoint * EndPoint::accept(u_int16_t * networkPort, u_int32_t * networkA
 
 INLINE int EndPoint::send(const void * gramData, int gramSize)
 {
+	if(pShmTransport_)
+		return pShmTransport_->send(gramData, gramSize);
+
 	return ::send(socket_, (char*)gramData, gramSize, 0);
 }
 
+INLINE ShmTransport* EndPoint::pShmTransport() const
+{
+	return pShmTransport_;
+}
+
+INLINE void EndPoint::pShmTransport(ShmTransport* pShmTransport)
+{
+	pShmTransport_ = pShmTransport;
+}
+
 INLINE int EndPoint::recv(void * gramData, int gramSize)
 {
 	return ::recv(socket_, (char*)gramData, gramSize, 0);
@@ -23,6 +23,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "common/md5.h"
 #include "network/channel.h"
 #include "network/network_interface.h"
+#include "network/network_stats.h"
 #include "network/packet_receiver.h"
 #include "network/fixed_messages.h"
 #include "helper/watcher.h"
@@ -71,7 +72,8 @@ pMessageHandlers(NULL),
 send_size(0),
 send_count(0),
 recv_size(0),
-recv_count(0)
+recv_count(0),
+pTimingStats(NULL)
 {
 }
 
@@ -79,6 +81,52 @@ recv_count(0)
 MessageHandler::~MessageHandler()
 {
 	SAFE_RELEASE(pArgs);
+	SAFE_RELEASE(pTimingStats);
+}
+
+//-------------------------------------------------------------------------------------
+uint32 MessageHandler::handleTimeAvg() const
+{
+	if(pTimingStats == NULL)
+		return 0;
+
+	return (uint32)(stampsToSeconds((uint64)pTimingStats->handleTime.mean()) * 1000000.0);
+}
+
+//-------------------------------------------------------------------------------------
+uint32 MessageHandler::handleTimeP99() const
+{
+	if(pTimingStats == NULL)
+		return 0;
+
+	return (uint32)(stampsToSeconds(pTimingStats->handleTime.valueAtPercentile(99.0)) * 1000000.0);
+}
+
+//-------------------------------------------------------------------------------------
+uint32 MessageHandler::handleTimeMax() const
+{
+	if(pTimingStats == NULL)
+		return 0;
+
+	return (uint32)(stampsToSeconds(pTimingStats->handleTime.max()) * 1000000.0);
+}
+
+//-------------------------------------------------------------------------------------
+uint32 MessageHandler::queueDelayP99() const
+{
+	if(pTimingStats == NULL)
+		return 0;
+
+	return (uint32)(stampsToSeconds(pTimingStats->queueDelay.valueAtPercentile(99.0)) * 1000000.0);
+}
+
+//-------------------------------------------------------------------------------------
+uint32 MessageHandler::recvSizeP99() const
+{
+	if(pTimingStats == NULL)
+		return 0;
+
+	return (uint32)pTimingStats->msgSize.valueAtPercentile(99.0);
 }
 
 //-------------------------------------------------------------------------------------
@@ -141,6 +189,21 @@ bool MessageHandlers::initializeWatcher()
 
 		kbe_snprintf(buf, MAX_BUF * 2, "network/messages/%s/recvAvgSize", sname.c_str());
 		WATCH_OBJECT(buf, iter->second, &MessageHandler::recvavgsize);
+
+		kbe_snprintf(buf, MAX_BUF * 2, "network/messages/%s/timings/handleTimeAvg", sname.c_str());
+		WATCH_OBJECT(buf, iter->second, &MessageHandler::handleTimeAvg);
+
+		kbe_snprintf(buf, MAX_BUF * 2, "network/messages/%s/timings/handleTimeP99", sname.c_str());
+		WATCH_OBJECT(buf, iter->second, &MessageHandler::handleTimeP99);
+
+		kbe_snprintf(buf, MAX_BUF * 2, "network/messages/%s/timings/handleTimeMax", sname.c_str());
+		WATCH_OBJECT(buf, iter->second, &MessageHandler::handleTimeMax);
+
+		kbe_snprintf(buf, MAX_BUF * 2, "network/messages/%s/timings/queueDelayP99", sname.c_str());
+		WATCH_OBJECT(buf, iter->second, &MessageHandler::queueDelayP99);
+
+		kbe_snprintf(buf, MAX_BUF * 2, "network/messages/%s/timings/recvSizeP99", sname.c_str());
+		WATCH_OBJECT(buf, iter->second, &MessageHandler::recvSizeP99);
 	}
 
 	return true;
@@ -35,6 +35,7 @@ namespace Network
 
 class Channel;
 class MessageHandlers;
+struct MessageTimingStats;
 
 /** 一个消息的参数抽象类 */
 class MessageArgs
@@ -92,6 +93,16 @@ public:
 	uint32 recvcount() const  { return recv_count; }
 	uint32 recvavgsize() const  { return (recv_count <= 0) ? 0 : recv_size / recv_count; }
 
+	// 开启了消息耗时统计后才会被创建, 参见NetworkStats::trackHandlerTiming
+	mutable MessageTimingStats* pTimingStats;
+
+	// 以下单位均为微秒
+	uint32 handleTimeAvg() const;
+	uint32 handleTimeP99() const;
+	uint32 handleTimeMax() const;
+	uint32 queueDelayP99() const;
+	uint32 recvSizeP99() const;
+
 	/**
 		默认返回类别为组件消息
 	*/
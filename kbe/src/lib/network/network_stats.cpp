@@ -21,6 +21,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "network_stats.h"
 #include "helper/watcher.h"
 #include "network/message_handler.h"
+#include "common/timestamp.h"
 
 namespace KBEngine { 
 
@@ -34,6 +35,7 @@ NetworkStats g_networkStats;
 //-------------------------------------------------------------------------------------
 NetworkStats::NetworkStats():
 stats_(),
+trackTimings_(false),
 handlers_()
 {
 }
@@ -89,6 +91,111 @@ void NetworkStats::trackMessage(S_OP op, const MessageHandler& msgHandler, uint3
 	}
 }
 
+//-------------------------------------------------------------------------------------
+void NetworkStats::trackTimings(bool v)
+{
+	trackTimings_ = v;
+}
+
+//-------------------------------------------------------------------------------------
+void NetworkStats::trackHandlerTiming(const MessageHandler& msgHandler, uint64 recvTime, 
+	uint64 startTime, uint64 endTime, uint32 size)
+{
+	MessageTimingStats* pTimingStats = msgHandler.pTimingStats;
+	if(pTimingStats == NULL)
+	{
+		pTimingStats = new MessageTimingStats();
+		msgHandler.pTimingStats = pTimingStats;
+	}
+
+	pTimingStats->handleTime.record(endTime - startTime);
+	pTimingStats->msgSize.record(size);
+
+	if(recvTime > 0 && startTime > recvTime)
+		pTimingStats->queueDelay.record(startTime - recvTime);
+}
+
+//-------------------------------------------------------------------------------------
+void NetworkStats::trackCompression(S_OP op, uint32 rawSize, uint32 wireSize, uint64 elapsed)
+{
+	CompressionStats& stats = compressionStats_[op];
+	++stats.packets;
+	stats.rawBytes += rawSize;
+	stats.wireBytes += wireSize;
+	stats.elapsed += elapsed;
+}
+
+//-------------------------------------------------------------------------------------
+void NetworkStats::resetTimings()
+{
+	std::vector<MessageHandlers*>::iterator rootiter = MessageHandlers::messageHandlers().begin();
+	for(; rootiter != MessageHandlers::messageHandlers().end(); ++rootiter)
+	{
+		MessageHandlers::MessageHandlerMap::const_iterator iter = (*rootiter)->msgHandlers().begin();
+		for(; iter != (*rootiter)->msgHandlers().end(); ++iter)
+		{
+			SAFE_RELEASE(iter->second->pTimingStats);
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------
+static bool timingStatsCmp(const MessageHandler* a, const MessageHandler* b)
+{
+	return a->pTimingStats->handleTime.sum() > b->pTimingStats->handleTime.sum();
+}
+
+//-------------------------------------------------------------------------------------
+std::string NetworkStats::timingsReport(uint32 maxLines, const char* newline)
+{
+	std::vector<MessageHandler*> handlers;
+
+	std::vector<MessageHandlers*>::iterator rootiter = MessageHandlers::messageHandlers().begin();
+	for(; rootiter != MessageHandlers::messageHandlers().end(); ++rootiter)
+	{
+		MessageHandlers::MessageHandlerMap::const_iterator iter = (*rootiter)->msgHandlers().begin();
+		for(; iter != (*rootiter)->msgHandlers().end(); ++iter)
+		{
+			if(iter->second->pTimingStats && iter->second->pTimingStats->handleTime.count() > 0)
+				handlers.push_back(iter->second);
+		}
+	}
+
+	std::sort(handlers.begin(), handlers.end(), timingStatsCmp);
+
+	std::string datas = fmt::format("tracking={}, unit=us(size=bytes){}", 
+		(trackTimings_ ? "on" : "off"), newline);
+
+	datas += fmt::format("{:<48}{:>10}{:>12}{:>10}{:>10}{:>10}{:>10}{:>10}{:>10}{:>10}{}", 
+		"name", "count", "total", "avg", "p50", "p99", "max", "qP50", "qP99", "sizeP99", newline);
+
+	const double us = 1000000.0 / stampsPerSecondD();
+
+	std::vector<MessageHandler*>::iterator iter = handlers.begin();
+	for(uint32 i = 0; iter != handlers.end(); ++iter, ++i)
+	{
+		if(maxLines > 0 && i >= maxLines)
+			break;
+
+		const MessageTimingStats& stats = *(*iter)->pTimingStats;
+
+		datas += fmt::format("{:<48}{:>10}{:>12}{:>10}{:>10}{:>10}{:>10}{:>10}{:>10}{:>10}{}",
+			(*iter)->name, 
+			stats.handleTime.count(),
+			(uint64)(stats.handleTime.sum() * us),
+			(uint64)(stats.handleTime.mean() * us),
+			(uint64)(stats.handleTime.valueAtPercentile(50.0) * us),
+			(uint64)(stats.handleTime.valueAtPercentile(99.0) * us),
+			(uint64)(stats.handleTime.max() * us),
+			(uint64)(stats.queueDelay.valueAtPercentile(50.0) * us),
+			(uint64)(stats.queueDelay.valueAtPercentile(99.0) * us),
+			stats.msgSize.valueAtPercentile(99.0),
+			newline);
+	}
+
+	return datas;
+}
+
 //-------------------------------------------------------------------------------------
 }
 }
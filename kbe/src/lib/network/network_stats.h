@@ -24,6 +24,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "network/interfaces.h"
 #include "common/common.h"
 #include "common/singleton.h"
+#include "helper/histogram.h"
 
 namespace KBEngine { 
 namespace Network
@@ -31,6 +32,22 @@ namespace Network
 
 class MessageHandler;
 
+/*
+	单个消息handler的耗时分布统计
+	handleTime与queueDelay记录的是TimeStamp, msgSize记录的是字节数
+*/
+struct MessageTimingStats
+{
+	// handler执行耗时
+	Histogram handleTime;
+
+	// 数据包被接收到之后直到消息被派发的等待时间
+	Histogram queueDelay;
+
+	// 消息体大小
+	Histogram msgSize;
+};
+
 /*
 	记录network流量等信息
 */
@@ -62,6 +79,26 @@ public:
 
 	typedef KBEUnordered_map<std::string, Stats> STATS;
 
+	/*
+		压缩过滤器的统计， rawBytes为压缩前(解压后)的字节数， wireBytes为实际传输的字节数，
+		elapsed为压缩(解压)耗时(TimeStamp)
+	*/
+	struct CompressionStats
+	{
+		CompressionStats():
+		packets(0),
+		rawBytes(0),
+		wireBytes(0),
+		elapsed(0)
+		{
+		}
+
+		uint64 packets;
+		uint64 rawBytes;
+		uint64 wireBytes;
+		uint64 elapsed;
+	};
+
 	NetworkStats();
 	~NetworkStats();
 
@@ -72,9 +109,35 @@ public:
 	void addHandler(NetworkStatsHandler* pHandler);
 	void removeHandler(NetworkStatsHandler* pHandler);
 
+	/**
+		消息handler的耗时统计开关， 关闭时消息派发路径上只多一次判断
+	*/
+	bool trackTimings() const { return trackTimings_; }
+	void trackTimings(bool v);
+
+	/**
+		recvTime为数据包被接收的时间(如果未知则为0), startTime和endTime为handler执行的起止时间
+	*/
+	void trackHandlerTiming(const MessageHandler& msgHandler, uint64 recvTime, 
+		uint64 startTime, uint64 endTime, uint32 size);
+
+	void resetTimings();
+
+	void trackCompression(S_OP op, uint32 rawSize, uint32 wireSize, uint64 elapsed);
+	const CompressionStats& compressionStats(S_OP op) const { return compressionStats_[op]; }
+
+	/**
+		按handler总耗时排序生成一份报告， maxLines为0则不限制行数
+	*/
+	std::string timingsReport(uint32 maxLines = 0, const char* newline = "\n");
+
 private:
 	STATS stats_;
 
+	bool trackTimings_;
+
+	CompressionStats compressionStats_[2];
+
 	std::vector<NetworkStatsHandler*> handlers_;
 };
 
@@ -34,6 +34,7 @@ public:
 	isTCPPacket_(isTCPPacket),
 	encrypted_(false),
 	pBundle_(NULL),
+	recvTime_(0),
 	sentSize(0)
 	{
 	};
@@ -51,7 +52,7 @@ public:
 	virtual size_t getPoolObjectBytes()
 	{
 		size_t bytes = sizeof(msgID_) + sizeof(isTCPPacket_) + sizeof(encrypted_) + sizeof(pBundle_)
-		 + sizeof(sentSize);
+		 + sizeof(recvTime_) + sizeof(sentSize);
 
 		return MemoryStream::getPoolObjectBytes() + bytes;
 	}
@@ -70,6 +71,7 @@ public:
 		sentSize = 0;
 		msgID_ = 0;
 		pBundle_ = NULL;
+		recvTime_ = 0;
 		// memset(data(), 0, size());
 	};
 	
@@ -86,11 +88,16 @@ public:
 
 	void encrypted(bool v) { encrypted_ = v; }
 
+	// 数据包放入接收窗口时的时间， 只在开启了消息耗时统计时才会被记录
+	uint64 recvTime() const { return recvTime_; }
+	void recvTime(uint64 v) { recvTime_ = v; }
+
 protected:
 	MessageID msgID_;
 	bool isTCPPacket_;
 	bool encrypted_;
 	Bundle* pBundle_;
+	uint64 recvTime_;
 
 public:
 	uint32 sentSize;
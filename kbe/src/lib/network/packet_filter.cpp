@@ -33,15 +33,47 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 namespace KBEngine { 
 namespace Network
 {
+//-------------------------------------------------------------------------------------
+PacketFilter::PacketFilter():
+pNextFilter_(NULL),
+pPrevFilter_(NULL)
+{
+}
+
+//-------------------------------------------------------------------------------------
+PacketFilter::~PacketFilter()
+{
+	pNextFilter(NULL);
+}
+
+//-------------------------------------------------------------------------------------
+void PacketFilter::pNextFilter(PacketFilter* pFilter)
+{
+	if(pNextFilter_)
+		pNextFilter_->pPrevFilter_ = NULL;
+
+	pNextFilter_ = pFilter;
+
+	if(pNextFilter_)
+		pNextFilter_->pPrevFilter_ = this;
+}
+
 //-------------------------------------------------------------------------------------
 Reason PacketFilter::send(Channel * pChannel, PacketSender& sender, Packet * pPacket)
 {
+	if(pNextFilter_)
+		return pNextFilter_->send(pChannel, sender, pPacket);
+
 	return sender.processFilterPacket(pChannel, pPacket);
 }
 
 //-------------------------------------------------------------------------------------
 Reason PacketFilter::recv(Channel * pChannel, PacketReceiver & receiver, Packet * pPacket)
 {
+	// NULL表示过滤器还在组包， 不需要经过上层过滤器
+	if(pPrevFilter_ && pPacket)
+		return pPrevFilter_->recv(pChannel, receiver, pPacket);
+
 	return receiver.processFilteredPacket(pChannel, pPacket);
 }
 
@@ -38,14 +38,32 @@ class PacketFilter;
 class PacketReceiver;
 class PacketSender;
 
+/*
+	过滤器可以串成一条链， pNextFilter_更靠近socket。
+	发送时从链头往socket方向依次处理， 接收时从链尾往上层依次处理，
+	派生类处理完毕后调用PacketFilter::send/recv交给链上的下一个环节。
+*/
 class PacketFilter : public RefCountable
 {
 public:
-	virtual ~PacketFilter() {}
+	PacketFilter();
+	virtual ~PacketFilter();
 
 	virtual Reason send(Channel * pChannel, PacketSender& sender, Packet * pPacket);
 
 	virtual Reason recv(Channel * pChannel, PacketReceiver & receiver, Packet * pPacket);
+
+	INLINE PacketFilter* pNextFilter() const;
+	void pNextFilter(PacketFilter* pFilter);
+
+	/**
+		链上最靠近socket的过滤器， 接收到的数据包从这里进入
+	*/
+	INLINE PacketFilter* pLastFilter();
+
+protected:
+	SmartPointer<PacketFilter> pNextFilter_;
+	PacketFilter* pPrevFilter_;
 };
 
 typedef SmartPointer<PacketFilter> PacketFilterPtr;
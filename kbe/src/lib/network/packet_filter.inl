@@ -29,5 +29,19 @@ namespace KBEngine {
 namespace Network
 {
 
+INLINE PacketFilter* PacketFilter::pNextFilter() const
+{
+	return pNextFilter_.get();
+}
+
+INLINE PacketFilter* PacketFilter::pLastFilter()
+{
+	PacketFilter* pFilter = this;
+	while(pFilter->pNextFilter_)
+		pFilter = pFilter->pNextFilter_.get();
+
+	return pFilter;
+}
+
 } 
 }
@@ -30,11 +30,10 @@ namespace Network
 
 //-------------------------------------------------------------------------------------
 PacketReader::PacketReader(Channel* pChannel):
-	pFragmentDatas_(NULL),
-	pFragmentDatasWpos_(0),
 	pFragmentDatasRemain_(0),
 	fragmentDatasFlag_(FRAGMENT_DATA_UNKNOW),
 	pFragmentStream_(NULL),
+	fragmentBodyReady_(false),
 	currMsgID_(0),
 	currMsgLen_(0),
 	pChannel_(pChannel)
@@ -52,20 +51,22 @@ PacketReader::~PacketReader()
 void PacketReader::reset()
 {
 	fragmentDatasFlag_ = FRAGMENT_DATA_UNKNOW;
-	pFragmentDatasWpos_ = 0;
 	pFragmentDatasRemain_ = 0;
+	fragmentBodyReady_ = false;
 	currMsgID_ = 0;
 	currMsgLen_ = 0;
 	
-	SAFE_RELEASE_ARRAY(pFragmentDatas_);
-	MemoryStream::reclaimPoolObject(pFragmentStream_);
-	pFragmentStream_ = NULL;
+	if(pFragmentStream_)
+	{
+		MemoryStream::reclaimPoolObject(pFragmentStream_);
+		pFragmentStream_ = NULL;
+	}
 }
 
 //-------------------------------------------------------------------------------------
 void PacketReader::processMessages(KBEngine::Network::MessageHandlers* pMsgHandlers, Packet* pPacket)
 {
-	while(pPacket->length() > 0 || pFragmentStream_ != NULL)
+	while(pPacket->length() > 0 || fragmentBodyReady_)
 	{
 		if(fragmentDatasFlag_ == FRAGMENT_DATA_UNKNOW)
 		{
@@ -86,7 +87,7 @@ void PacketReader::processMessages(KBEngine::Network::MessageHandlers* pMsgHandl
 
 			if(pMsgHandler == NULL)
 			{
-				MemoryStream* pPacket1 = pFragmentStream_ != NULL ? pFragmentStream_ : pPacket;
+				MemoryStream* pPacket1 = fragmentBodyReady_ ? pFragmentStream_ : pPacket;
 				TRACE_MESSAGE_PACKET(true, pPacket1, pMsgHandler, pPacket1->length(), pChannel_->c_str(), false);
 				
 				// 用作调试时比对
@@ -165,7 +166,7 @@ void PacketReader::processMessages(KBEngine::Network::MessageHandlers* pMsgHandl
 				g_componentType != CLIENT_TYPE && 
 				currMsgLen_ > NETWORK_MESSAGE_MAX_SIZE)
 			{
-				MemoryStream* pPacket1 = pFragmentStream_ != NULL ? pFragmentStream_ : pPacket;
+				MemoryStream* pPacket1 = fragmentBodyReady_ ? pFragmentStream_ : pPacket;
 				TRACE_MESSAGE_PACKET(true, pPacket1, pMsgHandler, pPacket1->length(), pChannel_->c_str(), false);
 
 				// 用作调试时比对
@@ -182,12 +183,18 @@ void PacketReader::processMessages(KBEngine::Network::MessageHandlers* pMsgHandl
 				break;
 			}
 
-			if(pFragmentStream_ != NULL)
+			if(fragmentBodyReady_)
 			{
 				TRACE_MESSAGE_PACKET(true, pFragmentStream_, pMsgHandler, currMsgLen_, pChannel_->c_str(), false);
-				pMsgHandler->handle(pChannel_, *pFragmentStream_);
-				MemoryStream::reclaimPoolObject(pFragmentStream_);
-				pFragmentStream_ = NULL;
+				handleMessage(pMsgHandler, *pFragmentStream_, pPacket);
+				
+				// handler可能重置了reader(例如通道被销毁)
+				fragmentBodyReady_ = false;
+				if(pFragmentStream_)
+				{
+					pFragmentStream_->clear(false);
+					pFragmentStream_->shrink(FRAGMENT_STREAM_KEEP_SIZE);
+				}
 			}
 			else
 			{
@@ -204,7 +211,7 @@ void PacketReader::processMessages(KBEngine::Network::MessageHandlers* pMsgHandl
 				pPacket->wpos(frpos);
 
 				TRACE_MESSAGE_PACKET(true, pPacket, pMsgHandler, currMsgLen_, pChannel_->c_str(), true);
-				pMsgHandler->handle(pChannel_, *pPacket);
+				handleMessage(pMsgHandler, *pPacket, pPacket);
 
 				// 如果handler没有处理完数据则输出一个警告
 				if(currMsgLen_ > 0)
@@ -231,21 +238,44 @@ void PacketReader::processMessages(KBEngine::Network::MessageHandlers* pMsgHandl
 	}
 }
 
+//-------------------------------------------------------------------------------------
+void PacketReader::handleMessage(MessageHandler* pMsgHandler, MemoryStream& s, Packet* pPacket)
+{
+	NetworkStats& networkStats = NetworkStats::getSingleton();
+	if(!networkStats.trackTimings())
+	{
+		pMsgHandler->handle(pChannel_, s);
+		return;
+	}
+
+	// handler中可能会改变reader的状态， 先记录下来
+	uint32 msglen = currMsgLen_;
+	uint64 recvTime = pPacket->recvTime();
+	uint64 startTime = timestamp();
+
+	pMsgHandler->handle(pChannel_, s);
+
+	networkStats.trackHandlerTiming(*pMsgHandler, recvTime, startTime, timestamp(), msglen);
+}
+
 //-------------------------------------------------------------------------------------
 void PacketReader::writeFragmentMessage(FragmentDataTypes fragmentDatasFlag, Packet* pPacket, uint32 datasize)
 {
-	KBE_ASSERT(pFragmentDatas_ == NULL);
+	KBE_ASSERT(fragmentDatasFlag_ == FRAGMENT_DATA_UNKNOW && !fragmentBodyReady_);
+
+	if(pFragmentStream_ == NULL)
+		pFragmentStream_ = MemoryStream::createPoolObject();
 
 	size_t opsize = pPacket->length();
 	pFragmentDatasRemain_ = datasize - opsize;
-	pFragmentDatas_ = new uint8[opsize + pFragmentDatasRemain_ + 1];
-
 	fragmentDatasFlag_ = fragmentDatasFlag;
-	pFragmentDatasWpos_ = opsize;
 
-	if(pPacket->length() > 0)
+	// 缓冲区保留上次的容量(最多FRAGMENT_STREAM_KEEP_SIZE)， 通常不需要重新分配
+	pFragmentStream_->clear(false);
+
+	if(opsize > 0)
 	{
-		memcpy(pFragmentDatas_, pPacket->data() + pPacket->rpos(), opsize);
+		pFragmentStream_->append(pPacket->data() + pPacket->rpos(), opsize);
 		pPacket->done();
 	}
 
@@ -260,30 +290,30 @@ void PacketReader::mergeFragmentMessage(Packet* pPacket)
 	if(opsize == 0)
 		return;
 
-	if(pPacket->length() >= pFragmentDatasRemain_)
+	if(opsize >= pFragmentDatasRemain_)
 	{
-		memcpy(pFragmentDatas_ + pFragmentDatasWpos_, pPacket->data() + pPacket->rpos(), pFragmentDatasRemain_);
+		pFragmentStream_->append(pPacket->data() + pPacket->rpos(), pFragmentDatasRemain_);
 		pPacket->rpos(pPacket->rpos() + pFragmentDatasRemain_);
 
-		KBE_ASSERT(pFragmentStream_ == NULL);
-
 		switch(fragmentDatasFlag_)
 		{
 		case FRAGMENT_DATA_MESSAGE_ID:			// 消息ID信息不全
-			memcpy(&currMsgID_, pFragmentDatas_, NETWORK_MESSAGE_ID_SIZE);
+			memcpy(&currMsgID_, pFragmentStream_->data(), NETWORK_MESSAGE_ID_SIZE);
+			pFragmentStream_->clear(false);
 			break;
 
 		case FRAGMENT_DATA_MESSAGE_LENGTH:		// 消息长度信息不全
-			memcpy(&currMsgLen_, pFragmentDatas_, NETWORK_MESSAGE_LENGTH_SIZE);
+			memcpy(&currMsgLen_, pFragmentStream_->data(), NETWORK_MESSAGE_LENGTH_SIZE);
+			pFragmentStream_->clear(false);
 			break;
 
 		case FRAGMENT_DATA_MESSAGE_LENGTH1:		// 消息长度信息不全
-			memcpy(&currMsgLen_, pFragmentDatas_, NETWORK_MESSAGE_LENGTH1_SIZE);
+			memcpy(&currMsgLen_, pFragmentStream_->data(), NETWORK_MESSAGE_LENGTH1_SIZE);
+			pFragmentStream_->clear(false);
 			break;
 
-		case FRAGMENT_DATA_MESSAGE_BODY:		// 消息内容信息不全
-			pFragmentStream_ = MemoryStream::createPoolObject();
-			pFragmentStream_->append(pFragmentDatas_, currMsgLen_);
+		case FRAGMENT_DATA_MESSAGE_BODY:		// 消息内容信息不全， 拼接完成后直接在缓冲区上派发
+			fragmentBodyReady_ = true;
 			break;
 
 		default:
@@ -295,13 +325,11 @@ void PacketReader::mergeFragmentMessage(Packet* pPacket)
 
 		fragmentDatasFlag_ = FRAGMENT_DATA_UNKNOW;
 		pFragmentDatasRemain_ = 0;
-		SAFE_RELEASE_ARRAY(pFragmentDatas_);
 	}
 	else
 	{
-		memcpy(pFragmentDatas_ + pFragmentDatasWpos_, pPacket->data(), opsize);
+		pFragmentStream_->append(pPacket->data() + pPacket->rpos(), opsize);
 		pFragmentDatasRemain_ -= opsize;
-		pFragmentDatasWpos_ += opsize;
 		pPacket->rpos(pPacket->rpos() + opsize);
 
 		//DEBUG_MSG(fmt::format("PacketReader::mergeFragmentMessage({}): channel[{:p}], fragmentDatasFlag={}, remainsize={}, currMsgID={}, currMsgLen={}.\n",
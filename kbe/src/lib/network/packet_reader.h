@@ -29,6 +29,7 @@ namespace KBEngine{
 namespace Network
 {
 class Channel;
+class MessageHandler;
 class MessageHandlers;
 
 class PacketReader
@@ -57,6 +58,9 @@ public:
 
 
 protected:
+	// 派发后拼接缓冲区保留的最大容量， 偶尔的大消息不应让每个通道一直占用同样大的内存
+	static const size_t FRAGMENT_STREAM_KEEP_SIZE = PACKET_MAX_SIZE_TCP * 4;
+
 	enum FragmentDataTypes
 	{
 		FRAGMENT_DATA_UNKNOW,
@@ -66,15 +70,21 @@ protected:
 		FRAGMENT_DATA_MESSAGE_BODY
 	};
 	
+	/**
+		派发一个完整的消息， 如果开启了消息耗时统计则记录handler的耗时分布
+	*/
+	void handleMessage(MessageHandler* pMsgHandler, MemoryStream& s, Packet* pPacket);
+
 	virtual void writeFragmentMessage(FragmentDataTypes fragmentDatasFlag, Packet* pPacket, uint32 datasize);
 	virtual void mergeFragmentMessage(Packet* pPacket);
 
 protected:
-	uint8*						pFragmentDatas_;
-	uint32						pFragmentDatasWpos_;
 	uint32						pFragmentDatasRemain_;
 	FragmentDataTypes			fragmentDatasFlag_;
+
+	// 跨包的数据直接拼接到这里， 消息体完整后原地派发给handler， 缓冲区在消息之间复用
 	MemoryStream*				pFragmentStream_;
+	bool						fragmentBodyReady_;
 
 	Network::MessageID			currMsgID_;
 	Network::MessageLength1		currMsgLen_;
@@ -80,7 +80,7 @@ Reason PacketReceiver::processPacket(Channel* pChannel, Packet * pPacket)
 
 		if (pChannel->pFilter())
 		{
-			return pChannel->pFilter()->recv(pChannel, *this, pPacket);
+			return pChannel->pFilter()->pLastFilter()->recv(pChannel, *this, pPacket);
 		}
 	}
 
@@ -128,6 +128,8 @@ int EpollPoller::processPendingEvents(double maxWait)
 	spareTime_ += timestamp() - startTime;
 #endif
 
+	refreshCachedTimestamp();
+
 	for (int i = 0; i < nfds; ++i)
 	{
 		if (events[i].events & (EPOLLERR|EPOLLHUP))
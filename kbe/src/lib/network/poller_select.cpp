@@ -127,6 +127,8 @@ int SelectPoller::processPendingEvents(double maxWait)
 #else
 	spareTime_ += timestamp() - startTime;
 #endif
+
+	refreshCachedTimestamp();
 	
 	if (countReady > 0)
 	{
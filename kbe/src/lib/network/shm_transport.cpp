@@ -0,0 +1,703 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "shm_transport.h"
+#include "network/address.h"
+#include "network/channel.h"
+#include "network/endpoint.h"
+#include "network/event_dispatcher.h"
+#include "network/network_interface.h"
+#include "network/error_reporter.h"
+
+#if KBE_PLATFORM != PLATFORM_WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace KBEngine { 
+namespace Network
+{
+
+#define SHM_TRANSPORT_MAGIC		0x4B42534D	// 'KBSM'
+#define SHM_TRANSPORT_VERSION	2
+#define SHM_CACHE_LINE			64
+
+// 每个方向一个环，读写位置各占一条缓存行，避免两端互相干扰
+struct ShmTransport::Ring
+{
+	volatile uint32 head;				// 读位置，只由读端修改
+	char pad0[SHM_CACHE_LINE - sizeof(uint32)];
+	volatile uint32 tail;				// 写位置，只由写端修改
+	char pad1[SHM_CACHE_LINE - sizeof(uint32)];
+	volatile uint32 readerWaiting;		// 读端准备睡眠，写端发布数据后需要唤醒
+	char pad2[SHM_CACHE_LINE - sizeof(uint32)];
+	volatile uint32 writerWaiting;		// 写端因环满而等待，读端腾出空间后需要唤醒
+	char pad3[SHM_CACHE_LINE - sizeof(uint32)];
+};
+
+struct ShmSegmentHeader
+{
+	uint32 magic;
+	uint32 version;
+	uint32 ringSize;
+	char pad[SHM_CACHE_LINE - sizeof(uint32) * 3];
+};
+
+// 一次notify写入的唤醒字节
+static const char g_shmWakeByte = 1;
+
+//-------------------------------------------------------------------------------------
+ShmPacketReceiver::ShmPacketReceiver(EndPoint & endpoint,
+	   NetworkInterface & networkInterface, ShmTransport& transport) :
+	PacketReceiver(endpoint, networkInterface),
+	transport_(transport)
+{
+}
+
+//-------------------------------------------------------------------------------------
+ShmPacketReceiver::~ShmPacketReceiver()
+{
+}
+
+//-------------------------------------------------------------------------------------
+bool ShmPacketReceiver::processRecv(bool expectingPacket)
+{
+	Channel* pChannel = getChannel();
+	if(pChannel == NULL || pChannel->isCondemn())
+		return false;
+
+	// 第一次进入时清空管道中的唤醒字节，之后的数据由环本身保证不丢失
+	if(expectingPacket)
+		transport_.drainNotify();
+
+	TCPPacket* pReceiveWindow = TCPPacket::createPoolObject();
+	int len = transport_.recv(pReceiveWindow->data(), (int)pReceiveWindow->size());
+
+	if(len <= 0)
+	{
+		TCPPacket::reclaimPoolObject(pReceiveWindow);
+		return false;
+	}
+
+	pReceiveWindow->wpos(len);
+
+	Reason ret = this->processPacket(pChannel, pReceiveWindow);
+
+	if(ret != REASON_SUCCESS)
+		this->dispatcher().errorReporter().reportException(ret, pEndpoint_->addr());
+
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+Reason ShmPacketReceiver::processFilteredPacket(Channel* pChannel, Packet * pPacket)
+{
+	if(pPacket)
+	{
+		pChannel->addReceiveWindow(pPacket);
+	}
+
+	return REASON_SUCCESS;
+}
+
+//-------------------------------------------------------------------------------------
+PacketReceiver::RecvState ShmPacketReceiver::checkSocketErrors(int len, bool expectingPacket)
+{
+	// 共享内存没有socket错误，断线由TCP连接检测
+	return RECV_STATE_BREAK;
+}
+
+//-------------------------------------------------------------------------------------
+ShmTransport::ShmTransport():
+	name_(),
+	isCreator_(false),
+	unlinked_(false),
+	ringSize_(0),
+	pSegment_(NULL),
+	segmentSize_(0),
+	pTxRing_(NULL),
+	pRxRing_(NULL),
+	pTxData_(NULL),
+	pRxData_(NULL),
+	txNotifyFd_(-1),
+	rxNotifyFd_(-1),
+	txSpaceFd_(-1),
+	rxSpaceFd_(-1),
+	pSendDispatcher_(NULL),
+	pSendHandler_(NULL),
+	pNetworkInterface_(NULL),
+	pPacketReceiver_(NULL),
+	pSendEndPoint_(NULL)
+{
+}
+
+//-------------------------------------------------------------------------------------
+ShmTransport::~ShmTransport()
+{
+	close();
+}
+
+#if KBE_PLATFORM != PLATFORM_WIN32
+//-------------------------------------------------------------------------------------
+static std::string shmNotifyPipeName(const std::string& name, int direction)
+{
+	// name以'/'开头，管道放在/tmp下
+	return fmt::format("/tmp{}_{}", name, direction);
+}
+
+// 0、1: 环中有新数据， 2、3: 环中腾出了空间
+#define SHM_NOTIFY_PIPES		4
+#define SHM_SPACE_PIPE(ring)	(2 + (ring))
+
+//-------------------------------------------------------------------------------------
+static int openNotifyPipe(const std::string& name, int direction)
+{
+	// O_RDWR打开FIFO不会阻塞等待另一端，也不会因为另一端关闭而持续可读
+	return ::open(shmNotifyPipeName(name, direction).c_str(), O_RDWR | O_NONBLOCK);
+}
+
+//-------------------------------------------------------------------------------------
+static void drainNotifyPipe(int fd)
+{
+	char buf[256];
+	while(::read(fd, buf, sizeof(buf)) > 0)
+	{
+		/* pass */;
+	}
+}
+
+//-------------------------------------------------------------------------------------
+bool ShmTransport::create(uint32 ringSize)
+{
+	static uint32 s_shmTransportCounter = 0;
+
+	// 取2的幂，读写位置可以直接用掩码回绕
+	uint32 size = 4096;
+	while(size < ringSize && size < (1u << 30))
+		size <<= 1;
+
+	ringSize_ = size;
+	isCreator_ = true;
+	name_ = fmt::format("/kbe_shm_{}_{}", (uint32)getpid(), ++s_shmTransportCounter);
+
+	int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	if(fd < 0)
+	{
+		ERROR_MSG(fmt::format("ShmTransport::create({}): shm_open failed! {}.\n", 
+			name_, kbe_strerror()));
+
+		unlinked_ = true;
+		return false;
+	}
+
+	bool ret = mapSegment(fd, true);
+	::close(fd);
+
+	if(!ret)
+	{
+		unlink();
+		return false;
+	}
+
+	for(int i = 0; i < SHM_NOTIFY_PIPES; ++i)
+	{
+		std::string pipeName = shmNotifyPipeName(name_, i);
+		if(mkfifo(pipeName.c_str(), 0600) != 0)
+		{
+			ERROR_MSG(fmt::format("ShmTransport::create({}): mkfifo({}) failed! {}.\n", 
+				name_, pipeName, kbe_strerror()));
+
+			unlink();
+			return false;
+		}
+	}
+
+	if(!openNotifyPipes())
+	{
+		unlink();
+		return false;
+	}
+
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+bool ShmTransport::open(const std::string& name)
+{
+	name_ = name;
+	isCreator_ = false;
+
+	// 名字由创建方负责删除
+	unlinked_ = true;
+
+	int fd = shm_open(name_.c_str(), O_RDWR, 0600);
+	if(fd < 0)
+	{
+		ERROR_MSG(fmt::format("ShmTransport::open({}): shm_open failed! {}.\n", 
+			name_, kbe_strerror()));
+
+		return false;
+	}
+
+	bool ret = mapSegment(fd, false);
+	::close(fd);
+
+	if(!ret)
+		return false;
+
+	return openNotifyPipes();
+}
+
+//-------------------------------------------------------------------------------------
+bool ShmTransport::mapSegment(int fd, bool init)
+{
+	size_t headerSize = sizeof(ShmSegmentHeader) + sizeof(Ring) * 2;
+
+	if(init)
+	{
+		segmentSize_ = headerSize + (size_t)ringSize_ * 2;
+
+		if(ftruncate(fd, (off_t)segmentSize_) != 0)
+		{
+			ERROR_MSG(fmt::format("ShmTransport::mapSegment({}): ftruncate({}) failed! {}.\n", 
+				name_, segmentSize_, kbe_strerror()));
+
+			return false;
+		}
+	}
+	else
+	{
+		struct stat st;
+		if(fstat(fd, &st) != 0 || (size_t)st.st_size < headerSize)
+		{
+			ERROR_MSG(fmt::format("ShmTransport::mapSegment({}): invalid segment!\n", name_));
+			return false;
+		}
+
+		segmentSize_ = (size_t)st.st_size;
+	}
+
+	void* p = mmap(NULL, segmentSize_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if(p == MAP_FAILED)
+	{
+		ERROR_MSG(fmt::format("ShmTransport::mapSegment({}): mmap({}) failed! {}.\n", 
+			name_, segmentSize_, kbe_strerror()));
+
+		segmentSize_ = 0;
+		return false;
+	}
+
+	pSegment_ = p;
+
+	ShmSegmentHeader* pHeader = (ShmSegmentHeader*)pSegment_;
+	Ring* pRings = (Ring*)((uint8*)pSegment_ + sizeof(ShmSegmentHeader));
+
+	if(init)
+	{
+		memset(pSegment_, 0, headerSize);
+		pHeader->magic = SHM_TRANSPORT_MAGIC;
+		pHeader->version = SHM_TRANSPORT_VERSION;
+		pHeader->ringSize = ringSize_;
+	}
+	else
+	{
+		if(pHeader->magic != SHM_TRANSPORT_MAGIC || pHeader->version != SHM_TRANSPORT_VERSION ||
+			segmentSize_ < headerSize + (size_t)pHeader->ringSize * 2)
+		{
+			ERROR_MSG(fmt::format("ShmTransport::mapSegment({}): header mismatch!\n", name_));
+			return false;
+		}
+
+		ringSize_ = pHeader->ringSize;
+	}
+
+	// 环0: 创建方->接受方，环1: 接受方->创建方
+	uint8* pData = (uint8*)pSegment_ + headerSize;
+	int tx = isCreator_ ? 0 : 1;
+	int rx = 1 - tx;
+
+	pTxRing_ = &pRings[tx];
+	pRxRing_ = &pRings[rx];
+	pTxData_ = pData + (size_t)ringSize_ * tx;
+	pRxData_ = pData + (size_t)ringSize_ * rx;
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+bool ShmTransport::openNotifyPipes()
+{
+	int tx = isCreator_ ? 0 : 1;
+	int rx = 1 - tx;
+
+	txNotifyFd_ = openNotifyPipe(name_, tx);
+	rxNotifyFd_ = openNotifyPipe(name_, rx);
+	txSpaceFd_ = openNotifyPipe(name_, SHM_SPACE_PIPE(tx));
+	rxSpaceFd_ = openNotifyPipe(name_, SHM_SPACE_PIPE(rx));
+
+	if(txNotifyFd_ < 0 || rxNotifyFd_ < 0 || txSpaceFd_ < 0 || rxSpaceFd_ < 0)
+	{
+		ERROR_MSG(fmt::format("ShmTransport::openNotifyPipes({}): open failed! {}.\n", 
+			name_, kbe_strerror()));
+
+		return false;
+	}
+
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+void ShmTransport::unlink()
+{
+	if(unlinked_)
+		return;
+
+	unlinked_ = true;
+
+	shm_unlink(name_.c_str());
+
+	for(int i = 0; i < SHM_NOTIFY_PIPES; ++i)
+		::unlink(shmNotifyPipeName(name_, i).c_str());
+}
+
+//-------------------------------------------------------------------------------------
+bool ShmTransport::enableRecv(NetworkInterface& networkInterface, EndPoint& endpoint)
+{
+	if(pPacketReceiver_ || rxNotifyFd_ < 0)
+		return false;
+
+	pNetworkInterface_ = &networkInterface;
+	pPacketReceiver_ = new ShmPacketReceiver(endpoint, networkInterface, *this);
+
+	if(!pNetworkInterface_->dispatcher().registerReadFileDescriptor(rxNotifyFd_, pPacketReceiver_))
+	{
+		SAFE_RELEASE(pPacketReceiver_);
+		pNetworkInterface_ = NULL;
+		return false;
+	}
+
+	// 对端可能在我们切换之前就已经写入了数据，自我唤醒一次
+	notifySelf();
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+void ShmTransport::enableSend(EndPoint& endpoint)
+{
+	if(pSendEndPoint_ || txNotifyFd_ < 0)
+		return;
+
+	pSendEndPoint_ = &endpoint;
+	endpoint.pShmTransport(this);
+}
+
+//-------------------------------------------------------------------------------------
+bool ShmTransport::waitSendSpace(EventDispatcher& dispatcher, OutputNotificationHandler* pSendHandler)
+{
+	if(pSendHandler_ || txSpaceFd_ < 0)
+		return false;
+
+	if(!dispatcher.registerReadFileDescriptor(txSpaceFd_, this))
+		return false;
+
+	pSendDispatcher_ = &dispatcher;
+	pSendHandler_ = pSendHandler;
+
+	// send()返回EAGAIN之后读端可能已经腾出了空间，唤醒字节已在管道中，不会错过
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+void ShmTransport::stopWaitSendSpace()
+{
+	if(pSendHandler_ == NULL)
+		return;
+
+	pSendDispatcher_->deregisterReadFileDescriptor(txSpaceFd_);
+	pSendDispatcher_ = NULL;
+	pSendHandler_ = NULL;
+}
+
+//-------------------------------------------------------------------------------------
+int ShmTransport::handleInputNotification(int fd)
+{
+	drainNotifyPipe(txSpaceFd_);
+
+	// 发送完成时Channel会调用stopWaitSendSpace
+	if(pSendHandler_)
+		pSendHandler_->handleOutputNotification(fd);
+
+	return 0;
+}
+
+//-------------------------------------------------------------------------------------
+void ShmTransport::close()
+{
+	stopWaitSendSpace();
+
+	if(pSendEndPoint_)
+	{
+		pSendEndPoint_->pShmTransport(NULL);
+		pSendEndPoint_ = NULL;
+	}
+
+	if(pPacketReceiver_)
+	{
+		pNetworkInterface_->dispatcher().deregisterReadFileDescriptor(rxNotifyFd_);
+		SAFE_RELEASE(pPacketReceiver_);
+		pNetworkInterface_ = NULL;
+	}
+
+	unlink();
+
+	if(txNotifyFd_ >= 0)
+	{
+		::close(txNotifyFd_);
+		txNotifyFd_ = -1;
+	}
+
+	if(rxNotifyFd_ >= 0)
+	{
+		::close(rxNotifyFd_);
+		rxNotifyFd_ = -1;
+	}
+
+	if(txSpaceFd_ >= 0)
+	{
+		::close(txSpaceFd_);
+		txSpaceFd_ = -1;
+	}
+
+	if(rxSpaceFd_ >= 0)
+	{
+		::close(rxSpaceFd_);
+		rxSpaceFd_ = -1;
+	}
+
+	if(pSegment_)
+	{
+		munmap(pSegment_, segmentSize_);
+		pSegment_ = NULL;
+		segmentSize_ = 0;
+	}
+
+	pTxRing_ = pRxRing_ = NULL;
+	pTxData_ = pRxData_ = NULL;
+}
+
+//-------------------------------------------------------------------------------------
+int ShmTransport::send(const void * data, int size)
+{
+	uint32 head = pTxRing_->head;
+	uint32 tail = pTxRing_->tail;
+	uint32 space = ringSize_ - (tail - head);
+
+	if(space == 0)
+	{
+		// 声明等待后再检查一次，与recv中先移动读位置再检查的顺序构成屏障对
+		pTxRing_->writerWaiting = 1;
+		__sync_synchronize();
+
+		head = pTxRing_->head;
+		space = ringSize_ - (tail - head);
+
+		if(space == 0)
+		{
+			// 与socket发送缓冲区满的语义一致，Channel通过waitSendSpace等待读端唤醒后重试
+			errno = EAGAIN;
+			return -1;
+		}
+
+		pTxRing_->writerWaiting = 0;
+	}
+
+	uint32 len = KBE_MIN((uint32)size, space);
+	uint32 offset = tail & (ringSize_ - 1);
+	uint32 first = KBE_MIN(len, ringSize_ - offset);
+
+	memcpy(pTxData_ + offset, data, first);
+	if(len > first)
+		memcpy(pTxData_, (const uint8*)data + first, len - first);
+
+	// 先发布数据再检查读端是否在睡眠，与recv中相反的顺序构成完整的屏障对
+	__sync_synchronize();
+	pTxRing_->tail = tail + len;
+	__sync_synchronize();
+
+	if(pTxRing_->readerWaiting)
+	{
+		pTxRing_->readerWaiting = 0;
+
+		// 管道满了说明读端已经有足够的唤醒，忽略EAGAIN
+		ssize_t ret = ::write(txNotifyFd_, &g_shmWakeByte, 1);
+		(void)ret;
+	}
+
+	return (int)len;
+}
+
+//-------------------------------------------------------------------------------------
+int ShmTransport::recv(void * data, int size)
+{
+	uint32 tail = pRxRing_->tail;
+	uint32 head = pRxRing_->head;
+
+	if(tail == head)
+	{
+		// 准备睡眠，再检查一次避免错过写端刚发布的数据
+		pRxRing_->readerWaiting = 1;
+		__sync_synchronize();
+
+		tail = pRxRing_->tail;
+		if(tail == head)
+			return 0;
+
+		pRxRing_->readerWaiting = 0;
+	}
+
+	__sync_synchronize();
+
+	uint32 len = KBE_MIN((uint32)size, tail - head);
+	uint32 offset = head & (ringSize_ - 1);
+	uint32 first = KBE_MIN(len, ringSize_ - offset);
+
+	memcpy(data, pRxData_ + offset, first);
+	if(len > first)
+		memcpy((uint8*)data + first, pRxData_, len - first);
+
+	__sync_synchronize();
+	pRxRing_->head = head + len;
+	__sync_synchronize();
+
+	if(pRxRing_->writerWaiting)
+	{
+		pRxRing_->writerWaiting = 0;
+
+		ssize_t ret = ::write(rxSpaceFd_, &g_shmWakeByte, 1);
+		(void)ret;
+	}
+
+	return (int)len;
+}
+
+//-------------------------------------------------------------------------------------
+void ShmTransport::drainNotify()
+{
+	drainNotifyPipe(rxNotifyFd_);
+}
+
+//-------------------------------------------------------------------------------------
+void ShmTransport::notifySelf()
+{
+	ssize_t ret = ::write(rxNotifyFd_, &g_shmWakeByte, 1);
+	(void)ret;
+}
+
+#else
+//-------------------------------------------------------------------------------------
+bool ShmTransport::create(uint32 ringSize)
+{
+	return false;
+}
+
+//-------------------------------------------------------------------------------------
+bool ShmTransport::open(const std::string& name)
+{
+	return false;
+}
+
+//-------------------------------------------------------------------------------------
+bool ShmTransport::mapSegment(int fd, bool init)
+{
+	return false;
+}
+
+//-------------------------------------------------------------------------------------
+bool ShmTransport::openNotifyPipes()
+{
+	return false;
+}
+
+//-------------------------------------------------------------------------------------
+void ShmTransport::unlink()
+{
+}
+
+//-------------------------------------------------------------------------------------
+bool ShmTransport::enableRecv(NetworkInterface& networkInterface, EndPoint& endpoint)
+{
+	return false;
+}
+
+//-------------------------------------------------------------------------------------
+void ShmTransport::enableSend(EndPoint& endpoint)
+{
+}
+
+//-------------------------------------------------------------------------------------
+bool ShmTransport::waitSendSpace(EventDispatcher& dispatcher, OutputNotificationHandler* pSendHandler)
+{
+	return false;
+}
+
+//-------------------------------------------------------------------------------------
+void ShmTransport::stopWaitSendSpace()
+{
+}
+
+//-------------------------------------------------------------------------------------
+int ShmTransport::handleInputNotification(int fd)
+{
+	return 0;
+}
+
+//-------------------------------------------------------------------------------------
+void ShmTransport::close()
+{
+}
+
+//-------------------------------------------------------------------------------------
+int ShmTransport::send(const void * data, int size)
+{
+	return -1;
+}
+
+//-------------------------------------------------------------------------------------
+int ShmTransport::recv(void * data, int size)
+{
+	return 0;
+}
+
+//-------------------------------------------------------------------------------------
+void ShmTransport::drainNotify()
+{
+}
+
+//-------------------------------------------------------------------------------------
+void ShmTransport::notifySelf()
+{
+}
+#endif
+
+//-------------------------------------------------------------------------------------
+}
+}
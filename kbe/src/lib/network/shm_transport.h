@@ -0,0 +1,156 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KBE_NETWORK_SHM_TRANSPORT_H
+#define KBE_NETWORK_SHM_TRANSPORT_H
+
+#include "common/common.h"
+#include "network/common.h"
+#include "network/packet_receiver.h"
+#include "network/interfaces.h"
+
+namespace KBEngine { 
+namespace Network
+{
+class EndPoint;
+class Channel;
+class NetworkInterface;
+class EventDispatcher;
+class ShmTransport;
+
+/*
+	同一台机器上的组件之间的共享内存通道。
+	共享内存中有两个单生产者单消费者的字节环(创建方->接受方，接受方->创建方)，
+	环中传输的数据与TCP流完全相同(包括消息分片)，因此PacketReader无需任何修改。
+	TCP连接继续保留，用于握手和断线检测；读端睡眠时由写端通过命名管道唤醒，
+	环满时写端等待另一条命名管道，由读端腾出空间后唤醒。
+*/
+class ShmPacketReceiver : public PacketReceiver
+{
+public:
+	ShmPacketReceiver(EndPoint & endpoint, NetworkInterface & networkInterface, ShmTransport& transport);
+	~ShmPacketReceiver();
+
+	Reason processFilteredPacket(Channel* pChannel, Packet * pPacket);
+
+protected:
+	virtual bool processRecv(bool expectingPacket);
+	virtual RecvState checkSocketErrors(int len, bool expectingPacket);
+
+protected:
+	ShmTransport& transport_;
+};
+
+class ShmTransport : public InputNotificationHandler
+{
+public:
+	struct Ring;
+
+	ShmTransport();
+	~ShmTransport();
+
+	/**
+		发起方创建共享内存及唤醒管道
+	*/
+	bool create(uint32 ringSize);
+
+	/**
+		接受方打开发起方创建的共享内存及唤醒管道
+	*/
+	bool open(const std::string& name);
+
+	/**
+		双方都已经映射后删除名字，进程退出后系统自动回收
+	*/
+	void unlink();
+
+	/**
+		读端切换到共享内存，此时对端经由TCP发来的最后一条消息必须已经处理
+	*/
+	bool enableRecv(NetworkInterface& networkInterface, EndPoint& endpoint);
+
+	/**
+		写端切换到共享内存，此时本端TCP发送队列必须为空
+	*/
+	void enableSend(EndPoint& endpoint);
+
+	/**
+		环满时等待读端腾出空间，唤醒后交给pSendHandler继续发送
+	*/
+	bool waitSendSpace(EventDispatcher& dispatcher, OutputNotificationHandler* pSendHandler);
+	void stopWaitSendSpace();
+	bool waitingSendSpace() const { return pSendHandler_ != NULL; }
+
+	/**
+		注销读事件并释放所有资源
+	*/
+	void close();
+
+	int send(const void * data, int size);
+	int recv(void * data, int size);
+
+	void drainNotify();
+	void notifySelf();
+
+	const std::string& name() const { return name_; }
+	uint32 ringSize() const { return ringSize_; }
+	bool isCreator() const { return isCreator_; }
+	bool recvEnabled() const { return pPacketReceiver_ != NULL; }
+	bool sendEnabled() const { return pSendEndPoint_ != NULL; }
+
+private:
+	virtual int handleInputNotification(int fd);
+
+	bool mapSegment(int fd, bool init);
+	bool openNotifyPipes();
+
+private:
+	std::string name_;
+	bool isCreator_;
+	bool unlinked_;
+
+	uint32 ringSize_;
+	void* pSegment_;
+	size_t segmentSize_;
+
+	Ring* pTxRing_;
+	Ring* pRxRing_;
+	uint8* pTxData_;
+	uint8* pRxData_;
+
+	int txNotifyFd_;
+	int rxNotifyFd_;
+
+	// 发送环有空间的通知(读本端)，接收环腾出空间的通知(写给对端)
+	int txSpaceFd_;
+	int rxSpaceFd_;
+
+	EventDispatcher* pSendDispatcher_;
+	OutputNotificationHandler* pSendHandler_;
+
+	NetworkInterface* pNetworkInterface_;
+	ShmPacketReceiver* pPacketReceiver_;
+	EndPoint* pSendEndPoint_;
+};
+
+}
+}
+
+#endif // KBE_NETWORK_SHM_TRANSPORT_H
@@ -77,7 +77,6 @@ Reason WebSocketPacketFilter::send(Channel * pChannel, PacketSender& sender, Pac
 		return PacketFilter::send(pChannel, sender, pPacket);
 
 	Bundle* pBundle = pPacket->pBundle();
-	TCPPacket* pRetTCPPacket = TCPPacket::createPoolObject();
 	websocket::WebSocketProtocol::FrameType frameType = websocket::WebSocketProtocol::BINARY_FRAME;
 
 	if (pBundle)
@@ -107,20 +106,7 @@ Reason WebSocketPacketFilter::send(Channel * pChannel, PacketSender& sender, Pac
 		}
 	}
 
-	websocket::WebSocketProtocol::makeFrame(frameType, pPacket, pRetTCPPacket);
-
-	int space = pPacket->length() - pRetTCPPacket->space();
-	if(space > 0)
-	{
-		WARNING_MSG(fmt::format("WebSocketPacketFilter::send: no free space, buffer added:{}, total={}.\n",
-			space, pRetTCPPacket->size()));
-
-		pRetTCPPacket->data_resize(pRetTCPPacket->size() + space);
-	}
-
-	(*pRetTCPPacket).append(pPacket->data() + pPacket->rpos(), pPacket->length());
-	pRetTCPPacket->swap(*(static_cast<KBEngine::MemoryStream*>(pPacket)));
-	TCPPacket::reclaimPoolObject(pRetTCPPacket);
+	websocket::WebSocketProtocol::makeFrame(frameType, pPacket);
 
 	pPacket->encrypted(true);
 	return PacketFilter::send(pChannel, sender, pPacket);
@@ -129,6 +115,10 @@ Reason WebSocketPacketFilter::send(Channel * pChannel, PacketSender& sender, Pac
 //-------------------------------------------------------------------------------------
 Reason WebSocketPacketFilter::recv(Channel * pChannel, PacketReceiver & receiver, Packet * pPacket)
 {
+	// 帧数据原地解码并向前压缩， 去掉帧头后整个包直接交给上层， 不再拷贝到新包
+	size_t startPos = pPacket->rpos();
+	size_t datasPos = startPos;
+
 	while(pPacket->length() > 0)
 	{
 		if(fragmentDatasFlag_ == FRAGMENT_MESSAGE_HREAD)
@@ -269,49 +259,37 @@ Reason WebSocketPacketFilter::recv(Channel * pChannel, PacketReceiver & receiver
 				return REASON_WEBSOCKET_ERROR;
 			}
 
-			if(pTCPPacket_ == NULL)
-				pTCPPacket_ = TCPPacket::createPoolObject();
+			size_t size = KBE_MIN((size_t)pFragmentDatasRemain_, pPacket->length());
+			uint8* pDatas = pPacket->data() + pPacket->rpos();
 
-			if(pFragmentDatasRemain_ <= (int32)pPacket->length())
+			// 一帧的数据可能跨越多个包， 掩码需要从该帧已收到的长度处继续
+			if(msg_masked_)
 			{
-				pTCPPacket_->append(pPacket->data() + pPacket->rpos(), pFragmentDatasRemain_);
-				pPacket->read_skip((size_t)pFragmentDatasRemain_);
-				pFragmentDatasRemain_ = 0;
-			}
-			else
-			{
-				pTCPPacket_->append(*(static_cast<MemoryStream*>(pPacket)));
-				pFragmentDatasRemain_ -= pPacket->length();
-				pPacket->done();
+				websocket::WebSocketProtocol::unmask(pDatas, size, msg_mask_, 
+					(size_t)(msg_payload_length_ - pFragmentDatasRemain_));
 			}
 
-			if(!websocket::WebSocketProtocol::decodingDatas(pTCPPacket_, msg_masked_, msg_mask_))
-			{
-				ERROR_MSG(fmt::format("WebSocketPacketReader::recv: decoding-frame is error! addr={}!\n",
-					pChannel_->c_str()));
+			if(datasPos != pPacket->rpos())
+				memmove(pPacket->data() + datasPos, pDatas, size);
 
-				this->pChannel_->condemn();
-				reset();
-
-				TCPPacket::reclaimPoolObject(static_cast<TCPPacket*>(pPacket));
-				return REASON_WEBSOCKET_ERROR;
-			}
-
-			Reason reason = PacketFilter::recv(pChannel, receiver, pTCPPacket_);
-
-			// pTCPPacket_不需要在这里回收了
-			pTCPPacket_ = NULL;
+			datasPos += size;
+			pPacket->read_skip(size);
+			pFragmentDatasRemain_ -= (int32)size;
 
 			if(pFragmentDatasRemain_ == 0)
 				reset();
-
-			if(reason != REASON_SUCCESS)
-				return reason;
 		}
 	}
 
-	TCPPacket::reclaimPoolObject(static_cast<TCPPacket*>(pPacket));
-	return REASON_SUCCESS;
+	if(datasPos == startPos)
+	{
+		TCPPacket::reclaimPoolObject(static_cast<TCPPacket*>(pPacket));
+		return REASON_SUCCESS;
+	}
+
+	pPacket->rpos(startPos);
+	pPacket->wpos(datasPos);
+	return PacketFilter::recv(pChannel, receiver, pPacket);
 }
 
 //-------------------------------------------------------------------------------------
@@ -230,6 +230,56 @@ int WebSocketProtocol::makeFrame(WebSocketProtocol::FrameType frame_type,
 	return pOutPacket->length();
 }
 
+//-------------------------------------------------------------------------------------
+size_t WebSocketProtocol::frameHeadSize(uint64 payloadSize)
+{
+	if(payloadSize <= 125)
+		return 2;
+	else if(payloadSize <= 65535)
+		return 4;
+
+	return 10;
+}
+
+//-------------------------------------------------------------------------------------
+int WebSocketProtocol::makeFrame(WebSocketProtocol::FrameType frame_type, Packet * pPacket)
+{
+	uint64 size = pPacket->length();
+	size_t headSize = frameHeadSize(size);
+	size_t rpos = pPacket->rpos();
+	size_t wpos = pPacket->wpos();
+
+	// 发送器总是从包的起始处发送，所以帧头只能插在数据前面，将数据整体后移
+	if(pPacket->space() < headSize)
+		pPacket->data_resize(wpos + headSize);
+
+	uint8* pHead = pPacket->data() + rpos;
+	memmove(pHead + headSize, pHead, (size_t)size);
+
+	pHead[0] = (uint8)frame_type;
+
+	if(headSize == 2)
+	{
+		pHead[1] = (uint8)size;
+	}
+	else if(headSize == 4)
+	{
+		pHead[1] = 126;
+		pHead[2] = (uint8)((size >> 8) & 0xff);
+		pHead[3] = (uint8)(size & 0xff);
+	}
+	else
+	{
+		pHead[1] = 127;
+
+		for(int i = 0; i < 8; ++i)
+			pHead[2 + i] = (uint8)((size >> ((7 - i) * 8)) & 0xff);
+	}
+
+	pPacket->wpos(wpos + headSize);
+	return (int)pPacket->length();
+}
+
 //-------------------------------------------------------------------------------------
 int WebSocketProtocol::getFrame(Packet * pPacket, uint8& msg_opcode, uint8& msg_fin, uint8& msg_masked, uint32& msg_mask, 
 		int32& msg_length_field, uint64& msg_payload_length, FrameType& frameType)
@@ -368,14 +418,34 @@ bool WebSocketProtocol::decodingDatas(Packet* pPacket, uint8 msg_masked, uint32
 {
 	// 解码内容
 	if(msg_masked) 
+		unmask(pPacket->data() + pPacket->rpos(), pPacket->length(), msg_mask, 0);
+
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+void WebSocketProtocol::unmask(uint8* pDatas, size_t size, uint32 msg_mask, size_t offset)
+{
+	// 按偏移旋转掩码， 使得pDatas[0]对应掩码的第(offset % 4)个字节
+	uint8 mask[8];
+	for(int i = 0; i < 8; ++i)
+		mask[i] = ((uint8*)(&msg_mask))[(offset + i) % 4];
+
+	uint64 mask64;
+	memcpy(&mask64, mask, sizeof(mask64));
+
+	// 每次处理8字节， 剩余部分逐字节处理
+	size_t i = 0;
+	for(; i + 8 <= size; i += 8)
 	{
-		uint8* c = pPacket->data() + pPacket->rpos();
-		for(int i=0; i<(int)pPacket->length(); i++) {
-			c[i] = c[i] ^ ((uint8*)(&msg_mask))[i % 4];
-		}
+		uint64 v;
+		memcpy(&v, pDatas + i, sizeof(v));
+		v ^= mask64;
+		memcpy(pDatas + i, &v, sizeof(v));
 	}
 
-	return true;
+	for(; i < size; ++i)
+		pDatas[i] ^= mask[i % 4];
 }
 
 //-------------------------------------------------------------------------------------
@@ -83,10 +83,22 @@ public:
 		帧解析相关
 	*/
 	static int makeFrame(FrameType frame_type, Packet* pInPacket, Packet* pOutPacket);
+
+	/**
+		在包内原地插入帧头， 不再申请新的包
+	*/
+	static int makeFrame(FrameType frame_type, Packet* pPacket);
+	static size_t frameHeadSize(uint64 payloadSize);
+
 	static int getFrame(Packet* pPacket, uint8& msg_opcode, uint8& msg_fin, uint8& msg_masked, uint32& msg_mask, 
 		int32& msg_length_field, uint64& msg_payload_length, FrameType& frameType);
 
 	static bool decodingDatas(Packet* pPacket, uint8 msg_masked, uint32 msg_mask);
+
+	/**
+		原地解码， offset为这段数据在整个帧中的偏移， 用于帧被拆分到多个包的情况
+	*/
+	static void unmask(uint8* pDatas, size_t size, uint32 msg_mask, size_t offset);
 };
 
 }
@@ -277,7 +277,11 @@ int Sequence::seq_ass_item(PyObject* self, Py_ssize_t index, PyObject* value)
 		// 检查类别是否正确
 		if(seq->isSameItemType(value))
 		{
-			values[index] = seq->createNewItemFromObj(value);
+			PyObject* pyNewItem = seq->createNewItemFromObj(value);
+			seq->onValuesRemoving(index, index + 1);
+			Py_DECREF(values[index]);
+			values[index] = pyNewItem;
+			seq->onValuesChanged(index, index + 1, 1);
 		}
 		else
 		{
@@ -288,8 +292,10 @@ int Sequence::seq_ass_item(PyObject* self, Py_ssize_t index, PyObject* value)
 	}
 	else
 	{
+		seq->onValuesRemoving(index, index + 1);
 		Py_DECREF((*(values.begin() + index)));
 		values.erase(values.begin() + index);
+		seq->onValuesChanged(index, index + 1, 0);
 	}
 
 	return 0;
@@ -313,12 +319,15 @@ int Sequence::seq_ass_slice(PyObject* self, Py_ssize_t index1, Py_ssize_t index2
 	{
 		if (index1 < index2)
 		{
+			seq->onValuesRemoving(index1, index2);
+
 			for (Py_ssize_t istart = index1; istart < index2; ++istart)
 			{
 				Py_DECREF(values[istart]);
 			}
 
 			values.erase(values.begin() + index1, values.begin() + index2);
+			seq->onValuesChanged(index1, index2, 0);
 		}
 
 		return 0;
@@ -363,8 +372,13 @@ int Sequence::seq_ass_slice(PyObject* self, Py_ssize_t index1, Py_ssize_t index2
 		}
 	}
 
+	if (index2 < index1)
+		index2 = index1;
+
 	if (index1 < index2)
 	{
+		seq->onValuesRemoving(index1, index2);
+
 		for (Py_ssize_t istart = index1; istart < index2; ++istart)
 		{
 			Py_DECREF(values[istart]);
@@ -390,6 +404,7 @@ int Sequence::seq_ass_slice(PyObject* self, Py_ssize_t index1, Py_ssize_t index2
 			Py_DECREF(pyTemp);
 	}
 
+	seq->onValuesChanged(index1, index2, osz);
 	return 0;
 }
 
@@ -445,13 +460,20 @@ PyObject* Sequence::seq_inplace_concat(PyObject* self, PyObject* oterSeq)
 		PyObject* pyTemp = PySequence_GetItem(oterSeq, i);
 		if(pyTemp == NULL)
 		{
-			PyErr_Format(PyExc_TypeError, "Sequence::seq_inplace_concat::PySequence_GetItem %d is NULL.", i);
-			PyErr_PrintEx(0);
+			// 撤销已追加的元素， 错误留给调用者处理
+			for(int j = 0; j < i; ++j)
+				Py_DECREF(values[szA + j]);
+
+			values.erase(values.begin() + szA, values.end());
+			return NULL;
 		}
 
-		values[szA + i] = pyTemp;
+		values[szA + i] = seq->createNewItemFromObj(pyTemp);
+		Py_DECREF(pyTemp);
 	}
 
+	seq->onValuesChanged(szA, szA, szB);
+	Py_INCREF(seq);
 	return seq;
 }
 
@@ -470,6 +492,8 @@ PyObject* Sequence::seq_inplace_repeat(PyObject* self, Py_ssize_t n)
 
 	if (n <= 0)
 	{
+		seq->onValuesRemoving(0, sz);
+
 		for(size_t j = 0; j < values.size(); ++j)
 		{
 			Py_DECREF(values[j]);
@@ -491,6 +515,8 @@ PyObject* Sequence::seq_inplace_repeat(PyObject* self, Py_ssize_t n)
 		}
 	}
 
+	seq->onValuesChanged(0, sz, (Py_ssize_t)values.size());
+	Py_INCREF(seq);
 	return seq;
 }
 
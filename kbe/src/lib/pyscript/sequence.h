@@ -59,6 +59,16 @@ public:
 	virtual bool isSameItemType(PyObject* pyValue);
 	virtual PyObject* createNewItemFromObj(PyObject* pyItem);
 
+	/** 
+		[index1, index2)区间的元素即将被移除或覆盖
+	*/
+	virtual void onValuesRemoving(Py_ssize_t index1, Py_ssize_t index2) {}
+
+	/** 
+		[index1, index2)区间的元素已被替换为从index1开始的count个新元素
+	*/
+	virtual void onValuesChanged(Py_ssize_t index1, Py_ssize_t index2, Py_ssize_t count) {}
+
 protected:
 	std::vector<PyObject*>				values_;
 } ;
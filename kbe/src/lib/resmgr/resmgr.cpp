@@ -39,12 +39,36 @@ uint64 Resmgr::respool_timeout = 0;
 uint32 Resmgr::respool_buffersize = 0;
 uint32 Resmgr::respool_checktick = 0;
 
+// 索引条目过多说明资源路径配置得太宽(例如指向了根目录)， 此时放弃索引
+#define RES_INDEX_MAX_SIZE 500000
+#define RES_INDEX_MAX_DEPTH 32
+
+//-------------------------------------------------------------------------------------
+static std::string resIndexKey(const char* res)
+{
+	std::string key = res;
+	strutil::kbe_replace(key, "\\", "/");
+	strutil::kbe_replace(key, "//", "/");
+
+	size_t start = key.find_first_not_of('/');
+	if(start == std::string::npos)
+		return "";
+
+	size_t end = key.find_last_not_of('/');
+	return key.substr(start, end - start + 1);
+}
+
 //-------------------------------------------------------------------------------------
 Resmgr::Resmgr():
 kb_env_(),
 respaths_(),
 isInit_(false),
 respool_(),
+resIndex_(),
+resIndexHits_(0),
+resIndexMisses_(0),
+respoolHits_(0),
+respoolMisses_(0),
 mutex_()
 {
 }
@@ -61,6 +85,11 @@ bool Resmgr::initializeWatcher()
 	WATCH_OBJECT("syspaths/KBE_ROOT", kb_env_.root_path);
 	WATCH_OBJECT("syspaths/KBE_RES_PATH", kb_env_.res_path);
 	WATCH_OBJECT("syspaths/KBE_BIN_PATH", kb_env_.bin_path);
+	WATCH_OBJECT("resmgr/indexSize", this, &Resmgr::resIndexSize);
+	WATCH_OBJECT("resmgr/indexHits", resIndexHits_);
+	WATCH_OBJECT("resmgr/indexMisses", resIndexMisses_);
+	WATCH_OBJECT("resmgr/respoolHits", respoolHits_);
+	WATCH_OBJECT("resmgr/respoolMisses", respoolMisses_);
 	return true;
 }
 
@@ -154,6 +183,8 @@ bool Resmgr::initialize()
 	//if(isInit())
 	//	return true;
 
+	std::vector<std::string> oldRespaths = respaths_;
+
 	// 获取引擎环境配置
 	kb_env_.root_path		= getenv("KBE_ROOT") == NULL ? "" : getenv("KBE_ROOT");
 	kb_env_.res_path		= getenv("KBE_RES_PATH") == NULL ? "" : getenv("KBE_RES_PATH"); 
@@ -180,6 +211,119 @@ bool Resmgr::initialize()
 	isInit_ = true;
 
 	respool_.clear();
+
+	// 进程启动时可能被多次初始化， 路径没有变化就不必重新遍历
+	if(resIndex_.size() == 0 || oldRespaths != respaths_)
+		buildResIndex();
+
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+void Resmgr::buildResIndex()
+{
+	resIndex_.clear();
+
+	// windows下文件名不区分大小写， 索引无法精确匹配， 仍然直接访问磁盘
+#if KBE_PLATFORM != PLATFORM_WIN32
+	for(size_t i = 0; i < respaths_.size() && i < 256; ++i)
+	{
+		if(respaths_[i].size() == 0)
+			continue;
+
+		if(!indexResPath((uint8)i, respaths_[i], "", 0))
+		{
+			resIndex_.clear();
+			break;
+		}
+	}
+#endif
+}
+
+//-------------------------------------------------------------------------------------
+bool Resmgr::indexResPath(uint8 respathIdx, const std::string& path, const std::string& key, int depth)
+{
+#if KBE_PLATFORM != PLATFORM_WIN32
+	if(depth > RES_INDEX_MAX_DEPTH)
+		return true;
+
+	DIR* dir = opendir(path.c_str());
+	if(dir == NULL)
+		return true;
+
+	struct dirent* entry;
+	while((entry = readdir(dir)) != NULL)
+	{
+		// 跳过.和..以及.svn、.git等隐藏目录， 这些资源找不到时会回退到磁盘查找
+		if(entry->d_name[0] == '.')
+			continue;
+
+		std::string entryKey = key + entry->d_name;
+		std::string entryPath = path + entry->d_name;
+
+		bool isDir = false;
+
+#ifdef _DIRENT_HAVE_D_TYPE
+		if(entry->d_type == DT_DIR)
+		{
+			isDir = true;
+		}
+		else if(entry->d_type == DT_UNKNOWN)
+#endif
+		{
+			struct stat s;
+			if(lstat(entryPath.c_str(), &s) == 0)
+				isDir = S_ISDIR(s.st_mode);
+		}
+
+		// 先出现的资源路径优先， 与逐个路径查找的顺序一致
+		resIndex_.insert(std::make_pair(entryKey, respathIdx));
+
+		if(resIndex_.size() > RES_INDEX_MAX_SIZE)
+		{
+			closedir(dir);
+			return false;
+		}
+
+		// 不进入符号链接的目录， 避免循环
+		if(isDir && !indexResPath(respathIdx, entryPath + "/", entryKey + "/", depth + 1))
+		{
+			closedir(dir);
+			return false;
+		}
+	}
+
+	closedir(dir);
+#endif
+
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+bool Resmgr::findResIndex(const char* res, std::string& fpath)
+{
+	if(resIndex_.size() == 0)
+		return false;
+
+	KBEUnordered_map< std::string, uint8 >::iterator iter = resIndex_.find(resIndexKey(res));
+	if(iter == resIndex_.end())
+	{
+		++resIndexMisses_;
+		return false;
+	}
+
+	fpath = respaths_[iter->second] + res;
+	strutil::kbe_replace(fpath, "\\", "/");
+	strutil::kbe_replace(fpath, "//", "/");
+
+	// 索引是启动时的快照， 文件可能已被删除或移动， 确认一次， 失败时由调用者逐个路径查找
+	if(access(fpath.c_str(), 0) != 0)
+	{
+		++resIndexMisses_;
+		return false;
+	}
+
+	++resIndexHits_;
 	return true;
 }
 
@@ -189,6 +333,7 @@ void Resmgr::print(void)
 	INFO_MSG(fmt::format("Resmgr::initialize: KBE_ROOT={0}\n", kb_env_.root_path));
 	INFO_MSG(fmt::format("Resmgr::initialize: KBE_RES_PATH={0}\n", kb_env_.res_path));
 	INFO_MSG(fmt::format("Resmgr::initialize: KBE_BIN_PATH={0}\n", kb_env_.bin_path));
+	INFO_MSG(fmt::format("Resmgr::initialize: indexed {} resources\n", resIndex_.size()));
 
 #if KBE_PLATFORM == PLATFORM_WIN32
 	printf("%s", fmt::format("KBE_ROOT = {0}\n", kb_env_.root_path).c_str());
@@ -207,6 +352,10 @@ std::string Resmgr::matchRes(const std::string& res)
 //-------------------------------------------------------------------------------------
 std::string Resmgr::matchRes(const char* res)
 {
+	std::string fpath;
+	if(findResIndex(res, fpath))
+		return fpath;
+
 	std::vector<std::string>::iterator iter = respaths_.begin();
 
 	for(; iter != respaths_.end(); ++iter)
@@ -228,6 +377,10 @@ std::string Resmgr::matchRes(const char* res)
 //-------------------------------------------------------------------------------------
 bool Resmgr::hasRes(const std::string& res)
 {
+	std::string fpath;
+	if(findResIndex(res.c_str(), fpath))
+		return true;
+
 	std::vector<std::string>::iterator iter = respaths_.begin();
 
 	for(; iter != respaths_.end(); ++iter)
@@ -249,6 +402,14 @@ bool Resmgr::hasRes(const std::string& res)
 //-------------------------------------------------------------------------------------
 FILE* Resmgr::openRes(std::string res, const char* mode)
 {
+	std::string indexPath;
+	if(findResIndex(res.c_str(), indexPath))
+	{
+		FILE * f = fopen (indexPath.c_str(), mode);
+		if(f != NULL)
+			return f;
+	}
+
 	std::vector<std::string>::iterator iter = respaths_.begin();
 
 	for(; iter != respaths_.end(); ++iter)
@@ -431,6 +592,10 @@ std::string Resmgr::matchPath(const char* path)
 	strutil::kbe_replace(npath, "\\", "/");
 	strutil::kbe_replace(npath, "//", "/");
 
+	std::string indexPath;
+	if(findResIndex(npath.c_str(), indexPath))
+		return indexPath;
+
 	for(; iter != respaths_.end(); ++iter)
 	{
 		std::string fpath = ((*iter) + npath);
@@ -566,12 +731,14 @@ ResourceObjectPtr Resmgr::openResource(const char* res, const char* model, uint3
 	KBEUnordered_map< std::string, ResourceObjectPtr >::iterator iter = respool_.find(respath);
 	if(iter == respool_.end())
 	{
+		++respoolMisses_;
 		FileObject* fobj = new FileObject(respath.c_str(), flags, model);
 		respool_[respath] = fobj;
 		fobj->update();
 		return fobj;
 	}
 
+	++respoolHits_;
 	iter->second->update();
 	return iter->second;
 }
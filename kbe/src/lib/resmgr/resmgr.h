@@ -127,16 +127,38 @@ public:
 
 	void update();
 
+	uint32 resIndexSize() const { 
+		return (uint32)resIndex_.size(); 
+	}
+
 private:
 
 	virtual void handleTimeout(TimerHandle handle, void * arg);
 
+	/*
+		启动时遍历资源路径建立索引， 查找资源时不必逐个路径访问磁盘。
+		索引是启动时的快照: 命中时仍会access()确认一次， 文件已不存在则回退到逐个路径查找；
+		但之后在更靠前的资源路径中新增的同名文件不会被发现， 仍返回索引中的文件，
+		直到进程重新启动(或资源路径变化后重新initialize())
+	*/
+	void buildResIndex();
+	bool indexResPath(uint8 respathIdx, const std::string& path, const std::string& key, int depth);
+	bool findResIndex(const char* res, std::string& fpath);
+
 	KBEEnv kb_env_;
 	std::vector<std::string> respaths_;
 	bool isInit_;
 
 	KBEUnordered_map< std::string, ResourceObjectPtr > respool_;
 
+	// 相对路径 -> 所在的respaths_下标
+	KBEUnordered_map< std::string, uint8 > resIndex_;
+
+	uint32 resIndexHits_;
+	uint32 resIndexMisses_;
+	uint32 respoolHits_;
+	uint32 respoolMisses_;
+
 	KBEngine::thread::ThreadMutex mutex_;
 };
 
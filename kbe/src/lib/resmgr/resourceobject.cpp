@@ -22,6 +22,13 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "resourceobject.h"
 #include "common/timer.h"
 
+#if KBE_PLATFORM != PLATFORM_WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 namespace KBEngine{	
 
 //-------------------------------------------------------------------------------------
@@ -56,9 +63,17 @@ bool ResourceObject::valid() const
 }
 
 //-------------------------------------------------------------------------------------
-FileObject::FileObject(const char* res, uint32 flags, const char* model):
-ResourceObject(res, flags)
+FileObject::FileObject(const char* res, uint32 flags, const char* model, bool mapped):
+ResourceObject(res, flags),
+fd_(NULL),
+pMappedData_(NULL),
+mappedSize_(0),
+mappedPos_(0)
 {
+	// 调用者要求映射的只读文件不需要经过stdio的缓冲和拷贝
+	if(mapped && (strcmp(model, "r") == 0 || strcmp(model, "rb") == 0) && map(res))
+		return;
+
 	fd_ = fopen(res, model);
 
 	if(fd_ == NULL)
@@ -71,45 +86,107 @@ ResourceObject(res, flags)
 //-------------------------------------------------------------------------------------
 FileObject::~FileObject()
 {
-	fclose(fd_);
+#if KBE_PLATFORM != PLATFORM_WIN32
+	if(pMappedData_)
+		munmap(pMappedData_, mappedSize_);
+#endif
+
+	if(fd_)
+		fclose(fd_);
+}
+
+//-------------------------------------------------------------------------------------
+bool FileObject::map(const char* res)
+{
+#if KBE_PLATFORM != PLATFORM_WIN32
+	int fd = open(res, O_RDONLY);
+	if(fd < 0)
+		return false;
+
+	struct stat s;
+
+	// 空文件无法映射， 交给fopen处理
+	if(fstat(fd, &s) != 0 || !S_ISREG(s.st_mode) || s.st_size <= 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	void* p = mmap(NULL, (size_t)s.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if(p == MAP_FAILED)
+		return false;
+
+	pMappedData_ = (uint8*)p;
+	mappedSize_ = (size_t)s.st_size;
+	mappedPos_ = 0;
+	return true;
+#else
+	return false;
+#endif
 }
 
 //-------------------------------------------------------------------------------------
 bool FileObject::seek(uint32 idx, int flags)
 {
-	if(invalid_ || fd_ == NULL)
+	if(invalid_ || (fd_ == NULL && pMappedData_ == NULL))
 	{
 		ERROR_MSG(fmt::format("FileObject::seek: {} invalid!\n", resName_));
 		return false;
 	}
 
 	update();
+
+	if(pMappedData_)
+	{
+		size_t base = flags == SEEK_CUR ? mappedPos_ : (flags == SEEK_END ? mappedSize_ : 0);
+		if(base + idx > mappedSize_)
+			return false;
+
+		mappedPos_ = base + idx;
+		return true;
+	}
+
 	return fseek(fd_, idx, flags) != -1;
 }
 
 //-------------------------------------------------------------------------------------
 uint32 FileObject::read(char* buf, uint32 limit)
 {
-	if(invalid_ || fd_ == NULL)
+	if(invalid_ || (fd_ == NULL && pMappedData_ == NULL))
 	{
 		ERROR_MSG(fmt::format("FileObject::read: {} invalid!\n", resName_));
 		return 0;
 	}
 
 	update();
+
+	if(pMappedData_)
+	{
+		uint32 size = (uint32)std::min<size_t>(limit, mappedSize_ - mappedPos_);
+		memcpy(buf, pMappedData_ + mappedPos_, size);
+		mappedPos_ += size;
+		return size;
+	}
+
 	return fread(buf, sizeof(char), limit, fd_);
 }
 
 //-------------------------------------------------------------------------------------
 uint32 FileObject::tell()
 {
-	if(invalid_ || fd_ == NULL)
+	if(invalid_ || (fd_ == NULL && pMappedData_ == NULL))
 	{
 		ERROR_MSG(fmt::format("FileObject::tell: {} invalid!\n", resName_));
 		return 0;
 	}
 
 	update();
+
+	if(pMappedData_)
+		return (uint32)mappedPos_;
+
 	return ftell(fd_);
 }
 
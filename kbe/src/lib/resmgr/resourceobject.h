@@ -51,17 +51,34 @@ protected:
 class FileObject : public ResourceObject
 {
 public:
-	FileObject(const char* res, uint32 flags, const char* model);
+	/*
+		mapped为true时只读打开的文件被映射到内存， 只用于打开后立即读完的加载者(私有对象)，
+		放入资源池的对象必须使用stdio， 否则文件被截断或替换后访问映射会导致SIGBUS
+	*/
+	FileObject(const char* res, uint32 flags, const char* model, bool mapped = false);
 	virtual ~FileObject();
 	
 	FILE* fd(){ return fd_; }
 
+	/*
+		映射打开的文件可以直接访问其内容， 映射的生命期与对象相同
+	*/
+	bool isMapped() const{ return pMappedData_ != NULL; }
+	const uint8* data() const{ return pMappedData_; }
+	size_t size() const{ return mappedSize_; }
+
 	bool seek(uint32 idx, int flags = SEEK_SET);
 	uint32 read(char* buf, uint32 limit);
 	uint32 tell();
 
 protected:
+	bool map(const char* res);
+
 	FILE* fd_;
+
+	uint8* pMappedData_;
+	size_t mappedSize_;
+	size_t mappedPos_;
 };
 
 typedef SmartPointer<ResourceObject> ResourceObjectPtr;
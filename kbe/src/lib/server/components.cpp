@@ -29,6 +29,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "network/tcp_packet.h"
 #include "network/bundle_broadcast.h"
 #include "network/network_interface.h"
+#include "network/shm_transport.h"
 #include "client_lib/client_interface.h"
 #include "server/serverconfig.h"
 
@@ -509,6 +510,7 @@ int Components::connectComponent(COMPONENT_TYPE componentType, int32 uid, COMPON
 			}
 
 			pComponentInfos->pChannel->send(pBundle);
+			offerShmChannel(pComponentInfos);
 		}
 	}
 	else
@@ -689,6 +691,158 @@ Components::ComponentInfos* Components::findLocalComponent(uint32 pid)
 	return NULL;
 }
 
+//-------------------------------------------------------------------------------------
+static bool isShmChannelComponent(COMPONENT_TYPE componentType)
+{
+	return componentType == BASEAPP_TYPE || componentType == CELLAPP_TYPE || componentType == DBMGR_TYPE;
+}
+
+//-------------------------------------------------------------------------------------
+static void newShmChannelMessage(Network::Bundle& bundle, COMPONENT_TYPE componentType, bool offer)
+{
+	switch(componentType)
+	{
+	case BASEAPP_TYPE:
+		if(offer)
+			bundle.newMessage(BaseappInterface::onShmChannelOffer);
+		else
+			bundle.newMessage(BaseappInterface::onShmChannelReady);
+		break;
+	case CELLAPP_TYPE:
+		if(offer)
+			bundle.newMessage(CellappInterface::onShmChannelOffer);
+		else
+			bundle.newMessage(CellappInterface::onShmChannelReady);
+		break;
+	case DBMGR_TYPE:
+		if(offer)
+			bundle.newMessage(DbmgrInterface::onShmChannelOffer);
+		else
+			bundle.newMessage(DbmgrInterface::onShmChannelReady);
+		break;
+	default:
+		KBE_ASSERT(false && "invalid componentType.\n");
+		break;
+	};
+}
+
+//-------------------------------------------------------------------------------------
+void Components::offerShmChannel(Components::ComponentInfos* info)
+{
+	if(!Network::g_shmTransportEnable || info->pChannel == NULL || info->pChannel->pShmTransport())
+		return;
+
+	if(!isShmChannelComponent(componentType_) || !isShmChannelComponent(info->componentType) || 
+		!isLocalComponent(info))
+		return;
+
+	Network::ShmTransport* pShmTransport = new Network::ShmTransport();
+	if(!pShmTransport->create(Network::g_shmTransportRingSize))
+	{
+		delete pShmTransport;
+		return;
+	}
+
+	// 通道负责释放，在收到对端的onShmChannelReady之前两个方向都仍然使用TCP
+	info->pChannel->pShmTransport(pShmTransport);
+
+	Network::Bundle* pBundle = Network::Bundle::createPoolObject();
+	newShmChannelMessage(*pBundle, info->componentType, true);
+	(*pBundle) << pShmTransport->name();
+	info->pChannel->send(pBundle);
+}
+
+//-------------------------------------------------------------------------------------
+void Components::onShmChannelOffer(Network::Channel* pChannel, const std::string& name)
+{
+	Components::ComponentInfos* cinfo = findComponent(pChannel);
+	if(cinfo == NULL || !isShmChannelComponent(cinfo->componentType))
+	{
+		ERROR_MSG(fmt::format("Components::onShmChannelOffer: not found component({})!\n", 
+			pChannel->c_str()));
+
+		return;
+	}
+
+	uint8 success = 0;
+	Network::ShmTransport* pShmTransport = NULL;
+
+	if(Network::g_shmTransportEnable && pChannel->pShmTransport() == NULL)
+	{
+		pShmTransport = new Network::ShmTransport();
+		if(pShmTransport->open(name))
+			success = 1;
+		else
+			SAFE_RELEASE(pShmTransport);
+	}
+
+	Network::Bundle* pBundle = Network::Bundle::createPoolObject();
+	newShmChannelMessage(*pBundle, cinfo->componentType, false);
+	(*pBundle) << success;
+	pChannel->send(pBundle);
+
+	if(!success)
+		return;
+
+	pChannel->pShmTransport(pShmTransport);
+
+	// onShmChannelReady是本端经由TCP的最后一条消息，对端处理它之后才开始读环。
+	// 如果TCP发送队列没有清空则继续使用TCP发送，对端同时读TCP与环，不会乱序
+	if(!pChannel->sending())
+		pShmTransport->enableSend(*pChannel->pEndPoint());
+
+	INFO_MSG(fmt::format("Components::onShmChannelOffer: {} uses shared memory {}, send={}.\n", 
+		pChannel->c_str(), name, pShmTransport->sendEnabled()));
+}
+
+//-------------------------------------------------------------------------------------
+void Components::onShmChannelReady(Network::Channel* pChannel, uint8 success)
+{
+	Network::ShmTransport* pShmTransport = pChannel->pShmTransport();
+	if(pShmTransport == NULL || pShmTransport->recvEnabled())
+		return;
+
+	if(pShmTransport->isCreator())
+	{
+		// 对端已经映射完毕或者放弃，名字不再需要
+		pShmTransport->unlink();
+
+		if(!success)
+		{
+			pChannel->pShmTransport(NULL);
+			return;
+		}
+	}
+
+	// 对端经由TCP的最后一条消息已经处理，此后它的数据都在环中
+	if(!pShmTransport->enableRecv(*_pNetworkInterface, *pChannel->pEndPoint()))
+	{
+		ERROR_MSG(fmt::format("Components::onShmChannelReady: {} enableRecv failed!\n", 
+			pChannel->c_str()));
+
+		pChannel->condemn();
+		return;
+	}
+
+	if(!pShmTransport->isCreator())
+		return;
+
+	Components::ComponentInfos* cinfo = findComponent(pChannel);
+	if(cinfo == NULL)
+		return;
+
+	Network::Bundle* pBundle = Network::Bundle::createPoolObject();
+	newShmChannelMessage(*pBundle, cinfo->componentType, false);
+	(*pBundle) << success;
+	pChannel->send(pBundle);
+
+	if(!pChannel->sending())
+		pShmTransport->enableSend(*pChannel->pEndPoint());
+
+	INFO_MSG(fmt::format("Components::onShmChannelReady: {} uses shared memory {}, send={}.\n", 
+		pChannel->c_str(), pShmTransport->name(), pShmTransport->sendEnabled()));
+}
+
 //-------------------------------------------------------------------------------------		
 bool Components::isLocalComponent(const Components::ComponentInfos* info)
 {
@@ -149,6 +149,13 @@ public:
 
 	int connectComponent(COMPONENT_TYPE componentType, int32 uid, COMPONENT_ID componentID, bool printlog = true);
 
+	/** 
+		同机的baseapp、cellapp、dbmgr之间协商共享内存通道.
+	*/
+	void offerShmChannel(Components::ComponentInfos* info);
+	void onShmChannelOffer(Network::Channel* pChannel, const std::string& name);
+	void onShmChannelReady(Network::Channel* pChannel, uint8 success);
+
 	typedef std::map<int32/*uid*/, COMPONENT_ORDER/*lastorder*/> ORDER_LOG;
 	ORDER_LOG& getGlobalOrderLog(){ return _globalOrderLog; }
 	ORDER_LOG& getBaseappGroupOrderLog(){ return _baseappGrouplOrderLog; }
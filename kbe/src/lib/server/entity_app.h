@@ -744,6 +744,10 @@ void EntityApp<E>::handleTimeout(TimerHandle handle, void * arg)
 	switch (reinterpret_cast<uintptr>(arg))
 	{
 		case TIMEOUT_GAME_TICK:
+			// 以即将开始的tick号作为新的一帧
+			if (TickTimeline::isRecording())
+				TickTimeline::getSingleton().onTick(g_kbetime + 1);
+
 			this->handleGameTick();
 			break;
 		default:
@@ -1453,7 +1457,7 @@ void EntityApp<E>::updateLoad()
 		{
 			CRITICAL_MSG(fmt::format("EntityApp::handleGameTick: "
 						"Invalid timing result {:.3f}.\n"
-						"Please change the environment variable KBE_TIMING_METHOD to [rdtsc|gettimeofday|gettime](curr = {1})!",
+						"Please change the environment variable KBE_TIMING_METHOD to [rdtsc|gettimeofday|gettime|coarse](curr = {})!",
 						spareTime, getTimingMethodName()));
 		}
 		else
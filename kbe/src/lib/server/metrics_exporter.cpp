@@ -0,0 +1,586 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "metrics_exporter.h"
+#include "network/common.h"
+#include "network/endpoint.h"
+#include "network/message_handler.h"
+#include "network/network_stats.h"
+#include "helper/metrics.h"
+#include "helper/profile.h"
+#include "helper/watcher.h"
+#include "common/memorystream.h"
+
+namespace KBEngine { 
+
+// 请求头的最大长度， 超过则认为是非法请求
+static const size_t METRICS_MAX_REQUEST_SIZE = 8192;
+
+//-------------------------------------------------------------------------------------
+static bool isWouldBlock()
+{
+#ifdef unix
+	return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#else
+	int err = WSAGetLastError();
+	return err == WSAEWOULDBLOCK || err == WSAEINTR;
+#endif
+}
+
+//-------------------------------------------------------------------------------------
+MetricsConnection::MetricsConnection(Network::EndPoint* pEndPoint, MetricsExporter* pMetricsExporter):
+pEndPoint_(pEndPoint),
+pMetricsExporter_(pMetricsExporter),
+request_(),
+response_(),
+sentSize_(0),
+sending_(false),
+writeRegistered_(false)
+{
+}
+
+//-------------------------------------------------------------------------------------
+MetricsConnection::~MetricsConnection(void)
+{
+	if(pEndPoint_)
+	{
+		pEndPoint_->close();
+		Network::EndPoint::reclaimPoolObject(pEndPoint_);
+		pEndPoint_ = NULL;
+	}
+}
+
+//-------------------------------------------------------------------------------------
+int	MetricsConnection::handleInputNotification(int fd)
+{
+	KBE_ASSERT((*pEndPoint_) == fd);
+
+	char data[1024];
+	int recvsize = pEndPoint_->recv(data, sizeof(data));
+
+	if(recvsize == -1)
+	{
+		if (!isWouldBlock())
+			pMetricsExporter_->closeConnection(fd, this);
+
+		return 0;
+	}
+	else if(recvsize == 0)
+	{
+		pMetricsExporter_->closeConnection(fd, this);
+		return 0;
+	}
+
+	// 已经在输出结果了， 忽略之后的数据
+	if(sending_)
+		return 0;
+
+	request_.append(data, recvsize);
+
+	if(request_.find("\r\n\r\n") != std::string::npos || request_.find("\n\n") != std::string::npos)
+	{
+		onRequest();
+		return 0;
+	}
+
+	if(request_.size() > METRICS_MAX_REQUEST_SIZE)
+	{
+		WARNING_MSG(fmt::format("MetricsConnection::handleInputNotification: request is too large({}), addr={}\n",
+			request_.size(), pEndPoint_->c_str()));
+
+		pMetricsExporter_->closeConnection(fd, this);
+	}
+
+	return 0;
+}
+
+//-------------------------------------------------------------------------------------
+void MetricsConnection::onRequest()
+{
+	// 只关心请求行: GET /metrics HTTP/1.1
+	std::string::size_type lineEnd = request_.find_first_of("\r\n");
+	std::string requestLine = request_.substr(0, lineEnd);
+
+	std::vector<std::string> vec;
+	strutil::kbe_split<char>(requestLine, ' ', vec);
+
+	std::string status = "200 OK";
+	std::string contentType = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+	std::string body;
+
+	if(vec.size() < 2 || (vec[0] != "GET" && vec[0] != "HEAD"))
+	{
+		status = "405 Method Not Allowed";
+		contentType = "text/plain; charset=utf-8";
+		body = "only GET is supported\n";
+	}
+	else if(vec[1] != "/metrics" && vec[1] != "/" && vec[1].find("/metrics?") != 0)
+	{
+		status = "404 Not Found";
+		contentType = "text/plain; charset=utf-8";
+		body = "try /metrics\n";
+	}
+	else
+	{
+		pMetricsExporter_->render(body);
+	}
+
+	response_ = fmt::format("HTTP/1.1 {}\r\nContent-Type: {}\r\nContent-Length: {}\r\nConnection: close\r\n\r\n",
+		status, contentType, body.size());
+
+	if(vec.size() < 1 || vec[0] != "HEAD")
+		response_ += body;
+
+	sentSize_ = 0;
+	sending_ = true;
+
+	int fd = (*pEndPoint_);
+
+	if(!flush())
+	{
+		pMetricsExporter_->closeConnection(fd, this);
+		return;
+	}
+
+	// 发送缓冲区满了， 等待可写时继续发送
+	if(!pMetricsExporter_->pDispatcher()->registerWriteFileDescriptor(fd, this))
+	{
+		ERROR_MSG(fmt::format("MetricsConnection::onRequest: registerWriteFileDescriptor is failed! addr={}\n",
+			pEndPoint_->c_str()));
+
+		pMetricsExporter_->closeConnection(fd, this);
+		return;
+	}
+
+	writeRegistered_ = true;
+}
+
+//-------------------------------------------------------------------------------------
+bool MetricsConnection::flush()
+{
+	while(sentSize_ < response_.size())
+	{
+		int len = pEndPoint_->send(response_.data() + sentSize_, (int)(response_.size() - sentSize_));
+		if(len <= 0)
+			return len < 0 && isWouldBlock();
+
+		sentSize_ += len;
+	}
+
+	return false;
+}
+
+//-------------------------------------------------------------------------------------
+int MetricsConnection::handleOutputNotification(int fd)
+{
+	if(!flush())
+		pMetricsExporter_->closeConnection(fd, this);
+
+	return 0;
+}
+
+//-------------------------------------------------------------------------------------
+MetricsExporter::MetricsExporter(Network::EventDispatcher* pDispatcher):
+connections_(),
+listener_(),
+pDispatcher_(pDispatcher),
+port_(0)
+{
+}
+
+//-------------------------------------------------------------------------------------
+MetricsExporter::~MetricsExporter(void)
+{
+}
+
+//-------------------------------------------------------------------------------------
+bool MetricsExporter::start(u_int16_t port, u_int32_t ip)
+{
+	listener_.socket(SOCK_STREAM);
+	listener_.setnonblocking(true);
+
+	// 端口被占用则向后尝试， 同一台机器上的多个组件因此可以共用一个配置
+	int tryn = 0;
+	while(tryn++ < 1024)
+	{
+		if (listener_.bind(htons(port), ip) == 0)
+			break;
+
+		++port;
+	}
+
+	if(tryn > 1024)
+	{
+		ERROR_MSG(fmt::format("MetricsExporter::start: bind port({}) is failed! ip={}\n", 
+			port, inet_ntoa((struct in_addr&)ip)));
+
+		return false;
+	}
+
+	port_ = port;
+
+	if(listener_.listen(16) == -1)
+	{
+		ERROR_MSG(fmt::format("MetricsExporter::start: listen is failed! addr={}\n", 
+			listener_.c_str()));
+
+		return false;
+	}
+
+	if(!pDispatcher_->registerReadFileDescriptor(listener_, this))
+	{
+		ERROR_MSG(fmt::format("MetricsExporter::start: registerReadFileDescriptor is failed! addr={}\n", 
+			listener_.c_str()));
+
+		return false;
+	}
+
+	INFO_MSG(fmt::format("MetricsExporter is running on http://{}:{}/metrics\n", 
+		inet_ntoa((struct in_addr&)ip), port_));
+
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+bool MetricsExporter::stop()
+{
+	MetricsConnections::iterator iter = connections_.begin();
+	for(; iter != connections_.end(); ++iter)
+	{
+		pDispatcher_->deregisterReadFileDescriptor(iter->first);
+
+		if(iter->second->isWriteRegistered())
+			pDispatcher_->deregisterWriteFileDescriptor(iter->first);
+	}
+
+	connections_.clear();
+
+	if(listener_.good())
+	{
+		pDispatcher_->deregisterReadFileDescriptor(listener_);
+		listener_.close();
+	}
+
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+void MetricsExporter::closeConnection(int fd, MetricsConnection* pMetricsConnection)
+{
+	MetricsConnections::iterator iter = connections_.find(fd);
+	if(iter == connections_.end() || iter->second.get() != pMetricsConnection)
+	{
+		ERROR_MSG(fmt::format("MetricsExporter::closeConnection: not found fd({})!\n", fd));
+		return;
+	}
+
+	pDispatcher_->deregisterReadFileDescriptor(fd);
+
+	if(pMetricsConnection->isWriteRegistered())
+		pDispatcher_->deregisterWriteFileDescriptor(fd);
+
+	connections_.erase(iter);
+}
+
+//-------------------------------------------------------------------------------------
+int	MetricsExporter::handleInputNotification(int fd)
+{
+	KBE_ASSERT(listener_ == fd);
+
+	int tickcount = 0;
+
+	while(tickcount ++ < 256)
+	{
+		Network::EndPoint* pNewEndPoint = listener_.accept();
+		if(pNewEndPoint == NULL)
+			break;
+
+		pNewEndPoint->setnonblocking(true);
+
+		MetricsConnection* pMetricsConnection = new MetricsConnection(pNewEndPoint, this);
+
+		if(!pDispatcher_->registerReadFileDescriptor((*pNewEndPoint), pMetricsConnection))
+		{
+			ERROR_MSG(fmt::format("MetricsExporter::handleInputNotification: registerReadFileDescriptor is failed! addr={}\n", 
+				pNewEndPoint->c_str()));
+
+			delete pMetricsConnection;
+			continue;
+		}
+
+		connections_[(*pNewEndPoint)].reset(pMetricsConnection);
+	}
+
+	return 0;
+}
+
+//-------------------------------------------------------------------------------------
+void MetricsExporter::render(std::string& out)
+{
+	AUTO_SCOPED_PROFILE("metricsRender");
+
+	out.reserve(64 * 1024);
+
+	out += "# TYPE kbe_component info\n# HELP kbe_component Component identity.\n";
+	out += fmt::format("kbe_component_info{{type=\"{}\",id=\"{}\",gorder=\"{}\",lorder=\"{}\"}} 1\n",
+		COMPONENT_NAME_EX(g_componentType), g_componentID, g_componentGlobalOrder, g_componentGroupOrder);
+
+	Metrics::getSingleton().render(out);
+
+	renderNetworkStats(out);
+	renderProfiles(out);
+	renderWatchers(out);
+
+	out += "# EOF\n";
+}
+
+//-------------------------------------------------------------------------------------
+static void renderWatcherPaths(WatcherPaths& watcherPaths, MemoryStream& s, std::string& out)
+{
+	Watchers::WATCHER_MAP& watcherObjs = watcherPaths.watchers().watcherObjs();
+	Watchers::WATCHER_MAP::iterator iter = watcherObjs.begin();
+	for(; iter != watcherObjs.end(); ++iter)
+	{
+		WatcherObject* pWatcherObject = iter->second.get();
+		WATCHER_VALUE_TYPE type = pWatcherObject->getType();
+
+		// 只输出数值类型的watcher
+		if(type == WATCHER_VALUE_TYPE_UNKNOWN || type == WATCHER_VALUE_TYPE_CHAR || 
+			type == WATCHER_VALUE_TYPE_STRING || type == WATCHER_VALUE_TYPE_COMPONENT_TYPE)
+			continue;
+
+		s.clear(false);
+		pWatcherObject->addToStream(&s);
+
+		WATCHER_ID id;
+		s >> id;
+
+		std::string val;
+
+		switch(type)
+		{
+		case WATCHER_VALUE_TYPE_UINT8:
+			{ uint8 v; s >> v; val = fmt::format("{}", v); }
+			break;
+		case WATCHER_VALUE_TYPE_UINT16:
+			{ uint16 v; s >> v; val = fmt::format("{}", v); }
+			break;
+		case WATCHER_VALUE_TYPE_UINT32:
+			{ uint32 v; s >> v; val = fmt::format("{}", v); }
+			break;
+		case WATCHER_VALUE_TYPE_UINT64:
+			{ uint64 v; s >> v; val = fmt::format("{}", v); }
+			break;
+		case WATCHER_VALUE_TYPE_INT8:
+			{ int8 v; s >> v; val = fmt::format("{}", v); }
+			break;
+		case WATCHER_VALUE_TYPE_INT16:
+			{ int16 v; s >> v; val = fmt::format("{}", v); }
+			break;
+		case WATCHER_VALUE_TYPE_INT32:
+			{ int32 v; s >> v; val = fmt::format("{}", v); }
+			break;
+		case WATCHER_VALUE_TYPE_INT64:
+			{ int64 v; s >> v; val = fmt::format("{}", v); }
+			break;
+		case WATCHER_VALUE_TYPE_FLOAT:
+			{ float v; s >> v; val = fmt::format("{}", v); }
+			break;
+		case WATCHER_VALUE_TYPE_DOUBLE:
+			{ double v; s >> v; val = fmt::format("{}", v); }
+			break;
+		case WATCHER_VALUE_TYPE_BOOL:
+			{ bool v; s >> v; val = v ? "1" : "0"; }
+			break;
+		default:
+			continue;
+		};
+
+		std::string path = pWatcherObject->path();
+
+		// 去掉"root/"前缀
+		if(path.compare(0, 5, "root/") == 0)
+			path.erase(0, 5);
+		else if(path == "root")
+			path = "";
+
+		if(path.size() > 0)
+			path += "/";
+
+		path += pWatcherObject->name();
+
+		out += fmt::format("kbe_watcher{{path=\"{}\"}} {}\n", Metrics::escapeLabel(path), val);
+	}
+
+	WatcherPaths::WATCHER_PATHS& paths = watcherPaths.watcherPaths();
+	WatcherPaths::WATCHER_PATHS::iterator pathIter = paths.begin();
+	for(; pathIter != paths.end(); ++pathIter)
+		renderWatcherPaths(*pathIter->second, s, out);
+}
+
+//-------------------------------------------------------------------------------------
+void MetricsExporter::renderWatchers(std::string& out)
+{
+	out += "# TYPE kbe_watcher gauge\n# HELP kbe_watcher Numeric watcher values, keyed by watcher path.\n";
+
+	MemoryStream::SmartPoolObjectPtr streamPtr = MemoryStream::createSmartPoolObj();
+	renderWatcherPaths(WatcherPaths::root(), *streamPtr.get()->get(), out);
+}
+
+//-------------------------------------------------------------------------------------
+void MetricsExporter::renderProfiles(std::string& out)
+{
+#if ENABLE_WATCHERS
+	ProfileGroup& group = ProfileGroup::defaultGroup();
+
+	out += "# TYPE kbe_profile_seconds counter\n# HELP kbe_profile_seconds Total time spent in a profile scope.\n";
+	for(ProfileGroup::iterator iter = group.begin(); iter != group.end(); ++iter)
+	{
+		out += fmt::format("kbe_profile_seconds_total{{name=\"{}\"}} {}\n", 
+			Metrics::escapeLabel((*iter)->name()), (*iter)->sumTimeInSeconds());
+	}
+
+	out += "# TYPE kbe_profile_internal_seconds counter\n# HELP kbe_profile_internal_seconds Time spent in a profile scope excluding nested profiles.\n";
+	for(ProfileGroup::iterator iter = group.begin(); iter != group.end(); ++iter)
+	{
+		out += fmt::format("kbe_profile_internal_seconds_total{{name=\"{}\"}} {}\n", 
+			Metrics::escapeLabel((*iter)->name()), (*iter)->sumIntTimeInSeconds());
+	}
+
+	out += "# TYPE kbe_profile_calls counter\n# HELP kbe_profile_calls Number of times a profile scope was entered.\n";
+	for(ProfileGroup::iterator iter = group.begin(); iter != group.end(); ++iter)
+	{
+		out += fmt::format("kbe_profile_calls_total{{name=\"{}\"}} {}\n", 
+			Metrics::escapeLabel((*iter)->name()), (*iter)->count());
+	}
+#endif
+}
+
+//-------------------------------------------------------------------------------------
+void MetricsExporter::renderNetworkStats(std::string& out)
+{
+	Network::NetworkStats::STATS& stats = Network::NetworkStats::getSingleton().stats();
+
+	const char* counters[][2] = {
+		{"kbe_network_message_sent", "Messages sent, by message."},
+		{"kbe_network_message_sent_bytes", "Bytes of messages sent, by message."},
+		{"kbe_network_message_received", "Messages received, by message."},
+		{"kbe_network_message_received_bytes", "Bytes of messages received, by message."}
+	};
+
+	for(int i = 0; i < 4; ++i)
+	{
+		out += fmt::format("# TYPE {} counter\n# HELP {} {}\n", counters[i][0], counters[i][0], counters[i][1]);
+
+		Network::NetworkStats::STATS::iterator iter = stats.begin();
+		for(; iter != stats.end(); ++iter)
+		{
+			const Network::NetworkStats::Stats& stat = iter->second;
+
+			uint32 val = 0;
+			switch(i)
+			{
+			case 0: val = stat.send_count; break;
+			case 1: val = stat.send_size; break;
+			case 2: val = stat.recv_count; break;
+			default: val = stat.recv_size; break;
+			};
+
+			out += fmt::format("{}_total{{message=\"{}\"}} {}\n", counters[i][0], 
+				Metrics::escapeLabel(iter->first), val);
+		}
+	}
+
+	// 外部通道压缩(channelCommon->compression)
+	const Network::NetworkStats::CompressionStats& compressed = 
+		Network::NetworkStats::getSingleton().compressionStats(Network::NetworkStats::SEND);
+
+	const Network::NetworkStats::CompressionStats& decompressed = 
+		Network::NetworkStats::getSingleton().compressionStats(Network::NetworkStats::RECV);
+
+	out += "# TYPE kbe_network_compression_raw_bytes counter\n"
+		"# HELP kbe_network_compression_raw_bytes Bytes before compression (after decompression).\n";
+	out += fmt::format("kbe_network_compression_raw_bytes_total{{op=\"send\"}} {}\n", compressed.rawBytes);
+	out += fmt::format("kbe_network_compression_raw_bytes_total{{op=\"recv\"}} {}\n", decompressed.rawBytes);
+
+	out += "# TYPE kbe_network_compression_wire_bytes counter\n"
+		"# HELP kbe_network_compression_wire_bytes Bytes on the wire after compression.\n";
+	out += fmt::format("kbe_network_compression_wire_bytes_total{{op=\"send\"}} {}\n", compressed.wireBytes);
+	out += fmt::format("kbe_network_compression_wire_bytes_total{{op=\"recv\"}} {}\n", decompressed.wireBytes);
+
+	out += "# TYPE kbe_network_compression_seconds counter\n"
+		"# HELP kbe_network_compression_seconds Time spent compressing and decompressing packets.\n";
+	out += fmt::format("kbe_network_compression_seconds_total{{op=\"send\"}} {}\n", 
+		double(compressed.elapsed) / stampsPerSecondD());
+	out += fmt::format("kbe_network_compression_seconds_total{{op=\"recv\"}} {}\n", 
+		double(decompressed.elapsed) / stampsPerSecondD());
+
+	// 消息耗时统计(messageTimings)开启后才会有数据
+	std::vector<const Network::MessageHandler*> handlers;
+
+	std::vector<Network::MessageHandlers*>::iterator rootiter = Network::MessageHandlers::messageHandlers().begin();
+	for(; rootiter != Network::MessageHandlers::messageHandlers().end(); ++rootiter)
+	{
+		Network::MessageHandlers::MessageHandlerMap::const_iterator iter = (*rootiter)->msgHandlers().begin();
+		for(; iter != (*rootiter)->msgHandlers().end(); ++iter)
+		{
+			if(iter->second->pTimingStats && iter->second->pTimingStats->handleTime.count() > 0)
+				handlers.push_back(iter->second);
+		}
+	}
+
+	if(handlers.size() == 0)
+		return;
+
+	double secondsPerStamp = 1.0 / stampsPerSecondD();
+
+	out += "# TYPE kbe_network_message_handle_seconds histogram\n"
+		"# HELP kbe_network_message_handle_seconds Message handler duration.\n";
+
+	for(size_t i = 0; i < handlers.size(); ++i)
+	{
+		Metrics::renderHistogram(out, "kbe_network_message_handle_seconds", 
+			fmt::format("message=\"{}\"", Metrics::escapeLabel(handlers[i]->name)), 
+			handlers[i]->pTimingStats->handleTime, secondsPerStamp);
+	}
+
+	out += "# TYPE kbe_network_message_queue_delay_seconds histogram\n"
+		"# HELP kbe_network_message_queue_delay_seconds Delay between packet receive and message dispatch.\n";
+
+	for(size_t i = 0; i < handlers.size(); ++i)
+	{
+		Metrics::renderHistogram(out, "kbe_network_message_queue_delay_seconds", 
+			fmt::format("message=\"{}\"", Metrics::escapeLabel(handlers[i]->name)), 
+			handlers[i]->pTimingStats->queueDelay, secondsPerStamp);
+	}
+
+	out += "# TYPE kbe_network_message_size_bytes histogram\n"
+		"# HELP kbe_network_message_size_bytes Message body size.\n";
+
+	for(size_t i = 0; i < handlers.size(); ++i)
+	{
+		Metrics::renderHistogram(out, "kbe_network_message_size_bytes", 
+			fmt::format("message=\"{}\"", Metrics::escapeLabel(handlers[i]->name)), 
+			handlers[i]->pTimingStats->msgSize, 1.0);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+}
@@ -0,0 +1,115 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KBE_METRICS_EXPORTER_H
+#define KBE_METRICS_EXPORTER_H
+	
+#include "common/common.h"
+#include "helper/debug_helper.h"
+#include "network/address.h"
+#include "network/endpoint.h"
+#include "network/event_dispatcher.h"
+
+namespace KBEngine{
+
+class MetricsExporter;
+
+/*
+	一个http抓取连接， 收到完整的请求头后输出一次结果并关闭连接
+*/
+class MetricsConnection : public Network::InputNotificationHandler, public Network::OutputNotificationHandler
+{
+public:
+	MetricsConnection(Network::EndPoint* pEndPoint, MetricsExporter* pMetricsExporter);
+	virtual ~MetricsConnection(void);
+
+	Network::EndPoint* pEndPoint() const{ return pEndPoint_; }
+
+	bool isWriteRegistered() const{ return writeRegistered_; }
+
+private:
+	int	handleInputNotification(int fd);
+	int handleOutputNotification(int fd);
+
+	void onRequest();
+
+	/**
+		尽可能多地发送剩余数据， 全部发送完毕或者出错时返回false
+	*/
+	bool flush();
+
+	Network::EndPoint* pEndPoint_;
+	MetricsExporter* pMetricsExporter_;
+
+	std::string request_;
+
+	std::string response_;
+	size_t sentSize_;
+	bool sending_;
+
+	// 只有注册过可写事件的连接在关闭时才需要注销
+	bool writeRegistered_;
+};
+
+/*
+	以OpenMetrics文本格式对外输出本组件的metrics、watchers、profiles以及网络统计,
+	例如: curl http://127.0.0.1:port/metrics
+	所有数据都在主线程上被抓取时才生成， 平时不产生任何开销。
+*/
+class MetricsExporter : public Network::InputNotificationHandler
+{
+public:
+	MetricsExporter(Network::EventDispatcher* pDispatcher);
+	virtual ~MetricsExporter(void);
+	
+	typedef std::map<int, KBEShared_ptr< MetricsConnection > > MetricsConnections;
+
+	bool start(u_int16_t port = 0, u_int32_t ip = INADDR_ANY);
+	bool stop();
+
+	void closeConnection(int fd, MetricsConnection* pMetricsConnection);
+
+	uint32 port() const{ return port_; }
+
+	Network::EventDispatcher* pDispatcher() const{ return pDispatcher_; }
+
+	/**
+		生成OpenMetrics格式的文本
+	*/
+	void render(std::string& out);
+
+private:
+	int	handleInputNotification(int fd);
+
+	void renderWatchers(std::string& out);
+	void renderProfiles(std::string& out);
+	void renderNetworkStats(std::string& out);
+
+	MetricsConnections connections_;
+
+	Network::EndPoint			listener_;
+	Network::EventDispatcher*	pDispatcher_;
+
+	uint32 port_;
+};
+
+}
+
+#endif // KBE_METRICS_EXPORTER_H
@@ -139,6 +139,10 @@ void PythonApp::handleTimeout(TimerHandle handle, void * arg)
 	{
 	case TIMEOUT_GAME_TICK:
 		++g_kbetime;
+
+		if (TickTimeline::isRecording())
+			TickTimeline::getSingleton().onTick(g_kbetime);
+
 		handleTimers();
 		break;
 	default:
@@ -22,6 +22,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "serverapp.h"
 #include "server/component_active_report_handler.h"
 #include "server/shutdowner.h"
+#include "server/metrics_exporter.h"
 #include "server/serverconfig.h"
 #include "server/components.h"
 #include "network/channel.h"
@@ -31,6 +32,8 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "helper/console_helper.h"
 #include "helper/sys_info.h"
 #include "helper/watch_pools.h"
+#include "helper/tick_timeline.h"
+#include "helper/metrics.h"
 #include "resmgr/resmgr.h"
 
 #include "../../server/baseappmgr/baseappmgr_interface.h"
@@ -70,6 +73,7 @@ startGlobalOrder_(-1),
 startGroupOrder_(-1),
 pShutdowner_(NULL),
 pActiveTimerHandle_(NULL),
+pMetricsExporter_(NULL),
 threadPool_()
 {
 	networkInterface_.pExtensionData(this);
@@ -174,10 +178,10 @@ bool ServerApp::initialize()
 		return false;
 
 #ifdef ENABLE_WATCHERS
-	return ret && initializeWatcher();
-#else
-	return ret;
+	ret = ret && initializeWatcher();
 #endif
+
+	return ret && initializeMetrics();
 }
 
 //-------------------------------------------------------------------------------------		
@@ -193,7 +197,32 @@ bool ServerApp::initializeWatcher()
 	WATCH_OBJECT("gametime", this, &ServerApp::time);
 
 	return Network::initializeWatcher() && Resmgr::getSingleton().initializeWatcher() &&
-		threadPool_.initializeWatcher() && WatchPool::initWatchPools();
+		threadPool_.initializeWatcher() && WatchPool::initWatchPools() && 
+		TickTimeline::getSingleton().initializeWatcher();
+}
+
+//-------------------------------------------------------------------------------------		
+bool ServerApp::initializeMetrics()
+{
+	if(!g_kbeSrvConfig.metrics_enable_)
+		return true;
+
+	if(!Network::initializeMetrics())
+		return false;
+
+	pMetricsExporter_ = new MetricsExporter(&dispatcher_);
+
+	// 导出服务只是辅助功能， 启动失败不影响组件运行
+	if(!pMetricsExporter_->start(g_kbeSrvConfig.metrics_port_, networkInterface_.intEndpoint().addr().ip))
+	{
+		ERROR_MSG(fmt::format("ServerApp::initializeMetrics: start metrics exporter failed! port={}\n", 
+			g_kbeSrvConfig.metrics_port_));
+
+		pMetricsExporter_->stop();
+		SAFE_RELEASE(pMetricsExporter_);
+	}
+
+	return true;
 }
 
 //-------------------------------------------------------------------------------------		
@@ -249,9 +278,17 @@ bool ServerApp::initThreadPool()
 //-------------------------------------------------------------------------------------		
 void ServerApp::finalise(void)
 {
+	if(pMetricsExporter_)
+	{
+		pMetricsExporter_->stop();
+		SAFE_RELEASE(pMetricsExporter_);
+	}
+
 	ProfileGroup::finalise();
+	TickTimeline::finalise();
 	threadPool_.finalise();
 	Network::finalise();
+	Metrics::finalise();
 }
 
 //-------------------------------------------------------------------------------------		
@@ -518,6 +555,27 @@ void ServerApp::queryLoad(Network::Channel* pChannel)
 		return;
 }
 
+//-------------------------------------------------------------------------------------
+void ServerApp::onShmChannelOffer(Network::Channel* pChannel, MemoryStream& s)
+{
+	if(pChannel->isExternal())
+		return;
+
+	std::string name;
+	s >> name;
+
+	Components::getSingleton().onShmChannelOffer(pChannel, name);
+}
+
+//-------------------------------------------------------------------------------------
+void ServerApp::onShmChannelReady(Network::Channel* pChannel, uint8 success)
+{
+	if(pChannel->isExternal())
+		return;
+
+	Components::getSingleton().onShmChannelReady(pChannel, success);
+}
+
 //-------------------------------------------------------------------------------------
 void ServerApp::hello(Network::Channel* pChannel, MemoryStream& s)
 {
@@ -526,6 +584,20 @@ void ServerApp::hello(Network::Channel* pChannel, MemoryStream& s)
 	s >> verInfo >> scriptVerInfo;
 	s.readBlob(encryptedKey);
 
+	// 旧的客户端没有这部分数据
+	uint8 compressType = 0;
+	uint32 compressDictionaryID = 0;
+
+	if(s.length() >= sizeof(compressType) + sizeof(compressDictionaryID))
+		s >> compressType >> compressDictionaryID;
+
+	// 客户端支持的可选特性， 同样只有新的客户端才附带
+	uint32 clientFeatures = 0;
+	if(s.length() >= sizeof(clientFeatures))
+		s >> clientFeatures;
+
+	pChannel->clientFeatures(clientFeatures);
+
 	char buf[MAX_BUF];
 	std::string encryptedKey_str;
 
@@ -552,14 +624,16 @@ void ServerApp::hello(Network::Channel* pChannel, MemoryStream& s)
 	else if(scriptVerInfo != KBEVersion::scriptVersionString())
 		onScriptVersionNotMatch(pChannel);
 	else
-		onHello(pChannel, verInfo, scriptVerInfo, encryptedKey);
+		onHello(pChannel, verInfo, scriptVerInfo, encryptedKey, compressType, compressDictionaryID);
 }
 
 //-------------------------------------------------------------------------------------
 void ServerApp::onHello(Network::Channel* pChannel, 
 						const std::string& verInfo, 
 						const std::string& scriptVerInfo, 
-						const std::string& encryptedKey)
+						const std::string& encryptedKey,
+						uint8 compressType,
+						uint32 compressDictionaryID)
 {
 }
 
@@ -605,6 +679,9 @@ void ServerApp::startProfile_(Network::Channel* pChannel, std::string profileNam
 	case 3:	// networkprofile
 		new NetworkProfileHandler(this->networkInterface(), timelen, profileName, pChannel->addr());
 		break;
+	case 4:	// tickprofile
+		new TickProfileHandler(this->networkInterface(), timelen, profileName, pChannel->addr());
+		break;
 	default:
 		ERROR_MSG(fmt::format("ServerApp::startProfile_: type({}:{}) not support!\n", 
 			profileType, profileName));
@@ -58,6 +58,7 @@ class Channel;
 
 class Shutdowner;
 class ComponentActiveReportHandler;
+class MetricsExporter;
 
 class ServerApp : 
 	public SignalHandler, 
@@ -93,6 +94,7 @@ public:
 	virtual bool installSignals();
 
 	virtual bool initializeWatcher();
+	virtual bool initializeMetrics();
 
 	virtual bool loadConfig();
 	const char* name(){return COMPONENT_NAME_EX(componentType_);}
@@ -168,6 +170,16 @@ public:
 	*/
 	virtual void queryLoad(Network::Channel* pChannel);
 
+	/** 网络接口
+		同机的app请求建立共享内存通道
+	*/
+	void onShmChannelOffer(Network::Channel* pChannel, MemoryStream& s);
+
+	/** 网络接口
+		共享内存通道握手，对端此后的数据都经由共享内存到达
+	*/
+	void onShmChannelReady(Network::Channel* pChannel, uint8 success);
+
 	/** 网络接口
 		请求关闭服务器
 	*/
@@ -175,13 +187,17 @@ public:
 
 	/** 网络接口
 		客户端与服务端第一次建立交互, 客户端发送自己的版本号与通讯密钥等信息
-		给服务端， 服务端返回是否握手成功
+		给服务端， 服务端返回是否握手成功。
+		新的客户端还会在末尾附带压缩类别与字典标识， 以及支持的可选特性(CLIENT_FEATURE_*，
+		记录在通道上)
 	*/
 	virtual void hello(Network::Channel* pChannel, MemoryStream& s);
 	virtual void onHello(Network::Channel* pChannel, 
 		const std::string& verInfo, 
 		const std::string& scriptVerInfo, 
-		const std::string& encryptedKey);
+		const std::string& encryptedKey,
+		uint8 compressType,
+		uint32 compressDictionaryID);
 
 	// 引擎版本不匹配
 	virtual void onVersionNotMatch(Network::Channel* pChannel);
@@ -212,6 +228,9 @@ protected:
 	Shutdowner*												pShutdowner_;
 	ComponentActiveReportHandler*							pActiveTimerHandle_;
 
+	// OpenMetrics导出服务, 未开启时为NULL
+	MetricsExporter*										pMetricsExporter_;
+
 	// 线程池
 	thread::ThreadPool										threadPool_;	
 };
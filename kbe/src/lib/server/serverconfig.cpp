@@ -22,6 +22,8 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "serverconfig.h"
 #include "network/common.h"
 #include "network/address.h"
+#include "network/network_stats.h"
+#include "helper/tick_timeline.h"
 #include "resmgr/resmgr.h"
 #include "common/kbekey.h"
 #include "common/kbeversion.h"
@@ -38,6 +40,8 @@ ServerConfig::ServerConfig():
 gameUpdateHertz_(10),
 tick_max_buffered_logs_(4096),
 tick_max_sync_logs_(32),
+metrics_enable_(false),
+metrics_port_(20500),
 interfacesAddr_(),
 shutdown_time_(1.f),
 shutdown_waitTickTime_(1.f),
@@ -122,6 +126,44 @@ bool ServerConfig::loadConfig(std::string fileName)
 		}
 	}
 
+	rootNode = xml->getRootNode("messageTimings");
+	if(rootNode != NULL)
+	{
+		Network::NetworkStats::getSingleton().trackTimings(xml->getValStr(rootNode) == "true");
+	}
+
+	rootNode = xml->getRootNode("metrics");
+	if(rootNode != NULL)
+	{
+		TiXmlNode* childnode = xml->enterNode(rootNode, "enable");
+		if(childnode)
+			metrics_enable_ = (xml->getValStr(childnode) == "true");
+
+		childnode = xml->enterNode(rootNode, "port");
+		if(childnode)
+			metrics_port_ = (uint16)xml->getValInt(childnode);
+	}
+
+	rootNode = xml->getRootNode("tickTimeline");
+	if(rootNode != NULL)
+	{
+		TiXmlNode* childnode = xml->enterNode(rootNode, "frames");
+		if(childnode)
+			TickTimeline::getSingleton().maxFrames(xml->getValInt(childnode));
+
+		childnode = xml->enterNode(rootNode, "slowFrames");
+		if(childnode)
+			TickTimeline::getSingleton().maxSlowFrames(xml->getValInt(childnode));
+
+		childnode = xml->enterNode(rootNode, "slowTickThreshold");
+		if(childnode)
+			TickTimeline::getSingleton().slowTickThreshold(xml->getValInt(childnode));
+
+		childnode = xml->enterNode(rootNode, "enable");
+		if(childnode && xml->getValStr(childnode) == "true")
+			TickTimeline::getSingleton().start();
+	}
+
 	rootNode = xml->getRootNode("debugEntity");
 	if(rootNode != NULL)
 	{
@@ -358,6 +400,34 @@ bool ServerConfig::loadConfig(std::string fileName)
 		{
 			Network::g_channelExternalEncryptType = xml->getValInt(childnode);
 		}
+
+		childnode = xml->enterNode(rootNode, "compression");
+		if(childnode)
+		{
+			TiXmlNode* childnode1 = xml->enterNode(childnode, "type");
+			if(childnode1)
+				Network::g_channelExternalCompressType = xml->getValInt(childnode1);
+
+			childnode1 = xml->enterNode(childnode, "threshold");
+			if(childnode1)
+				Network::g_channelExternalCompressThreshold = KBE_MAX(0, xml->getValInt(childnode1));
+
+			childnode1 = xml->enterNode(childnode, "level");
+			if(childnode1)
+				Network::g_channelExternalCompressLevel = KBE_MIN(9, KBE_MAX(1, xml->getValInt(childnode1)));
+		}
+
+		childnode = xml->enterNode(rootNode, "shmTransport");
+		if(childnode)
+		{
+			TiXmlNode* childnode1 = xml->enterNode(childnode, "enable");
+			if(childnode1)
+				Network::g_shmTransportEnable = xml->getValStr(childnode1) == "true";
+
+			childnode1 = xml->enterNode(childnode, "ringSize");
+			if(childnode1)
+				Network::g_shmTransportRingSize = KBE_MAX(4096, xml->getValInt(childnode1));
+		}
 	}
 
 	rootNode = xml->getRootNode("gameUpdateHertz");
@@ -549,6 +619,88 @@ bool ServerConfig::loadConfig(std::string fileName)
 			{
 				_cellAppInfo.entity_posdir_additional_updates = xml->getValInt(childnode);
 			}
+
+			childnode = xml->enterNode(node, "proximity_grid_cell_size");
+			if(childnode)
+			{
+				_cellAppInfo.proximity_grid_cell_size = float(xml->getValFloat(childnode));
+			}
+
+			childnode = xml->enterNode(node, "proximity_grid_queries");
+			if(childnode)
+			{
+				_cellAppInfo.proximity_grid_queries = (xml->getValStr(childnode) == "true");
+			}
+		}
+
+		node = xml->enterNode(rootNode, "containerPatch");
+		if(node != NULL)
+		{
+			TiXmlNode* childnode = xml->enterNode(node, "enable");
+			if(childnode)
+			{
+				_cellAppInfo.containerPatch_enable = (xml->getValStr(childnode) == "true");
+			}
+
+			childnode = xml->enterNode(node, "clients");
+			if(childnode)
+			{
+				_cellAppInfo.containerPatch_clients = (xml->getValStr(childnode) == "true");
+			}
+
+			childnode = xml->enterNode(node, "maxOps");
+			if(childnode)
+			{
+				_cellAppInfo.containerPatch_maxOps = uint16(xml->getValInt(childnode));
+			}
+
+			childnode = xml->enterNode(node, "fullSyncInterval");
+			if(childnode)
+			{
+				_cellAppInfo.containerPatch_fullSyncInterval = uint16(xml->getValInt(childnode));
+			}
+		}
+
+		node = xml->enterNode(rootNode, "clientRelay");
+		if(node != NULL)
+		{
+			TiXmlNode* childnode = xml->enterNode(node, "batch");
+			if(childnode)
+			{
+				_cellAppInfo.clientRelay_batch = (xml->getValStr(childnode) == "true");
+			}
+
+			childnode = xml->enterNode(node, "maxBytes");
+			if(childnode)
+			{
+				_cellAppInfo.clientRelay_maxBytes = uint32(xml->getValInt(childnode));
+			}
+		}
+
+		node = xml->enterNode(rootNode, "clientMovement");
+		if(node != NULL)
+		{
+			TiXmlNode* childnode = xml->enterNode(node, "aggregate");
+			if(childnode)
+			{
+				_cellAppInfo.clientMovement_aggregate = (xml->getValStr(childnode) == "true");
+			}
+
+			childnode = xml->enterNode(node, "speedTolerance");
+			if(childnode)
+			{
+				_cellAppInfo.clientMovement_speedTolerance = float(xml->getValFloat(childnode));
+			}
+		}
+
+		node = xml->enterNode(rootNode, "volatileSnapshot");
+		if(node != NULL)
+		{
+			TiXmlNode* childnode = xml->enterNode(node, "enable");
+			if(childnode)
+			{
+				_cellAppInfo.volatileSnapshot_enable = (xml->getValStr(childnode) == "true");
+			}
 		}
 
 		node = xml->enterNode(rootNode, "telnet_service");
@@ -757,6 +909,34 @@ bool ServerConfig::loadConfig(std::string fileName)
 			Resmgr::respool_timeout = _baseAppInfo.respool_timeout;
 			Resmgr::respool_buffersize = _baseAppInfo.respool_buffersize;
 		}
+
+		node = xml->enterNode(rootNode, "containerPatch");
+		if(node != NULL)
+		{
+			TiXmlNode* childnode = xml->enterNode(node, "enable");
+			if(childnode)
+			{
+				_baseAppInfo.containerPatch_enable = (xml->getValStr(childnode) == "true");
+			}
+
+			childnode = xml->enterNode(node, "clients");
+			if(childnode)
+			{
+				_baseAppInfo.containerPatch_clients = (xml->getValStr(childnode) == "true");
+			}
+
+			childnode = xml->enterNode(node, "maxOps");
+			if(childnode)
+			{
+				_baseAppInfo.containerPatch_maxOps = uint16(xml->getValInt(childnode));
+			}
+
+			childnode = xml->enterNode(node, "fullSyncInterval");
+			if(childnode)
+			{
+				_baseAppInfo.containerPatch_fullSyncInterval = uint16(xml->getValInt(childnode));
+			}
+		}
 	}
 
 	rootNode = xml->getRootNode("dbmgr");
@@ -1243,6 +1423,52 @@ bool ServerConfig::loadConfig(std::string fileName)
 			_botsInfo.forceInternalLogin = (xml->getValStr(node) == "true");
 		}
 
+		node = xml->enterNode(rootNode, "nativeBots");
+		if(node != NULL)
+		{
+			TiXmlNode* childnode = xml->enterNode(node, "enable");
+			if(childnode)
+			{
+				_botsInfo.nativeBots_enable = (xml->getValStr(childnode) == "true");
+			}
+
+			childnode = xml->enterNode(node, "moveSpeed");
+			if(childnode)
+			{
+				_botsInfo.nativeBots_moveSpeed = (float)xml->getValFloat(childnode);
+			}
+
+			childnode = xml->enterNode(node, "moveInterval");
+			if(childnode)
+			{
+				_botsInfo.nativeBots_moveInterval = (float)xml->getValFloat(childnode);
+			}
+
+			childnode = xml->enterNode(node, "rpcMethod");
+			if(childnode)
+			{
+				_botsInfo.nativeBots_rpcMethod = xml->getValStr(childnode);
+			}
+
+			childnode = xml->enterNode(node, "rpcInterval");
+			if(childnode)
+			{
+				_botsInfo.nativeBots_rpcInterval = (float)xml->getValFloat(childnode);
+			}
+
+			childnode = xml->enterNode(node, "rttInterval");
+			if(childnode)
+			{
+				_botsInfo.nativeBots_rttInterval = (float)xml->getValFloat(childnode);
+			}
+
+			childnode = xml->enterNode(node, "reportInterval");
+			if(childnode)
+			{
+				_botsInfo.nativeBots_reportInterval = (float)xml->getValFloat(childnode);
+			}
+		}
+
 		node = xml->enterNode(rootNode, "telnet_service");
 		if(node != NULL)
 		{
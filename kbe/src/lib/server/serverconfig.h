@@ -139,6 +139,17 @@ typedef struct EngineComponentInfo
 		account_registration_enable = false;
 		account_reset_password_enable = false;
 		use_coordinate_system = true;
+		proximity_grid_cell_size = 16.f;
+		proximity_grid_queries = false;
+		containerPatch_enable = false;
+		containerPatch_clients = false;
+		containerPatch_maxOps = 32;
+		containerPatch_fullSyncInterval = 64;
+		clientRelay_batch = true;
+		clientMovement_aggregate = false;
+		clientMovement_speedTolerance = 1.f;
+		volatileSnapshot_enable = false;
+		clientRelay_maxBytes = 32768;
 		account_type = 3;
 		debugDBMgr = false;
 
@@ -146,6 +157,13 @@ typedef struct EngineComponentInfo
 
 		isOnInitCallPropertysSetMethods = true;
 		forceInternalLogin = false;
+
+		nativeBots_enable = false;
+		nativeBots_moveSpeed = 5.f;
+		nativeBots_moveInterval = 0.1f;
+		nativeBots_rpcInterval = 1.f;
+		nativeBots_rttInterval = 1.f;
+		nativeBots_reportInterval = 10.f;
 	}
 
 	~EngineComponentInfo()
@@ -173,6 +191,20 @@ typedef struct EngineComponentInfo
 	bool use_coordinate_system;								// 是否使用坐标系统 如果为false, view, trap, move等功能将不再维护
 	bool coordinateSystem_hasY;								// 范围管理器是管理Y轴， 注：有y轴则view、trap等功能有了高度， 但y轴的管理会带来一定的消耗
 	uint16 entity_posdir_additional_updates;				// 实体位置停止发生改变后，引擎继续向客户端更新tick次的位置信息，为0则总是更新。
+	float proximity_grid_cell_size;							// 空间哈希陷阱索引的格子边长
+	bool proximity_grid_queries;							// entitiesInRange是否使用空间哈希索引， 否则遍历坐标系统的链表
+
+	bool containerPatch_enable;								// 容器属性(FIXED_ARRAY/FIXED_DICT)被原地修改时是否增量同步
+	bool containerPatch_clients;							// 增量补丁是否也发送给客户端(需要客户端插件支持)
+	uint16 containerPatch_maxOps;							// 一个tick内单个属性的补丁数超过该值则改为全量同步
+	uint16 containerPatch_fullSyncInterval;					// 单个属性每同步多少次补丁后做一次全量同步，0则不做
+
+	bool clientRelay_batch;									// 同一tick内发往同一个baseapp的客户端消息合并为一个批量转发消息
+	uint32 clientRelay_maxBytes;							// 单个批量转发消息的最大字节数
+
+	bool clientMovement_aggregate;							// 一个tick内客户端上报的多次移动只保留最新的一次，在下一个tick开始时统一应用
+	float clientMovement_speedTolerance;					// 移动速度检查(topSpeed)的容差倍数
+	bool volatileSnapshot_enable;							// 视野内实体的位置朝向每tick打包为一条增量快照消息(仅对声明支持的客户端)
 
 	bool aliasEntityID;										// 优化EntityID，view范围内小于255个EntityID, 传输到client时使用1字节伪ID 
 	bool entitydefAliasID;									// 优化entity属性和方法广播时占用的带宽，entity客户端属性或者客户端不超过255个时， 方法uid和属性uid传输到client时使用1字节别名ID
@@ -240,6 +272,14 @@ typedef struct EngineComponentInfo
 	bool debugDBMgr;										// debug模式下可输出读写操作信息
 
 	bool isOnInitCallPropertysSetMethods;					// 机器人(bots)专用：在Entity初始化时是否触发属性的set_*事件
+
+	bool nativeBots_enable;									// 机器人(bots)专用：使用不带脚本的C++机器人进行压测
+	float nativeBots_moveSpeed;								// 原生机器人随机行走的速度(米/秒)
+	float nativeBots_moveInterval;							// 原生机器人向服务器同步位置的间隔(秒)
+	std::string nativeBots_rpcMethod;						// 原生机器人周期调用的base方法(必须是无参数的exposed方法)， 空则不调用
+	float nativeBots_rpcInterval;							// 原生机器人调用rpcMethod的间隔(秒)
+	float nativeBots_rttInterval;							// 原生机器人测量往返延迟的间隔(秒)
+	float nativeBots_reportInterval;						// 原生机器人统计报告的输出间隔(秒)
 } ENGINE_COMPONENT_INFO;
 
 class ServerConfig : public Singleton<ServerConfig>
@@ -310,6 +350,10 @@ public:
 
 	ChannelCommon channelCommon_;
 
+	// 以OpenMetrics格式导出metrics的http服务, 端口被占用则向后尝试
+	bool metrics_enable_;
+	uint16 metrics_port_;
+
 	// 每个客户端每秒占用的最大带宽
 	uint32 bitsPerSecondToClient_;		
 
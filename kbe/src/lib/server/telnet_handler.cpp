@@ -24,6 +24,8 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "network/bundle.h"
 #include "network/endpoint.h"
 #include "network/network_interface.h"
+#include "network/network_stats.h"
+#include "helper/tick_timeline.h"
 #include "pyscript/script.h"
 
 #ifndef CODE_INLINE
@@ -177,6 +179,11 @@ std::string TelnetHandler::help()
 		"\r\n\t\t usage: \":eventprofile 30\""
 		"\r\n[:networkprofile]: collects and reports the network profiles \r\n\t\tof a server process over a period of time."
 		"\r\n\t\t usage: \":networkprofile 30\""
+		"\r\n[:msgtimings   ]: reports the per-message handler duration, queue delay \r\n\t\tand size histograms(<messageTimings> in kbengine.xml)."
+		"\r\n\t\t usage: \":msgtimings [on|off|reset|top N]\""
+		"\r\n[:tickprofile  ]: per-tick profile timeline(<tickTimeline> in kbengine.xml)."
+		"\r\n\t\t dump/slow writes the recent/slow ticks as a chrome trace(chrome://tracing)."
+		"\r\n\t\t usage: \":tickprofile [on|off|dump|slow|threshold ms]\""
 		"\r\n\r\n\033[0m";
 };
 
@@ -723,6 +730,107 @@ bool TelnetHandler::processCommand()
 		readonly();
 		return false;
 	}
+	else if(cmd.find(":msgtimings") == 0)
+	{
+		cmd.erase(cmd.find(":msgtimings"), strlen(":msgtimings"));
+		cmd = strutil::kbe_trim(cmd);
+
+		Network::NetworkStats& networkStats = Network::NetworkStats::getSingleton();
+		uint32 maxLines = 30;
+		std::string str;
+
+		if(cmd == "on")
+		{
+			networkStats.trackTimings(true);
+			str = "message timings: on.\r\n";
+		}
+		else if(cmd == "off")
+		{
+			networkStats.trackTimings(false);
+			str = "message timings: off.\r\n";
+		}
+		else if(cmd == "reset")
+		{
+			networkStats.resetTimings();
+			str = "message timings: reset.\r\n";
+		}
+		else
+		{
+			if(cmd.find("top") == 0)
+			{
+				cmd.erase(0, strlen("top"));
+
+				try
+				{
+					KBEngine::StringConv::str2value(maxLines, strutil::kbe_trim(cmd).c_str());
+				}
+				catch(...)  
+				{
+					maxLines = 30;
+				}
+			}
+
+			str = "\r\n" + networkStats.timingsReport(maxLines, "\r\n");
+		}
+
+		pEndPoint_->send(str.c_str(), str.size());
+		sendNewLine();
+		return true;
+	}
+	else if(cmd.find(":tickprofile") == 0)
+	{
+		cmd.erase(cmd.find(":tickprofile"), strlen(":tickprofile"));
+		cmd = strutil::kbe_trim(cmd);
+
+		TickTimeline& tickTimeline = TickTimeline::getSingleton();
+		std::string str;
+
+		if(cmd == "on")
+		{
+			tickTimeline.start();
+			str = "tick timeline: on.\r\n";
+		}
+		else if(cmd == "off")
+		{
+			tickTimeline.stop();
+			str = "tick timeline: off.\r\n";
+		}
+		else if(cmd == "dump" || cmd == "slow")
+		{
+			std::string filename = fmt::format("{}_{}_{}ticks_{}.json", COMPONENT_NAME_EX(g_componentType), 
+				g_componentID, (cmd == "slow" ? "slow" : ""), g_kbetime);
+
+			if(tickTimeline.writeChromeTrace(filename, cmd == "slow"))
+				str = fmt::format("tick timeline: saved to {}.\r\n", filename);
+			else
+				str = fmt::format("tick timeline: save to {} failed!\r\n", filename);
+		}
+		else if(cmd.find("threshold") == 0)
+		{
+			cmd.erase(0, strlen("threshold"));
+
+			uint32 ms = tickTimeline.slowTickThreshold();
+
+			try
+			{
+				KBEngine::StringConv::str2value(ms, strutil::kbe_trim(cmd).c_str());
+			}
+			catch(...)  
+			{
+			}
+
+			tickTimeline.slowTickThreshold(ms);
+			str = fmt::format("tick timeline: slowTickThreshold={}ms.\r\n", ms);
+		}
+		else
+		{
+			str = "\r\n" + tickTimeline.summary(30, "\r\n");
+		}
+
+		pEndPoint_->send(str.c_str(), str.size());
+		sendNewLine();
+		return true;
+	}
 
 	if(state_ == TELNET_STATE_PYTHON)
 	{
@@ -38,12 +38,14 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "network/udp_packet.h"
 #include "network/fixed_messages.h"
 #include "network/encryption_filter.h"
+#include "network/compression_filter.h"
 #include "server/components.h"
 #include "server/telnet_server.h"
 #include "server/py_file_descriptor.h"
 #include "server/sendmail_threadtasks.h"
 #include "math/math.h"
 #include "pyscript/py_memorystream.h"
+#include "entitydef/property_patch.h"
 #include "client_lib/client_interface.h"
 
 #include "../../server/baseappmgr/baseappmgr_interface.h"
@@ -196,7 +198,11 @@ Baseapp::Baseapp(Network::EventDispatcher& dispatcher,
 	pResmgrTimerHandle_(),
 	pInitProgressHandler_(NULL),
 	flags_(APP_FLAGS_NONE),
-	pBundleImportEntityDefDatas_(NULL)
+	pBundleImportEntityDefDatas_(NULL),
+	numClientRelayBatches_(0),
+	numClientRelayRecords_(0),
+	numClientRelayBytes_(0),
+	propertyPatchEntities_()
 {
 	KBEngine::Network::MessageHandlers::pMainMessageHandlers = &BaseappInterface::messageHandlers;
 
@@ -363,6 +369,9 @@ bool Baseapp::initializeWatcher()
 	WATCH_OBJECT("numClients", this, &Baseapp::numClients);
 	WATCH_OBJECT("load", this, &Baseapp::_getLoad);
 	WATCH_OBJECT("stats/runningTime", &runningTime);
+	WATCH_OBJECT("stats/clientRelay/batches", &numClientRelayBatches_);
+	WATCH_OBJECT("stats/clientRelay/records", &numClientRelayRecords_);
+	WATCH_OBJECT("stats/clientRelay/bytes", &numClientRelayBytes_);
 	return EntityApp<Entity>::initializeWatcher();
 }
 
@@ -527,10 +536,54 @@ void Baseapp::handleGameTick()
 
 	EntityApp<Entity>::handleGameTick();
 
+	flushPropertyPatches();
 	handleBackup();
 	handleArchive();
 }
 
+//-------------------------------------------------------------------------------------
+void Baseapp::onPropertyPatch(ENTITY_ID ownerID, const PropertyDescription* pPropertyDescription, 
+	PyObject* pyRoot, MemoryStream* pPatch)
+{
+	Entity* pEntity = Baseapp::getSingleton().findEntity(ownerID);
+	if(pEntity == NULL || pEntity->isDestroyed())
+		return;
+
+	// The container may no longer be the value of this property, e.g. the property was reassigned
+	PyObject* pyName = PyUnicode_InternFromString(pPropertyDescription->getName());
+	PyObject* pyValue = PyObject_GenericGetAttr(static_cast<PyObject*>(pEntity), pyName);
+	Py_DECREF(pyName);
+
+	if(pyValue == NULL)
+	{
+		PyErr_Clear();
+		return;
+	}
+
+	Py_DECREF(pyValue);
+	if(pyValue != pyRoot)
+		return;
+
+	pEntity->onDefDataPatched(pPropertyDescription, pPatch);
+}
+
+//-------------------------------------------------------------------------------------
+void Baseapp::flushPropertyPatches()
+{
+	if(propertyPatchEntities_.empty())
+		return;
+
+	std::vector<ENTITY_ID>::iterator iter = propertyPatchEntities_.begin();
+	for(; iter != propertyPatchEntities_.end(); ++iter)
+	{
+		Entity* pEntity = findEntity((*iter));
+		if(pEntity)
+			pEntity->flushPropertyPatches();
+	}
+
+	propertyPatchEntities_.clear();
+}
+
 //-------------------------------------------------------------------------------------
 void Baseapp::handleBackup()
 {
@@ -572,6 +625,10 @@ bool Baseapp::initializeEnd()
 
 	new SyncEntityStreamTemplateHandler(this->networkInterface());
 
+	// Incremental sync of def container properties
+	if(g_kbeSrvConfig.getBaseApp().containerPatch_enable)
+		PropertyPatch::handler(&Baseapp::onPropertyPatch);
+
 	// Install pyProfile here if required
 	// Uninstall and output results at the end
 	if(g_kbeSrvConfig.getBaseApp().profiles.open_pyprofile)
@@ -600,6 +657,8 @@ void Baseapp::finalise()
 	}
 
 	pRestoreEntityHandlers_.clear();
+	PropertyPatch::handler(NULL);
+	propertyPatchEntities_.clear();
 	loopCheckTimerHandle_.cancel();
 	pResmgrTimerHandle_.cancel();
 	forward_messagebuffer_.clear();
@@ -2382,6 +2441,17 @@ void Baseapp::onCreateEntityRemotelyFromDBIDOtherBaseappCallback(Network::Channe
 	}
 }
 
+//-------------------------------------------------------------------------------------
+// Optional features the client declared in its hello (CLIENT_FEATURE_*), the cell's witness
+// only enables them for clients that support them
+static uint32 clientFeaturesOf(EntityCall* clientEntityCall)
+{
+	if(clientEntityCall == NULL || clientEntityCall->getChannel() == NULL)
+		return 0;
+
+	return clientEntityCall->getChannel()->clientFeatures();
+}
+
 //-------------------------------------------------------------------------------------
 void Baseapp::createCellEntityInNewSpace(Entity* pEntity, PyObject* pyCellappIndex)
 {
@@ -2418,6 +2488,9 @@ void Baseapp::createCellEntityInNewSpace(Entity* pEntity, PyObject* pyCellappInd
 	bool hasClient = (clientEntityCall != NULL);
 	(*pBundle) << hasClient;
 
+	// Cellappmgr forwards everything after hasClient as is
+	(*pBundle) << clientFeaturesOf(clientEntityCall);
+
 	MemoryStream* s = MemoryStream::createPoolObject();
 	pEntity->addCellDataToStream(CELLAPP_TYPE, ED_FLAG_ALL, s);
 	(*pBundle).append(*s);
@@ -2462,6 +2535,9 @@ void Baseapp::restoreSpaceInCell(Entity* pEntity)
 	bool hasClient = (clientEntityCall != NULL);
 	(*pBundle) << hasClient;
 
+	// Cellappmgr forwards everything after hasClient as is
+	(*pBundle) << clientFeaturesOf(clientEntityCall);
+
 	MemoryStream* s = MemoryStream::createPoolObject();
 	pEntity->addCellDataToStream(CELLAPP_TYPE, ED_FLAG_ALL, s);
 	(*pBundle).append(*s);
@@ -2976,6 +3052,7 @@ void Baseapp::createCellEntity(EntityCallAbstract* createToCellEntityCall, Entit
 	(*pBundle) << id;
 	(*pBundle) << componentID_;
 	(*pBundle) << hasClient;
+	(*pBundle) << clientFeaturesOf(clientEntityCall);
 	(*pBundle) << pEntity->inRestore();
 
 	MemoryStream* s = MemoryStream::createPoolObject();
@@ -4091,6 +4168,67 @@ void Baseapp::forwardMessageToClientFromCellapp(Network::Channel* pChannel,
 	ENTITY_ID eid;
 	s >> eid;
 
+	forwardMessageToClient(eid, s);
+}
+
+//-------------------------------------------------------------------------------------
+void Baseapp::forwardMessagesToClientsFromCellapp(Network::Channel* pChannel, 
+												KBEngine::MemoryStream& s)
+{
+	AUTO_SCOPED_PROFILE("forwardMessagesToClientsFromCellapp");
+
+	if(pChannel->isExternal())
+	{
+		s.done();
+		return;
+	}
+
+	++numClientRelayBatches_;
+
+	// Each record is handed to forwardMessageToClient through a window on the
+	// incoming stream, so the client messages are appended without being copied
+	const size_t wpos = s.wpos();
+
+	while(s.length() > 0)
+	{
+		if(s.length() < sizeof(ENTITY_ID) + sizeof(uint32))
+		{
+			ERROR_MSG(fmt::format("Baseapp::forwardMessagesToClientsFromCellapp: "
+				"invalid record header({} bytes left)! from {}.\n", s.length(), pChannel->c_str()));
+
+			break;
+		}
+
+		ENTITY_ID eid;
+		uint32 size;
+		s >> eid >> size;
+
+		if(size > s.length())
+		{
+			ERROR_MSG(fmt::format("Baseapp::forwardMessagesToClientsFromCellapp: "
+				"invalid record(entityID={}, size={}, left={})! from {}.\n", eid, size, s.length(), pChannel->c_str()));
+
+			break;
+		}
+
+		const size_t end = s.rpos() + size;
+		s.wpos((int)end);
+
+		forwardMessageToClient(eid, s);
+
+		s.wpos((int)wpos);
+		s.rpos((int)end);
+
+		++numClientRelayRecords_;
+		numClientRelayBytes_ += size;
+	}
+
+	s.done();
+}
+
+//-------------------------------------------------------------------------------------
+void Baseapp::forwardMessageToClient(ENTITY_ID eid, KBEngine::MemoryStream& s)
+{
 	Entity* pEntity = pEntities_->find(eid);
 	if(pEntity == NULL)
 	{
@@ -4118,17 +4256,17 @@ void Baseapp::forwardMessageToClientFromCellapp(Network::Channel* pChannel,
 
 				if(isprint)
 				{
-					WARNING_MSG(fmt::format("Baseapp::forwardMessageToClientFromCellapp: entityID {} not found, {}(msgid={}).\n", 
+					WARNING_MSG(fmt::format("Baseapp::forwardMessageToClient: entityID {} not found, {}(msgid={}).\n", 
 						eid, (pMessageHandler == NULL ? "unknown" : pMessageHandler->name), fmsgid));
 				}
 				else
 				{
-					WARNING_MSG(fmt::format("Baseapp::forwardMessageToClientFromCellapp: entityID {} not found.\n", eid));
+					WARNING_MSG(fmt::format("Baseapp::forwardMessageToClient: entityID {} not found.\n", eid));
 				}
 			}
 			else
 			{
-				// ERROR_MSG(fmt::format("Baseapp::forwardMessageToClientFromCellapp: entityID {} not found.\n", eid));
+				// ERROR_MSG(fmt::format("Baseapp::forwardMessageToClient: entityID {} not found.\n", eid));
 			}
 		}
 
@@ -4163,13 +4301,13 @@ void Baseapp::forwardMessageToClientFromCellapp(Network::Channel* pChannel,
 
 				if(isprint)
 				{
-					ERROR_MSG(fmt::format("Baseapp::forwardMessageToClientFromCellapp: "
+					ERROR_MSG(fmt::format("Baseapp::forwardMessageToClient: "
 						"error(not found clientEntityCall)! entityID({}), {}(msgid={}).\n", 
 						eid,(pMessageHandler == NULL ? "unknown" : pMessageHandler->name), fmsgid));
 				}
 				else
 				{
-					ERROR_MSG(fmt::format("Baseapp::forwardMessageToClientFromCellapp: "
+					ERROR_MSG(fmt::format("Baseapp::forwardMessageToClient: "
 						"error(not found clientEntityCall)! entityID({}).\n",
 						eid));
 				}
@@ -4177,7 +4315,7 @@ void Baseapp::forwardMessageToClientFromCellapp(Network::Channel* pChannel,
 			else
 			{
 				/*
-				ERROR_MSG(fmt::format("Baseapp::forwardMessageToClientFromCellapp: "
+				ERROR_MSG(fmt::format("Baseapp::forwardMessageToClient: "
 					"error(not found clientEntityCall)! entityID({}).\n",
 					eid));
 				*/
@@ -4238,7 +4376,7 @@ void Baseapp::forwardMessageToClientFromCellapp(Network::Channel* pChannel,
 
 		if(isprint)
 		{
-			DEBUG_MSG(fmt::format("Baseapp::forwardMessageToClientFromCellapp: {}(msgid={}).\n",
+			DEBUG_MSG(fmt::format("Baseapp::forwardMessageToClient: {}(msgid={}).\n",
 				(pMessageHandler == NULL ? "unknown" : pMessageHandler->name), fmsgid));
 		}
 	}
@@ -4662,7 +4800,9 @@ void Baseapp::onEntityAutoLoadCBFromDBMgr(Network::Channel* pChannel, MemoryStre
 void Baseapp::onHello(Network::Channel* pChannel, 
 						const std::string& verInfo, 
 						const std::string& scriptVerInfo,
-						const std::string& encryptedKey)
+						const std::string& encryptedKey,
+						uint8 compressType,
+						uint32 compressDictionaryID)
 {
 	Network::Bundle* pBundle = Network::Bundle::createPoolObject();
 	
@@ -4673,6 +4813,14 @@ void Baseapp::onHello(Network::Channel* pChannel,
 	(*pBundle) << EntityDef::md5().getDigestStr();
 	(*pBundle) << g_componentType;
 
+	// Only clients that offered compression get the answer appended, the dictionary is used
+	// when both sides built the same one from their entitydefs
+	Network::CompressionFilter* pCompressionFilter = Network::createCompressionFilter(compressType, 
+		compressDictionaryID, EntityDef::compressionDictionary());
+
+	if(pCompressionFilter)
+		(*pBundle) << pCompressionFilter->type() << pCompressionFilter->dictionaryID();
+
 	// This message does not allow encryption, so set the encryption to ignored again.
 	// This occurs when the first send message is not immediately generated but is notified by epoll
 	//  (usually for testing, won't happen in normal environment).
@@ -4695,6 +4843,9 @@ void Baseapp::onHello(Network::Channel* pChannel,
 				, pChannel->c_str()));
 		}
 	}
+
+	if(pCompressionFilter)
+		pChannel->pushFilter(pCompressionFilter);
 }
 
 //-------------------------------------------------------------------------------------
@@ -362,6 +362,16 @@ public:
 	*/
 	void forwardMessageToClientFromCellapp(Network::Channel* pChannel, KBEngine::MemoryStream& s);
 
+	/** Network interface
+		cellapp forwards a batch of entity messages to clients, each record is [ENTITY_ID][uint32 len][client messages]
+	*/
+	void forwardMessagesToClientsFromCellapp(Network::Channel* pChannel, KBEngine::MemoryStream& s);
+
+	/**
+		Forward the client messages in [s.rpos(), s.wpos()) to the client of an entity
+	*/
+	void forwardMessageToClient(ENTITY_ID eid, KBEngine::MemoryStream& s);
+
 	/** Network interface
 		Cellapp forwards the entity message to the cellEntity of a baseEntity
 	*/
@@ -413,7 +423,9 @@ public:
 	virtual void onHello(Network::Channel* pChannel, 
 		const std::string& verInfo, 
 		const std::string& scriptVerInfo, 
-		const std::string& encryptedKey);
+		const std::string& encryptedKey,
+		uint8 compressType,
+		uint32 compressDictionaryID);
 
 	// Engine version does not match
 	virtual void onVersionNotMatch(Network::Channel* pChannel);
@@ -523,6 +535,15 @@ public:
 	void flags(uint32 v) { flags_ = v; }
 	static PyObject* __py_setFlags(PyObject* self, PyObject* args);
 	static PyObject* __py_getFlags(PyObject* self, PyObject* args);
+
+	/** 
+		Def container properties modified in place, patches are collected per entity and sent once per tick
+	*/
+	static void onPropertyPatch(ENTITY_ID ownerID, const PropertyDescription* pPropertyDescription, 
+		PyObject* pyRoot, MemoryStream* pPatch);
+
+	void addPropertyPatchEntity(ENTITY_ID entityID){ propertyPatchEntities_.push_back(entityID); }
+	void flushPropertyPatches();
 	
 protected:
 	TimerHandle												loopCheckTimerHandle_;
@@ -554,6 +575,14 @@ protected:
 
 	// Dynamic import of entitydef protocol for clients
 	Network::Bundle*										pBundleImportEntityDefDatas_;
+
+	// Cellapp client relay statistics
+	uint64													numClientRelayBatches_;
+	uint64													numClientRelayRecords_;
+	uint64													numClientRelayBytes_;
+
+	// Entities that have container property patches waiting to be sent in this tick
+	std::vector<ENTITY_ID>									propertyPatchEntities_;
 };
 
 }
@@ -200,12 +200,22 @@ NETWORK_INTERFACE_DECLARE_BEGIN(BaseappInterface)
 	// Cellapp forward entity message to client
 	BASEAPP_MESSAGE_DECLARE_STREAM(forwardMessageToClientFromCellapp,				NETWORK_VARIABLE_MESSAGE)
 
+	// Cellapp forwards a batch of entity messages to the clients of several proxies
+	BASEAPP_MESSAGE_DECLARE_STREAM(forwardMessagesToClientsFromCellapp,				NETWORK_VARIABLE_MESSAGE)
+
 	// Cellapp forwards entity messages to the cellentity of a baseentity 
 	BASEAPP_MESSAGE_DECLARE_STREAM(forwardMessageToCellappFromCellapp,				NETWORK_VARIABLE_MESSAGE)
 
 	// Request to shut down the server
 	BASEAPP_MESSAGE_DECLARE_STREAM(reqCloseServer,									NETWORK_VARIABLE_MESSAGE)
 
+	// Co-located app offers a shared-memory channel
+	BASEAPP_MESSAGE_DECLARE_STREAM(onShmChannelOffer,								NETWORK_VARIABLE_MESSAGE)
+
+	// Shared-memory channel handshake marker
+	BASEAPP_MESSAGE_DECLARE_ARGS1(onShmChannelReady,								NETWORK_FIXED_MESSAGE,
+									uint8,											success)
+
 	// Write entity to db callback.
 	BASEAPP_MESSAGE_DECLARE_ARGS5(onWriteToDBCallback,								NETWORK_FIXED_MESSAGE,
 									ENTITY_ID,										eid,
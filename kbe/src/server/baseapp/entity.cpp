@@ -26,6 +26,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "entitydef/entity_call.h"
 #include "entitydef/entity_component.h"
 #include "entitydef/entitydef.h"
+#include "entitydef/property_patch.h"
 #include "network/channel.h"	
 #include "network/fixed_messages.h"
 #include "client_lib/client_interface.h"
@@ -79,7 +80,9 @@ createdSpace_(false),
 inRestore_(false),
 pBufferedSendToClientMessages_(NULL),
 isDirty_(true),
-dbInterfaceIndex_(0)
+dbInterfaceIndex_(0),
+pPropertyPatches_(NULL),
+hasPendingPropertyPatches_(false)
 {
 	script::PyGC::incTracing("Entity");
 	ENTITY_INIT_PROPERTYS(Entity);
@@ -97,6 +100,18 @@ Entity::~Entity()
 	S_RELEASE(cellDataDict_);
 	SAFE_RELEASE(pBufferedSendToClientMessages_);
 
+	if(pPropertyPatches_)
+	{
+		std::vector<PropertyPatchState>::iterator iter = pPropertyPatches_->begin();
+		for(; iter != pPropertyPatches_->end(); ++iter)
+		{
+			if(iter->pPatch)
+				MemoryStream::reclaimPoolObject(iter->pPatch);
+		}
+
+		SAFE_RELEASE(pPropertyPatches_);
+	}
+
 	if(Baseapp::getSingleton().pEntities())
 		Baseapp::getSingleton().pEntities()->pGetbages()->erase(id());
 
@@ -112,6 +127,26 @@ void Entity::onDefDataChanged(EntityComponent* pEntityComponent, const PropertyD
 
 	if(propertyDescription->isPersistent())
 		setDirty();
+
+	if(pEntityComponent == NULL && PropertyPatch::isEnabled())
+	{
+		attachPropertyPatch(propertyDescription, pyData);
+
+		// The whole value is sent now, patches collected before are no longer needed
+		if(pPropertyPatches_)
+		{
+			std::vector<PropertyPatchState>::iterator iter = pPropertyPatches_->begin();
+			for(; iter != pPropertyPatches_->end(); ++iter)
+			{
+				if(iter->pPropertyDescription == propertyDescription)
+				{
+					resetPropertyPatchState((*iter));
+					iter->flushCount = 0;
+					break;
+				}
+			}
+		}
+	}
 	
 	uint32 flags = propertyDescription->getFlags();
 	ENTITY_PROPERTY_UID componentPropertyUID = 0;
@@ -158,6 +193,169 @@ void Entity::onDefDataChanged(EntityComponent* pEntityComponent, const PropertyD
 	MemoryStream::reclaimPoolObject(mstream);
 }
 
+//-------------------------------------------------------------------------------------
+bool Entity::attachPropertyPatch(const PropertyDescription* propertyDescription, PyObject* pyValue)
+{
+	if(PropertyPatch::getLink(pyValue) == NULL)
+		return false;
+
+	PropertyPatch::attach(id(), propertyDescription, pyValue);
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+void Entity::resetPropertyPatchState(PropertyPatchState& state)
+{
+	if(state.pPatch)
+		state.pPatch->clear(false);
+
+	state.numOps = 0;
+	state.fullSync = false;
+}
+
+//-------------------------------------------------------------------------------------
+void Entity::onDefDataPatched(const PropertyDescription* propertyDescription, MemoryStream* pPatch)
+{
+	if(initing() || isDestroyed())
+		return;
+
+	if(propertyDescription->isPersistent())
+		setDirty();
+
+	if((propertyDescription->getFlags() & ED_FLAG_BASE_AND_CLIENT) <= 0 || clientEntityCall_ == NULL)
+		return;
+
+	if(pPropertyPatches_ == NULL)
+		pPropertyPatches_ = new std::vector<PropertyPatchState>();
+
+	PropertyPatchState* pState = NULL;
+
+	std::vector<PropertyPatchState>::iterator iter = pPropertyPatches_->begin();
+	for(; iter != pPropertyPatches_->end(); ++iter)
+	{
+		if(iter->pPropertyDescription == propertyDescription)
+		{
+			pState = &(*iter);
+			break;
+		}
+	}
+
+	if(pState == NULL)
+	{
+		PropertyPatchState state;
+		state.pPropertyDescription = propertyDescription;
+		state.pPatch = NULL;
+		state.numOps = 0;
+		state.flushCount = 0;
+		state.fullSync = false;
+
+		pPropertyPatches_->push_back(state);
+		pState = &pPropertyPatches_->back();
+	}
+
+	if(!pState->fullSync)
+	{
+		// Too many changes in one tick, sending the whole value is cheaper
+		if(pPatch == NULL || pState->numOps >= g_kbeSrvConfig.getBaseApp().containerPatch_maxOps)
+		{
+			resetPropertyPatchState((*pState));
+			pState->fullSync = true;
+		}
+		else
+		{
+			if(pState->pPatch == NULL)
+				pState->pPatch = MemoryStream::createPoolObject();
+
+			pState->pPatch->append(pPatch->data() + pPatch->rpos(), pPatch->length());
+			++pState->numOps;
+		}
+	}
+
+	if(!hasPendingPropertyPatches_)
+	{
+		hasPendingPropertyPatches_ = true;
+		Baseapp::getSingleton().addPropertyPatchEntity(id());
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void Entity::flushPropertyPatches()
+{
+	hasPendingPropertyPatches_ = false;
+
+	if(pPropertyPatches_ == NULL)
+		return;
+
+	const bool sendToClient = g_kbeSrvConfig.getBaseApp().containerPatch_clients;
+	const uint16 fullSyncInterval = g_kbeSrvConfig.getBaseApp().containerPatch_fullSyncInterval;
+
+	std::vector<PropertyPatchState>::iterator iter = pPropertyPatches_->begin();
+	for(; iter != pPropertyPatches_->end(); ++iter)
+	{
+		PropertyPatchState& state = (*iter);
+		if(!state.fullSync && state.numOps == 0)
+			continue;
+
+		if(isDestroyed() || clientEntityCall_ == NULL)
+		{
+			resetPropertyPatchState(state);
+			continue;
+		}
+
+		const PropertyDescription* propertyDescription = state.pPropertyDescription;
+
+		bool fullSync = state.fullSync || !sendToClient;
+
+		// Periodically resend the whole value to correct any drift
+		if(!fullSync && fullSyncInterval > 0 && ++state.flushCount >= fullSyncInterval)
+			fullSync = true;
+
+		if(fullSync)
+		{
+			PyObject* pyName = PyUnicode_InternFromString(propertyDescription->getName());
+			PyObject* pyValue = PyObject_GenericGetAttr(static_cast<PyObject*>(this), pyName);
+			Py_DECREF(pyName);
+
+			if(pyValue == NULL)
+			{
+				SCRIPT_ERROR_CHECK();
+				resetPropertyPatchState(state);
+				continue;
+			}
+
+			// Resets the state of this property
+			onDefDataChanged(NULL, propertyDescription, pyValue);
+			Py_DECREF(pyValue);
+			continue;
+		}
+
+		Network::Bundle* pBundle = Network::Bundle::createPoolObject();
+		(*pBundle).newMessage(ClientInterface::onUpdatePropertyPatch);
+		(*pBundle) << id();
+
+		if (pScriptModule_->usePropertyDescrAlias())
+		{
+			(*pBundle) << (uint8)0;
+			(*pBundle) << propertyDescription->aliasIDAsUint8();
+		}
+		else
+		{
+			(*pBundle) << (ENTITY_PROPERTY_UID)0;
+			(*pBundle) << propertyDescription->getUType();
+		}
+
+		(*pBundle) << state.numOps;
+		pBundle->append(*state.pPatch);
+
+		g_privateClientEventHistoryStats.trackEvent(scriptName(), 
+			propertyDescription->getName(), 
+			pBundle->currMsgLength());
+
+		static_cast<Proxy*>(this)->sendToClient(ClientInterface::onUpdatePropertyPatch, pBundle);
+		resetPropertyPatchState(state);
+	}
+}
+
 //-------------------------------------------------------------------------------------
 void Entity::onDestroy(bool callScript)
 {
@@ -714,18 +912,33 @@ PyObject* Entity::onScriptGetAttribute(PyObject* attr)
 	// If you access the def persistent class container property
 	// Since there is no good monitoring of the internal changes in the properties of the container class,
 	// use a compromise here
+	bool dirty = false;
 	PropertyDescription* pPropertyDescription = const_cast<ScriptDefModule*>(pScriptModule())->findPersistentPropertyDescription(ccattr);
 	if(pPropertyDescription && (pPropertyDescription->getFlags() & ENTITY_BASE_DATA_FLAGS) > 0)
 	{
-		setDirty();
+		dirty = true;
 	}
 	else if (strcmp(ccattr, "cellData") == 0)
 	{
-		setDirty();
+		dirty = true;
 	}
+
+	// FIXED_ARRAY and FIXED_DICT values linked to this entity report their own changes
+	PropertyDescription* pPatchPropertyDescription = NULL;
+	if(PropertyPatch::isEnabled())
+		pPatchPropertyDescription = const_cast<ScriptDefModule*>(pScriptModule())->findBasePropertyDescription(ccattr);
 	
 	free(ccattr);
-	return ScriptObject::onScriptGetAttribute(attr);
+
+	PyObject* pyValue = ScriptObject::onScriptGetAttribute(attr);
+
+	if(pPatchPropertyDescription && pyValue && attachPropertyPatch(pPatchPropertyDescription, pyValue))
+		dirty = false;
+
+	if(dirty)
+		setDirty();
+
+	return pyValue;
 }	
 
 //-------------------------------------------------------------------------------------
@@ -283,6 +283,17 @@ public:
 	*/
 	INLINE void setDirty(bool dirty = true);
 	INLINE bool isDirty() const;
+
+	/** 
+		Defined container property was modified in place, 
+		pPatch is NULL if the change can't be described by a patch and the whole property must be resent
+	*/
+	void onDefDataPatched(const PropertyDescription* propertyDescription, MemoryStream* pPatch);
+
+	/** 
+		Send the patches collected in this tick to the client
+	*/
+	void flushPropertyPatches();
 	
 protected:
 	/** 
@@ -291,6 +302,23 @@ protected:
 	void onDefDataChanged(EntityComponent* pEntityComponent, const PropertyDescription* propertyDescription,
 			PyObject* pyData);
 
+	/** 
+		Link a container property value to this entity, its in-place changes are then reported 
+		through onDefDataPatched. Returns false if the value can't be tracked
+	*/
+	bool attachPropertyPatch(const PropertyDescription* propertyDescription, PyObject* pyValue);
+
+	struct PropertyPatchState
+	{
+		const PropertyDescription* pPropertyDescription;
+		MemoryStream* pPatch;
+		uint16 numOps;
+		uint16 flushCount;
+		bool fullSync;
+	};
+
+	void resetPropertyPatchState(PropertyPatchState& state);
+
 	/**
 		Erase online log from db
 	*/
@@ -347,6 +375,10 @@ protected:
 
 	// If this entity has been written to the database, this attribute is the index of the corresponding database interface
 	uint16									dbInterfaceIndex_;
+
+	// In-place changes of container properties waiting to be sent to the client
+	std::vector<PropertyPatchState>*		pPropertyPatches_;
+	bool									hasPendingPropertyPatches_;
 };
 
 }
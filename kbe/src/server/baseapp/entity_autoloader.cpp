@@ -31,14 +31,21 @@ namespace KBEngine{
 
 #define LOAD_ENTITY_SIZE 32
 
+// Number of batch queries kept in flight per entity type, so dbmgr's
+// thread pool can serve several batches while earlier ones are being created
+#define LOAD_ENTITY_INFLIGHT 4
+
 //-------------------------------------------------------------------------------------
 EntityAutoLoader::EntityAutoLoader(Network::NetworkInterface & networkInterface, InitProgressHandler* pInitProgressHandler):
 networkInterface_(networkInterface),
 pInitProgressHandler_(pInitProgressHandler),
 entityTypes_(),
 start_(0),
-end_(0),
-querying_(false)
+inflight_(0),
+typeDone_(false),
+numLoaded_(0),
+numQueries_(0),
+startTime_(timestamp())
 {
 	ENGINE_COMPONENT_INFO& dbcfg = g_kbeSrvConfig.getDBMgr();
 
@@ -61,6 +68,9 @@ EntityAutoLoader::~EntityAutoLoader()
 {
 	DEBUG_MSG("EntityAutoLoader::~EntityAutoLoader()\n");
 
+	INFO_MSG(fmt::format("EntityAutoLoader::~EntityAutoLoader(): loaded {} entities in {} queries, took {:.3f}s.\n",
+		numLoaded_, numQueries_, TimeStamp::toSeconds(timestamp() - startTime_)));
+
 	if(pInitProgressHandler_)
 		pInitProgressHandler_->setAutoLoadState(1);
 }
@@ -74,21 +84,23 @@ void EntityAutoLoader::onEntityAutoLoadCBFromDBMgr(Network::Channel* pChannel, M
 	int size = 0;
 	s >> size;
 
-	if(size >= LOAD_ENTITY_SIZE)
-	{
-		start_ = end_;
-		end_ += LOAD_ENTITY_SIZE;
-	}
-	else
+	--inflight_;
+	numLoaded_ += size;
+
+	// Batches may come back in any order, a short batch marks the end of the table,
+	// move on to the next type only after every batch of this one has returned
+	if(size < LOAD_ENTITY_SIZE)
+		typeDone_ = true;
+
+	if(typeDone_ && inflight_ <= 0)
 	{
 		start_ = 0;
-		end_ = 0;
+		inflight_ = 0;
+		typeDone_ = false;
 
 		(*entityTypes_.begin()).erase((*entityTypes_.begin()).begin());
 	}
 
-	querying_ = false;
-
 	ENTITY_SCRIPT_UID entityType;
 	s >> entityType;
 
@@ -129,23 +141,28 @@ void EntityAutoLoader::onEntityAutoLoadCBFromDBMgr(Network::Channel* pChannel, M
 bool EntityAutoLoader::process()
 {
 	Network::Channel* pChannel = Components::getSingleton().getDbmgrChannel();
-	if(pChannel == NULL || querying_)
+	if(pChannel == NULL)
 		return true;
 
 	if(entityTypes_.size() > 0)
 	{
 		if ((*entityTypes_.begin()).size() > 0)
 		{
-			Network::Bundle* pBundle = Network::Bundle::createPoolObject();
+			uint16 dbInterfaceIndex = (uint16)(g_kbeSrvConfig.getDBMgr().dbInterfaceInfos.size() - entityTypes_.size());
+
+			while(!typeDone_ && inflight_ < LOAD_ENTITY_INFLIGHT)
+			{
+				ENTITY_ID end = start_ + LOAD_ENTITY_SIZE;
 
-			if (start_ == 0 && end_ == 0)
-				end_ = LOAD_ENTITY_SIZE;
+				Network::Bundle* pBundle = Network::Bundle::createPoolObject();
+				(*pBundle).newMessage(DbmgrInterface::entityAutoLoad);
+				(*pBundle) << dbInterfaceIndex << g_componentID << (*(*entityTypes_.begin()).begin()) << start_ << end;
+				pChannel->send(pBundle);
 
-			uint16 dbInterfaceIndex = (uint16)(g_kbeSrvConfig.getDBMgr().dbInterfaceInfos.size() - entityTypes_.size());
-			(*pBundle).newMessage(DbmgrInterface::entityAutoLoad);
-			(*pBundle) << dbInterfaceIndex << g_componentID << (*(*entityTypes_.begin()).begin()) << start_ << end_;
-			pChannel->send(pBundle);
-			querying_ = true;
+				start_ = end;
+				++inflight_;
+				++numQueries_;
+			}
 		}
 		else
 		{
@@ -48,11 +48,18 @@ private:
 
 	std::vector< std::vector<ENTITY_SCRIPT_UID> > entityTypes_;
 
-	// 每次取查询结果集的区段
+	// 下一次查询结果集的区段起始位置
 	ENTITY_ID start_;
-	ENTITY_ID end_;
 
-	bool querying_;
+	// 当前实体类型已发出但还未返回的查询数量
+	int inflight_;
+
+	// 当前实体类型的结果已经取完(收到了不足一批的结果)
+	bool typeDone_;
+
+	uint32 numLoaded_;
+	uint32 numQueries_;
+	uint64 startTime_;
 };
 
 
@@ -74,14 +74,13 @@ PyObject* EntityRemoteMethod::tp_call(PyObject* self, PyObject* args,
 	}
 
 	// If a client method is invoked, we record the event and bandwidth
-	if(methodDescription->checkArgs(args))
+	MemoryStream* mstream = MemoryStream::createPoolObject();
+
+	if(methodDescription->checkArgsAndAddToStream(mstream, args))
 	{
 		Network::Bundle* pBundle = Network::Bundle::createPoolObject();
 		entityCall->newCall((*pBundle));
 
-		MemoryStream* mstream = MemoryStream::createPoolObject();
-		methodDescription->addToStream(mstream, args);
-
 		if(mstream->wpos() > 0)
 			(*pBundle).append(mstream->data(), (int)mstream->wpos());
 
@@ -92,10 +91,9 @@ PyObject* EntityRemoteMethod::tp_call(PyObject* self, PyObject* args,
 			"::");
 		
 		static_cast<Proxy*>(pEntity)->sendToClient(ClientInterface::onRemoteMethodCall, pBundle);
-
-		MemoryStream::reclaimPoolObject(mstream);
 	}
 	
+	MemoryStream::reclaimPoolObject(mstream);
 	S_Return;
 }	
 
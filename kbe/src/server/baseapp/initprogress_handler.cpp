@@ -36,7 +36,8 @@ delayTicks_(0),
 pEntityAutoLoader_(NULL),
 autoLoadState_(-1),
 error_(false),
-baseappReady_(false)
+baseappReady_(false),
+startTime_(timestamp())
 {
 	networkInterface.dispatcher().addTask(this);
 }
@@ -121,6 +122,9 @@ bool InitProgressHandler::process()
 	{
 		baseappReady_ = true;
 
+		INFO_MSG(fmt::format("InitProgressHandler::process(): calling onBaseAppReady, {:.3f}s since dbmgr init completed.\n",
+			TimeStamp::toSeconds(timestamp() - startTime_)));
+
 		SCOPED_PROFILE(SCRIPTCALL_PROFILE);
 
 		// All scripts loaded
@@ -197,6 +201,9 @@ bool InitProgressHandler::process()
 
 	if(completed)
 	{
+		INFO_MSG(fmt::format("InitProgressHandler::process(): ready for login, {:.3f}s since dbmgr init completed.\n",
+			TimeStamp::toSeconds(timestamp() - startTime_)));
+
 		delete this;
 		return false;
 	}
@@ -53,6 +53,9 @@ private:
 	int8 autoLoadState_;
 	bool error_;
 	bool baseappReady_;
+
+	// Used to report how long each startup stage took
+	uint64 startTime_;
 };
 
 
@@ -433,6 +433,13 @@ void Proxy::onGetWitness()
 		Network::Bundle* pBundle = Network::Bundle::createPoolObject();
 		(*pBundle).newMessage(CellappInterface::onGetWitnessFromBase);
 		(*pBundle) << this->id();
+
+		// The client may have been replaced, so the cell learns its features again
+		uint32 clientFeatures = 0;
+		if(clientEntityCall() && clientEntityCall()->getChannel())
+			clientFeatures = clientEntityCall()->getChannel()->clientFeatures();
+
+		(*pBundle) << clientFeatures;
 		sendToCellapp(pBundle);
 	}
 }
@@ -38,6 +38,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "server/py_file_descriptor.h"
 #include "dbmgr/dbmgr_interface.h"
 #include "navigation/navigation.h"
+#include "entitydef/property_patch.h"
 #include "client_lib/client_interface.h"
 
 #include "../../server/baseappmgr/baseappmgr_interface.h"
@@ -66,8 +67,11 @@ Cellapp::Cellapp(Network::EventDispatcher& dispatcher,
 	pTelnetServer_(NULL),
 	pWitnessedTimeoutHandler_(NULL),
 	pGhostManager_(NULL),
+	clientRelay_(),
 	flags_(APP_FLAGS_NONE),
-	spaceViewers_()
+	spaceViewers_(),
+	propertyPatchEntities_(),
+	clientMoveEntities_()
 {
 	KBEngine::Network::MessageHandlers::pMainMessageHandlers = &CellappInterface::messageHandlers;
 
@@ -154,6 +158,10 @@ bool Cellapp::initializeWatcher()
 	WATCH_OBJECT("load", this, &Cellapp::_getLoad);
 	WATCH_OBJECT("spaceSize", &KBEngine::getUsername);
 	WATCH_OBJECT("stats/runningTime", &runningTime);
+	WATCH_OBJECT("stats/clientRelay/batches", &clientRelay_, &ClientRelay::numBatches);
+	WATCH_OBJECT("stats/clientRelay/records", &clientRelay_, &ClientRelay::numRecords);
+	WATCH_OBJECT("stats/clientRelay/bytes", &clientRelay_, &ClientRelay::numBytes);
+	WATCH_OBJECT("stats/clientRelay/fallbacks", &clientRelay_, &ClientRelay::numFallbacks);
 	return EntityApp<Entity>::initializeWatcher() && WatchObjectPool::initWatchPools();
 }
 
@@ -265,8 +273,14 @@ void Cellapp::handleGameTick()
 	// Must be done first
 	updateLoad();
 
+	// Move the client controlled entities before timers and View updates see them
+	applyClientMoves();
+
 	EntityApp<Entity>::handleGameTick();
 
+	// Send the in-place container changes collected during this tick
+	flushPropertyPatches();
+
 	updatables_.update();
 	Spaces::update();
 }
@@ -292,6 +306,10 @@ bool Cellapp::initializeEnd()
 	// Whether to manage the Y-axis
 	CoordinateSystem::hasY = g_kbeSrvConfig.getCellApp().coordinateSystem_hasY;
 
+	// Incremental sync of def container properties
+	if(g_kbeSrvConfig.getCellApp().containerPatch_enable)
+		PropertyPatch::handler(&Cellapp::onPropertyPatch);
+
 	dispatcher_.clearSpareTime();
 
 	pGhostManager_ = new GhostManager();
@@ -311,6 +329,9 @@ bool Cellapp::initializeEnd()
 void Cellapp::finalise()
 {
 	spaceViewers_.finalise();
+	PropertyPatch::handler(NULL);
+	propertyPatchEntities_.clear();
+	clientMoveEntities_.clear();
 
 	SAFE_RELEASE(pGhostManager_);
 	SAFE_RELEASE(pWitnessedTimeoutHandler_);
@@ -430,6 +451,13 @@ void Cellapp::onGetEntityAppFromDbmgr(Network::Channel* pChannel, int32 uid, std
 	cinfos->pChannel->send(pBundle);
 }
 
+//-------------------------------------------------------------------------------------
+void Cellapp::onChannelDeregister(Network::Channel * pChannel)
+{
+	clientRelay_.onChannelDeregister(pChannel);
+	EntityApp<Entity>::onChannelDeregister(pChannel);
+}
+
 //-------------------------------------------------------------------------------------
 void Cellapp::onUpdateLoad()
 {
@@ -494,6 +522,7 @@ PyObject* Cellapp::__py_createEntity(PyObject* self, PyObject* args)
 		pEntity->pySetPosition(position);
 		pEntity->pySetDirection(direction);	
 		pEntity->initializeScript();
+		pEntity->attachPropertyPatches();
 
 		// Add to space
 		space->addEntityAndEnterWorld(pEntity);
@@ -871,12 +900,14 @@ void Cellapp::onCreateCellEntityInNewSpaceFromBaseapp(Network::Channel* pChannel
 	COMPONENT_ID componentID;
 	SPACE_ID spaceID = 1;
 	bool hasClient;
+	uint32 clientFeatures;
 
 	s >> entityType;
 	s >> entitycallEntityID;
 	s >> spaceID;
 	s >> componentID;
 	s >> hasClient;
+	s >> clientFeatures;
 
 	// DEBUG_MSG("Cellapp::onCreateCellEntityInNewSpaceFromBaseapp: spaceID=%u, entityType=%s, entityID=%d, componentID=%"PRAppID".\n", 
 	//	spaceID, entityType.c_str(), entitycallEntityID, componentID);
@@ -920,6 +951,7 @@ void Cellapp::onCreateCellEntityInNewSpaceFromBaseapp(Network::Channel* pChannel
 			// In order to enable the entity.__init__ to be able to modify attributes immediately broadcast to the client we need to set these in advance
 			e->clientEntityCall(client);
 			e->setWitness(Witness::createPoolObject());
+			e->pWitness()->clientFeatures(clientFeatures);
 		}
 
 		// Baseapp may not be initialized here, so it's possible that it is None
@@ -944,6 +976,7 @@ void Cellapp::onCreateCellEntityInNewSpaceFromBaseapp(Network::Channel* pChannel
 		space->addEntity(e);
 		e->spaceID(space->id());
 		e->initializeEntity(cellData);
+		e->attachPropertyPatches();
 		Py_XDECREF(cellData);
 
 		// Add to space
@@ -978,12 +1011,14 @@ void Cellapp::onRestoreSpaceInCellFromBaseapp(Network::Channel* pChannel, KBEngi
 	COMPONENT_ID componentID;
 	SPACE_ID spaceID = 1;
 	bool hasClient;
+	uint32 clientFeatures;
 
 	s >> entityType;
 	s >> entitycallEntityID;
 	s >> spaceID;
 	s >> componentID;
 	s >> hasClient;
+	s >> clientFeatures;
 
 	// DEBUG_MSG("Cellapp::onRestoreSpaceInCellFromBaseapp: spaceID=%u, entityType=%s, entityID=%d, componentID=%"PRAppID".\n", 
 	//	spaceID, entityType.c_str(), entitycallEntityID, componentID);
@@ -1018,6 +1053,7 @@ void Cellapp::onRestoreSpaceInCellFromBaseapp(Network::Channel* pChannel, KBEngi
 			// In order to enable the entity.__init__ to be able to modify attributes immediately broadcast to the client we need to set these in advance
 			e->clientEntityCall(client);
 			e->setWitness(Witness::createPoolObject());
+			e->pWitness()->clientFeatures(clientFeatures);
 		}
 
 		// Baseapp may not be initialized here, so it's possible that it is None
@@ -1085,6 +1121,7 @@ void Cellapp::onCreateCellEntityFromBaseapp(Network::Channel* pChannel, KBEngine
 	COMPONENT_ID componentID;
 	SPACE_ID spaceID = 1;
 	bool hasClient;
+	uint32 clientFeatures;
 	bool inRescore = false;
 
 	s >> createToEntityID;
@@ -1092,6 +1129,7 @@ void Cellapp::onCreateCellEntityFromBaseapp(Network::Channel* pChannel, KBEngine
 	s >> entityID;
 	s >> componentID;
 	s >> hasClient;
+	s >> clientFeatures;
 	s >> inRescore;
 
 	// Baseapp may not be initialized here, so it's possible that it is None
@@ -1104,7 +1142,7 @@ void Cellapp::onCreateCellEntityFromBaseapp(Network::Channel* pChannel, KBEngine
 		Network::Bundle* pBundle = Network::Bundle::createPoolObject();
 		ForwardItem* pFI = new ForwardItem();
 		pFI->pHandler = new FMH_Baseapp_onEntityGetCellFrom_onCreateCellEntityFromBaseapp(entityType, createToEntityID, 
-			entityID, pCellData, hasClient, inRescore, componentID, spaceID);
+			entityID, pCellData, hasClient, clientFeatures, inRescore, componentID, spaceID);
 
 		pFI->pBundle = pBundle;
 		(*pBundle).newMessage(BaseappInterface::onEntityGetCell);
@@ -1118,14 +1156,14 @@ void Cellapp::onCreateCellEntityFromBaseapp(Network::Channel* pChannel, KBEngine
 	}
 
 	_onCreateCellEntityFromBaseapp(entityType, createToEntityID, entityID, 
-					&s, hasClient, inRescore, componentID, spaceID);
+					&s, hasClient, clientFeatures, inRescore, componentID, spaceID);
 
 }
 
 //-------------------------------------------------------------------------------------
 void Cellapp::_onCreateCellEntityFromBaseapp(std::string& entityType, ENTITY_ID createToEntityID, ENTITY_ID entityID,
-											MemoryStream* pCellData, bool hasClient, bool inRescore, COMPONENT_ID componentID, 
-											SPACE_ID spaceID)
+											MemoryStream* pCellData, bool hasClient, uint32 clientFeatures, bool inRescore, 
+											COMPONENT_ID componentID, SPACE_ID spaceID)
 {
 	// Note: If it can't find the component, it's because a message caching decision has been made in onCreateCellEntityFromBaseapp
 	Components::ComponentInfos* cinfos = Components::getSingleton().findComponent(BASEAPP_TYPE, componentID);
@@ -1192,6 +1230,7 @@ void Cellapp::_onCreateCellEntityFromBaseapp(std::string& entityType, ENTITY_ID
 			// In order to enable the entity.__init__ to be able to modify attributes immediately broadcast to the client we need to set these in advance
 			e->clientEntityCall(client);
 			e->setWitness(Witness::createPoolObject());
+			e->pWitness()->clientFeatures(clientFeatures);
 		}
 
 		space->addEntity(e);
@@ -1199,6 +1238,7 @@ void Cellapp::_onCreateCellEntityFromBaseapp(std::string& entityType, ENTITY_ID
 		if(!inRescore)
 		{
 			e->initializeScript();
+			e->attachPropertyPatches();
 		}
 		else
 		{
@@ -1513,6 +1553,105 @@ void Cellapp::onUpdateGhostPropertys(Network::Channel* pChannel, KBEngine::Memor
 	entity->onUpdateGhostPropertys(s);
 }
 
+//-------------------------------------------------------------------------------------
+void Cellapp::onUpdateGhostPropertyPatch(Network::Channel* pChannel, KBEngine::MemoryStream& s)
+{
+	ENTITY_ID entityID;
+	
+	s >> entityID;
+
+	Entity* entity = findEntity(entityID);
+	if(entity == NULL)
+	{
+		GhostManager* gm = Cellapp::getSingleton().pGhostManager();
+		if(gm)
+		{
+			COMPONENT_ID targetCell = gm->getRoute(entityID);
+			if(targetCell > 0)
+			{
+				Network::Bundle* pForwardBundle = gm->createSendBundle(targetCell);
+				(*pForwardBundle).newMessage(CellappInterface::onUpdateGhostPropertyPatch);
+				(*pForwardBundle) << entityID;
+				pForwardBundle->append(s);
+
+				gm->pushRouteMessage(entityID, targetCell, pForwardBundle);
+				s.done();
+				return;
+			}
+		}
+
+		ERROR_MSG(fmt::format("Cellapp::onUpdateGhostPropertyPatch: not found entity({})\n", 
+			entityID));
+
+		s.done();
+		return;
+	}
+
+	entity->onUpdateGhostPropertyPatch(s);
+}
+
+//-------------------------------------------------------------------------------------
+void Cellapp::onPropertyPatch(ENTITY_ID ownerID, const PropertyDescription* pPropertyDescription, 
+	PyObject* pyRoot, MemoryStream* pPatch)
+{
+	Entity* pEntity = Cellapp::getSingleton().findEntity(ownerID);
+	if(pEntity == NULL || pEntity->isDestroyed() || !pEntity->isReal())
+		return;
+
+	// The container may no longer be the value of this property, e.g. the property was reassigned
+	PyObject* pyName = PyUnicode_InternFromString(pPropertyDescription->getName());
+	PyObject* pyValue = PyObject_GenericGetAttr(static_cast<PyObject*>(pEntity), pyName);
+	Py_DECREF(pyName);
+
+	if(pyValue == NULL)
+	{
+		PyErr_Clear();
+		return;
+	}
+
+	Py_DECREF(pyValue);
+	if(pyValue != pyRoot)
+		return;
+
+	pEntity->onDefDataPatched(pPropertyDescription, pPatch);
+}
+
+//-------------------------------------------------------------------------------------
+void Cellapp::flushPropertyPatches()
+{
+	if(propertyPatchEntities_.empty())
+		return;
+
+	std::vector<ENTITY_ID>::iterator iter = propertyPatchEntities_.begin();
+	for(; iter != propertyPatchEntities_.end(); ++iter)
+	{
+		Entity* pEntity = findEntity((*iter));
+		if(pEntity)
+			pEntity->flushPropertyPatches();
+	}
+
+	propertyPatchEntities_.clear();
+}
+
+//-------------------------------------------------------------------------------------
+void Cellapp::applyClientMoves()
+{
+	if(clientMoveEntities_.empty())
+		return;
+
+	AUTO_SCOPED_PROFILE("clientMoves");
+
+	std::vector<ENTITY_ID>::iterator iter = clientMoveEntities_.begin();
+	for(; iter != clientMoveEntities_.end(); ++iter)
+	{
+		Entity* pEntity = findEntity((*iter));
+		if(pEntity)
+			pEntity->applyPendingClientMove();
+	}
+
+	clientMoveEntities_.clear();
+}
+
 //-------------------------------------------------------------------------------------
 void Cellapp::onRemoteRealMethodCall(Network::Channel* pChannel, KBEngine::MemoryStream& s)
 {
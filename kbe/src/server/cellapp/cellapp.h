@@ -27,6 +27,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "space_viewer.h"
 #include "updatables.h"
 #include "ghost_manager.h"
+#include "client_relay.h"
 #include "witnessed_timeout_handler.h"
 #include "server/entity_app.h"
 #include "server/forward_messagebuffer.h"
@@ -80,6 +81,8 @@ public:
 	float _getLoad() const { return getLoad(); }
 	virtual void onUpdateLoad();
 
+	virtual void onChannelDeregister(Network::Channel * pChannel);
+
 	/**  Network interface
 		Dbmgr tells the address of other baseapp or cellapp that has been started
 		Current app needs to actively establish a connection with them
@@ -147,7 +150,7 @@ public:
 	*/
 	void onCreateCellEntityFromBaseapp(Network::Channel* pChannel, KBEngine::MemoryStream& s);
 	void _onCreateCellEntityFromBaseapp(std::string& entityType, ENTITY_ID createToEntityID, ENTITY_ID entityID, 
-		MemoryStream* pCellData, bool hasClient, bool inRescore, COMPONENT_ID componentID, SPACE_ID spaceID);
+		MemoryStream* pCellData, bool hasClient, uint32 clientFeatures, bool inRescore, COMPONENT_ID componentID, SPACE_ID spaceID);
 
 	/** Network interface
 		Destroy a cellEntity
@@ -174,6 +177,11 @@ public:
 		Real entity requests to update attributes to ghost
 	*/
 	void onUpdateGhostPropertys(Network::Channel* pChannel, KBEngine::MemoryStream& s);
+
+	/** Network interface
+		Real entity requests to apply in-place container changes to ghost
+	*/
+	void onUpdateGhostPropertyPatch(Network::Channel* pChannel, KBEngine::MemoryStream& s);
 	
 	/** Network interface
 		Ghost request to call def method real entity
@@ -254,8 +262,28 @@ public:
 	void pGhostManager(GhostManager* v){ pGhostManager_ = v; }
 	GhostManager* pGhostManager() const{ return pGhostManager_; }
 
+	/**
+		Batches the messages forwarded to clients through baseapps
+	*/
+	ClientRelay& clientRelay(){ return clientRelay_; }
+
 	ArraySize spaceSize() const { return (ArraySize)Spaces::size(); }
 
+	/** 
+		Def container properties modified in place, patches are collected per entity and sent once per tick
+	*/
+	static void onPropertyPatch(ENTITY_ID ownerID, const PropertyDescription* pPropertyDescription, 
+		PyObject* pyRoot, MemoryStream* pPatch);
+
+	void addPropertyPatchEntity(ENTITY_ID entityID){ propertyPatchEntities_.push_back(entityID); }
+	void flushPropertyPatches();
+
+	/** 
+		Client movements received since the last tick, each entity moves once at the start of the tick
+	*/
+	void addClientMoveEntity(ENTITY_ID entityID){ clientMoveEntities_.push_back(entityID); }
+	void applyClientMoves();
+
 	/** 
 		Raycast
 	*/
@@ -283,12 +311,20 @@ protected:
 	WitnessedTimeoutHandler	*			pWitnessedTimeoutHandler_;
 
 	GhostManager*						pGhostManager_;
+
+	ClientRelay							clientRelay_;
 	
 	// APP flags
 	uint32								flags_;
 
 	// View space through tools
 	SpaceViewers						spaceViewers_;
+
+	// Entities that have container property patches waiting to be sent in this tick
+	std::vector<ENTITY_ID>				propertyPatchEntities_;
+
+	// Entities with a buffered client movement
+	std::vector<ENTITY_ID>				clientMoveEntities_;
 };
 
 }
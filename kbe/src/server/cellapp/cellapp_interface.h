@@ -149,6 +149,13 @@ NETWORK_INTERFACE_DECLARE_BEGIN(CellappInterface)
 	// Request to shut down the server
 	CELLAPP_MESSAGE_DECLARE_STREAM(reqCloseServer,									NETWORK_VARIABLE_MESSAGE)
 
+	// Co-located app offers a shared-memory channel
+	CELLAPP_MESSAGE_DECLARE_STREAM(onShmChannelOffer,								NETWORK_VARIABLE_MESSAGE)
+
+	// Shared-memory channel handshake marker
+	CELLAPP_MESSAGE_DECLARE_ARGS1(onShmChannelReady,								NETWORK_FIXED_MESSAGE,
+									uint8,											success)
+
 	// Request for watcher data
 	CELLAPP_MESSAGE_DECLARE_STREAM(queryWatcher,									NETWORK_VARIABLE_MESSAGE)
 
@@ -174,6 +181,9 @@ NETWORK_INTERFACE_DECLARE_BEGIN(CellappInterface)
 	// Real entity requests to update volatile data to ghost
 	CELLAPP_MESSAGE_DECLARE_STREAM(onUpdateGhostVolatileData,						NETWORK_VARIABLE_MESSAGE)
 
+	// Real entity requests to apply in-place container changes to ghost
+	CELLAPP_MESSAGE_DECLARE_STREAM(onUpdateGhostPropertyPatch,						NETWORK_VARIABLE_MESSAGE)
+
 	// Request to kill the current app
 	CELLAPP_MESSAGE_DECLARE_STREAM(reqKillServer,									NETWORK_VARIABLE_MESSAGE)
 
@@ -207,7 +217,8 @@ NETWORK_INTERFACE_DECLARE_BEGIN(CellappInterface)
 									float,											z)
 
 	// The entity is bound to an observer (client)
-	ENTITY_MESSAGE_DECLARE_ARGS0(onGetWitnessFromBase,								NETWORK_FIXED_MESSAGE)
+	ENTITY_MESSAGE_DECLARE_ARGS1(onGetWitnessFromBase,								NETWORK_FIXED_MESSAGE,
+									uint32,											clientFeatures)
 
 	// Entity loses an observer (client)
 	ENTITY_MESSAGE_DECLARE_ARGS0(onLoseWitness,										NETWORK_FIXED_MESSAGE)
@@ -0,0 +1,191 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "client_relay.h"
+#include "network/bundle.h"
+#include "network/channel.h"
+#include "network/packet.h"
+#include "server/serverconfig.h"
+
+#include "../../server/baseapp/baseapp_interface.h"
+
+namespace KBEngine{	
+
+//-------------------------------------------------------------------------------------
+ClientRelay::ClientRelay():
+batches_(),
+buffer_(),
+numBatches_(0),
+numRecords_(0),
+numBytes_(0),
+numFallbacks_(0)
+{
+}
+
+//-------------------------------------------------------------------------------------
+ClientRelay::~ClientRelay()
+{
+	batches_.clear();
+}
+
+//-------------------------------------------------------------------------------------
+void ClientRelay::onChannelDeregister(Network::Channel* pChannel)
+{
+	batches_.erase(pChannel);
+}
+
+//-------------------------------------------------------------------------------------
+void ClientRelay::sendFallback(Network::Channel* pChannel, Network::Bundle* pBundle)
+{
+	++numFallbacks_;
+	pChannel->send(pBundle);
+}
+
+//-------------------------------------------------------------------------------------
+void ClientRelay::send(Network::Channel* pChannel, Network::Bundle* pBundle)
+{
+	const size_t headerSize = NETWORK_MESSAGE_ID_SIZE + NETWORK_MESSAGE_LENGTH_SIZE;
+	const size_t msgLength = pBundle->currMsgLength();
+
+	if(!g_kbeSrvConfig.getCellApp().clientRelay_batch)
+	{
+		pChannel->send(pBundle);
+		return;
+	}
+
+	// Only a forwardMessageToClientFromCellapp that is still open at the tail of the bundle
+	// can be moved, anything else is sent as it is
+	if(pChannel->isDestroyed() || pChannel->isCondemn() ||
+		pBundle->messageID() != BaseappInterface::forwardMessageToClientFromCellapp.msgID ||
+		msgLength <= headerSize + sizeof(ENTITY_ID))
+	{
+		sendFallback(pChannel, pBundle);
+		return;
+	}
+
+	// A record is [ENTITY_ID][uint32 size][client messages]
+	const size_t recordSize = msgLength - headerSize + sizeof(uint32);
+	const size_t maxBytes = std::min<size_t>(g_kbeSrvConfig.getCellApp().clientRelay_maxBytes, 
+		NETWORK_MESSAGE_MAX_SIZE - 1);
+
+	if(recordSize > maxBytes || !extractMessage(pBundle))
+	{
+		sendFallback(pChannel, pBundle);
+		return;
+	}
+
+	// Whatever was queued in front of the message stays in front of the batch
+	if(pBundle->empty())
+		Network::Bundle::reclaimPoolObject(pBundle);
+	else
+		pChannel->pushBundle(pBundle);
+
+	Network::Bundle* pBatch = pChannel->createSendBundle();
+	BatchState& state = batches_[pChannel];
+
+	if(!canAppend(pChannel, pBatch, state, recordSize))
+	{
+		pBatch->newMessage(BaseappInterface::forwardMessagesToClientsFromCellapp);
+		state.pBundle = pBatch;
+		state.pLengthPacket = pBatch->pCurrPacket();
+		state.lengthPos = pBatch->currMsgLengthPos();
+		state.length = 0;
+		++numBatches_;
+	}
+
+	const uint32 size = (uint32)(buffer_.size() - sizeof(ENTITY_ID));
+	pBatch->append(&buffer_[0], sizeof(ENTITY_ID));
+	(*pBatch) << size;
+	pBatch->append(&buffer_[sizeof(ENTITY_ID)], (int)size);
+
+	state.length += (uint32)recordSize;
+
+	Network::MessageLength msgLen = (Network::MessageLength)state.length;
+	KBEngine::EndianConvert(msgLen);
+	memcpy(&state.pLengthPacket->data()[state.lengthPos], (uint8*)&msgLen, NETWORK_MESSAGE_LENGTH_SIZE);
+
+	pBatch->finiMessage(true);
+	pChannel->pushBundle(pBatch);
+	pChannel->delayedSend();
+
+	state.pLastPacket = pBatch->packets().back();
+	state.lastPacketWpos = state.pLastPacket->wpos();
+	state.numMessages = pBatch->numMessages();
+	state.numBytesSent = pChannel->numBytesSent();
+
+	++numRecords_;
+	numBytes_ += recordSize;
+}
+
+//-------------------------------------------------------------------------------------
+bool ClientRelay::canAppend(Network::Channel* pChannel, Network::Bundle* pBundle, 
+	const BatchState& state, size_t recordSize) const
+{
+	if(state.pBundle != pBundle || pChannel->sending())
+		return false;
+
+	// Nothing was sent or written to the bundle since the last record
+	if(pBundle->pCurrPacket() != state.pLastPacket || 
+		state.pLastPacket->wpos() != state.lastPacketWpos ||
+		pBundle->numMessages() != state.numMessages ||
+		pChannel->numBytesSent() != state.numBytesSent)
+		return false;
+
+	const size_t maxBytes = std::min<size_t>(g_kbeSrvConfig.getCellApp().clientRelay_maxBytes, 
+		NETWORK_MESSAGE_MAX_SIZE - 1);
+
+	return state.length + recordSize <= maxBytes;
+}
+
+//-------------------------------------------------------------------------------------
+bool ClientRelay::extractMessage(Network::Bundle* pBundle)
+{
+	const size_t headerSize = NETWORK_MESSAGE_ID_SIZE + NETWORK_MESSAGE_LENGTH_SIZE;
+	const size_t msgLength = pBundle->currMsgLength();
+	
+	size_t remain = msgLength - headerSize;
+	buffer_.resize(remain);
+
+	// The message is the tail of the bundle, copy it backwards packet by packet
+	Network::Packet* pPacket = pBundle->pCurrPacket();
+	Network::Bundle::Packets& packets = pBundle->packets();
+	Network::Bundle::Packets::reverse_iterator iter = packets.rbegin();
+
+	while(remain > 0)
+	{
+		if(pPacket == NULL)
+		{
+			if(iter == packets.rend())
+				return false;
+
+			pPacket = (*iter++);
+		}
+
+		size_t n = std::min(remain, pPacket->wpos());
+		remain -= n;
+		memcpy(&buffer_[remain], pPacket->data() + pPacket->wpos() - n, n);
+		pPacket = NULL;
+	}
+
+	pBundle->revokeMessage((int32)msgLength);
+	return true;
+}
+
+}
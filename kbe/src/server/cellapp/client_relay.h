@@ -0,0 +1,102 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KBE_CLIENT_RELAY_H
+#define KBE_CLIENT_RELAY_H
+
+// common include
+#include "helper/debug_helper.h"
+#include "common/common.h"
+
+namespace KBEngine{
+
+namespace Network
+{
+class Bundle;
+class Channel;
+class Packet;
+}
+
+/*
+	Merges the client messages a cellapp sends to proxies on the same baseapp into
+	forwardMessagesToClientsFromCellapp batches, the baseapp parses a batch once and
+	splices each record into the client channels.
+
+	The batch is built inside the channel's send queue itself, so messages that are
+	not relayed keep their order relative to the relayed ones. A record is only
+	appended to the pending batch if nothing else was written to the channel since,
+	otherwise a new batch is started.
+*/
+class ClientRelay
+{
+public:
+	ClientRelay();
+	~ClientRelay();
+
+	/**
+		Sends a bundle destined for a client through a baseapp channel.
+		If the bundle ends with a forwardMessageToClientFromCellapp message it is moved
+		into the batch, otherwise the bundle is sent as before.
+	*/
+	void send(Network::Channel* pChannel, Network::Bundle* pBundle);
+
+	void onChannelDeregister(Network::Channel* pChannel);
+
+	uint64 numBatches() const { return numBatches_; }
+	uint64 numRecords() const { return numRecords_; }
+	uint64 numBytes() const { return numBytes_; }
+	uint64 numFallbacks() const { return numFallbacks_; }
+
+private:
+	struct BatchState
+	{
+		Network::Bundle* pBundle;
+		Network::Packet* pLengthPacket;
+		size_t lengthPos;
+		Network::Packet* pLastPacket;
+		size_t lastPacketWpos;
+		int32 numMessages;
+		uint32 numBytesSent;
+		uint32 length;
+	};
+
+	bool extractMessage(Network::Bundle* pBundle);
+
+	bool canAppend(Network::Channel* pChannel, Network::Bundle* pBundle, 
+		const BatchState& state, size_t recordSize) const;
+
+	void sendFallback(Network::Channel* pChannel, Network::Bundle* pBundle);
+
+private:
+	// The batch waiting in the send queue of each baseapp channel
+	std::map<Network::Channel*, BatchState> batches_;
+
+	// ENTITY_ID + client messages of the message being moved into a batch
+	std::vector<uint8> buffer_;
+
+	uint64 numBatches_;
+	uint64 numRecords_;
+	uint64 numBytes_;
+	uint64 numFallbacks_;
+};
+
+}
+
+#endif // KBE_CLIENT_RELAY_H
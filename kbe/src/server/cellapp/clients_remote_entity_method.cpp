@@ -86,7 +86,7 @@ PyObject* ClientsRemoteEntityMethod::callmethod(PyObject* args, PyObject* kwds)
 		S_Return;
 	}
 	
-	const std::list<ENTITY_ID>& entities = pEntity->witnesses();
+	const WitnessedSlots& witnesses = pEntity->witnesses();
 
 	if(otherClients_)
 	{
@@ -167,12 +167,10 @@ PyObject* ClientsRemoteEntityMethod::callmethod(PyObject* args, PyObject* kwds)
 			pEntity->pWitness()->sendToClient(ClientInterface::onRemoteMethodCall, pSendBundle);
 		}
 
-		// Broadcast to others
-		std::list<ENTITY_ID>::const_iterator iter = entities.begin();
-		for(; iter != entities.end(); ++iter)
+		// Broadcast to others, only the witnesses whose client already knows this entity are visited
+		WITNESSED_SLOTS_FOREACH_IN_CLIENT(witnesses, pViewEntity)
 		{
-			Entity* pViewEntity = Cellapp::getSingleton().findEntity((*iter));
-			if(pViewEntity == NULL || pViewEntity->pWitness() == NULL || pViewEntity->isDestroyed())
+			if(pViewEntity->pWitness() == NULL || pViewEntity->isDestroyed())
 				continue;
 			
 			EntityCall* entityCall = pViewEntity->clientEntityCall();
@@ -182,11 +180,6 @@ PyObject* ClientsRemoteEntityMethod::callmethod(PyObject* args, PyObject* kwds)
 			Network::Channel* pChannel = entityCall->getChannel();
 			if(pChannel == NULL)
 				continue;
-
-			// This possibility exists, for example, the data comes from createWitnessFromStream()
-			// Or if their own entity is not yet created on the target client
-			if (!pViewEntity->pWitness()->entityInView(pEntity->id()))
-				continue;
 			
 			Network::Bundle* pSendBundle = pChannel->createSendBundle();
 			NETWORK_ENTITY_MESSAGE_FORWARD_CLIENT_BEGIN(pViewEntity->id(), (*pSendBundle));
@@ -247,6 +240,7 @@ PyObject* ClientsRemoteEntityMethod::callmethod(PyObject* args, PyObject* kwds)
 
 			pViewEntity->pWitness()->sendToClient(ClientInterface::onRemoteMethodCallOptimized, pSendBundle);
 		}
+		WITNESSED_SLOTS_FOREACH_END
 
 		MemoryStream::reclaimPoolObject(mstream);
 	}
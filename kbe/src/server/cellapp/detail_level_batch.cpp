@@ -0,0 +1,159 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "detail_level_batch.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define KBE_DETAIL_LEVEL_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define KBE_DETAIL_LEVEL_SSE2
+#endif
+
+namespace KBEngine{	
+
+//-------------------------------------------------------------------------------------
+DetailLevelBatch::DetailLevelBatch():
+entities_(),
+xs_(),
+ys_(),
+zs_(),
+levelMasks_(),
+size_(0)
+{
+}
+
+//-------------------------------------------------------------------------------------
+DetailLevelBatch::~DetailLevelBatch()
+{
+}
+
+//-------------------------------------------------------------------------------------
+void DetailLevelBatch::clear()
+{
+	size_ = 0;
+}
+
+//-------------------------------------------------------------------------------------
+void DetailLevelBatch::grow()
+{
+	size_t capacity = entities_.size() > 0 ? entities_.size() * 2 : 64;
+
+	entities_.resize(capacity);
+	xs_.resize(capacity);
+	ys_.resize(capacity);
+	zs_.resize(capacity);
+	levelMasks_.resize(capacity);
+}
+
+//-------------------------------------------------------------------------------------
+void DetailLevelBatch::classifyScalar(size_t start, size_t end, float ox, float oy, float oz, const float* radiusSq)
+{
+	for (size_t i = start; i < end; ++i)
+	{
+		float dx = xs_[i] - ox;
+		float dy = ys_[i] - oy;
+		float dz = zs_[i] - oz;
+		float distSq = dx * dx + dy * dy + dz * dz;
+
+		levelMasks_[i] = (uint8)((distSq <= radiusSq[0] ? 1 : 0) | 
+			(distSq <= radiusSq[1] ? 2 : 0) | (distSq <= radiusSq[2] ? 4 : 0));
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void DetailLevelBatch::classify(const Position3D& origin, const DetailLevel& detailLevel)
+{
+	size_t count = size_;
+
+	if (count == 0)
+		return;
+
+	// Squaring FLT_MAX gives +inf, which still contains every distance
+	float radiusSq[3];
+	for (int i = 0; i < 3; ++i)
+		radiusSq[i] = detailLevel.level[i].radius * detailLevel.level[i].radius;
+
+	size_t i = 0;
+
+#if defined(KBE_DETAIL_LEVEL_AVX2)
+	const __m256 ox = _mm256_set1_ps(origin.x);
+	const __m256 oy = _mm256_set1_ps(origin.y);
+	const __m256 oz = _mm256_set1_ps(origin.z);
+	const __m256 r0 = _mm256_set1_ps(radiusSq[0]);
+	const __m256 r1 = _mm256_set1_ps(radiusSq[1]);
+	const __m256 r2 = _mm256_set1_ps(radiusSq[2]);
+	const __m256i bit0 = _mm256_set1_epi32(1);
+	const __m256i bit1 = _mm256_set1_epi32(2);
+	const __m256i bit2 = _mm256_set1_epi32(4);
+
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 dx = _mm256_sub_ps(_mm256_loadu_ps(&xs_[i]), ox);
+		__m256 dy = _mm256_sub_ps(_mm256_loadu_ps(&ys_[i]), oy);
+		__m256 dz = _mm256_sub_ps(_mm256_loadu_ps(&zs_[i]), oz);
+		__m256 distSq = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+
+		__m256i mask = _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(distSq, r0, _CMP_LE_OQ)), bit0);
+		mask = _mm256_or_si256(mask, _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(distSq, r1, _CMP_LE_OQ)), bit1));
+		mask = _mm256_or_si256(mask, _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(distSq, r2, _CMP_LE_OQ)), bit2));
+
+		// 8 x int32 -> 8 x uint8
+		__m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(mask), _mm256_extracti128_si256(mask, 1));
+		packed = _mm_packus_epi16(packed, packed);
+		_mm_storel_epi64((__m128i*)&levelMasks_[i], packed);
+	}
+#elif defined(KBE_DETAIL_LEVEL_SSE2)
+	const __m128 ox = _mm_set1_ps(origin.x);
+	const __m128 oy = _mm_set1_ps(origin.y);
+	const __m128 oz = _mm_set1_ps(origin.z);
+	const __m128 r0 = _mm_set1_ps(radiusSq[0]);
+	const __m128 r1 = _mm_set1_ps(radiusSq[1]);
+	const __m128 r2 = _mm_set1_ps(radiusSq[2]);
+	const __m128i bit0 = _mm_set1_epi32(1);
+	const __m128i bit1 = _mm_set1_epi32(2);
+	const __m128i bit2 = _mm_set1_epi32(4);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 dx = _mm_sub_ps(_mm_loadu_ps(&xs_[i]), ox);
+		__m128 dy = _mm_sub_ps(_mm_loadu_ps(&ys_[i]), oy);
+		__m128 dz = _mm_sub_ps(_mm_loadu_ps(&zs_[i]), oz);
+		__m128 distSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+		__m128i mask = _mm_and_si128(_mm_castps_si128(_mm_cmple_ps(distSq, r0)), bit0);
+		mask = _mm_or_si128(mask, _mm_and_si128(_mm_castps_si128(_mm_cmple_ps(distSq, r1)), bit1));
+		mask = _mm_or_si128(mask, _mm_and_si128(_mm_castps_si128(_mm_cmple_ps(distSq, r2)), bit2));
+
+		// 4 x int32 -> 4 x uint8
+		__m128i packed = _mm_packs_epi32(mask, mask);
+		packed = _mm_packus_epi16(packed, packed);
+
+		int32 v = _mm_cvtsi128_si32(packed);
+		memcpy(&levelMasks_[i], &v, sizeof(v));
+	}
+#endif
+
+	classifyScalar(i, count, origin.x, origin.y, origin.z, radiusSq);
+}
+
+//-------------------------------------------------------------------------------------
+}
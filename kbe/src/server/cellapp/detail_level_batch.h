@@ -0,0 +1,83 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KBE_DETAIL_LEVEL_BATCH_H
+#define KBE_DETAIL_LEVEL_BATCH_H
+
+#include "common/common.h"
+#include "math/math.h"
+#include "entitydef/detaillevel.h"
+
+namespace KBEngine{
+
+class Entity;
+
+/*
+	Classifies a batch of observers into the detail levels of an entity in one pass.
+	Observer positions are gathered into structure-of-arrays buffers, then squared distances
+	are compared against the squared level radii 8 (AVX2), 4 (SSE2) or 1 (scalar) lanes at a time.
+	The result for each observer is a mask with bit N set if it is within level[N].
+
+	Not used by the cellapp yet: gathering positions from the witness slots costs more than
+	the per-pair test it saves (see tools/bench detail_level), the property broadcasts keep
+	the per-pair check until the bench shows a win on the real data layout.
+*/
+class DetailLevelBatch
+{
+public:
+	DetailLevelBatch();
+	~DetailLevelBatch();
+
+	void clear();
+
+	void add(Entity* pEntity, const Position3D& pos)
+	{
+		if (size_ == entities_.size())
+			grow();
+
+		entities_[size_] = pEntity;
+		xs_[size_] = pos.x;
+		ys_[size_] = pos.y;
+		zs_[size_] = pos.z;
+		++size_;
+	}
+
+	size_t size() const { return size_; }
+	Entity* entity(size_t idx) const { return entities_[idx]; }
+
+	void classify(const Position3D& origin, const DetailLevel& detailLevel);
+
+	bool inLevel(size_t idx, int level) const { return (levelMasks_[idx] & (1 << level)) != 0; }
+
+private:
+	void grow();
+	void classifyScalar(size_t start, size_t end, float ox, float oy, float oz, const float* radiusSq);
+
+	std::vector<Entity*> entities_;
+	std::vector<float> xs_, ys_, zs_;
+	std::vector<uint8> levelMasks_;
+
+	// The buffers only grow, clear() just resets size_
+	size_t size_;
+};
+
+}
+
+#endif // KBE_DETAIL_LEVEL_BATCH_H
@@ -31,6 +31,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "real_entity_method.h"
 #include "entity_coordinate_node.h"
 #include "proximity_controller.h"
+#include "proximity_grid.h"
 #include "move_controller.h"	
 #include "moveto_point_handler.h"	
 #include "moveto_entity_handler.h"	
@@ -39,6 +40,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "turn_controller.h"
 #include "pyscript/py_gc.h"
 #include "entitydef/volatileinfo.h"
+#include "entitydef/property_patch.h"
 #include "entitydef/entity_call.h"
 #include "entitydef/entity_component.h"
 #include "network/channel.h"	
@@ -77,6 +79,9 @@ SCRIPT_METHOD_DECLARE("moveToPoint",				pyMoveToPoint,					METH_VARARGS,				0)
 SCRIPT_METHOD_DECLARE("moveToEntity",				pyMoveToEntity,					METH_VARARGS,				0)
 SCRIPT_METHOD_DECLARE("accelerate",					pyAccelerate,					METH_VARARGS,				0)
 SCRIPT_METHOD_DECLARE("entitiesInRange",			pyEntitiesInRange,				METH_VARARGS,				0)
+SCRIPT_METHOD_DECLARE("entitiesInBox",				pyEntitiesInBox,				METH_VARARGS,				0)
+SCRIPT_METHOD_DECLARE("entitiesInCone",				pyEntitiesInCone,				METH_VARARGS,				0)
+SCRIPT_METHOD_DECLARE("nearestEntities",			pyNearestEntities,				METH_VARARGS,				0)
 SCRIPT_METHOD_DECLARE("entitiesInView",				pyEntitiesInView,				METH_VARARGS,				0)
 SCRIPT_METHOD_DECLARE("teleport",					pyTeleport,						METH_VARARGS,				0)
 SCRIPT_METHOD_DECLARE("destroySpace",				pyDestroySpace,					METH_VARARGS,				0)
@@ -138,7 +143,14 @@ pyPositionChangedCallback_(),
 pyDirectionChangedCallback_(),
 layer_(0),
 isDirty_(true),
-pCustomVolatileinfo_(NULL)
+pCustomVolatileinfo_(NULL),
+pPropertyPatches_(NULL),
+hasPendingPropertyPatches_(false),
+pendingClientPos_(),
+pendingClientDir_(),
+pendingClientSpaceID_(0),
+pendingClientMoves_(0),
+hasPendingClientMove_(false)
 {
 	pyPositionChangedCallback_ = std::tr1::bind(&Entity::onPyPositionChanged, this);
 	pyDirectionChangedCallback_ = std::tr1::bind(&Entity::onPyDirectionChanged, this);
@@ -162,6 +174,18 @@ Entity::~Entity()
 
 	S_RELEASE(pCustomVolatileinfo_);
 
+	if(pPropertyPatches_)
+	{
+		std::vector<PropertyPatchState>::iterator iter = pPropertyPatches_->begin();
+		for(; iter != pPropertyPatches_->end(); ++iter)
+		{
+			if(iter->pPatch)
+				MemoryStream::reclaimPoolObject(iter->pPatch);
+		}
+
+		SAFE_RELEASE(pPropertyPatches_);
+	}
+
 	S_RELEASE(clientEntityCall_);
 	S_RELEASE(baseEntityCall_);
 	S_RELEASE(allClients_);
@@ -263,8 +287,11 @@ void Entity::onDestroy(bool callScript)
 		ERROR_MSG(fmt::format("{}::onDestroy(): id={}, witnesses_count({}/{}) != 0, isReal={}, spaceID={}, position=({},{},{})\n", 
 			scriptName(), id(), witnesses_count_, witnesses_.size(), isReal(), this->spaceID(), position().x, position().y, position().z));
 
-		std::list<ENTITY_ID> witnesses_copy = witnesses_;
-		std::list<ENTITY_ID>::iterator it = witnesses_copy.begin();
+		std::vector<ENTITY_ID> witnesses_copy;
+		for (size_t i = 0; i < witnesses_.size(); ++i)
+			witnesses_copy.push_back(witnesses_.id(i));
+
+		std::vector<ENTITY_ID>::iterator it = witnesses_copy.begin();
 		for (; it != witnesses_copy.end(); ++it)
 		{
 			Entity *ent = Cellapp::getSingleton().findEntity((*it));
@@ -667,7 +694,16 @@ PyObject* Entity::onScriptGetAttribute(PyObject* attr)
 		PropertyDescription* pPropertyDescription = const_cast<ScriptDefModule*>(pScriptModule())->findPersistentPropertyDescription(ccattr);
 		if(pPropertyDescription && (pPropertyDescription->getFlags() & ENTITY_CELL_DATA_FLAGS) > 0)
 		{
-			setDirty();
+			free(ccattr);
+			PyObject* pyValue = ScriptObject::onScriptGetAttribute(attr);
+
+			// FIXED_ARRAY and FIXED_DICT values linked to this property report their own changes through onDefDataPatched
+			PropertyOwnerLink* pLink = PropertyPatch::isEnabled() ? PropertyPatch::getLink(pyValue) : NULL;
+			if(pLink == NULL || pLink->ownerID != id() || 
+				pLink->pPropertyDescription != pPropertyDescription || pLink->pParent != NULL)
+				setDirty();
+
+			return pyValue;
 		}
 	}
 	
@@ -684,6 +720,26 @@ void Entity::onDefDataChanged(EntityComponent* pEntityComponent, const PropertyD
 
 	if(propertyDescription->isPersistent())
 		setDirty();
+
+	if(pEntityComponent == NULL && PropertyPatch::isEnabled())
+	{
+		PropertyPatch::attach(id(), propertyDescription, pyData);
+
+		// The whole value is sent now, patches collected before are no longer needed
+		if(pPropertyPatches_)
+		{
+			std::vector<PropertyPatchState>::iterator iter = pPropertyPatches_->begin();
+			for(; iter != pPropertyPatches_->end(); ++iter)
+			{
+				if(iter->pPropertyDescription == propertyDescription)
+				{
+					resetPropertyPatchState((*iter));
+					iter->flushCount = 0;
+					break;
+				}
+			}
+		}
+	}
 	
 	ENTITY_PROPERTY_UID componentPropertyUID =0;
 	int8 componentPropertyAliasID = 0;
@@ -733,11 +789,9 @@ void Entity::onDefDataChanged(EntityComponent* pEntityComponent, const PropertyD
 	{
 		DETAIL_TYPE propertyDetailLevel = propertyDescription->getDetailLevel();
 
-		std::list<ENTITY_ID>::iterator witer = witnesses_.begin();
-		for(; witer != witnesses_.end(); ++witer)
+		WITNESSED_SLOTS_FOREACH_IN_CLIENT(witnesses_, pEntity)
 		{
-			Entity* pEntity = Cellapp::getSingleton().findEntity((*witer));
-			if(pEntity == NULL || pEntity->pWitness() == NULL)
+			if(pEntity->pWitness() == NULL)
 				continue;
 
 			EntityCall* clientEntityCall = pEntity->clientEntityCall();
@@ -748,11 +802,6 @@ void Entity::onDefDataChanged(EntityComponent* pEntityComponent, const PropertyD
 			if(pChannel == NULL)
 				continue;
 
-			// It's possible that, for example, the data comes from createWitnessFromStream()
-			// Or if their own entity is not yet created on the target client
-			if(!pEntity->pWitness()->entityInView(id()))
-				continue;
-
 			const Position3D& targetPos = pEntity->position();
 			Position3D lengthPos = targetPos - basePos;
 
@@ -801,6 +850,7 @@ void Entity::onDefDataChanged(EntityComponent* pEntityComponent, const PropertyD
 				pEntity->pWitness()->sendToClient(ClientInterface::onUpdatePropertysOptimized, pSendBundle);
 			}
 		}
+		WITNESSED_SLOTS_FOREACH_END
 	}
 
 	/*
@@ -904,6 +954,315 @@ void Entity::onDefDataChanged(EntityComponent* pEntityComponent, const PropertyD
 	MemoryStream::reclaimPoolObject(mstream);
 }
 
+//-------------------------------------------------------------------------------------
+void Entity::resetPropertyPatchState(PropertyPatchState& state)
+{
+	if(state.pPatch)
+		state.pPatch->clear(false);
+
+	state.numOps = 0;
+	state.fullSync = false;
+}
+
+//-------------------------------------------------------------------------------------
+void Entity::onDefDataPatched(const PropertyDescription* propertyDescription, MemoryStream* pPatch)
+{
+	// If it's not a realentity or it's initializing, ignore it.
+	if(!isReal() || initing() || isDestroyed())
+		return;
+
+	if(propertyDescription->isPersistent())
+		setDirty();
+
+	if(pPropertyPatches_ == NULL)
+		pPropertyPatches_ = new std::vector<PropertyPatchState>();
+
+	PropertyPatchState* pState = NULL;
+
+	std::vector<PropertyPatchState>::iterator iter = pPropertyPatches_->begin();
+	for(; iter != pPropertyPatches_->end(); ++iter)
+	{
+		if(iter->pPropertyDescription == propertyDescription)
+		{
+			pState = &(*iter);
+			break;
+		}
+	}
+
+	if(pState == NULL)
+	{
+		PropertyPatchState state;
+		state.pPropertyDescription = propertyDescription;
+		state.pPatch = NULL;
+		state.numOps = 0;
+		state.flushCount = 0;
+		state.fullSync = false;
+
+		pPropertyPatches_->push_back(state);
+		pState = &pPropertyPatches_->back();
+	}
+
+	if(!pState->fullSync)
+	{
+		// Too many changes in one tick, sending the whole value is cheaper
+		if(pPatch == NULL || pState->numOps >= g_kbeSrvConfig.getCellApp().containerPatch_maxOps)
+		{
+			resetPropertyPatchState((*pState));
+			pState->fullSync = true;
+		}
+		else
+		{
+			if(pState->pPatch == NULL)
+				pState->pPatch = MemoryStream::createPoolObject();
+
+			pState->pPatch->append(pPatch->data() + pPatch->rpos(), pPatch->length());
+			++pState->numOps;
+		}
+	}
+
+	if(!hasPendingPropertyPatches_)
+	{
+		hasPendingPropertyPatches_ = true;
+		Cellapp::getSingleton().addPropertyPatchEntity(id());
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void Entity::attachPropertyPatches()
+{
+	if(!PropertyPatch::isEnabled() || !isReal())
+		return;
+
+	ScriptDefModule::PROPERTYDESCRIPTION_MAP& propertyDescrs = pScriptModule_->getCellPropertyDescriptions();
+	ScriptDefModule::PROPERTYDESCRIPTION_MAP::iterator iter = propertyDescrs.begin();
+	for(; iter != propertyDescrs.end(); ++iter)
+	{
+		PropertyDescription* pPropertyDescription = iter->second;
+		if((pPropertyDescription->getFlags() & 
+			(ENTITY_BROADCAST_CELL_FLAGS | ENTITY_BROADCAST_OTHER_CLIENT_FLAGS | ENTITY_BROADCAST_OWN_CLIENT_FLAGS)) == 0)
+			continue;
+
+		DATATYPE type = pPropertyDescription->getDataType()->type();
+		if(type != DATA_TYPE_FIXEDARRAY && type != DATA_TYPE_FIXEDDICT)
+			continue;
+
+		// Bypass onScriptGetAttribute, reading here must not mark the entity dirty
+		PyObject* pyName = PyUnicode_FromString(pPropertyDescription->getName());
+		PyObject* pyValue = PyObject_GenericGetAttr(static_cast<PyObject*>(this), pyName);
+		Py_DECREF(pyName);
+
+		if(pyValue == NULL)
+		{
+			PyErr_Clear();
+			continue;
+		}
+
+		PropertyPatch::attach(id(), pPropertyDescription, pyValue);
+		Py_DECREF(pyValue);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void Entity::flushPropertyPatches()
+{
+	hasPendingPropertyPatches_ = false;
+
+	if(pPropertyPatches_ == NULL)
+		return;
+
+	const bool sendToClients = g_kbeSrvConfig.getCellApp().containerPatch_clients;
+	const uint16 fullSyncInterval = g_kbeSrvConfig.getCellApp().containerPatch_fullSyncInterval;
+
+	std::vector<PropertyPatchState>::iterator iter = pPropertyPatches_->begin();
+	for(; iter != pPropertyPatches_->end(); ++iter)
+	{
+		PropertyPatchState& state = (*iter);
+		if(!state.fullSync && state.numOps == 0)
+			continue;
+
+		if(!isReal() || isDestroyed())
+		{
+			resetPropertyPatchState(state);
+			continue;
+		}
+
+		const PropertyDescription* propertyDescription = state.pPropertyDescription;
+		uint32 flags = propertyDescription->getFlags();
+
+		bool fullSync = state.fullSync;
+
+		// Periodically resend the whole value to correct any drift
+		if(!fullSync && fullSyncInterval > 0 && ++state.flushCount >= fullSyncInterval)
+			fullSync = true;
+
+		// Clients do not understand patches
+		if(!fullSync && !sendToClients && 
+			(flags & (ENTITY_BROADCAST_OTHER_CLIENT_FLAGS | ENTITY_BROADCAST_OWN_CLIENT_FLAGS)) > 0)
+			fullSync = true;
+
+		if(fullSync)
+		{
+			PyObject* pyName = PyUnicode_InternFromString(propertyDescription->getName());
+			PyObject* pyValue = PyObject_GenericGetAttr(static_cast<PyObject*>(this), pyName);
+			Py_DECREF(pyName);
+
+			if(pyValue == NULL)
+			{
+				SCRIPT_ERROR_CHECK();
+				resetPropertyPatchState(state);
+				continue;
+			}
+
+			// Resets the state of this property
+			onDefDataChanged(NULL, propertyDescription, pyValue);
+			Py_DECREF(pyValue);
+			continue;
+		}
+
+		if((flags & ENTITY_BROADCAST_CELL_FLAGS) > 0 && hasGhost())
+		{
+			GhostManager* gm = Cellapp::getSingleton().pGhostManager();
+			if(gm)
+			{
+				Network::Bundle* pForwardBundle = gm->createSendBundle(ghostCell());
+				(*pForwardBundle).newMessage(CellappInterface::onUpdateGhostPropertyPatch);
+				(*pForwardBundle) << id();
+				(*pForwardBundle) << propertyDescription->getUType();
+				(*pForwardBundle) << state.numOps;
+
+				pForwardBundle->append(*state.pPatch);
+
+				// Record the amount of data generated by this event
+				g_publicCellEventHistoryStats.trackEvent(scriptName(), 
+					propertyDescription->getName(), 
+					pForwardBundle->currMsgLength());
+
+				gm->pushMessage(ghostCell(), pForwardBundle);
+			}
+		}
+
+		if((flags & (ENTITY_BROADCAST_OTHER_CLIENT_FLAGS | ENTITY_BROADCAST_OWN_CLIENT_FLAGS)) > 0)
+			sendPropertyPatchToClients(propertyDescription, state.numOps, state.pPatch);
+
+		resetPropertyPatchState(state);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void Entity::sendPropertyPatchToClients(const PropertyDescription* propertyDescription, 
+	uint16 numOps, MemoryStream* pPatch)
+{
+	uint32 flags = propertyDescription->getFlags();
+	const Position3D& basePos = this->position(); 
+
+	if((flags & ENTITY_BROADCAST_OTHER_CLIENT_FLAGS) > 0)
+	{
+		DETAIL_TYPE propertyDetailLevel = propertyDescription->getDetailLevel();
+
+		WITNESSED_SLOTS_FOREACH_IN_CLIENT(witnesses_, pEntity)
+		{
+			if(pEntity->pWitness() == NULL)
+				continue;
+
+			EntityCall* clientEntityCall = pEntity->clientEntityCall();
+			if(clientEntityCall == NULL)
+				continue;
+
+			Network::Channel* pChannel = clientEntityCall->getChannel();
+			if(pChannel == NULL)
+				continue;
+
+			const Position3D& targetPos = pEntity->position();
+			Position3D lengthPos = targetPos - basePos;
+
+			// Clients outside the detail level do not hold this property, 
+			// it is sent in full when they get close again
+			if(!pScriptModule_->getDetailLevel().level[propertyDetailLevel].inLevel(lengthPos.length()))
+				continue;
+
+			Network::Bundle* pSendBundle = pChannel->createSendBundle();
+			NETWORK_ENTITY_MESSAGE_FORWARD_CLIENT_BEGIN(pEntity->id(), (*pSendBundle));
+			
+			int ialiasID = -1;
+			const Network::MessageHandler& msgHandler = pEntity->pWitness()->getViewEntityMessageHandler(ClientInterface::onUpdatePropertyPatch, 
+				ClientInterface::onUpdatePropertyPatchOptimized, id(), ialiasID);
+			
+			ENTITY_MESSAGE_FORWARD_CLIENT_BEGIN(pSendBundle, msgHandler, viewEntityMessage);
+			
+			if(ialiasID != -1)
+				(*pSendBundle) << (uint8)ialiasID;
+			else
+				(*pSendBundle) << id();
+			
+			if (pScriptModule_->usePropertyDescrAlias())
+			{
+				(*pSendBundle) << (uint8)0;
+				(*pSendBundle) << propertyDescription->aliasIDAsUint8();
+			}
+			else
+			{
+				(*pSendBundle) << (ENTITY_PROPERTY_UID)0;
+				(*pSendBundle) << propertyDescription->getUType();
+			}
+
+			(*pSendBundle) << numOps;
+			pSendBundle->append(*pPatch);
+			
+			// Record the amount of data generated by this event
+			g_publicClientEventHistoryStats.trackEvent(scriptName(), 
+				propertyDescription->getName(), 
+				pSendBundle->currMsgLength());
+
+			ENTITY_MESSAGE_FORWARD_CLIENT_END(pSendBundle, msgHandler, viewEntityMessage);
+
+			pEntity->pWitness()->sendToClient(ClientInterface::onUpdatePropertyPatchOptimized, pSendBundle);
+		}
+		WITNESSED_SLOTS_FOREACH_END
+	}
+
+	if((flags & ENTITY_BROADCAST_OWN_CLIENT_FLAGS) > 0 && clientEntityCall_ != NULL && pWitness_)
+	{
+		Network::Bundle* pSendBundle = NULL;
+		
+		Network::Channel* pChannel = pWitness_->pChannel();
+		if(!pChannel)
+			pSendBundle = Network::Bundle::createPoolObject();
+		else
+			pSendBundle = pChannel->createSendBundle();
+		
+		NETWORK_ENTITY_MESSAGE_FORWARD_CLIENT_BEGIN(id(), (*pSendBundle));
+		
+		ENTITY_MESSAGE_FORWARD_CLIENT_BEGIN(pSendBundle, ClientInterface::onUpdatePropertyPatch, updatePropertyPatch);
+		(*pSendBundle) << id();
+
+		if (pScriptModule_->usePropertyDescrAlias())
+		{
+			(*pSendBundle) << (uint8)0;
+			(*pSendBundle) << propertyDescription->aliasIDAsUint8();
+		}
+		else
+		{
+			(*pSendBundle) << (ENTITY_PROPERTY_UID)0;
+			(*pSendBundle) << propertyDescription->getUType();
+		}
+
+		(*pSendBundle) << numOps;
+		pSendBundle->append(*pPatch);
+		
+		// Record the amount of data generated by this event
+		if((flags & ENTITY_BROADCAST_OTHER_CLIENT_FLAGS) <= 0)
+		{
+			g_privateClientEventHistoryStats.trackEvent(scriptName(), 
+				propertyDescription->getName(), 
+				pSendBundle->currMsgLength());
+		}
+
+		ENTITY_MESSAGE_FORWARD_CLIENT_END(pSendBundle, ClientInterface::onUpdatePropertyPatch, updatePropertyPatch);
+
+		pWitness_->sendToClient(ClientInterface::onUpdatePropertyPatch, pSendBundle);
+	}
+}
+
 //-------------------------------------------------------------------------------------
 void Entity::onRemoteMethodCall(Network::Channel* pChannel, MemoryStream& s)
 {
@@ -1423,12 +1782,12 @@ PyObject* Entity::pyIsReal()
 }
 
 //-------------------------------------------------------------------------------------
-void Entity::addWitnessed(Entity* entity)
+void Entity::addWitnessed(Entity* entity, bool inClient)
 {
 	if(Cellapp::getSingleton().pWitnessedTimeoutHandler())
 		Cellapp::getSingleton().pWitnessedTimeoutHandler()->delWitnessed(this);
 
-	witnesses_.push_back(entity->id());
+	witnesses_.add(entity->id(), entity, inClient);
 	++witnesses_count_;
 
 	/*
@@ -1501,14 +1860,13 @@ void Entity::onDelWitnessed()
 //-------------------------------------------------------------------------------------
 bool Entity::entityInWitnessed(ENTITY_ID entityID)
 {
-	std::list<ENTITY_ID>::iterator it = witnesses_.begin();
-	for (; it != witnesses_.end(); ++it)
-	{
-		if (*it == entityID)
-			return true;
-	}
+	return witnesses_.has(entityID);
+}
 
-	return false;
+//-------------------------------------------------------------------------------------
+void Entity::witnessInClient(Entity* entity, bool inClient)
+{
+	witnesses_.inClient(entity->id(), inClient);
 }
 
 //-------------------------------------------------------------------------------------
@@ -1542,7 +1900,7 @@ void Entity::restoreProximitys()
 }
 
 //-------------------------------------------------------------------------------------
-uint32 Entity::addProximity(float range_xz, float range_y, int32 userarg)
+uint32 Entity::addProximity(float range_xz, float range_y, int32 userarg, bool useSpatialHash)
 {
 	if(range_xz <= 0.0f || (CoordinateSystem::hasY && range_y <= 0.0f))
 	{
@@ -1560,8 +1918,30 @@ uint32 Entity::addProximity(float range_xz, float range_y, int32 userarg)
 		return 0;
 	}
 
+	// A wide trap would be listed in too many cells of the grid, the coordinate lists handle it better
+	if(useSpatialHash && !ProximityGrid::canHoldTrap(g_kbeSrvConfig.getCellApp().proximity_grid_cell_size, range_xz))
+	{
+		WARNING_MSG(fmt::format("Entity::addProximity: range_xz({}) covers more than {} cells of proximity_grid_cell_size({}), "
+			"using a RangeTrigger instead! entity[{}:{}]\n", range_xz, PROXIMITY_GRID_MAX_TRAP_CELLS, 
+			g_kbeSrvConfig.getCellApp().proximity_grid_cell_size, scriptName(), id()));
+
+		useSpatialHash = false;
+	}
+
 	// Put a trap in space
-	KBEShared_ptr<Controller> p( new ProximityController(this, range_xz, range_y, userarg, pControllers_->freeID()) );
+	ProximityController* pProximityController = new ProximityController(this, range_xz, range_y, userarg, 
+		pControllers_->freeID(), useSpatialHash);
+
+	KBEShared_ptr<Controller> p(pProximityController);
+
+	// The grid refuses a trap when the space is gone or the trap is too wide
+	if(useSpatialHash && !pProximityController->installed())
+	{
+		ERROR_MSG(fmt::format("Entity::addProximity: install trap(xz={}, y={}) failed! entity[{}:{}]\n", 
+			range_xz, range_y, scriptName(), id()));
+
+		return 0;
+	}
 
 	bool ret = pControllers_->add(p);
 	KBE_ASSERT(ret);
@@ -1569,25 +1949,60 @@ uint32 Entity::addProximity(float range_xz, float range_y, int32 userarg)
 }
 
 //-------------------------------------------------------------------------------------
-PyObject* Entity::pyAddProximity(float range_xz, float range_y, int32 userarg)
+PyObject* Entity::__py_pyAddProximity(PyObject* self, PyObject* args)
 {
-	if(!isReal())
+	uint16 currargsSize = PyTuple_Size(args);
+	Entity* pobj = static_cast<Entity*>(self);
+
+	if(!pobj->isReal())
 	{
 		PyErr_Format(PyExc_AssertionError, "%s::addProximity: not is real entity(%d).", 
-			scriptName(), id());
+			pobj->scriptName(), pobj->id());
 		PyErr_PrintEx(0);
 		return 0;
 	}
 
-	if(this->isDestroyed())
+	if(pobj->isDestroyed())
 	{
 		PyErr_Format(PyExc_AssertionError, "%s::addProximity: %d is destroyed!\n",		
-			scriptName(), id());		
+			pobj->scriptName(), pobj->id());		
 		PyErr_PrintEx(0);
 		return 0;
 	}
 
-	return PyLong_FromLong(addProximity(range_xz, range_y, userarg));
+	float range_xz = 0.f, range_y = 0.f;
+	int32 userarg = 0;
+	int useSpatialHash = 0;
+
+	if(currargsSize == 3)
+	{
+		if(!PyArg_ParseTuple(args, "ffi", &range_xz, &range_y, &userarg))
+		{
+			PyErr_Format(PyExc_TypeError, "%s::addProximity: args error! entity(%d)", 
+				pobj->scriptName(), pobj->id());
+			PyErr_PrintEx(0);
+			return 0;
+		}
+	}
+	else if(currargsSize == 4)
+	{
+		if(!PyArg_ParseTuple(args, "ffii", &range_xz, &range_y, &userarg, &useSpatialHash))
+		{
+			PyErr_Format(PyExc_TypeError, "%s::addProximity: args error! entity(%d)", 
+				pobj->scriptName(), pobj->id());
+			PyErr_PrintEx(0);
+			return 0;
+		}
+	}
+	else
+	{
+		PyErr_Format(PyExc_AssertionError, "%s::addProximity: args require 3 or 4 args(range_xz, range_y, userarg, useSpatialHash), gived %d! entity(%d)", 
+			pobj->scriptName(), currargsSize, pobj->id());
+		PyErr_PrintEx(0);
+		return 0;
+	}
+
+	return PyLong_FromLong(pobj->addProximity(range_xz, range_y, userarg, useSpatialHash != 0));
 }
 
 //-------------------------------------------------------------------------------------
@@ -1972,6 +2387,7 @@ void Entity::onPyPositionChanged()
 		Entity::bufferCallback(false);
 	}
 
+	updateProximityGrid();
 	updateLastPos();
 }
 
@@ -1990,9 +2406,21 @@ void Entity::onPositionChanged()
 		Entity::bufferCallback(false);
 	}
 
+	updateProximityGrid();
 	updateLastPos();
 }
 
+//-------------------------------------------------------------------------------------
+void Entity::updateProximityGrid()
+{
+	if(ProximityGrid::activeGrids() == 0)
+		return;
+
+	Space* space = Spaces::findSpace(this->spaceID());
+	if(space && space->pProximityGrid())
+		space->pProximityGrid()->onEntityMoved(this);
+}
+
 //-------------------------------------------------------------------------------------
 void Entity::updateLastPos()
 {
@@ -2040,13 +2468,13 @@ void Entity::setWitness(Witness* pWitness)
 }
 
 //-------------------------------------------------------------------------------------
-void Entity::onGetWitnessFromBase(Network::Channel* pChannel)
+void Entity::onGetWitnessFromBase(Network::Channel* pChannel, uint32 clientFeatures)
 {
-	onGetWitness(true);
+	onGetWitness(true, clientFeatures);
 }
 
 //-------------------------------------------------------------------------------------
-void Entity::onGetWitness(bool fromBase)
+void Entity::onGetWitness(bool fromBase, uint32 clientFeatures)
 {
 	KBE_ASSERT(this->baseEntityCall() != NULL);
 
@@ -2082,6 +2510,9 @@ void Entity::onGetWitness(bool fromBase)
 			// The entities in the View also need to be reset and resynchronized to the client
 			pWitness_->resetViewEntities();
 		}
+
+		// The bound client may be a different one than before
+		pWitness_->clientFeatures(clientFeatures);
 	}
 
 	// Prevent this entity from being destroyed in some script callbacks, here's a reference to yourself
@@ -2249,13 +2680,16 @@ PyObject* Entity::pyGetVolatileinfo()
 }
 
 //-------------------------------------------------------------------------------------
-bool Entity::checkMoveForTopSpeed(const Position3D& position)
+bool Entity::checkMoveForTopSpeed(const Position3D& position, uint32 moves)
 {
 	Position3D movment = position - this->position();
 	bool move = true;
+
+	// Each merged update may have moved up to topSpeed, as if they had been checked one by one
+	float tolerance = g_kbeSrvConfig.getCellApp().clientMovement_speedTolerance * float(moves > 0 ? moves : 1);
 	
 	// Check to make sure movement obeys speed limit
-	if(topSpeedY_ > 0.01f && movment.y > topSpeedY_)
+	if(topSpeedY_ > 0.01f && movment.y > topSpeedY_ * tolerance)
 	{
 		move = false;
 	}
@@ -2264,7 +2698,7 @@ bool Entity::checkMoveForTopSpeed(const Position3D& position)
 	{
 		movment.y = 0.f;
 		
-		if(movment.length() > topSpeed_)
+		if(movment.length() > topSpeed_ * tolerance)
 			move = false;
 	}
 
@@ -2298,9 +2732,48 @@ void Entity::onUpdateDataFromClient(KBEngine::MemoryStream& s)
 	dir.yaw(yaw);
 	dir.pitch(pitch);
 	dir.roll(roll);
+
+	if(g_kbeSrvConfig.getCellApp().clientMovement_aggregate)
+	{
+		// Several updates may arrive within one tick, only the latest one is applied
+		if(!hasPendingClientMove_)
+		{
+			hasPendingClientMove_ = true;
+			pendingClientMoves_ = 0;
+			Cellapp::getSingleton().addClientMoveEntity(id());
+		}
+
+		++pendingClientMoves_;
+		pendingClientPos_ = pos;
+		pendingClientDir_ = dir;
+		pendingClientSpaceID_ = currSpace;
+		return;
+	}
+
+	onClientMove(pos, dir);
+}
+
+//-------------------------------------------------------------------------------------
+void Entity::applyPendingClientMove()
+{
+	if(!hasPendingClientMove_)
+		return;
+
+	hasPendingClientMove_ = false;
+
+	// Teleported or destroyed since the update arrived
+	if(isDestroyed() || spaceID_ == 0 || spaceID_ != pendingClientSpaceID_)
+		return;
+
+	onClientMove(pendingClientPos_, pendingClientDir_, pendingClientMoves_);
+}
+
+//-------------------------------------------------------------------------------------
+void Entity::onClientMove(const Position3D& pos, const Direction3D& dir, uint32 moves)
+{
 	this->direction(dir);
 
-	if(checkMoveForTopSpeed(pos))
+	if(checkMoveForTopSpeed(pos, moves))
 	{
 		this->position(pos);
 	}
@@ -3101,6 +3574,78 @@ PyObject* Entity::pyEntitiesInView()
 	return pyList;
 }
 
+//-------------------------------------------------------------------------------------
+static bool entityTypeToUType(PyObject* pyEntityType, int& entityUType)
+{
+	entityUType = -1;
+
+	if (pyEntityType == NULL || pyEntityType == Py_None)
+		return true;
+
+	wchar_t* PyUnicode_AsWideCharStringRet0 = PyUnicode_AsWideCharString(pyEntityType, NULL);
+	char* pEntityType = strutil::wchar2char(PyUnicode_AsWideCharStringRet0);
+	PyMem_Free(PyUnicode_AsWideCharStringRet0);
+
+	ScriptDefModule* sm = EntityDef::findScriptModule(pEntityType);
+	free(pEntityType);
+
+	if (sm == NULL)
+		return false;
+
+	entityUType = sm->getUType();
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+static PyObject* entitiesToPyList(const std::vector<Entity*>& entities, PyObject* pyResult)
+{
+	if (pyResult == NULL || pyResult == Py_None)
+	{
+		PyObject* pyList = PyList_New(entities.size());
+
+		for (size_t i = 0; i < entities.size(); ++i)
+		{
+			Py_INCREF(entities[i]);
+			PyList_SET_ITEM(pyList, i, entities[i]);
+		}
+
+		return pyList;
+	}
+
+	// Refill the caller's list in place, its storage is kept between queries
+	Py_ssize_t oldSize = PyList_GET_SIZE(pyResult);
+	Py_ssize_t newSize = (Py_ssize_t)entities.size();
+
+	for (Py_ssize_t i = 0; i < newSize; ++i)
+	{
+		if (i < oldSize)
+		{
+			Py_INCREF(entities[i]);
+			PyList_SetItem(pyResult, i, entities[i]);
+		}
+		else
+		{
+			PyList_Append(pyResult, entities[i]);
+		}
+	}
+
+	if (oldSize > newSize)
+		PyList_SetSlice(pyResult, newSize, oldSize, NULL);
+
+	Py_INCREF(pyResult);
+	return pyResult;
+}
+
+//-------------------------------------------------------------------------------------
+static ProximityGrid* queryGrid(Entity* pEntity)
+{
+	Space* space = Spaces::findSpace(pEntity->spaceID());
+	if (space == NULL || !space->isGood())
+		return NULL;
+
+	return space->createProximityGrid();
+}
+
 //-------------------------------------------------------------------------------------
 PyObject* Entity::__py_pyEntitiesInRange(PyObject* self, PyObject* args)
 {
@@ -3115,7 +3660,7 @@ PyObject* Entity::__py_pyEntitiesInRange(PyObject* self, PyObject* args)
 		return 0;
 	}
 
-	PyObject* pyPosition = NULL, *pyEntityType = NULL;
+	PyObject* pyPosition = NULL, *pyEntityType = NULL, *pyResult = NULL;
 	float radius = 0.f;
 
 	if (pobj->isDestroyed() && !pobj->hasFlags(ENTITY_FLAGS_DESTROYING) /* 允许在销毁期间调用 */)
@@ -3155,9 +3700,9 @@ PyObject* Entity::__py_pyEntitiesInRange(PyObject* self, PyObject* args)
 		}
 
 	}
-	else if (currargsSize == 3)
+	else if (currargsSize == 3 || currargsSize == 4)
 	{
-		if (PyArg_ParseTuple(args, "fOO", &radius, &pyEntityType, &pyPosition) == -1)
+		if (PyArg_ParseTuple(args, "fOO|O", &radius, &pyEntityType, &pyPosition, &pyResult) == -1)
 		{
 			PyErr_Format(PyExc_TypeError, "%s::entitiesInRange: args error! entity(%d)",
 				pobj->scriptName(), pobj->id());
@@ -3180,6 +3725,14 @@ PyObject* Entity::__py_pyEntitiesInRange(PyObject* self, PyObject* args)
 			PyErr_PrintEx(0);
 			return 0;
 		}
+
+		if (pyResult && pyResult != Py_None && !PyList_Check(pyResult))
+		{
+			PyErr_Format(PyExc_TypeError, "%s::entitiesInRange: args(result) must be a list! entity(%d)",
+				pobj->scriptName(), pobj->id());
+			PyErr_PrintEx(0);
+			return 0;
+		}
 	}
 	else
 	{
@@ -3189,7 +3742,6 @@ PyObject* Entity::__py_pyEntitiesInRange(PyObject* self, PyObject* args)
 		return 0;
 	}
 
-	char* pEntityType = NULL;
 	Position3D originpos;
 
 	// Extract coordinate information
@@ -3202,46 +3754,170 @@ PyObject* Entity::__py_pyEntitiesInRange(PyObject* self, PyObject* args)
 		originpos = pobj->position();
 	}
 
-	if (pyEntityType && pyEntityType != Py_None)
+	int entityUType = -1;
+	std::vector<Entity*> findentities;
+
+	if (!entityTypeToUType(pyEntityType, entityUType))
+		return entitiesToPyList(findentities, pyResult);
+
+	ProximityGrid* pGrid = NULL;
+	if (g_kbeSrvConfig.getCellApp().proximity_grid_queries)
+		pGrid = queryGrid(pobj);
+
+	if (pGrid)
 	{
-		wchar_t* PyUnicode_AsWideCharStringRet0 = PyUnicode_AsWideCharString(pyEntityType, NULL);
-		pEntityType = strutil::wchar2char(PyUnicode_AsWideCharStringRet0);
-		PyMem_Free(PyUnicode_AsWideCharStringRet0);
+		Position3D range(radius, radius, radius);
+		pGrid->entitiesInBox(findentities, originpos - range, originpos + range, entityUType, CoordinateSystem::hasY);
 	}
+	else
+	{
+		// Users always expect to search near the entity, so we search from around
+		EntityCoordinateNode::entitiesInRange(findentities, pobj->pEntityCoordinateNode(), originpos, radius, entityUType);
+	}
+
+	return entitiesToPyList(findentities, pyResult);
+}
+
+//-------------------------------------------------------------------------------------
+PyObject* Entity::__py_pyEntitiesInBox(PyObject* self, PyObject* args)
+{
+	Entity* pobj = static_cast<Entity*>(self);
+
+	if (!pobj->isReal())
+	{
+		PyErr_Format(PyExc_AssertionError, "%s::entitiesInBox: not is real entity(%d).",
+			pobj->scriptName(), pobj->id());
+		PyErr_PrintEx(0);
+		return 0;
+	}
+
+	if (pobj->isDestroyed())
+	{
+		PyErr_Format(PyExc_TypeError, "%s::entitiesInBox: entity(%d) is destroyed!",
+			pobj->scriptName(), pobj->id());
+		PyErr_PrintEx(0);
+		return 0;
+	}
+
+	PyObject* pyMinPosition = NULL, *pyMaxPosition = NULL, *pyEntityType = NULL, *pyResult = NULL;
+
+	if (!PyArg_ParseTuple(args, "OO|OO", &pyMinPosition, &pyMaxPosition, &pyEntityType, &pyResult) ||
+		!PySequence_Check(pyMinPosition) || PySequence_Size(pyMinPosition) < 3 ||
+		!PySequence_Check(pyMaxPosition) || PySequence_Size(pyMaxPosition) < 3 ||
+		(pyEntityType && pyEntityType != Py_None && !PyUnicode_Check(pyEntityType)) ||
+		(pyResult && pyResult != Py_None && !PyList_Check(pyResult)))
+	{
+		PyErr_Format(PyExc_TypeError, "%s::entitiesInBox: args(minPosition, maxPosition, [entityType, result]) error! entity(%d)",
+			pobj->scriptName(), pobj->id());
+		PyErr_PrintEx(0);
+		return 0;
+	}
+
+	Position3D minPos, maxPos;
+	script::ScriptVector3::convertPyObjectToVector3(minPos, pyMinPosition);
+	script::ScriptVector3::convertPyObjectToVector3(maxPos, pyMaxPosition);
 
 	int entityUType = -1;
+	std::vector<Entity*> findentities;
 
-	if (pEntityType)
+	ProximityGrid* pGrid = queryGrid(pobj);
+	if (pGrid && entityTypeToUType(pyEntityType, entityUType))
+		pGrid->entitiesInBox(findentities, minPos, maxPos, entityUType, true);
+
+	return entitiesToPyList(findentities, pyResult);
+}
+
+//-------------------------------------------------------------------------------------
+PyObject* Entity::__py_pyEntitiesInCone(PyObject* self, PyObject* args)
+{
+	Entity* pobj = static_cast<Entity*>(self);
+
+	if (!pobj->isReal())
 	{
-		ScriptDefModule* sm = EntityDef::findScriptModule(pEntityType);
-		if (sm == NULL)
-		{
-			free(pEntityType);
-			return PyList_New(0);
-		}
+		PyErr_Format(PyExc_AssertionError, "%s::entitiesInCone: not is real entity(%d).",
+			pobj->scriptName(), pobj->id());
+		PyErr_PrintEx(0);
+		return 0;
+	}
+
+	if (pobj->isDestroyed())
+	{
+		PyErr_Format(PyExc_TypeError, "%s::entitiesInCone: entity(%d) is destroyed!",
+			pobj->scriptName(), pobj->id());
+		PyErr_PrintEx(0);
+		return 0;
+	}
+
+	float radius = 0.f, angle = 0.f;
+	PyObject* pyEntityType = NULL, *pyResult = NULL;
 
-		free(pEntityType);
-		entityUType = sm->getUType();
+	if (!PyArg_ParseTuple(args, "ff|OO", &radius, &angle, &pyEntityType, &pyResult) ||
+		(pyEntityType && pyEntityType != Py_None && !PyUnicode_Check(pyEntityType)) ||
+		(pyResult && pyResult != Py_None && !PyList_Check(pyResult)))
+	{
+		PyErr_Format(PyExc_TypeError, "%s::entitiesInCone: args(radius, angle, [entityType, result]) error! entity(%d)",
+			pobj->scriptName(), pobj->id());
+		PyErr_PrintEx(0);
+		return 0;
 	}
 
+	int entityUType = -1;
 	std::vector<Entity*> findentities;
 
-	// Users always expect to search near the entity, so we search from around
-	EntityCoordinateNode::entitiesInRange(findentities, pobj->pEntityCoordinateNode(), originpos, radius, entityUType);
+	// The cone opens along the entity's yaw, angle is the half angle in radians
+	ProximityGrid* pGrid = queryGrid(pobj);
+	if (pGrid && entityTypeToUType(pyEntityType, entityUType))
+	{
+		pGrid->entitiesInCone(findentities, pobj->position(), pobj->direction().yaw(), angle, 
+			radius, entityUType, pobj);
+	}
 
-	PyObject* pyList = PyList_New(findentities.size());
+	return entitiesToPyList(findentities, pyResult);
+}
 
-	std::vector<Entity*>::iterator iter = findentities.begin();
-	int i = 0;
-	for (; iter != findentities.end(); ++iter)
+//-------------------------------------------------------------------------------------
+PyObject* Entity::__py_pyNearestEntities(PyObject* self, PyObject* args)
+{
+	Entity* pobj = static_cast<Entity*>(self);
+
+	if (!pobj->isReal())
 	{
-		Entity* pEntity = (*iter);
+		PyErr_Format(PyExc_AssertionError, "%s::nearestEntities: not is real entity(%d).",
+			pobj->scriptName(), pobj->id());
+		PyErr_PrintEx(0);
+		return 0;
+	}
 
-		Py_INCREF(pEntity);
-		PyList_SET_ITEM(pyList, i++, pEntity);
+	if (pobj->isDestroyed())
+	{
+		PyErr_Format(PyExc_TypeError, "%s::nearestEntities: entity(%d) is destroyed!",
+			pobj->scriptName(), pobj->id());
+		PyErr_PrintEx(0);
+		return 0;
 	}
 
-	return pyList;
+	uint32 count = 0;
+	float radius = 0.f;
+	PyObject* pyEntityType = NULL, *pyResult = NULL;
+
+	if (!PyArg_ParseTuple(args, "If|OO", &count, &radius, &pyEntityType, &pyResult) ||
+		(pyEntityType && pyEntityType != Py_None && !PyUnicode_Check(pyEntityType)) ||
+		(pyResult && pyResult != Py_None && !PyList_Check(pyResult)))
+	{
+		PyErr_Format(PyExc_TypeError, "%s::nearestEntities: args(count, radius, [entityType, result]) error! entity(%d)",
+			pobj->scriptName(), pobj->id());
+		PyErr_PrintEx(0);
+		return 0;
+	}
+
+	int entityUType = -1;
+	std::vector<Entity*> findentities;
+
+	ProximityGrid* pGrid = queryGrid(pobj);
+	if (pGrid && entityTypeToUType(pyEntityType, entityUType))
+		pGrid->nearestEntities(findentities, pobj->position(), radius, count, entityUType, pobj);
+
+	return entitiesToPyList(findentities, pyResult);
 }
 
 //-------------------------------------------------------------------------------------
@@ -3625,11 +4301,9 @@ void Entity::teleportLocal(PyObject_ptr nearbyMBRef, Position3D& pos, Direction3
 
 	currspace->addEntityToNode(this);
 
-	std::list<ENTITY_ID>::iterator witer = witnesses_.begin();
-	for (; witer != witnesses_.end(); ++witer)
+	WITNESSED_SLOTS_FOREACH_IN_CLIENT(witnesses_, pEntity)
 	{
-		Entity* pEntity = Cellapp::getSingleton().findEntity((*witer));
-		if (pEntity == NULL || pEntity->pWitness() == NULL)
+		if (pEntity->pWitness() == NULL)
 			continue;
 
 		EntityCall* clientEntityCall = pEntity->clientEntityCall();
@@ -3640,11 +4314,6 @@ void Entity::teleportLocal(PyObject_ptr nearbyMBRef, Position3D& pos, Direction3
 		if (pChannel == NULL)
 			continue;
 
-		// This possibility exists, for example the data comes from createWitnessFromStream()
-		// Another example is that their entity is not yet created on the target client
-		if (!pEntity->pWitness()->entityInView(id()))
-			continue;
-
 		// Notify that location was forcibly changed
 		Network::Bundle* pSendBundle = Network::Bundle::createPoolObject();
 		NETWORK_ENTITY_MESSAGE_FORWARD_CLIENT_BEGIN(pEntity->id(), (*pSendBundle));
@@ -3657,6 +4326,7 @@ void Entity::teleportLocal(PyObject_ptr nearbyMBRef, Position3D& pos, Direction3
 		ENTITY_MESSAGE_FORWARD_CLIENT_END(pSendBundle, ClientInterface::onSetEntityPosAndDir, setEntityPosAndDir);
 		pEntity->pWitness()->sendToClient(ClientInterface::onSetEntityPosAndDir, pSendBundle);
 	}
+	WITNESSED_SLOTS_FOREACH_END
 
 	onTeleportSuccess(nearbyMBRef, lastSpaceID);
 }
@@ -3830,6 +4500,7 @@ void Entity::onRestore()
 
 	bufferOrExeCallback(const_cast<char*>("onRestore"), NULL);
 	removeFlags(ENTITY_FLAGS_INITING);
+	attachPropertyPatches();
 }
 
 //-------------------------------------------------------------------------------------
@@ -3842,10 +4513,32 @@ bool Entity::_reload(bool fullReload)
 //-------------------------------------------------------------------------------------
 void Entity::onUpdateGhostPropertys(KBEngine::MemoryStream& s)
 {
+	ENTITY_PROPERTY_UID componentPropertyUID = 0;
 	ENTITY_PROPERTY_UID utype;
-	s >> utype;
+	s >> componentPropertyUID >> utype;
 
-	PropertyDescription* pPropertyDescription = pScriptModule()->findCellPropertyDescription(utype);
+	ScriptDefModule* pCurrScriptModule = pScriptModule();
+
+	PropertyDescription* pComponentPropertyDescription = NULL;
+	if (componentPropertyUID > 0)
+	{
+		pComponentPropertyDescription = pCurrScriptModule->findCellPropertyDescription(componentPropertyUID);
+		if (pComponentPropertyDescription == NULL)
+		{
+			ERROR_MSG(fmt::format("{}::onUpdateGhostPropertys: not found component propertyID({}), entityID({})\n", 
+				scriptName(), componentPropertyUID, id()));
+
+			s.done();
+			return;
+		}
+
+		DataType* pDataType = pComponentPropertyDescription->getDataType();
+		KBE_ASSERT(pDataType->type() == DATA_TYPE_ENTITY_COMPONENT);
+
+		pCurrScriptModule = static_cast<EntityComponentType*>(pDataType)->pScriptDefModule();
+	}
+
+	PropertyDescription* pPropertyDescription = pCurrScriptModule->findCellPropertyDescription(utype);
 	if(pPropertyDescription == NULL)
 	{
 		ERROR_MSG(fmt::format("{}::onUpdateGhostPropertys: not found propertyID({}), entityID({})\n", 
@@ -3868,12 +4561,73 @@ void Entity::onUpdateGhostPropertys(KBEngine::MemoryStream& s)
 		return;
 	}
 
-	PyObject_SetAttrString(static_cast<PyObject*>(this),
-				pPropertyDescription->getName(), pyVal);
+	if (pComponentPropertyDescription)
+	{
+		PyObject* pyComponent = PyObject_GetAttrString(static_cast<PyObject*>(this), 
+			pComponentPropertyDescription->getName());
+
+		if (pyComponent)
+		{
+			PyObject_SetAttrString(pyComponent, pPropertyDescription->getName(), pyVal);
+			Py_DECREF(pyComponent);
+		}
+		else
+		{
+			SCRIPT_ERROR_CHECK();
+		}
+	}
+	else
+	{
+		PyObject_SetAttrString(static_cast<PyObject*>(this),
+					pPropertyDescription->getName(), pyVal);
+	}
 
 	Py_DECREF(pyVal);
 }
 
+//-------------------------------------------------------------------------------------
+void Entity::onUpdateGhostPropertyPatch(KBEngine::MemoryStream& s)
+{
+	ENTITY_PROPERTY_UID utype;
+	uint16 numOps = 0;
+	s >> utype >> numOps;
+
+	PropertyDescription* pPropertyDescription = pScriptModule()->findCellPropertyDescription(utype);
+	if(pPropertyDescription == NULL)
+	{
+		ERROR_MSG(fmt::format("{}::onUpdateGhostPropertyPatch: not found propertyID({}), entityID({})\n", 
+			scriptName(), utype, id()));
+
+		s.done();
+		return;
+	}
+
+	PyObject* pyName = PyUnicode_InternFromString(pPropertyDescription->getName());
+	PyObject* pyValue = PyObject_GenericGetAttr(static_cast<PyObject*>(this), pyName);
+	Py_DECREF(pyName);
+
+	if(pyValue == NULL)
+	{
+		SCRIPT_ERROR_CHECK();
+		s.done();
+		return;
+	}
+
+	for(uint16 i = 0; i < numOps; ++i)
+	{
+		if(!PropertyPatch::apply(s, pyValue))
+		{
+			ERROR_MSG(fmt::format("{}::onUpdateGhostPropertyPatch: entityID={}, apply patch to {} error!\n", 
+				scriptName(), id(), pPropertyDescription->getName()));
+
+			s.done();
+			break;
+		}
+	}
+
+	Py_DECREF(pyValue);
+}
+
 //-------------------------------------------------------------------------------------
 void Entity::onRemoteRealMethodCall(KBEngine::MemoryStream& s)
 {
@@ -4068,6 +4822,7 @@ void Entity::createFromStream(KBEngine::MemoryStream& s)
 	Py_XDECREF(cellData);
 
 	removeFlags(ENTITY_FLAGS_INITING);
+	attachPropertyPatches();
 	
 	createEventsFromStream(s);
 	createMovementHandlerFromStream(s);
@@ -4118,10 +4873,9 @@ void Entity::addWitnessToStream(KBEngine::MemoryStream& s)
 	uint32 size = witnesses_count_;
 	s << size;
 
-	std::list<ENTITY_ID>::iterator iter = witnesses_.begin();
-	for(; iter != witnesses_.end(); ++iter)
+	for(size_t i = 0; i < witnesses_.size(); ++i)
 	{
-		s << (*iter);
+		s << witnesses_.id(i);
 	}
 
 	if(pWitness())
@@ -4198,7 +4952,9 @@ void Entity::createWitnessFromStream(KBEngine::MemoryStream& s)
 			if (pEntity == NULL || pEntity->spaceID() != spaceID())
 				continue;
 
-			witnesses_.push_back(entityID);
+			// If the witness was restored first, its view already tells whether its client knows us,
+			// otherwise Witness::createFromStream() fills this in later
+			witnesses_.add(entityID, pEntity, pEntity->pWitness() != NULL && pEntity->pWitness()->entityInView(id()));
 			++witnesses_count_;
 		}
 	}
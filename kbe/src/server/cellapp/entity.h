@@ -22,6 +22,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #define KBE_ENTITY_H
 	
 #include "profile.h"
+#include "witnessed_slots.h"
 #include "common/timer.h"
 #include "common/common.h"
 #include "common/smartpointer.h"
@@ -114,6 +115,23 @@ public:
 	*/
 	void onDefDataChanged(EntityComponent* pEntityComponent, const PropertyDescription* propertyDescription,
 			PyObject* pyData);
+
+	/** 
+		Defined container property was modified in place, 
+		pPatch is NULL if the change can't be described by a patch and the whole property must be resent
+	*/
+	void onDefDataPatched(const PropertyDescription* propertyDescription, MemoryStream* pPatch);
+
+	/** 
+		Link the container properties loaded while initing to this entity, 
+		later assignments are linked by onDefDataChanged
+	*/
+	void attachPropertyPatches();
+
+	/** 
+		Send the patches collected in this tick to ghosts and clients
+	*/
+	void flushPropertyPatches();
 	
 	/** 
 		The entity communication channel
@@ -182,6 +200,7 @@ public:
 		const Direction3D& dir);
 	
 	void onPositionChanged();
+	void updateProximityGrid();
 	void onDirectionChanged();
 	
 	void onPyPositionChanged();
@@ -189,7 +208,10 @@ public:
 	
 	void updateLastPos();
 
-	bool checkMoveForTopSpeed(const Position3D& position);
+	/**
+		topSpeed is a distance per tick, moves is the number of client updates merged into this movement
+	*/
+	bool checkMoveForTopSpeed(const Position3D& position, uint32 moves = 1);
 
 	/** Network interface
 		Client sets new location
@@ -355,6 +377,14 @@ public:
 	*/
 	static PyObject* __py_pyEntitiesInRange(PyObject* self, PyObject* args);
 
+	/** 
+		Spatial queries answered by the space's ProximityGrid, an optional list passed 
+		as the last argument is refilled and returned instead of creating a new one
+	*/
+	static PyObject* __py_pyEntitiesInBox(PyObject* self, PyObject* args);
+	static PyObject* __py_pyEntitiesInCone(PyObject* self, PyObject* args);
+	static PyObject* __py_pyNearestEntities(PyObject* self, PyObject* args);
+
 	/** 
 		Script requests to get entities in View-range
 	*/
@@ -396,7 +426,7 @@ public:
 	/** 
 		Add a Witness who witnessed this entity
 	*/
-	void addWitnessed(Entity* entity);
+	void addWitnessed(Entity* entity, bool inClient = false);
 
 	/** 
 		Remove a Witness that was observing this entity
@@ -409,15 +439,20 @@ public:
 	*/
 	bool entityInWitnessed(ENTITY_ID entityID);
 
-	INLINE const std::list<ENTITY_ID>&	witnesses();
+	/**
+		Whether the client of a Witness observing this entity already knows this entity
+	*/
+	void witnessInClient(Entity* entity, bool inClient);
+
+	INLINE const WitnessedSlots& witnesses();
 	INLINE size_t witnessesSize() const;
 
 	/** Network interface
 		Entity binds a Witness (client)
 	*/
 	void setWitness(Witness* pWitness);
-	void onGetWitnessFromBase(Network::Channel* pChannel);
-	void onGetWitness(bool fromBase = false);
+	void onGetWitnessFromBase(Network::Channel* pChannel, uint32 clientFeatures);
+	void onGetWitness(bool fromBase = false, uint32 clientFeatures = 0);
 
 	/** Network interface
 		Entity lost an Witness (client)
@@ -430,10 +465,18 @@ public:
 	void onUpdateDataFromClient(KBEngine::MemoryStream& s);
 
 	/** 
-		Add a range Trigger  
+		Apply a movement of the controlling client, when movements are aggregated 
+		only the latest one of a tick is kept and Cellapp applies it at the start of the next tick
+	*/
+	void onClientMove(const Position3D& pos, const Direction3D& dir, uint32 moves = 1);
+	void applyPendingClientMove();
+
+	/** 
+		Add a range Trigger, useSpatialHash puts it in the space's ProximityGrid 
+		instead of the coordinate system
 	*/
-	uint32 addProximity(float range_xz, float range_y, int32 userarg);
-	DECLARE_PY_MOTHOD_ARG3(pyAddProximity, float, float, int32);
+	uint32 addProximity(float range_xz, float range_y, int32 userarg, bool useSpatialHash = false);
+	static PyObject* __py_pyAddProximity(PyObject* self, PyObject* args);
 
 	/** 
 		Methods for calling client entities 
@@ -538,6 +581,11 @@ public:
 		Real entity requests to update properties to ghost
 	*/
 	void onUpdateGhostPropertys(KBEngine::MemoryStream& s);
+
+	/** 
+		Real entity requests to apply in-place container changes to ghost
+	*/
+	void onUpdateGhostPropertyPatch(KBEngine::MemoryStream& s);
 	
 	/** 
 		Ghost requests to call def method real
@@ -622,6 +670,23 @@ private:
 	static int32											_scriptCallbacksBufferCount;
 
 protected:
+	/** 
+		Send a property patch to the clients that can see this property
+	*/
+	void sendPropertyPatchToClients(const PropertyDescription* propertyDescription, 
+		uint16 numOps, MemoryStream* pPatch);
+
+	struct PropertyPatchState
+	{
+		const PropertyDescription* pPropertyDescription;
+		MemoryStream* pPatch;
+		uint16 numOps;
+		uint16 flushCount;
+		bool fullSync;
+	};
+
+	void resetPropertyPatchState(PropertyPatchState& state);
+
 	// The entityCall of the entity part of this entity
 	EntityCall*												clientEntityCall_;
 
@@ -668,7 +733,7 @@ protected:
 	SPACE_ENTITIES::size_type								spaceEntityIdx_;
 
 	// Is it observed by any Witnesses
-	std::list<ENTITY_ID>									witnesses_;
+	WitnessedSlots											witnesses_;
 	size_t													witnesses_count_;
 
 	// Witness object
@@ -699,6 +764,17 @@ protected:
 	// If the user has set up Volatileinfo, Volatileinfo is created here, otherwise it is NULL.
 	// Use Volatileinfo of ScriptDefModule
 	VolatileInfo*											pCustomVolatileinfo_;
+
+	// Pending in-place changes of def container properties, sent once per tick
+	std::vector<PropertyPatchState>*						pPropertyPatches_;
+	bool													hasPendingPropertyPatches_;
+
+	// Latest movement received from the controlling client, waiting for the next tick
+	Position3D												pendingClientPos_;
+	Direction3D												pendingClientDir_;
+	SPACE_ID												pendingClientSpaceID_;
+	uint32													pendingClientMoves_;
+	bool													hasPendingClientMove_;
 };
 
 }
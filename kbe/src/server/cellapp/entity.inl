@@ -34,7 +34,7 @@ INLINE bool Entity::hasWitness(void) const
 }
 
 //-------------------------------------------------------------------------------------
-INLINE const std::list<ENTITY_ID>&	Entity::witnesses()
+INLINE const WitnessedSlots& Entity::witnesses()
 {
 	return witnesses_;
 }
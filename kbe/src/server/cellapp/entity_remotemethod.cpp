@@ -83,14 +83,13 @@ PyObject* EntityRemoteMethod::tp_call(PyObject* self, PyObject* args,
 	}
 	
 	// If we call the client method, we record the event and record the bandwidth
-	if(methodDescription->checkArgs(args))
+	MemoryStream* mstream = MemoryStream::createPoolObject();
+
+	if(methodDescription->checkArgsAndAddToStream(mstream, args))
 	{
 		Network::Bundle* pBundle = pChannel->createSendBundle();
 		entityCall->newCall((*pBundle));
 
-		MemoryStream* mstream = MemoryStream::createPoolObject();
-		methodDescription->addToStream(mstream, args);
-
 		if(mstream->wpos() > 0)
 			(*pBundle).append(mstream->data(), (int)mstream->wpos());
 
@@ -126,9 +125,9 @@ PyObject* EntityRemoteMethod::tp_call(PyObject* self, PyObject* args,
 			"::");
 		
 		pEntity->pWitness()->sendToClient(ClientInterface::onRemoteMethodCall, pBundle);
-		MemoryStream::reclaimPoolObject(mstream);
 	}
 	
+	MemoryStream::reclaimPoolObject(mstream);
 	S_Return;
 }	
 
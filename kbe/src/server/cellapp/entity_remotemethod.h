@@ -31,7 +31,7 @@ namespace KBEngine{
 class EntityRemoteMethod : public RemoteEntityMethod
 {
 	/** Subclasses populate a derived class with some py operations */
-	INSTANCE_SCRIPT_HREADER(EntityRemoteMethod, RemoteEntityMethod)	
+	REMOTE_ENTITY_METHOD_HREADER(EntityRemoteMethod, RemoteEntityMethod)	
 public:
 	EntityRemoteMethod(MethodDescription* methodDescription, 
 						EntityCallAbstract* entityCall);
@@ -29,9 +29,11 @@ EntityRef::EntityRef(Entity* pEntity):
 id_(0),
 aliasID_(0),
 pEntity_(pEntity),
-flags_(ENTITYREF_FLAG_UNKNOWN)
+flags_(ENTITYREF_FLAG_UNKNOWN),
+hasVolatileBase_(false)
 {
 	id_ = pEntity->id();
+	volatileBase_[0] = volatileBase_[1] = volatileBase_[2] = 0;
 }
 
 //-------------------------------------------------------------------------------------
@@ -39,8 +41,10 @@ EntityRef::EntityRef():
 id_(0),
 aliasID_(0),
 pEntity_(NULL),
-flags_(ENTITYREF_FLAG_UNKNOWN)
+flags_(ENTITYREF_FLAG_UNKNOWN),
+hasVolatileBase_(false)
 {
+	volatileBase_[0] = volatileBase_[1] = volatileBase_[2] = 0;
 }
 
 //-------------------------------------------------------------------------------------
@@ -89,6 +93,7 @@ void EntityRef::onReclaimObject()
 	aliasID_ =  0;
 	pEntity_ = NULL;
 	flags_ = ENTITYREF_FLAG_UNKNOWN;
+	hasVolatileBase_ = false;
 }
 
 //-------------------------------------------------------------------------------------
@@ -100,6 +105,15 @@ void EntityRef::pEntity(Entity* e)
 		id_ = e->id(); 
 }
 
+//-------------------------------------------------------------------------------------
+void EntityRef::volatileBase(int32 x, int32 y, int32 z)
+{
+	volatileBase_[0] = x;
+	volatileBase_[1] = y;
+	volatileBase_[2] = z;
+	hasVolatileBase_ = true;
+}
+
 //-------------------------------------------------------------------------------------
 void EntityRef::addToStream(KBEngine::MemoryStream& s)
 {
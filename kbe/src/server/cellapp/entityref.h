@@ -56,7 +56,8 @@ public:
 	{
 		size_t bytes = sizeof(id_)
 			+ sizeof(aliasID_) + sizeof(pEntity_)
-			+ sizeof(flags_);
+			+ sizeof(flags_) + sizeof(volatileBase_)
+			+ sizeof(hasVolatileBase_);
 
 		return bytes;
 	}
@@ -73,6 +74,15 @@ public:
 	int aliasID() const { return aliasID_; }
 	void aliasID(int id) { aliasID_ = id; }
 
+	/**
+		Last position sent to the client through volatile snapshots, in centimeters.
+		The client keeps the same integers, so deltas never drift.
+	*/
+	bool hasVolatileBase() const { return hasVolatileBase_; }
+	const int32* volatileBase() const { return volatileBase_; }
+	void volatileBase(int32 x, int32 y, int32 z);
+	void resetVolatileBase() { hasVolatileBase_ = false; }
+
 	void addToStream(KBEngine::MemoryStream& s);
 	void createFromStream(KBEngine::MemoryStream& s);
 
@@ -81,6 +91,9 @@ private:
 	int aliasID_;
 	Entity* pEntity_;
 	uint32 flags_;
+
+	int32 volatileBase_[3];
+	bool hasVolatileBase_;
 };
 
 }
@@ -61,6 +61,7 @@ void FMH_Baseapp_onEntityGetCellFrom_onCreateCellEntityInNewSpaceFromBaseapp::pr
 
 	_e->spaceID(space->id());
 	_e->initializeEntity(_params);
+	_e->attachPropertyPatches();
 	Py_XDECREF(_params);
 	_params = NULL;
 
@@ -81,12 +82,13 @@ void FMH_Baseapp_onEntityGetCellFrom_onCreateCellEntityInNewSpaceFromBaseapp::pr
 FMH_Baseapp_onEntityGetCellFrom_onCreateCellEntityFromBaseapp::
 	FMH_Baseapp_onEntityGetCellFrom_onCreateCellEntityFromBaseapp(
 			std::string& entityType, ENTITY_ID createToEntityID, ENTITY_ID entityID, MemoryStream* pCellData, 
-			 bool hasClient, bool inRescore, COMPONENT_ID componentID, SPACE_ID spaceID):
+			 bool hasClient, uint32 clientFeatures, bool inRescore, COMPONENT_ID componentID, SPACE_ID spaceID):
 _entityType(entityType),
 _createToEntityID(createToEntityID),
 _entityID(entityID),
 _pCellData(pCellData),
 _hasClient(hasClient),
+_clientFeatures(clientFeatures),
 _componentID(componentID),
 _spaceID(spaceID),
 _inRescore(inRescore)
@@ -103,7 +105,7 @@ FMH_Baseapp_onEntityGetCellFrom_onCreateCellEntityFromBaseapp::~FMH_Baseapp_onEn
 void FMH_Baseapp_onEntityGetCellFrom_onCreateCellEntityFromBaseapp::process()
 {
 	Cellapp::getSingleton()._onCreateCellEntityFromBaseapp(_entityType, _createToEntityID, _entityID, 
-		_pCellData, _hasClient, _inRescore, _componentID, _spaceID);
+		_pCellData, _hasClient, _clientFeatures, _inRescore, _componentID, _spaceID);
 
 	MemoryStream::reclaimPoolObject(_pCellData);
 	_pCellData = NULL;
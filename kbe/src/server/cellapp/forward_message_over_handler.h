@@ -51,7 +51,8 @@ class FMH_Baseapp_onEntityGetCellFrom_onCreateCellEntityFromBaseapp : public For
 {
 public:
 	FMH_Baseapp_onEntityGetCellFrom_onCreateCellEntityFromBaseapp(std::string& entityType, ENTITY_ID createToEntityID, 
-		ENTITY_ID entityID, MemoryStream* pCellData, bool hasClient, bool inRescore, COMPONENT_ID componentID, SPACE_ID spaceID);
+		ENTITY_ID entityID, MemoryStream* pCellData, bool hasClient, uint32 clientFeatures, bool inRescore, 
+		COMPONENT_ID componentID, SPACE_ID spaceID);
 	~FMH_Baseapp_onEntityGetCellFrom_onCreateCellEntityFromBaseapp();
 
 	virtual void process();
@@ -61,6 +62,7 @@ private:
 	ENTITY_ID _createToEntityID, _entityID;
 	MemoryStream* _pCellData;
 	bool _hasClient;
+	uint32 _clientFeatures;
 	COMPONENT_ID _componentID;
 	SPACE_ID _spaceID;
 	bool _inRescore;
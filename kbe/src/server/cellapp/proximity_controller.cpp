@@ -22,21 +22,32 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "entity.h"
 #include "proximity_controller.h"	
 #include "entity_coordinate_node.h"
+#include "proximity_grid.h"
+#include "space.h"
+#include "spaces.h"
 
 namespace KBEngine{	
 
 
 //-------------------------------------------------------------------------------------
-ProximityController::ProximityController(Entity* pEntity, float xz, float y, int32 userarg, uint32 id):
+ProximityController::ProximityController(Entity* pEntity, float xz, float y, int32 userarg, uint32 id, bool useSpatialHash):
 Controller(CONTROLLER_TYPE_PROXIMITY, pEntity, userarg, id),
 pTrapTrigger_(NULL),
 xz_(xz),
-y_(y)
+y_(y),
+useSpatialHash_(useSpatialHash),
+installed_(false)
 {
+	if(useSpatialHash_)
+	{
+		installed_ = installToGrid();
+		return;
+	}
+
 	pTrapTrigger_ = new TrapTrigger(static_cast<EntityCoordinateNode*>(pEntity->pEntityCoordinateNode()), 
 								this, xz, y);
 
-	pTrapTrigger_->install();
+	installed_ = pTrapTrigger_->install();
 }
 
 //-------------------------------------------------------------------------------------
@@ -44,34 +55,70 @@ ProximityController::ProximityController(Entity* pEntity):
 Controller(pEntity),
 pTrapTrigger_(NULL),
 xz_(0.f),
-y_(0.f)
+y_(0.f),
+useSpatialHash_(false),
+installed_(false)
 {
 }
 
 //-------------------------------------------------------------------------------------
 ProximityController::~ProximityController()
 {
+	if(useSpatialHash_)
+	{
+		uninstallFromGrid();
+		return;
+	}
+
 	pTrapTrigger_->uninstall();
 	delete pTrapTrigger_;
 }
 
+//-------------------------------------------------------------------------------------
+bool ProximityController::installToGrid()
+{
+	Space* pSpace = Spaces::findSpace(pEntity_->spaceID());
+	if(pSpace == NULL || !pSpace->isGood())
+		return false;
+
+	return pSpace->createProximityGrid()->addTrap(this, pEntity_, xz_, y_);
+}
+
+//-------------------------------------------------------------------------------------
+void ProximityController::uninstallFromGrid()
+{
+	// The trap is already gone if the owner has left the space
+	Space* pSpace = Spaces::findSpace(pEntity_->spaceID());
+	if(pSpace == NULL || pSpace->pProximityGrid() == NULL)
+		return;
+
+	pSpace->pProximityGrid()->removeTrap(this);
+}
+
 //-------------------------------------------------------------------------------------
 void ProximityController::addToStream(KBEngine::MemoryStream& s)
 {
 	Controller::addToStream(s);
-	s << xz_ << y_;
+	s << xz_ << y_ << useSpatialHash_;
 }
 
 //-------------------------------------------------------------------------------------
 void ProximityController::createFromStream(KBEngine::MemoryStream& s)
 {
 	Controller::createFromStream(s);
-	s >> xz_ >> y_;
+	s >> xz_ >> y_ >> useSpatialHash_;
 }
 
 //-------------------------------------------------------------------------------------
 bool ProximityController::reinstall(CoordinateNode* pCoordinateNode)
 {
+	if(useSpatialHash_)
+	{
+		uninstallFromGrid();
+		installed_ = installToGrid();
+		return installed_;
+	}
+
 	// This may happen when jumping across cellapp scenes
 	// Because of using ProximityController::ProximityController(Entity* pEntity) construct
 	if(pTrapTrigger_ == NULL)
@@ -31,11 +31,13 @@ class CoordinateNode;
 
 /*
 	Manage traps.
+	A trap is either a TrapTrigger in the coordinate system, or an entry in the
+	ProximityGrid of the space when added with useSpatialHash.
 */
 class ProximityController : public Controller
 {
 public:
-	ProximityController(Entity* pEntity, float xz, float y, int32 userarg, uint32 id = 0);
+	ProximityController(Entity* pEntity, float xz, float y, int32 userarg, uint32 id = 0, bool useSpatialHash = false);
 	ProximityController(Entity* pEntity);
 	~ProximityController();
 	
@@ -47,10 +49,19 @@ public:
 	void addToStream(KBEngine::MemoryStream& s);
 	void createFromStream(KBEngine::MemoryStream& s);
 
+	bool useSpatialHash() const{ return useSpatialHash_; }
+	bool installed() const{ return installed_; }
+
+protected:
+	bool installToGrid();
+	void uninstallFromGrid();
+
 protected:
 	TrapTrigger* pTrapTrigger_;
 	float xz_; 
 	float y_;
+	bool useSpatialHash_;
+	bool installed_;
 };
 
 }
@@ -0,0 +1,599 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "proximity_grid.h"
+#include "entity.h"
+#include "coordinate_system.h"
+#include "entity_coordinate_node.h"
+#include "proximity_controller.h"
+
+namespace KBEngine{	
+
+int32 ProximityGrid::activeGrids_ = 0;
+
+//-------------------------------------------------------------------------------------
+template<typename T>
+static void sortedInsert(std::vector<T*>& vec, T* p)
+{
+	vec.insert(std::lower_bound(vec.begin(), vec.end(), p), p);
+}
+
+//-------------------------------------------------------------------------------------
+template<typename T>
+static void sortedErase(std::vector<T*>& vec, T* p)
+{
+	typename std::vector<T*>::iterator iter = std::lower_bound(vec.begin(), vec.end(), p);
+	if(iter != vec.end() && (*iter) == p)
+		vec.erase(iter);
+}
+
+//-------------------------------------------------------------------------------------
+ProximityGrid::ProximityGrid(float cellSize):
+cellSize_(cellSize > 0.f ? cellSize : 16.f),
+cells_(),
+entities_(),
+traps_(),
+trapScratch_(),
+entityScratch_(),
+queryScratch_(),
+nearestScratch_()
+{
+	++activeGrids_;
+}
+
+//-------------------------------------------------------------------------------------
+ProximityGrid::~ProximityGrid()
+{
+	TRAPS::iterator trapIter = traps_.begin();
+	for(; trapIter != traps_.end(); ++trapIter)
+		delete trapIter->second;
+
+	ENTITIES::iterator entityIter = entities_.begin();
+	for(; entityIter != entities_.end(); ++entityIter)
+		delete entityIter->second;
+
+	traps_.clear();
+	entities_.clear();
+	cells_.clear();
+
+	--activeGrids_;
+}
+
+//-------------------------------------------------------------------------------------
+int32 ProximityGrid::toCell(float v) const
+{
+	float cell = floorf(v / cellSize_);
+
+	// Also catches NaN, which would otherwise convert to an undefined int32
+	if(!(cell > float(-PROXIMITY_GRID_MAX_CELL)))
+		return -PROXIMITY_GRID_MAX_CELL;
+
+	if(cell > float(PROXIMITY_GRID_MAX_CELL))
+		return PROXIMITY_GRID_MAX_CELL;
+
+	return int32(cell);
+}
+
+//-------------------------------------------------------------------------------------
+bool ProximityGrid::canHoldTrap(float cellSize, float xz)
+{
+	if(cellSize <= 0.f)
+		cellSize = 16.f;
+
+	// The box [x - xz, x + xz] touches at most floor(2 * xz / cellSize) + 2 cells per axis
+	double cellsPerAxis = floor(2.0 * fabs(xz) / cellSize) + 2.0;
+	return cellsPerAxis * cellsPerAxis <= double(PROXIMITY_GRID_MAX_TRAP_CELLS);
+}
+
+//-------------------------------------------------------------------------------------
+bool ProximityGrid::contains(const Trap* pTrap, const Position3D& pos) const
+{
+	const Position3D& origin = pTrap->pOwner->pEntity->position();
+
+	if(fabs(pos.x - origin.x) > pTrap->xz || fabs(pos.z - origin.z) > pTrap->xz)
+		return false;
+
+	return !CoordinateSystem::hasY || fabs(pos.y - origin.y) <= pTrap->y;
+}
+
+//-------------------------------------------------------------------------------------
+ProximityGrid::EntityRecord* ProximityGrid::findRecord(Entity* pEntity) const
+{
+	ENTITIES::const_iterator iter = entities_.find(pEntity->id());
+	if(iter == entities_.end())
+		return NULL;
+
+	return iter->second;
+}
+
+//-------------------------------------------------------------------------------------
+void ProximityGrid::linkEntity(EntityRecord* pRecord, uint64 key)
+{
+	Cell& cell = cells_[key];
+	pRecord->cellKey = key;
+	pRecord->cellIdx = cell.entities.size();
+	cell.entities.push_back(pRecord);
+}
+
+//-------------------------------------------------------------------------------------
+void ProximityGrid::unlinkEntity(EntityRecord* pRecord)
+{
+	CELLS::iterator iter = cells_.find(pRecord->cellKey);
+	KBE_ASSERT(iter != cells_.end());
+
+	std::vector<EntityRecord*>& entities = iter->second.entities;
+	KBE_ASSERT(pRecord->cellIdx < entities.size() && entities[pRecord->cellIdx] == pRecord);
+
+	EntityRecord* pBack = entities.back();
+	pBack->cellIdx = pRecord->cellIdx;
+	entities[pRecord->cellIdx] = pBack;
+	entities.pop_back();
+
+	if(entities.empty() && iter->second.traps.empty())
+		cells_.erase(iter);
+}
+
+//-------------------------------------------------------------------------------------
+void ProximityGrid::linkTrap(Trap* pTrap)
+{
+	const Position3D& origin = pTrap->pOwner->pEntity->position();
+	pTrap->minX = toCell(origin.x - pTrap->xz);
+	pTrap->maxX = toCell(origin.x + pTrap->xz);
+	pTrap->minZ = toCell(origin.z - pTrap->xz);
+	pTrap->maxZ = toCell(origin.z + pTrap->xz);
+
+	for(int32 x = pTrap->minX; x <= pTrap->maxX; ++x)
+	{
+		for(int32 z = pTrap->minZ; z <= pTrap->maxZ; ++z)
+			cells_[cellKey(x, z)].traps.push_back(pTrap);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void ProximityGrid::unlinkTrap(Trap* pTrap)
+{
+	for(int32 x = pTrap->minX; x <= pTrap->maxX; ++x)
+	{
+		for(int32 z = pTrap->minZ; z <= pTrap->maxZ; ++z)
+		{
+			CELLS::iterator iter = cells_.find(cellKey(x, z));
+			if(iter == cells_.end())
+				continue;
+
+			std::vector<Trap*>& traps = iter->second.traps;
+			std::vector<Trap*>::iterator trapIter = std::find(traps.begin(), traps.end(), pTrap);
+			if(trapIter != traps.end())
+			{
+				(*trapIter) = traps.back();
+				traps.pop_back();
+			}
+
+			if(traps.empty() && iter->second.entities.empty())
+				cells_.erase(iter);
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void ProximityGrid::destroyTrap(Trap* pTrap)
+{
+	std::vector<EntityRecord*>::iterator iter = pTrap->inside.begin();
+	for(; iter != pTrap->inside.end(); ++iter)
+		sortedErase((*iter)->insideTraps, pTrap);
+
+	unlinkTrap(pTrap);
+
+	std::vector<Trap*>& ownedTraps = pTrap->pOwner->ownedTraps;
+	ownedTraps.erase(std::find(ownedTraps.begin(), ownedTraps.end(), pTrap));
+
+	traps_.erase(pTrap->pController);
+	delete pTrap;
+}
+
+//-------------------------------------------------------------------------------------
+void ProximityGrid::onEnter(Trap* pTrap, EntityRecord* pRecord)
+{
+	pTrap->pController->onEnter(pRecord->pEntity, pTrap->xz, pTrap->y);
+}
+
+//-------------------------------------------------------------------------------------
+void ProximityGrid::onLeave(Trap* pTrap, EntityRecord* pRecord)
+{
+	pTrap->pController->onLeave(pRecord->pEntity, pTrap->xz, pTrap->y);
+}
+
+//-------------------------------------------------------------------------------------
+void ProximityGrid::updateEntity(EntityRecord* pRecord)
+{
+	const Position3D& pos = pRecord->pEntity->position();
+
+	trapScratch_.clear();
+
+	CELLS::iterator cellIter = cells_.find(pRecord->cellKey);
+	if(cellIter != cells_.end())
+	{
+		std::vector<Trap*>& traps = cellIter->second.traps;
+		for(size_t i = 0; i < traps.size(); ++i)
+		{
+			Trap* pTrap = traps[i];
+			if(pTrap->pOwner != pRecord && contains(pTrap, pos))
+				trapScratch_.push_back(pTrap);
+		}
+
+		std::sort(trapScratch_.begin(), trapScratch_.end());
+	}
+
+	std::vector<Trap*>& insideTraps = pRecord->insideTraps;
+
+	for(size_t i = 0; i < insideTraps.size(); ++i)
+	{
+		Trap* pTrap = insideTraps[i];
+		if(std::binary_search(trapScratch_.begin(), trapScratch_.end(), pTrap))
+			continue;
+
+		sortedErase(pTrap->inside, pRecord);
+		onLeave(pTrap, pRecord);
+	}
+
+	for(size_t i = 0; i < trapScratch_.size(); ++i)
+	{
+		Trap* pTrap = trapScratch_[i];
+		if(std::binary_search(insideTraps.begin(), insideTraps.end(), pTrap))
+			continue;
+
+		sortedInsert(pTrap->inside, pRecord);
+		onEnter(pTrap, pRecord);
+	}
+
+	insideTraps.assign(trapScratch_.begin(), trapScratch_.end());
+}
+
+//-------------------------------------------------------------------------------------
+void ProximityGrid::updateTrap(Trap* pTrap)
+{
+	const Position3D& origin = pTrap->pOwner->pEntity->position();
+
+	if(toCell(origin.x - pTrap->xz) != pTrap->minX || toCell(origin.x + pTrap->xz) != pTrap->maxX ||
+		toCell(origin.z - pTrap->xz) != pTrap->minZ || toCell(origin.z + pTrap->xz) != pTrap->maxZ)
+	{
+		unlinkTrap(pTrap);
+		linkTrap(pTrap);
+	}
+
+	entityScratch_.clear();
+
+	for(int32 x = pTrap->minX; x <= pTrap->maxX; ++x)
+	{
+		for(int32 z = pTrap->minZ; z <= pTrap->maxZ; ++z)
+		{
+			CELLS::iterator iter = cells_.find(cellKey(x, z));
+			if(iter == cells_.end())
+				continue;
+
+			std::vector<EntityRecord*>& entities = iter->second.entities;
+			for(size_t i = 0; i < entities.size(); ++i)
+			{
+				EntityRecord* pRecord = entities[i];
+				if(pRecord != pTrap->pOwner && contains(pTrap, pRecord->pEntity->position()))
+					entityScratch_.push_back(pRecord);
+			}
+		}
+	}
+
+	std::sort(entityScratch_.begin(), entityScratch_.end());
+
+	std::vector<EntityRecord*>& inside = pTrap->inside;
+
+	for(size_t i = 0; i < inside.size(); ++i)
+	{
+		EntityRecord* pRecord = inside[i];
+		if(std::binary_search(entityScratch_.begin(), entityScratch_.end(), pRecord))
+			continue;
+
+		sortedErase(pRecord->insideTraps, pTrap);
+		onLeave(pTrap, pRecord);
+	}
+
+	for(size_t i = 0; i < entityScratch_.size(); ++i)
+	{
+		EntityRecord* pRecord = entityScratch_[i];
+		if(std::binary_search(inside.begin(), inside.end(), pRecord))
+			continue;
+
+		sortedInsert(pRecord->insideTraps, pTrap);
+		onEnter(pTrap, pRecord);
+	}
+
+	inside.assign(entityScratch_.begin(), entityScratch_.end());
+}
+
+//-------------------------------------------------------------------------------------
+void ProximityGrid::addEntity(Entity* pEntity)
+{
+	if(findRecord(pEntity))
+	{
+		onEntityMoved(pEntity);
+		return;
+	}
+
+	EntityRecord* pRecord = new EntityRecord();
+	pRecord->pEntity = pEntity;
+	pRecord->cellKey = 0;
+	pRecord->cellIdx = 0;
+	entities_[pEntity->id()] = pRecord;
+
+	const Position3D& pos = pEntity->position();
+	linkEntity(pRecord, cellKey(toCell(pos.x), toCell(pos.z)));
+
+	Entity::bufferCallback(true);
+	updateEntity(pRecord);
+	Entity::bufferCallback(false);
+}
+
+//-------------------------------------------------------------------------------------
+void ProximityGrid::removeEntity(Entity* pEntity)
+{
+	EntityRecord* pRecord = findRecord(pEntity);
+	if(pRecord == NULL)
+		return;
+
+	Entity::bufferCallback(true);
+
+	// Traps of a leaving entity are dropped silently, like a RangeTrigger whose origin is removed
+	while(!pRecord->ownedTraps.empty())
+		destroyTrap(pRecord->ownedTraps.back());
+
+	std::vector<Trap*>::iterator iter = pRecord->insideTraps.begin();
+	for(; iter != pRecord->insideTraps.end(); ++iter)
+	{
+		sortedErase((*iter)->inside, pRecord);
+		onLeave((*iter), pRecord);
+	}
+
+	pRecord->insideTraps.clear();
+
+	unlinkEntity(pRecord);
+	entities_.erase(pEntity->id());
+	delete pRecord;
+
+	Entity::bufferCallback(false);
+}
+
+//-------------------------------------------------------------------------------------
+void ProximityGrid::onEntityMoved(Entity* pEntity)
+{
+	EntityRecord* pRecord = findRecord(pEntity);
+	if(pRecord == NULL)
+		return;
+
+	const Position3D& pos = pEntity->position();
+	uint64 key = cellKey(toCell(pos.x), toCell(pos.z));
+
+	if(key != pRecord->cellKey)
+	{
+		unlinkEntity(pRecord);
+		linkEntity(pRecord, key);
+	}
+
+	Entity::bufferCallback(true);
+
+	updateEntity(pRecord);
+
+	for(size_t i = 0; i < pRecord->ownedTraps.size(); ++i)
+		updateTrap(pRecord->ownedTraps[i]);
+
+	Entity::bufferCallback(false);
+}
+
+//-------------------------------------------------------------------------------------
+bool ProximityGrid::addTrap(ProximityController* pController, Entity* pOwner, float xz, float y)
+{
+	if(traps_.find(pController) != traps_.end() || !canHoldTrap(cellSize_, xz))
+		return false;
+
+	EntityRecord* pRecord = findRecord(pOwner);
+	if(pRecord == NULL)
+	{
+		addEntity(pOwner);
+		pRecord = findRecord(pOwner);
+	}
+
+	Trap* pTrap = new Trap();
+	pTrap->pController = pController;
+	pTrap->pOwner = pRecord;
+	pTrap->xz = fabs(xz);
+	pTrap->y = fabs(y);
+
+	traps_[pController] = pTrap;
+	pRecord->ownedTraps.push_back(pTrap);
+	linkTrap(pTrap);
+
+	Entity::bufferCallback(true);
+	updateTrap(pTrap);
+	Entity::bufferCallback(false);
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+bool ProximityGrid::removeTrap(ProximityController* pController)
+{
+	TRAPS::iterator iter = traps_.find(pController);
+	if(iter == traps_.end())
+		return false;
+
+	destroyTrap(iter->second);
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+bool ProximityGrid::matchQuery(Entity* pEntity, int entityUType)
+{
+	// Hidden entities are skipped, as by the coordinate list walks
+	EntityCoordinateNode* pNode = pEntity->pEntityCoordinateNode();
+	if(pNode && pNode->hasFlags(COORDINATE_NODE_FLAG_HIDE_OR_REMOVED))
+		return false;
+
+	return entityUType == -1 || pEntity->pScriptModule()->getUType() == (ENTITY_SCRIPT_UID)entityUType;
+}
+
+//-------------------------------------------------------------------------------------
+void ProximityGrid::collectEntities(float minX, float minZ, float maxX, float maxZ)
+{
+	queryScratch_.clear();
+
+	int32 cellMinX = toCell(minX);
+	int32 cellMaxX = toCell(maxX);
+	int32 cellMinZ = toCell(minZ);
+	int32 cellMaxZ = toCell(maxZ);
+
+	// A query wider than the populated area walks the occupied cells instead
+	uint64 numCells = uint64(int64(cellMaxX) - cellMinX + 1) * uint64(int64(cellMaxZ) - cellMinZ + 1);
+	if(numCells > cells_.size())
+	{
+		CELLS::iterator iter = cells_.begin();
+		for(; iter != cells_.end(); ++iter)
+		{
+			int32 x = int32(uint32(iter->first >> 32));
+			int32 z = int32(uint32(iter->first));
+
+			if(x < cellMinX || x > cellMaxX || z < cellMinZ || z > cellMaxZ)
+				continue;
+
+			queryScratch_.insert(queryScratch_.end(), iter->second.entities.begin(), iter->second.entities.end());
+		}
+
+		return;
+	}
+
+	for(int32 x = cellMinX; x <= cellMaxX; ++x)
+	{
+		for(int32 z = cellMinZ; z <= cellMaxZ; ++z)
+		{
+			CELLS::iterator iter = cells_.find(cellKey(x, z));
+			if(iter == cells_.end())
+				continue;
+
+			queryScratch_.insert(queryScratch_.end(), iter->second.entities.begin(), iter->second.entities.end());
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void ProximityGrid::entitiesInBox(std::vector<Entity*>& foundEntities, const Position3D& minPos, const Position3D& maxPos, 
+	int entityUType, bool checkY)
+{
+	collectEntities(minPos.x, minPos.z, maxPos.x, maxPos.z);
+
+	for(size_t i = 0; i < queryScratch_.size(); ++i)
+	{
+		Entity* pEntity = queryScratch_[i]->pEntity;
+		const Position3D& pos = pEntity->position();
+
+		if(pos.x < minPos.x || pos.x > maxPos.x || pos.z < minPos.z || pos.z > maxPos.z)
+			continue;
+
+		if(checkY && (pos.y < minPos.y || pos.y > maxPos.y))
+			continue;
+
+		if(matchQuery(pEntity, entityUType))
+			foundEntities.push_back(pEntity);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void ProximityGrid::entitiesInCone(std::vector<Entity*>& foundEntities, const Position3D& origin, float yaw, float halfAngle, 
+	float radius, int entityUType, const Entity* pExclude)
+{
+	collectEntities(origin.x - radius, origin.z - radius, origin.x + radius, origin.z + radius);
+
+	// Same convention as Vector3::yaw(), yaw 0 faces +z
+	float forwardX = sinf(yaw);
+	float forwardZ = cosf(yaw);
+	float cosHalfAngle = cosf(halfAngle);
+	float radiusSq = radius * radius;
+
+	for(size_t i = 0; i < queryScratch_.size(); ++i)
+	{
+		Entity* pEntity = queryScratch_[i]->pEntity;
+		if(pEntity == pExclude || !matchQuery(pEntity, entityUType))
+			continue;
+
+		const Position3D& pos = pEntity->position();
+		float dx = pos.x - origin.x;
+		float dz = pos.z - origin.z;
+		float distSq = dx * dx + dz * dz;
+
+		if(distSq > radiusSq)
+			continue;
+
+		if(CoordinateSystem::hasY && fabs(pos.y - origin.y) > radius)
+			continue;
+
+		if(distSq > 0.f && (dx * forwardX + dz * forwardZ) < cosHalfAngle * sqrtf(distSq))
+			continue;
+
+		foundEntities.push_back(pEntity);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void ProximityGrid::nearestEntities(std::vector<Entity*>& foundEntities, const Position3D& origin, float radius, size_t count, 
+	int entityUType, const Entity* pExclude)
+{
+	if(count == 0)
+		return;
+
+	collectEntities(origin.x - radius, origin.z - radius, origin.x + radius, origin.z + radius);
+
+	float radiusSq = radius * radius;
+	nearestScratch_.clear();
+
+	for(size_t i = 0; i < queryScratch_.size(); ++i)
+	{
+		Entity* pEntity = queryScratch_[i]->pEntity;
+		if(pEntity == pExclude || !matchQuery(pEntity, entityUType))
+			continue;
+
+		const Position3D& pos = pEntity->position();
+		float dx = pos.x - origin.x;
+		float dy = CoordinateSystem::hasY ? pos.y - origin.y : 0.f;
+		float dz = pos.z - origin.z;
+		float distSq = dx * dx + dy * dy + dz * dz;
+
+		if(distSq <= radiusSq)
+			nearestScratch_.push_back(std::make_pair(distSq, pEntity));
+	}
+
+	if(nearestScratch_.size() > count)
+	{
+		std::partial_sort(nearestScratch_.begin(), nearestScratch_.begin() + count, nearestScratch_.end());
+		nearestScratch_.resize(count);
+	}
+	else
+	{
+		std::sort(nearestScratch_.begin(), nearestScratch_.end());
+	}
+
+	for(size_t i = 0; i < nearestScratch_.size(); ++i)
+		foundEntities.push_back(nearestScratch_[i].second);
+}
+
+//-------------------------------------------------------------------------------------
+}
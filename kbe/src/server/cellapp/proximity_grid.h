@@ -0,0 +1,173 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KBE_PROXIMITY_GRID_H
+#define KBE_PROXIMITY_GRID_H
+
+#include "common/common.h"
+#include "math/math.h"
+
+namespace KBEngine{
+
+class Entity;
+class ProximityController;
+
+// A grid trap may be listed in at most this many cells, wider traps stay RangeTriggers
+#define PROXIMITY_GRID_MAX_TRAP_CELLS		4096
+
+// Cell coordinates are clamped to this range so that far away positions still fit a cell key
+#define PROXIMITY_GRID_MAX_CELL				(1 << 30)
+
+/*
+	Trap index of a space, an alternative to RangeTrigger for proximities.
+	The space is hashed into square cells of cellSize, a trap is listed in every cell its
+	xz box overlaps and an entity in the cell holding its position. Moving an entity
+	only tests the traps of its own cell, then diffs the result against the traps it was
+	inside to produce enter/leave events. Trap boxes match RangeTrigger (|dx|, |dz| <= xz,
+	|dy| <= y when the coordinate system has a y axis), the owner never triggers its own traps.
+	Traps are meant for small radii, a trap costs one list entry per overlapped cell.
+	The entity lists also serve the spatial queries of scripts (box, cone, nearest), which
+	only visit the cells overlapping the query instead of walking the coordinate lists.
+*/
+class ProximityGrid
+{
+public:
+	ProximityGrid(float cellSize);
+	~ProximityGrid();
+
+	/**
+		Entities of the space, adding an entity already in the grid counts as a move
+	*/
+	void addEntity(Entity* pEntity);
+	void removeEntity(Entity* pEntity);
+	void onEntityMoved(Entity* pEntity);
+
+	/**
+		Traps are keyed by their controller, the owner is the controller's entity
+	*/
+	bool addTrap(ProximityController* pController, Entity* pOwner, float xz, float y);
+	bool removeTrap(ProximityController* pController);
+
+	/**
+		Whether a trap of range xz stays within PROXIMITY_GRID_MAX_TRAP_CELLS cells of cellSize
+	*/
+	static bool canHoldTrap(float cellSize, float xz);
+
+	/**
+		Spatial queries, results are appended to foundEntities, entityUType -1 matches any type.
+		The y range of a box is only tested when checkY is set, cones lie in the xz plane
+		around yaw, nearest entities are sorted by distance
+	*/
+	void entitiesInBox(std::vector<Entity*>& foundEntities, const Position3D& minPos, const Position3D& maxPos, 
+		int entityUType, bool checkY);
+
+	void entitiesInCone(std::vector<Entity*>& foundEntities, const Position3D& origin, float yaw, float halfAngle, 
+		float radius, int entityUType, const Entity* pExclude);
+
+	void nearestEntities(std::vector<Entity*>& foundEntities, const Position3D& origin, float radius, size_t count, 
+		int entityUType, const Entity* pExclude);
+
+	float cellSize() const { return cellSize_; }
+	size_t numTraps() const { return traps_.size(); }
+	size_t numEntities() const { return entities_.size(); }
+
+	/**
+		Number of live grids, position updates skip the space lookup when it is 0
+	*/
+	static int32 activeGrids() { return activeGrids_; }
+
+private:
+	struct Trap;
+
+	struct EntityRecord
+	{
+		Entity* pEntity;
+		uint64 cellKey;
+		size_t cellIdx;
+
+		// Traps this entity is inside, sorted by address
+		std::vector<Trap*> insideTraps;
+
+		std::vector<Trap*> ownedTraps;
+	};
+
+	struct Trap
+	{
+		ProximityController* pController;
+		EntityRecord* pOwner;
+		float xz;
+		float y;
+		int32 minX, minZ, maxX, maxZ;
+
+		// Entities inside this trap, sorted by address
+		std::vector<EntityRecord*> inside;
+	};
+
+	struct Cell
+	{
+		std::vector<Trap*> traps;
+		std::vector<EntityRecord*> entities;
+	};
+
+	typedef KBEUnordered_map<uint64, Cell> CELLS;
+	typedef KBEUnordered_map<ENTITY_ID, EntityRecord*> ENTITIES;
+	typedef KBEUnordered_map<ProximityController*, Trap*> TRAPS;
+
+	int32 toCell(float v) const;
+	static uint64 cellKey(int32 x, int32 z) { return (uint64(uint32(x)) << 32) | uint64(uint32(z)); }
+
+	bool contains(const Trap* pTrap, const Position3D& pos) const;
+
+	EntityRecord* findRecord(Entity* pEntity) const;
+
+	void linkEntity(EntityRecord* pRecord, uint64 key);
+	void unlinkEntity(EntityRecord* pRecord);
+
+	void linkTrap(Trap* pTrap);
+	void unlinkTrap(Trap* pTrap);
+	void destroyTrap(Trap* pTrap);
+
+	void updateEntity(EntityRecord* pRecord);
+	void updateTrap(Trap* pTrap);
+
+	void onEnter(Trap* pTrap, EntityRecord* pRecord);
+	void onLeave(Trap* pTrap, EntityRecord* pRecord);
+
+	void collectEntities(float minX, float minZ, float maxX, float maxZ);
+	static bool matchQuery(Entity* pEntity, int entityUType);
+
+private:
+	float cellSize_;
+
+	CELLS cells_;
+	ENTITIES entities_;
+	TRAPS traps_;
+
+	// Scratch lists of the diff passes
+	std::vector<Trap*> trapScratch_;
+	std::vector<EntityRecord*> entityScratch_;
+	std::vector<EntityRecord*> queryScratch_;
+	std::vector< std::pair<float, Entity*> > nearestScratch_;
+
+	static int32 activeGrids_;
+};
+
+}
+#endif // KBE_PROXIMITY_GRID_H
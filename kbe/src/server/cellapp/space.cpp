@@ -22,6 +22,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "space.h"	
 #include "entity.h"
 #include "witness.h"	
+#include "proximity_grid.h"
 #include "navigation/navigation.h"
 #include "loadnavmesh_threadtasks.h"
 #include "entitydef/entities.h"
@@ -44,6 +45,7 @@ entities_(),
 hasGeometry_(false),
 pCell_(NULL),
 coordinateSystem_(),
+pProximityGrid_(NULL),
 pNavHandle_(),
 state_(STATE_NORMAL),
 destroyTime_(0)
@@ -71,6 +73,7 @@ Space::~Space()
 	entities_.clear();
 	
 	this->coordinateSystem_.releaseNodes();
+	SAFE_RELEASE(pProximityGrid_);
 	
 	pNavHandle_.clear();
 
@@ -403,6 +406,24 @@ void Space::addEntity(Entity* pEntity)
 void Space::addEntityToNode(Entity* pEntity)
 {
 	pEntity->installCoordinateNodes(&coordinateSystem_);
+
+	if(pProximityGrid_)
+		pProximityGrid_->addEntity(pEntity);
+}
+
+//-------------------------------------------------------------------------------------
+ProximityGrid* Space::createProximityGrid()
+{
+	if(pProximityGrid_)
+		return pProximityGrid_;
+
+	pProximityGrid_ = new ProximityGrid(g_kbeSrvConfig.getCellApp().proximity_grid_cell_size);
+
+	SPACE_ENTITIES::iterator iter = entities_.begin();
+	for(; iter != entities_.end(); ++iter)
+		pProximityGrid_->addEntity((*iter).get());
+
+	return pProximityGrid_;
 }
 
 //-------------------------------------------------------------------------------------
@@ -427,6 +448,9 @@ void Space::removeEntity(Entity* pEntity)
 
 	onLeaveWorld(pEntity);
 
+	if(pProximityGrid_)
+		pProximityGrid_->removeEntity(pEntity);
+
 	// This must be done after onLeaveWorld, because its rangeTrigger may need to reference pEntityCoordinateNode
 	pEntity->uninstallCoordinateNodes(&coordinateSystem_);
 	pEntity->onLeaveSpace(this);
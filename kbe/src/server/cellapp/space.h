@@ -32,6 +32,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 namespace KBEngine{
 
 class Entity;
+class ProximityGrid;
 typedef SmartPointer<Entity> EntityPtr;
 typedef std::vector<EntityPtr> SPACE_ENTITIES;
 
@@ -104,6 +105,14 @@ public:
 
 	CoordinateSystem* pCoordinateSystem(){ return &coordinateSystem_; }
 
+	/**
+		Spatial hash of the space, used by proximities added with the spatial hash option 
+		and by the entity queries of scripts, created on first use and filled with the 
+		entities already in the space
+	*/
+	ProximityGrid* pProximityGrid() const{ return pProximityGrid_; }
+	ProximityGrid* createProximityGrid();
+
 	bool isDestroyed() const{ return state_ == STATE_DESTROYED; }
 	bool isGood() const{ return state_ == STATE_NORMAL; }
 
@@ -137,6 +146,8 @@ protected:
 
 	CoordinateSystem			coordinateSystem_;
 
+	ProximityGrid*				pProximityGrid_;
+
 	NavigationHandlePtr			pNavHandle_;
 
 	// spaceData can only store string resources so that it can be better compatible with client.
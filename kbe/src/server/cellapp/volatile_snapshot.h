@@ -0,0 +1,111 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KBE_VOLATILE_SNAPSHOT_H
+#define KBE_VOLATILE_SNAPSHOT_H
+
+#include "common/common.h"
+#include "client_lib/common.h"
+
+namespace KBEngine{
+
+/*
+	One entity of an onUpdateVolatileSnapshot message, indexed by its alias ID.
+	A slot with no flags is left out of the message.
+*/
+struct VolatileSnapshotSlot
+{
+	uint8 flags;
+	int16 delta[3];
+	int8 yaw, pitch, roll;
+};
+
+inline int32 quantizeVolatilePos(float v)
+{
+	return (int32)floorf(v * VOLATILE_SNAPSHOT_UNITS_PER_METER + 0.5f);
+}
+
+/*
+	Writes the body of onUpdateVolatileSnapshot: the slot count, a bitmask of the slots that follow,
+	their flags packed two per byte, then the fields named by each slot's flags.
+	STREAM is a Network::Bundle or a MemoryStream.
+*/
+template<class STREAM>
+void writeVolatileSnapshot(STREAM& s, const VolatileSnapshotSlot* slots, int slotCount)
+{
+	s << (uint8)slotCount;
+
+	for (int i = 0; i < slotCount; i += 8)
+	{
+		uint8 mask = 0;
+		for (int j = i; j < slotCount && j < i + 8; ++j)
+		{
+			if (slots[j].flags != 0)
+				mask |= (uint8)(1 << (j - i));
+		}
+
+		s << mask;
+	}
+
+	// Low nibble first
+	uint8 nibbles = 0;
+	bool highNibble = false;
+	for (int i = 0; i < slotCount; ++i)
+	{
+		if (slots[i].flags == 0)
+			continue;
+
+		if (highNibble)
+		{
+			s << (uint8)(nibbles | (slots[i].flags << 4));
+			nibbles = 0;
+		}
+		else
+		{
+			nibbles = slots[i].flags;
+		}
+
+		highNibble = !highNibble;
+	}
+
+	if (highNibble)
+		s << nibbles;
+
+	for (int i = 0; i < slotCount; ++i)
+	{
+		const VolatileSnapshotSlot& slot = slots[i];
+
+		if ((slot.flags & VOLATILE_SNAPSHOT_FLAG_XZ) > 0)
+			s << slot.delta[0] << slot.delta[2];
+
+		if ((slot.flags & VOLATILE_SNAPSHOT_FLAG_Y) > 0)
+			s << slot.delta[1];
+
+		if ((slot.flags & VOLATILE_SNAPSHOT_FLAG_YAW) > 0)
+			s << slot.yaw;
+
+		if ((slot.flags & VOLATILE_SNAPSHOT_FLAG_PITCH_ROLL) > 0)
+			s << slot.pitch << slot.roll;
+	}
+}
+
+}
+
+#endif // KBE_VOLATILE_SNAPSHOT_H
@@ -23,6 +23,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "profile.h"
 #include "cellapp.h"
 #include "view_trigger.h"
+#include "volatile_snapshot.h"
 #include "network/channel.h"	
 #include "network/bundle.h"
 #include "network/network_stats.h"
@@ -59,7 +60,9 @@ pViewTrigger_(NULL),
 pViewLagAreaTrigger_(NULL),
 viewEntities_(),
 viewEntities_map_(),
-clientViewSize_(0)
+clientViewSize_(0),
+clientFeatures_(0),
+volatileUpdates_()
 {
 	updatableName = "Witness";
 }
@@ -109,14 +112,14 @@ void Witness::addToStream(KBEngine::MemoryStream& s)
 	*/
 
 	// Doing so currently solves the problem, but there will be problems with space multiple cell segmentation
-	s << viewRadius_ << viewLagArea_ << (uint16)0;	
+	s << viewRadius_ << viewLagArea_ << (uint16)0 << clientFeatures_;	
 	s << (uint32)0; // viewEntities_map_.size();
 }
 
 //-------------------------------------------------------------------------------------
 void Witness::createFromStream(KBEngine::MemoryStream& s)
 {
-	s >> viewRadius_ >> viewLagArea_ >> clientViewSize_;
+	s >> viewRadius_ >> viewLagArea_ >> clientViewSize_ >> clientFeatures_;
 
 	uint32 size;
 	s >> size;
@@ -128,6 +131,10 @@ void Witness::createFromStream(KBEngine::MemoryStream& s)
 		viewEntities_.push_back(pEntityRef);
 		viewEntities_map_[pEntityRef->id()] = pEntityRef;
 		pEntityRef->aliasID(i);
+
+		// The viewed entity may have been restored before us, see Entity::createWitnessFromStream()
+		if(pEntityRef->pEntity())
+			pEntityRef->pEntity()->witnessInClient(pEntity_, pEntityRef->flags() == ENTITYREF_FLAG_NORMAL);
 	}
 
 	setViewRadius(viewRadius_, viewLagArea_);
@@ -238,6 +245,7 @@ void Witness::clear(Entity* pEntity)
 	viewRadius_ = 0.0f;
 	viewLagArea_ = 5.0f;
 	clientViewSize_ = 0;
+	clientFeatures_ = 0;
 
 	// Do not need to destroy, can also be reused later
 	// Destruction here may produce errors because enterView may result in the destruction of the entity
@@ -411,7 +419,7 @@ void Witness::onEnterView(ViewTrigger* pViewTrigger, Entity* pEntity)
 				pEntityRef->flags(ENTITYREF_FLAG_ENTER_CLIENT_PENDING);
 
 			pEntityRef->pEntity(pEntity);
-			pEntity->addWitnessed(pEntity_);
+			pEntity->addWitnessed(pEntity_, pEntityRef->flags() == ENTITYREF_FLAG_NORMAL);
 			pSelfEntity->onEnteredView(pEntity);
 		}
 
@@ -487,6 +495,10 @@ void Witness::resetViewEntities()
 		}
 
 		(*iter)->flags(ENTITYREF_FLAG_ENTER_CLIENT_PENDING);
+
+		if((*iter)->pEntity())
+			(*iter)->pEntity()->witnessInClient(pEntity_, false);
+
 		++iter;
 	}
 	
@@ -615,7 +627,7 @@ bool Witness::pushBundle(Network::Bundle* pBundle)
 	if(!pc)
 		return false;
 
-	pc->send(pBundle);
+	Cellapp::getSingleton().clientRelay().send(pc, pBundle);
 	return true;
 }
 
@@ -784,6 +796,10 @@ bool Witness::update()
 		NETWORK_ENTITY_MESSAGE_FORWARD_CLIENT_BEGIN(pEntity_->id(), (*pSendBundle));
 		addBaseDataToStream(pSendBundle);
 
+		// Only clients that declared they can decode the snapshot get it, the others keep the per-entity messages
+		bool volatileSnapshot = g_kbeSrvConfig.getCellApp().volatileSnapshot_enable && 
+			(clientFeatures_ & CLIENT_FEATURE_VOLATILE_SNAPSHOT) > 0;
+
 		VIEW_ENTITIES::iterator iter = viewEntities_.begin();
 		for(; iter != viewEntities_.end(); )
 		{
@@ -825,6 +841,8 @@ bool Witness::update()
 				ENTITY_MESSAGE_FORWARD_CLIENT_END(pSendBundle, ClientInterface::onEntityEnterWorld, entityEnterWorld);
 
 				pEntityRef->flags(ENTITYREF_FLAG_NORMAL);
+				pEntityRef->resetVolatileBase();
+				otherEntity->witnessInClient(pEntity_, true);
 
 				KBE_ASSERT(clientViewSize_ != 65535);
 
@@ -866,12 +884,20 @@ bool Witness::update()
 				
 				KBE_ASSERT(pEntityRef->flags() == ENTITYREF_FLAG_NORMAL);
 				
-				addUpdateToStream(pSendBundle, getEntityVolatileDataUpdateFlags(otherEntity), pEntityRef);
+				uint32 flags = getEntityVolatileDataUpdateFlags(otherEntity);
+				if (!volatileSnapshot)
+					addUpdateToStream(pSendBundle, flags, pEntityRef);
+				else if (flags != UPDATE_FLAG_NULL)
+					volatileUpdates_.push_back(std::make_pair(pEntityRef, flags));
 			}
 
 			++iter;
 		}
 
+		// Alias IDs are only final once all enters and leaves of this tick were written
+		if (volatileSnapshot)
+			addVolatileSnapshotToStream(pSendBundle);
+
 		size_t pSendBundleMessageLength = pSendBundle->currMsgLength();
 		if (pSendBundleMessageLength > 8/*Base packet size generated by NETWORK_ENTITY_MESSAGE_FORWARD_CLIENT_BEGIN*/)
 		{
@@ -882,7 +908,7 @@ bool Witness::update()
 			}
 
 			AUTO_SCOPED_PROFILE("sendToClient");
-			pChannel->send(pSendBundle);
+			Cellapp::getSingleton().clientRelay().send(pChannel, pSendBundle);
 		}
 		else
 		{
@@ -1261,6 +1287,124 @@ void Witness::addUpdateToStream(Network::Bundle* pForwardBundle, uint32 flags, E
 	};
 }
 
+//-------------------------------------------------------------------------------------
+void Witness::addVolatileSnapshotToStream(Network::Bundle* pSendBundle)
+{
+	if (volatileUpdates_.empty())
+		return;
+
+	std::vector< std::pair<EntityRef*, uint32> >::iterator iter = volatileUpdates_.begin();
+
+	// Slots are alias IDs, without them the client only understands the per-entity messages.
+	// The bases are dropped so that the next snapshot starts from an exact position again.
+	if (!EntityDef::entityAliasID() || clientViewSize_ > 255)
+	{
+		for (; iter != volatileUpdates_.end(); ++iter)
+		{
+			iter->first->resetVolatileBase();
+			addUpdateToStream(pSendBundle, iter->second, iter->first);
+		}
+
+		volatileUpdates_.clear();
+		return;
+	}
+
+	VolatileSnapshotSlot slots[255];
+	int slotCount = 0;
+
+	for (; iter != volatileUpdates_.end(); ++iter)
+	{
+		EntityRef* pEntityRef = iter->first;
+		uint32 flags = iter->second;
+		Entity* otherEntity = pEntityRef->pEntity();
+
+		KBE_ASSERT(pEntityRef->aliasID() < 255);
+		int aliasID = pEntityRef->aliasID();
+
+		for (; slotCount <= aliasID; ++slotCount)
+			memset(&slots[slotCount], 0, sizeof(VolatileSnapshotSlot));
+
+		VolatileSnapshotSlot& slot = slots[aliasID];
+
+		if ((flags & (UPDATE_FLAG_XZ | UPDATE_FLAG_XYZ)) > 0)
+		{
+			const Position3D& pos = otherEntity->position();
+			int32 q[3] = { quantizeVolatilePos(pos.x), quantizeVolatilePos(pos.y), quantizeVolatilePos(pos.z) };
+			bool hasY = (flags & UPDATE_FLAG_XYZ) > 0;
+			int32 d[3] = { 0, 0, 0 };
+			bool rebase = !pEntityRef->hasVolatileBase();
+
+			if (!rebase)
+			{
+				const int32* base = pEntityRef->volatileBase();
+				d[0] = q[0] - base[0];
+				d[1] = hasY ? q[1] - base[1] : 0;
+				d[2] = q[2] - base[2];
+
+				for (int i = 0; i < 3; ++i)
+				{
+					if (d[i] < -32768 || d[i] > 32767)
+						rebase = true;
+				}
+
+				if (!rebase)
+					pEntityRef->volatileBase(q[0], base[1] + d[1], q[2]);
+			}
+
+			if (rebase)
+			{
+				ENTITY_MESSAGE_FORWARD_CLIENT_BEGIN(pSendBundle, ClientInterface::onUpdateVolatileBase, volatileBase);
+				_addViewEntityIDToBundle(pSendBundle, pEntityRef);
+				(*pSendBundle) << q[0] << q[1] << q[2];
+				ENTITY_MESSAGE_FORWARD_CLIENT_END(pSendBundle, ClientInterface::onUpdateVolatileBase, volatileBase);
+
+				pEntityRef->volatileBase(q[0], q[1], q[2]);
+				d[0] = d[1] = d[2] = 0;
+			}
+
+			// After a rebase the zero delta still carries the isOnGround state
+			if (rebase || d[0] != 0 || d[1] != 0 || d[2] != 0)
+			{
+				slot.flags |= VOLATILE_SNAPSHOT_FLAG_XZ;
+				if (hasY)
+					slot.flags |= VOLATILE_SNAPSHOT_FLAG_Y;
+
+				slot.delta[0] = (int16)d[0];
+				slot.delta[1] = (int16)d[1];
+				slot.delta[2] = (int16)d[2];
+			}
+		}
+
+		const Direction3D& dir = otherEntity->direction();
+
+		if ((flags & (UPDATE_FLAG_YAW | UPDATE_FLAG_YAW_PITCH_ROLL | UPDATE_FLAG_YAW_PITCH | UPDATE_FLAG_YAW_ROLL)) > 0)
+		{
+			slot.flags |= VOLATILE_SNAPSHOT_FLAG_YAW;
+			slot.yaw = angle2int8(dir.yaw());
+		}
+
+		if ((flags & (UPDATE_FLAG_ROLL | UPDATE_FLAG_PITCH | UPDATE_FLAG_YAW_PITCH_ROLL | 
+			UPDATE_FLAG_YAW_PITCH | UPDATE_FLAG_YAW_ROLL | UPDATE_FLAG_PITCH_ROLL)) > 0)
+		{
+			slot.flags |= VOLATILE_SNAPSHOT_FLAG_PITCH_ROLL;
+			slot.pitch = angle2int8(dir.pitch());
+			slot.roll = angle2int8(dir.roll());
+		}
+	}
+
+	volatileUpdates_.clear();
+
+	while (slotCount > 0 && slots[slotCount - 1].flags == 0)
+		--slotCount;
+
+	if (slotCount == 0)
+		return;
+
+	ENTITY_MESSAGE_FORWARD_CLIENT_BEGIN(pSendBundle, ClientInterface::onUpdateVolatileSnapshot, volatileSnapshot);
+	writeVolatileSnapshot(*pSendBundle, slots, slotCount);
+	ENTITY_MESSAGE_FORWARD_CLIENT_END(pSendBundle, ClientInterface::onUpdateVolatileSnapshot, volatileSnapshot);
+}
+
 //-------------------------------------------------------------------------------------
 uint32 Witness::getEntityVolatileDataUpdateFlags(Entity* otherEntity)
 {
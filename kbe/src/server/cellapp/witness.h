@@ -126,6 +126,12 @@ public:
 	INLINE float viewRadius() const;
 	INLINE float viewLagArea() const;
 
+	/**
+		Optional features the client declared in its hello (CLIENT_FEATURE_*)
+	*/
+	INLINE uint32 clientFeatures() const;
+	INLINE void clientFeatures(uint32 features);
+
 	typedef std::vector<Network::Bundle*> Bundles;
 	bool pushBundle(Network::Bundle* pBundle);
 
@@ -164,6 +170,12 @@ public:
 	*/
 	void addUpdateToStream(Network::Bundle* pForwardBundle, uint32 flags, EntityRef* pEntityRef);
 
+	/**
+		Write the volatile updates collected in this tick as one packed snapshot,
+		falls back to addUpdateToStream when the client cannot use alias IDs
+	*/
+	void addVolatileSnapshotToStream(Network::Bundle* pSendBundle);
+
 	/**
 		Add base location to update package
 	*/
@@ -224,6 +236,11 @@ private:
 	Direction3D								lastBaseDir_;
 
 	uint16									clientViewSize_;
+
+	uint32									clientFeatures_;
+
+	// Volatile updates collected by update() when volatileSnapshot is enabled
+	std::vector< std::pair<EntityRef*, uint32> >	volatileUpdates_;
 };
 
 }
@@ -45,6 +45,18 @@ INLINE float Witness::viewLagArea() const
 	return viewLagArea_; 
 }
 
+//-------------------------------------------------------------------------------------
+INLINE uint32 Witness::clientFeatures() const
+{
+	return clientFeatures_;
+}
+
+//-------------------------------------------------------------------------------------
+INLINE void Witness::clientFeatures(uint32 features)
+{
+	clientFeatures_ = features;
+}
+
 //-------------------------------------------------------------------------------------
 INLINE EntityRef* Witness::getViewEntityRef(ENTITY_ID entityID)
 {
@@ -0,0 +1,120 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "witnessed_slots.h"
+
+namespace KBEngine{	
+
+//-------------------------------------------------------------------------------------
+WitnessedSlots::WitnessedSlots():
+entities_(),
+ids_(),
+inClientBits_(),
+slots_()
+{
+}
+
+//-------------------------------------------------------------------------------------
+WitnessedSlots::~WitnessedSlots()
+{
+}
+
+//-------------------------------------------------------------------------------------
+void WitnessedSlots::setBit(size_t slot, bool v)
+{
+	if (v)
+		inClientBits_[slot >> 6] |= (uint64(1) << (slot & 63));
+	else
+		inClientBits_[slot >> 6] &= ~(uint64(1) << (slot & 63));
+}
+
+//-------------------------------------------------------------------------------------
+void WitnessedSlots::add(ENTITY_ID entityID, Entity* pEntity, bool inClient)
+{
+	KBEUnordered_map<ENTITY_ID, uint32>::iterator iter = slots_.find(entityID);
+	if (iter != slots_.end())
+	{
+		entities_[iter->second] = pEntity;
+		setBit(iter->second, inClient);
+		return;
+	}
+
+	size_t slot = entities_.size();
+	entities_.push_back(pEntity);
+	ids_.push_back(entityID);
+	slots_[entityID] = (uint32)slot;
+
+	if ((slot >> 6) >= inClientBits_.size())
+		inClientBits_.push_back(0);
+
+	setBit(slot, inClient);
+}
+
+//-------------------------------------------------------------------------------------
+bool WitnessedSlots::remove(ENTITY_ID entityID)
+{
+	KBEUnordered_map<ENTITY_ID, uint32>::iterator iter = slots_.find(entityID);
+	if (iter == slots_.end())
+		return false;
+
+	size_t slot = iter->second;
+	slots_.erase(iter);
+
+	// Move the last observer into the freed slot so the slots stay contiguous
+	size_t last = entities_.size() - 1;
+	if (slot != last)
+	{
+		entities_[slot] = entities_[last];
+		ids_[slot] = ids_[last];
+		slots_[ids_[slot]] = (uint32)slot;
+		setBit(slot, inClient(last));
+	}
+
+	setBit(last, false);
+	entities_.pop_back();
+	ids_.pop_back();
+
+	if (inClientBits_.size() > ((entities_.size() + 63) >> 6))
+		inClientBits_.pop_back();
+
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+void WitnessedSlots::clear()
+{
+	entities_.clear();
+	ids_.clear();
+	inClientBits_.clear();
+	slots_.clear();
+}
+
+//-------------------------------------------------------------------------------------
+void WitnessedSlots::inClient(ENTITY_ID entityID, bool v)
+{
+	KBEUnordered_map<ENTITY_ID, uint32>::const_iterator iter = slots_.find(entityID);
+	if (iter == slots_.end())
+		return;
+
+	setBit(iter->second, v);
+}
+
+//-------------------------------------------------------------------------------------
+}
@@ -0,0 +1,121 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KBE_WITNESSED_SLOTS_H
+#define KBE_WITNESSED_SLOTS_H
+
+#include "common/common.h"
+
+#if KBE_PLATFORM == PLATFORM_WIN32
+#include <intrin.h>
+#endif
+
+namespace KBEngine{
+
+class Entity;
+
+/*
+	The set of Witnesses observing an entity.
+	Observers occupy contiguous slots, and a parallel bitset marks the slots whose client
+	already knows this entity (the same condition as Witness::entityInView()).
+	Broadcasting to other clients only walks the set bits, no hash lookups involved.
+	Each observer's slot is indexed by its entity ID, so add/remove/inClient are O(1).
+	Slots are swap-removed, so their order is not stable.
+
+	The entity pointers are only valid while the observer keeps this entity in its View,
+	Witness removes itself through Entity::delWitnessed() before that ends. Code that is not
+	on the broadcast path (diagnostics, streaming) should use the IDs.
+*/
+class WitnessedSlots
+{
+public:
+	WitnessedSlots();
+	~WitnessedSlots();
+
+	void add(ENTITY_ID entityID, Entity* pEntity, bool inClient);
+	bool remove(ENTITY_ID entityID);
+	void clear();
+
+	/**
+		Update the in-client state of an observer, ignored if entityID is not observing
+	*/
+	void inClient(ENTITY_ID entityID, bool v);
+	bool inClient(size_t slot) const { return (inClientBits_[slot >> 6] & (uint64(1) << (slot & 63))) != 0; }
+
+	bool has(ENTITY_ID entityID) const { return slots_.find(entityID) != slots_.end(); }
+
+	size_t size() const { return entities_.size(); }
+	Entity* at(size_t slot) const { return entities_[slot]; }
+	ENTITY_ID id(size_t slot) const { return ids_[slot]; }
+
+	/**
+		The raw bitset, 64 slots per word
+	*/
+	size_t numWords() const { return inClientBits_.size(); }
+	uint64 word(size_t idx) const { return inClientBits_[idx]; }
+
+	static uint32 lowestBit(uint64 v)
+	{
+#if KBE_PLATFORM == PLATFORM_WIN32
+		unsigned long idx = 0;
+		_BitScanForward64(&idx, v);
+		return (uint32)idx;
+#else
+		return (uint32)__builtin_ctzll(v);
+#endif
+	}
+
+private:
+	void setBit(size_t slot, bool v);
+
+	std::vector<Entity*> entities_;
+	std::vector<ENTITY_ID> ids_;
+	std::vector<uint64> inClientBits_;
+
+	// entity ID -> slot
+	KBEUnordered_map<ENTITY_ID, uint32> slots_;
+};
+
+/*
+	Walk the observers of a WitnessedSlots whose client knows the entity:
+
+	WITNESSED_SLOTS_FOREACH_IN_CLIENT(witnesses_, pEntity)
+	{
+		...
+	}
+	WITNESSED_SLOTS_FOREACH_END
+*/
+#define WITNESSED_SLOTS_FOREACH_IN_CLIENT(SLOTS, ENTITY)										\
+	for (size_t _wordIdx = 0; _wordIdx < (SLOTS).numWords(); ++_wordIdx)						\
+	{																							\
+		uint64 _bits = (SLOTS).word(_wordIdx);													\
+		while (_bits)																			\
+		{																						\
+			size_t _slot = (_wordIdx << 6) + WitnessedSlots::lowestBit(_bits);					\
+			_bits &= _bits - 1;																	\
+			Entity* ENTITY = (SLOTS).at(_slot);													\
+
+#define WITNESSED_SLOTS_FOREACH_END																\
+		}																						\
+	}																							\
+
+}
+
+#endif // KBE_WITNESSED_SLOTS_H
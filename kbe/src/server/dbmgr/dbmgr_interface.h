@@ -133,6 +133,13 @@ NETWORK_INTERFACE_DECLARE_BEGIN(DbmgrInterface)
 	// Request to shut down the server
 	DBMGR_MESSAGE_DECLARE_STREAM(reqCloseServer,					NETWORK_VARIABLE_MESSAGE)
 
+	// Co-located app offers a shared-memory channel
+	DBMGR_MESSAGE_DECLARE_STREAM(onShmChannelOffer,				NETWORK_VARIABLE_MESSAGE)
+
+	// Shared-memory channel handshake marker
+	DBMGR_MESSAGE_DECLARE_ARGS1(onShmChannelReady,				NETWORK_FIXED_MESSAGE,
+									uint8,							success)
+
 	// Another app informs this app that it is active.
 	DBMGR_MESSAGE_DECLARE_ARGS7(queryEntity,						NETWORK_VARIABLE_MESSAGE, 
 									uint16,							dbInterfaceIndex,
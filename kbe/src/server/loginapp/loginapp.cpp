@@ -35,6 +35,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "server/sendmail_threadtasks.h"
 #include "client_lib/client_interface.h"
 #include "network/encryption_filter.h"
+#include "network/compression_filter.h"
 
 #include "baseapp/baseapp_interface.h"
 #include "baseappmgr/baseappmgr_interface.h"
@@ -1313,7 +1314,9 @@ void Loginapp::onLoginAccountQueryBaseappAddrFromBaseappmgr(Network::Channel* pC
 void Loginapp::onHello(Network::Channel* pChannel, 
 						const std::string& verInfo, 
 						const std::string& scriptVerInfo, 
-						const std::string& encryptedKey)
+						const std::string& encryptedKey,
+						uint8 compressType,
+						uint32 compressDictionaryID)
 {
 	Network::Bundle* pBundle = Network::Bundle::createPoolObject();
 	
@@ -1324,6 +1327,13 @@ void Loginapp::onHello(Network::Channel* pChannel,
 	(*pBundle) << digest_;
 	(*pBundle) << g_componentType;
 
+	// Loginapp does not load the entitydefs, so no dictionary here
+	Network::CompressionFilter* pCompressionFilter = 
+		Network::createCompressionFilter(compressType, compressDictionaryID, "");
+
+	if(pCompressionFilter)
+		(*pBundle) << pCompressionFilter->type() << pCompressionFilter->dictionaryID();
+
 	// This message does not allow encryption, so the setting is encrypted and ignored again.
 	// This occurs when the first send message is not immediately generated but is notified by epoll
 	//  (usually for testing, the normal environment does not appear)
@@ -1346,6 +1356,10 @@ void Loginapp::onHello(Network::Channel* pChannel,
 				, pChannel->c_str()));
 		}
 	}
+
+	// The compression filter sits on top of the encryption (and websocket) filter
+	if(pCompressionFilter)
+		pChannel->pushFilter(pCompressionFilter);
 }
 
 //-------------------------------------------------------------------------------------
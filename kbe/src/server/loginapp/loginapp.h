@@ -73,7 +73,9 @@ public:
 	virtual void onHello(Network::Channel* pChannel, 
 		const std::string& verInfo, 
 		const std::string& scriptVerInfo, 
-		const std::string& encryptedKey);
+		const std::string& encryptedKey,
+		uint8 compressType,
+		uint32 compressDictionaryID);
 
 	/** Network interface
 		A client informs the app that it is active.
@@ -0,0 +1,160 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bench.h"
+#include "common/strutil.h"
+#include "resmgr/resmgr.h"
+#include "pyscript/script.h"
+#include "entitydef/datatypes.h"
+#include "entitydef/fixedarray.h"
+#include "entitydef/fixeddict.h"
+
+namespace KBEngine{
+
+double Bench::scale_ = 1.0;
+volatile uint64 Bench::sink_ = 0;
+
+//-------------------------------------------------------------------------------------
+Bench::Bench(const char* name, const char* desc, BenchFunc func)
+{
+	Entry entry;
+	entry.name = name;
+	entry.desc = desc;
+	entry.func = func;
+	entries().push_back(entry);
+}
+
+//-------------------------------------------------------------------------------------
+std::vector<Bench::Entry>& Bench::entries()
+{
+	static std::vector<Entry> s_entries;
+	return s_entries;
+}
+
+//-------------------------------------------------------------------------------------
+const Bench::Entry* Bench::find(const std::string& name)
+{
+	std::vector<Entry>& benchs = entries();
+	for(size_t i = 0; i < benchs.size(); ++i)
+	{
+		if(name == benchs[i].name)
+			return &benchs[i];
+	}
+
+	return NULL;
+}
+
+//-------------------------------------------------------------------------------------
+uint64 Bench::scaled(uint64 count)
+{
+	uint64 v = (uint64)(count * scale_);
+	return v > 0 ? v : 1;
+}
+
+//-------------------------------------------------------------------------------------
+bool Bench::installPython()
+{
+	static script::Script* s_pScript = NULL;
+	if(s_pScript)
+		return true;
+
+	// 与PythonApp::installPyScript一致， 只需要公共脚本路径
+	std::string userScriptsPath = Resmgr::getSingleton().getPyUserScriptsPath();
+	wchar_t* tbuf = userScriptsPath.size() > 0 ? strutil::char2wchar(userScriptsPath.c_str()) : NULL;
+	if(tbuf == NULL)
+	{
+		printf("Bench::installPython: KBE_RES_PATH error!\n");
+		return false;
+	}
+
+	std::wstring path = tbuf;
+	free(tbuf);
+
+	std::wstring pyPaths = path + L"common;";
+	pyPaths += path + L"data;";
+	pyPaths += path + L"user_type;";
+
+	script::Script* pScript = new script::Script();
+	if(!pScript->install(pyPaths, "KBEngine", g_componentType))
+	{
+		printf("Bench::installPython: install python failed!\n");
+		delete pScript;
+		return false;
+	}
+
+	s_pScript = pScript;
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+bool Bench::initDataTypes()
+{
+	static bool s_inited = false;
+	if(s_inited)
+		return true;
+
+	if(!installPython())
+		return false;
+
+	FixedArray::installScript(NULL);
+	FixedDict::installScript(NULL);
+
+	if(!DataTypes::initialize())
+		return false;
+
+	s_inited = true;
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+void Bench::title(const std::string& s)
+{
+	printf("\n%s\n", s.c_str());
+}
+
+//-------------------------------------------------------------------------------------
+void Bench::report(const std::string& name, uint64 ops, uint64 stamps, uint64 bytes)
+{
+	double seconds = double(stamps) / stampsPerSecondD();
+	if(seconds <= 0.0)
+		seconds = 1e-9;
+
+	double nsPerOp = seconds * 1e9 / double(ops > 0 ? ops : 1);
+	double opsPerSecond = double(ops) / seconds;
+
+	if(bytes > 0)
+	{
+		printf("  %-44s %12.1f ns/op %14.0f ops/s %10.1f MB/s\n", name.c_str(),
+			nsPerOp, opsPerSecond, double(bytes) / seconds / (1024.0 * 1024.0));
+	}
+	else
+	{
+		printf("  %-44s %12.1f ns/op %14.0f ops/s\n", name.c_str(), nsPerOp, opsPerSecond);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void Bench::note(const std::string& name, const std::string& s)
+{
+	printf("  %-44s %s\n", name.c_str(), s.c_str());
+}
+
+//-------------------------------------------------------------------------------------
+}
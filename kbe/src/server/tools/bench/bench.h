@@ -0,0 +1,102 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KBE_BENCH_TOOL_H
+#define KBE_BENCH_TOOL_H
+
+#include "common/common.h"
+#include "common/timestamp.h"
+
+namespace KBEngine{
+
+/*
+	微基准测试
+	每个基准是一个无参函数， 由BENCH_REGISTER在静态初始化时注册， bench工具按名字运行。
+	基准自己计时， 通过report输出一行结果， 对比优化前后的实现时各输出一行。
+*/
+class Bench
+{
+public:
+	typedef void (*BenchFunc)();
+
+	struct Entry
+	{
+		const char* name;
+		const char* desc;
+		BenchFunc func;
+	};
+
+	Bench(const char* name, const char* desc, BenchFunc func);
+
+	static std::vector<Entry>& entries();
+	static const Entry* find(const std::string& name);
+
+	/**
+		命令行--scale=指定的循环次数倍数
+	*/
+	static void scale(double v) { scale_ = v; }
+	static uint64 scaled(uint64 count);
+
+	/**
+		需要python或entitydef类别的基准在开始时调用， 只初始化一次
+	*/
+	static bool installPython();
+	static bool initDataTypes();
+
+	/**
+		输出一组结果的标题
+	*/
+	static void title(const std::string& s);
+
+	/**
+		输出一行结果， ops为操作次数， stamps为总耗时， bytes不为0时同时输出吞吐量
+	*/
+	static void report(const std::string& name, uint64 ops, uint64 stamps, uint64 bytes = 0);
+
+	/**
+		输出一行不需要计时的结果， 例如大小对比
+	*/
+	static void note(const std::string& name, const std::string& s);
+
+	/**
+		防止被测的计算结果被编译器优化掉
+	*/
+	static void consume(uint64 v) { sink_ ^= v; }
+
+	/**
+		编译器无法假定每次返回的指针指向同一对象， 被测数据不变时避免整个计算被提出计时循环
+	*/
+	template<typename T>
+	static T* opaque(T* p)
+	{
+		T* volatile v = p;
+		return v;
+	}
+
+private:
+	static double scale_;
+	static volatile uint64 sink_;
+};
+
+#define BENCH_REGISTER(NAME, DESC, FUNC)	static KBEngine::Bench _g_bench_##FUNC(NAME, DESC, FUNC)
+
+}
+
+#endif // KBE_BENCH_TOOL_H
@@ -0,0 +1,246 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bench.h"
+#include "common/memorystream.h"
+#include "entitydef/datatypes.h"
+#include "entitydef/datatype.h"
+#include "entitydef/fixedarray.h"
+#include "entitydef/fixeddict.h"
+
+namespace KBEngine{
+
+/*
+	FIXED_DICT/ARRAY的编解码
+	对比优化前逐项通过通用DataType编解码(字典按字符串key查找)与加载entitydef时预先选定的编解码器。
+	两者的输出完全一致， 因此只对比耗时， 大小仅作为参考输出。
+*/
+static const char* BENCH_DATATYPE_TYPES =
+	"<root>\n"
+	"	<BENCH_INT32_ARRAY> ARRAY <of> INT32 </of> </BENCH_INT32_ARRAY>\n"
+	"	<BENCH_FLOAT_ARRAY> ARRAY <of> FLOAT </of> </BENCH_FLOAT_ARRAY>\n"
+	"	<BENCH_ITEM> FIXED_DICT\n"
+	"		<Properties>\n"
+	"			<id> <Type> UINT64 </Type> </id>\n"
+	"			<itemType> <Type> INT32 </Type> </itemType>\n"
+	"			<count> <Type> UINT16 </Type> </count>\n"
+	"			<slot> <Type> UINT8 </Type> </slot>\n"
+	"		</Properties>\n"
+	"	</BENCH_ITEM>\n"
+	"	<BENCH_ITEM_ARRAY> ARRAY <of> BENCH_ITEM </of> </BENCH_ITEM_ARRAY>\n"
+	"</root>\n";
+
+//-------------------------------------------------------------------------------------
+static bool loadBenchTypes()
+{
+	static bool s_loaded = false;
+	if(s_loaded)
+		return true;
+
+	if(!Bench::initDataTypes())
+		return false;
+
+	std::string file = fmt::format("kbe_bench_types_{}.xml", getProcessPID());
+	FILE* f = fopen(file.c_str(), "wb");
+	if(f == NULL)
+	{
+		printf("datatype_codec: can't write %s!\n", file.c_str());
+		return false;
+	}
+
+	fwrite(BENCH_DATATYPE_TYPES, 1, strlen(BENCH_DATATYPE_TYPES), f);
+	fclose(f);
+
+	bool ret = DataTypes::loadTypes(file);
+	remove(file.c_str());
+
+	s_loaded = ret;
+	return ret;
+}
+
+//-------------------------------------------------------------------------------------
+static void genericDictToStream(FixedDictType* pType, MemoryStream* s, PyObject* pyValue)
+{
+	PyObject* pydict = pyValue;
+	if(PyObject_TypeCheck(pyValue, FixedDict::getScriptType()))
+		pydict = static_cast<FixedDict*>(pyValue)->getDictObject();
+
+	FixedDictType::FIXEDDICT_KEYTYPE_MAP& keyTypes = pType->getKeyTypes();
+	FixedDictType::FIXEDDICT_KEYTYPE_MAP::iterator iter = keyTypes.begin();
+	for(; iter != keyTypes.end(); ++iter)
+	{
+		PyObject* pyObject = PyDict_GetItemString(pydict, iter->first.c_str());
+		iter->second->dataType->addToStream(s, pyObject);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+static void genericArrayToStream(FixedArrayType* pType, MemoryStream* s, PyObject* pyValue)
+{
+	DataType* pItemType = pType->getDataType();
+
+	ArraySize size = (ArraySize)PySequence_Size(pyValue);
+	(*s) << size;
+
+	for(ArraySize i = 0; i < size; ++i)
+	{
+		PyObject* pyVal = PySequence_GetItem(pyValue, i);
+
+		if(pItemType->type() == DATA_TYPE_FIXEDDICT)
+			genericDictToStream(static_cast<FixedDictType*>(pItemType), s, pyVal);
+		else
+			pItemType->addToStream(s, pyVal);
+
+		Py_DECREF(pyVal);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+static PyObject* genericArrayFromStream(FixedArrayType* pType, MemoryStream* s)
+{
+	DataType* pItemType = pType->getDataType();
+
+	FixedArray* pFixedArray = new FixedArray(pType);
+	pFixedArray->initialize("");
+
+	ArraySize size;
+	(*s) >> size;
+
+	std::vector<PyObject*>& vals = pFixedArray->getValues();
+	for(ArraySize i = 0; i < size; ++i)
+		vals.push_back(pItemType->createFromStream(s));
+
+	return pFixedArray;
+}
+
+//-------------------------------------------------------------------------------------
+static void benchArray(const char* name, FixedArrayType* pType, PyObject* pyList, bool generic)
+{
+	// 实体属性中保存的是FixedArray， 先经过一次编解码得到与运行时相同的对象
+	MemoryStream s;
+	pType->addToStream(&s, pyList);
+	PyObject* pyValue = pType->createFromStream(&s);
+
+	s.clear(false);
+	pType->addToStream(&s, pyValue);
+	size_t bytes = s.length();
+	int items = (int)PySequence_Size(pyValue);
+
+	uint64 loops = Bench::scaled(20000);
+	uint64 startTime = timestamp();
+
+	for(uint64 i = 0; i < loops; ++i)
+	{
+		s.clear(false);
+
+		if(generic)
+			genericArrayToStream(pType, &s, pyValue);
+		else
+			pType->addToStream(&s, pyValue);
+	}
+
+	Bench::report(fmt::format("{} encode({})", name, generic ? "generic" : "codec"),
+		loops, timestamp() - startTime, loops * bytes);
+
+	// 字典的解码两者都经过FixedDictType， 只对比数值数组
+	if(!generic || pType->getDataType()->type() != DATA_TYPE_FIXEDDICT)
+	{
+		startTime = timestamp();
+
+		for(uint64 i = 0; i < loops; ++i)
+		{
+			s.rpos(0);
+
+			PyObject* pyResult = generic ? genericArrayFromStream(pType, &s) : pType->createFromStream(&s);
+			Py_DECREF(pyResult);
+		}
+
+		Bench::report(fmt::format("{} decode({})", name, generic ? "generic" : "codec"),
+			loops, timestamp() - startTime, loops * bytes);
+	}
+
+	if(!generic)
+		Bench::note(fmt::format("{} size", name), fmt::format("{} bytes, {} items", bytes, items));
+
+	Py_DECREF(pyValue);
+}
+
+//-------------------------------------------------------------------------------------
+static void benchDataTypeCodec()
+{
+	if(!loadBenchTypes())
+	{
+		printf("datatype_codec: load types failed, skipped.\n");
+		return;
+	}
+
+	FixedArrayType* pInt32Array = static_cast<FixedArrayType*>(DataTypes::getDataType("BENCH_INT32_ARRAY"));
+	FixedArrayType* pFloatArray = static_cast<FixedArrayType*>(DataTypes::getDataType("BENCH_FLOAT_ARRAY"));
+	FixedArrayType* pItemArray = static_cast<FixedArrayType*>(DataTypes::getDataType("BENCH_ITEM_ARRAY"));
+
+	const int NUMBERS = 500, ITEMS = 200;
+
+	PyObject* pyInts = PyList_New(NUMBERS);
+	PyObject* pyFloats = PyList_New(NUMBERS);
+	for(int i = 0; i < NUMBERS; ++i)
+	{
+		PyList_SET_ITEM(pyInts, i, PyLong_FromLong(i * 7919 - 100000));
+		PyList_SET_ITEM(pyFloats, i, PyFloat_FromDouble(i * 0.25));
+	}
+
+	PyObject* pyItems = PyList_New(ITEMS);
+	for(int i = 0; i < ITEMS; ++i)
+	{
+		PyObject* pyItem = PyDict_New();
+		PyObject* pyVal = PyLong_FromUnsignedLongLong(1000000000ULL + i);
+		PyDict_SetItemString(pyItem, "id", pyVal);
+		Py_DECREF(pyVal);
+
+		pyVal = PyLong_FromLong(2000 + i % 50);
+		PyDict_SetItemString(pyItem, "itemType", pyVal);
+		Py_DECREF(pyVal);
+
+		pyVal = PyLong_FromLong(1 + i % 99);
+		PyDict_SetItemString(pyItem, "count", pyVal);
+		Py_DECREF(pyVal);
+
+		pyVal = PyLong_FromLong(i % 256);
+		PyDict_SetItemString(pyItem, "slot", pyVal);
+		Py_DECREF(pyVal);
+
+		PyList_SET_ITEM(pyItems, i, pyItem);
+	}
+
+	benchArray("ARRAY<INT32>[500]", pInt32Array, pyInts, true);
+	benchArray("ARRAY<INT32>[500]", pInt32Array, pyInts, false);
+	benchArray("ARRAY<FLOAT>[500]", pFloatArray, pyFloats, true);
+	benchArray("ARRAY<FLOAT>[500]", pFloatArray, pyFloats, false);
+	benchArray("ARRAY<FIXED_DICT>[200]", pItemArray, pyItems, true);
+	benchArray("ARRAY<FIXED_DICT>[200]", pItemArray, pyItems, false);
+
+	Py_DECREF(pyInts);
+	Py_DECREF(pyFloats);
+	Py_DECREF(pyItems);
+}
+
+BENCH_REGISTER("datatype_codec", "FIXED_DICT/ARRAY encode and decode, per-item DataType vs precompiled codec", benchDataTypeCodec);
+
+//-------------------------------------------------------------------------------------
+}
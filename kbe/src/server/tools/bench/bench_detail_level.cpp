@@ -0,0 +1,128 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bench.h"
+#include "cellapp/detail_level_batch.h"
+
+namespace KBEngine{
+
+/*
+	属性改变时对观察者的详情级别判定(Entity::onDefDataChanged)
+	cellapp: 每个观察者单独计算距离并判定级别。
+	候选: 观察者位置收集到DetailLevelBatch中一次判定， 只有比前者快时才会用到cellapp中。
+	space中有N个实体， 每个实体约有N/10个观察者， 一个tick内每个实体都改变一次属性。
+*/
+static void benchDetailLevelSpace(int numEntities, DetailLevel& detailLevel)
+{
+	int numObservers = numEntities / 10;
+
+	// 实体i的观察者为其后连续的numObservers个实体， 末尾重复开头的部分以免取模
+	std::vector<Position3D> positions(numEntities + numObservers + 1);
+	for(size_t i = 0; i < positions.size(); ++i)
+	{
+		int idx = int(i) % numEntities;
+		positions[i].x = float((idx * 7919) % 2000) * 0.1f;
+		positions[i].y = float(idx % 7);
+		positions[i].z = float((idx * 104729) % 2000) * 0.1f;
+	}
+
+	uint64 ticks = Bench::scaled(3);
+	uint64 pairs = ticks * numEntities * numObservers;
+	uint64 inLevel = 0;
+
+	uint64 startTime = timestamp();
+	for(uint64 tick = 0; tick < ticks; ++tick)
+	{
+		const Position3D* pPositions = Bench::opaque(&positions[0]);
+
+		for(int i = 0; i < numEntities; ++i)
+		{
+			const Position3D& basePos = pPositions[i];
+			int propertyDetailLevel = i % 3;
+
+			for(int j = 1; j <= numObservers; ++j)
+			{
+				Position3D lengthPos = pPositions[i + j] - basePos;
+				if(detailLevel.level[propertyDetailLevel].inLevel(KBEVec3Length(&lengthPos)))
+					++inLevel;
+			}
+		}
+	}
+
+	uint64 scalarStamps = timestamp() - startTime;
+	Bench::report(fmt::format("{} entities x {} observers(per pair)", numEntities, numObservers),
+		pairs, scalarStamps);
+
+	Bench::consume(inLevel);
+	inLevel = 0;
+
+	DetailLevelBatch batch;
+
+	startTime = timestamp();
+	for(uint64 tick = 0; tick < ticks; ++tick)
+	{
+		const Position3D* pPositions = Bench::opaque(&positions[0]);
+
+		for(int i = 0; i < numEntities; ++i)
+		{
+			int propertyDetailLevel = i % 3;
+
+			batch.clear();
+			for(int j = 1; j <= numObservers; ++j)
+				batch.add(NULL, pPositions[i + j]);
+
+			batch.classify(pPositions[i], detailLevel);
+
+			for(size_t j = 0; j < batch.size(); ++j)
+			{
+				if(batch.inLevel(j, propertyDetailLevel))
+					++inLevel;
+			}
+		}
+	}
+
+	uint64 batchStamps = timestamp() - startTime;
+	Bench::report(fmt::format("{} entities x {} observers(DetailLevelBatch)", numEntities, numObservers),
+		pairs, batchStamps);
+
+	Bench::consume(inLevel);
+
+	double stampsPerMs = stampsPerSecondD() / 1000.0;
+	Bench::note(fmt::format("{} entities per tick", numEntities),
+		fmt::format("{:.2f} ms -> {:.2f} ms", scalarStamps / stampsPerMs / ticks, batchStamps / stampsPerMs / ticks));
+}
+
+//-------------------------------------------------------------------------------------
+static void benchDetailLevel()
+{
+	DetailLevel detailLevel;
+	detailLevel.level[0].radius = 30.f;
+	detailLevel.level[1].radius = 60.f;
+	detailLevel.level[2].radius = 100.f;
+
+	benchDetailLevelSpace(1000, detailLevel);
+	benchDetailLevelSpace(5000, detailLevel);
+	benchDetailLevelSpace(10000, detailLevel);
+}
+
+BENCH_REGISTER("detail_level", "detail-level classification of observers in 1k-10k entity spaces, per pair vs batched", benchDetailLevel);
+
+//-------------------------------------------------------------------------------------
+}
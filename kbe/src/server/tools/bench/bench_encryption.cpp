@@ -0,0 +1,185 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bench.h"
+#include "network/encryption_filter.h"
+#include "network/tcp_packet.h"
+
+namespace KBEngine{
+
+/*
+	单核的包加密吞吐量， 与过滤器的send/recv处理包的方式一致
+	BlowfishFilter: 加密到另一个包再交换， 接收端跳过长度和填充头后原地解密。
+	AesGcmFilter: 原地加密为一条记录， 接收端原地验证并解密。
+	每个包都从池中取出并填入明文， 处理完归还， 加密与往返(加密+解密)分别计时。
+*/
+static const int BENCH_ENCRYPTION_ROUNDS = 200000;
+
+//-------------------------------------------------------------------------------------
+static void benchBlowfishEncrypt(Network::BlowfishFilter& filter, Network::Packet* pPacket)
+{
+	Network::Packet* pOutPacket = Network::TCPPacket::createPoolObject();
+
+	Network::PacketLength oldlen = (Network::PacketLength)pPacket->length();
+	pOutPacket->wpos(sizeof(Network::PacketLength) + 1);
+	filter.encrypt(pPacket, pOutPacket);
+
+	Network::PacketLength packetLen = (Network::PacketLength)(pPacket->length() + 1);
+	uint8 padSize = (uint8)(pPacket->length() - oldlen);
+	size_t oldwpos = pOutPacket->wpos();
+	pOutPacket->wpos(0);
+
+	(*pOutPacket) << packetLen;
+	(*pOutPacket) << padSize;
+
+	pOutPacket->wpos((int)oldwpos);
+	pPacket->swap(*(static_cast<KBEngine::MemoryStream*>(pOutPacket)));
+	Network::TCPPacket::reclaimPoolObject(static_cast<Network::TCPPacket*>(pOutPacket));
+}
+
+//-------------------------------------------------------------------------------------
+static void benchBlowfishDecrypt(Network::BlowfishFilter& filter, Network::Packet* pPacket)
+{
+	Network::PacketLength packetLen;
+	uint8 padSize;
+
+	(*pPacket) >> packetLen;
+	(*pPacket) >> padSize;
+
+	filter.decrypt(pPacket, pPacket);
+	pPacket->wpos((int)(pPacket->wpos() - padSize));
+}
+
+//-------------------------------------------------------------------------------------
+static Network::TCPPacket* benchEncryptionPacket(const std::vector<uint8>& plain)
+{
+	Network::TCPPacket* pPacket = Network::TCPPacket::createPoolObject();
+	pPacket->append(&plain[0], plain.size());
+	return pPacket;
+}
+
+//-------------------------------------------------------------------------------------
+static bool benchEncryptionCheck(Network::TCPPacket* pPacket, const std::vector<uint8>& plain)
+{
+	bool ok = pPacket->length() == plain.size() &&
+		memcmp(pPacket->data() + pPacket->rpos(), &plain[0], plain.size()) == 0;
+
+	Network::TCPPacket::reclaimPoolObject(pPacket);
+	return ok;
+}
+
+//-------------------------------------------------------------------------------------
+static void benchEncryptionSize(size_t size)
+{
+	std::vector<uint8> plain(size);
+	for(size_t i = 0; i < size; ++i)
+		plain[i] = (uint8)(i * 31 + 7);
+
+	uint64 rounds = Bench::scaled(BENCH_ENCRYPTION_ROUNDS);
+	uint64 bytes = rounds * size;
+	uint64 checksum = 0;
+
+	bool ok = true;
+
+	{
+		Network::BlowfishFilter client;
+		Network::BlowfishFilter server(client.key());
+
+		uint64 startTime = timestamp();
+		for(uint64 i = 0; i < rounds; ++i)
+		{
+			Network::TCPPacket* pPacket = benchEncryptionPacket(plain);
+			benchBlowfishEncrypt(client, pPacket);
+			checksum += pPacket->wpos();
+			Network::TCPPacket::reclaimPoolObject(pPacket);
+		}
+
+		Bench::report(fmt::format("{} byte packets, blowfish encrypt", size), rounds, timestamp() - startTime, bytes);
+
+		startTime = timestamp();
+		for(uint64 i = 0; i < rounds; ++i)
+		{
+			Network::TCPPacket* pPacket = benchEncryptionPacket(plain);
+			benchBlowfishEncrypt(client, pPacket);
+			benchBlowfishDecrypt(server, pPacket);
+			ok = benchEncryptionCheck(pPacket, plain) && ok;
+		}
+
+		Bench::report(fmt::format("{} byte packets, blowfish round trip", size), rounds, timestamp() - startTime, bytes);
+
+		if(!ok)
+			Bench::note("blowfish", "decrypted data mismatch!");
+	}
+
+	{
+		Network::AesGcmFilter client;
+		Network::AesGcmFilter server(client.key());
+
+		if(!client.isGood() || !server.isGood())
+		{
+			Bench::note("aes-128-gcm", "openssl init failed, skipped");
+			return;
+		}
+
+		uint64 startTime = timestamp();
+		for(uint64 i = 0; i < rounds; ++i)
+		{
+			Network::TCPPacket* pPacket = benchEncryptionPacket(plain);
+			client.encrypt(pPacket, pPacket);
+			checksum += pPacket->wpos();
+			Network::TCPPacket::reclaimPoolObject(pPacket);
+		}
+
+		Bench::report(fmt::format("{} byte packets, aes-128-gcm encrypt", size), rounds, timestamp() - startTime, bytes);
+
+		// 上面的加密推进了client的记录计数， 往返使用新的一对
+		Network::AesGcmFilter roundClient;
+		Network::AesGcmFilter roundServer(roundClient.key());
+
+		startTime = timestamp();
+		for(uint64 i = 0; i < rounds; ++i)
+		{
+			Network::TCPPacket* pPacket = benchEncryptionPacket(plain);
+			roundClient.encrypt(pPacket, pPacket);
+			roundServer.decrypt(pPacket, pPacket);
+			ok = benchEncryptionCheck(pPacket, plain) && ok;
+		}
+
+		Bench::report(fmt::format("{} byte packets, aes-128-gcm round trip", size), rounds, timestamp() - startTime, bytes);
+
+		if(!ok || !roundServer.isGood())
+			Bench::note("aes-128-gcm", "decrypted data mismatch!");
+	}
+
+	Bench::consume(checksum);
+}
+
+//-------------------------------------------------------------------------------------
+static void benchEncryption()
+{
+	// 客户端常见的小包与接近PACKET_MAX_SIZE_TCP的满包
+	benchEncryptionSize(200);
+	benchEncryptionSize(1400);
+}
+
+BENCH_REGISTER("encryption", "per-core packet encryption throughput, blowfish vs aes-128-gcm", benchEncryption);
+
+//-------------------------------------------------------------------------------------
+}
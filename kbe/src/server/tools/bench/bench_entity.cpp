@@ -0,0 +1,134 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bench.h"
+#include "bench_entity.h"
+#include "cellapp/entity.h"
+#include "entitydef/scriptdef_module.h"
+
+namespace KBEngine{
+
+static PyObject* g_pyBenchEntityType = NULL;
+static std::vector<ScriptDefModule*> g_benchScriptModules;
+static std::vector<Entity*> g_benchEntities;
+
+static const char* BENCH_ENTITY_SCRIPT =
+	"import KBEngine\n"
+	"class BenchEntity(KBEngine.Entity):\n"
+	"	trapEvents = 0\n"
+	"	def onEnterTrap(self, entity, rangeXZ, rangeY, controllerID, userarg):\n"
+	"		BenchEntity.trapEvents += 1\n"
+	"	def onLeaveTrap(self, entity, rangeXZ, rangeY, controllerID, userarg):\n"
+	"		BenchEntity.trapEvents += 1\n";
+
+//-------------------------------------------------------------------------------------
+bool BenchEntities::initialize()
+{
+	if(g_pyBenchEntityType)
+		return true;
+
+	if(!Bench::installPython())
+		return false;
+
+	// 与Cellapp::installPyModules一致
+	PyObject* pyModule = PyImport_AddModule("KBEngine");
+	if(pyModule == NULL)
+	{
+		PyErr_PrintEx(0);
+		return false;
+	}
+
+	Entity::installScript(pyModule);
+
+	PyObject* pyDict = PyDict_New();
+	PyDict_SetItemString(pyDict, "__builtins__", PyEval_GetBuiltins());
+
+	PyObject* pyResult = PyRun_String(BENCH_ENTITY_SCRIPT, Py_file_input, pyDict, pyDict);
+	if(pyResult == NULL)
+	{
+		PyErr_PrintEx(0);
+		Py_DECREF(pyDict);
+		return false;
+	}
+
+	Py_DECREF(pyResult);
+
+	g_pyBenchEntityType = PyDict_GetItemString(pyDict, "BenchEntity");
+	Py_INCREF(g_pyBenchEntityType);
+	Py_DECREF(pyDict);
+
+	for(int i = 0; i < BENCH_ENTITY_UTYPES; ++i)
+	{
+		ScriptDefModule* pScriptModule = new ScriptDefModule("BenchEntity", ENTITY_SCRIPT_UID(i + 1));
+		pScriptModule->setScriptType((PyTypeObject*)g_pyBenchEntityType);
+		pScriptModule->setCell(true);
+		g_benchScriptModules.push_back(pScriptModule);
+	}
+
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+Entity* BenchEntities::get(size_t idx)
+{
+	while(g_benchEntities.size() <= idx)
+	{
+		size_t newIdx = g_benchEntities.size();
+		ScriptDefModule* pScriptModule = g_benchScriptModules[newIdx % BENCH_ENTITY_UTYPES];
+
+		// 与EntityApp::onCreateEntity一致
+		PyObject* pyEntity = pScriptModule->createObject();
+		g_benchEntities.push_back(new(pyEntity) Entity(ENTITY_ID(newIdx + 1), pScriptModule));
+	}
+
+	return g_benchEntities[idx];
+}
+
+//-------------------------------------------------------------------------------------
+int BenchEntities::utype(size_t idx)
+{
+	return int(idx % BENCH_ENTITY_UTYPES) + 1;
+}
+
+//-------------------------------------------------------------------------------------
+uint64 BenchEntities::trapEvents()
+{
+	PyObject* pyEvents = PyObject_GetAttrString(g_pyBenchEntityType, "trapEvents");
+	if(pyEvents == NULL)
+	{
+		PyErr_Clear();
+		return 0;
+	}
+
+	uint64 events = PyLong_AsUnsignedLongLong(pyEvents);
+	Py_DECREF(pyEvents);
+	return events;
+}
+
+//-------------------------------------------------------------------------------------
+void BenchEntities::resetTrapEvents()
+{
+	PyObject* pyEvents = PyLong_FromLong(0);
+	PyObject_SetAttrString(g_pyBenchEntityType, "trapEvents", pyEvents);
+	Py_DECREF(pyEvents);
+}
+
+//-------------------------------------------------------------------------------------
+}
@@ -0,0 +1,65 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KBE_BENCH_ENTITY_H
+#define KBE_BENCH_ENTITY_H
+
+#include "common/common.h"
+
+namespace KBEngine{
+
+class Entity;
+
+/*
+	需要cellapp实体的基准(陷阱、范围查询)使用的实体
+	实体由cellapp的Entity构造， 脚本类型是继承KBEngine.Entity的BenchEntity， 只实现onEnterTrap与onLeaveTrap并计数。
+	实体没有加入space， 基准自己把实体放入CoordinateSystem或ProximityGrid。
+	Entity的析构依赖Cellapp单例， 创建的实体保留到进程退出， 各基准之间复用。
+*/
+class BenchEntities
+{
+public:
+	/**
+		BenchEntity脚本类型有BENCH_ENTITY_UTYPES个， 第idx个实体的类型为idx % BENCH_ENTITY_UTYPES
+	*/
+	enum
+	{
+		BENCH_ENTITY_UTYPES = 4
+	};
+
+	static bool initialize();
+
+	/**
+		第idx个实体， 不足时创建， 实体ID为idx + 1
+	*/
+	static Entity* get(size_t idx);
+
+	static int utype(size_t idx);
+
+	/**
+		onEnterTrap与onLeaveTrap被调用的总次数
+	*/
+	static uint64 trapEvents();
+	static void resetTrapEvents();
+};
+
+}
+
+#endif // KBE_BENCH_ENTITY_H
@@ -0,0 +1,212 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bench.h"
+#include "network/channel.h"
+#include "network/message_handler.h"
+#include "network/packet_reader.h"
+#include "network/tcp_packet.h"
+
+namespace KBEngine{
+
+/*
+	组件之间大消息的接收吞吐量
+	消息流按PACKET_MAX_SIZE_TCP切分成TCPPacket依次交给PacketReader::processMessages， 大多数消息都跨包。
+	之前: 跨包的消息每次new一块内存拼接， 拼接完成后再拷贝到一个池中的MemoryStream再派发(BenchCopyingPacketReader)。
+	现在: 分片直接拼接到reader复用的MemoryStream中， 在缓冲区上原地派发。
+*/
+class BenchMessageHandler : public Network::MessageHandler
+{
+public:
+	virtual void handle(Network::Channel* pChannel, MemoryStream& s)
+	{
+		Bench::consume(s.length());
+		s.done();
+	}
+};
+
+/*
+	修改前的分片拼接方式
+*/
+class BenchCopyingPacketReader : public Network::PacketReader
+{
+public:
+	BenchCopyingPacketReader(Network::Channel* pChannel):
+	Network::PacketReader(pChannel),
+	pFragmentDatas_(NULL),
+	fragmentDatasWpos_(0)
+	{
+	}
+
+	virtual ~BenchCopyingPacketReader()
+	{
+		SAFE_RELEASE_ARRAY(pFragmentDatas_);
+	}
+
+protected:
+	virtual void writeFragmentMessage(FragmentDataTypes fragmentDatasFlag, Network::Packet* pPacket, uint32 datasize)
+	{
+		size_t opsize = pPacket->length();
+		pFragmentDatasRemain_ = datasize - opsize;
+		pFragmentDatas_ = new uint8[opsize + pFragmentDatasRemain_ + 1];
+
+		fragmentDatasFlag_ = fragmentDatasFlag;
+		fragmentDatasWpos_ = opsize;
+
+		if(opsize > 0)
+		{
+			memcpy(pFragmentDatas_, pPacket->data() + pPacket->rpos(), opsize);
+			pPacket->done();
+		}
+	}
+
+	virtual void mergeFragmentMessage(Network::Packet* pPacket)
+	{
+		size_t opsize = pPacket->length();
+		if(opsize == 0)
+			return;
+
+		if(opsize >= pFragmentDatasRemain_)
+		{
+			memcpy(pFragmentDatas_ + fragmentDatasWpos_, pPacket->data() + pPacket->rpos(), pFragmentDatasRemain_);
+			pPacket->rpos(pPacket->rpos() + pFragmentDatasRemain_);
+
+			switch(fragmentDatasFlag_)
+			{
+			case FRAGMENT_DATA_MESSAGE_ID:
+				memcpy(&currMsgID_, pFragmentDatas_, NETWORK_MESSAGE_ID_SIZE);
+				break;
+
+			case FRAGMENT_DATA_MESSAGE_LENGTH:
+				memcpy(&currMsgLen_, pFragmentDatas_, NETWORK_MESSAGE_LENGTH_SIZE);
+				break;
+
+			case FRAGMENT_DATA_MESSAGE_LENGTH1:
+				memcpy(&currMsgLen_, pFragmentDatas_, NETWORK_MESSAGE_LENGTH1_SIZE);
+				break;
+
+			case FRAGMENT_DATA_MESSAGE_BODY:
+				// 之前每条消息派发后都归还到池中
+				if(pFragmentStream_)
+					MemoryStream::reclaimPoolObject(pFragmentStream_);
+
+				pFragmentStream_ = MemoryStream::createPoolObject();
+				pFragmentStream_->append(pFragmentDatas_, currMsgLen_);
+				fragmentBodyReady_ = true;
+				break;
+
+			default:
+				break;
+			};
+
+			fragmentDatasFlag_ = FRAGMENT_DATA_UNKNOW;
+			pFragmentDatasRemain_ = 0;
+			SAFE_RELEASE_ARRAY(pFragmentDatas_);
+		}
+		else
+		{
+			memcpy(pFragmentDatas_ + fragmentDatasWpos_, pPacket->data() + pPacket->rpos(), opsize);
+			pFragmentDatasRemain_ -= opsize;
+			fragmentDatasWpos_ += opsize;
+			pPacket->rpos(pPacket->rpos() + opsize);
+		}
+	}
+
+private:
+	uint8* pFragmentDatas_;
+	uint32 fragmentDatasWpos_;
+};
+
+//-------------------------------------------------------------------------------------
+static void benchPacketReaderRun(Network::PacketReader& reader, Network::MessageHandlers& msgHandlers,
+	std::vector<Network::TCPPacket*>& packets, uint64 loops, uint64 streamSize, const std::string& name)
+{
+	uint64 startTime = timestamp();
+	for(uint64 i = 0; i < loops; ++i)
+	{
+		for(size_t j = 0; j < packets.size(); ++j)
+		{
+			packets[j]->rpos(0);
+			reader.processMessages(&msgHandlers, packets[j]);
+		}
+	}
+
+	Bench::report(name, loops * packets.size(), timestamp() - startTime, loops * streamSize);
+}
+
+//-------------------------------------------------------------------------------------
+static void benchPacketReader()
+{
+	static Network::MessageHandlers s_msgHandlers("bench");
+	static Network::MessageHandler* s_pMsgHandler = NULL;
+
+	if(s_pMsgHandler == NULL)
+		s_pMsgHandler = s_msgHandlers.add("Bench::onMessage", NULL, NETWORK_VARIABLE_MESSAGE, new BenchMessageHandler());
+
+	Network::Channel channel;
+
+	// 默认构造的Channel是外部通道， 超过NETWORK_MESSAGE_MAX_SIZE的消息会被拒绝， 因此不测试扩展长度
+	uint32 msgSizes[3] = { 4096, 16384, 60000 };
+
+	for(int m = 0; m < 3; ++m)
+	{
+		uint32 msgSize = msgSizes[m];
+
+		MemoryStream stream;
+		for(int i = 0; i < 16; ++i)
+		{
+			stream << s_pMsgHandler->msgID;
+			stream << (Network::MessageLength)msgSize;
+
+			for(uint32 j = 0; j < msgSize; ++j)
+				stream << (uint8)(j * 31);
+		}
+
+		std::vector<Network::TCPPacket*> packets;
+		for(size_t pos = 0; pos < stream.wpos(); pos += PACKET_MAX_SIZE_TCP)
+		{
+			Network::TCPPacket* pPacket = Network::TCPPacket::createPoolObject();
+			pPacket->append(stream.data() + pos, std::min((size_t)PACKET_MAX_SIZE_TCP, stream.wpos() - pos));
+			packets.push_back(pPacket);
+		}
+
+		uint64 loops = Bench::scaled(200000000 / stream.wpos() + 1);
+
+		{
+			BenchCopyingPacketReader reader(&channel);
+			benchPacketReaderRun(reader, s_msgHandlers, packets, loops, stream.wpos(),
+				fmt::format("{} byte messages(copying reassembly)", msgSize));
+		}
+
+		{
+			Network::PacketReader reader(&channel);
+			benchPacketReaderRun(reader, s_msgHandlers, packets, loops, stream.wpos(),
+				fmt::format("{} byte messages(reused fragment stream)", msgSize));
+		}
+
+		for(size_t i = 0; i < packets.size(); ++i)
+			Network::TCPPacket::reclaimPoolObject(packets[i]);
+	}
+}
+
+BENCH_REGISTER("packet_reader", "receive throughput of large messages split across TCP packets", benchPacketReader);
+
+//-------------------------------------------------------------------------------------
+}
@@ -0,0 +1,197 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bench.h"
+#include "bench_entity.h"
+#include "cellapp/entity.h"
+#include "cellapp/coordinate_system.h"
+#include "cellapp/proximity_controller.h"
+#include "cellapp/proximity_grid.h"
+#include "server/serverconfig.h"
+
+namespace KBEngine{
+
+/*
+	10k个陷阱(addProximity)时实体移动的陷阱判定开销， 使用cellapp的Entity、ProximityController、CoordinateSystem与ProximityGrid。
+	坐标轴: 实体节点装入CoordinateSystem， 陷阱是ProximityController的TrapTrigger， 移动实体时由Entity::position更新节点。
+	网格: 实体与陷阱加入ProximityGrid， 移动实体后调用ProximityGrid::onEntityMoved， 与Entity::updateProximityGrid一致。
+	实体没有加入space， ProximityController::installToGrid找不到space， 网格的陷阱由基准直接加入。
+	陷阱的主人是静止的NPC， 玩家在space中随机移动， 进入离开事件由脚本的onEnterTrap、onLeaveTrap计数。
+	坐标轴逐个轴移动， 一次斜穿陷阱角落的移动会先进入再离开， 因此事件数量略多于网格(只比较移动前后的状态)。
+*/
+static const int BENCH_PROXIMITY_TRAPS = 10000;
+static const int BENCH_PROXIMITY_PLAYERS = 1000;
+static const float BENCH_PROXIMITY_SPACE_SIZE = 2000.f;
+static const float BENCH_PROXIMITY_TRAP_RANGE = 10.f;
+
+//-------------------------------------------------------------------------------------
+static uint32 benchProximityRandom(uint32& seed)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+//-------------------------------------------------------------------------------------
+static float benchProximityRandomFloat(uint32& seed, float range)
+{
+	return float(benchProximityRandom(seed) % 1000000) / 1000000.f * range;
+}
+
+//-------------------------------------------------------------------------------------
+static void benchProximityMove(const std::vector<Entity*>& players, const std::vector<Position3D>& steps, 
+	ProximityGrid* pGrid)
+{
+	for(size_t i = 0; i < steps.size(); ++i)
+	{
+		Entity* pEntity = players[i % players.size()];
+
+		Position3D pos = pEntity->position();
+		pos += steps[i];
+		pEntity->position(pos);
+
+		if(pGrid)
+			pGrid->onEntityMoved(pEntity);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+static void benchProximity()
+{
+	if(!BenchEntities::initialize())
+	{
+		Bench::note("proximity", "skipped, cannot create entities");
+		return;
+	}
+
+	uint32 seed = 0x12345678;
+
+	// 前BENCH_PROXIMITY_TRAPS个实体是陷阱的主人， 之后是玩家
+	std::vector<Entity*> entities, owners, players;
+	std::vector<Position3D> startPositions;
+
+	for(int i = 0; i < BENCH_PROXIMITY_TRAPS + BENCH_PROXIMITY_PLAYERS; ++i)
+	{
+		Entity* pEntity = BenchEntities::get(i);
+		entities.push_back(pEntity);
+
+		if(i < BENCH_PROXIMITY_TRAPS)
+			owners.push_back(pEntity);
+		else
+			players.push_back(pEntity);
+
+		float x = benchProximityRandomFloat(seed, BENCH_PROXIMITY_SPACE_SIZE);
+		float z = benchProximityRandomFloat(seed, BENCH_PROXIMITY_SPACE_SIZE);
+		startPositions.push_back(Position3D(x, 0.f, z));
+	}
+
+	// 每个tick每个玩家移动不超过1米
+	uint64 ticks = Bench::scaled(200);
+	uint64 moves = ticks * BENCH_PROXIMITY_PLAYERS;
+
+	std::vector<Position3D> steps((size_t)moves);
+	for(uint64 i = 0; i < moves; ++i)
+	{
+		steps[(size_t)i].x = benchProximityRandomFloat(seed, 2.f) - 1.f;
+		steps[(size_t)i].z = benchProximityRandomFloat(seed, 2.f) - 1.f;
+	}
+
+	std::vector<ProximityController*> controllers;
+
+	if(entities[0]->pEntityCoordinateNode())
+	{
+		CoordinateSystem coordinateSystem;
+		for(size_t i = 0; i < entities.size(); ++i)
+		{
+			entities[i]->position(startPositions[i]);
+			entities[i]->installCoordinateNodes(&coordinateSystem);
+		}
+
+		for(int i = 0; i < BENCH_PROXIMITY_TRAPS; ++i)
+		{
+			controllers.push_back(new ProximityController(owners[i], BENCH_PROXIMITY_TRAP_RANGE, 
+				BENCH_PROXIMITY_TRAP_RANGE, 0, i + 1));
+		}
+
+		BenchEntities::resetTrapEvents();
+
+		uint64 startTime = timestamp();
+		benchProximityMove(players, steps, NULL);
+
+		Bench::report(fmt::format("{} traps, move(coordinate lists)", BENCH_PROXIMITY_TRAPS), moves, timestamp() - startTime);
+		Bench::note("enter/leave events(coordinate lists)", fmt::format("{}", BenchEntities::trapEvents()));
+
+		// 与Space::removeEntity一致， 先卸载陷阱再卸载实体节点
+		for(size_t i = 0; i < controllers.size(); ++i)
+			delete controllers[i];
+
+		controllers.clear();
+
+		for(size_t i = 0; i < entities.size(); ++i)
+			entities[i]->uninstallCoordinateNodes(&coordinateSystem);
+
+		coordinateSystem.releaseNodes();
+	}
+	else
+	{
+		Bench::note("coordinate lists", "skipped, cellapp/coordinate_system is disabled");
+	}
+
+	ProximityGrid* pGrid = new ProximityGrid(g_kbeSrvConfig.getCellApp().proximity_grid_cell_size);
+	for(size_t i = 0; i < entities.size(); ++i)
+	{
+		entities[i]->position(startPositions[i]);
+		pGrid->addEntity(entities[i]);
+	}
+
+	for(int i = 0; i < BENCH_PROXIMITY_TRAPS; ++i)
+	{
+		ProximityController* pController = new ProximityController(owners[i], BENCH_PROXIMITY_TRAP_RANGE, 
+			BENCH_PROXIMITY_TRAP_RANGE, 0, i + 1, true);
+
+		pGrid->addTrap(pController, owners[i], BENCH_PROXIMITY_TRAP_RANGE, BENCH_PROXIMITY_TRAP_RANGE);
+		controllers.push_back(pController);
+	}
+
+	BenchEntities::resetTrapEvents();
+
+	uint64 startTime = timestamp();
+	benchProximityMove(players, steps, pGrid);
+
+	Bench::report(fmt::format("{} traps, move(proximity grid)", BENCH_PROXIMITY_TRAPS), moves, timestamp() - startTime);
+	Bench::note("enter/leave events(proximity grid)", fmt::format("{}", BenchEntities::trapEvents()));
+
+	for(size_t i = 0; i < controllers.size(); ++i)
+	{
+		pGrid->removeTrap(controllers[i]);
+		delete controllers[i];
+	}
+
+	for(size_t i = 0; i < entities.size(); ++i)
+		pGrid->removeEntity(entities[i]);
+
+	delete pGrid;
+}
+
+BENCH_REGISTER("proximity", "entity moves against 10k proximity traps, coordinate lists vs proximity grid", benchProximity);
+
+//-------------------------------------------------------------------------------------
+}
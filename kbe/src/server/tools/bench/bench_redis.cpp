@@ -0,0 +1,184 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bench.h"
+#include "server/serverconfig.h"
+#include "db_redis/db_interface_redis.h"
+#include "db_redis/db_pipeline.h"
+
+namespace KBEngine{
+
+/*
+	redis后端的实体写入
+	一次实体写入按每个属性一条HSET建模， 对比逐条阻塞query、一次管道、MULTI/EXEC管道以及多个实体合并为一次管道，
+	输出每秒写入的实体数与p99延迟。
+	使用配置中第一个redis类型的数据库接口， 没有则连接本机6379端口， 写入的key以kbe_bench_为前缀， 结束后删除。
+*/
+class BenchRedisInterface : public DBInterfaceRedis
+{
+public:
+	BenchRedisInterface(const DBInterfaceInfo& info):
+	DBInterfaceRedis(info.name)
+	{
+		db_port_ = info.db_port;
+		kbe_snprintf(db_ip_, MAX_IP, "%s", info.db_ip);
+		kbe_snprintf(db_password_, MAX_BUF * 10, "%s", info.db_password);
+	}
+};
+
+static const int BENCH_REDIS_FIELDS = 12;
+static const int BENCH_REDIS_BATCH = 16;
+
+enum BenchRedisMode
+{
+	BENCH_REDIS_QUERY,
+	BENCH_REDIS_PIPELINE,
+	BENCH_REDIS_PIPELINE_MULTI,
+	BENCH_REDIS_PIPELINE_BATCH
+};
+
+//-------------------------------------------------------------------------------------
+static std::string benchRedisCommand(uint64 dbid, int field, uint64 loop)
+{
+	return fmt::format("HSET kbe_bench_Avatar:{} sm_field{} {}", dbid, field, loop * 31 + field);
+}
+
+//-------------------------------------------------------------------------------------
+static void benchRedisWrites(DBInterfaceRedis* pdbi, BenchRedisMode mode, const char* name)
+{
+	int entitiesPerOp = mode == BENCH_REDIS_PIPELINE_BATCH ? BENCH_REDIS_BATCH : 1;
+	uint64 ops = Bench::scaled(20000) / entitiesPerOp;
+	if(ops == 0)
+		ops = 1;
+
+	std::vector<uint64> latencies;
+	latencies.reserve((size_t)ops);
+
+	uint64 startTime = timestamp();
+
+	for(uint64 i = 0; i < ops; ++i)
+	{
+		uint64 opStartTime = timestamp();
+
+		if(mode == BENCH_REDIS_QUERY)
+		{
+			for(int field = 0; field < BENCH_REDIS_FIELDS; ++field)
+			{
+				redisReply* pRedisReply = NULL;
+				pdbi->query(benchRedisCommand(i % 1000, field, i), &pRedisReply, false);
+
+				if(pRedisReply)
+					freeReplyObject(pRedisReply);
+			}
+		}
+		else
+		{
+			redis::DBPipeline pipeline(pdbi, mode == BENCH_REDIS_PIPELINE_MULTI);
+
+			for(int e = 0; e < entitiesPerOp; ++e)
+			{
+				uint64 dbid = (i * entitiesPerOp + e) % 1000;
+				for(int field = 0; field < BENCH_REDIS_FIELDS; ++field)
+					pipeline.append(benchRedisCommand(dbid, field, i));
+			}
+
+			pipeline.commit();
+		}
+
+		latencies.push_back(timestamp() - opStartTime);
+	}
+
+	uint64 elapsed = timestamp() - startTime;
+
+	Bench::report(fmt::format("{} ({} HSET/entity)", name, BENCH_REDIS_FIELDS), ops * entitiesPerOp, elapsed);
+
+	std::sort(latencies.begin(), latencies.end());
+	double p99 = double(latencies[(size_t)((latencies.size() - 1) * 0.99)]) / stampsPerSecondD() * 1e6;
+
+	Bench::note(fmt::format("{} p99", name), entitiesPerOp > 1 ?
+		fmt::format("{:.1f} us per batch of {}", p99, entitiesPerOp) : fmt::format("{:.1f} us", p99));
+}
+
+//-------------------------------------------------------------------------------------
+static void benchRedisCleanup(DBInterfaceRedis* pdbi)
+{
+	redis::DBPipeline pipeline(pdbi);
+
+	for(int dbid = 0; dbid < 1000; ++dbid)
+		pipeline.append(fmt::format("DEL kbe_bench_Avatar:{}", dbid));
+
+	pipeline.commit();
+}
+
+//-------------------------------------------------------------------------------------
+static void benchRedis()
+{
+	// 数据库接口的名字必须存在于配置中， 地址优先使用配置中的redis接口
+	std::vector<DBInterfaceInfo>& dbInterfaceInfos = g_kbeSrvConfig.getDBMgr().dbInterfaceInfos;
+	if(dbInterfaceInfos.size() == 0)
+	{
+		printf("redis: no database interface in config, skipped.\n");
+		return;
+	}
+
+	DBInterfaceInfo info = dbInterfaceInfos[0];
+	kbe_snprintf(info.db_ip, MAX_BUF, "%s", "127.0.0.1");
+	info.db_port = 6379;
+	memset(info.db_password, 0, sizeof(info.db_password));
+
+	for(size_t i = 0; i < dbInterfaceInfos.size(); ++i)
+	{
+		if(strcmp(dbInterfaceInfos[i].db_type, "redis") == 0)
+		{
+			info = dbInterfaceInfos[i];
+			break;
+		}
+	}
+
+	BenchRedisInterface* pdbi = new BenchRedisInterface(info);
+	if(!pdbi->attach())
+	{
+		printf("redis: can't connect to redis-server(%s:%u), skipped.\n", info.db_ip, info.db_port);
+		delete pdbi;
+		return;
+	}
+
+	try
+	{
+		benchRedisWrites(pdbi, BENCH_REDIS_QUERY, "query per command");
+		benchRedisWrites(pdbi, BENCH_REDIS_PIPELINE, "pipeline");
+		benchRedisWrites(pdbi, BENCH_REDIS_PIPELINE_MULTI, "pipeline MULTI/EXEC");
+		benchRedisWrites(pdbi, BENCH_REDIS_PIPELINE_BATCH, fmt::format("pipeline {} entities", BENCH_REDIS_BATCH).c_str());
+		benchRedisCleanup(pdbi);
+	}
+	catch(std::exception& e)
+	{
+		pdbi->processException(e);
+		printf("redis: query failed, stopped.\n");
+	}
+
+	pdbi->detach();
+	delete pdbi;
+}
+
+BENCH_REGISTER("redis", "redis entity writes/s and p99, per-command query vs pipelined batches", benchRedis);
+
+//-------------------------------------------------------------------------------------
+}
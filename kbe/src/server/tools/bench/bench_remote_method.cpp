@@ -0,0 +1,180 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bench.h"
+#include "network/bundle.h"
+#include "entitydef/datatypes.h"
+#include "entitydef/method.h"
+#include "entitydef/entity_call.h"
+#include "entitydef/remote_entity_method.h"
+#include "entitydef/scriptdef_module.h"
+
+namespace KBEngine{
+
+/*
+	远程方法调用(entity.client.foo(...))
+	取方法对象: 每次分配新的RemoteEntityMethod与复用entityCall中回收的对象，
+	参数打包: checkArgs后打包到栈上的流与检查参数的同时打包到对象池中的流， 两者最后都追加到bundle。
+	不经过channel发送， 只测量脚本层调用本身的开销。
+*/
+struct BenchRemoteMethodCall
+{
+	const char* name;
+	MethodDescription* pMethodDescription;
+	PyObject* pyArgs;
+};
+
+//-------------------------------------------------------------------------------------
+static MethodDescription* createBenchMethod(ENTITY_METHOD_UID utype, const char* name, const char* argTypes[], int argCount)
+{
+	MethodDescription* pMethodDescription = new MethodDescription(utype, CLIENT_TYPE, name);
+	for(int i = 0; i < argCount; ++i)
+		pMethodDescription->pushArgType(DataTypes::getDataType(argTypes[i]));
+
+	return pMethodDescription;
+}
+
+//-------------------------------------------------------------------------------------
+static void benchLookup(EntityCall* pEntityCall, MethodDescription* pMethodDescription, bool reuse)
+{
+	uint64 loops = Bench::scaled(2000000);
+	uint64 startTime = timestamp();
+
+	for(uint64 i = 0; i < loops; ++i)
+	{
+		RemoteEntityMethod* pMethod = reuse ? pEntityCall->getRemoteMethod(pMethodDescription) :
+			new RemoteEntityMethod(pMethodDescription, pEntityCall);
+
+		// 每个方法只回收一个对象， 已有回收对象时新分配的对象在这里被释放
+		Py_DECREF(pMethod);
+	}
+
+	Bench::report(reuse ? "lookup(reuse parked object)" : "lookup(new RemoteEntityMethod)",
+		loops, timestamp() - startTime);
+}
+
+//-------------------------------------------------------------------------------------
+static void benchCall(const BenchRemoteMethodCall& call, bool fused)
+{
+	MethodDescription* pMethodDescription = call.pMethodDescription;
+
+	uint64 loops = Bench::scaled(1000000);
+	uint64 startTime = timestamp();
+
+	for(uint64 i = 0; i < loops; ++i)
+	{
+		Network::Bundle* pBundle = Network::Bundle::createPoolObject();
+
+		if(fused)
+		{
+			MemoryStream* mstream = MemoryStream::createPoolObject();
+
+			if(pMethodDescription->checkArgsAndAddToStream(mstream, call.pyArgs) && mstream->wpos() > 0)
+				pBundle->append(mstream->data(), (int)mstream->wpos());
+
+			MemoryStream::reclaimPoolObject(mstream);
+		}
+		else
+		{
+			if(pMethodDescription->checkArgs(call.pyArgs))
+			{
+				MemoryStream mstream;
+				pMethodDescription->addToStream(&mstream, call.pyArgs);
+
+				if(mstream.wpos() > 0)
+					pBundle->append(mstream.data(), (int)mstream.wpos());
+			}
+		}
+
+		Bench::consume(pBundle->packetsLength());
+		Network::Bundle::reclaimPoolObject(pBundle);
+	}
+
+	Bench::report(fmt::format("{} {}", call.name, fused ? "(fused check+pooled stream)" : "(checkArgs+stack stream)"),
+		loops, timestamp() - startTime);
+}
+
+//-------------------------------------------------------------------------------------
+static void benchRemoteMethod()
+{
+	if(!Bench::initDataTypes())
+	{
+		printf("remote_method: init datatypes failed, skipped.\n");
+		return;
+	}
+
+	static bool s_installed = false;
+	if(!s_installed)
+	{
+		EntityCall::installScript(NULL);
+		s_installed = true;
+	}
+
+	ScriptDefModule* pScriptModule = new ScriptDefModule("BenchAvatar", 1);
+
+	const char* noArgs[] = { NULL };
+	const char* damageArgs[] = { "INT32" };
+	const char* chatArgs[] = { "UINT64", "UNICODE" };
+	const char* moveArgs[] = { "FLOAT", "FLOAT", "FLOAT", "UINT8" };
+
+	BenchRemoteMethodCall calls[] = {
+		{ "onTick()", createBenchMethod(1, "onTick", noArgs, 0), PyTuple_New(0) },
+		{ "onDamage(INT32)", createBenchMethod(2, "onDamage", damageArgs, 1), Py_BuildValue("(i)", 120) },
+		{ "onChat(UINT64, UNICODE)", createBenchMethod(3, "onChat", chatArgs, 2),
+			Py_BuildValue("(Ks)", (unsigned long long)1000001, "hello, world") },
+		{ "onMove(FLOAT, FLOAT, FLOAT, UINT8)", createBenchMethod(4, "onMove", moveArgs, 4),
+			Py_BuildValue("(fffi)", 10.5f, 0.f, -3.25f, 1) },
+	};
+
+	const int callCount = sizeof(calls) / sizeof(calls[0]);
+
+	EntityCall* pEntityCall = new EntityCall(pScriptModule, NULL, 0, 1, ENTITYCALL_TYPE_CLIENT);
+
+	// 脚本中的entity持有entityCall， 方法对象不是唯一的持有者时才会被回收
+	Py_INCREF(pEntityCall);
+
+	RemoteEntityMethod* pMethod = pEntityCall->getRemoteMethod(calls[1].pMethodDescription);
+	Py_DECREF(pMethod);
+
+	benchLookup(pEntityCall, calls[1].pMethodDescription, false);
+	benchLookup(pEntityCall, calls[1].pMethodDescription, true);
+
+	for(int i = 0; i < callCount; ++i)
+	{
+		benchCall(calls[i], false);
+		benchCall(calls[i], true);
+	}
+
+	Py_DECREF(pEntityCall);
+	Py_DECREF(pEntityCall);
+
+	for(int i = 0; i < callCount; ++i)
+	{
+		Py_DECREF(calls[i].pyArgs);
+		delete calls[i].pMethodDescription;
+	}
+
+	delete pScriptModule;
+}
+
+BENCH_REGISTER("remote_method", "remote method lookup and argument serialization per call signature", benchRemoteMethod);
+
+//-------------------------------------------------------------------------------------
+}
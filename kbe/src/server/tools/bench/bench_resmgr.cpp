@@ -0,0 +1,111 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bench.h"
+#include "resmgr/resmgr.h"
+
+namespace KBEngine{
+
+/*
+	资源查找: 启动时建立的路径索引 vs 逐个资源路径access()
+	索引命中后仍会access()确认一次文件存在， 所以命中的开销是一次哈希查找加一次access()，
+	逐个路径查找的开销随资源所在路径的位置增加， 找不到的资源两者都要遍历所有路径。
+*/
+static const int BENCH_RESMGR_ROUNDS = 100000;
+
+//-------------------------------------------------------------------------------------
+// 建立索引之前matchRes/hasRes的查找方式
+static std::string benchProbeRes(const std::vector<std::string>& respaths, const std::string& res)
+{
+	std::vector<std::string>::const_iterator iter = respaths.begin();
+
+	for(; iter != respaths.end(); ++iter)
+	{
+		std::string fpath = ((*iter) + res);
+
+		strutil::kbe_replace(fpath, "\\", "/");
+		strutil::kbe_replace(fpath, "//", "/");
+
+		if (access(fpath.c_str(), 0) == 0)
+		{
+			return fpath;
+		}
+	}
+
+	return res;
+}
+
+//-------------------------------------------------------------------------------------
+static void benchResmgrPath(const char* name, const std::string& res)
+{
+	Resmgr& resmgr = Resmgr::getSingleton();
+	const std::vector<std::string>& respaths = resmgr.respaths();
+
+	uint64 rounds = Bench::scaled(BENCH_RESMGR_ROUNDS);
+	uint64 checksum = 0;
+
+	Bench::note(name, res);
+
+	std::string probePath = benchProbeRes(respaths, res);
+	if(probePath != resmgr.matchRes(res))
+		Bench::note(name, "matchRes differs from the probe loop!");
+
+	uint64 startTime = timestamp();
+	for(uint64 i = 0; i < rounds; ++i)
+		checksum += benchProbeRes(respaths, res).size();
+
+	Bench::report(fmt::format("{}, probe loop", name), rounds, timestamp() - startTime);
+
+	startTime = timestamp();
+	for(uint64 i = 0; i < rounds; ++i)
+		checksum += resmgr.matchRes(res).size();
+
+	Bench::report(fmt::format("{}, matchRes", name), rounds, timestamp() - startTime);
+
+	startTime = timestamp();
+	for(uint64 i = 0; i < rounds; ++i)
+		checksum += resmgr.hasRes(res) ? 1 : 0;
+
+	Bench::report(fmt::format("{}, hasRes", name), rounds, timestamp() - startTime);
+
+	Bench::consume(checksum);
+}
+
+//-------------------------------------------------------------------------------------
+static void benchResmgr()
+{
+	Resmgr& resmgr = Resmgr::getSingleton();
+	Bench::note("resource paths", fmt::format("{}", resmgr.respaths().size()));
+	Bench::note("indexed resources", fmt::format("{}", resmgr.resIndexSize()));
+
+	if(resmgr.resIndexSize() == 0)
+		Bench::note("index", "empty, matchRes falls back to the probe loop");
+
+	// 分别位于第一个、第三个、第四个资源路径(kbe/res, assets/scripts, assets/res)， 以及找不到的资源
+	benchResmgrPath("respath 1", "server/kbengine_defaults.xml");
+	benchResmgrPath("respath 3", "entity_defs/Account.def");
+	benchResmgrPath("respath 4", "server/kbengine.xml");
+	benchResmgrPath("missing", "server/not_exists.xml");
+}
+
+BENCH_REGISTER("resmgr", "resource lookup over several resource paths, path index vs probing each path", benchResmgr);
+
+//-------------------------------------------------------------------------------------
+}
@@ -0,0 +1,302 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bench.h"
+#include "network/endpoint.h"
+#include "network/shm_transport.h"
+
+#if KBE_PLATFORM != PLATFORM_WIN32
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace KBEngine{
+
+#if KBE_PLATFORM != PLATFORM_WIN32
+
+/*
+	同机组件之间的共享内存通道与回环TCP
+	发送方在单独的线程中， 双方都是忙等， 只对比数据通道本身的吞吐量和往返延迟，
+	服务端中读端没有数据时睡眠在epoll中， 由唤醒管道叫醒。
+*/
+class BenchStream
+{
+public:
+	virtual ~BenchStream() {}
+
+	// 返回读到的字节数， 出错返回-1
+	virtual int recvSome(void* data, int size) = 0;
+	virtual bool sendAll(const void* data, int size) = 0;
+
+	bool recvAll(void* data, int size)
+	{
+		while(size > 0)
+		{
+			int len = recvSome(data, size);
+			if(len < 0)
+				return false;
+
+			data = (uint8*)data + len;
+			size -= len;
+		}
+
+		return true;
+	}
+};
+
+class BenchShmStream : public BenchStream
+{
+public:
+	BenchShmStream(Network::ShmTransport& transport):
+	transport_(transport)
+	{
+	}
+
+	virtual int recvSome(void* data, int size)
+	{
+		int len;
+		while((len = transport_.recv(data, size)) == 0)
+			sched_yield();
+
+		return len;
+	}
+
+	virtual bool sendAll(const void* data, int size)
+	{
+		while(size > 0)
+		{
+			int len = transport_.send(data, size);
+			if(len < 0)
+			{
+				if(errno != EAGAIN)
+					return false;
+
+				sched_yield();
+				continue;
+			}
+
+			data = (const uint8*)data + len;
+			size -= len;
+		}
+
+		return true;
+	}
+
+private:
+	Network::ShmTransport& transport_;
+};
+
+class BenchTcpStream : public BenchStream
+{
+public:
+	BenchTcpStream(Network::EndPoint& endpoint):
+	endpoint_(endpoint)
+	{
+	}
+
+	virtual int recvSome(void* data, int size)
+	{
+		int len = endpoint_.recv(data, size);
+		return len > 0 ? len : -1;
+	}
+
+	virtual bool sendAll(const void* data, int size)
+	{
+		while(size > 0)
+		{
+			int len = endpoint_.send(data, size);
+			if(len <= 0)
+				return false;
+
+			data = (const uint8*)data + len;
+			size -= len;
+		}
+
+		return true;
+	}
+
+private:
+	Network::EndPoint& endpoint_;
+};
+
+struct BenchStreamTask
+{
+	BenchStream* pStream;
+	uint64 bytes;
+	uint64 pings;
+};
+
+static const int BENCH_PING_SIZE = 64;
+
+//-------------------------------------------------------------------------------------
+static void* benchStreamWriter(void* arg)
+{
+	BenchStreamTask* pTask = (BenchStreamTask*)arg;
+
+	uint8 buf[PACKET_MAX_SIZE_TCP];
+	memset(buf, 0x5a, sizeof(buf));
+
+	uint64 bytes = pTask->bytes;
+	while(bytes > 0)
+	{
+		int len = (int)KBE_MIN(bytes, (uint64)sizeof(buf));
+		if(!pTask->pStream->sendAll(buf, len))
+			break;
+
+		bytes -= len;
+	}
+
+	return NULL;
+}
+
+//-------------------------------------------------------------------------------------
+static void* benchStreamEcho(void* arg)
+{
+	BenchStreamTask* pTask = (BenchStreamTask*)arg;
+
+	uint8 buf[BENCH_PING_SIZE];
+	for(uint64 i = 0; i < pTask->pings; ++i)
+	{
+		if(!pTask->pStream->recvAll(buf, sizeof(buf)) || !pTask->pStream->sendAll(buf, sizeof(buf)))
+			break;
+	}
+
+	return NULL;
+}
+
+//-------------------------------------------------------------------------------------
+static void benchStream(const std::string& name, BenchStream* pSender, BenchStream* pReceiver)
+{
+	// 吞吐量: 写端按TCP包大小连续写入， 读端尽量多读
+	BenchStreamTask task;
+	task.pStream = pSender;
+	task.bytes = Bench::scaled(512ULL * 1024 * 1024);
+	task.pings = 0;
+
+	pthread_t tid;
+	uint64 startTime = timestamp();
+	if(pthread_create(&tid, NULL, benchStreamWriter, &task) != 0)
+	{
+		printf("shm_transport: create thread failed!\n");
+		return;
+	}
+
+	std::vector<uint8> buf(64 * 1024);
+	uint64 received = 0;
+	while(received < task.bytes)
+	{
+		int len = pReceiver->recvSome(&buf[0], (int)buf.size());
+		if(len < 0)
+			break;
+
+		received += len;
+	}
+
+	uint64 elapsed = timestamp() - startTime;
+	pthread_join(tid, NULL);
+
+	Bench::report(name + " throughput(1460B writes)", received / PACKET_MAX_SIZE_TCP, elapsed, received);
+
+	// 延迟: 64字节往返
+	task.pStream = pReceiver;
+	task.bytes = 0;
+	task.pings = Bench::scaled(100000);
+
+	if(pthread_create(&tid, NULL, benchStreamEcho, &task) != 0)
+	{
+		printf("shm_transport: create thread failed!\n");
+		return;
+	}
+
+	uint8 ping[BENCH_PING_SIZE];
+	memset(ping, 0xa5, sizeof(ping));
+
+	startTime = timestamp();
+	uint64 pings = 0;
+	for(; pings < task.pings; ++pings)
+	{
+		if(!pSender->sendAll(ping, sizeof(ping)) || !pSender->recvAll(ping, sizeof(ping)))
+			break;
+	}
+
+	elapsed = timestamp() - startTime;
+	pthread_join(tid, NULL);
+
+	Bench::report(name + " round trip(64B)", pings, elapsed);
+}
+
+//-------------------------------------------------------------------------------------
+static void benchShmTransport()
+{
+	Network::ShmTransport creator, opener;
+	if(!creator.create(Network::g_shmTransportRingSize) || !opener.open(creator.name()))
+	{
+		printf("shm_transport: create shared memory failed, skipped.\n");
+		return;
+	}
+
+	creator.unlink();
+
+	BenchShmStream shmSender(creator), shmReceiver(opener);
+	benchStream(fmt::format("shm(ring={}KB)", creator.ringSize() / 1024), &shmSender, &shmReceiver);
+
+	Network::EndPoint listener;
+	listener.socket(SOCK_STREAM);
+	if(!listener.good() || listener.bind(0, htonl(INADDR_LOOPBACK)) != 0 || listener.listen() != 0)
+	{
+		printf("shm_transport: listen on loopback failed, skipped tcp.\n");
+		return;
+	}
+
+	u_int16_t port = 0;
+	u_int32_t addr = 0;
+	listener.getlocaladdress(&port, &addr);
+
+	Network::EndPoint client;
+	client.socket(SOCK_STREAM);
+	if(client.connect(port, htonl(INADDR_LOOPBACK), false) != 0)
+	{
+		printf("shm_transport: connect to loopback failed, skipped tcp.\n");
+		return;
+	}
+
+	Network::EndPoint* pServer = listener.accept(NULL, NULL, false);
+	if(pServer == NULL)
+	{
+		printf("shm_transport: accept failed, skipped tcp.\n");
+		return;
+	}
+
+	client.setnodelay(true);
+	pServer->setnodelay(true);
+
+	BenchTcpStream tcpSender(client), tcpReceiver(*pServer);
+	benchStream("tcp loopback", &tcpSender, &tcpReceiver);
+
+	pServer->close();
+	Network::EndPoint::reclaimPoolObject(pServer);
+}
+
+BENCH_REGISTER("shm_transport", "shared-memory ring vs loopback TCP, throughput and round trip", benchShmTransport);
+
+#endif
+
+//-------------------------------------------------------------------------------------
+}
@@ -0,0 +1,262 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bench.h"
+#include "bench_entity.h"
+#include "cellapp/entity.h"
+#include "cellapp/coordinate_system.h"
+#include "cellapp/entity_coordinate_node.h"
+#include "cellapp/proximity_grid.h"
+#include "server/serverconfig.h"
+
+namespace KBEngine{
+
+/*
+	脚本的entitiesInRange、nearestEntities查询开销， 10k实体的space中每个实体以20米半径查询一次，
+	使用cellapp的Entity、CoordinateSystem、EntityCoordinateNode与ProximityGrid。
+	坐标轴: EntityCoordinateNode::entitiesInRange， 从实体自己的节点沿x、z轴向两侧遍历， 每个轴的结果放入std::set再取交集。
+		CoordinateSystem中只有实体节点， 实际space中还有view等触发器的节点， 坐标轴的开销只会更高。
+	网格: ProximityGrid::entitiesInBox(与Entity::entitiesInRange使用网格时的参数一致)与ProximityGrid::nearestEntities。
+		坐标轴没有nearest查询， 对比的是脚本的做法: entitiesInRange后按距离排序取前几个。
+	python: 调用脚本的Entity.entitiesInRange， 每次返回新的list与传入result复用同一个list的对比， 实体不在space中， 查询走坐标轴。
+*/
+static const int BENCH_QUERY_ENTITIES = 10000;
+static const float BENCH_QUERY_SPACE_SIZE = 1000.f;
+static const float BENCH_QUERY_RADIUS = 20.f;
+static const size_t BENCH_QUERY_NEAREST = 10;
+
+//-------------------------------------------------------------------------------------
+static bool compareQueryDistance(const std::pair<float, Entity*>& a, const std::pair<float, Entity*>& b)
+{
+	return a.first < b.first;
+}
+
+//-------------------------------------------------------------------------------------
+static void benchSpatialQueryPython(const std::vector<Entity*>& entities, uint64 queries)
+{
+	PyObject* pyRadius = PyFloat_FromDouble(BENCH_QUERY_RADIUS);
+
+	uint64 found = 0;
+	uint64 startTime = timestamp();
+	for(uint64 i = 0; i < queries; ++i)
+	{
+		PyObject* pyEntity = entities[(size_t)(i % entities.size())];
+		PyObject* pyList = PyObject_CallMethod(pyEntity, const_cast<char*>("entitiesInRange"), 
+			const_cast<char*>("O"), pyRadius);
+
+		if(pyList == NULL)
+		{
+			PyErr_PrintEx(0);
+			break;
+		}
+
+		found += PyList_GET_SIZE(pyList);
+		Py_DECREF(pyList);
+	}
+
+	Bench::report("python entitiesInRange(new list)", queries, timestamp() - startTime);
+
+	PyObject* pyResult = PyList_New(0);
+
+	startTime = timestamp();
+	for(uint64 i = 0; i < queries; ++i)
+	{
+		PyObject* pyEntity = entities[(size_t)(i % entities.size())];
+		PyObject* pyList = PyObject_CallMethod(pyEntity, const_cast<char*>("entitiesInRange"), 
+			const_cast<char*>("OOOO"), pyRadius, Py_None, Py_None, pyResult);
+
+		if(pyList == NULL)
+		{
+			PyErr_PrintEx(0);
+			break;
+		}
+
+		found += PyList_GET_SIZE(pyList);
+		Py_DECREF(pyList);
+	}
+
+	Bench::report("python entitiesInRange(reused list)", queries, timestamp() - startTime);
+
+	Py_DECREF(pyResult);
+	Py_DECREF(pyRadius);
+
+	Bench::consume(found);
+}
+
+//-------------------------------------------------------------------------------------
+static void benchSpatialQuery()
+{
+	if(!BenchEntities::initialize())
+	{
+		Bench::note("spatial_query", "skipped, cannot create entities");
+		return;
+	}
+
+	uint32 seed = 2463534242u;
+	std::vector<Entity*> entities;
+
+	for(int i = 0; i < BENCH_QUERY_ENTITIES; ++i)
+	{
+		Position3D pos;
+
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		pos.x = float(seed % 1000000) / 1000000.f * BENCH_QUERY_SPACE_SIZE;
+
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		pos.z = float(seed % 1000000) / 1000000.f * BENCH_QUERY_SPACE_SIZE;
+
+		Entity* pEntity = BenchEntities::get(i);
+		pEntity->position(pos);
+		entities.push_back(pEntity);
+	}
+
+	if(entities[0]->pEntityCoordinateNode() == NULL)
+	{
+		Bench::note("spatial_query", "skipped, cellapp/coordinate_system is disabled");
+		return;
+	}
+
+	CoordinateSystem coordinateSystem;
+	ProximityGrid grid(g_kbeSrvConfig.getCellApp().proximity_grid_cell_size);
+
+	for(int i = 0; i < BENCH_QUERY_ENTITIES; ++i)
+	{
+		entities[i]->installCoordinateNodes(&coordinateSystem);
+		grid.addEntity(entities[i]);
+	}
+
+	uint64 queries = Bench::scaled(20000);
+	int types[2] = { -1, BenchEntities::utype(1) };
+	Position3D range(BENCH_QUERY_RADIUS, BENCH_QUERY_RADIUS, BENCH_QUERY_RADIUS);
+	std::vector<Entity*> foundEntities;
+
+	for(int t = 0; t < 2; ++t)
+	{
+		int entityUType = types[t];
+		std::string typeName = entityUType == -1 ? "any type" : "one type";
+
+		uint64 listFound = 0;
+		uint64 startTime = timestamp();
+		for(uint64 i = 0; i < queries; ++i)
+		{
+			Entity* pEntity = entities[(size_t)(i % BENCH_QUERY_ENTITIES)];
+
+			foundEntities.clear();
+			EntityCoordinateNode::entitiesInRange(foundEntities, pEntity->pEntityCoordinateNode(), 
+				pEntity->position(), BENCH_QUERY_RADIUS, entityUType);
+
+			listFound += foundEntities.size();
+		}
+
+		Bench::report(fmt::format("entitiesInRange {}m, {}(coordinate lists)", BENCH_QUERY_RADIUS, typeName),
+			queries, timestamp() - startTime);
+
+		uint64 gridFound = 0;
+
+		startTime = timestamp();
+		for(uint64 i = 0; i < queries; ++i)
+		{
+			Entity* pEntity = entities[(size_t)(i % BENCH_QUERY_ENTITIES)];
+			const Position3D& origin = pEntity->position();
+
+			foundEntities.clear();
+			grid.entitiesInBox(foundEntities, origin - range, origin + range, entityUType, CoordinateSystem::hasY);
+			gridFound += foundEntities.size();
+		}
+
+		Bench::report(fmt::format("entitiesInRange {}m, {}(proximity grid)", BENCH_QUERY_RADIUS, typeName),
+			queries, timestamp() - startTime);
+
+		Bench::note(fmt::format("found entities, {}", typeName), fmt::format("coordinate lists {}, proximity grid {}",
+			listFound, gridFound));
+	}
+
+	std::vector< std::pair<float, Entity*> > distances;
+	uint64 listNearest = 0;
+
+	uint64 startTime = timestamp();
+	for(uint64 i = 0; i < queries; ++i)
+	{
+		Entity* pEntity = entities[(size_t)(i % BENCH_QUERY_ENTITIES)];
+		const Position3D& origin = pEntity->position();
+
+		foundEntities.clear();
+		EntityCoordinateNode::entitiesInRange(foundEntities, pEntity->pEntityCoordinateNode(), 
+			origin, BENCH_QUERY_RADIUS, -1);
+
+		distances.clear();
+		for(size_t j = 0; j < foundEntities.size(); ++j)
+		{
+			if(foundEntities[j] == pEntity)
+				continue;
+
+			Vector3 diff = foundEntities[j]->position() - origin;
+			float distance = KBEVec3Length(&diff);
+			if(distance <= BENCH_QUERY_RADIUS)
+				distances.push_back(std::make_pair(distance, foundEntities[j]));
+		}
+
+		size_t count = std::min(distances.size(), BENCH_QUERY_NEAREST);
+		std::partial_sort(distances.begin(), distances.begin() + count, distances.end(), compareQueryDistance);
+		listNearest += count;
+	}
+
+	Bench::report(fmt::format("nearest {} in {}m(coordinate lists, sorted)", BENCH_QUERY_NEAREST, BENCH_QUERY_RADIUS),
+		queries, timestamp() - startTime);
+
+	uint64 gridNearest = 0;
+
+	startTime = timestamp();
+	for(uint64 i = 0; i < queries; ++i)
+	{
+		Entity* pEntity = entities[(size_t)(i % BENCH_QUERY_ENTITIES)];
+
+		foundEntities.clear();
+		grid.nearestEntities(foundEntities, pEntity->position(), BENCH_QUERY_RADIUS, BENCH_QUERY_NEAREST, -1, pEntity);
+		gridNearest += foundEntities.size();
+	}
+
+	Bench::report(fmt::format("nearest {} in {}m(proximity grid)", BENCH_QUERY_NEAREST, BENCH_QUERY_RADIUS),
+		queries, timestamp() - startTime);
+
+	Bench::note("found nearest entities", fmt::format("coordinate lists {}, proximity grid {}",
+		listNearest, gridNearest));
+
+	benchSpatialQueryPython(entities, queries);
+
+	// 与Space::removeEntity一致
+	for(int i = 0; i < BENCH_QUERY_ENTITIES; ++i)
+	{
+		grid.removeEntity(entities[i]);
+		entities[i]->uninstallCoordinateNodes(&coordinateSystem);
+	}
+
+	coordinateSystem.releaseNodes();
+}
+
+BENCH_REGISTER("spatial_query", "entitiesInRange and nearestEntities over 10k entities, coordinate lists vs proximity grid", 
+	benchSpatialQuery);
+
+//-------------------------------------------------------------------------------------
+}
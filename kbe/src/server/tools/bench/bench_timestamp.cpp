@@ -0,0 +1,78 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bench.h"
+
+namespace KBEngine{
+
+#if KBE_PLATFORM != PLATFORM_WIN32
+
+/*
+	每种时钟源读取一次的开销， 以及主循环中缓存的时间戳
+	timestamp()按启动时选出的g_timingMethod分派， 另外单独计时一行。
+*/
+static const int BENCH_TIMESTAMP_ROUNDS = 10000000;
+
+typedef uint64 (*BenchClockFunc)();
+
+//-------------------------------------------------------------------------------------
+static void benchTimestampClock(const char* name, BenchClockFunc func)
+{
+	uint64 rounds = Bench::scaled(BENCH_TIMESTAMP_ROUNDS);
+	uint64 checksum = 0;
+
+	uint64 startTime = timestamp();
+	for(uint64 i = 0; i < rounds; ++i)
+		checksum += func();
+
+	Bench::report(name, rounds, timestamp() - startTime);
+	Bench::consume(checksum);
+}
+
+//-------------------------------------------------------------------------------------
+static void benchTimestamp()
+{
+	Bench::note("timing method", getTimingMethodName());
+
+	benchTimestampClock("timestamp_rdtsc", timestamp_rdtsc);
+	benchTimestampClock("timestamp_gettimeofday", timestamp_gettimeofday);
+	benchTimestampClock("timestamp_gettime", timestamp_gettime);
+	benchTimestampClock("timestamp_gettime_coarse", timestamp_gettime_coarse);
+	benchTimestampClock("timestamp()", timestamp);
+
+	// 模拟主循环中poller唤醒后刷新过缓存， 结束后恢复， 不影响其他基准
+	uint64 oldCachedTimestamp = g_cachedTimestamp;
+	refreshCachedTimestamp();
+	benchTimestampClock("cachedTimestamp", cachedTimestamp);
+	g_cachedTimestamp = oldCachedTimestamp;
+
+#ifdef CLOCK_MONOTONIC_COARSE
+	timespec res;
+	if(clock_getres(CLOCK_MONOTONIC_COARSE, &res) == 0)
+		Bench::note("coarse clock resolution", fmt::format("{} ns", 1000000000ULL * res.tv_sec + res.tv_nsec));
+#endif
+}
+
+BENCH_REGISTER("timestamp", "cost of one timestamp read per clock source, and the cached tick timestamp", benchTimestamp);
+
+#endif
+
+//-------------------------------------------------------------------------------------
+}
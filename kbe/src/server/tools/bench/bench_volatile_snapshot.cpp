@@ -0,0 +1,184 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bench.h"
+#include "math/math.h"
+#include "network/bundle.h"
+#include "network/network_stats.h"
+#include "server/common.h"
+#include "client_lib/client_interface.h"
+#include "baseapp/baseapp_interface.h"
+#include "cellapp/volatile_snapshot.h"
+
+namespace KBEngine{
+
+/*
+	一个观察者视野中的实体每个tick都移动并转向时， 发往客户端的数据
+	之前: 每个实体一条onUpdateData_xz_y消息(别名ID、压缩的相对坐标和yaw)。
+	现在: 与Witness::addVolatileSnapshotToStream一致， 坐标量化后相对上次发送的基准做增量，
+		所有实体写入一条onUpdateVolatileSnapshot， 增量超出int16时先发送onUpdateVolatileBase。
+	两者都写入与witness相同的forwardMessageToClientFromCellapp包中， 统计编码耗时与每个tick的字节数。
+*/
+static const int BENCH_SNAPSHOT_ENTITIES = 100;
+
+struct BenchSnapshotEntity
+{
+	Position3D position;
+	float yaw;
+	int32 base[3];
+};
+
+//-------------------------------------------------------------------------------------
+static void benchSnapshotMove(std::vector<BenchSnapshotEntity>& entities, uint32& seed)
+{
+	for(size_t i = 0; i < entities.size(); ++i)
+	{
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+
+		// 每个tick最多移动0.6米
+		entities[i].position.x += float(int(seed % 1201) - 600) * 0.001f;
+		entities[i].position.z += float(int((seed >> 11) % 1201) - 600) * 0.001f;
+		entities[i].yaw = float(int((seed >> 22) % 628) - 314) * 0.01f;
+	}
+}
+
+//-------------------------------------------------------------------------------------
+static void benchVolatileSnapshot()
+{
+	uint32 seed = 2463534242u;
+	std::vector<BenchSnapshotEntity> entities(BENCH_SNAPSHOT_ENTITIES);
+	for(int i = 0; i < BENCH_SNAPSHOT_ENTITIES; ++i)
+	{
+		entities[i].position = Position3D(float(i % 10) * 8.f - 40.f, 0.f, float(i / 10) * 8.f - 40.f);
+		entities[i].yaw = 0.f;
+	}
+
+	const Position3D observerPos(0.f, 0.f, 0.f);
+	const ENTITY_ID observerID = 1;
+	uint64 ticks = Bench::scaled(100000);
+
+	std::vector<BenchSnapshotEntity> startEntities = entities;
+	uint32 startSeed = seed;
+
+	uint64 bytes = 0;
+	uint64 startTime = timestamp();
+	for(uint64 tick = 0; tick < ticks; ++tick)
+	{
+		benchSnapshotMove(entities, seed);
+
+		Network::Bundle* pSendBundle = Network::Bundle::createPoolObject();
+		NETWORK_ENTITY_MESSAGE_FORWARD_CLIENT_BEGIN(observerID, (*pSendBundle));
+
+		for(int i = 0; i < BENCH_SNAPSHOT_ENTITIES; ++i)
+		{
+			Position3D relativePos = entities[i].position - observerPos;
+
+			ENTITY_MESSAGE_FORWARD_CLIENT_BEGIN(pSendBundle, ClientInterface::onUpdateData_xz_y, update);
+			(*pSendBundle) << (uint8)i;
+			pSendBundle->appendPackXZ(relativePos.x, relativePos.z);
+			(*pSendBundle) << angle2int8(entities[i].yaw);
+			ENTITY_MESSAGE_FORWARD_CLIENT_END(pSendBundle, ClientInterface::onUpdateData_xz_y, update);
+		}
+
+		bytes += pSendBundle->currMsgLength();
+		Network::Bundle::reclaimPoolObject(pSendBundle);
+	}
+
+	uint64 updateStamps = timestamp() - startTime;
+	uint64 updateBytes = bytes;
+	Bench::report(fmt::format("{} entities, onUpdateData_xz_y per entity", BENCH_SNAPSHOT_ENTITIES), ticks,
+		updateStamps, updateBytes);
+
+	entities = startEntities;
+	seed = startSeed;
+
+	// 进入视野时已发送了完整坐标
+	for(int i = 0; i < BENCH_SNAPSHOT_ENTITIES; ++i)
+	{
+		entities[i].base[0] = quantizeVolatilePos(entities[i].position.x);
+		entities[i].base[1] = quantizeVolatilePos(entities[i].position.y);
+		entities[i].base[2] = quantizeVolatilePos(entities[i].position.z);
+	}
+
+	VolatileSnapshotSlot slots[BENCH_SNAPSHOT_ENTITIES];
+	uint64 rebases = 0;
+
+	bytes = 0;
+	startTime = timestamp();
+	for(uint64 tick = 0; tick < ticks; ++tick)
+	{
+		benchSnapshotMove(entities, seed);
+
+		Network::Bundle* pSendBundle = Network::Bundle::createPoolObject();
+		NETWORK_ENTITY_MESSAGE_FORWARD_CLIENT_BEGIN(observerID, (*pSendBundle));
+
+		memset(slots, 0, sizeof(slots));
+
+		for(int i = 0; i < BENCH_SNAPSHOT_ENTITIES; ++i)
+		{
+			BenchSnapshotEntity& entity = entities[i];
+			VolatileSnapshotSlot& slot = slots[i];
+
+			int32 q[3] = { quantizeVolatilePos(entity.position.x), quantizeVolatilePos(entity.position.y),
+				quantizeVolatilePos(entity.position.z) };
+
+			int32 d[2] = { q[0] - entity.base[0], q[2] - entity.base[2] };
+
+			if(d[0] < -32768 || d[0] > 32767 || d[1] < -32768 || d[1] > 32767)
+			{
+				ENTITY_MESSAGE_FORWARD_CLIENT_BEGIN(pSendBundle, ClientInterface::onUpdateVolatileBase, volatileBase);
+				(*pSendBundle) << (uint8)i;
+				(*pSendBundle) << q[0] << q[1] << q[2];
+				ENTITY_MESSAGE_FORWARD_CLIENT_END(pSendBundle, ClientInterface::onUpdateVolatileBase, volatileBase);
+
+				d[0] = d[1] = 0;
+				++rebases;
+			}
+
+			entity.base[0] = q[0];
+			entity.base[2] = q[2];
+
+			slot.flags = VOLATILE_SNAPSHOT_FLAG_XZ | VOLATILE_SNAPSHOT_FLAG_YAW;
+			slot.delta[0] = (int16)d[0];
+			slot.delta[2] = (int16)d[1];
+			slot.yaw = angle2int8(entity.yaw);
+		}
+
+		ENTITY_MESSAGE_FORWARD_CLIENT_BEGIN(pSendBundle, ClientInterface::onUpdateVolatileSnapshot, volatileSnapshot);
+		writeVolatileSnapshot(*pSendBundle, slots, BENCH_SNAPSHOT_ENTITIES);
+		ENTITY_MESSAGE_FORWARD_CLIENT_END(pSendBundle, ClientInterface::onUpdateVolatileSnapshot, volatileSnapshot);
+
+		bytes += pSendBundle->currMsgLength();
+		Network::Bundle::reclaimPoolObject(pSendBundle);
+	}
+
+	Bench::report(fmt::format("{} entities, onUpdateVolatileSnapshot", BENCH_SNAPSHOT_ENTITIES), ticks,
+		timestamp() - startTime, bytes);
+
+	Bench::note("bytes per tick", fmt::format("onUpdateData_xz_y {:.1f}, onUpdateVolatileSnapshot {:.1f} ({} rebases)",
+		double(updateBytes) / ticks, double(bytes) / ticks, rebases));
+}
+
+BENCH_REGISTER("volatile_snapshot", "per-tick volatile updates of 100 entities, per-entity messages vs one snapshot", benchVolatileSnapshot);
+
+//-------------------------------------------------------------------------------------
+}
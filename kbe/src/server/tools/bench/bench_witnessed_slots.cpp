@@ -0,0 +1,165 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bench.h"
+#include "cellapp/witnessed_slots.h"
+
+namespace KBEngine{
+
+/*
+	向观察者广播(allClients/otherClients)时对观察者的枚举
+	之前: 遍历观察者ID列表， 每个观察者先在cellapp的实体表中查找， 再在其View中查找本实体确认客户端已经知道本实体。
+	现在: 遍历WitnessedSlots中客户端已知本实体的位。
+	观察者用一个简单的结构代替， 只测量枚举本身的开销。
+
+	另外测量观察者进出View(delWitnessed/addWitnessed)的开销，
+	之前从ID列表中线性删除， 现在按ID索引到槽位后交换删除。
+*/
+struct BenchObserver
+{
+	ENTITY_ID id;
+	uint32 channelID;
+
+	// Witness::viewEntities_map_， 值为EntityRef的flags
+	std::map<ENTITY_ID, uint32> viewEntities;
+};
+
+static const ENTITY_ID BENCH_WITNESSED_ENTITY_ID = 1;
+static const int BENCH_WITNESSED_OBSERVERS = 500;
+static const int BENCH_WITNESSED_SPACE_ENTITIES = 5000;
+static const int BENCH_WITNESSED_VIEW_ENTITIES = 100;
+
+//-------------------------------------------------------------------------------------
+static void benchWitnessedSlots()
+{
+	std::vector<BenchObserver> observers(BENCH_WITNESSED_SPACE_ENTITIES);
+	KBEUnordered_map<ENTITY_ID, BenchObserver*> entities;
+
+	for(int i = 0; i < BENCH_WITNESSED_SPACE_ENTITIES; ++i)
+	{
+		observers[i].id = i + 2;
+		observers[i].channelID = i;
+		entities[observers[i].id] = &observers[i];
+	}
+
+	std::list<ENTITY_ID> witnesses;
+	WitnessedSlots witnessedSlots;
+
+	// 观察者分散在整个space中， 约10%的客户端还不知道本实体(进入View的消息尚未发出)
+	for(int i = 0; i < BENCH_WITNESSED_OBSERVERS; ++i)
+	{
+		BenchObserver& observer = observers[(i * 7919) % BENCH_WITNESSED_SPACE_ENTITIES];
+		bool inClient = (i % 10) != 0;
+
+		for(int j = 0; j < BENCH_WITNESSED_VIEW_ENTITIES; ++j)
+			observer.viewEntities[observer.id + j * 13 + 1] = 0;
+
+		observer.viewEntities[BENCH_WITNESSED_ENTITY_ID] = inClient ? 0 : 1;
+
+		witnesses.push_back(observer.id);
+		witnessedSlots.add(observer.id, reinterpret_cast<Entity*>(&observer), inClient);
+	}
+
+	uint64 loops = Bench::scaled(20000);
+	uint64 sum = 0;
+
+	uint64 startTime = timestamp();
+	for(uint64 i = 0; i < loops; ++i)
+	{
+		const std::list<ENTITY_ID>& witnessIDs = *Bench::opaque(&witnesses);
+		KBEUnordered_map<ENTITY_ID, BenchObserver*>& entityMap = *Bench::opaque(&entities);
+
+		std::list<ENTITY_ID>::const_iterator iter = witnessIDs.begin();
+		for(; iter != witnessIDs.end(); ++iter)
+		{
+			KBEUnordered_map<ENTITY_ID, BenchObserver*>::iterator entityIter = entityMap.find((*iter));
+			if(entityIter == entityMap.end())
+				continue;
+
+			BenchObserver* pObserver = entityIter->second;
+
+			std::map<ENTITY_ID, uint32>::iterator viewIter = pObserver->viewEntities.find(BENCH_WITNESSED_ENTITY_ID);
+			if(viewIter == pObserver->viewEntities.end() || viewIter->second != 0)
+				continue;
+
+			sum += pObserver->channelID;
+		}
+	}
+
+	Bench::report(fmt::format("{} observers(id list+findEntity+entityInView)", BENCH_WITNESSED_OBSERVERS),
+		loops, timestamp() - startTime);
+
+	Bench::consume(sum);
+	sum = 0;
+
+	startTime = timestamp();
+	for(uint64 i = 0; i < loops; ++i)
+	{
+		const WitnessedSlots& slots = *Bench::opaque(&witnessedSlots);
+
+		WITNESSED_SLOTS_FOREACH_IN_CLIENT(slots, pViewEntity)
+		{
+			sum += reinterpret_cast<BenchObserver*>(pViewEntity)->channelID;
+		}
+		WITNESSED_SLOTS_FOREACH_END
+	}
+
+	Bench::report(fmt::format("{} observers(WitnessedSlots bitset)", BENCH_WITNESSED_OBSERVERS),
+		loops, timestamp() - startTime);
+
+	Bench::consume(sum);
+
+	// 每次让一个观察者离开再重新进入
+	std::vector<ENTITY_ID> churnIDs(witnesses.begin(), witnesses.end());
+	loops = Bench::scaled(200000);
+
+	startTime = timestamp();
+	for(uint64 i = 0; i < loops; ++i)
+	{
+		std::list<ENTITY_ID>& witnessIDs = *Bench::opaque(&witnesses);
+		ENTITY_ID entityID = churnIDs[(i * 31) % churnIDs.size()];
+
+		witnessIDs.remove(entityID);
+		witnessIDs.push_back(entityID);
+	}
+
+	Bench::report(fmt::format("{} observers(id list remove+add)", BENCH_WITNESSED_OBSERVERS),
+		loops, timestamp() - startTime);
+
+	startTime = timestamp();
+	for(uint64 i = 0; i < loops; ++i)
+	{
+		WitnessedSlots& slots = *Bench::opaque(&witnessedSlots);
+		ENTITY_ID entityID = churnIDs[(i * 31) % churnIDs.size()];
+
+		slots.remove(entityID);
+		slots.add(entityID, reinterpret_cast<Entity*>(entities[entityID]), true);
+	}
+
+	Bench::report(fmt::format("{} observers(WitnessedSlots remove+add)", BENCH_WITNESSED_OBSERVERS),
+		loops, timestamp() - startTime);
+
+	Bench::consume(witnessedSlots.size());
+}
+
+BENCH_REGISTER("witnessed_slots", "broadcast enumeration and observer churn over 500 observers, id list vs dense slots", benchWitnessedSlots);
+
+//-------------------------------------------------------------------------------------
+}
@@ -0,0 +1,175 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/kbemain.h"
+#include "entitydef/entitydef.h"
+#include "bench.h"
+
+#undef DEFINE_IN_INTERFACE
+#include "machine/machine_interface.h"
+#define DEFINE_IN_INTERFACE
+#include "machine/machine_interface.h"
+
+#undef DEFINE_IN_INTERFACE
+#include "client_lib/client_interface.h"
+#define DEFINE_IN_INTERFACE
+#include "client_lib/client_interface.h"
+
+#undef DEFINE_IN_INTERFACE
+#include "baseappmgr/baseappmgr_interface.h"
+#define DEFINE_IN_INTERFACE
+#include "baseappmgr/baseappmgr_interface.h"
+
+#undef DEFINE_IN_INTERFACE
+#include "cellappmgr/cellappmgr_interface.h"
+#define DEFINE_IN_INTERFACE
+#include "cellappmgr/cellappmgr_interface.h"
+
+#undef DEFINE_IN_INTERFACE
+#include "cellapp/cellapp_interface.h"
+#define DEFINE_IN_INTERFACE
+#include "cellapp/cellapp_interface.h"
+
+#undef DEFINE_IN_INTERFACE
+#include "baseapp/baseapp_interface.h"
+#define DEFINE_IN_INTERFACE
+#include "baseapp/baseapp_interface.h"
+
+#undef DEFINE_IN_INTERFACE
+#include "loginapp/loginapp_interface.h"
+#define DEFINE_IN_INTERFACE
+#include "loginapp/loginapp_interface.h"
+
+#undef DEFINE_IN_INTERFACE
+#include "dbmgr/dbmgr_interface.h"
+#define DEFINE_IN_INTERFACE
+#include "dbmgr/dbmgr_interface.h"
+
+#undef DEFINE_IN_INTERFACE
+#include "tools/logger/logger_interface.h"
+#define DEFINE_IN_INTERFACE
+#include "tools/logger/logger_interface.h"
+
+#undef DEFINE_IN_INTERFACE
+#include "tools/bots/bots_interface.h"
+#define DEFINE_IN_INTERFACE
+#include "tools/bots/bots_interface.h"
+
+#undef DEFINE_IN_INTERFACE
+#include "tools/interfaces/interfaces_interface.h"
+#define DEFINE_IN_INTERFACE
+#include "tools/interfaces/interfaces_interface.h"
+
+using namespace KBEngine;
+
+int process_help(int argc, char* argv[])
+{
+	printf("Usage:\n");
+	printf("\tbench [--list] [--scale=N] [name ...]\n");
+	printf("\tRun the named benchmarks, or all of them when no name is given. Environment variables based on KBE.\n");
+	printf("\tbench --scale=0.1 datatype_codec\n");
+
+	printf("\n--list:\n");
+	printf("\tList the registered benchmarks.\n");
+
+	printf("\n--scale=N:\n");
+	printf("\tMultiply the loop counts of every benchmark by N.\n");
+
+	printf("\n--help:\n");
+	printf("\tDisplay help information.\n");
+	return 0;
+}
+
+int process_list()
+{
+	std::vector<Bench::Entry>& benchs = Bench::entries();
+	for(size_t i = 0; i < benchs.size(); ++i)
+		printf("%-24s %s\n", benchs[i].name, benchs[i].desc);
+
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	g_componentType = TOOL_TYPE;
+	g_componentID = 0;
+
+	parseMainCommandArgs(argc, argv);
+
+	std::vector<const Bench::Entry*> runs;
+
+	for(int argIdx = 1; argIdx < argc; ++argIdx)
+	{
+		std::string cmd = argv[argIdx];
+
+		if(cmd == "--help")
+			return process_help(argc, argv);
+
+		if(cmd == "--list")
+			return process_list();
+
+		if(cmd.find("--scale=") == 0)
+		{
+			Bench::scale(atof(cmd.substr(strlen("--scale=")).c_str()));
+			continue;
+		}
+
+		// 环境变量参数由parseMainCommandArgs处理
+		if(cmd.find("--") == 0)
+			continue;
+
+		const Bench::Entry* pEntry = Bench::find(cmd);
+		if(pEntry == NULL)
+		{
+			printf("bench: not found benchmark(%s), see --list.\n", cmd.c_str());
+			return -1;
+		}
+
+		runs.push_back(pEntry);
+	}
+
+	if(runs.size() == 0)
+	{
+		std::vector<Bench::Entry>& benchs = Bench::entries();
+		for(size_t i = 0; i < benchs.size(); ++i)
+			runs.push_back(&benchs[i]);
+	}
+
+	Resmgr::getSingleton().initialize();
+	setEvns();
+	loadConfig();
+
+	DebugHelper::initialize(g_componentType);
+
+	// 粗粒度时钟的精度不够用于计时
+	if(g_timingMethod == GET_TIME_COARSE_TIMING_METHOD)
+		g_timingMethod = GET_TIME_TIMING_METHOD;
+
+	printf("timing: %s\n", getTimingMethodName());
+
+	for(size_t i = 0; i < runs.size(); ++i)
+	{
+		Bench::title(fmt::format("{}: {}", runs[i]->name, runs[i]->desc));
+		runs[i]->func();
+	}
+
+	DebugHelper::getSingleton().finalise();
+	return 0;
+}
@@ -21,6 +21,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "pybots.h"
 #include "bots.h"
 #include "clientobject.h"
+#include "native_bot.h"
 #include "server/telnet_server.h"
 #include "server/components.h"
 #include "client_lib/entity.h"
@@ -56,6 +57,7 @@ Bots::Bots(Network::EventDispatcher& dispatcher,
 ClientApp(dispatcher, ninterface, componentType, componentID),
 pPyBots_(NULL),
 clients_(),
+nativeBots_(),
 reqCreateAndLoginTotalCount_(g_kbeSrvConfig.getBots().defaultAddBots_totalCount),
 reqCreateAndLoginTickCount_(g_kbeSrvConfig.getBots().defaultAddBots_tickCount),
 reqCreateAndLoginTickTime_(g_kbeSrvConfig.getBots().defaultAddBots_tickTime),
@@ -160,6 +162,8 @@ void Bots::finalise()
 
 	clients_.clear();
 
+	nativeBots_.finalise();
+
 	reqCreateAndLoginTotalCount_ = 0;
 	SAFE_RELEASE(pCreateAndLoginHandler_);
 	
@@ -305,6 +309,11 @@ void Bots::handleGameTick()
 			pClientObject->gameTick();
 		}
 	}
+
+	{
+		AUTO_SCOPED_PROFILE("updateNativeBots");
+		nativeBots_.tick();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -601,6 +610,13 @@ void Bots::onHelloCB_(Network::Channel* pChannel, const std::string& verInfo,
 		const std::string& scriptVerInfo, const std::string& protocolMD5, const std::string& entityDefMD5, 
 		COMPONENT_TYPE componentType)
 {
+	NativeBot* pNativeBot = nativeBots_.findBot(pChannel);
+	if(pNativeBot)
+	{
+		pNativeBot->onHelloCB(componentType);
+		return;
+	}
+
 	ClientObject* pClient = findClient(pChannel);
 	if(pClient)
 	{
@@ -611,6 +627,13 @@ void Bots::onHelloCB_(Network::Channel* pChannel, const std::string& verInfo,
 //-------------------------------------------------------------------------------------	
 void Bots::onVersionNotMatch(Network::Channel* pChannel, MemoryStream& s)
 {
+	NativeBot* pNativeBot = nativeBots_.findBot(pChannel);
+	if(pNativeBot)
+	{
+		pNativeBot->onVersionNotMatch(s);
+		return;
+	}
+
 	ClientObject* pClient = findClient(pChannel);
 	if(pClient)
 	{
@@ -621,6 +644,13 @@ void Bots::onVersionNotMatch(Network::Channel* pChannel, MemoryStream& s)
 //-------------------------------------------------------------------------------------	
 void Bots::onScriptVersionNotMatch(Network::Channel* pChannel, MemoryStream& s)
 {
+	NativeBot* pNativeBot = nativeBots_.findBot(pChannel);
+	if(pNativeBot)
+	{
+		pNativeBot->onVersionNotMatch(s);
+		return;
+	}
+
 	ClientObject* pClient = findClient(pChannel);
 	if(pClient)
 	{
@@ -631,6 +661,13 @@ void Bots::onScriptVersionNotMatch(Network::Channel* pChannel, MemoryStream& s)
 //-------------------------------------------------------------------------------------
 void Bots::onCreateAccountResult(Network::Channel * pChannel, MemoryStream& s)
 {
+	NativeBot* pNativeBot = nativeBots_.findBot(pChannel);
+	if(pNativeBot)
+	{
+		pNativeBot->onCreateAccountResult(s);
+		return;
+	}
+
 	ClientObject* pClient = findClient(pChannel);
 	if(pClient)
 	{
@@ -641,6 +678,13 @@ void Bots::onCreateAccountResult(Network::Channel * pChannel, MemoryStream& s)
 //-------------------------------------------------------------------------------------	
 void Bots::onLoginSuccessfully(Network::Channel * pChannel, MemoryStream& s)
 {
+	NativeBot* pNativeBot = nativeBots_.findBot(pChannel);
+	if(pNativeBot)
+	{
+		pNativeBot->onLoginSuccessfully(s);
+		return;
+	}
+
 	ClientObject* pClient = findClient(pChannel);
 	if(pClient)
 	{
@@ -651,6 +695,13 @@ void Bots::onLoginSuccessfully(Network::Channel * pChannel, MemoryStream& s)
 //-------------------------------------------------------------------------------------	
 void Bots::onLoginFailed(Network::Channel * pChannel, MemoryStream& s)
 {
+	NativeBot* pNativeBot = nativeBots_.findBot(pChannel);
+	if(pNativeBot)
+	{
+		pNativeBot->onLoginFailed(s);
+		return;
+	}
+
 	ClientObject* pClient = findClient(pChannel);
 	if(pClient)
 	{
@@ -661,6 +712,13 @@ void Bots::onLoginFailed(Network::Channel * pChannel, MemoryStream& s)
 //-------------------------------------------------------------------------------------	
 void Bots::onLoginBaseappFailed(Network::Channel * pChannel, SERVER_ERROR_CODE failedcode)
 {
+	NativeBot* pNativeBot = nativeBots_.findBot(pChannel);
+	if(pNativeBot)
+	{
+		pNativeBot->onLoginBaseappFailed(failedcode);
+		return;
+	}
+
 	ClientObject* pClient = findClient(pChannel);
 	if(pClient)
 	{
@@ -676,12 +734,23 @@ void Bots::onReloginBaseappSuccessfully(Network::Channel * pChannel, MemoryStrea
 	{
 		pClient->onReloginBaseappSuccessfully(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------	
 void Bots::onCreatedProxies(Network::Channel * pChannel, 
 								 uint64 rndUUID, ENTITY_ID eid, std::string& entityType)
 {
+	NativeBot* pNativeBot = nativeBots_.findBot(pChannel);
+	if(pNativeBot)
+	{
+		pNativeBot->onCreatedProxies(eid, entityType);
+		return;
+	}
+
 	ClientObject* pClient = findClient(pChannel);
 	if(pClient)
 	{
@@ -692,6 +761,13 @@ void Bots::onCreatedProxies(Network::Channel * pChannel,
 //-------------------------------------------------------------------------------------	
 void Bots::onEntityEnterWorld(Network::Channel * pChannel, MemoryStream& s)
 {
+	NativeBot* pNativeBot = nativeBots_.findBot(pChannel);
+	if(pNativeBot)
+	{
+		pNativeBot->onEntityEnterWorld(s);
+		return;
+	}
+
 	ClientObject* pClient = findClient(pChannel);
 	if(pClient)
 	{
@@ -717,11 +793,22 @@ void Bots::onEntityLeaveWorldOptimized(Network::Channel * pChannel, MemoryStream
 	{
 		pClient->onEntityLeaveWorldOptimized(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------	
 void Bots::onEntityEnterSpace(Network::Channel * pChannel, MemoryStream& s)
 {
+	NativeBot* pNativeBot = nativeBots_.findBot(pChannel);
+	if(pNativeBot)
+	{
+		pNativeBot->onEntityEnterSpace(s);
+		return;
+	}
+
 	ClientObject* pClient = findClient(pChannel);
 	if(pClient)
 	{
@@ -732,6 +819,13 @@ void Bots::onEntityEnterSpace(Network::Channel * pChannel, MemoryStream& s)
 //-------------------------------------------------------------------------------------	
 void Bots::onEntityLeaveSpace(Network::Channel * pChannel, ENTITY_ID eid)
 {
+	NativeBot* pNativeBot = nativeBots_.findBot(pChannel);
+	if(pNativeBot)
+	{
+		pNativeBot->onEntityLeaveSpace(eid);
+		return;
+	}
+
 	ClientObject* pClient = findClient(pChannel);
 	if(pClient)
 	{
@@ -757,6 +851,10 @@ void Bots::onRemoteMethodCall(Network::Channel* pChannel, KBEngine::MemoryStream
 	{
 		pClient->onRemoteMethodCall(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -767,11 +865,22 @@ void Bots::onRemoteMethodCallOptimized(Network::Channel* pChannel, KBEngine::Mem
 	{
 		pClient->onRemoteMethodCallOptimized(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------	
 void Bots::onKicked(Network::Channel * pChannel, SERVER_ERROR_CODE failedcode)
 {
+	NativeBot* pNativeBot = nativeBots_.findBot(pChannel);
+	if(pNativeBot)
+	{
+		pNativeBot->onKicked(failedcode);
+		return;
+	}
+
 	ClientObject* pClient = findClient(pChannel);
 	if(pClient)
 	{
@@ -787,6 +896,10 @@ void Bots::onUpdatePropertys(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onUpdatePropertys(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -797,11 +910,50 @@ void Bots::onUpdatePropertysOptimized(Network::Channel* pChannel, MemoryStream&
 	{
 		pClient->onUpdatePropertysOptimized(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void Bots::onUpdatePropertyPatch(Network::Channel* pChannel, MemoryStream& s)
+{
+	ClientObject* pClient = findClient(pChannel);
+	if(pClient)
+	{
+		pClient->onUpdatePropertyPatch(pChannel, s);
+	}
+	else
+	{
+		s.done();
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void Bots::onUpdatePropertyPatchOptimized(Network::Channel* pChannel, MemoryStream& s)
+{
+	ClientObject* pClient = findClient(pChannel);
+	if(pClient)
+	{
+		pClient->onUpdatePropertyPatchOptimized(pChannel, s);
+	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
 void Bots::onUpdateBasePos(Network::Channel* pChannel, float x, float y, float z)
 {
+	NativeBot* pNativeBot = nativeBots_.findBot(pChannel);
+	if(pNativeBot)
+	{
+		pNativeBot->onUpdateBasePos(x, y, z);
+		return;
+	}
+
 	ClientObject* pClient = findClient(pChannel);
 	if(pClient)
 	{
@@ -827,11 +979,22 @@ void Bots::onUpdateBaseDir(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onUpdateBaseDir(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
 void Bots::onSetEntityPosAndDir(Network::Channel* pChannel, MemoryStream& s)
 {
+	NativeBot* pNativeBot = nativeBots_.findBot(pChannel);
+	if(pNativeBot)
+	{
+		pNativeBot->onSetEntityPosAndDir(s);
+		return;
+	}
+
 	ClientObject* pClient = findClient(pChannel);
 	if(pClient)
 	{
@@ -847,6 +1010,10 @@ void Bots::onUpdateData(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onUpdateData(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -857,6 +1024,10 @@ void Bots::onUpdateData_ypr(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onUpdateData_ypr(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -867,6 +1038,10 @@ void Bots::onUpdateData_yp(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onUpdateData_yp(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -877,6 +1052,10 @@ void Bots::onUpdateData_yr(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onUpdateData_yr(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -887,6 +1066,10 @@ void Bots::onUpdateData_pr(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onUpdateData_pr(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -897,6 +1080,10 @@ void Bots::onUpdateData_y(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onUpdateData_y(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -907,6 +1094,10 @@ void Bots::onUpdateData_p(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onUpdateData_p(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -917,6 +1108,10 @@ void Bots::onUpdateData_r(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onUpdateData_r(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -927,6 +1122,10 @@ void Bots::onUpdateData_xz(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onUpdateData_xz(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -937,6 +1136,10 @@ void Bots::onUpdateData_xz_ypr(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onUpdateData_xz_ypr(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -947,6 +1150,10 @@ void Bots::onUpdateData_xz_yp(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onUpdateData_xz_yp(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -957,6 +1164,10 @@ void Bots::onUpdateData_xz_yr(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onUpdateData_xz_yr(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -967,6 +1178,10 @@ void Bots::onUpdateData_xz_pr(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onUpdateData_xz_pr(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -977,6 +1192,10 @@ void Bots::onUpdateData_xz_y(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onUpdateData_xz_y(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -987,6 +1206,10 @@ void Bots::onUpdateData_xz_p(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onUpdateData_xz_p(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -997,6 +1220,10 @@ void Bots::onUpdateData_xz_r(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onUpdateData_xz_r(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -1007,6 +1234,10 @@ void Bots::onUpdateData_xyz(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onUpdateData_xyz(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -1017,6 +1248,10 @@ void Bots::onUpdateData_xyz_ypr(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onUpdateData_xyz_ypr(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -1027,6 +1262,10 @@ void Bots::onUpdateData_xyz_yp(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onUpdateData_xyz_yp(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -1037,6 +1276,10 @@ void Bots::onUpdateData_xyz_yr(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onUpdateData_xyz_yr(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -1047,6 +1290,10 @@ void Bots::onUpdateData_xyz_pr(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onUpdateData_xyz_pr(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -1057,6 +1304,10 @@ void Bots::onUpdateData_xyz_y(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onUpdateData_xyz_y(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -1067,6 +1318,10 @@ void Bots::onUpdateData_xyz_p(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onUpdateData_xyz_p(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -1077,6 +1332,38 @@ void Bots::onUpdateData_xyz_r(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onUpdateData_xyz_r(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void Bots::onUpdateVolatileSnapshot(Network::Channel* pChannel, MemoryStream& s)
+{
+	ClientObject* pClient = findClient(pChannel);
+	if(pClient)
+	{
+		pClient->onUpdateVolatileSnapshot(pChannel, s);
+	}
+	else
+	{
+		s.done();
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void Bots::onUpdateVolatileBase(Network::Channel* pChannel, MemoryStream& s)
+{
+	ClientObject* pClient = findClient(pChannel);
+	if(pClient)
+	{
+		pClient->onUpdateVolatileBase(pChannel, s);
+	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -1107,6 +1394,10 @@ void Bots::onStreamDataRecv(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->onStreamDataRecv(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------
@@ -1127,6 +1418,10 @@ void Bots::initSpaceData(Network::Channel* pChannel, MemoryStream& s)
 	{
 		pClient->initSpaceData(pChannel, s);
 	}
+	else
+	{
+		s.done();
+	}
 }
 
 //-------------------------------------------------------------------------------------	
@@ -1222,6 +1517,13 @@ void Bots::startProfile_(Network::Channel* pChannel, std::string profileName, in
 //-------------------------------------------------------------------------------------
 void Bots::onAppActiveTickCB(Network::Channel* pChannel)
 {
+	NativeBot* pNativeBot = nativeBots_.findBot(pChannel);
+	if(pNativeBot)
+	{
+		pNativeBot->onAppActiveTickCB();
+		return;
+	}
+
 	ClientObject* pClient = findClient(pChannel);
 	if (pClient)
 	{
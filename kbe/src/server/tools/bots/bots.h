@@ -25,6 +25,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 // common include	
 #include "profile.h"
 #include "create_and_login_handler.h"
+#include "native_bots.h"
 #include "common/timer.h"
 #include "pyscript/script.h"
 #include "network/endpoint.h"
@@ -137,6 +138,9 @@ public:
 	ClientObject* findClient(Network::Channel * pChannel);
 	ClientObject* findClientByAppID(int32 appID);
 
+	NativeBots& nativeBots(){ return nativeBots_; }
+	size_t numBots() const { return clients_.size() + nativeBots_.size(); }
+
 	static PyObject* __py_addBots(PyObject* self, PyObject* args);
 
 	/** 网络接口
@@ -259,6 +263,12 @@ public:
 	virtual void onUpdatePropertys(Network::Channel* pChannel, MemoryStream& s);
 	virtual void onUpdatePropertysOptimized(Network::Channel* pChannel, MemoryStream& s);
 
+	/** 网络接口
+		服务器增量更新entity的容器属性
+	*/
+	virtual void onUpdatePropertyPatch(Network::Channel* pChannel, MemoryStream& s);
+	virtual void onUpdatePropertyPatchOptimized(Network::Channel* pChannel, MemoryStream& s);
+
 	/** 网络接口
 		服务器更新avatar基础位置和朝向
 	*/
@@ -302,6 +312,12 @@ public:
 	virtual void onUpdateData_xyz_p(Network::Channel* pChannel, MemoryStream& s);
 	virtual void onUpdateData_xyz_r(Network::Channel* pChannel, MemoryStream& s);
 
+	/** 网络接口
+		服务器每tick打包更新VolatileData
+	*/
+	virtual void onUpdateVolatileSnapshot(Network::Channel* pChannel, MemoryStream& s);
+	virtual void onUpdateVolatileBase(Network::Channel* pChannel, MemoryStream& s);
+
 	/** 网络接口
 		download stream开始了 
 	*/
@@ -351,6 +367,9 @@ protected:
 
 	CLIENTS													clients_;
 
+	// 不带脚本的原生机器人
+	NativeBots												nativeBots_;
+
 	// console请求创建到服务端的bots数量
 	uint32													reqCreateAndLoginTotalCount_;
 	uint32													reqCreateAndLoginTickCount_;
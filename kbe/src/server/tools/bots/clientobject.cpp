@@ -24,6 +24,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 #include "network/tcp_packet.h"
 #include "network/bundle.h"
 #include "network/fixed_messages.h"
+#include "network/compression_filter.h"
 #include "thread/threadpool.h"
 #include "server/components.h"
 #include "server/serverconfig.h"
@@ -56,7 +57,7 @@ ClientObject::ClientObject(std::string name, Network::NetworkInterface& ninterfa
 ClientObjectBase(ninterface, getScriptType()),
 error_(C_ERROR_NONE),
 state_(C_STATE_INIT),
-pBlowfishFilter_(0),
+pEncryptionFilter_(0),
 pTCPPacketSenderEx_(NULL),
 pTCPPacketReceiverEx_(NULL)
 {
@@ -69,7 +70,7 @@ pTCPPacketReceiverEx_(NULL)
 //-------------------------------------------------------------------------------------
 ClientObject::~ClientObject()
 {
-	SAFE_RELEASE(pBlowfishFilter_);
+	SAFE_RELEASE(pEncryptionFilter_);
 }
 
 //-------------------------------------------------------------------------------------		
@@ -154,10 +155,10 @@ bool ClientObject::initCreate()
 	(*pBundle).newMessage(LoginappInterface::hello);
 	(*pBundle) << KBEVersion::versionString() << KBEVersion::scriptVersionString();
 
-	if(Network::g_channelExternalEncryptType == 1)
+	pEncryptionFilter_ = Network::createClientEncryptionFilter(Network::g_channelExternalEncryptType);
+	if(pEncryptionFilter_)
 	{
-		pBlowfishFilter_ = new Network::BlowfishFilter();
-		(*pBundle).appendBlob(pBlowfishFilter_->key());
+		(*pBundle).appendBlob(pEncryptionFilter_->key());
 	}
 	else
 	{
@@ -165,6 +166,9 @@ bool ClientObject::initCreate()
 		(*pBundle).appendBlob(key);
 	}
 
+	Network::addCompressionOffer(*pBundle, EntityDef::compressionDictionary());
+	(*pBundle) << (uint32)CLIENT_FEATURE_VOLATILE_SNAPSHOT;
+
 	pEndpoint->send(pBundle);
 	Network::Bundle::reclaimPoolObject(pBundle);
 	return true;
@@ -227,11 +231,13 @@ bool ClientObject::initLoginBaseapp()
 	(*pBundle).newMessage(BaseappInterface::hello);
 	(*pBundle) << KBEVersion::versionString() << KBEVersion::scriptVersionString();
 	
-	if(Network::g_channelExternalEncryptType == 1)
+	// 去掉与loginapp通信时安装的过滤器
+	pServerChannel_->pFilter(NULL);
+
+	pEncryptionFilter_ = Network::createClientEncryptionFilter(Network::g_channelExternalEncryptType);
+	if(pEncryptionFilter_)
 	{
-		pBlowfishFilter_ = new Network::BlowfishFilter();
-		(*pBundle).appendBlob(pBlowfishFilter_->key());
-		pServerChannel_->pFilter(NULL);
+		(*pBundle).appendBlob(pEncryptionFilter_->key());
 	}
 	else
 	{
@@ -239,6 +245,9 @@ bool ClientObject::initLoginBaseapp()
 		(*pBundle).appendBlob(key);
 	}
 
+	Network::addCompressionOffer(*pBundle, EntityDef::compressionDictionary());
+	(*pBundle) << (uint32)CLIENT_FEATURE_VOLATILE_SNAPSHOT;
+
 	pEndpoint->send(pBundle);
 	Network::Bundle::reclaimPoolObject(pBundle);
 	return true;
@@ -336,10 +345,10 @@ void ClientObject::onHelloCB_(Network::Channel* pChannel, const std::string& ver
 		const std::string& scriptVerInfo, const std::string& protocolMD5, const std::string& entityDefMD5, 
 		COMPONENT_TYPE componentType)
 {
-	if(Network::g_channelExternalEncryptType == 1)
+	if(pEncryptionFilter_)
 	{
-		pServerChannel_->pFilter(pBlowfishFilter_);
-		pBlowfishFilter_ = NULL;
+		pServerChannel_->pFilter(pEncryptionFilter_);
+		pEncryptionFilter_ = NULL;
 	}
 
 	if(componentType == LOGINAPP_TYPE)
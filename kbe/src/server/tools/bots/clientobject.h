@@ -114,7 +114,7 @@ public:
 protected:
 	C_ERROR error_;
 	C_STATE state_;
-	Network::BlowfishFilter* pBlowfishFilter_;
+	Network::EncryptionFilter* pEncryptionFilter_;
 
 	Network::TCPPacketSenderEx* pTCPPacketSenderEx_;
 	Network::TCPPacketReceiverEx* pTCPPacketReceiverEx_;
@@ -69,12 +69,19 @@ void CreateAndLoginHandler::handleTimeout(TimerHandle handle, void * arg)
 
 	uint32 count = bots.reqCreateAndLoginTickCount();
 
-	while(bots.reqCreateAndLoginTotalCount() - bots.clients().size() > 0 && count-- > 0)
+	while(bots.reqCreateAndLoginTotalCount() > bots.numBots() && count-- > 0)
 	{
-		ClientObject* pClient = new ClientObject(g_kbeSrvConfig.getBots().bots_account_name_prefix + 
-			KBEngine::StringConv::val2str(g_componentID) + "_" + KBEngine::StringConv::val2str(g_accountID++), 
-			Bots::getSingleton().networkInterface());
+		std::string name = g_kbeSrvConfig.getBots().bots_account_name_prefix + 
+			KBEngine::StringConv::val2str(g_componentID) + "_" + KBEngine::StringConv::val2str(g_accountID++);
 
+		// 原生机器人不创建脚本对象， 单进程可以承载更多的连接
+		if(g_kbeSrvConfig.getBots().nativeBots_enable)
+		{
+			bots.nativeBots().createBot(name, bots.networkInterface());
+			continue;
+		}
+
+		ClientObject* pClient = new ClientObject(name, Bots::getSingleton().networkInterface());
 		Bots::getSingleton().addClient(pClient);
 	}
 }
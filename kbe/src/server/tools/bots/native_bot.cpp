@@ -0,0 +1,627 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "native_bot.h"
+#include "native_bots.h"
+#include "tcp_packet_receiver_ex.h"
+#include "tcp_packet_sender_ex.h"
+#include "network/bundle.h"
+#include "network/channel.h"
+#include "network/endpoint.h"
+#include "network/event_dispatcher.h"
+#include "network/network_interface.h"
+#include "network/encryption_filter.h"
+#include "network/compression_filter.h"
+#include "server/serverconfig.h"
+#include "server/server_errors.h"
+#include "entitydef/entitydef.h"
+#include "entitydef/scriptdef_module.h"
+#include "entitydef/method.h"
+#include "client_lib/client_interface.h"
+#include "common/kbeversion.h"
+
+#include "baseapp/baseapp_interface.h"
+#include "loginapp/loginapp_interface.h"
+
+namespace KBEngine{
+
+//-------------------------------------------------------------------------------------
+NativeBot::NativeBot(NativeBots& owner, const std::string& name, Network::NetworkInterface& ninterface):
+owner_(owner),
+networkInterface_(ninterface),
+name_(name),
+password_(g_kbeSrvConfig.getBots().bots_account_passwd),
+state_(STATE_INIT),
+pChannel_(Network::Channel::createPoolObject()),
+pTCPPacketSenderEx_(NULL),
+pTCPPacketReceiverEx_(NULL),
+pEncryptionFilter_(NULL),
+connectedBaseapp_(false),
+baseappIP_(),
+baseappPort_(0),
+entityID_(0),
+spaceID_(0),
+inWorld_(false),
+position_(),
+yaw_(0.f),
+pRPCMethod_(NULL),
+loginStartTime_(0),
+lastMoveTime_(0),
+lastRPCTime_(0),
+lastActiveTickTime_(0),
+pendingActiveTickTime_(0),
+numPendingActiveTicks_(0),
+lastBytesReceived_(0),
+lastBytesSent_(0)
+{
+	pChannel_->pNetworkInterface(&ninterface);
+	pChannel_->pMsgHandlers(&ClientInterface::messageHandlers);
+}
+
+//-------------------------------------------------------------------------------------
+NativeBot::~NativeBot()
+{
+	SAFE_RELEASE(pEncryptionFilter_);
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBot::finalise()
+{
+	collectBytes();
+	disconnect();
+
+	if(pChannel_)
+	{
+		if(!pChannel_->isDestroyed())
+			pChannel_->destroy();
+
+		Network::Channel::reclaimPoolObject(pChannel_);
+		pChannel_ = NULL;
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBot::disconnect()
+{
+	if(pTCPPacketReceiverEx_)
+		networkInterface_.dispatcher().deregisterReadFileDescriptor(*pTCPPacketReceiverEx_->pEndPoint());
+
+	// 回收EndPoint时不会关闭socket， 这里主动关闭， 切换到baseapp时不泄漏loginapp的连接
+	if(pChannel_ && pChannel_->pEndPoint())
+	{
+		pChannel_->stopSend();
+		pChannel_->pPacketSender(NULL);
+		pChannel_->pEndPoint()->close();
+		pChannel_->pEndPoint(NULL);
+	}
+
+	SAFE_RELEASE(pTCPPacketSenderEx_);
+	SAFE_RELEASE(pTCPPacketReceiverEx_);
+}
+
+//-------------------------------------------------------------------------------------
+bool NativeBot::connect(const std::string& ip, uint16 port, bool toBaseapp)
+{
+	disconnect();
+
+	Network::EndPoint* pEndpoint = Network::EndPoint::createPoolObject();
+
+	pEndpoint->socket(SOCK_STREAM);
+	if (!pEndpoint->good())
+	{
+		ERROR_MSG("NativeBot::connect: couldn't create a socket\n");
+		Network::EndPoint::reclaimPoolObject(pEndpoint);
+		return false;
+	}
+
+	u_int32_t address;
+	Network::Address::string2ip(ip.c_str(), address);
+	if(pEndpoint->connect(htons(port), address) == -1)
+	{
+		ERROR_MSG(fmt::format("NativeBot::connect({}): connect server({}:{}) is error({})!\n",
+			name_, ip, port, kbe_strerror()));
+
+		Network::EndPoint::reclaimPoolObject(pEndpoint);
+		return false;
+	}
+
+	Network::Address addr(ip.c_str(), port);
+	pEndpoint->addr(addr);
+
+	pChannel_->pEndPoint(pEndpoint);
+	pEndpoint->setnonblocking(true);
+	pEndpoint->setnodelay(true);
+
+	pTCPPacketSenderEx_ = new Network::TCPPacketSenderEx(*pEndpoint, networkInterface_, this);
+	pTCPPacketReceiverEx_ = new Network::TCPPacketReceiverEx(*pEndpoint, networkInterface_, this);
+	networkInterface_.dispatcher().registerReadFileDescriptor((*pEndpoint), pTCPPacketReceiverEx_);
+	pChannel_->pPacketSender(pTCPPacketSenderEx_);
+
+	connectedBaseapp_ = toBaseapp;
+	numPendingActiveTicks_ = 0;
+	pendingActiveTickTime_ = 0;
+
+	Network::Bundle* pBundle = Network::Bundle::createPoolObject();
+	if(toBaseapp)
+		(*pBundle).newMessage(BaseappInterface::hello);
+	else
+		(*pBundle).newMessage(LoginappInterface::hello);
+
+	(*pBundle) << KBEVersion::versionString() << KBEVersion::scriptVersionString();
+
+	// 同一个channel会先后连接loginapp与baseapp， 去掉之前安装的过滤器
+	pChannel_->pFilter(NULL);
+
+	SAFE_RELEASE(pEncryptionFilter_);
+	pEncryptionFilter_ = Network::createClientEncryptionFilter(Network::g_channelExternalEncryptType);
+	if(pEncryptionFilter_)
+	{
+		(*pBundle).appendBlob(pEncryptionFilter_->key());
+	}
+	else
+	{
+		std::string key = "";
+		(*pBundle).appendBlob(key);
+	}
+
+	Network::addCompressionOffer(*pBundle, EntityDef::compressionDictionary());
+
+	pEndpoint->send(pBundle);
+	Network::Bundle::reclaimPoolObject(pBundle);
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBot::send(Network::Bundle* pBundle)
+{
+	pChannel_->send(pBundle);
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBot::onPacketsReceived()
+{
+	if(isDestroyed() || !pChannel_->pEndPoint() || pChannel_->isCondemn())
+		return;
+
+	pChannel_->processPackets(NULL);
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBot::tick(uint64 now)
+{
+	if(isDestroyed())
+		return;
+
+	if(pChannel_->pEndPoint())
+	{
+		if(pChannel_->isCondemn())
+		{
+			destroy();
+			return;
+		}
+
+		pChannel_->processPackets(NULL);
+	}
+	else if(state_ != STATE_INIT)
+	{
+		destroy();
+		return;
+	}
+
+	ENGINE_COMPONENT_INFO& infos = g_kbeSrvConfig.getBots();
+
+	switch(state_)
+	{
+		case STATE_INIT:
+			state_ = STATE_WAIT;
+			loginStartTime_ = now;
+			owner_.onLoginStarted();
+
+			if(!connect(infos.login_ip, infos.login_port, false))
+			{
+				owner_.onLoginFailed();
+				destroy();
+				return;
+			}
+
+			break;
+		case STATE_CREATE:
+			state_ = STATE_WAIT;
+			createAccount();
+			break;
+		case STATE_LOGIN:
+			state_ = STATE_WAIT;
+			login();
+			break;
+		case STATE_LOGIN_BASEAPP_CREATE:
+			state_ = STATE_WAIT;
+
+			if(!connect(baseappIP_, baseappPort_, true))
+			{
+				owner_.onLoginFailed();
+				destroy();
+				return;
+			}
+
+			break;
+		case STATE_LOGIN_BASEAPP:
+			state_ = STATE_WAIT;
+			loginBaseapp();
+			break;
+		case STATE_WAIT:
+			break;
+		case STATE_PLAY:
+			updateMovement(now);
+			updateRPC(now);
+			break;
+		case STATE_DESTROYED:
+			return;
+		default:
+			KBE_ASSERT(false);
+			break;
+	};
+
+	updateActiveTick(now);
+	collectBytes();
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBot::collectBytes()
+{
+	if(!pChannel_)
+		return;
+
+	uint32 bytesReceived = pChannel_->numBytesReceived();
+	uint32 bytesSent = pChannel_->numBytesSent();
+
+	owner_.onBytes(bytesReceived - lastBytesReceived_, bytesSent - lastBytesSent_);
+
+	lastBytesReceived_ = bytesReceived;
+	lastBytesSent_ = bytesSent;
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBot::createAccount()
+{
+	Network::Bundle* pBundle = Network::Bundle::createPoolObject();
+	(*pBundle).newMessage(LoginappInterface::reqCreateAccount);
+	(*pBundle) << name_;
+	(*pBundle) << password_;
+	(*pBundle).appendBlob(std::string("bots"));
+	send(pBundle);
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBot::login()
+{
+	Network::Bundle* pBundle = Network::Bundle::createPoolObject();
+	(*pBundle).newMessage(LoginappInterface::login);
+	(*pBundle) << (CLIENT_CTYPE)CLIENT_TYPE_BOTS;
+	(*pBundle).appendBlob(std::string("bots"));
+	(*pBundle) << name_;
+	(*pBundle) << password_;
+
+	if (!g_kbeSrvConfig.getDBMgr().allowEmptyDigest)
+		(*pBundle) << EntityDef::md5().getDigestStr();
+
+	(*pBundle) << g_kbeSrvConfig.getBots().forceInternalLogin;
+	send(pBundle);
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBot::loginBaseapp()
+{
+	Network::Bundle* pBundle = Network::Bundle::createPoolObject();
+	(*pBundle).newMessage(BaseappInterface::loginBaseapp);
+	(*pBundle) << name_;
+	(*pBundle) << password_;
+	send(pBundle);
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBot::updateActiveTick(uint64 now)
+{
+	if(!pChannel_->pEndPoint())
+		return;
+
+	// 心跳同时用于保活和测量往返延迟， 间隔不能超过通道超时时间的一半
+	float interval = std::min(g_kbeSrvConfig.getBots().nativeBots_rttInterval, 
+		Network::g_channelExternalTimeout / 2.f);
+
+	if(now - lastActiveTickTime_ < uint64(interval * stampsPerSecond()))
+		return;
+
+	lastActiveTickTime_ = now;
+
+	// 只有在没有未回应的心跳时才计时， 回应按发送顺序到达， 下一个回应一定属于这次心跳
+	if(numPendingActiveTicks_ == 0)
+		pendingActiveTickTime_ = now;
+
+	++numPendingActiveTicks_;
+
+	Network::Bundle* pBundle = Network::Bundle::createPoolObject();
+	if(connectedBaseapp_)
+		(*pBundle).newMessage(BaseappInterface::onClientActiveTick);
+	else
+		(*pBundle).newMessage(LoginappInterface::onClientActiveTick);
+
+	send(pBundle);
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBot::updateMovement(uint64 now)
+{
+	if(!inWorld_ || spaceID_ == 0)
+		return;
+
+	ENGINE_COMPONENT_INFO& infos = g_kbeSrvConfig.getBots();
+
+	uint64 elapsed = now - lastMoveTime_;
+	if(elapsed < uint64(infos.nativeBots_moveInterval * stampsPerSecond()))
+		return;
+
+	// 第一次移动只记录时间， 否则会按照进入世界前的时间计算出过大的位移
+	if(lastMoveTime_ > 0)
+	{
+		float dt = std::min(float(double(elapsed) / stampsPerSecondD()), 1.f);
+
+		// 随机行走: 每次在当前朝向上随机偏转一个小角度
+		yaw_ += (float(rand()) / RAND_MAX - 0.5f);
+		if(yaw_ > KBE_PI)
+			yaw_ -= KBE_2PI;
+		else if(yaw_ < -KBE_PI)
+			yaw_ += KBE_2PI;
+
+		float dist = infos.nativeBots_moveSpeed * dt;
+		position_.x += cosf(yaw_) * dist;
+		position_.z += sinf(yaw_) * dist;
+
+		Network::Bundle* pBundle = Network::Bundle::createPoolObject();
+		(*pBundle).newMessage(BaseappInterface::onUpdateDataFromClient);
+		(*pBundle) << position_.x << position_.y << position_.z;
+		(*pBundle) << 0.f << 0.f << yaw_;
+		(*pBundle) << (uint8)1;
+		(*pBundle) << spaceID_;
+		send(pBundle);
+
+		owner_.onMoveSent();
+	}
+
+	lastMoveTime_ = now;
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBot::updateRPC(uint64 now)
+{
+	if(pRPCMethod_ == NULL)
+		return;
+
+	if(now - lastRPCTime_ < uint64(g_kbeSrvConfig.getBots().nativeBots_rpcInterval * stampsPerSecond()))
+		return;
+
+	lastRPCTime_ = now;
+
+	Network::Bundle* pBundle = Network::Bundle::createPoolObject();
+	(*pBundle).newMessage(BaseappInterface::onRemoteMethodCall);
+	(*pBundle) << entityID_;
+	(*pBundle) << (ENTITY_PROPERTY_UID)0;
+	(*pBundle) << pRPCMethod_->getUType();
+	send(pBundle);
+
+	owner_.onRPCSent();
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBot::onHelloCB(COMPONENT_TYPE componentType)
+{
+	if(pEncryptionFilter_)
+	{
+		pChannel_->pFilter(pEncryptionFilter_);
+		pEncryptionFilter_ = NULL;
+	}
+
+	if(componentType == LOGINAPP_TYPE)
+		state_ = STATE_CREATE;
+	else
+		state_ = STATE_LOGIN_BASEAPP;
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBot::onVersionNotMatch(MemoryStream& s)
+{
+	ERROR_MSG(fmt::format("NativeBot::onVersionNotMatch({}): version not match!\n", name_));
+
+	s.done();
+	owner_.onLoginFailed();
+	destroy();
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBot::onCreateAccountResult(MemoryStream& s)
+{
+	SERVER_ERROR_CODE retcode;
+	std::string datas;
+
+	s >> retcode;
+	s.readBlob(datas);
+
+	// 账号已经存在也继续登录
+	state_ = STATE_LOGIN;
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBot::onLoginSuccessfully(MemoryStream& s)
+{
+	std::string accountName;
+	std::string datas;
+
+	s >> accountName;
+	s >> baseappIP_;
+	s >> baseappPort_;
+	s.readBlob(datas);
+
+	state_ = STATE_LOGIN_BASEAPP_CREATE;
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBot::onLoginFailed(MemoryStream& s)
+{
+	SERVER_ERROR_CODE failedcode;
+	std::string datas;
+
+	s >> failedcode;
+	s.readBlob(datas);
+
+	WARNING_MSG(fmt::format("NativeBot::onLoginFailed: {} failedcode={}!\n", 
+		name_, SERVER_ERR_STR[failedcode]));
+
+	owner_.onLoginFailed();
+	destroy();
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBot::onLoginBaseappFailed(SERVER_ERROR_CODE failedcode)
+{
+	WARNING_MSG(fmt::format("NativeBot::onLoginBaseappFailed: {} failedcode={}!\n", 
+		name_, SERVER_ERR_STR[failedcode]));
+
+	owner_.onLoginFailed();
+	destroy();
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBot::onCreatedProxies(ENTITY_ID eid, const std::string& entityType)
+{
+	if(entityID_ == 0)
+		owner_.onLoggedIn(timestamp() - loginStartTime_);
+
+	entityID_ = eid;
+	pRPCMethod_ = NULL;
+
+	const std::string& rpcMethod = g_kbeSrvConfig.getBots().nativeBots_rpcMethod;
+	if(!rpcMethod.empty())
+	{
+		ScriptDefModule* pScriptModule = EntityDef::findScriptModule(entityType.c_str());
+		MethodDescription* pMethod = pScriptModule ? 
+			pScriptModule->findBaseMethodDescription(rpcMethod.c_str()) : NULL;
+
+		// 原生机器人不打包参数， 只能调用无参数的exposed方法
+		if(pMethod && pMethod->isExposed() && pMethod->getArgSize() == 0)
+			pRPCMethod_ = pMethod;
+	}
+
+	state_ = STATE_PLAY;
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBot::onEntityEnterWorld(MemoryStream& s)
+{
+	ENTITY_ID eid = 0;
+	s >> eid;
+	s.done();
+
+	if(eid == entityID_)
+	{
+		inWorld_ = true;
+		lastMoveTime_ = 0;
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBot::onEntityEnterSpace(MemoryStream& s)
+{
+	ENTITY_ID eid = 0;
+	SPACE_ID spaceID = 0;
+
+	s >> eid;
+	s >> spaceID;
+	s.done();
+
+	if(eid == entityID_)
+		spaceID_ = spaceID;
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBot::onEntityLeaveSpace(ENTITY_ID eid)
+{
+	if(eid == entityID_)
+	{
+		spaceID_ = 0;
+		inWorld_ = false;
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBot::onSetEntityPosAndDir(MemoryStream& s)
+{
+	ENTITY_ID eid = 0;
+	s >> eid;
+
+	if(eid != entityID_)
+	{
+		s.done();
+		return;
+	}
+
+	float roll, pitch;
+	s >> position_.x >> position_.y >> position_.z >> roll >> pitch >> yaw_;
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBot::onUpdateBasePos(float x, float y, float z)
+{
+	// 还没有开始移动前以服务器给出的位置作为起点
+	if(lastMoveTime_ == 0)
+	{
+		position_.x = x;
+		position_.y = y;
+		position_.z = z;
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBot::onKicked(SERVER_ERROR_CODE failedcode)
+{
+	WARNING_MSG(fmt::format("NativeBot::onKicked: {} code={}!\n", 
+		name_, SERVER_ERR_STR[failedcode]));
+
+	destroy();
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBot::onAppActiveTickCB()
+{
+	pChannel_->updateLastReceivedTime();
+
+	if(numPendingActiveTicks_ == 0)
+		return;
+
+	--numPendingActiveTicks_;
+
+	if(pendingActiveTickTime_ > 0)
+	{
+		owner_.onRTT(timestamp() - pendingActiveTickTime_);
+		pendingActiveTickTime_ = 0;
+	}
+}
+
+//-------------------------------------------------------------------------------------
+}
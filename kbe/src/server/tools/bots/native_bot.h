@@ -0,0 +1,155 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KBE_NATIVE_BOT_H
+#define KBE_NATIVE_BOT_H
+
+#include "common/common.h"
+#include "common/memorystream.h"
+#include "math/math.h"
+#include "network/common.h"
+#include "server/server_errors.h"
+
+namespace KBEngine { 
+
+class NativeBots;
+class MethodDescription;
+
+namespace Network
+{
+class Channel;
+class Bundle;
+class NetworkInterface;
+class EncryptionFilter;
+class TCPPacketSenderEx;
+class TCPPacketReceiverEx;
+}
+
+/*
+	不带脚本的轻量级机器人， 只完成登录、进入世界、随机行走、周期调用rpc与测量延迟， 
+	用于单进程驱动数万个连接对服务器进行压测。
+*/
+class NativeBot
+{
+public:
+	enum STATE
+	{
+		STATE_INIT = 0,
+		STATE_CREATE = 1,
+		STATE_LOGIN = 2,
+		STATE_LOGIN_BASEAPP_CREATE = 3,
+		STATE_LOGIN_BASEAPP = 4,
+		STATE_WAIT = 5,
+		STATE_PLAY = 6,
+		STATE_DESTROYED = 7,
+	};
+
+	NativeBot(NativeBots& owner, const std::string& name, Network::NetworkInterface& ninterface);
+	~NativeBot();
+
+	void finalise();
+
+	Network::Channel* pChannel() const { return pChannel_; }
+	const std::string& name() const { return name_; }
+
+	bool isDestroyed() const { return state_ == STATE_DESTROYED; }
+	bool isInWorld() const { return inWorld_; }
+	void destroy() { state_ = STATE_DESTROYED; }
+
+	void tick(uint64 now);
+
+	/**
+		socket上有数据到达， 立即处理收到的消息
+	*/
+	void onPacketsReceived();
+
+	void onHelloCB(COMPONENT_TYPE componentType);
+	void onVersionNotMatch(MemoryStream& s);
+	void onCreateAccountResult(MemoryStream& s);
+	void onLoginSuccessfully(MemoryStream& s);
+	void onLoginFailed(MemoryStream& s);
+	void onLoginBaseappFailed(SERVER_ERROR_CODE failedcode);
+	void onCreatedProxies(ENTITY_ID eid, const std::string& entityType);
+	void onEntityEnterWorld(MemoryStream& s);
+	void onEntityEnterSpace(MemoryStream& s);
+	void onEntityLeaveSpace(ENTITY_ID eid);
+	void onSetEntityPosAndDir(MemoryStream& s);
+	void onUpdateBasePos(float x, float y, float z);
+	void onKicked(SERVER_ERROR_CODE failedcode);
+	void onAppActiveTickCB();
+
+private:
+	bool connect(const std::string& ip, uint16 port, bool toBaseapp);
+	void disconnect();
+
+	void send(Network::Bundle* pBundle);
+
+	void createAccount();
+	void login();
+	void loginBaseapp();
+
+	void updateMovement(uint64 now);
+	void updateRPC(uint64 now);
+	void updateActiveTick(uint64 now);
+	void collectBytes();
+
+	NativeBots& owner_;
+	Network::NetworkInterface& networkInterface_;
+
+	std::string name_;
+	std::string password_;
+
+	STATE state_;
+
+	Network::Channel* pChannel_;
+	Network::TCPPacketSenderEx* pTCPPacketSenderEx_;
+	Network::TCPPacketReceiverEx* pTCPPacketReceiverEx_;
+	Network::EncryptionFilter* pEncryptionFilter_;
+	bool connectedBaseapp_;
+
+	std::string baseappIP_;
+	uint16 baseappPort_;
+
+	ENTITY_ID entityID_;
+	SPACE_ID spaceID_;
+	bool inWorld_;
+
+	Position3D position_;
+	float yaw_;
+
+	// 周期调用的exposed方法， NULL则不调用
+	MethodDescription* pRPCMethod_;
+
+	uint64 loginStartTime_;
+	uint64 lastMoveTime_;
+	uint64 lastRPCTime_;
+	uint64 lastActiveTickTime_;
+
+	// 尚未收到回应的心跳发出时间， 0表示没有
+	uint64 pendingActiveTickTime_;
+	uint32 numPendingActiveTicks_;
+
+	uint32 lastBytesReceived_;
+	uint32 lastBytesSent_;
+};
+
+}
+
+#endif // KBE_NATIVE_BOT_H
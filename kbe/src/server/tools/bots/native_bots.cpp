@@ -0,0 +1,197 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "native_bots.h"
+#include "native_bot.h"
+#include "network/channel.h"
+#include "server/serverconfig.h"
+
+namespace KBEngine{
+
+// 每个统计窗口保留的样本上限， 超出后不再记录， 避免大量机器人时内存与排序开销失控
+static const size_t NATIVE_BOTS_MAX_SAMPLES = 1000000;
+
+//-------------------------------------------------------------------------------------
+static inline uint32 stampsToMicroseconds(uint64 stamps)
+{
+	return uint32(std::min(double(stamps) * 1000000.0 / stampsPerSecondD(), 4294967295.0));
+}
+
+//-------------------------------------------------------------------------------------
+static double samplesPercentile(const std::vector<uint32>& samples, float percent)
+{
+	if(samples.empty())
+		return 0.0;
+
+	size_t idx = std::min(samples.size() - 1, size_t(samples.size() * percent));
+	return samples[idx] / 1000.0;
+}
+
+//-------------------------------------------------------------------------------------
+NativeBots::NativeBots():
+bots_(),
+numLoginStarted_(0),
+numLoginFailed_(0),
+numMoves_(0),
+numRPCs_(0),
+numBytesReceived_(0),
+numBytesSent_(0),
+loginSamples_(),
+rttSamples_(),
+totalLoggedIn_(0),
+lastReportTime_(0)
+{
+}
+
+//-------------------------------------------------------------------------------------
+NativeBots::~NativeBots()
+{
+	finalise();
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBots::finalise()
+{
+	BOTS::iterator iter = bots_.begin();
+	for(; iter != bots_.end(); ++iter)
+	{
+		iter->second->finalise();
+		delete iter->second;
+	}
+
+	bots_.clear();
+}
+
+//-------------------------------------------------------------------------------------
+NativeBot* NativeBots::createBot(const std::string& name, Network::NetworkInterface& ninterface)
+{
+	NativeBot* pBot = new NativeBot(*this, name, ninterface);
+	bots_[pBot->pChannel()] = pBot;
+	return pBot;
+}
+
+//-------------------------------------------------------------------------------------
+NativeBot* NativeBots::findBot(Network::Channel* pChannel)
+{
+	if(bots_.empty())
+		return NULL;
+
+	BOTS::iterator iter = bots_.find(pChannel);
+	if(iter != bots_.end())
+		return iter->second;
+
+	return NULL;
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBots::onLoggedIn(uint64 usedTime)
+{
+	++totalLoggedIn_;
+
+	if(loginSamples_.size() < NATIVE_BOTS_MAX_SAMPLES)
+		loginSamples_.push_back(stampsToMicroseconds(usedTime));
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBots::onRTT(uint64 rtt)
+{
+	if(rttSamples_.size() < NATIVE_BOTS_MAX_SAMPLES)
+		rttSamples_.push_back(stampsToMicroseconds(rtt));
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBots::tick()
+{
+	uint64 now = timestamp();
+
+	if(lastReportTime_ == 0)
+		resetWindow(now);
+
+	uint32 numInWorld = 0;
+
+	BOTS::iterator iter = bots_.begin();
+	while(iter != bots_.end())
+	{
+		NativeBot* pBot = iter->second;
+
+		pBot->tick(now);
+
+		if(pBot->isDestroyed())
+		{
+			pBot->finalise();
+			delete pBot;
+			bots_.erase(iter++);
+			continue;
+		}
+
+		if(pBot->isInWorld())
+			++numInWorld;
+
+		++iter;
+	}
+
+	float reportInterval = g_kbeSrvConfig.getBots().nativeBots_reportInterval;
+	if(reportInterval > 0.f && now - lastReportTime_ >= uint64(reportInterval * stampsPerSecond()))
+	{
+		report(now, numInWorld);
+		resetWindow(now);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBots::resetWindow(uint64 now)
+{
+	numLoginStarted_ = 0;
+	numLoginFailed_ = 0;
+	numMoves_ = 0;
+	numRPCs_ = 0;
+	numBytesReceived_ = 0;
+	numBytesSent_ = 0;
+	loginSamples_.clear();
+	rttSamples_.clear();
+	lastReportTime_ = now;
+}
+
+//-------------------------------------------------------------------------------------
+void NativeBots::report(uint64 now, uint32 numInWorld)
+{
+	double secs = double(now - lastReportTime_) / stampsPerSecondD();
+	if(secs <= 0.0)
+		return;
+
+	std::sort(loginSamples_.begin(), loginSamples_.end());
+	std::sort(rttSamples_.begin(), rttSamples_.end());
+
+	INFO_MSG(fmt::format("NativeBots::report: bots={}, inWorld={}, totalLoggedIn={}, "
+		"logins={:.1f}/s(started={}, failed={}, p50={:.1f}ms, p99={:.1f}ms), "
+		"recv={:.1f}KB/s, sent={:.1f}KB/s, moves={:.1f}/s, rpcs={:.1f}/s, "
+		"rtt(samples={}, p50={:.2f}ms, p90={:.2f}ms, p99={:.2f}ms, max={:.2f}ms)\n",
+		bots_.size(), numInWorld, totalLoggedIn_,
+		loginSamples_.size() / secs, numLoginStarted_, numLoginFailed_,
+		samplesPercentile(loginSamples_, 0.5f), samplesPercentile(loginSamples_, 0.99f),
+		numBytesReceived_ / 1024.0 / secs, numBytesSent_ / 1024.0 / secs,
+		numMoves_ / secs, numRPCs_ / secs,
+		rttSamples_.size(), samplesPercentile(rttSamples_, 0.5f), samplesPercentile(rttSamples_, 0.9f),
+		samplesPercentile(rttSamples_, 0.99f), samplesPercentile(rttSamples_, 1.f)));
+}
+
+//-------------------------------------------------------------------------------------
+}
@@ -0,0 +1,94 @@
+/*
+This source file is part of KBEngine
+For the latest info, see http://www.kbengine.org/
+
+Copyright (c) 2008-2018 KBEngine.
+
+KBEngine is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+KBEngine is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+ 
+You should have received a copy of the GNU Lesser General Public License
+along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KBE_NATIVE_BOTS_H
+#define KBE_NATIVE_BOTS_H
+
+#include "common/common.h"
+#include "common/timestamp.h"
+#include "helper/debug_helper.h"
+
+namespace KBEngine { 
+
+class NativeBot;
+
+namespace Network
+{
+class Channel;
+class NetworkInterface;
+}
+
+/*
+	管理所有原生机器人， 在主循环中驱动它们并汇总压测统计， 
+	每隔reportInterval输出一次登录吞吐、收发流量与往返延迟分位数。
+*/
+class NativeBots
+{
+public:
+	NativeBots();
+	~NativeBots();
+
+	void finalise();
+
+	NativeBot* createBot(const std::string& name, Network::NetworkInterface& ninterface);
+	NativeBot* findBot(Network::Channel* pChannel);
+
+	size_t size() const { return bots_.size(); }
+
+	void tick();
+
+	void onLoginStarted() { ++numLoginStarted_; }
+	void onLoginFailed() { ++numLoginFailed_; }
+	void onLoggedIn(uint64 usedTime);
+	void onRTT(uint64 rtt);
+	void onMoveSent() { ++numMoves_; }
+	void onRPCSent() { ++numRPCs_; }
+	void onBytes(uint32 received, uint32 sent) 
+	{ 
+		numBytesReceived_ += received; 
+		numBytesSent_ += sent; 
+	}
+
+private:
+	void report(uint64 now, uint32 numInWorld);
+	void resetWindow(uint64 now);
+
+	typedef KBEUnordered_map<Network::Channel*, NativeBot*> BOTS;
+	BOTS bots_;
+
+	// 以下为当前统计窗口内的数据
+	uint32 numLoginStarted_;
+	uint32 numLoginFailed_;
+	uint32 numMoves_;
+	uint32 numRPCs_;
+	uint64 numBytesReceived_;
+	uint64 numBytesSent_;
+
+	// 单位为微秒
+	std::vector<uint32> loginSamples_;
+	std::vector<uint32> rttSamples_;
+
+	uint64 totalLoggedIn_;
+	uint64 lastReportTime_;
+};
+
+}
+
+#endif // KBE_NATIVE_BOTS_H
@@ -21,6 +21,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "tcp_packet_receiver_ex.h"
 #include "clientobject.h"
+#include "native_bot.h"
 #include "bots.h"
 
 #include "network/address.h"
@@ -40,7 +41,17 @@ namespace Network
 TCPPacketReceiverEx::TCPPacketReceiverEx(EndPoint & endpoint,
 	   NetworkInterface & networkInterface, ClientObject* pClientObject) :
 	TCPPacketReceiver(endpoint, networkInterface),
-	pClientObject_(pClientObject)
+	pClientObject_(pClientObject),
+	pNativeBot_(NULL)
+{
+}
+
+//-------------------------------------------------------------------------------------
+TCPPacketReceiverEx::TCPPacketReceiverEx(EndPoint & endpoint,
+	   NetworkInterface & networkInterface, NativeBot* pNativeBot) :
+	TCPPacketReceiver(endpoint, networkInterface),
+	pClientObject_(NULL),
+	pNativeBot_(pNativeBot)
 {
 }
 
@@ -53,13 +64,31 @@ TCPPacketReceiverEx::~TCPPacketReceiverEx()
 //-------------------------------------------------------------------------------------
 Channel* TCPPacketReceiverEx::getChannel()
 {
+	if(pNativeBot_)
+		return pNativeBot_->pChannel();
+
 	return pClientObject_->pServerChannel();
 }
 
+//-------------------------------------------------------------------------------------
+int TCPPacketReceiverEx::handleInputNotification(int fd)
+{
+	int ret = TCPPacketReceiver::handleInputNotification(fd);
+
+	// 原生机器人没有脚本， 收到数据立即处理， 延迟统计不受tick间隔影响
+	if(pNativeBot_)
+		pNativeBot_->onPacketsReceived();
+
+	return ret;
+}
+
 //-------------------------------------------------------------------------------------
 void TCPPacketReceiverEx::onGetError(Channel* pChannel)
 {
-	pClientObject_->destroy();
+	if(pNativeBot_)
+		pNativeBot_->destroy();
+	else
+		pClientObject_->destroy();
 }
 
 //-------------------------------------------------------------------------------------
@@ -27,6 +27,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 namespace KBEngine { 
 
 class ClientObject;
+class NativeBot;
 
 namespace Network
 {
@@ -35,14 +36,18 @@ class TCPPacketReceiverEx : public TCPPacketReceiver
 {
 public:
 	TCPPacketReceiverEx(EndPoint & endpoint, NetworkInterface & networkInterface, ClientObject* pClientObject);
+	TCPPacketReceiverEx(EndPoint & endpoint, NetworkInterface & networkInterface, NativeBot* pNativeBot);
 	~TCPPacketReceiverEx();
 
 	virtual Channel* getChannel();
 
+	virtual int handleInputNotification(int fd);
+
 protected:
 	virtual void onGetError(Channel* pChannel);
 
 	ClientObject* pClientObject_;
+	NativeBot* pNativeBot_;
 };
 }
 }
@@ -21,6 +21,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "tcp_packet_sender_ex.h"
 #include "clientobject.h"
+#include "native_bot.h"
 #include "bots.h"
 
 #include "network/address.h"
@@ -43,7 +44,17 @@ namespace Network
 TCPPacketSenderEx::TCPPacketSenderEx(EndPoint & endpoint,
 	   NetworkInterface & networkInterface, ClientObject* pClientObject) :
 	TCPPacketSender(endpoint, networkInterface),
-	pClientObject_(pClientObject)
+	pClientObject_(pClientObject),
+	pNativeBot_(NULL)
+{
+}
+
+//-------------------------------------------------------------------------------------
+TCPPacketSenderEx::TCPPacketSenderEx(EndPoint & endpoint,
+	   NetworkInterface & networkInterface, NativeBot* pNativeBot) :
+	TCPPacketSender(endpoint, networkInterface),
+	pClientObject_(NULL),
+	pNativeBot_(pNativeBot)
 {
 }
 
@@ -56,13 +67,19 @@ TCPPacketSenderEx::~TCPPacketSenderEx()
 //-------------------------------------------------------------------------------------
 Channel* TCPPacketSenderEx::getChannel()
 {
+	if(pNativeBot_)
+		return pNativeBot_->pChannel();
+
 	return pClientObject_->pServerChannel();
 }
 
 //-------------------------------------------------------------------------------------
 void TCPPacketSenderEx::onGetError(Channel* pChannel)
 {
-	pClientObject_->destroy();
+	if(pNativeBot_)
+		pNativeBot_->destroy();
+	else
+		pClientObject_->destroy();
 }
 
 //-------------------------------------------------------------------------------------
@@ -27,6 +27,7 @@ along with KBEngine.  If not, see <http://www.gnu.org/licenses/>.
 namespace KBEngine { 
 
 class ClientObject;
+class NativeBot;
 
 namespace Network
 {
@@ -35,6 +36,7 @@ class TCPPacketSenderEx : public TCPPacketSender
 {
 public:
 	TCPPacketSenderEx(EndPoint & endpoint, NetworkInterface & networkInterface, ClientObject* pClientObject);
+	TCPPacketSenderEx(EndPoint & endpoint, NetworkInterface & networkInterface, NativeBot* pNativeBot);
 	~TCPPacketSenderEx();
 
 	virtual Channel* getChannel();
@@ -43,6 +45,7 @@ protected:
 	virtual void onGetError(Channel* pChannel);
 
 	ClientObject* pClientObject_;
+	NativeBot* pNativeBot_;
 };
 }
 }